@@ -12,11 +12,22 @@ struct TransformBuffer {
     DirectX::XMFLOAT4X4 view;
     DirectX::XMFLOAT4X4 proj;
     DirectX::XMFLOAT4X4 wit;
+    // undoes position & UV quantization, see VertexLayout.h
+    DirectX::XMFLOAT3 position_offset;
+    float pad0;
+    DirectX::XMFLOAT3 position_scale;
+    float pad1;
+    DirectX::XMFLOAT2 uv_offset;
+    DirectX::XMFLOAT2 uv_scale;
 };
 
 struct SkyMatrixBuffer {
     DirectX::XMFLOAT4X4 view;
     DirectX::XMFLOAT4X4 proj;
+    DirectX::XMFLOAT3 position_offset;
+    float pad0;
+    DirectX::XMFLOAT3 position_scale;
+    float pad1;
 };
 
 struct SceneDataBuffer {
@@ -37,4 +48,6 @@ struct MaterialBuffer {
     DirectX::XMFLOAT3 color_tint;
     uint32_t texture_index_count;
     DirectX::XMUINT4 packed_texture_indices[MATERIAL_BUFFER_PACKED_VECTOR_COUNT];
+    DirectX::XMFLOAT3 orm_constant;
+    uint32_t orm_constant_channels;
 };
@@ -0,0 +1,50 @@
+#include "ContentHash.h"
+
+#include <cstring>
+
+namespace {
+    uint64_t mix64(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    uint64_t rotl64(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+}
+
+uint64_t content_hash(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    // four independent lanes eat 32 bytes per iteration, which keeps
+    //   hashing way cheaper than even the fastest loader it guards
+    uint64_t lanes[4] = {
+        0x9e3779b185ebca87ull,
+        0xc2b2ae3d27d4eb4full,
+        0x165667b19e3779f9ull,
+        0x85ebca77c2b2ae63ull
+    };
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int l = 0; l < 4; l++) {
+            uint64_t word;
+            memcpy(&word, bytes + i + l * 8, sizeof(word));
+            lanes[l] = rotl64(lanes[l] + word * 0xc2b2ae3d27d4eb4full, 31) * 0x9e3779b185ebca87ull;
+        }
+    }
+
+    uint64_t h = (uint64_t)size;
+    for (int l = 0; l < 4; l++) {
+        h = mix64(h ^ lanes[l]);
+    }
+    for (; i < size; i++) {
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    }
+
+    return mix64(h);
+}
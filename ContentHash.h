@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// fast 64 bit hash of a file's bytes, what the cooked caches use to tell
+//   if their source changed. not meant to stand up to anyone trying
+uint64_t content_hash(const void* data, size_t size);
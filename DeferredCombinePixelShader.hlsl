@@ -40,11 +40,12 @@ float4 main(PostProcessIn input) : SV_TARGET {
 	TextureCube sky_cubemap = ResourceDescriptorHeap[skybox_cubemap_id];
 
     float4 albedo = albedo_tex.Sample(BasicSampler, input.uv);
-    float2 material = material_tex.Sample(BasicSampler, input.uv).xy;
+    float3 material = material_tex.Sample(BasicSampler, input.uv).xyz;
     float3 normal = normals_tex.Sample(BasicSampler, input.uv).xyz * 2.0f - float3(1.0f, 1.0f, 1.0f);
     float4 world_pos_depth_sample = world_pos_depth_tex.Sample(BasicSampler, input.uv);
     float roughness = material.x;
     float metalness = material.y;
+    float occlusion = material.z;
     float depth = world_pos_depth_sample.w;
 	float3 surface_color = albedo.rgb;
 	float light_mask = albedo.w;
@@ -78,7 +79,9 @@ float4 main(PostProcessIn input) : SV_TARGET {
 	// add skybox reflection
 	float3 to_frag = normalize(light_input.world_pos - camera_world_pos);
 	float3 refl_vec = reflect(to_frag, normal);
-	float3 sky_refl = sky_cubemap.Sample(BasicSampler, refl_vec).rgb;
+	// ambient occlusion only gets to darken what comes from the sky, the
+	//   lights are direct
+	float3 sky_refl = sky_cubemap.Sample(BasicSampler, refl_vec).rgb * occlusion;
 
 	float3 sky_surface_blend = lerp(
 		total_light, 
@@ -0,0 +1,4 @@
+// the G-buffer pass for materials whose ORM texture is flat all over, the
+//   value comes out of MaterialData & it never gets sampled
+#define MATERIAL_CONSTANT_ORM
+#include "DeferredMRTOutPixelShader.hlsl"
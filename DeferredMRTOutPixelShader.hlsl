@@ -5,6 +5,19 @@
 #define MATERIAL_MAX_TEXTURES 32
 #define PACKED_VECTOR_COUNT (MATERIAL_MAX_TEXTURES + 3) / 4
 
+//! make sure these match the MATERIAL_SLOT_* in "Material.h" !!!!
+#define MATERIAL_SLOT_ALBEDO 0
+#define MATERIAL_SLOT_NORMALS 1
+#define MATERIAL_SLOT_ORM 2
+
+//! make sure these match the TEXTURE_CHANNEL_* in "TextureConstant.h" !!!!
+#define TEXTURE_CHANNEL_R 0x1
+#define TEXTURE_CHANNEL_G 0x2
+#define TEXTURE_CHANNEL_B 0x4
+
+// DeferredMRTOutConstantOrmPixelShader.hlsl defines MATERIAL_CONSTANT_ORM
+//   & includes this, for materials with every ORM channel flat
+
 SamplerState BasicSampler : register(s0);
 
 // none of this stuff is used in this shader YET but I didn't feel 
@@ -27,6 +40,8 @@ cbuffer MaterialData : register(b1) {
 	float3 color_tint;
 	uint texture_count;
 	uint4 texture_indices[PACKED_VECTOR_COUNT];
+	float3 orm_constant;
+	uint orm_constant_channels;
 }
 
 uint get_texture_index(uint mat_index) {
@@ -38,20 +53,22 @@ uint get_texture_index(uint mat_index) {
 float3 get_normal(Texture2D normal_tex, SamplerState s, PSInput input) {
 	// TBN matrix
 	float3 N = normalize(input.normal);
-	float3 T = normalize(input.tangent - N * dot(input.tangent, N));
-	float3 B = cross(T, N);
+	float3 T = normalize(input.tangent.xyz - N * dot(input.tangent.xyz, N));
+	// w * cross(N, T) follows +v, our normal maps want green the other
+	//   way. w flips it back for mirrored uvs
+	float3 B = input.tangent.w * cross(T, N);
 	float3x3 TBN = float3x3(T, B, N);
 
-	// sample, unpack, transform, and save normal map values
-	float3 unpacked_normal = normal_tex.Sample(s, input.uv).xyz * 2.0 - 1.0;
+	// sample, unpack, transform, and save normal map values. cooked normal
+	//   maps are BC5 & only keep x & y, z gets rebuilt (fine on RGBA8 too)
+	float2 unpacked_xy = normal_tex.Sample(s, input.uv).xy * 2.0 - 1.0;
+	float3 unpacked_normal = float3(unpacked_xy, sqrt(saturate(1.0 - dot(unpacked_xy, unpacked_xy))));
 	return normalize(mul(unpacked_normal, TBN));
 }
 
 MRTOut main(PSInput input) {
-	Texture2D albedo = ResourceDescriptorHeap[get_texture_index(0)];
-	Texture2D metalness_map = ResourceDescriptorHeap[get_texture_index(1)];
-	Texture2D normal_map = ResourceDescriptorHeap[get_texture_index(2)];
-	Texture2D roughness_map = ResourceDescriptorHeap[get_texture_index(3)];		
+	Texture2D albedo = ResourceDescriptorHeap[get_texture_index(MATERIAL_SLOT_ALBEDO)];
+	Texture2D normal_map = ResourceDescriptorHeap[get_texture_index(MATERIAL_SLOT_NORMALS)];
 
 	// apply UV modifications
 	input.uv *= uv_scale;
@@ -59,18 +76,27 @@ MRTOut main(PSInput input) {
 
 	// clean up tangents & normals (sometimes they aren't normalized)
 	input.normal = normalize(input.normal);
-	input.tangent = normalize(input.tangent);
+	input.tangent.xyz = normalize(input.tangent.xyz);
 
 	// set up lighting parameters before light calculations
 	input.normal = get_normal(normal_map, BasicSampler, input);
     float3 surface_color = albedo.Sample(BasicSampler, input.uv).rgb * color_tint;
-	float roughness = roughness_map.Sample(BasicSampler, input.uv).r;
-	float metalness = metalness_map.Sample(BasicSampler, input.uv).r;
+#ifdef MATERIAL_CONSTANT_ORM
+	// nothing to fetch, it's the same everywhere
+	float3 orm = orm_constant;
+#else
+	// occlusion, roughness & metal all in one fetch. flat channels come
+	//   from the material instead, those are exact
+	Texture2D orm_map = ResourceDescriptorHeap[get_texture_index(MATERIAL_SLOT_ORM)];
+	float3 orm = orm_map.Sample(BasicSampler, input.uv).rgb;
+	float3 flat = (orm_constant_channels & uint3(TEXTURE_CHANNEL_R, TEXTURE_CHANNEL_G, TEXTURE_CHANNEL_B)) != 0;
+	orm = lerp(orm, orm_constant, flat);
+#endif
 
 	MRTOut output;
 	output.albedo = float4(surface_color, 1);
 	output.normals = float4(input.normal * 0.5f + 0.5f, 1.0f);
-	output.material = float4(roughness, metalness, 0.0f, 1.0f);
+	output.material = float4(orm.g, orm.b, orm.r, 1.0f);
 	output.world_pos_depth = float4(
 		// pack world pos to fit in a texture
 		input.world_pos,
@@ -0,0 +1,182 @@
+#include "DescriptorAllocator.h"
+
+#include <bit>
+
+static void set_bits(std::vector<uint64_t>& bitmap, uint32_t index, uint32_t count, bool used) {
+    while (count > 0) {
+        uint32_t bit = index % 64;
+        uint32_t span = 64 - bit < count ? 64 - bit : count;
+        uint64_t mask = (span == 64 ? ~0ull : ((1ull << span) - 1)) << bit;
+        if (used) {
+            bitmap[index / 64] |= mask;
+        } else {
+            bitmap[index / 64] &= ~mask;
+        }
+        index += span;
+        count -= span;
+    }
+}
+
+void descriptor_allocator_create(
+    DescriptorAllocator* allocator,
+    uint32_t static_count,
+    uint32_t frame_capacity,
+    uint32_t frame_count
+) {
+    allocator->static_count = static_count;
+    allocator->bitmap.assign((static_count + 63) / 64, 0);
+    if (static_count % 64 != 0) {
+        allocator->bitmap.back() = ~0ull << (static_count % 64);
+    }
+    allocator->search_word = 0;
+    allocator->pending_frees.clear();
+
+    allocator->frame_capacity = frame_capacity;
+    allocator->frame_count = frame_count;
+    allocator->frame_slot = 0;
+    allocator->frame_offset = 0;
+
+    allocator->stats = {};
+}
+
+uint32_t descriptor_allocator_allocate(DescriptorAllocator* allocator, uint32_t count) {
+    if (count == 0) return DESCRIPTOR_INVALID;
+
+    uint32_t word_count = (uint32_t)allocator->bitmap.size();
+    uint32_t found = DESCRIPTOR_INVALID;
+
+    if (count == 1) {
+        // single slots are the common case, first word with a hole wins
+        for (uint32_t w = allocator->search_word; w < word_count; w++) {
+            uint64_t bits = allocator->bitmap[w];
+            if (bits != ~0ull) {
+                found = w * 64 + (uint32_t)std::countr_zero(~bits);
+                allocator->search_word = w;
+                break;
+            }
+        }
+    } else {
+        // first fit over runs of clear bits, full & empty words in one step
+        uint32_t run = 0;
+        uint32_t start = 0;
+        for (uint32_t w = allocator->search_word; w < word_count && found == DESCRIPTOR_INVALID; w++) {
+            uint64_t bits = allocator->bitmap[w];
+            if (bits == ~0ull) {
+                run = 0;
+                continue;
+            }
+            if (bits == 0) {
+                if (run == 0) start = w * 64;
+                run += 64;
+                if (run >= count) found = start;
+                continue;
+            }
+
+            // mixed word, hop from run to run instead of bit by bit
+            uint32_t b = 0;
+            while (b < 64) {
+                uint64_t rest = bits >> b;
+                if (rest & 1) {
+                    run = 0;
+                    b += (uint32_t)std::countr_one(rest);
+                    continue;
+                }
+                uint32_t zeros = rest == 0 ? 64 - b : (uint32_t)std::countr_zero(rest);
+                if (run == 0) start = w * 64 + b;
+                run += zeros;
+                b += zeros;
+                if (run >= count) {
+                    found = start;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (found == DESCRIPTOR_INVALID) return DESCRIPTOR_INVALID;
+
+    set_bits(allocator->bitmap, found, count, true);
+    allocator->stats.used += count;
+    allocator->stats.allocation_count++;
+    if (allocator->stats.used > allocator->stats.high_water) {
+        allocator->stats.high_water = allocator->stats.used;
+    }
+    return found;
+}
+
+void descriptor_allocator_free(DescriptorAllocator* allocator, uint32_t index, uint32_t count, uint64_t fence_value) {
+    if (index == DESCRIPTOR_INVALID || count == 0) return;
+
+    allocator->pending_frees.push_back({ index, count, fence_value });
+    allocator->stats.pending_frees = (uint32_t)allocator->pending_frees.size();
+}
+
+void descriptor_allocator_retire(DescriptorAllocator* allocator, uint64_t completed_value) {
+    // frees get queued with the current frame's fence value, which only
+    //   goes up, so the queue is in fence order
+    while (!allocator->pending_frees.empty() && allocator->pending_frees.front().fence_value <= completed_value) {
+        DescriptorAllocator::PendingFree pending = allocator->pending_frees.front();
+        allocator->pending_frees.pop_front();
+
+        set_bits(allocator->bitmap, pending.index, pending.count, false);
+        allocator->stats.used -= pending.count;
+        allocator->stats.free_count++;
+        if (pending.index / 64 < allocator->search_word) {
+            allocator->search_word = pending.index / 64;
+        }
+    }
+    allocator->stats.pending_frees = (uint32_t)allocator->pending_frees.size();
+}
+
+void descriptor_allocator_begin_frame(DescriptorAllocator* allocator, uint32_t frame_slot) {
+    allocator->frame_slot = frame_slot;
+    allocator->frame_offset = 0;
+    allocator->stats.frame_used = 0;
+}
+
+uint32_t descriptor_allocator_allocate_frame(DescriptorAllocator* allocator, uint32_t count) {
+    if (allocator->frame_offset + count > allocator->frame_capacity) {
+        allocator->stats.frame_overflow_count++;
+        return DESCRIPTOR_INVALID;
+    }
+
+    uint32_t index = allocator->static_count +
+                     allocator->frame_slot * allocator->frame_capacity +
+                     allocator->frame_offset;
+    allocator->frame_offset += count;
+
+    allocator->stats.frame_used = allocator->frame_offset;
+    if (allocator->stats.frame_used > allocator->stats.frame_high_water) {
+        allocator->stats.frame_high_water = allocator->stats.frame_used;
+    }
+    return index;
+}
+
+uint32_t descriptor_allocator_largest_free_run(const DescriptorAllocator* allocator) {
+    uint32_t best = 0;
+    uint32_t run = 0;
+    for (uint64_t bits : allocator->bitmap) {
+        if (bits == 0) {
+            run += 64;
+        } else if (bits == ~0ull) {
+            run = 0;
+        } else {
+            uint32_t b = 0;
+            while (b < 64) {
+                uint64_t rest = bits >> b;
+                if (rest & 1) {
+                    run = 0;
+                    b += (uint32_t)std::countr_one(rest);
+                    continue;
+                }
+                uint32_t zeros = rest == 0 ? 64 - b : (uint32_t)std::countr_zero(rest);
+                run += zeros;
+                b += zeros;
+                best = run > best ? run : best;
+            }
+            continue;
+        }
+        best = run > best ? run : best;
+    }
+    return best;
+}
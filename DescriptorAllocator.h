@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+constexpr uint32_t DESCRIPTOR_INVALID = UINT32_MAX;
+
+struct DescriptorAllocatorStats {
+    // static region
+    uint32_t used;
+    uint32_t high_water;
+    uint64_t allocation_count;
+    uint64_t free_count;
+    // frees still waiting on their fence
+    uint32_t pending_frees;
+    // the current frame's partition
+    uint32_t frame_used;
+    uint32_t frame_high_water;
+    uint32_t frame_overflow_count;
+};
+
+// hands out slots of one descriptor heap, laid out as
+//   [0, static_count)                     long lived (bindless) descriptors,
+//                                         bitmap allocated & freed one by one
+//   [static_count, + frame_capacity * n)  one linear partition per frame in
+//                                         flight, wiped when the frame restarts
+// frees are queued with a fence value & only land once the caller says that
+//   value is done, so the GPU never reads a slot that's been handed out again.
+//   nothing here touches D3D12
+struct DescriptorAllocator {
+    uint32_t static_count;
+    // bit set = slot in use, padding bits past static_count stay set
+    std::vector<uint64_t> bitmap;
+    // no free bits before this word
+    uint32_t search_word;
+
+    struct PendingFree {
+        uint32_t index;
+        uint32_t count;
+        uint64_t fence_value;
+    };
+    std::deque<PendingFree> pending_frees;
+
+    uint32_t frame_capacity;
+    uint32_t frame_count;
+    uint32_t frame_slot;
+    uint32_t frame_offset;
+
+    DescriptorAllocatorStats stats;
+};
+
+void descriptor_allocator_create(
+    DescriptorAllocator* allocator,
+    uint32_t static_count,
+    uint32_t frame_capacity,
+    uint32_t frame_count
+);
+
+// count contiguous static slots (first fit), DESCRIPTOR_INVALID when
+//   there's no run that long
+uint32_t descriptor_allocator_allocate(DescriptorAllocator* allocator, uint32_t count);
+
+// gives the slots back once fence_value is done
+void descriptor_allocator_free(DescriptorAllocator* allocator, uint32_t index, uint32_t count, uint64_t fence_value);
+
+// lands every queued free whose fence value is at or below completed_value
+void descriptor_allocator_retire(DescriptorAllocator* allocator, uint64_t completed_value);
+
+// wipes frame_slot's partition & makes it current. only call once the
+//   GPU's done with the last frame that used that slot
+void descriptor_allocator_begin_frame(DescriptorAllocator* allocator, uint32_t frame_slot);
+
+// count contiguous slots that are good until this frame slot comes around
+//   again, DESCRIPTOR_INVALID when the partition's full
+uint32_t descriptor_allocator_allocate_frame(DescriptorAllocator* allocator, uint32_t count);
+
+// longest run of free static slots, free slots / this is the fragmentation
+uint32_t descriptor_allocator_largest_free_run(const DescriptorAllocator* allocator);
@@ -0,0 +1,84 @@
+#include "FrameAllocator.h"
+#include <cstddef>
+
+// a free page that fits size, or a brand new one
+static uint32_t acquire_page(FrameAllocator* allocator, uint64_t size) {
+    for (size_t i = 0; i < allocator->free_pages.size(); i++) {
+        uint32_t page = allocator->free_pages[i];
+        if (allocator->pages[page].size >= size) {
+            allocator->free_pages[i] = allocator->free_pages.back();
+            allocator->free_pages.pop_back();
+            return page;
+        }
+    }
+
+    allocator->pages.push_back({ size > allocator->page_size ? size : allocator->page_size, 0 });
+    allocator->stats.pages_created++;
+    return (uint32_t)allocator->pages.size() - 1;
+}
+
+void frame_allocator_create(FrameAllocator* allocator, uint64_t page_size, uint64_t alignment, uint32_t initial_page_count) {
+    allocator->page_size = page_size;
+    allocator->alignment = alignment;
+    allocator->pages.assign(initial_page_count, { page_size, 0 });
+    allocator->free_pages.clear();
+    for (uint32_t i = initial_page_count; i > 0; i--) {
+        allocator->free_pages.push_back(i - 1);
+    }
+    allocator->retired_pages.clear();
+    allocator->frame_pages.clear();
+    allocator->frame_fence_value = 0;
+    allocator->offset = 0;
+    allocator->stats = {};
+}
+
+void frame_allocator_begin_frame(FrameAllocator* allocator, uint64_t fence_value, uint64_t completed_value) {
+    // frames finish in order, so the oldest retired pages free up first
+    while (!allocator->retired_pages.empty() &&
+           allocator->pages[allocator->retired_pages.front()].fence_value <= completed_value) {
+        allocator->free_pages.push_back(allocator->retired_pages.front());
+        allocator->retired_pages.pop_front();
+    }
+
+    allocator->frame_fence_value = fence_value;
+    allocator->frame_pages.clear();
+    allocator->frame_pages.push_back(acquire_page(allocator, allocator->page_size));
+    allocator->offset = 0;
+
+    allocator->stats.bytes_written = 0;
+    allocator->stats.bytes_reserved = 0;
+    allocator->stats.page_count = 1;
+}
+
+FrameAllocation frame_allocator_allocate(FrameAllocator* allocator, uint64_t size) {
+    uint64_t reserved = (size + allocator->alignment - 1) & ~(allocator->alignment - 1);
+
+    uint32_t page = allocator->frame_pages.back();
+    if (allocator->offset + reserved > allocator->pages[page].size) {
+        // out of room, the rest of this page is wasted & we move on
+        page = acquire_page(allocator, reserved);
+        allocator->frame_pages.push_back(page);
+        allocator->offset = 0;
+        allocator->stats.spill_count++;
+        allocator->stats.page_count++;
+    }
+
+    FrameAllocation allocation = { page, allocator->offset };
+    allocator->offset += reserved;
+    allocator->stats.bytes_written += size;
+    allocator->stats.bytes_reserved += reserved;
+    return allocation;
+}
+
+void frame_allocator_end_frame(FrameAllocator* allocator) {
+    for (uint32_t page : allocator->frame_pages) {
+        allocator->pages[page].fence_value = allocator->frame_fence_value;
+        allocator->retired_pages.push_back(page);
+    }
+    allocator->frame_pages.clear();
+
+    allocator->stats.frame_count++;
+    if (allocator->stats.bytes_reserved > allocator->stats.high_water_bytes) {
+        allocator->stats.high_water_bytes = allocator->stats.bytes_reserved;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// a page of upload memory the frame allocator carves out of. the backend
+//   owns whatever buffer sits behind each index, the allocator just hands
+//   them out & knows when the GPU's done with them
+struct FrameAllocatorPage {
+    uint64_t size;
+    // frame fence value of the last frame that wrote into it
+    uint64_t fence_value;
+};
+
+struct FrameAllocation {
+    uint32_t page;
+    uint64_t offset;
+};
+
+struct FrameAllocatorStats {
+    // the frame being recorded
+    uint64_t bytes_written;
+    // bytes_written plus alignment padding
+    uint64_t bytes_reserved;
+    uint32_t page_count;
+
+    // every frame so far
+    uint64_t frame_count;
+    // most bytes_reserved of any one frame
+    uint64_t high_water_bytes;
+    // times a frame ran off the end of a page and took another
+    uint64_t spill_count;
+    uint32_t pages_created;
+};
+
+// linear allocator that resets every frame. each frame fills pages front
+//   to back, pages go back to the free list once the frame fence says the
+//   GPU's done reading the frame that wrote them. nothing here touches the
+//   GPU, fence values are just numbers handed in by the caller
+struct FrameAllocator {
+    uint64_t page_size;
+    uint64_t alignment;
+    // pages.size() only ever grows, the backend creates buffers to match
+    std::vector<FrameAllocatorPage> pages;
+    // pages no frame in flight is using
+    std::vector<uint32_t> free_pages;
+    // pages of finished frames, oldest first
+    std::deque<uint32_t> retired_pages;
+    // this frame's pages, the last one is being filled
+    std::vector<uint32_t> frame_pages;
+    uint64_t frame_fence_value;
+    uint64_t offset;
+    FrameAllocatorStats stats;
+};
+
+// initial_page_count pages of page_size exist from the start (the backend
+//   usually carves those out of one big heap), alignment is a power of two
+void frame_allocator_create(FrameAllocator* allocator, uint64_t page_size, uint64_t alignment, uint32_t initial_page_count);
+
+// starts a frame that's done once the fence hits fence_value. pages from
+//   frames up to completed_value come back first
+void frame_allocator_begin_frame(FrameAllocator* allocator, uint64_t fence_value, uint64_t completed_value);
+
+// size bytes for this frame. a full page spills into a free one, or a new
+//   one if nothing's free (bigger than page_size if size needs it)
+FrameAllocation frame_allocator_allocate(FrameAllocator* allocator, uint64_t size);
+
+// this frame's pages stay the GPU's until its fence value is done
+void frame_allocator_end_frame(FrameAllocator* allocator);
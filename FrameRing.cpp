@@ -0,0 +1,66 @@
+#include "FrameRing.h"
+
+// how much the newest frame counts in the running average
+static constexpr double LATENCY_AVERAGE_WEIGHT = 1.0 / 16.0;
+
+static uint32_t clamp_count(uint32_t count) {
+    count = count < MAX_FRAMES_IN_FLIGHT ? count : MAX_FRAMES_IN_FLIGHT;
+    return count > 0 ? count : 1;
+}
+
+void frame_ring_create(FrameRing* ring, uint32_t count, uint64_t first_fence_value, double now) {
+    ring->count = clamp_count(count);
+    ring->requested_count = ring->count;
+    ring->slot = 0;
+    ring->fence_value = first_fence_value;
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        ring->signaled_values[i] = 0;
+        ring->start_times[i] = 0.0;
+        ring->in_flight[i] = false;
+    }
+    ring->frame_start_time = now;
+    ring->stats = {};
+}
+
+uint64_t frame_ring_submit(FrameRing* ring) {
+    ring->signaled_values[ring->slot] = ring->fence_value;
+    ring->start_times[ring->slot] = ring->frame_start_time;
+    ring->in_flight[ring->slot] = true;
+    return ring->fence_value;
+}
+
+uint64_t frame_ring_advance(FrameRing* ring) {
+    ring->fence_value++;
+
+    // a slot only ever waits on its own last frame, so the count can change
+    //   right away. slots past a smaller count just finish in the background
+    ring->count = ring->requested_count;
+    ring->slot = (ring->slot + 1) % ring->count;
+    return ring->signaled_values[ring->slot];
+}
+
+void frame_ring_stalled(FrameRing* ring, double seconds) {
+    ring->stats.stall_count++;
+    ring->stats.stall_seconds += seconds;
+}
+
+void frame_ring_retire(FrameRing* ring, uint64_t completed_value, double now) {
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (!ring->in_flight[i] || ring->signaled_values[i] > completed_value) continue;
+        ring->in_flight[i] = false;
+
+        double latency = now - ring->start_times[i];
+        FrameLatencyStats& stats = ring->stats;
+        stats.average_seconds = stats.frame_count == 0
+            ? latency
+            : stats.average_seconds + (latency - stats.average_seconds) * LATENCY_AVERAGE_WEIGHT;
+        stats.max_seconds = latency > stats.max_seconds ? latency : stats.max_seconds;
+        stats.last_seconds = latency;
+        stats.frame_count++;
+    }
+    ring->frame_start_time = now;
+}
+
+void frame_ring_set_count(FrameRing* ring, uint32_t count) {
+    ring->requested_count = clamp_count(count);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// frames the CPU can get ahead of the GPU, how many are actually in flight
+//   is picked at runtime. anything per frame gets this many slots up front
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+// one T per frame slot, indexed by FrameRing::slot. slots past the ring's
+//   count just sit there until it grows
+template <typename T>
+struct PerFrame {
+    T slots[MAX_FRAMES_IN_FLIGHT] = {};
+
+    T& operator[](uint32_t slot) { return slots[slot]; }
+    const T& operator[](uint32_t slot) const { return slots[slot]; }
+    T* begin() { return slots; }
+    T* end() { return slots + MAX_FRAMES_IN_FLIGHT; }
+};
+
+struct FrameLatencyStats {
+    // frames the GPU's finished so far
+    uint64_t frame_count;
+    // from a frame starting on the CPU to the CPU seeing the GPU's done
+    //   with it, so it's only as fine as how often retire gets called
+    double last_seconds;
+    // running average, recent frames weigh the most
+    double average_seconds;
+    double max_seconds;
+    // advances that had to wait for the GPU & how long they waited in total
+    uint64_t stall_count;
+    double stall_seconds;
+};
+
+// which frame slot is being recorded & what fence values say each slot's
+//   free again. one fence, every frame signals the next value up. nothing
+//   here touches the GPU, fence values & times are handed in
+struct FrameRing {
+    uint32_t count;
+    // takes effect on the next advance
+    uint32_t requested_count;
+    uint32_t slot;
+    // what the frame being recorded signals when it's done
+    uint64_t fence_value;
+    double frame_start_time;
+    // what each slot's last frame signaled, it's free once that's done
+    PerFrame<uint64_t> signaled_values;
+    PerFrame<double> start_times;
+    // submitted & the CPU hasn't seen it finish yet
+    PerFrame<bool> in_flight;
+    FrameLatencyStats stats;
+};
+
+// count frames in flight, 1 to MAX_FRAMES_IN_FLIGHT. the first frame
+//   starts right away at now & signals first_fence_value
+void frame_ring_create(FrameRing* ring, uint32_t count, uint64_t first_fence_value, double now);
+
+// the frame being recorded is off to the GPU, signal the value this returns
+uint64_t frame_ring_submit(FrameRing* ring);
+
+// on to the next slot. returns the fence value that has to be done before
+//   anything in the slot gets reused. a new count kicks in here, no
+//   draining needed
+uint64_t frame_ring_advance(FrameRing* ring);
+
+// the CPU waited seconds for the GPU before it could carry on
+void frame_ring_stalled(FrameRing* ring, double seconds);
+
+// the fence got to completed_value by now, finished frames get their
+//   latency counted. goes after waiting on advance's value, the new frame
+//   starts at now since time spent waiting isn't part of it
+void frame_ring_retire(FrameRing* ring, uint64_t completed_value, double now);
+
+// clamped to 1 to MAX_FRAMES_IN_FLIGHT, see frame_ring_advance
+void frame_ring_set_count(FrameRing* ring, uint32_t count);
@@ -19,6 +19,21 @@ static float randf_range(float min, float max) {
     return min + ((max - min) * ((rand() / (float)RAND_MAX)));
 }
 
+// mesh buffers & every texture on the copy queue are done, anything
+//   still streaming in just shows up a frame or so later
+static bool is_uploaded(const GameEntity& entity) {
+    if (!Graphics::IsUploadDone(entity.get_mesh()->get_upload_ticket())) {
+        return false;
+    }
+    const Material* material = entity.get_material().get();
+    for (uint32_t i = 0; i < material->get_texture_index_count(); i++) {
+        if (!Graphics::IsUploadDone(Graphics::get_texture_upload_ticket(material->get_texture_indices()[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // --------------------------------------------------------
 // The constructor is called after the window and graphics API
 // are initialized but before the game loop begins
@@ -37,9 +52,7 @@ Game::Game() {
 // --------------------------------------------------------
 Game::~Game() {
     Graphics::WaitForGPU();
-    for (uint32_t i = 0; i < Graphics::NUM_BACK_BUFFERS; i++) {
-        mrt_bundle_destroy(&mrt_bundles[i]);
-    }
+    mrt_bundle_destroy(&mrt_bundle);
 }
 
 void Game::CreateMainPipelineStuff() {
@@ -47,6 +60,7 @@ void Game::CreateMainPipelineStuff() {
     Microsoft::WRL::ComPtr<ID3DBlob> vertex_shader_bytecode;
     Microsoft::WRL::ComPtr<ID3DBlob> fullscreen_tri_vertex_bytecode;
     Microsoft::WRL::ComPtr<ID3DBlob> deferred_mrt_pixel_bytecode;
+    Microsoft::WRL::ComPtr<ID3DBlob> deferred_mrt_constant_orm_pixel_bytecode;
     Microsoft::WRL::ComPtr<ID3DBlob> deferred_combine_pixel_bytecode;
     {
         D3DReadFileToBlob(
@@ -64,6 +78,11 @@ void Game::CreateMainPipelineStuff() {
             deferred_mrt_pixel_bytecode.GetAddressOf()
         );
 
+        D3DReadFileToBlob(
+            FixPath(L"DeferredMRTOutConstantOrmPixelShader.cso").c_str(),
+            deferred_mrt_constant_orm_pixel_bytecode.GetAddressOf()
+        );
+
         D3DReadFileToBlob(
             FixPath(L"DeferredCombinePixelShader.cso").c_str(),
             deferred_combine_pixel_bytecode.GetAddressOf()
@@ -75,44 +94,25 @@ void Game::CreateMainPipelineStuff() {
 
     // root signature
     {
-        D3D12_DESCRIPTOR_RANGE cbv_range_transform = {};
-        cbv_range_transform.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-        cbv_range_transform.NumDescriptors = 1;
-        cbv_range_transform.BaseShaderRegister = 0;
-        cbv_range_transform.RegisterSpace = 0;
-        cbv_range_transform.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
-
+        // per draw constants are root CBVs, they point straight at the
+        //   frame's cbuffer memory so there's no descriptor to write per draw
         D3D12_ROOT_PARAMETER transform_param = {};
-        transform_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        transform_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
         transform_param.ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
-        transform_param.DescriptorTable.NumDescriptorRanges = 1;
-        transform_param.DescriptorTable.pDescriptorRanges = &cbv_range_transform;
-
-        D3D12_DESCRIPTOR_RANGE cbv_range_scene_data = {};
-        cbv_range_scene_data.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-        cbv_range_scene_data.NumDescriptors = 1;
-        cbv_range_scene_data.BaseShaderRegister = 0;
-        cbv_range_scene_data.RegisterSpace = 0;
-        cbv_range_scene_data.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+        transform_param.Descriptor.ShaderRegister = 0;
+        transform_param.Descriptor.RegisterSpace = 0;
 
         D3D12_ROOT_PARAMETER scene_data_param = {};
-        scene_data_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        scene_data_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
         scene_data_param.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
-        scene_data_param.DescriptorTable.NumDescriptorRanges = 1;
-        scene_data_param.DescriptorTable.pDescriptorRanges = &cbv_range_scene_data;
-
-        D3D12_DESCRIPTOR_RANGE cbv_range_material = {};
-        cbv_range_material.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-        cbv_range_material.NumDescriptors = 1;
-        cbv_range_material.BaseShaderRegister = 1;
-        cbv_range_material.RegisterSpace = 0;
-        cbv_range_material.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+        scene_data_param.Descriptor.ShaderRegister = 0;
+        scene_data_param.Descriptor.RegisterSpace = 0;
 
         D3D12_ROOT_PARAMETER material_param = {};
-        material_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        material_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
         material_param.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
-        material_param.DescriptorTable.NumDescriptorRanges = 1;
-        material_param.DescriptorTable.pDescriptorRanges = &cbv_range_material;
+        material_param.Descriptor.ShaderRegister = 1;
+        material_param.Descriptor.RegisterSpace = 0;
 
         std::vector<D3D12_ROOT_PARAMETER> root_params = {
             transform_param,
@@ -179,16 +179,14 @@ void Game::CreateMainPipelineStuff() {
 
     // MRT stuff
     {
-        for (uint32_t i = 0; i < Graphics::NUM_BACK_BUFFERS; i++) {
-            mrt_bundle_create(
-                Window::Width(),
-                Window::Height(),
-                mrt_formats.data(),
-                reinterpret_cast<float*>(clear_colors),
-                static_cast<uint32_t>(mrt_formats.size()),
-                &mrt_bundles[i]
-            );
-        }
+        mrt_bundle_create(
+            Window::Width(),
+            Window::Height(),
+            mrt_formats.data(),
+            reinterpret_cast<float*>(clear_colors),
+            static_cast<uint32_t>(mrt_formats.size()),
+            &mrt_bundle
+        );
     }
 
     // pipeline states
@@ -238,6 +236,13 @@ void Game::CreateMainPipelineStuff() {
             IID_PPV_ARGS(mrt_pipeline_state.GetAddressOf())
         );
 
+        pso_desc.PS.pShaderBytecode = deferred_mrt_constant_orm_pixel_bytecode->GetBufferPointer();
+        pso_desc.PS.BytecodeLength = deferred_mrt_constant_orm_pixel_bytecode->GetBufferSize();
+        Graphics::Device->CreateGraphicsPipelineState(
+            &pso_desc,
+            IID_PPV_ARGS(mrt_constant_orm_pipeline_state.GetAddressOf())
+        );
+
         // ~~~ COMBINE PSO ~~~
 
         pso_desc.VS.pShaderBytecode = fullscreen_tri_vertex_bytecode->GetBufferPointer();
@@ -291,18 +296,11 @@ void Game::InitSky() {
 
     // root signature
     {
-        D3D12_DESCRIPTOR_RANGE cbv_range_transform = {};
-        cbv_range_transform.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-        cbv_range_transform.NumDescriptors = 1;
-        cbv_range_transform.BaseShaderRegister = 0;
-        cbv_range_transform.RegisterSpace = 0;
-        cbv_range_transform.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
-
         D3D12_ROOT_PARAMETER transform_param = {};
-        transform_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        transform_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
         transform_param.ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
-        transform_param.DescriptorTable.NumDescriptorRanges = 1;
-        transform_param.DescriptorTable.pDescriptorRanges = &cbv_range_transform;
+        transform_param.Descriptor.ShaderRegister = 0;
+        transform_param.Descriptor.RegisterSpace = 0;
 
         D3D12_ROOT_PARAMETER root_constant_param = {};
         root_constant_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
@@ -378,11 +376,11 @@ void Game::InitSky() {
         pso_desc.PS.pShaderBytecode = pixel_shader_bytecode->GetBufferPointer();
         pso_desc.PS.BytecodeLength = pixel_shader_bytecode->GetBufferSize();
 
-        pso_desc.NumRenderTargets = mrt_bundles[0].count;
+        pso_desc.NumRenderTargets = mrt_bundle.count;
         memcpy(
             pso_desc.RTVFormats,
-            mrt_bundles[0].formats,
-            sizeof(DXGI_FORMAT) * mrt_bundles[0].count
+            mrt_bundle.formats,
+            sizeof(DXGI_FORMAT) * mrt_bundle.count
         );
         pso_desc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
         pso_desc.SampleDesc.Count = 1;
@@ -394,7 +392,9 @@ void Game::InitSky() {
 
         pso_desc.DepthStencilState.DepthEnable = true;
         pso_desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
-        pso_desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+        // tested against but never written, the sky sits on the far plane
+        //   the clear already put there (& the graph only reads depth here)
+        pso_desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
 
         pso_desc.BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
         pso_desc.BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
@@ -431,32 +431,60 @@ void Game::SceneInit() {
 
     RandomizeLights();
 
+    // every material's textures decode together across threads & go up in
+    //   one batch, 3 per material in MATERIAL_SLOT_* order. the "_orm"
+    //   ones get packed from each material's roughness & metal maps
+    const char* texture_names[] = {
+        "bronze_albedo.png", "bronze_normals.png", "bronze_orm.png",
+        "cobblestone_albedo.png", "cobblestone_normals.png", "cobblestone_orm.png",
+        "floor_albedo.png", "floor_normals.png", "floor_orm.png",
+    };
+    constexpr uint32_t texture_count = sizeof(texture_names) / sizeof(texture_names[0]);
+    std::vector<std::string> texture_paths;
+    std::vector<const char*> texture_path_strings;
+    for (const char* name : texture_names) {
+        texture_paths.push_back(FixPath(std::string("../../Assets/Textures/") + name));
+    }
+    for (const std::string& path : texture_paths) {
+        texture_path_strings.push_back(path.c_str());
+    }
+    uint32_t texture_ids[texture_count] = {};
+    Graphics::LoadTextures(texture_path_strings.data(), texture_count, texture_ids);
+
     std::shared_ptr<Material> mat_bronze = std::make_shared<Material>();
     {
-        mat_bronze->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/bronze_albedo.png").c_str()));
-        mat_bronze->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/bronze_metal.png").c_str()));
-        mat_bronze->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/bronze_normals.png").c_str()));
-        mat_bronze->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/bronze_roughness.png").c_str()));
+        for (uint32_t i = 0; i < 3; i++) {
+            mat_bronze->AddTexture(texture_ids[i]);
+        }
     }
 
     std::shared_ptr<Material> mat_cobblestone = std::make_shared<Material>();
     {
-        mat_cobblestone->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/cobblestone_albedo.png").c_str()));
-        mat_cobblestone->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/cobblestone_metal.png").c_str()));
-        mat_cobblestone->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/cobblestone_normals.png").c_str()));
-        mat_cobblestone->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/cobblestone_roughness.png").c_str()));
+        for (uint32_t i = 3; i < 6; i++) {
+            mat_cobblestone->AddTexture(texture_ids[i]);
+        }
         mat_cobblestone->set_uv_scale({0.25f, 0.25f});
     }
 
     std::shared_ptr<Material> mat_floor = std::make_shared<Material>();
     {
-        mat_floor->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/floor_albedo.png").c_str()));
-        mat_floor->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/floor_metal.png").c_str()));
-        mat_floor->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/floor_normals.png").c_str()));
-        mat_floor->AddTexture(Graphics::LoadTexture(FixPath(L"../../Assets/Textures/floor_roughness.png").c_str()));
+        for (uint32_t i = 6; i < 9; i++) {
+            mat_floor->AddTexture(texture_ids[i]);
+        }
         mat_floor->set_uv_scale({2.0f, 2.0f});
     }
 
+    // flat ORM channels (every metal map here is one value) turn into
+    //   material constants, exact instead of whatever BC7 made of them
+    std::shared_ptr<Material> materials[] = { mat_bronze, mat_cobblestone, mat_floor };
+    for (const std::shared_ptr<Material>& material : materials) {
+        TextureConstant orm = Graphics::get_texture_constant(material->get_texture_indices()[MATERIAL_SLOT_ORM]);
+        material->set_orm_constant(
+            orm.channels & TEXTURE_CHANNELS_RGB,
+            { orm.value[0] / 255.0f, orm.value[1] / 255.0f, orm.value[2] / 255.0f }
+        );
+    }
+
     cube_mesh = Mesh::Load(FixPath("../../Assets/Meshes/cube.obj").c_str());
 
     entities.emplace_back(
@@ -473,6 +501,10 @@ void Game::SceneInit() {
         mat_cobblestone,
         Transform({-4.0f, 0.0f, 0.0f})
     );
+
+    // everything above just recorded copies, send them all off in one batch
+    //   so the GPU's already busy with them while the first frame records
+    Graphics::FlushUploads();
 }
 
 // --------------------------------------------------------
@@ -496,9 +528,8 @@ void Game::OnResize() {
 
     camera->UpdateProjectionMatrix(Window::AspectRatio());
 
-    for (uint32_t i = 0; i < Graphics::NUM_BACK_BUFFERS; i++) {
-        mrt_bundle_resize(Window::Width(), Window::Height(), &mrt_bundles[i]);
-    }
+    // nothing gets reallocated here, the next frame picks up targets at the new size
+    mrt_bundle_resize(Window::Width(), Window::Height(), &mrt_bundle);
 }
 
 // --------------------------------------------------------
@@ -513,6 +544,7 @@ void Game::Update(float deltaTime, float totalTime) {
 
     for (auto& entity : entities) {
         entity.get_transform().Rotate(0, deltaTime, 0);
+        entity.update_lod(*camera, (float)Window::Height());
     }
 }
 
@@ -520,220 +552,322 @@ void Game::Update(float deltaTime, float totalTime) {
 // Clear the screen, redraw everything, present to the user
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime) {
-    ClearPrevFrame();
-
     if (Input::KeyPress(VK_SPACE)) {
         RandomizeLights();
     }
+    // cycle through 1 to MAX_FRAMES_IN_FLIGHT to feel out latency vs throughput
+    if (Input::KeyPress('F')) {
+        Graphics::SetFramesInFlight(Graphics::get_frames_in_flight() % MAX_FRAMES_IN_FLIGHT + 1);
+    }
 
-    uint32_t frame_index = Graphics::get_swap_chain_index();
+    uint32_t swap_chain_index = Graphics::get_swap_chain_index();
 
     // our actual rendering things happen between clearing and presenting !!!!!
 
     auto command_list = Graphics::CommandList;
 
     command_list->SetDescriptorHeaps(1, Graphics::CBVSRVDescriptorHeap.GetAddressOf());
-    command_list->SetGraphicsRootSignature(root_signature.Get());
 
     // set parameters & objects & references & etc for upcoming draw
     command_list->RSSetViewports(1, &viewport);
     command_list->RSSetScissorRects(1, &scissor_rect);
     command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+    // every pass says what it touches & how, the graph works out the
+    //   barriers between them & where the G-buffer lives this frame
+    RenderGraph* graph = &render_graph;
+    render_graph_reset(graph);
+
+    uint32_t back_buffer = render_graph_import(
+        graph,
+        "back buffer",
+        Graphics::BackBuffers[swap_chain_index].Get(),
+        RG_STATE_PRESENT,
+        RG_STATE_PRESENT
+    );
+    uint32_t depth = render_graph_import(
+        graph,
+        "depth",
+        Graphics::DepthBuffer.Get(),
+        RG_STATE_DEPTH_WRITE,
+        RG_STATE_DEPTH_WRITE
+    );
+    uint32_t gbuffer[GBUFFER_RT_COUNT];
+    for (uint32_t i = 0; i < GBUFFER_RT_COUNT; i++) {
+        gbuffer[i] = render_graph_create_texture(graph, "gbuffer", mrt_bundle_target_desc(&mrt_bundle, i));
+    }
+
     // ~~~ DEFERRED MRT DRAW ~~~
+    uint32_t pass = render_graph_add_pass(graph, "gbuffer", [=, this]() { DrawGBuffer(gbuffer); });
+    for (uint32_t i = 0; i < GBUFFER_RT_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    }
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_WRITE);
 
-    // assuming that all materials use the same pipeline
-    command_list->SetPipelineState(mrt_pipeline_state.Get());
-    command_list->OMSetRenderTargets(
-        mrt_bundles[frame_index].count,
-        mrt_bundles[frame_index].rtv_descriptors,
-        true,
-        &Graphics::DSVHandle
-    );
+    // sky fills in whatever the scene didn't cover
+    pass = render_graph_add_pass(graph, "sky", [this]() { DrawSky(); });
+    for (uint32_t i = 0; i < GBUFFER_RT_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_RENDER_TARGET, RG_USE_READ | RG_USE_WRITE);
+    }
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_READ);
 
-    for (auto& entity : entities) {
-        std::shared_ptr<Mesh> mesh = entity.get_mesh();
-        std::shared_ptr<Material> material = entity.get_material();
-
-        // transform buffer
-        {
-            TransformBuffer data = {};
-            data.world = entity.get_transform().GetWorldMatrix();
-            data.view = camera->GetView();
-            data.proj = camera->GetProjection();
-            data.wit = entity.get_transform().GetWorldInverseTransposeMatrix();
-
-            D3D12_GPU_DESCRIPTOR_HANDLE handle = Graphics::CBHeapFillNext(&data, sizeof(data));
-            command_list->SetGraphicsRootDescriptorTable(0, handle);
-        }
+    // deferred combine draw
+    pass = render_graph_add_pass(graph, "combine", [=, this]() { DrawCombine(swap_chain_index); });
+    for (uint32_t i = 0; i < GBUFFER_RT_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+    }
+    render_graph_use(graph, pass, back_buffer, RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_READ);
 
-        // material buffer
-        {
-            MaterialBuffer data = {};
-            uint32_t texture_count = material->get_texture_index_count();
-            memcpy(
-                data.packed_texture_indices,
-                material->get_texture_indices(),
-                sizeof(uint32_t) * texture_count
-            );
-            data.texture_index_count = texture_count;
-            data.uv_offset = material->get_uv_offset();
-            data.uv_scale = material->get_uv_scale();
-            data.color_tint = material->get_color_tint();
-
-            D3D12_GPU_DESCRIPTOR_HANDLE handle = Graphics::CBHeapFillNext(&data, sizeof(data));
-            command_list->SetGraphicsRootDescriptorTable(2, handle);
-        }
+    render_graph_compile(graph);
+    Graphics::ExecuteRenderGraph(graph);
 
-        D3D12_VERTEX_BUFFER_VIEW vb_view = mesh->get_vb_view();
-        command_list->IASetVertexBuffers(0, 1, &vb_view);
-        D3D12_INDEX_BUFFER_VIEW ib_view = mesh->get_ib_view();
-        command_list->IASetIndexBuffer(&ib_view);
+    Present();
+}
 
-        command_list->DrawIndexedInstanced(mesh->get_index_count(), 1, 0, 0, 0);
+void Game::DrawGBuffer(const uint32_t* gbuffer) {
+    auto command_list = Graphics::CommandList;
+
+    // views follow whatever targets the graph handed out this frame
+    ID3D12Resource* images[GBUFFER_RT_COUNT];
+    for (uint32_t i = 0; i < GBUFFER_RT_COUNT; i++) {
+        images[i] = static_cast<ID3D12Resource*>(render_graph_native(&render_graph, gbuffer[i]));
     }
+    mrt_bundle_bind(&mrt_bundle, images);
 
-    // draw sky
-    {
-        command_list->SetGraphicsRootSignature(sky_root_signature.Get());
-        command_list->SetPipelineState(sky_pipeline_state.Get());
-
-        // matrix buffer copying
-        SkyMatrixBuffer data = {};
-        data.view = camera->GetView();
-        data.proj = camera->GetProjection();
-        D3D12_GPU_DESCRIPTOR_HANDLE handle = Graphics::CBHeapFillNext(&data, sizeof(data));
-        command_list->SetGraphicsRootDescriptorTable(0, handle);
-
-        // push constants copying wait no push constants are a vulkan
-        //   thing sorry *ROOT* constants (im too used to vulkan lol)
-        command_list->SetGraphicsRoot32BitConstant(1, sky_cubemap_id, 0);
-
-        // bind cube index/vertex buffers...
-        D3D12_VERTEX_BUFFER_VIEW vb_view = cube_mesh->get_vb_view();
-        command_list->IASetVertexBuffers(0, 1, &vb_view);
-        D3D12_INDEX_BUFFER_VIEW ib_view = cube_mesh->get_ib_view();
-        command_list->IASetIndexBuffer(&ib_view);
-
-        // then draw!
-        command_list->DrawIndexedInstanced(cube_mesh->get_index_count(), 1, 0, 0, 0);
+    // clear depth buffer
+    command_list->ClearDepthStencilView(
+        Graphics::DSVHandle,
+        D3D12_CLEAR_FLAG_DEPTH,
+        1.0f,   // clear depth @ 1.0f (max)
+        0,      // don't care ab stencil clear value
+        0,      // no scissor rects
+        nullptr // no scissor rects
+    );
+
+    // clear the MRT targets too !! they might've been something else's
+    //   memory earlier in the frame
+    for (uint32_t i = 0; i < mrt_bundle.count; i++) {
+        command_list->ClearRenderTargetView(
+            mrt_bundle.rtv_descriptors[i],
+            &mrt_bundle.clear_colors[i * 4],
+            0,
+            nullptr
+        );
     }
 
-    // deferred combine draw
-    {
-        // Transition RTs to pixel shader resources
-        for (uint32_t i = 0; i < mrt_bundles[frame_index].count; i++) {
-            D3D12_RESOURCE_BARRIER rb = {};
-            rb.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            rb.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-            rb.Transition.pResource = mrt_bundles[frame_index].images[i].Get();
-            rb.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-            rb.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-            rb.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-            Graphics::CommandList->ResourceBarrier(1, &rb);
-        }
+    // every entity's cost is roughly how many draws it records. this runs
+    //   on the main thread first so transforms get their lazy matrices
+    //   worked out before the workers read them. entities still uploading
+    //   sit this frame out instead of making the GPU wait on them
+    draw_entities.clear();
+    draw_costs.clear();
+    for (uint32_t i = 0; i < (uint32_t)entities.size(); i++) {
+        if (!is_uploaded(entities[i])) continue;
+        entities[i].get_transform().GetWorldMatrix();
+
+        const Mesh* mesh = entities[i].get_mesh().get();
+        bool meshlets = entities[i].get_lod() == 0 && mesh->get_meshlet_count() > 1;
+        draw_entities.push_back(i);
+        draw_costs.push_back(1 + (meshlets ? mesh->get_meshlet_count() : 0));
+    }
+
+    // every list the entities end up in needs the pass's state from scratch
+    auto setup = [this](ID3D12GraphicsCommandList* command_list) {
+        command_list->SetDescriptorHeaps(1, Graphics::CBVSRVDescriptorHeap.GetAddressOf());
+        command_list->RSSetViewports(1, &viewport);
+        command_list->RSSetScissorRects(1, &scissor_rect);
+        command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+        // every material uses this pipeline or its constant ORM version,
+        //   record switches between them
         command_list->SetGraphicsRootSignature(root_signature.Get());
         command_list->SetPipelineState(mrt_pipeline_state.Get());
         command_list->OMSetRenderTargets(
-            1,
-            &Graphics::RTVHandles[frame_index],
+            mrt_bundle.count,
+            mrt_bundle.rtv_descriptors,
             true,
             &Graphics::DSVHandle
         );
+    };
 
-        // copy scene data - ONCE PER FRAME
-        SceneDataBuffer scene_data = {};
-        scene_data.camera_world_pos = camera->GetTransform().GetPosition();
-        scene_data.gamma = GAME_GAMMA;
-        scene_data.light_count = static_cast<uint32_t>(lights.size());
-        scene_data.skybox_cubemap_id = sky_cubemap_id;
-        scene_data.albedo_rt_id = mrt_bundles[frame_index].srv_descriptors[ALBEDO_RT_IDX].bindless_index;
-        scene_data.normals_rt_id = mrt_bundles[frame_index].srv_descriptors[NORMALS_RT_IDX].bindless_index;
-        scene_data.material_rt_id = mrt_bundles[frame_index].srv_descriptors[MATERIAL_RT_IDX].bindless_index;
-        scene_data.world_pos_depth_rt_id = mrt_bundles[frame_index].srv_descriptors[DEPTH_RT_IDX].bindless_index;
-        memcpy(
-            scene_data.lights,
-            lights.data(),
-            sizeof(Light) * lights.size()
-        );
+    // runs on a worker's thread, so only that worker's cbuffer memory &
+    //   meshlet scratch get touched
+    auto record = [this](ID3D12GraphicsCommandList* command_list, uint32_t worker, RecordChunk chunk) {
+        // chunks can follow each other on a list, so the first draw always sets it
+        ID3D12PipelineState* bound_pipeline_state = nullptr;
+        for (uint32_t d = chunk.first; d < chunk.first + chunk.count; d++) {
+            GameEntity& entity = entities[draw_entities[d]];
+            std::shared_ptr<Mesh> mesh = entity.get_mesh();
+            std::shared_ptr<Material> material = entity.get_material();
+
+            ID3D12PipelineState* pipeline_state = material->get_orm_constant_channels() == TEXTURE_CHANNELS_RGB
+                ? mrt_constant_orm_pipeline_state.Get()
+                : mrt_pipeline_state.Get();
+            if (pipeline_state != bound_pipeline_state) {
+                command_list->SetPipelineState(pipeline_state);
+                bound_pipeline_state = pipeline_state;
+            }
+
+            // transform buffer
+            {
+                TransformBuffer data = {};
+                data.world = entity.get_transform().GetWorldMatrix();
+                data.view = camera->GetView();
+                data.proj = camera->GetProjection();
+                data.wit = entity.get_transform().GetWorldInverseTransposeMatrix();
+                data.position_offset = mesh->get_vertex_encode_params().position_offset;
+                data.position_scale = mesh->get_vertex_encode_params().position_scale;
+                data.uv_offset = mesh->get_vertex_encode_params().uv_offset;
+                data.uv_scale = mesh->get_vertex_encode_params().uv_scale;
+
+                D3D12_GPU_VIRTUAL_ADDRESS address = Graphics::CBHeapFillNext(worker, &data, sizeof(data));
+                command_list->SetGraphicsRootConstantBufferView(0, address);
+            }
+
+            // material buffer
+            {
+                MaterialBuffer data = {};
+                uint32_t texture_count = material->get_texture_index_count();
+                memcpy(
+                    data.packed_texture_indices,
+                    material->get_texture_indices(),
+                    sizeof(uint32_t) * texture_count
+                );
+                data.texture_index_count = texture_count;
+                data.uv_offset = material->get_uv_offset();
+                data.uv_scale = material->get_uv_scale();
+                data.color_tint = material->get_color_tint();
+                data.orm_constant = material->get_orm_constant();
+                data.orm_constant_channels = material->get_orm_constant_channels();
+
+                D3D12_GPU_VIRTUAL_ADDRESS address = Graphics::CBHeapFillNext(worker, &data, sizeof(data));
+                command_list->SetGraphicsRootConstantBufferView(2, address);
+            }
+
+            D3D12_VERTEX_BUFFER_VIEW vb_view = mesh->get_vb_view();
+            command_list->IASetVertexBuffers(0, 1, &vb_view);
+            D3D12_INDEX_BUFFER_VIEW ib_view = mesh->get_ib_view();
+            command_list->IASetIndexBuffer(&ib_view);
+
+            // full detail meshes get culled meshlet by meshlet, anything
+            //   coarser is small enough on screen to just draw outright
+            const MeshLod& lod = mesh->get_lod(entity.get_lod());
+            if (entity.get_lod() == 0 && mesh->get_meshlet_count() > 1) {
+                XMFLOAT4X4 world_float = entity.get_transform().GetWorldMatrix();
+                XMFLOAT4X4 view_float = camera->GetView();
+                XMFLOAT4X4 proj_float = camera->GetProjection();
+                XMMATRIX world = XMLoadFloat4x4(&world_float);
+
+                XMFLOAT4X4 world_view_proj;
+                XMStoreFloat4x4(&world_view_proj, world * XMLoadFloat4x4(&view_float) * XMLoadFloat4x4(&proj_float));
+
+                // cone tests happen in object space too
+                XMFLOAT3 camera_position = camera->GetTransform().GetPosition();
+                XMStoreFloat3(&camera_position, XMVector3Transform(XMLoadFloat3(&camera_position), XMMatrixInverse(nullptr, world)));
+
+                MeshletCullParams cull_params = meshlet_cull_params_create(world_view_proj, camera_position);
+                meshlet_cull(mesh->get_meshlets(), mesh->get_meshlet_count(), cull_params, &meshlet_draws[worker]);
+
+                for (const MeshletDraw& draw : meshlet_draws[worker]) {
+                    mesh->draw(command_list, draw.first_index, draw.index_count);
+                }
+            } else {
+                mesh->draw(command_list, lod.first_index, lod.index_count);
+            }
+        }
+    };
 
-        D3D12_GPU_DESCRIPTOR_HANDLE handle = Graphics::CBHeapFillNext(&scene_data, sizeof(scene_data));
-        command_list->SetGraphicsRootDescriptorTable(1, handle);
+    Graphics::RecordParallel(
+        draw_costs.data(),
+        static_cast<uint32_t>(draw_costs.size()),
+        RECORD_CHUNK_MIN_COST,
+        setup,
+        record
+    );
+}
 
-        // TAKE THE MRT SHTUFF AND COMBINE AND RENDER
-        command_list->SetPipelineState(fullscreen_pipeline_state.Get());
-        command_list->DrawInstanced(3, 1, 0, 0);
-    }
+void Game::DrawSky() {
+    auto command_list = Graphics::CommandList;
 
-    Present();
+    // the sky can't just not be there, so the frame waits on it (on the GPU)
+    //   if it's still uploading
+    Graphics::RequireUpload(cube_mesh->get_upload_ticket());
+    Graphics::RequireUpload(Graphics::get_texture_upload_ticket(sky_cubemap_id));
+
+    command_list->SetGraphicsRootSignature(sky_root_signature.Get());
+    command_list->SetPipelineState(sky_pipeline_state.Get());
+
+    // matrix buffer copying
+    SkyMatrixBuffer data = {};
+    data.view = camera->GetView();
+    data.proj = camera->GetProjection();
+    data.position_offset = cube_mesh->get_vertex_encode_params().position_offset;
+    data.position_scale = cube_mesh->get_vertex_encode_params().position_scale;
+    D3D12_GPU_VIRTUAL_ADDRESS address = Graphics::CBHeapFillNext(&data, sizeof(data));
+    command_list->SetGraphicsRootConstantBufferView(0, address);
+
+    // push constants copying wait no push constants are a vulkan
+    //   thing sorry *ROOT* constants (im too used to vulkan lol)
+    command_list->SetGraphicsRoot32BitConstant(1, sky_cubemap_id, 0);
+
+    // bind cube index/vertex buffers...
+    D3D12_VERTEX_BUFFER_VIEW vb_view = cube_mesh->get_vb_view();
+    command_list->IASetVertexBuffers(0, 1, &vb_view);
+    D3D12_INDEX_BUFFER_VIEW ib_view = cube_mesh->get_ib_view();
+    command_list->IASetIndexBuffer(&ib_view);
+
+    // then draw!
+    cube_mesh->draw(command_list.Get(), 0, cube_mesh->get_index_count());
 }
 
-void Game::ClearPrevFrame() {
-    auto current_back_buffer = Graphics::BackBuffers[Graphics::get_swap_chain_index()];
+void Game::DrawCombine(uint32_t swap_chain_index) {
     auto command_list = Graphics::CommandList;
 
-    // transition layout from present to render target layout
-    D3D12_RESOURCE_BARRIER rb = {};
-    rb.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    rb.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    rb.Transition.pResource = current_back_buffer.Get();
-    rb.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-    rb.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-    rb.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    command_list->ResourceBarrier(1, &rb);
-
     // clear main render target
     float color[] = {0.0f, 0.0f, 0.0f, 1.0f};
     command_list->ClearRenderTargetView(
-        Graphics::RTVHandles[Graphics::get_swap_chain_index()],
+        Graphics::RTVHandles[swap_chain_index],
         color,
         0,      // no scissor rects
         nullptr // no scissor rects
     );
 
-    // clear depth buffer
-    command_list->ClearDepthStencilView(
-        Graphics::DSVHandle,
-        D3D12_CLEAR_FLAG_DEPTH,
-        1.0f,   // clear depth @ 1.0f (max)
-        0,      // don't care ab stencil clear value
-        0,      // no scissor rects
-        nullptr // no scissor rects
+    command_list->SetGraphicsRootSignature(root_signature.Get());
+    command_list->SetPipelineState(mrt_pipeline_state.Get());
+    command_list->OMSetRenderTargets(
+        1,
+        &Graphics::RTVHandles[swap_chain_index],
+        true,
+        &Graphics::DSVHandle
     );
 
-    // clear and transition the MRT targets too !!
-    MRTBundle* bundle = &mrt_bundles[Graphics::get_swap_chain_index()];
-    for (uint32_t i = 0; i < bundle->count; i++) {
-        // transition state first
-        rb.Transition.pResource = bundle->images[i].Get();
-        rb.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-        rb.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        command_list->ResourceBarrier(1, &rb);
+    // copy scene data - ONCE PER FRAME
+    SceneDataBuffer scene_data = {};
+    scene_data.camera_world_pos = camera->GetTransform().GetPosition();
+    scene_data.gamma = GAME_GAMMA;
+    scene_data.light_count = static_cast<uint32_t>(lights.size());
+    scene_data.skybox_cubemap_id = sky_cubemap_id;
+    scene_data.albedo_rt_id = mrt_bundle.srv_descriptors[ALBEDO_RT_IDX].bindless_index;
+    scene_data.normals_rt_id = mrt_bundle.srv_descriptors[NORMALS_RT_IDX].bindless_index;
+    scene_data.material_rt_id = mrt_bundle.srv_descriptors[MATERIAL_RT_IDX].bindless_index;
+    scene_data.world_pos_depth_rt_id = mrt_bundle.srv_descriptors[DEPTH_RT_IDX].bindless_index;
+    memcpy(
+        scene_data.lights,
+        lights.data(),
+        sizeof(Light) * lights.size()
+    );
 
-        // then clear
-        command_list->ClearRenderTargetView(
-            bundle->rtv_descriptors[i],
-            &bundle->clear_colors[i * 4],
-            0,
-            nullptr
-        );
-    }
+    D3D12_GPU_VIRTUAL_ADDRESS address = Graphics::CBHeapFillNext(&scene_data, sizeof(scene_data));
+    command_list->SetGraphicsRootConstantBufferView(1, address);
+
+    // TAKE THE MRT SHTUFF AND COMBINE AND RENDER
+    command_list->SetPipelineState(fullscreen_pipeline_state.Get());
+    command_list->DrawInstanced(3, 1, 0, 0);
 }
 
 void Game::Present() {
-    auto current_back_buffer = Graphics::BackBuffers[Graphics::get_swap_chain_index()];
-    auto command_list = Graphics::CommandList;
-
-    // transition back to present state
-    D3D12_RESOURCE_BARRIER rb = {};
-    rb.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    rb.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    rb.Transition.pResource = current_back_buffer.Get();
-    rb.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-    rb.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-    rb.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    command_list->ResourceBarrier(1, &rb);
+    // the graph already put the back buffer back in present state
 
     // IMPORTANT!!!!! actually execute our list <3
     Graphics::CloseAndExecuteCommandList();
@@ -747,7 +881,7 @@ void Game::Present() {
 
     // finalize things and prepare for next frame
     Graphics::AdvanceSwapChainIndex();
-    Graphics::ResetAllocatorAndCommandList(Graphics::get_swap_chain_index());
+    Graphics::ResetAllocatorAndCommandList(Graphics::get_frame_index());
 }
 
 void Game::RandomizeLights() {
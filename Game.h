@@ -7,6 +7,8 @@
 #include "Light.h"
 #include "Graphics.h"
 #include "MRTBundle.h"
+#include "Meshlet.h"
+#include "RenderGraph.h"
 
 constexpr float GAME_GAMMA = 1.4f;
 
@@ -14,6 +16,7 @@ constexpr uint32_t ALBEDO_RT_IDX = 0;
 constexpr uint32_t NORMALS_RT_IDX = 1;
 constexpr uint32_t MATERIAL_RT_IDX = 2;
 constexpr uint32_t DEPTH_RT_IDX = 3;
+constexpr uint32_t GBUFFER_RT_COUNT = 4;
 
 class Game {
    public:
@@ -32,16 +35,21 @@ class Game {
     void CreateMainPipelineStuff();
     void InitSky();
     void SceneInit();
-    void ClearPrevFrame();
+    // the passes Draw puts in the render graph
+    void DrawGBuffer(const uint32_t* gbuffer);
+    void DrawSky();
+    void DrawCombine(uint32_t swap_chain_index);
     void Present();
 
     void RandomizeLights();
 
-    // mrt stuff
-    MRTBundle mrt_bundles[Graphics::NUM_BACK_BUFFERS];
+    // mrt stuff, one G-buffer shared by every frame in flight
+    MRTBundle mrt_bundle;
 
     Microsoft::WRL::ComPtr<ID3D12RootSignature> root_signature;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> mrt_pipeline_state;
+    // same pass for materials whose ORM is flat all over, it never samples it
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> mrt_constant_orm_pipeline_state;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> fullscreen_pipeline_state;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> sky_root_signature;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> sky_pipeline_state;
@@ -54,5 +62,13 @@ class Game {
     std::unique_ptr<Camera> camera;
     std::vector<GameEntity> entities;
     std::vector<Light> lights;
+
+    // reused every frame so culling doesn't allocate, one per recording thread
+    std::vector<MeshletDraw> meshlet_draws[Graphics::MAX_RECORD_WORKERS];
+    // entities whose uploads are done, only those get drawn
+    std::vector<uint32_t> draw_entities;
+    std::vector<uint32_t> draw_costs;
+    // rebuilt every frame, same deal
+    RenderGraph render_graph;
 };
 
@@ -1,10 +1,32 @@
 #include "GameEntity.h"
 
+using namespace DirectX;
+
 GameEntity::GameEntity(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material)
   : mesh(mesh),
-    material(material) { }
+    material(material),
+    lod(0) { }
 
 GameEntity::GameEntity(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material, const Transform& copy_transform)
   : transform(copy_transform),
     mesh(mesh),
-    material(material) { }
+    material(material),
+    lod(0) { }
+
+WorldBounds GameEntity::get_world_bounds() {
+    XMFLOAT4X4 world = transform.GetWorldMatrix();
+    return mesh_bounds_transform(mesh->get_bounds(), XMLoadFloat4x4(&world));
+}
+
+void GameEntity::update_lod(Camera& camera, float screen_height) {
+    WorldBounds bounds = get_world_bounds();
+    float projected_radius = mesh_lod_projected_radius(
+        bounds.sphere_center,
+        bounds.sphere_radius,
+        camera.GetTransform().GetPosition(),
+        camera.GetFov(),
+        screen_height
+    );
+
+    lod = mesh_lod_select(mesh->get_lods(), mesh->get_lod_count(), projected_radius, lod);
+}
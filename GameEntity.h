@@ -3,6 +3,7 @@
 #include "Transform.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "Camera.h"
 #include <memory>
 
 class GameEntity {
@@ -10,6 +11,8 @@ class GameEntity {
     Transform transform;
     std::shared_ptr<Mesh> mesh;
     std::shared_ptr<Material> material;
+    // LOD picked last frame, kept around for hysteresis
+    uint32_t lod;
 
    public:
     GameEntity(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material);
@@ -19,4 +22,11 @@ class GameEntity {
     std::shared_ptr<Mesh> get_mesh() const { return mesh; }
     std::shared_ptr<Material> get_material() const { return material; }
     void set_material(std::shared_ptr<Material> material) { this->material = material; }
+    uint32_t get_lod() const { return lod; }
+
+    // the mesh's bounds moved by this entity's transform (parents included)
+    WorldBounds get_world_bounds();
+
+    // picks this frame's LOD from how big the mesh's bounding sphere is on screen
+    void update_lod(Camera& camera, float screen_height);
 };
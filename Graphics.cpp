@@ -1,8 +1,20 @@
 #include "Graphics.h"
+#include <chrono>
+#include <deque>
 #include <dxgi1_6.h>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <vector>
-#include <WICTextureLoader.h>
-#include <ResourceUploadBatch.h>
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "Parallel.h"
+#include "QueueSync.h"
+#include "TextureCooker.h"
+#include "TextureLoader.h"
+#include "TexturePacker.h"
+#include "UploadRing.h"
 
 // DLL settings!
 extern "C" {
@@ -24,24 +36,216 @@ namespace Graphics {
         bool vsyncDesired = false;
         BOOL isFullscreen = false;
 
-        uint32_t back_buffer_index = 0;
+        uint32_t swap_chain_index = 0;
+        // frames in flight & their fence values, per frame stuff is
+        //   indexed by frame_ring.slot
+        FrameRing frame_ring = {};
 
         D3D_FEATURE_LEVEL featureLevel {};
 
         // descriptor heap management
         size_t cbvsrv_descriptor_heap_increment_size = 0;
-        uint32_t cbv_descriptor_index = 0;
 
-        // cb upload heap management
-        uint64_t cb_upload_heap_size = 0;
-        uint64_t cb_upload_heap_offset = 0;
-        void* cb_upload_heap_start = nullptr;
+        // cb upload heap management, pages [0, MAX_FRAMES_IN_FLIGHT) are the
+        //   heap's per frame partitions, anything past that is a spill page
+        //   with its own buffer
+        struct CBPage {
+            Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+            uint8_t* cpu_address;
+            D3D12_GPU_VIRTUAL_ADDRESS gpu_address;
+        };
+        FrameAllocator cb_allocator;
+        std::vector<CBPage> cb_pages;
+
+        // cbuffers are bound as root CBVs, so the heap is all textures: the
+        //   bindless ones up front, then each frame's transient ones
+        DescriptorAllocator descriptor_allocator;
+        // placed resource memory. tier 1 hardware can't mix buffers, plain
+        //   textures & render/depth targets in one heap, so each gets a pool
+        enum GpuMemoryKind {
+            GPU_MEMORY_BUFFERS,
+            GPU_MEMORY_TEXTURES,
+            GPU_MEMORY_TARGETS,
+            GPU_MEMORY_KIND_COUNT
+        };
+        struct GpuMemoryPool {
+            HeapPool pool;
+            D3D12_HEAP_FLAGS heap_flags;
+            uint64_t heap_alignment;
+            // one per pool block
+            std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> heaps;
+        };
+        GpuMemoryPool gpu_memory[GPU_MEMORY_KIND_COUNT];
+
+        // transient targets, memory & resources mirror transient_pool's
+        //   slots & placements
+        struct TransientMemory {
+            HeapAllocation allocation;
+            std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resources;
+        };
+        TransientPool transient_pool;
+        std::vector<TransientMemory> transient_memory;
+        std::vector<TransientRelease> transient_released;
+
+        // where each placed resource sits, so releasing it can find its spot
+        struct PlacedResource {
+            GpuMemoryKind kind;
+            HeapAllocation allocation;
+        };
+        std::unordered_map<ID3D12Resource*, PlacedResource> placed_resources;
+
+        // draws recorded on other threads. every worker has its own lists,
+        //   allocators & cbuffer pages so the threads never share anything
+        struct RecordWorkerState {
+            PerFrame<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> allocators;
+            std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists;
+            FrameAllocator cb_allocator;
+            std::vector<CBPage> cb_pages;
+        };
+        std::vector<RecordWorkerState> record_workers;
+
+        class D3D12RecordBackend : public RecordBackend {
+           public:
+            void begin_list(const RecordSlot& slot) override {
+                RecordWorkerState& worker = record_workers[slot.worker];
+                ID3D12CommandAllocator* allocator = worker.allocators[slot.allocator].Get();
+                if (slot.reset_allocator) {
+                    allocator->Reset();
+                }
+
+                // new lists start out open
+                if (slot.list < worker.lists.size()) {
+                    worker.lists[slot.list]->Reset(allocator, nullptr);
+                    return;
+                }
+                worker.lists.emplace_back();
+                Device->CreateCommandList(
+                    0,
+                    D3D12_COMMAND_LIST_TYPE_DIRECT,
+                    allocator,
+                    nullptr,
+                    IID_PPV_ARGS(worker.lists.back().GetAddressOf())
+                );
+            }
+
+            void end_list(const RecordSlot& slot) override {
+                record_workers[slot.worker].lists[slot.list]->Close();
+            }
+
+            void submit(const RecordSlot* slots, uint32_t count) override;
+        };
+        D3D12RecordBackend record_backend;
+        ParallelRecorder recorder;
+
+        // CommandList is primary_list until RecordParallel moves it on to a
+        //   continuation. closed lists wait in frame_lists so the whole
+        //   frame goes out in one ExecuteCommandLists
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> primary_list;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> continuation_lists;
+        uint32_t continuation_lists_used = 0;
+        std::vector<ID3D12CommandList*> frame_lists;
+
+        void D3D12RecordBackend::submit(const RecordSlot* slots, uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+                frame_lists.push_back(record_workers[slots[i].worker].lists[slots[i].list].Get());
+            }
+        }
 
-        // texture descriptors start AFTER the cbuffer descriptors
-        uint32_t srv_descriptor_offset = MAX_CBUFFERS;
         // these textures will freaking die if we don't save pointers to em
         //   (auto destruction with snart pointers)
         std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+
+        // the upload ring's window into the queue, signaled after every upload batch
+        class QueueUploadFence : public UploadFence {
+           public:
+            Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+            HANDLE event = 0;
+
+            uint64_t get_completed_value() override { return fence->GetCompletedValue(); }
+            void wait(uint64_t value) override {
+                if (fence->GetCompletedValue() < value) {
+                    fence->SetEventOnCompletion(value, event);
+                    WaitForSingleObject(event, INFINITE);
+                }
+            }
+        };
+
+        // the direct queue holding off until the copy queue's got somewhere
+        class DirectQueueWaiter : public QueueWaiter {
+           public:
+            void wait(uint64_t value) override;
+        };
+
+        // batched upload management, the batches go out on their own copy
+        //   queue so they run alongside rendering. frames only wait on the
+        //   upload fence values of what they read, see RequireUpload
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> copy_queue;
+        QueueUploadFence upload_fence;
+        uint64_t upload_fence_counter = 0;
+        // last thing the CPU saw the upload fence at, saves asking every check
+        uint64_t upload_completed_value = 0;
+        DirectQueueWaiter direct_queue_waiter;
+        QueueSync upload_sync;
+        UploadRing upload_ring = {};
+        Microsoft::WRL::ComPtr<ID3D12Resource> upload_ring_buffer;
+        uint8_t* upload_ring_start = nullptr;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> upload_list;
+        bool upload_list_open = false;
+
+        // allocators in the order their batches went out, each one can be
+        //   reset once its batch is done
+        struct UploadAllocator {
+            Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+            uint64_t fence_value;
+        };
+        std::deque<UploadAllocator> upload_allocators;
+
+        // upload destinations & one-off staging buffers can't die before
+        //   the batch touching them is done
+        struct UploadKeepAlive {
+            Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+            uint64_t fence_value;
+        };
+        std::deque<UploadKeepAlive> upload_keep_alive;
+
+        void DirectQueueWaiter::wait(uint64_t value) {
+            CommandQueue->Wait(upload_fence.fence.Get(), value);
+        }
+
+        // what each bindless texture slot's upload signals, for get_texture_upload_ticket
+        std::vector<UploadTicket> texture_upload_tickets;
+
+        void set_texture_upload_ticket(uint32_t index, UploadTicket ticket) {
+            if (index >= texture_upload_tickets.size()) {
+                texture_upload_tickets.resize(index + 1, UploadTicket{ 0 });
+            }
+            texture_upload_tickets[index] = ticket;
+        }
+
+        // same thing for get_texture_constant
+        std::vector<TextureConstant> texture_constants;
+
+        void set_texture_constant(uint32_t index, TextureConstant constant) {
+            if (index >= texture_constants.size()) {
+                texture_constants.resize(index + 1, TextureConstant{});
+            }
+            texture_constants[index] = constant;
+        }
+
+        // the 1x1 every collapsed texture of a value shares, by packed value,
+        //   & the upload that fills it (everything sharing it waits on that)
+        struct ConstantTexture {
+            ID3D12Resource* resource;
+            UploadTicket ticket;
+        };
+        std::unordered_map<uint32_t, ConstantTexture> constant_textures;
+        TextureLoadStats texture_load_stats = {};
+
+        // frame ring timestamps, only ever compared with each other
+        double get_seconds() {
+            std::chrono::duration<double> since = std::chrono::steady_clock::now().time_since_epoch();
+            return since.count();
+        }
     }
 }
 
@@ -61,7 +265,48 @@ std::wstring Graphics::get_api_name() {
 }
 
 uint32_t Graphics::get_swap_chain_index() {
-    return back_buffer_index;
+    return swap_chain_index;
+}
+
+uint32_t Graphics::get_frame_index() {
+    return frame_ring.slot;
+}
+
+uint32_t Graphics::get_frames_in_flight() {
+    return frame_ring.requested_count;
+}
+
+FrameLatencyStats Graphics::get_frame_latency_stats() {
+    return frame_ring.stats;
+}
+
+FrameAllocatorStats Graphics::get_cb_allocator_stats() {
+    return cb_allocator.stats;
+}
+
+uint32_t Graphics::get_record_worker_count() {
+    return recorder.worker_count;
+}
+
+ParallelRecorderStats Graphics::get_record_stats() {
+    return recorder.stats;
+}
+
+DescriptorAllocatorStats Graphics::get_descriptor_stats() {
+    return descriptor_allocator.stats;
+}
+
+HeapPoolStats Graphics::get_gpu_memory_stats() {
+    HeapPoolStats total = {};
+    for (const GpuMemoryPool& memory : gpu_memory) {
+        total.block_count += memory.pool.stats.block_count;
+        total.reserved_bytes += memory.pool.stats.reserved_bytes;
+        total.used_bytes += memory.pool.stats.used_bytes;
+        total.allocation_count += memory.pool.stats.allocation_count;
+        total.pending_frees += memory.pool.stats.pending_frees;
+        total.dedicated_block_count += memory.pool.stats.dedicated_block_count;
+    }
+    return total;
 }
 
 // --------------------------------------------------------
@@ -140,8 +385,8 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 
     // COMMAND ALLOCATORS AND QUEUES AND POOLS AND oh wait pools are vulkan nvm
     {
-        // allocators
-        for (uint32_t i = 0; i < NUM_BACK_BUFFERS; i++) {
+        // allocators, enough for the most frames in flight there can be
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             Device->CreateCommandAllocator(
                 D3D12_COMMAND_LIST_TYPE_DIRECT,
                 IID_PPV_ARGS(CommandAllocators[i].GetAddressOf())
@@ -156,6 +401,14 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
             &queue_desc, IID_PPV_ARGS(CommandQueue.GetAddressOf())
         );
 
+        // uploads get a queue of their own
+        D3D12_COMMAND_QUEUE_DESC copy_queue_desc = {};
+        copy_queue_desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        copy_queue_desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        Device->CreateCommandQueue(
+            &copy_queue_desc, IID_PPV_ARGS(copy_queue.GetAddressOf())
+        );
+
         // list
         Device->CreateCommandList(
             0,                              // which GPU will this be attached to (0 for single GPU setup)
@@ -164,6 +417,22 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
             nullptr,                        // pipeline state (we don't have one yet <3)
             IID_PPV_ARGS(CommandList.GetAddressOf())
         );
+        primary_list = CommandList;
+
+        // recording threads, the main one included
+        uint32_t worker_count = std::thread::hardware_concurrency();
+        worker_count = worker_count < MAX_RECORD_WORKERS ? worker_count : MAX_RECORD_WORKERS;
+        worker_count = worker_count > 0 ? worker_count : 1;
+        record_workers.resize(worker_count);
+        for (RecordWorkerState& worker : record_workers) {
+            for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                Device->CreateCommandAllocator(
+                    D3D12_COMMAND_LIST_TYPE_DIRECT,
+                    IID_PPV_ARGS(worker.allocators[i].GetAddressOf())
+                );
+            }
+        }
+        parallel_recorder_create(&recorder, worker_count, MAX_FRAMES_IN_FLIGHT, &record_backend);
     }
 
     // HOOOLY SWAP CHAIN !!!
@@ -205,7 +474,16 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 
         Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(FrameFence.GetAddressOf()));
         FrameFenceEvent = CreateEventEx(0, 0, 0, EVENT_ALL_ACCESS);
-        memset(FrameFenceCounters, 0, sizeof(FrameFenceCounters));
+        // the first frame has to signal something the fence isn't already at,
+        //   or whatever waits on it thinks it's done before it starts
+        frame_ring_create(&frame_ring, DEFAULT_FRAMES_IN_FLIGHT, 1, get_seconds());
+        parallel_recorder_begin_frame(&recorder, frame_ring.slot);
+
+        Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(upload_fence.fence.GetAddressOf()));
+        upload_fence.event = CreateEventEx(0, 0, 0, EVENT_ALL_ACCESS);
+        upload_fence_counter = 0;
+        upload_completed_value = 0;
+        queue_sync_create(&upload_sync);
     }
 
     // we're done with all the basic API stuff
@@ -225,6 +503,25 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
         Device->CreateDescriptorHeap(&dsv_heap_desc, IID_PPV_ARGS(DSVHeap.GetAddressOf()));
     }
 
+    // placed resource pools, heaps get made as they fill up. buffers are
+    //   always 64KB aligned, small textures can go down to 4KB & targets
+    //   get 4MB aligned heaps in case they're multisampled
+    {
+        heap_pool_create(&gpu_memory[GPU_MEMORY_BUFFERS].pool, GPU_HEAP_BLOCK_SIZE, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        gpu_memory[GPU_MEMORY_BUFFERS].heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        gpu_memory[GPU_MEMORY_BUFFERS].heap_alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        heap_pool_create(&gpu_memory[GPU_MEMORY_TEXTURES].pool, GPU_HEAP_BLOCK_SIZE, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+        gpu_memory[GPU_MEMORY_TEXTURES].heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+        gpu_memory[GPU_MEMORY_TEXTURES].heap_alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        heap_pool_create(&gpu_memory[GPU_MEMORY_TARGETS].pool, GPU_HEAP_BLOCK_SIZE, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        gpu_memory[GPU_MEMORY_TARGETS].heap_flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        gpu_memory[GPU_MEMORY_TARGETS].heap_alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        transient_pool_create(&transient_pool, TRANSIENT_RELEASE_FRAMES);
+    }
+
     // create initial buffers at the end of setup
     ResizeBuffers(windowWidth, windowHeight);
 
@@ -232,15 +529,13 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
     {
         // upload heap
         {
-            cb_upload_heap_size = (uint64_t)MAX_CBUFFERS * 256;
-
             D3D12_RESOURCE_DESC desc = {};
             desc.Alignment = 0;
             desc.DepthOrArraySize = 1;
             desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
             desc.Flags = D3D12_RESOURCE_FLAG_NONE;
             desc.Format = DXGI_FORMAT_UNKNOWN;
-            desc.Width = cb_upload_heap_size,
+            desc.Width = CB_FRAME_BUDGET * MAX_FRAMES_IN_FLIGHT,
             desc.Height = 1; // assuming this is a regular buffer and not a tex
             desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
             desc.MipLevels = 1;
@@ -263,8 +558,65 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
                 IID_PPV_ARGS(CBUploadHeap.GetAddressOf())
             );
 
+            void* cb_upload_heap_start = nullptr;
             D3D12_RANGE range = {0, 0};
             CBUploadHeap->Map(0, &range, &cb_upload_heap_start);
+
+            // one partition per frame in flight, the first frame starts now
+            frame_allocator_create(
+                &cb_allocator,
+                CB_FRAME_BUDGET,
+                D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
+                MAX_FRAMES_IN_FLIGHT
+            );
+            cb_pages.resize(MAX_FRAMES_IN_FLIGHT);
+            for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                cb_pages[i].cpu_address = static_cast<uint8_t*>(cb_upload_heap_start) + CB_FRAME_BUDGET * i;
+                cb_pages[i].gpu_address = CBUploadHeap->GetGPUVirtualAddress() + CB_FRAME_BUDGET * i;
+            }
+            frame_allocator_begin_frame(&cb_allocator, frame_ring.fence_value, FrameFence->GetCompletedValue());
+
+            // workers' pages get made the first time they're written to
+            for (RecordWorkerState& worker : record_workers) {
+                frame_allocator_create(&worker.cb_allocator, CB_WORKER_PAGE_SIZE, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, 0);
+                frame_allocator_begin_frame(&worker.cb_allocator, frame_ring.fence_value, FrameFence->GetCompletedValue());
+            }
+        }
+
+        // staging ring for uploads, stays mapped forever
+        {
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Alignment = 0;
+            desc.DepthOrArraySize = 1;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Width = UPLOAD_RING_SIZE;
+            desc.Height = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.MipLevels = 1;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+
+            D3D12_HEAP_PROPERTIES heap_props = {};
+            heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            heap_props.CreationNodeMask = 1;
+            heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            heap_props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            heap_props.VisibleNodeMask = 1;
+
+            Device->CreateCommittedResource(
+                &heap_props,
+                D3D12_HEAP_FLAG_NONE,
+                &desc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                IID_PPV_ARGS(upload_ring_buffer.GetAddressOf())
+            );
+
+            D3D12_RANGE range = {0, 0};
+            upload_ring_buffer->Map(0, &range, reinterpret_cast<void**>(&upload_ring_start));
+            upload_ring_create(&upload_ring, UPLOAD_RING_SIZE, &upload_fence);
         }
 
         // descriptor heap
@@ -272,10 +624,13 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
             D3D12_DESCRIPTOR_HEAP_DESC desc = {};
             desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
             desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-            desc.NumDescriptors = MAX_CBUFFERS + MAX_TEXTURE_DESCRIPTORS;
+            desc.NumDescriptors = MAX_TEXTURE_DESCRIPTORS + MAX_FRAME_DESCRIPTORS * MAX_FRAMES_IN_FLIGHT;
 
             Device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(CBVSRVDescriptorHeap.GetAddressOf()));
 
+            descriptor_allocator_create(&descriptor_allocator, MAX_TEXTURE_DESCRIPTORS, MAX_FRAME_DESCRIPTORS, MAX_FRAMES_IN_FLIGHT);
+            descriptor_allocator_begin_frame(&descriptor_allocator, frame_ring.slot);
+
             cbvsrv_descriptor_heap_increment_size =
                 (size_t)Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         }
@@ -296,6 +651,8 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 // APIs might need more explicit clean up.
 // --------------------------------------------------------
 void Graphics::ShutDown() {
+    // the recording threads have to be joined before they get destroyed
+    parallel_recorder_destroy(&recorder);
 }
 
 // --------------------------------------------------------
@@ -346,7 +703,7 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height) {
 
     // now we recreate the depth buffer !
     {
-        DepthBuffer.Reset();
+        ReleasePlacedResource(&DepthBuffer);
 
         // depth create info
         D3D12_RESOURCE_DESC depth_desc = {};
@@ -368,23 +725,8 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height) {
         clear_value.DepthStencil.Depth = 1.0f;
         clear_value.DepthStencil.Stencil = 0;
 
-        // describe heap that the resource will live in <3
-        D3D12_HEAP_PROPERTIES heap_props = {};
-        heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heap_props.CreationNodeMask = 1;
-        heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heap_props.Type = D3D12_HEAP_TYPE_DEFAULT;
-        heap_props.VisibleNodeMask = 1;
-
-        // make the resource itself !!!
-        Device->CreateCommittedResource(
-            &heap_props,
-            D3D12_HEAP_FLAG_NONE,
-            &depth_desc,
-            D3D12_RESOURCE_STATE_DEPTH_WRITE,
-            &clear_value,
-            IID_PPV_ARGS(DepthBuffer.GetAddressOf())
-        );
+        // make the resource itself !!! it shares a heap with the other targets
+        CreatePlacedResource(&depth_desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &clear_value, &DepthBuffer);
 
         // aaaaand finally create the view for our new resource
         DSVHandle = DSVHeap->GetCPUDescriptorHandleForHeapStart();
@@ -395,45 +737,436 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height) {
         );
     }
 
-    // reset/grab states
-    back_buffer_index = 0;
+    // reset/grab states. the new buffers start over at 0, the frame slot
+    //   doesn't care about the swap chain so it just carries on
+    swap_chain_index = 0;
     SwapChain->GetFullscreenState(&isFullscreen, nullptr);
 
     // wait for GPU to finish work <3
     WaitForGPU();
 }
 
+void Graphics::SetFramesInFlight(uint32_t count) {
+    frame_ring_set_count(&frame_ring, count);
+}
+
 void Graphics::AdvanceSwapChainIndex() {
     // signal current fence value!
-    uint64_t current_fence_counter = FrameFenceCounters[back_buffer_index];
-    CommandQueue->Signal(FrameFence.Get(), current_fence_counter);
+    CommandQueue->Signal(FrameFence.Get(), frame_ring_submit(&frame_ring));
+
+    // everything this frame put in cbuffers is the GPU's until that signal lands
+    frame_allocator_end_frame(&cb_allocator);
+    for (RecordWorkerState& worker : record_workers) {
+        frame_allocator_end_frame(&worker.cb_allocator);
+    }
 
-    // get next index
-    back_buffer_index = (back_buffer_index + 1) % NUM_BACK_BUFFERS;
+    // get next index, flip model presents go round the buffers in order
+    swap_chain_index = (swap_chain_index + 1) % NUM_BACK_BUFFERS;
 
-    // wait for next frame to be done if necessary
-    if (FrameFence->GetCompletedValue() < FrameFenceCounters[back_buffer_index]) {
-        FrameFence->SetEventOnCompletion(FrameFenceCounters[back_buffer_index], FrameFenceEvent);
+    // wait for the next frame slot to be done if necessary, that's all
+    //   that keeps the CPU from getting too far ahead
+    uint64_t wait_value = frame_ring_advance(&frame_ring);
+    if (FrameFence->GetCompletedValue() < wait_value) {
+        double wait_start = get_seconds();
+        FrameFence->SetEventOnCompletion(wait_value, FrameFenceEvent);
         WaitForSingleObject(FrameFenceEvent, INFINITE);
+        frame_ring_stalled(&frame_ring, get_seconds() - wait_start);
     }
+    uint64_t completed_value = FrameFence->GetCompletedValue();
+    frame_ring_retire(&frame_ring, completed_value, get_seconds());
 
-    // update the counter since we know the frame is done waiting by now!
-    FrameFenceCounters[back_buffer_index] = current_fence_counter + 1;
+    // the slot's free, its frame signals the next value up
+    frame_allocator_begin_frame(&cb_allocator, frame_ring.fence_value, completed_value);
+    for (RecordWorkerState& worker : record_workers) {
+        frame_allocator_begin_frame(&worker.cb_allocator, frame_ring.fence_value, completed_value);
+    }
+    // the workers' allocators for this slot are free too
+    parallel_recorder_begin_frame(&recorder, frame_ring.slot);
+
+    // same goes for descriptors, anything released by frames the GPU's
+    //   finished can be handed out again
+    descriptor_allocator_retire(&descriptor_allocator, completed_value);
+    descriptor_allocator_begin_frame(&descriptor_allocator, frame_ring.slot);
+
+    // and heap space of released placed resources
+    for (GpuMemoryPool& memory : gpu_memory) {
+        heap_pool_retire(&memory.pool, completed_value);
+    }
+
+    // transient targets idle for longer than any frame in flight can be
+    //   dropped outright, their heap space still waits on the fence
+    transient_released.clear();
+    transient_pool_begin_frame(&transient_pool, &transient_released);
+    for (const TransientRelease& release : transient_released) {
+        TransientMemory& memory = transient_memory[release.slot];
+        if (release.placement == TRANSIENT_NONE) {
+            heap_pool_free(&gpu_memory[GPU_MEMORY_TARGETS].pool, memory.allocation, frame_ring.fence_value);
+            memory.resources.clear();
+        } else {
+            memory.resources[release.placement].Reset();
+        }
+    }
 }
 
-Microsoft::WRL::ComPtr<ID3D12Resource> Graphics::CreateStaticBuffer(size_t data_stride, uint32_t data_count, const void* data) {
-    // create local allocator and list for one-time use
-    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> command_allocator;
-    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> command_list;
-    Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(command_allocator.GetAddressOf()));
-    Device->CreateCommandList(
-        0,
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        command_allocator.Get(),
-        nullptr,
-        IID_PPV_ARGS(command_list.GetAddressOf())
+namespace Graphics {
+    namespace {
+        GpuMemoryKind get_gpu_memory_kind(const D3D12_RESOURCE_DESC* desc) {
+            if (desc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+                return GPU_MEMORY_BUFFERS;
+            }
+            if (desc->Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+                return GPU_MEMORY_TARGETS;
+            }
+            return GPU_MEMORY_TEXTURES;
+        }
+
+        // size & alignment of desc once placed. small textures can sit at
+        //   4KB instead of 64KB, but only if the driver says so for this
+        //   exact desc, out_desc gets whichever alignment it agreed to
+        D3D12_RESOURCE_ALLOCATION_INFO get_placement_info(
+            GpuMemoryKind kind,
+            const D3D12_RESOURCE_DESC* desc,
+            D3D12_RESOURCE_DESC* out_desc
+        ) {
+            *out_desc = *desc;
+            D3D12_RESOURCE_ALLOCATION_INFO info = {};
+            if (kind == GPU_MEMORY_TEXTURES && desc->SampleDesc.Count == 1) {
+                out_desc->Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+                info = Device->GetResourceAllocationInfo(0, 1, out_desc);
+                if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+                    out_desc->Alignment = 0;
+                }
+            }
+            if (out_desc->Alignment == 0) {
+                info = Device->GetResourceAllocationInfo(0, 1, out_desc);
+            }
+            return info;
+        }
+
+        HeapAllocation allocate_gpu_memory(GpuMemoryKind kind, uint64_t size, uint64_t alignment) {
+            GpuMemoryPool& memory = gpu_memory[kind];
+            HeapAllocation allocation = {};
+            heap_pool_allocate(&memory.pool, size, alignment, &allocation);
+
+            // the pool grew a block, back it with a heap
+            while (memory.heaps.size() < memory.pool.blocks.size()) {
+                uint64_t block_size = memory.pool.blocks[memory.heaps.size()].size;
+
+                D3D12_HEAP_DESC heap_desc = {};
+                heap_desc.SizeInBytes = (block_size + memory.heap_alignment - 1) & ~(memory.heap_alignment - 1);
+                heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+                heap_desc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+                heap_desc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+                heap_desc.Properties.CreationNodeMask = 1;
+                heap_desc.Properties.VisibleNodeMask = 1;
+                heap_desc.Alignment = memory.heap_alignment;
+                heap_desc.Flags = memory.heap_flags;
+
+                Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+                Device->CreateHeap(&heap_desc, IID_PPV_ARGS(heap.GetAddressOf()));
+                memory.heaps.push_back(heap);
+            }
+            return allocation;
+        }
+    }
+}
+
+HRESULT Graphics::CreatePlacedResource(
+    const D3D12_RESOURCE_DESC* desc,
+    D3D12_RESOURCE_STATES initial_state,
+    const D3D12_CLEAR_VALUE* clear_value,
+    Microsoft::WRL::ComPtr<ID3D12Resource>* out_resource
+) {
+    GpuMemoryKind kind = get_gpu_memory_kind(desc);
+    D3D12_RESOURCE_DESC placed_desc = {};
+    D3D12_RESOURCE_ALLOCATION_INFO info = get_placement_info(kind, desc, &placed_desc);
+    HeapAllocation allocation = allocate_gpu_memory(kind, info.SizeInBytes, info.Alignment);
+
+    GpuMemoryPool& memory = gpu_memory[kind];
+    HRESULT result = Device->CreatePlacedResource(
+        memory.heaps[allocation.block].Get(),
+        allocation.offset,
+        &placed_desc,
+        initial_state,
+        clear_value,
+        IID_PPV_ARGS(out_resource->GetAddressOf())
     );
+    if (FAILED(result)) {
+        // nothing on the GPU ever saw it, so it can go back right away
+        heap_pool_free_now(&memory.pool, allocation);
+        return result;
+    }
+
+    placed_resources[out_resource->Get()] = { kind, allocation };
+    return S_OK;
+}
+
+void Graphics::ReleasePlacedResource(Microsoft::WRL::ComPtr<ID3D12Resource>* resource) {
+    auto placed = placed_resources.find(resource->Get());
+    if (placed != placed_resources.end()) {
+        heap_pool_free(
+            &gpu_memory[placed->second.kind].pool,
+            placed->second.allocation,
+            frame_ring.fence_value
+        );
+        placed_resources.erase(placed);
+    }
+    resource->Reset();
+}
+
+Graphics::TransientTarget Graphics::AcquireTransientTarget(
+    const D3D12_RESOURCE_DESC* desc,
+    const D3D12_CLEAR_VALUE* clear_value,
+    D3D12_RESOURCE_STATES initial_state
+) {
+    D3D12_RESOURCE_DESC placed_desc = {};
+    D3D12_RESOURCE_ALLOCATION_INFO info = get_placement_info(GPU_MEMORY_TARGETS, desc, &placed_desc);
+
+    TransientKey key = { (uint32_t)desc->Format, (uint32_t)desc->Width, desc->Height, (uint32_t)desc->Flags };
+    TransientAcquire acquired = transient_pool_acquire(&transient_pool, key, info.SizeInBytes, info.Alignment);
+
+    if (acquired.slot >= transient_memory.size()) {
+        transient_memory.resize(acquired.slot + 1);
+    }
+    TransientMemory& memory = transient_memory[acquired.slot];
+    if (acquired.allocate) {
+        memory.allocation = allocate_gpu_memory(GPU_MEMORY_TARGETS, info.SizeInBytes, info.Alignment);
+        memory.resources.clear();
+    }
+    if (acquired.placement >= memory.resources.size()) {
+        memory.resources.resize(acquired.placement + 1);
+    }
+
+    Microsoft::WRL::ComPtr<ID3D12Resource>& resource = memory.resources[acquired.placement];
+    if (acquired.create) {
+        resource.Reset();
+        HRESULT result = Device->CreatePlacedResource(
+            gpu_memory[GPU_MEMORY_TARGETS].heaps[memory.allocation.block].Get(),
+            memory.allocation.offset,
+            &placed_desc,
+            initial_state,
+            clear_value,
+            IID_PPV_ARGS(resource.GetAddressOf())
+        );
+        // a null target would only show up as a crash somewhere in the graph
+        if (FAILED(result)) {
+            throw std::runtime_error("Error creating transient target: CreatePlacedResource failed");
+        }
+    }
+
+    return { resource.Get(), acquired.create, acquired.aliased };
+}
 
+void Graphics::ReleaseTransientTarget(ID3D12Resource* resource) {
+    for (uint32_t s = 0; s < (uint32_t)transient_memory.size(); s++) {
+        for (auto& placed : transient_memory[s].resources) {
+            if (placed.Get() == resource) {
+                transient_pool_release(&transient_pool, s);
+                return;
+            }
+        }
+    }
+}
+
+TransientPoolStats Graphics::get_transient_stats() {
+    return transient_pool.stats;
+}
+
+namespace Graphics {
+    namespace {
+        class D3D12RenderGraphDevice : public RenderGraphDevice {
+           public:
+            void* acquire_transient(const RenderGraphTextureDesc& desc, bool* out_aliased) override {
+                D3D12_RESOURCE_DESC resource_desc = {};
+                resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+                resource_desc.Width = desc.width;
+                resource_desc.Height = desc.height;
+                resource_desc.DepthOrArraySize = 1;
+                resource_desc.MipLevels = 1;
+                resource_desc.Format = (DXGI_FORMAT)desc.format;
+                resource_desc.SampleDesc.Count = 1;
+                resource_desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+                resource_desc.Flags = (D3D12_RESOURCE_FLAGS)desc.flags;
+
+                D3D12_CLEAR_VALUE clear = {};
+                clear.Format = resource_desc.Format;
+                if (desc.flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) {
+                    clear.DepthStencil.Depth = desc.clear_color[0];
+                } else {
+                    memcpy(clear.Color, desc.clear_color, sizeof(float) * 4);
+                }
+
+                TransientTarget target = AcquireTransientTarget(
+                    &resource_desc,
+                    &clear,
+                    (D3D12_RESOURCE_STATES)desc.initial_state
+                );
+                *out_aliased = target.aliased;
+                return target.resource;
+            }
+
+            void release_transient(void* native) override {
+                ReleaseTransientTarget(static_cast<ID3D12Resource*>(native));
+            }
+
+            void resource_barriers(const RenderGraphBarrier* barriers, void* const* natives, uint32_t count) override {
+                d3d_barriers.resize(count);
+                for (uint32_t i = 0; i < count; i++) {
+                    D3D12_RESOURCE_BARRIER& rb = d3d_barriers[i];
+                    rb = {};
+                    if (barriers[i].before == RENDER_GRAPH_NONE) {
+                        rb.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                        rb.Aliasing.pResourceBefore = nullptr;
+                        rb.Aliasing.pResourceAfter = static_cast<ID3D12Resource*>(natives[i]);
+                    } else {
+                        rb.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                        rb.Transition.pResource = static_cast<ID3D12Resource*>(natives[i]);
+                        rb.Transition.StateBefore = (D3D12_RESOURCE_STATES)barriers[i].before;
+                        rb.Transition.StateAfter = (D3D12_RESOURCE_STATES)barriers[i].after;
+                        rb.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                    }
+                }
+                CommandList->ResourceBarrier(count, d3d_barriers.data());
+            }
+
+           private:
+            std::vector<D3D12_RESOURCE_BARRIER> d3d_barriers;
+        };
+
+        D3D12RenderGraphDevice render_graph_device;
+    }
+}
+
+void Graphics::ExecuteRenderGraph(RenderGraph* graph) {
+    render_graph_execute(graph, &render_graph_device);
+}
+
+namespace Graphics {
+    namespace {
+        // where one upload's bytes sit before the copy, in the ring
+        //   or in a one-off buffer if it didn't fit
+        struct StagingSpace {
+            ID3D12Resource* resource;
+            uint64_t offset;
+            uint8_t* cpu_address;
+        };
+
+        // everything recorded right now goes out with the next flush
+        UploadTicket pending_upload_ticket() {
+            return { upload_fence_counter + 1 };
+        }
+
+        void keep_alive_until_uploaded(ID3D12Resource* resource) {
+            upload_keep_alive.push_back({ resource, pending_upload_ticket().fence_value });
+        }
+
+        void release_finished_uploads() {
+            uint64_t completed = upload_fence.get_completed_value();
+            upload_completed_value = completed;
+            while (!upload_keep_alive.empty() && upload_keep_alive.front().fence_value <= completed) {
+                upload_keep_alive.pop_front();
+            }
+            upload_ring_retire(&upload_ring);
+        }
+
+        ID3D12GraphicsCommandList* open_upload_list() {
+            if (upload_list_open) {
+                return upload_list.Get();
+            }
+
+            // oldest allocator is free once its batch is done, otherwise
+            //   make another (there's only ever a few batches in flight)
+            Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+            if (!upload_allocators.empty() &&
+                upload_allocators.front().fence_value <= upload_fence.get_completed_value()) {
+                allocator = upload_allocators.front().allocator;
+                upload_allocators.pop_front();
+                allocator->Reset();
+            } else {
+                Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(allocator.GetAddressOf()));
+            }
+
+            if (upload_list) {
+                upload_list->Reset(allocator.Get(), nullptr);
+            } else {
+                Device->CreateCommandList(
+                    0,
+                    D3D12_COMMAND_LIST_TYPE_COPY,
+                    allocator.Get(),
+                    nullptr,
+                    IID_PPV_ARGS(upload_list.GetAddressOf())
+                );
+            }
+
+            // fence value gets filled in when the batch goes out
+            upload_allocators.push_back({ allocator, 0 });
+            upload_list_open = true;
+            return upload_list.Get();
+        }
+
+        StagingSpace reserve_staging(uint64_t size, uint64_t alignment) {
+            if (size <= UPLOAD_RING_SIZE) {
+                uint64_t offset = 0;
+                bool reserved = upload_ring_allocate(&upload_ring, size, alignment, &offset);
+
+                // the batch we're still filling is in the way, send it off
+                //   and wait for the space behind it instead
+                if (!reserved && upload_ring_has_open_batch(&upload_ring)) {
+                    FlushUploads();
+                    reserved = upload_ring_allocate(&upload_ring, size, alignment, &offset);
+                }
+
+                if (reserved) {
+                    return { upload_ring_buffer.Get(), offset, upload_ring_start + offset };
+                }
+            }
+
+            // too big for the whole ring, this one gets its own buffer
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Alignment = 0;
+            desc.DepthOrArraySize = 1;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Width = size;
+            desc.Height = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.MipLevels = 1;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+
+            D3D12_HEAP_PROPERTIES heap_props = {};
+            heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            heap_props.CreationNodeMask = 1;
+            heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            heap_props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            heap_props.VisibleNodeMask = 1;
+
+            Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+            Device->CreateCommittedResource(
+                &heap_props,
+                D3D12_HEAP_FLAG_NONE,
+                &desc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                IID_PPV_ARGS(buffer.GetAddressOf())
+            );
+
+            void* mapped = nullptr;
+            D3D12_RANGE range = {0, 0};
+            buffer->Map(0, &range, &mapped);
+            keep_alive_until_uploaded(buffer.Get());
+            return { buffer.Get(), 0, static_cast<uint8_t*>(mapped) };
+        }
+    }
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> Graphics::CreateStaticBuffer(
+    size_t data_stride,
+    uint32_t data_count,
+    const void* data,
+    UploadTicket* out_ticket
+) {
     D3D12_RESOURCE_DESC desc = {};
     desc.Alignment = 0;
     desc.DepthOrArraySize = 1;
@@ -447,159 +1180,775 @@ Microsoft::WRL::ComPtr<ID3D12Resource> Graphics::CreateStaticBuffer(size_t data_
     desc.SampleDesc.Count = 1;
     desc.SampleDesc.Quality = 0;
 
-    // create our output buffer
+    // create our output buffer, placed in the shared buffer heaps
     Microsoft::WRL::ComPtr<ID3D12Resource> output_buffer;
-    {
-        D3D12_HEAP_PROPERTIES heap_props = {};
-        heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heap_props.CreationNodeMask = 1;
-        heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heap_props.Type = D3D12_HEAP_TYPE_DEFAULT;
-        heap_props.VisibleNodeMask = 1;
-
-        Device->CreateCommittedResource(
-            &heap_props,
-            D3D12_HEAP_FLAG_NONE,
-            &desc,
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr,
-            IID_PPV_ARGS(output_buffer.GetAddressOf())
-        );
+    CreatePlacedResource(&desc, D3D12_RESOURCE_STATE_COMMON, nullptr, &output_buffer);
+
+    // the data rides along with the next upload batch, no waiting on the GPU here!
+    UploadTicket ticket = UploadBuffer(output_buffer.Get(), 0, data, desc.Width);
+    if (out_ticket) {
+        *out_ticket = ticket;
     }
+    return output_buffer;
+}
 
-    // create our staging/upload buffer
-    Microsoft::WRL::ComPtr<ID3D12Resource> upload_buffer;
-    {
-        D3D12_HEAP_PROPERTIES heap_props = {};
-        heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heap_props.CreationNodeMask = 1;
-        heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heap_props.Type = D3D12_HEAP_TYPE_UPLOAD;
-        heap_props.VisibleNodeMask = 1;
-
-        Device->CreateCommittedResource(
-            &heap_props,
-            D3D12_HEAP_FLAG_NONE,
-            &desc,
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(upload_buffer.GetAddressOf())
-        );
+Graphics::UploadTicket Graphics::UploadBuffer(
+    ID3D12Resource* buffer,
+    uint64_t buffer_offset,
+    const void* data,
+    uint64_t size
+) {
+    StagingSpace staging = reserve_staging(size, 16);
+    memcpy(staging.cpu_address, data, size);
+
+    // buffer sits in COMMON (or decayed back to it), the copy promotes it to
+    //   COPY_DEST & it decays back once the batch is done. the direct queue
+    //   promotes it to whatever it reads it as from there, no barriers needed
+    ID3D12GraphicsCommandList* list = open_upload_list();
+    list->CopyBufferRegion(buffer, buffer_offset, staging.resource, staging.offset, size);
+
+    keep_alive_until_uploaded(buffer);
+    return pending_upload_ticket();
+}
+
+Graphics::UploadTicket Graphics::UploadTexture(
+    ID3D12Resource* texture,
+    uint32_t first_subresource,
+    uint32_t subresource_count,
+    const D3D12_SUBRESOURCE_DATA* data
+) {
+    // where each subresource's rows have to go, relative to the staging start
+    D3D12_RESOURCE_DESC desc = texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(subresource_count);
+    std::vector<UINT> row_counts(subresource_count);
+    std::vector<UINT64> row_sizes(subresource_count);
+    UINT64 total_size = 0;
+    Device->GetCopyableFootprints(
+        &desc,
+        first_subresource,
+        subresource_count,
+        0,
+        footprints.data(),
+        row_counts.data(),
+        row_sizes.data(),
+        &total_size
+    );
+
+    StagingSpace staging = reserve_staging(total_size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+    // rows get repacked to the GPU's row pitch on the way in
+    for (uint32_t s = 0; s < subresource_count; s++) {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = footprints[s].Footprint;
+        uint8_t* dest = staging.cpu_address + footprints[s].Offset;
+        const uint8_t* src = static_cast<const uint8_t*>(data[s].pData);
+
+        for (uint32_t z = 0; z < footprint.Depth; z++) {
+            uint8_t* dest_slice = dest + (uint64_t)footprint.RowPitch * row_counts[s] * z;
+            const uint8_t* src_slice = src + data[s].SlicePitch * z;
+            for (uint32_t row = 0; row < row_counts[s]; row++) {
+                memcpy(
+                    dest_slice + (uint64_t)footprint.RowPitch * row,
+                    src_slice + data[s].RowPitch * row,
+                    (size_t)row_sizes[s]
+                );
+            }
+        }
     }
 
-    // map buffer, copy data
-    void* mapped = nullptr;
-    upload_buffer->Map(0, nullptr, &mapped);
-    memcpy(mapped, data, data_stride * data_count);
-    upload_buffer->Unmap(0, nullptr);
+    ID3D12GraphicsCommandList* list = open_upload_list();
+    for (uint32_t s = 0; s < subresource_count; s++) {
+        D3D12_TEXTURE_COPY_LOCATION dest_location = {};
+        dest_location.pResource = texture;
+        dest_location.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dest_location.SubresourceIndex = first_subresource + s;
 
-    // copy staging buffer data to return buffer
-    command_list->CopyResource(output_buffer.Get(), upload_buffer.Get());
+        D3D12_TEXTURE_COPY_LOCATION src_location = {};
+        src_location.pResource = staging.resource;
+        src_location.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        src_location.PlacedFootprint = footprints[s];
+        src_location.PlacedFootprint.Offset += staging.offset;
 
-    // transition return buffer state to one that's optimal for shader reading
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    barrier.Transition.pResource = output_buffer.Get();
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    command_list->ResourceBarrier(1, &barrier);
+        list->CopyTextureRegion(&dest_location, 0, 0, 0, &src_location, nullptr);
+    }
 
-    // close and submit command list for execution
-    command_list->Close();
-    ID3D12CommandList* list = command_list.Get();
-    CommandQueue->ExecuteCommandLists(1, &list);
+    // copy queues can't transition to anything a shader reads, the texture
+    //   decays to COMMON once the batch is done & gets promoted from there
+    keep_alive_until_uploaded(texture);
+    return pending_upload_ticket();
+}
 
-    // wait for work to finish and return our new buffer :D
-    WaitForGPU();
-    return output_buffer;
+Graphics::UploadTicket Graphics::FlushUploads() {
+    if (upload_list_open) {
+        upload_list->Close();
+        ID3D12CommandList* list = upload_list.Get();
+        copy_queue->ExecuteCommandLists(1, &list);
+
+        // signal after everything in the batch so the ticket covers all of it
+        upload_fence_counter++;
+        copy_queue->Signal(upload_fence.fence.Get(), upload_fence_counter);
+        queue_sync_signaled(&upload_sync, upload_fence_counter);
+        upload_ring_close_batch(&upload_ring, upload_fence_counter);
+        upload_allocators.back().fence_value = upload_fence_counter;
+        upload_list_open = false;
+
+        release_finished_uploads();
+    }
+
+    return { upload_fence_counter };
+}
+
+bool Graphics::IsUploadDone(UploadTicket ticket) {
+    if (ticket.fence_value <= upload_completed_value) {
+        return true;
+    }
+    upload_completed_value = upload_fence.get_completed_value();
+    return ticket.fence_value <= upload_completed_value;
 }
 
-D3D12_GPU_DESCRIPTOR_HANDLE Graphics::CBHeapFillNext(const void* data, size_t size) {
-    // ensure multiples of 256
-    size_t reservation_size = (size + 255) / 256 * 256;
+void Graphics::RequireUpload(UploadTicket ticket) {
+    queue_sync_require(&upload_sync, ticket.fence_value);
+}
+
+Graphics::UploadTicket Graphics::get_texture_upload_ticket(uint32_t index) {
+    return index < texture_upload_tickets.size() ? texture_upload_tickets[index] : UploadTicket{ 0 };
+}
+
+TextureConstant Graphics::get_texture_constant(uint32_t index) {
+    return index < texture_constants.size() ? texture_constants[index] : TextureConstant{};
+}
+
+QueueSyncStats Graphics::get_upload_sync_stats() {
+    return upload_sync.stats;
+}
+
+Graphics::TextureLoadStats Graphics::get_texture_load_stats() {
+    return texture_load_stats;
+}
 
-    if (cb_upload_heap_offset + (uint64_t)reservation_size >= cb_upload_heap_size) {
-        cb_upload_heap_offset = 0;
+void Graphics::WaitForUpload(UploadTicket ticket) {
+    // still sitting in the open batch? send it off first or we'd wait forever
+    if (ticket.fence_value > upload_fence_counter) {
+        FlushUploads();
     }
+    upload_fence.wait(ticket.fence_value);
+    release_finished_uploads();
+}
+
+namespace Graphics {
+    namespace {
+        // spill pages live in their own mapped upload buffers
+        CBPage create_cb_page(uint64_t size) {
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Alignment = 0;
+            desc.DepthOrArraySize = 1;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Width = size;
+            desc.Height = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.MipLevels = 1;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
 
-    D3D12_GPU_VIRTUAL_ADDRESS virtual_gpu_addr =
-        CBUploadHeap->GetGPUVirtualAddress() + cb_upload_heap_offset;
+            D3D12_HEAP_PROPERTIES heap_props = {};
+            heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            heap_props.CreationNodeMask = 1;
+            heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            heap_props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            heap_props.VisibleNodeMask = 1;
 
-    // copy data to heap
-    {
-        void* dest = reinterpret_cast<void*>((char*)cb_upload_heap_start + cb_upload_heap_offset);
-        memcpy(dest, data, size);
-        cb_upload_heap_offset += (uint64_t)reservation_size;
+            CBPage page = {};
+            Device->CreateCommittedResource(
+                &heap_props,
+                D3D12_HEAP_FLAG_NONE,
+                &desc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                IID_PPV_ARGS(page.buffer.GetAddressOf())
+            );
+
+            void* mapped = nullptr;
+            D3D12_RANGE range = {0, 0};
+            page.buffer->Map(0, &range, &mapped);
+            page.cpu_address = static_cast<uint8_t*>(mapped);
+            page.gpu_address = page.buffer->GetGPUVirtualAddress();
+            return page;
+        }
     }
+}
 
-    // create a CBV for this section
-    {
-        D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle = CBVSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-        D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle = CBVSRVDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
+D3D12_GPU_VIRTUAL_ADDRESS Graphics::CBHeapFillNext(const void* data, size_t size) {
+    FrameAllocation allocation = frame_allocator_allocate(&cb_allocator, (uint64_t)size);
 
-        cpu_handle.ptr += ((size_t)cbv_descriptor_index * cbvsrv_descriptor_heap_increment_size);
-        gpu_handle.ptr += ((size_t)cbv_descriptor_index * cbvsrv_descriptor_heap_increment_size);
+    // this frame outgrew everything we had, back the new page with a buffer
+    while (cb_pages.size() < cb_allocator.pages.size()) {
+        cb_pages.push_back(create_cb_page(cb_allocator.pages[cb_pages.size()].size));
+    }
+
+    // copy data to heap, no view needed since it's bound as a root CBV
+    memcpy(cb_pages[allocation.page].cpu_address + allocation.offset, data, size);
+    return cb_pages[allocation.page].gpu_address + allocation.offset;
+}
 
-        D3D12_CONSTANT_BUFFER_VIEW_DESC desc = {};
-        desc.BufferLocation = virtual_gpu_addr;
-        desc.SizeInBytes = (UINT)reservation_size;
+D3D12_GPU_VIRTUAL_ADDRESS Graphics::CBHeapFillNext(uint32_t worker, const void* data, size_t size) {
+    RecordWorkerState& state = record_workers[worker];
+    FrameAllocation allocation = frame_allocator_allocate(&state.cb_allocator, (uint64_t)size);
 
-        Device->CreateConstantBufferView(&desc, cpu_handle);
+    // only this worker's thread ever touches its pages
+    while (state.cb_pages.size() < state.cb_allocator.pages.size()) {
+        state.cb_pages.push_back(create_cb_page(state.cb_allocator.pages[state.cb_pages.size()].size));
+    }
 
-        cbv_descriptor_index++;
-        cbv_descriptor_index %= MAX_CBUFFERS;
+    memcpy(state.cb_pages[allocation.page].cpu_address + allocation.offset, data, size);
+    return state.cb_pages[allocation.page].gpu_address + allocation.offset;
+}
 
-        return gpu_handle;
+void Graphics::RecordParallel(
+    const uint32_t* costs,
+    uint32_t count,
+    uint64_t min_chunk_cost,
+    const std::function<void(ID3D12GraphicsCommandList*)>& setup,
+    const std::function<void(ID3D12GraphicsCommandList*, uint32_t worker, RecordChunk chunk)>& record
+) {
+    // nothing to spread around, CommandList still ends up set up the same
+    if (count == 0) {
+        setup(CommandList.Get());
+        return;
     }
+
+    // everything recorded so far runs before the chunks
+    CommandList->Close();
+    frame_lists.push_back(CommandList.Get());
+
+    parallel_recorder_record(&recorder, costs, count, min_chunk_cost, [&](const RecordSlot& slot, RecordChunk chunk) {
+        ID3D12GraphicsCommandList* list = record_workers[slot.worker].lists[slot.list].Get();
+        setup(list);
+        record(list, slot.worker, chunk);
+    });
+
+    // & everything after runs after them. the frame's allocator is fine to
+    //   share since only one of its lists is ever open at a time
+    ID3D12CommandAllocator* allocator = CommandAllocators[frame_ring.slot].Get();
+    if (continuation_lists_used < continuation_lists.size()) {
+        continuation_lists[continuation_lists_used]->Reset(allocator, nullptr);
+    } else {
+        continuation_lists.emplace_back();
+        Device->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator,
+            nullptr,
+            IID_PPV_ARGS(continuation_lists.back().GetAddressOf())
+        );
+    }
+    CommandList = continuation_lists[continuation_lists_used++];
+    setup(CommandList.Get());
 }
 
-uint32_t Graphics::LoadTexture(const wchar_t* file, bool generate_mips) {
-    // create texture
-
-    DirectX::ResourceUploadBatch upload(Device.Get());
-    upload.Begin();
-
-    Microsoft::WRL::ComPtr<ID3D12Resource> texture;
-    DirectX::CreateWICTextureFromFile(
-        Device.Get(),
-        upload,
-        file,
-        texture.GetAddressOf(),
-        generate_mips
-    );
+namespace Graphics {
+    namespace {
+        // every texture we ship is a PNG, & this one runs anywhere
+        PngImageDecoder png_decoder;
+
+        // mapped_file_open takes ANSI paths
+        std::string narrow_path(const wchar_t* path) {
+            int size = WideCharToMultiByte(CP_ACP, 0, path, -1, nullptr, 0, nullptr, nullptr);
+            std::string result(size > 1 ? size - 1 : 0, '\0');
+            if (size > 1) {
+                WideCharToMultiByte(CP_ACP, 0, path, -1, result.data(), size, nullptr, nullptr);
+            }
+            return result;
+        }
+
+        uint64_t placement_align(uint64_t size) {
+            return (size + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~(uint64_t)(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+        }
+
+        // a batch of images decoded with their mips, laid out the way the
+        //   copies want them & waiting to go into staging
+        struct DecodedTextures {
+            std::vector<TextureLoadJob> jobs;
+            // where each job starts in pixels, & in the staging block later
+            std::vector<uint64_t> offsets;
+            std::unique_ptr<uint8_t[]> pixels;
+            uint64_t size;
+        };
+
+        // decodes every file across threads. upload heaps are write combined
+        //   & making mips means reading the level above back, so this all
+        //   happens in plain memory & goes into staging with one memcpy.
+        //   anything that won't load comes out white (1x1 if it didn't
+        //   even have a readable header) so there's always a texture
+        void decode_textures(const char* const* paths, uint32_t count, bool generate_mips, DecodedTextures* out_decoded) {
+            std::vector<MappedFile> files(count);
+            out_decoded->jobs.assign(count, TextureLoadJob{});
+            for (uint32_t i = 0; i < count; i++) {
+                TextureLoadJob& job = out_decoded->jobs[i];
+                if (mapped_file_open(paths[i], &files[i])) {
+                    job.data = files[i].data;
+                    job.size = files[i].size;
+                }
+                job.generate_mips = generate_mips;
+            }
+            texture_batch_prepare(
+                out_decoded->jobs.data(),
+                count,
+                &png_decoder,
+                D3D12_TEXTURE_DATA_PITCH_ALIGNMENT,
+                D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+            );
+
+            out_decoded->offsets.resize(count);
+            out_decoded->size = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                TextureLoadJob& job = out_decoded->jobs[i];
+                if (!job.ok) {
+                    texture_layout_compute(
+                        1, 1, 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, &job.layout
+                    );
+                }
+                out_decoded->offsets[i] = out_decoded->size;
+                out_decoded->size += (job.layout.size + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1)
+                    & ~(uint64_t)(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+            }
+
+            out_decoded->pixels = std::make_unique<uint8_t[]>(out_decoded->size);
+            for (uint32_t i = 0; i < count; i++) {
+                out_decoded->jobs[i].staging = out_decoded->pixels.get() + out_decoded->offsets[i];
+            }
+
+            TextureBatchStats stats = {};
+            texture_batch_decode(out_decoded->jobs.data(), count, &png_decoder, &stats);
+
+            for (uint32_t i = 0; i < count; i++) {
+                TextureLoadJob& job = out_decoded->jobs[i];
+                job.data = nullptr;
+                mapped_file_close(&files[i]);
+                if (!job.ok) {
+                    memset(job.staging, 0xff, (size_t)job.layout.size);
+                }
+            }
+
+            texture_load_stats.decoded_count += stats.texture_count;
+            texture_load_stats.failed_count += stats.failed_count;
+            texture_load_stats.decode_seconds += stats.decode_seconds;
+            texture_load_stats.mip_seconds += stats.mip_seconds;
+            texture_load_stats.decode_wall_seconds += stats.wall_seconds;
+        }
+
+        // same as decode_textures, but each texture gets packed (occlusion,
+        //   roughness, metal) from the maps OrmSources found for it. every
+        //   map decodes in one batch, then the packing & mips for each
+        //   texture go to their own thread. a texture with a map that
+        //   wouldn't load still gets built (white where that map was) but
+        //   isn't ok, so it never gets cooked
+        void pack_orm_textures(const OrmSources* sources, uint32_t count, bool generate_mips, DecodedTextures* out_decoded) {
+            std::vector<const char*> map_paths;
+            std::vector<int32_t> map_indices(count * ORM_CHANNEL_COUNT, -1);
+            for (uint32_t i = 0; i < count; i++) {
+                for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+                    if (sources[i].paths[c].empty()) continue;
+                    map_indices[i * ORM_CHANNEL_COUNT + c] = (int32_t)map_paths.size();
+                    map_paths.push_back(sources[i].paths[c].c_str());
+                }
+            }
+            DecodedTextures maps;
+            decode_textures(map_paths.data(), (uint32_t)map_paths.size(), false, &maps);
+
+            std::vector<PackSource> pack_sources(count * ORM_CHANNEL_COUNT, PackSource{});
+            out_decoded->jobs.assign(count, TextureLoadJob{});
+            out_decoded->offsets.resize(count);
+            out_decoded->size = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                TextureLoadJob& job = out_decoded->jobs[i];
+                job.ok = true;
+                for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+                    int32_t map = map_indices[i * ORM_CHANNEL_COUNT + c];
+                    if (map < 0) continue;
+                    const TextureLoadJob& map_job = maps.jobs[map];
+                    const TextureMip& top = map_job.layout.mips[0];
+                    pack_sources[i * ORM_CHANNEL_COUNT + c] = { map_job.staging + top.offset, top.width, top.height, top.row_pitch };
+                    job.ok = job.ok && map_job.ok;
+                }
+
+                uint32_t width;
+                uint32_t height;
+                orm_pack_size(&pack_sources[i * ORM_CHANNEL_COUNT], &width, &height);
+                texture_layout_compute(
+                    width,
+                    height,
+                    generate_mips ? 0 : 1,
+                    D3D12_TEXTURE_DATA_PITCH_ALIGNMENT,
+                    D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT,
+                    &job.layout
+                );
+                out_decoded->offsets[i] = out_decoded->size;
+                out_decoded->size += placement_align(job.layout.size);
+            }
+
+            out_decoded->pixels = std::make_unique<uint8_t[]>(out_decoded->size);
+            std::vector<TexturePackStats> stats(count);
+            parallel_for(count, [&](uint32_t i) {
+                TextureLoadJob& job = out_decoded->jobs[i];
+                job.staging = out_decoded->pixels.get() + out_decoded->offsets[i];
+                texture_pack_orm(&pack_sources[i * ORM_CHANNEL_COUNT], job.staging, job.layout.mips[0].row_pitch, &stats[i]);
+                texture_generate_mips(job.staging, job.layout);
+            });
+
+            for (uint32_t i = 0; i < count; i++) {
+                texture_load_stats.orm_pack_seconds += stats[i].seconds;
+            }
+            texture_load_stats.orm_packed_count += count;
+        }
+
+        // scans the top level of everything that loaded & collapses the
+        //   fully flat ones to 1x1 in place, before they get cooked or
+        //   uploaded. out_constants gets what was found for each
+        void collapse_constant_textures(DecodedTextures* decoded, TextureConstant* out_constants) {
+            uint32_t count = (uint32_t)decoded->jobs.size();
+            std::vector<TextureUniformity> uniformities(count);
+            std::vector<uint64_t> original_sizes(count);
+            parallel_for(count, [&](uint32_t i) {
+                TextureLoadJob& job = decoded->jobs[i];
+                out_constants[i] = {};
+                original_sizes[i] = job.layout.size;
+                if (!job.ok) return;
+
+                const TextureMip& top = job.layout.mips[0];
+                texture_uniformity_scan(job.staging + top.offset, top.width, top.height, top.row_pitch, &uniformities[i]);
+                out_constants[i] = texture_constant_from(uniformities[i]);
+                if (out_constants[i].channels == TEXTURE_CHANNELS_ALL) {
+                    texture_collapse(
+                        job.staging,
+                        out_constants[i],
+                        D3D12_TEXTURE_DATA_PITCH_ALIGNMENT,
+                        D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT,
+                        &job.layout
+                    );
+                }
+            });
+
+            for (uint32_t i = 0; i < count; i++) {
+                if (!decoded->jobs[i].ok || out_constants[i].channels != TEXTURE_CHANNELS_ALL) continue;
+                texture_load_stats.collapsed_count++;
+                texture_load_stats.collapsed_bytes += original_sizes[i] - decoded->jobs[i].layout.size;
+            }
+        }
 
-    auto finish = upload.End(CommandQueue.Get());
-    finish.wait();
+        // one staging block & copies for every level of every job. job i's
+        //   levels go to textures[i] starting at first_subresources[i], jobs
+        //   without a texture already went up some other way & get skipped
+        UploadTicket upload_decoded(
+            const DecodedTextures& decoded,
+            ID3D12Resource* const* textures,
+            const uint32_t* first_subresources
+        ) {
+            uint64_t size = 0;
+            for (uint32_t i = 0; i < (uint32_t)decoded.jobs.size(); i++) {
+                size += textures[i] ? placement_align(decoded.jobs[i].layout.size) : 0;
+            }
+            // nothing recorded, so nothing to wait for either
+            if (size == 0) {
+                return { upload_fence_counter };
+            }
+            StagingSpace staging = reserve_staging(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+            ID3D12GraphicsCommandList* list = open_upload_list();
+            uint64_t offset = 0;
+            for (uint32_t i = 0; i < (uint32_t)decoded.jobs.size(); i++) {
+                if (!textures[i]) continue;
+                const TextureLayout& layout = decoded.jobs[i].layout;
+                memcpy(staging.cpu_address + offset, decoded.pixels.get() + decoded.offsets[i], (size_t)layout.size);
+
+                for (uint32_t m = 0; m < layout.mip_count; m++) {
+                    const TextureMip& mip = layout.mips[m];
+
+                    D3D12_TEXTURE_COPY_LOCATION dest_location = {};
+                    dest_location.pResource = textures[i];
+                    dest_location.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    dest_location.SubresourceIndex = first_subresources[i] + m;
+
+                    D3D12_TEXTURE_COPY_LOCATION src_location = {};
+                    src_location.pResource = staging.resource;
+                    src_location.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                    src_location.PlacedFootprint.Offset = staging.offset + offset + mip.offset;
+                    src_location.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+                    src_location.PlacedFootprint.Footprint.Width = mip.width;
+                    src_location.PlacedFootprint.Footprint.Height = mip.height;
+                    src_location.PlacedFootprint.Footprint.Depth = 1;
+                    src_location.PlacedFootprint.Footprint.RowPitch = mip.row_pitch;
+
+                    list->CopyTextureRegion(&dest_location, 0, 0, 0, &src_location, nullptr);
+                }
+                offset += placement_align(layout.size);
+
+                if (i == 0 || textures[i] != textures[i - 1]) {
+                    keep_alive_until_uploaded(textures[i]);
+                }
+            }
+            return pending_upload_ticket();
+        }
+
+        Microsoft::WRL::ComPtr<ID3D12Resource> create_texture_2d(
+            uint32_t width,
+            uint32_t height,
+            uint32_t mip_count,
+            DXGI_FORMAT format
+        ) {
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Alignment = 0;
+            desc.DepthOrArraySize = 1;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            desc.Format = format;
+            desc.Width = width;
+            desc.Height = height;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            desc.MipLevels = (UINT16)mip_count;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+
+            // made in COMMON with every level there, the copy queue fills them
+            //   in & the direct queue promotes them to whatever it reads them as
+            Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+            CreatePlacedResource(&desc, D3D12_RESOURCE_STATE_COMMON, nullptr, &texture);
+
+            // save snart pointer so it doesn't get cleaned up out of scope
+            textures.push_back(texture);
+            return texture;
+        }
 
-    // save snart pointer so it doesn't get cleaned up out of scope
-    textures.push_back(texture);
+        // a cooked texture's levels go up straight out of the mapping
+        UploadTicket upload_cooked(const CookedTexture& cooked, ID3D12Resource* texture) {
+            D3D12_SUBRESOURCE_DATA levels[TEXTURE_MAX_MIPS] = {};
+            for (uint32_t m = 0; m < cooked.mip_count; m++) {
+                uint32_t width = cooked.width >> m > 0 ? cooked.width >> m : 1;
+                uint32_t height = cooked.height >> m > 0 ? cooked.height >> m : 1;
+                levels[m].pData = cooked.mips[m];
+                levels[m].RowPitch = texture_format_row_pitch(cooked.format, width);
+                levels[m].SlicePitch = levels[m].RowPitch * texture_format_row_count(cooked.format, height);
+            }
+            return UploadTexture(texture, 0, cooked.mip_count, levels);
+        }
+    }
+}
 
-    // save and incrememnt index
-    uint32_t srv_index = srv_descriptor_offset;
-    srv_descriptor_offset++;
+void Graphics::LoadTextures(const char* const* files, uint32_t count, uint32_t* out_indices, bool generate_mips) {
+    // bindless slots first, they don't depend on anything being decoded
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> cpu_handles(count);
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> gpu_handles(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!ReserveDescriptorHeapSlot(&cpu_handles[i], &gpu_handles[i])) {
+            // hand back what this call got before running out
+            for (uint32_t r = 0; r < i; r++) ReleaseDescriptorHeapSlot(gpu_handles[r]);
+            throw std::runtime_error("Error loading textures: the bindless descriptor heap is out of slots");
+        }
+        out_indices[i] = get_descriptor_index(gpu_handles[i]);
+    }
 
-    // create SRV for our texture using our index in the heap
-    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle = CBVSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    cpu_handle.ptr += ((size_t)srv_index * cbvsrv_descriptor_heap_increment_size);
-    Device->CreateShaderResourceView(texture.Get(), nullptr, cpu_handle);
+    // anything with an up to date .dds next to it skips decoding entirely.
+    //   an "_orm" texture that isn't on disk gets packed from its maps,
+    //   which stand in for its source when checking the .dds
+    std::vector<CookedTexture> cooked(count);
+    std::vector<bool> is_cooked(count, false);
+    std::vector<uint64_t> source_hashes(count, 0);
+    std::vector<uint32_t> stale;
+    std::vector<const char*> stale_files;
+    std::vector<uint32_t> stale_packed;
+    std::vector<OrmSources> pack_sources;
+    for (uint32_t i = 0; i < count; i++) {
+        MappedFile source;
+        OrmSources orm_sources;
+        bool packed = false;
+        if (mapped_file_open(files[i], &source)) {
+            source_hashes[i] = texture_source_hash(source.data, source.size);
+            mapped_file_close(&source);
+        } else if (orm_sources_find(files[i], &orm_sources)) {
+            source_hashes[i] = orm_sources_hash(orm_sources);
+            packed = true;
+        }
+        if (source_hashes[i] != 0) {
+            is_cooked[i] = cooked_texture_open(
+                cooked_texture_path(files[i]).c_str(),
+                source_hashes[i],
+                texture_role_from_path(files[i]),
+                generate_mips,
+                &cooked[i]
+            );
+        }
+        if (is_cooked[i]) continue;
+        if (packed) {
+            stale_packed.push_back(i);
+            pack_sources.push_back(orm_sources);
+        } else {
+            stale.push_back(i);
+            stale_files.push_back(files[i]);
+        }
+    }
 
+    // the rest get decoded (or packed) together & cooked for next time. not
+    //   being able to write the cache isn't fatal, those go up as plain RGBA8
+    std::vector<TextureConstant> constants(count, TextureConstant{});
+    auto collapse = [&](const std::vector<uint32_t>& indices, DecodedTextures* built) {
+        std::vector<TextureConstant> built_constants(indices.size());
+        collapse_constant_textures(built, built_constants.data());
+        for (uint32_t s = 0; s < (uint32_t)indices.size(); s++) {
+            constants[indices[s]] = built_constants[s];
+        }
+    };
+    DecodedTextures decoded;
+    if (!stale.empty()) {
+        decode_textures(stale_files.data(), (uint32_t)stale.size(), generate_mips, &decoded);
+        collapse(stale, &decoded);
+    }
+    DecodedTextures packed;
+    if (!stale_packed.empty()) {
+        pack_orm_textures(pack_sources.data(), (uint32_t)stale_packed.size(), generate_mips, &packed);
+        collapse(stale_packed, &packed);
+    }
+
+    std::vector<ID3D12Resource*> targets(count, nullptr);
+    std::vector<UploadTicket> tickets(count, UploadTicket{ 0 });
+    std::vector<DXGI_FORMAT> formats(count, DXGI_FORMAT_R8G8B8A8_UNORM);
+    std::vector<uint32_t> mip_counts(count, 1);
+    auto cook_and_upload = [&](const std::vector<uint32_t>& indices, const DecodedTextures& built) {
+        std::vector<ID3D12Resource*> built_targets(indices.size(), nullptr);
+        std::vector<uint32_t> first_subresources(indices.size(), 0);
+        for (uint32_t s = 0; s < (uint32_t)indices.size(); s++) {
+            uint32_t i = indices[s];
+            const TextureLoadJob& job = built.jobs[s];
+            if (job.ok) {
+                std::string cooked_path = cooked_texture_path(files[i]);
+                uint32_t role = texture_role_from_path(files[i]);
+                TextureCookStats cook_stats = {};
+                bool cooked_ok = cooked_texture_write(
+                    cooked_path.c_str(), source_hashes[i], role, job.staging, job.layout, constants[i], &cook_stats
+                );
+                texture_load_stats.cooked_count += cooked_ok ? 1 : 0;
+                texture_load_stats.cook_failed_count += cooked_ok ? 0 : 1;
+                texture_load_stats.cook_seconds += cook_stats.compress.seconds;
+
+                is_cooked[i] = cooked_ok && cooked_texture_open(cooked_path.c_str(), source_hashes[i], role, generate_mips, &cooked[i]);
+            }
+            if (is_cooked[i]) continue;
+
+            // a flat one that already has a 1x1 around doesn't go up at all
+            uint32_t value = texture_constant_pack(constants[i]);
+            bool shared = constants[i].channels == TEXTURE_CHANNELS_ALL;
+            auto existing = constant_textures.find(value);
+            if (shared && existing != constant_textures.end()) {
+                targets[i] = existing->second.resource;
+                continue;
+            }
+            built_targets[s] = create_texture_2d(
+                job.layout.mips[0].width,
+                job.layout.mips[0].height,
+                job.layout.mip_count,
+                DXGI_FORMAT_R8G8B8A8_UNORM
+            ).Get();
+            targets[i] = built_targets[s];
+            mip_counts[i] = job.layout.mip_count;
+            if (shared) {
+                constant_textures[value] = { targets[i], UploadTicket{ 0 } };
+            }
+        }
+
+        // 1x1s made here only get their ticket once the batch is recorded,
+        //   anything sharing one (made here or earlier) waits on its upload
+        UploadTicket built_ticket = upload_decoded(built, built_targets.data(), first_subresources.data());
+        for (uint32_t s = 0; s < (uint32_t)indices.size(); s++) {
+            uint32_t i = indices[s];
+            if (is_cooked[i] || !built_targets[s]) continue;
+            tickets[i] = built_ticket;
+            if (constants[i].channels == TEXTURE_CHANNELS_ALL) {
+                constant_textures[texture_constant_pack(constants[i])].ticket = built_ticket;
+            }
+        }
+        for (uint32_t s = 0; s < (uint32_t)indices.size(); s++) {
+            uint32_t i = indices[s];
+            if (is_cooked[i] || built_targets[s]) continue;
+            tickets[i] = constant_textures[texture_constant_pack(constants[i])].ticket;
+        }
+    };
+
+    // everything rides along in the open upload batch
+    cook_and_upload(stale, decoded);
+    cook_and_upload(stale_packed, packed);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!is_cooked[i]) continue;
+        constants[i] = cooked[i].constant;
+        formats[i] = (DXGI_FORMAT)texture_format_dxgi(cooked[i].format);
+        mip_counts[i] = cooked[i].mip_count;
+
+        // cooked 1x1s are RGBA8 like the ones made above, so they share too
+        uint32_t value = texture_constant_pack(constants[i]);
+        bool shared = constants[i].channels == TEXTURE_CHANNELS_ALL;
+        auto existing = constant_textures.find(value);
+        if (shared && existing != constant_textures.end()) {
+            targets[i] = existing->second.resource;
+            tickets[i] = existing->second.ticket;
+        } else {
+            targets[i] = create_texture_2d(cooked[i].width, cooked[i].height, cooked[i].mip_count, formats[i]).Get();
+            tickets[i] = upload_cooked(cooked[i], targets[i]);
+            if (shared) {
+                constant_textures[value] = { targets[i], tickets[i] };
+            }
+        }
+        cooked_texture_close(&cooked[i]);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        set_texture_upload_ticket(out_indices[i], tickets[i]);
+        set_texture_constant(out_indices[i], constants[i]);
+
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+        srv_desc.Format = formats[i];
+        srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv_desc.Texture2D.MipLevels = mip_counts[i];
+
+        // create SRV for our texture using our index in the heap
+        Device->CreateShaderResourceView(targets[i], &srv_desc, cpu_handles[i]);
+    }
+}
+
+uint32_t Graphics::LoadTexture(const wchar_t* file, bool generate_mips) {
+    std::string path = narrow_path(file);
+    const char* paths[1] = { path.c_str() };
+    uint32_t srv_index = 0;
+    LoadTextures(paths, 1, &srv_index, generate_mips);
     return srv_index;
 }
 
 void Graphics::ResetAllocatorAndCommandList(uint32_t index) {
     CommandAllocators[index]->Reset();
+    CommandList = primary_list;
+    continuation_lists_used = 0;
     CommandList->Reset(CommandAllocators[index].Get(), nullptr);
 }
 
 void Graphics::CloseAndExecuteCommandList() {
+    // anything this frame reads has to be on its way, then the direct queue
+    //   waits for exactly that much of the copy queue & nothing more
+    FlushUploads();
+    queue_sync_submit(&upload_sync, &upload_fence, &direct_queue_waiter);
+
+    // the whole frame in one go, lists recorded on other threads included
     CommandList->Close();
-    ID3D12CommandList* list = CommandList.Get();
-    CommandQueue->ExecuteCommandLists(1, &list);
+    frame_lists.push_back(CommandList.Get());
+    CommandQueue->ExecuteCommandLists((UINT)frame_lists.size(), frame_lists.data());
+    frame_lists.clear();
 }
 
 void Graphics::WaitForGPU() {
+    // pending uploads count as GPU work too, they're on the copy queue
+    if (upload_list_open) {
+        FlushUploads();
+    }
+    upload_fence.wait(upload_fence_counter);
+    release_finished_uploads();
+
     WaitFenceCounter++;
     CommandQueue->Signal(WaitFence.Get(), WaitFenceCounter);
 
@@ -668,121 +2017,63 @@ void Graphics::PrintDebugMessages() {
 // - This returns an unsigned int, which is the index of the descriptor (SRV) for the loaded cubemap.
 //   - If you’re not using bindless, you probably want this to return something else.
 // - The following assumptions are made:
-//   - The DirectX Toolkit is part of the project.
+//   - Faces are decoded with the same threaded loader as LoadTextures (TextureLoader.h).
 //   - Graphics.cpp has a vector of resources named "textures".
 //   - Graphics.cpp has a variable called "srvDescriptorOffset" that tracks how much of the SRV portion of the descriptor table is in use.
-//   - Multiframe sync has been implemented, so ResetAllocatorAndCommandList() has a parameter.  If yours doesn’t, simply remove the argument.
+//   - The faces go up through the batched uploads (UploadTexture), so nothing waits on the GPU here.
 
 // === Graphics.cpp ===
 uint32_t Graphics::CreateCubemap(const std::wstring& path) {
-    // Temporary textures
-    Microsoft::WRL::ComPtr<ID3D12Resource> faces[6] {};
-
-    // Batch the upload of all six textures
-    DirectX::ResourceUploadBatch upload(Device.Get());
-    upload.Begin();
-
-    std::wstring right = (path + L"/right.png");
-    std::wstring left = (path + L"/left.png");
-    std::wstring up = (path + L"/up.png");
-    std::wstring down = (path + L"/down.png");
-    std::wstring front = (path + L"/front.png");
-    std::wstring back = (path + L"/back.png");
-
-    // Load all six textures
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, right.c_str(), faces[0].GetAddressOf());
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, left.c_str(), faces[1].GetAddressOf());
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, up.c_str(), faces[2].GetAddressOf());
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, down.c_str(), faces[3].GetAddressOf());
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, front.c_str(), faces[4].GetAddressOf());
-    DirectX::CreateWICTextureFromFile(Device.Get(), upload, back.c_str(), faces[5].GetAddressOf());
-
-    // Perform the upload and wait for it to finish before returning the texture
-    auto finish = upload.End(CommandQueue.Get());
-    finish.wait();
-
-    // Grab the size of the first face
-    D3D12_RESOURCE_DESC faceDesc = faces[0]->GetDesc();
+    const wchar_t* face_names[6] = { L"/right.png", L"/left.png", L"/up.png", L"/down.png", L"/front.png", L"/back.png" };
 
-    // Create the new, final texture
-    D3D12_HEAP_PROPERTIES props = {};
-    props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-    props.CreationNodeMask = 1;
-    props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-    props.Type = D3D12_HEAP_TYPE_DEFAULT;
-    props.VisibleNodeMask = 1;
+    // Decode all six faces at once, each one lands in its own subresource
+    std::string face_paths[6];
+    const char* face_path_strings[6] = {};
+    for (int f = 0; f < 6; f++) {
+        face_paths[f] = narrow_path((path + face_names[f]).c_str());
+        face_path_strings[f] = face_paths[f].c_str();
+    }
+    DecodedTextures decoded;
+    decode_textures(face_path_strings, 6, false, &decoded);
+    const TextureMip& faceSize = decoded.jobs[0].layout.mips[0];
 
+    // Create the new, final texture
     D3D12_RESOURCE_DESC desc = {};
     desc.Alignment = 0;
     desc.DepthOrArraySize = 6; // Cube map
     desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
     desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-    desc.Format = faceDesc.Format;
-    desc.Height = faceDesc.Height;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.Height = faceSize.height;
     desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     desc.MipLevels = 1;
     desc.SampleDesc.Count = 1;
     desc.SampleDesc.Quality = 0;
-    desc.Width = faceDesc.Width;
+    desc.Width = faceSize.width;
 
     Microsoft::WRL::ComPtr<ID3D12Resource> cubeMap;
-    Device->CreateCommittedResource(
-        &props,
-        D3D12_HEAP_FLAG_NONE,
-        &desc,
-        D3D12_RESOURCE_STATE_COPY_DEST, // Copying into immediately
-        0,
-        IID_PPV_ARGS(cubeMap.GetAddressOf())
-    );
+    CreatePlacedResource(&desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, &cubeMap); // Copying into immediately
 
-    // Copy all faces to the proper subresource of the cube map
-    for (int f = 0; f < 6; f++) {
-        // Set up destination
-        D3D12_TEXTURE_COPY_LOCATION destLoc {};
-        destLoc.pResource = cubeMap.Get();
-        destLoc.SubresourceIndex = f;
-        destLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-
-        // Set up source
-        D3D12_TEXTURE_COPY_LOCATION srcLoc {};
-        srcLoc.pResource = faces[f].Get();
-        srcLoc.SubresourceIndex = 0;
-        srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-
-        // Transition source to proper state
-        D3D12_RESOURCE_BARRIER tr {};
-        tr.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        tr.Transition.pResource = faces[f].Get();
-        tr.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE; // Default state after load
-        tr.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        tr.Transition.Subresource = 0;
-
-        CommandList->ResourceBarrier(1, &tr);
-        CommandList->CopyTextureRegion(&destLoc, 0, 0, 0, &srcLoc, 0);
-    }
-
-    // Transition final texture to final state
-    D3D12_RESOURCE_BARRIER tr {};
-    tr.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    tr.Transition.pResource = cubeMap.Get();
-    tr.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-    tr.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    tr.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    CommandList->ResourceBarrier(1, &tr);
-
-    CloseAndExecuteCommandList();
-    WaitForGPU();
-    ResetAllocatorAndCommandList(0);
+    // One mip per face, so faces line up with subresources 0-5
+    ID3D12Resource* targets[6] = { cubeMap.Get(), cubeMap.Get(), cubeMap.Get(), cubeMap.Get(), cubeMap.Get(), cubeMap.Get() };
+    uint32_t first_subresources[6] = { 0, 1, 2, 3, 4, 5 };
+    UploadTicket ticket = upload_decoded(decoded, targets, first_subresources);
 
     // Save the resource
     textures.push_back(cubeMap);
 
-    // Save the index of this descriptor and increment the overall offset
-    uint32_t srvIndex = srv_descriptor_offset++;
+    // Reserve a bindless slot and save the index of this descriptor
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = {};
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = {};
+    if (!ReserveDescriptorHeapSlot(&cpuHandle, &gpuHandle)) {
+        throw std::runtime_error("Error creating cubemap: the bindless descriptor heap is out of slots");
+    }
+    uint32_t srvIndex = get_descriptor_index(gpuHandle);
+    set_texture_upload_ticket(srvIndex, ticket);
 
     // Set up descriptor
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc {};
-    srvDesc.Format = faceDesc.Format;
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     srvDesc.TextureCube.MipLevels = 1;
@@ -790,37 +2081,76 @@ uint32_t Graphics::CreateCubemap(const std::wstring& path) {
     srvDesc.TextureCube.ResourceMinLODClamp = 0;
 
     // Create the SRV in the main descriptor heap at the appropriate offset
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = CBVSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    cpuHandle.ptr += srvIndex * Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
     Device->CreateShaderResourceView(cubeMap.Get(), &srvDesc, cpuHandle);
 
     // Send back the index of the descriptor
     return srvIndex;
 }
 
+namespace Graphics {
+    namespace {
+        void get_descriptor_handles(
+            uint32_t index,
+            D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+            D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle
+        ) {
+            if (out_cpu_handle != nullptr) {
+                *out_cpu_handle = CBVSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+                out_cpu_handle->ptr += (SIZE_T)index * cbvsrv_descriptor_heap_increment_size;
+            }
+            if (out_gpu_handle != nullptr) {
+                *out_gpu_handle = CBVSRVDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
+                out_gpu_handle->ptr += (UINT64)index * cbvsrv_descriptor_heap_increment_size;
+            }
+        }
+    }
+}
+
 // slightly modified from:
 //   https://github.com/vixorien/ggp-demos/blob/main/GGP2/D3D12/10%20-%20Multiple%20Render%20Targets/Graphics.cpp
 
-void Graphics::ReserveDescriptorHeapSlot(D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle) {
-    // Grab the actual heap start on both sides and offset to the next open SRV/UAV portion
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = CBVSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = CBVSRVDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
-
-    cpuHandle.ptr += (SIZE_T)srv_descriptor_offset * cbvsrv_descriptor_heap_increment_size;
-    gpuHandle.ptr += (SIZE_T)srv_descriptor_offset * cbvsrv_descriptor_heap_increment_size;
-
-    // Set the requested handle(s)
-    if (out_cpu_handle != nullptr) {
-        *out_cpu_handle = cpuHandle;
+bool Graphics::ReserveDescriptorHeapSlot(
+    D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+    D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle,
+    uint32_t count
+) {
+    // Nothing to hand back, nothing to reserve
+    if (!out_cpu_handle && !out_gpu_handle) {
+        return false;
     }
-    if (out_gpu_handle != nullptr) {
-        *out_gpu_handle = gpuHandle;
+
+    uint32_t index = descriptor_allocator_allocate(&descriptor_allocator, count);
+    if (index == DESCRIPTOR_INVALID) {
+        return false;
     }
 
-    // Update the overall offset if at least one handle was reserved
-    if (out_cpu_handle || out_gpu_handle) {
-        srv_descriptor_offset++;
+    get_descriptor_handles(index, out_cpu_handle, out_gpu_handle);
+    return true;
+}
+
+void Graphics::ReleaseDescriptorHeapSlot(D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle, uint32_t count) {
+    // frames already submitted may still read it, the frame being
+    //   recorded signals last so that's the one to wait out
+    descriptor_allocator_free(
+        &descriptor_allocator,
+        get_descriptor_index(gpu_handle),
+        count,
+        frame_ring.fence_value
+    );
+}
+
+bool Graphics::ReserveFrameDescriptors(
+    uint32_t count,
+    D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+    D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle
+) {
+    uint32_t index = descriptor_allocator_allocate_frame(&descriptor_allocator, count);
+    if (index == DESCRIPTOR_INVALID) {
+        return false;
     }
+
+    get_descriptor_handles(index, out_cpu_handle, out_gpu_handle);
+    return true;
 }
 
 uint32_t Graphics::get_descriptor_index(D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle) {
@@ -5,6 +5,15 @@
 #include <dxgi1_6.h>
 #include <string>
 #include <wrl/client.h>
+#include "DescriptorAllocator.h"
+#include "FrameAllocator.h"
+#include "FrameRing.h"
+#include "HeapAllocator.h"
+#include "ParallelRecorder.h"
+#include "QueueSync.h"
+#include "RenderGraph.h"
+#include "TextureConstant.h"
+#include "TransientPool.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -12,9 +21,66 @@
 namespace Graphics {
     // --- CONSTANTS ---
 
-    constexpr uint32_t NUM_BACK_BUFFERS = 2;
-    constexpr uint32_t MAX_CBUFFERS = 1000;
+    // swap chain images, how far the CPU runs ahead is FrameRing's business
+    constexpr uint32_t NUM_BACK_BUFFERS = 3;
+    // frames in flight to start with, SetFramesInFlight changes it later
+    constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
     constexpr uint32_t MAX_TEXTURE_DESCRIPTORS = 100;
+    // transient descriptors per frame in flight, they sit after the bindless ones
+    constexpr uint32_t MAX_FRAME_DESCRIPTORS = 256;
+    // cbuffer bytes each frame in flight gets out of CBUploadHeap before it
+    //   has to spill into extra pages
+    constexpr uint64_t CB_FRAME_BUDGET = 256 * 1024;
+    // threads RecordParallel uses at most, the calling thread's one of them
+    constexpr uint32_t MAX_RECORD_WORKERS = 8;
+    // each recording thread's cbuffer pages, they come & go like spill pages
+    constexpr uint64_t CB_WORKER_PAGE_SIZE = 64 * 1024;
+    // staging space shared by every buffer & texture upload, anything
+    //   bigger than this gets its own one-off upload buffer
+    constexpr uint64_t UPLOAD_RING_SIZE = 32ull * 1024 * 1024;
+    // placed resources get carved out of heaps this big, anything that
+    //   doesn't fit in one gets a heap of its own
+    constexpr uint64_t GPU_HEAP_BLOCK_SIZE = 64ull * 1024 * 1024;
+    // transient targets nobody's acquired for this many frames get dropped
+    constexpr uint32_t TRANSIENT_RELEASE_FRAMES = 60;
+    static_assert(TRANSIENT_RELEASE_FRAMES > MAX_FRAMES_IN_FLIGHT, "transient targets can't be dropped while frames still use them");
+
+    // --- TYPES ---
+
+    // an upload that might still be in flight, it's done once the upload
+    //   fence reaches fence_value. check it with IsUploadDone/WaitForUpload
+    struct UploadTicket {
+        uint64_t fence_value;
+    };
+
+    // a transient target for the frame being recorded. created means it's
+    //   a new resource (views on it have to be made again), aliased means
+    //   another target was using its memory, so it needs an aliasing
+    //   barrier & a clear or discard before anything reads it
+    struct TransientTarget {
+        ID3D12Resource* resource;
+        bool created;
+        bool aliased;
+    };
+
+    // what texture loading's done since startup, summed over every LoadTextures
+    struct TextureLoadStats {
+        uint32_t decoded_count;
+        // files that wouldn't open or decode, they end up white
+        uint32_t failed_count;
+        // summed over every texture, so more than decode_wall_seconds with threads
+        double decode_seconds;
+        double mip_seconds;
+        double decode_wall_seconds;
+        uint32_t orm_packed_count;
+        double orm_pack_seconds;
+        // flat ones that went 1x1 & the staging bytes that saved
+        uint32_t collapsed_count;
+        uint64_t collapsed_bytes;
+        uint32_t cooked_count;
+        uint32_t cook_failed_count;
+        double cook_seconds;
+    };
 
     // --- GLOBAL VARS ---
 
@@ -23,7 +89,7 @@ namespace Graphics {
     inline Microsoft::WRL::ComPtr<IDXGISwapChain> SwapChain;
 
     // Command stuff!
-    inline Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CommandAllocators[NUM_BACK_BUFFERS];
+    inline PerFrame<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> CommandAllocators;
     inline Microsoft::WRL::ComPtr<ID3D12CommandQueue> CommandQueue;
     inline Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> CommandList;
 
@@ -37,7 +103,8 @@ namespace Graphics {
     inline Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> DSVHeap;
     inline D3D12_CPU_DESCRIPTOR_HANDLE DSVHandle = {};
 
-    // cbuffer things !!!
+    // cbuffer things !!! the upload heap is split into one CB_FRAME_BUDGET
+    //   partition per frame in flight
     inline Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> CBVSRVDescriptorHeap;
     inline Microsoft::WRL::ComPtr<ID3D12Resource> CBUploadHeap;
 
@@ -47,7 +114,6 @@ namespace Graphics {
     inline uint64_t WaitFenceCounter = 0;
     inline Microsoft::WRL::ComPtr<ID3D12Fence> FrameFence;
     inline HANDLE FrameFenceEvent = 0;
-    inline uint64_t FrameFenceCounters[NUM_BACK_BUFFERS] = {};
 
     // Debug Layer
     inline Microsoft::WRL::ComPtr<ID3D12InfoQueue> InfoQueue;
@@ -58,21 +124,142 @@ namespace Graphics {
     bool get_vsync_state();
     std::wstring get_api_name();
     uint32_t get_swap_chain_index();
+    // the frame slot being recorded, what per frame resources are indexed by
+    uint32_t get_frame_index();
+    uint32_t get_frames_in_flight();
+    FrameLatencyStats get_frame_latency_stats();
+    FrameAllocatorStats get_cb_allocator_stats();
+    uint32_t get_record_worker_count();
+    ParallelRecorderStats get_record_stats();
+    DescriptorAllocatorStats get_descriptor_stats();
+    // summed over the buffer, texture & render target pools
+    HeapPoolStats get_gpu_memory_stats();
+    TransientPoolStats get_transient_stats();
 
     // General functions
     HRESULT Initialize(unsigned int windowWidth, unsigned int windowHeight, HWND windowHandle, bool vsyncIfPossible);
     void ShutDown();
     void ResizeBuffers(unsigned int width, unsigned int height);
     void AdvanceSwapChainIndex();
-    Microsoft::WRL::ComPtr<ID3D12Resource> CreateStaticBuffer(size_t data_stride, uint32_t data_count, const void* data);
-    D3D12_GPU_DESCRIPTOR_HANDLE CBHeapFillNext(const void* data, size_t size);
+    // 1 to MAX_FRAMES_IN_FLIGHT, fewer means less latency & more waiting
+    //   on the GPU. it kicks in on the next AdvanceSwapChainIndex
+    void SetFramesInFlight(uint32_t count);
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreateStaticBuffer(
+        size_t data_stride,
+        uint32_t data_count,
+        const void* data,
+        UploadTicket* out_ticket = nullptr
+    );
+    // placed in one of the shared GPU heaps instead of getting a heap of
+    //   its own. it has to go back through ReleasePlacedResource, dropping
+    //   the last ComPtr alone leaks its spot in the heap
+    HRESULT CreatePlacedResource(
+        const D3D12_RESOURCE_DESC* desc,
+        D3D12_RESOURCE_STATES initial_state,
+        const D3D12_CLEAR_VALUE* clear_value,
+        Microsoft::WRL::ComPtr<ID3D12Resource>* out_resource
+    );
+    // resets the pointer, the heap space gets reused once the frame being
+    //   recorded is done on the GPU
+    void ReleasePlacedResource(Microsoft::WRL::ComPtr<ID3D12Resource>* resource);
+    // render or depth target that only has to last the frame being
+    //   recorded. the same desc every frame hands back the same resource,
+    //   new ones get placed in memory nobody's acquired yet this frame if
+    //   it fits. created ones start in initial_state, the rest are in
+    //   whatever state the last frame left them
+    //! throws std::runtime_error if the resource can't be created
+    TransientTarget AcquireTransientTarget(
+        const D3D12_RESOURCE_DESC* desc,
+        const D3D12_CLEAR_VALUE* clear_value,
+        D3D12_RESOURCE_STATES initial_state
+    );
+    // done with it for the rest of the frame, later acquires can alias it
+    void ReleaseTransientTarget(ID3D12Resource* resource);
+    // runs a compiled graph on CommandList, transients come from
+    //   AcquireTransientTarget & each pass's barriers go out in one call
+    void ExecuteRenderGraph(RenderGraph* graph);
+    // copies data into this frame's cbuffer memory, the address goes
+    //   straight into a root CBV
+    D3D12_GPU_VIRTUAL_ADDRESS CBHeapFillNext(const void* data, size_t size);
+    // same thing for RecordParallel's record, out of that worker's own pages
+    D3D12_GPU_VIRTUAL_ADDRESS CBHeapFillNext(uint32_t worker, const void* data, size_t size);
+    // decodes every file at once across threads, mips made on the CPU, &
+    //   records all of it into the open upload batch. out_indices gets each
+    //   one's bindless slot, each texture's upload ticket comes from
+    //   get_texture_upload_ticket (1x1s share theirs). an
+    //   "_orm" file that doesn't exist gets packed from its sibling
+    //   occlusion, roughness & metal maps instead. flat textures collapse
+    //   to a 1x1 shared by every texture with that value
+    //! throws std::runtime_error if the bindless heap can't fit them all
+    void LoadTextures(const char* const* files, uint32_t count, uint32_t* out_indices, bool generate_mips = true);
     uint32_t LoadTexture(const wchar_t* file, bool generate_mips = true);
+    //! throws std::runtime_error if the bindless heap's out of slots
     uint32_t CreateCubemap(const std::wstring& path);
 
     // bindless things
-    void ReserveDescriptorHeapSlot(D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle, D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle);
+    // count contiguous long lived slots, false if the heap's out of them
+    bool ReserveDescriptorHeapSlot(
+        D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+        D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle,
+        uint32_t count = 1
+    );
+    // the slots get reused once the frame being recorded is done on the GPU
+    void ReleaseDescriptorHeapSlot(D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle, uint32_t count = 1);
+    // slots that are only good for the frame being recorded, never released
+    bool ReserveFrameDescriptors(
+        uint32_t count,
+        D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_handle,
+        D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_handle
+    );
     uint32_t get_descriptor_index(D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle);
 
+    // Batched uploads: these record copies into the open upload batch and
+    //   return right away, the batch goes to the copy queue with FlushUploads
+    //   (which CloseAndExecuteCommandList does before every frame) & runs
+    //   alongside rendering. a frame that reads an upload either checks
+    //   IsUploadDone first or calls RequireUpload so the direct queue waits
+    //   for it. resources have to be in COMMON or COPY_DEST, they end up in
+    //   COMMON & reads on the direct queue promote them from there
+    UploadTicket UploadBuffer(
+        ID3D12Resource* buffer,
+        uint64_t buffer_offset,
+        const void* data,
+        uint64_t size
+    );
+    UploadTicket UploadTexture(
+        ID3D12Resource* texture,
+        uint32_t first_subresource,
+        uint32_t subresource_count,
+        const D3D12_SUBRESOURCE_DATA* data
+    );
+    UploadTicket FlushUploads();
+    bool IsUploadDone(UploadTicket ticket);
+    void WaitForUpload(UploadTicket ticket);
+    // the frame being recorded reads what ticket uploaded, the direct queue
+    //   holds off on the frame (not the CPU) until it's there. only the
+    //   highest ticket per frame counts & only if it's not done already
+    void RequireUpload(UploadTicket ticket);
+    // what LoadTexture/CreateCubemap's upload of that slot signals
+    UploadTicket get_texture_upload_ticket(uint32_t index);
+    // which channels of the texture in that slot are flat & their values,
+    //   so materials can use them as constants instead of sampling
+    TextureConstant get_texture_constant(uint32_t index);
+    QueueSyncStats get_upload_sync_stats();
+    TextureLoadStats get_texture_load_stats();
+
+    // Multithreaded recording: count items split by cost into contiguous
+    //   chunks, each recorded on its own thread into its own command list.
+    //   lists don't share state, so setup runs on each before record does,
+    //   & on CommandList after since that's a fresh list too. it all goes
+    //   out in order: CommandList up to now, the chunks, CommandList after
+    void RecordParallel(
+        const uint32_t* costs,
+        uint32_t count,
+        uint64_t min_chunk_cost,
+        const std::function<void(ID3D12GraphicsCommandList*)>& setup,
+        const std::function<void(ID3D12GraphicsCommandList*, uint32_t worker, RecordChunk chunk)>& record
+    );
+
     // Command stuff & sync
     void ResetAllocatorAndCommandList(uint32_t index);
     void CloseAndExecuteCommandList();
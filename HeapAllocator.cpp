@@ -0,0 +1,396 @@
+#include "HeapAllocator.h"
+
+#include <bit>
+
+// which size class a free node of this many granules goes in
+static void size_class(uint64_t units, uint32_t* out_fl, uint32_t* out_sl) {
+    if (units < HEAP_SL_COUNT) {
+        // small sizes all share the first class, one granule per slot
+        *out_fl = 0;
+        *out_sl = (uint32_t)units;
+        return;
+    }
+    uint32_t log2 = 63 - (uint32_t)std::countl_zero(units);
+    *out_fl = log2 - HEAP_SL_LOG2 + 1;
+    *out_sl = (uint32_t)(units >> (log2 - HEAP_SL_LOG2)) - HEAP_SL_COUNT;
+}
+
+static uint32_t new_node(HeapAllocator* allocator) {
+    if (!allocator->unused_nodes.empty()) {
+        uint32_t node = allocator->unused_nodes.back();
+        allocator->unused_nodes.pop_back();
+        return node;
+    }
+    allocator->nodes.push_back({});
+    return (uint32_t)allocator->nodes.size() - 1;
+}
+
+static void insert_free(HeapAllocator* allocator, uint32_t node) {
+    HeapNode& n = allocator->nodes[node];
+    uint32_t fl, sl;
+    size_class(n.size >> allocator->granularity_log2, &fl, &sl);
+
+    uint32_t head = allocator->free_lists[fl][sl];
+    n.free = true;
+    n.prev_free = HEAP_NODE_NONE;
+    n.next_free = head;
+    if (head != HEAP_NODE_NONE) {
+        allocator->nodes[head].prev_free = node;
+    }
+    allocator->free_lists[fl][sl] = node;
+    allocator->fl_bitmap |= 1u << fl;
+    allocator->sl_bitmaps[fl] |= 1u << sl;
+
+    allocator->stats.free_bytes += n.size;
+    allocator->stats.free_node_count++;
+}
+
+static void remove_free(HeapAllocator* allocator, uint32_t node) {
+    HeapNode& n = allocator->nodes[node];
+    uint32_t fl, sl;
+    size_class(n.size >> allocator->granularity_log2, &fl, &sl);
+
+    if (n.prev_free != HEAP_NODE_NONE) {
+        allocator->nodes[n.prev_free].next_free = n.next_free;
+    } else {
+        allocator->free_lists[fl][sl] = n.next_free;
+    }
+    if (n.next_free != HEAP_NODE_NONE) {
+        allocator->nodes[n.next_free].prev_free = n.prev_free;
+    }
+
+    if (allocator->free_lists[fl][sl] == HEAP_NODE_NONE) {
+        allocator->sl_bitmaps[fl] &= ~(1u << sl);
+        if (allocator->sl_bitmaps[fl] == 0) {
+            allocator->fl_bitmap &= ~(1u << fl);
+        }
+    }
+    n.free = false;
+
+    allocator->stats.free_bytes -= n.size;
+    allocator->stats.free_node_count--;
+}
+
+// turns a free node (already out of its list) into an allocation of bytes
+//   at a multiple of alignment. whatever's left in front & behind goes back
+//   as free nodes, the neighbors there are never free so nothing merges
+static void carve(HeapAllocator* allocator, uint32_t node, uint64_t bytes, uint64_t alignment, HeapAllocation* out_allocation) {
+    uint64_t offset = allocator->nodes[node].offset;
+    uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+
+    if (aligned > offset) {
+        uint32_t front = new_node(allocator);
+        HeapNode& n = allocator->nodes[node];
+        HeapNode& f = allocator->nodes[front];
+        f.offset = offset;
+        f.size = aligned - offset;
+        f.prev_physical = n.prev_physical;
+        f.next_physical = node;
+        if (n.prev_physical != HEAP_NODE_NONE) {
+            allocator->nodes[n.prev_physical].next_physical = front;
+        }
+        n.prev_physical = front;
+        n.offset = aligned;
+        n.size -= f.size;
+        insert_free(allocator, front);
+    }
+
+    if (allocator->nodes[node].size > bytes) {
+        uint32_t back = new_node(allocator);
+        HeapNode& n = allocator->nodes[node];
+        HeapNode& b = allocator->nodes[back];
+        b.offset = aligned + bytes;
+        b.size = n.size - bytes;
+        b.prev_physical = node;
+        b.next_physical = n.next_physical;
+        if (n.next_physical != HEAP_NODE_NONE) {
+            allocator->nodes[n.next_physical].prev_physical = back;
+        }
+        n.next_physical = back;
+        n.size = bytes;
+        insert_free(allocator, back);
+    }
+
+    allocator->stats.used_bytes += bytes;
+    allocator->stats.allocation_count++;
+    out_allocation->block = 0;
+    out_allocation->node = node;
+    out_allocation->offset = aligned;
+    out_allocation->size = bytes;
+}
+
+void heap_allocator_create(HeapAllocator* allocator, uint64_t size, uint64_t granularity) {
+    allocator->granularity = granularity;
+    allocator->granularity_log2 = (uint32_t)std::countr_zero(granularity);
+    allocator->size = size & ~(granularity - 1);
+
+    allocator->nodes.clear();
+    allocator->unused_nodes.clear();
+    allocator->fl_bitmap = 0;
+    for (uint32_t fl = 0; fl < HEAP_FL_COUNT; fl++) {
+        allocator->sl_bitmaps[fl] = 0;
+        for (uint32_t sl = 0; sl < HEAP_SL_COUNT; sl++) {
+            allocator->free_lists[fl][sl] = HEAP_NODE_NONE;
+        }
+    }
+    allocator->stats = {};
+
+    // node 0 always starts at offset 0, merges keep the lower node
+    uint32_t node = new_node(allocator);
+    HeapNode& n = allocator->nodes[node];
+    n.offset = 0;
+    n.size = allocator->size;
+    n.prev_physical = HEAP_NODE_NONE;
+    n.next_physical = HEAP_NODE_NONE;
+    insert_free(allocator, node);
+}
+
+bool heap_allocator_allocate(HeapAllocator* allocator, uint64_t size, uint64_t alignment, HeapAllocation* out_allocation) {
+    uint64_t granularity = allocator->granularity;
+    alignment = alignment > granularity ? alignment : granularity;
+    uint64_t bytes = size == 0 ? granularity : (size + granularity - 1) & ~(granularity - 1);
+
+    // worst case padding to reach the alignment gets asked for up front,
+    //   then the size is rounded up to the next class so that anything in
+    //   the class found is big enough without looking at it
+    uint64_t units = (bytes + alignment - granularity) >> allocator->granularity_log2;
+    if (units >= HEAP_SL_COUNT) {
+        uint32_t log2 = 63 - (uint32_t)std::countl_zero(units);
+        units += (1ull << (log2 - HEAP_SL_LOG2)) - 1;
+    }
+    uint32_t fl, sl;
+    size_class(units, &fl, &sl);
+    if (fl >= HEAP_FL_COUNT) return false;
+
+    uint32_t sl_map = allocator->sl_bitmaps[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        uint32_t fl_map = fl + 1 < HEAP_FL_COUNT ? allocator->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (fl_map == 0) return false;
+
+        fl = (uint32_t)std::countr_zero(fl_map);
+        sl_map = allocator->sl_bitmaps[fl];
+    }
+    sl = (uint32_t)std::countr_zero(sl_map);
+
+    uint32_t node = allocator->free_lists[fl][sl];
+    remove_free(allocator, node);
+    carve(allocator, node, bytes, alignment, out_allocation);
+    return true;
+}
+
+void heap_allocator_free(HeapAllocator* allocator, uint32_t node) {
+    HeapNode* n = &allocator->nodes[node];
+    allocator->stats.used_bytes -= n->size;
+    allocator->stats.allocation_count--;
+
+    // soak up a free neighbor behind, the lower node is the one that stays
+    if (n->next_physical != HEAP_NODE_NONE && allocator->nodes[n->next_physical].free) {
+        uint32_t next = n->next_physical;
+        remove_free(allocator, next);
+        HeapNode& x = allocator->nodes[next];
+        n->size += x.size;
+        n->next_physical = x.next_physical;
+        if (x.next_physical != HEAP_NODE_NONE) {
+            allocator->nodes[x.next_physical].prev_physical = node;
+        }
+        allocator->unused_nodes.push_back(next);
+    }
+
+    // and get soaked up by one in front
+    if (n->prev_physical != HEAP_NODE_NONE && allocator->nodes[n->prev_physical].free) {
+        uint32_t prev = n->prev_physical;
+        remove_free(allocator, prev);
+        HeapNode& p = allocator->nodes[prev];
+        p.size += n->size;
+        p.next_physical = n->next_physical;
+        if (n->next_physical != HEAP_NODE_NONE) {
+            allocator->nodes[n->next_physical].prev_physical = prev;
+        }
+        allocator->unused_nodes.push_back(node);
+        node = prev;
+        n = &p;
+    }
+
+    insert_free(allocator, node);
+}
+
+uint64_t heap_allocator_largest_free(const HeapAllocator* allocator) {
+    if (allocator->fl_bitmap == 0) return 0;
+
+    // the top class only spans 1/HEAP_SL_COUNT of a power of two, so the
+    //   walk is short
+    uint32_t fl = 31 - (uint32_t)std::countl_zero(allocator->fl_bitmap);
+    uint32_t sl = 31 - (uint32_t)std::countl_zero(allocator->sl_bitmaps[fl]);
+    uint64_t largest = 0;
+    for (uint32_t node = allocator->free_lists[fl][sl]; node != HEAP_NODE_NONE; node = allocator->nodes[node].next_free) {
+        uint64_t size = allocator->nodes[node].size;
+        largest = size > largest ? size : largest;
+    }
+    return largest;
+}
+
+bool heap_allocator_allocate_below(
+    HeapAllocator* allocator,
+    const HeapAllocation& allocation,
+    uint64_t alignment,
+    HeapAllocation* out_allocation
+) {
+    uint64_t granularity = allocator->granularity;
+    alignment = alignment > granularity ? alignment : granularity;
+    uint64_t bytes = allocator->nodes[allocation.node].size;
+
+    // lowest free node in front of it that fits, this one isn't O(1) but
+    //   it's only for defragmenting
+    uint32_t best = HEAP_NODE_NONE;
+    for (uint32_t node = allocator->nodes[allocation.node].prev_physical; node != HEAP_NODE_NONE;
+         node = allocator->nodes[node].prev_physical) {
+        const HeapNode& n = allocator->nodes[node];
+        if (!n.free) continue;
+
+        uint64_t aligned = (n.offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= n.offset + n.size) {
+            best = node;
+        }
+    }
+    if (best == HEAP_NODE_NONE) return false;
+
+    remove_free(allocator, best);
+    carve(allocator, best, bytes, alignment, out_allocation);
+    out_allocation->block = allocation.block;
+    return true;
+}
+
+static void update_pool_stats(HeapPool* pool) {
+    pool->stats.block_count = (uint32_t)pool->blocks.size();
+    pool->stats.reserved_bytes = 0;
+    pool->stats.used_bytes = 0;
+    pool->stats.allocation_count = 0;
+    for (const HeapAllocator& block : pool->blocks) {
+        pool->stats.reserved_bytes += block.size;
+        pool->stats.used_bytes += block.stats.used_bytes;
+        pool->stats.allocation_count += block.stats.allocation_count;
+    }
+    pool->stats.pending_frees = (uint32_t)pool->pending_frees.size();
+}
+
+static void remember_alignment(HeapPool* pool, const HeapAllocation& allocation, uint64_t alignment) {
+    std::vector<uint64_t>& alignments = pool->alignments[allocation.block];
+    if (alignments.size() < pool->blocks[allocation.block].nodes.size()) {
+        alignments.resize(pool->blocks[allocation.block].nodes.size());
+    }
+    alignments[allocation.node] = alignment;
+}
+
+void heap_pool_create(HeapPool* pool, uint64_t block_size, uint64_t granularity) {
+    pool->block_size = block_size;
+    pool->granularity = granularity;
+    pool->blocks.clear();
+    pool->alignments.clear();
+    pool->pending_frees.clear();
+    pool->stats = {};
+}
+
+void heap_pool_allocate(HeapPool* pool, uint64_t size, uint64_t alignment, HeapAllocation* out_allocation) {
+    for (uint32_t b = 0; b < (uint32_t)pool->blocks.size(); b++) {
+        if (heap_allocator_allocate(&pool->blocks[b], size, alignment, out_allocation)) {
+            out_allocation->block = b;
+            remember_alignment(pool, *out_allocation, alignment);
+            update_pool_stats(pool);
+            return;
+        }
+    }
+
+    // nothing fits anywhere, new blocks start at offset 0 so alignment's free
+    uint64_t granularity = pool->granularity;
+    uint64_t bytes = (size + granularity - 1) & ~(granularity - 1);
+    uint64_t block_size = bytes > pool->block_size ? bytes : pool->block_size;
+    if (bytes > pool->block_size) {
+        pool->stats.dedicated_block_count++;
+    }
+
+    pool->blocks.emplace_back();
+    pool->alignments.emplace_back();
+    heap_allocator_create(&pool->blocks.back(), block_size, granularity);
+    heap_allocator_allocate(&pool->blocks.back(), size, alignment, out_allocation);
+    out_allocation->block = (uint32_t)pool->blocks.size() - 1;
+    remember_alignment(pool, *out_allocation, alignment);
+    update_pool_stats(pool);
+}
+
+void heap_pool_free(HeapPool* pool, const HeapAllocation& allocation, uint64_t fence_value) {
+    pool->pending_frees.push_back({ allocation, fence_value });
+    pool->stats.pending_frees = (uint32_t)pool->pending_frees.size();
+}
+
+void heap_pool_free_now(HeapPool* pool, const HeapAllocation& allocation) {
+    heap_allocator_free(&pool->blocks[allocation.block], allocation.node);
+    update_pool_stats(pool);
+}
+
+void heap_pool_retire(HeapPool* pool, uint64_t completed_value) {
+    if (pool->pending_frees.empty()) return;
+
+    // queued with the current frame's fence value, which only goes up
+    while (!pool->pending_frees.empty() && pool->pending_frees.front().fence_value <= completed_value) {
+        const HeapAllocation& allocation = pool->pending_frees.front().allocation;
+        heap_allocator_free(&pool->blocks[allocation.block], allocation.node);
+        pool->pending_frees.pop_front();
+    }
+    update_pool_stats(pool);
+}
+
+uint32_t heap_pool_defragment(HeapPool* pool, uint32_t max_moves, std::vector<HeapMove>* out_moves) {
+    // every live allocation, last block first & highest offset first, so
+    //   whatever sits at the very end of the pool moves first
+    std::vector<HeapAllocation> candidates;
+    for (uint32_t b = (uint32_t)pool->blocks.size(); b-- > 0;) {
+        const HeapAllocator& block = pool->blocks[b];
+        uint32_t node = 0;
+        while (block.nodes[node].next_physical != HEAP_NODE_NONE) {
+            node = block.nodes[node].next_physical;
+        }
+        for (; node != HEAP_NODE_NONE; node = block.nodes[node].prev_physical) {
+            const HeapNode& n = block.nodes[node];
+            if (!n.free) {
+                candidates.push_back({ b, node, n.offset, n.size });
+            }
+        }
+    }
+
+    uint32_t move_count = 0;
+    for (const HeapAllocation& from : candidates) {
+        if (move_count == max_moves) break;
+
+        uint64_t alignment = pool->alignments[from.block][from.node];
+        HeapAllocation to = {};
+        bool moved = false;
+        for (uint32_t b = 0; b < from.block && !moved; b++) {
+            if (heap_allocator_allocate(&pool->blocks[b], from.size, alignment, &to)) {
+                to.block = b;
+                moved = true;
+            }
+        }
+        if (!moved) {
+            moved = heap_allocator_allocate_below(&pool->blocks[from.block], from, alignment, &to);
+        }
+        if (!moved) continue;
+
+        remember_alignment(pool, to, alignment);
+        out_moves->push_back({ from, to });
+        move_count++;
+    }
+
+    update_pool_stats(pool);
+    return move_count;
+}
+
+float heap_pool_fragmentation(const HeapPool* pool) {
+    uint64_t free_bytes = 0;
+    uint64_t largest = 0;
+    for (const HeapAllocator& block : pool->blocks) {
+        free_bytes += block.stats.free_bytes;
+        uint64_t block_largest = heap_allocator_largest_free(&block);
+        largest = block_largest > largest ? block_largest : largest;
+    }
+    return free_bytes == 0 ? 0.0f : 1.0f - (float)largest / (float)free_bytes;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+constexpr uint32_t HEAP_NODE_NONE = UINT32_MAX;
+
+// TLSF size classes: one first level class per power of two, split into
+//   2^HEAP_SL_LOG2 second level classes. sizes are counted in granules
+constexpr uint32_t HEAP_SL_LOG2 = 4;
+constexpr uint32_t HEAP_SL_COUNT = 1 << HEAP_SL_LOG2;
+constexpr uint32_t HEAP_FL_COUNT = 32;
+
+// one piece of a block, either free or handed out. pieces next to each
+//   other in memory are linked, free ones also sit in their size class list
+struct HeapNode {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t prev_physical;
+    uint32_t next_physical;
+    uint32_t prev_free;
+    uint32_t next_free;
+    bool free;
+};
+
+struct HeapAllocation {
+    // block within a pool, always 0 straight out of a HeapAllocator
+    uint32_t block;
+    uint32_t node;
+    // aligned start & the size asked for
+    uint64_t offset;
+    uint64_t size;
+};
+
+// a defragment step: the allocation at from is copied to to. both are live
+//   once it's planned, the caller frees from when the copy's done
+struct HeapMove {
+    HeapAllocation from;
+    HeapAllocation to;
+};
+
+struct HeapAllocatorStats {
+    uint64_t used_bytes;
+    uint64_t free_bytes;
+    uint32_t allocation_count;
+    uint32_t free_node_count;
+};
+
+// two level segregated fit (TLSF) over one block of memory. alloc & free
+//   are O(1): a pair of bitmaps picks the first size class with something
+//   big enough, neighbors get merged on free. the bookkeeping lives out
+//   here on the CPU since the memory behind it usually isn't mappable
+struct HeapAllocator {
+    uint64_t size;
+    // every offset & size is a multiple of this (power of two)
+    uint64_t granularity;
+    uint32_t granularity_log2;
+
+    std::vector<HeapNode> nodes;
+    // node slots nothing's using, recycled before nodes grows
+    std::vector<uint32_t> unused_nodes;
+
+    // bit per first level class with any free node, then per second level
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmaps[HEAP_FL_COUNT];
+    uint32_t free_lists[HEAP_FL_COUNT][HEAP_SL_COUNT];
+
+    HeapAllocatorStats stats;
+};
+
+void heap_allocator_create(HeapAllocator* allocator, uint64_t size, uint64_t granularity);
+
+// size bytes at a multiple of alignment (power of two, anything below the
+//   granularity is rounded up to it). false when no free node is big enough
+bool heap_allocator_allocate(HeapAllocator* allocator, uint64_t size, uint64_t alignment, HeapAllocation* out_allocation);
+
+// hands the node back right away, merging it with free neighbors
+void heap_allocator_free(HeapAllocator* allocator, uint32_t node);
+
+// biggest single allocation that'd fit (ignoring alignment)
+uint64_t heap_allocator_largest_free(const HeapAllocator* allocator);
+
+// tries to fit the allocation in free space lower in the block, for
+//   compacting. false if nothing lower fits, the original isn't touched
+bool heap_allocator_allocate_below(
+    HeapAllocator* allocator,
+    const HeapAllocation& allocation,
+    uint64_t alignment,
+    HeapAllocation* out_allocation
+);
+
+struct HeapPoolStats {
+    uint32_t block_count;
+    uint64_t reserved_bytes;
+    uint64_t used_bytes;
+    uint32_t allocation_count;
+    // frees still waiting on their fence
+    uint32_t pending_frees;
+    // blocks made for a single allocation too big for block_size
+    uint32_t dedicated_block_count;
+};
+
+// a growing list of HeapAllocator blocks, the GPU side keeps one heap per
+//   block. frees wait on a fence value like descriptor frees do
+struct HeapPool {
+    uint64_t block_size;
+    uint64_t granularity;
+    // blocks.size() only ever grows, the backend makes heaps to match
+    std::vector<HeapAllocator> blocks;
+    // alignment each live allocation asked for, by block & node. needed
+    //   to move them while defragmenting
+    std::vector<std::vector<uint64_t>> alignments;
+
+    struct PendingFree {
+        HeapAllocation allocation;
+        uint64_t fence_value;
+    };
+    std::deque<PendingFree> pending_frees;
+
+    HeapPoolStats stats;
+};
+
+void heap_pool_create(HeapPool* pool, uint64_t block_size, uint64_t granularity);
+
+// first block that fits wins, a new one gets added when none does. it's
+//   block_size unless size won't fit in that, then it's just big enough
+void heap_pool_allocate(HeapPool* pool, uint64_t size, uint64_t alignment, HeapAllocation* out_allocation);
+
+// gives the memory back once fence_value is done
+void heap_pool_free(HeapPool* pool, const HeapAllocation& allocation, uint64_t fence_value);
+
+// gives the memory back right away, for allocations the GPU never saw
+//   (creating the resource in them failed)
+void heap_pool_free_now(HeapPool* pool, const HeapAllocation& allocation);
+
+// lands every queued free whose fence value is at or below completed_value
+void heap_pool_retire(HeapPool* pool, uint64_t completed_value);
+
+// defragment hook: plans up to max_moves moves of the highest allocations
+//   into free space in earlier blocks or lower in their own, so the tail
+//   of the pool empties out. the destinations are already allocated, the
+//   caller copies each resource & then frees from (usually with a fence)
+uint32_t heap_pool_defragment(HeapPool* pool, uint32_t max_moves, std::vector<HeapMove>* out_moves);
+
+// 1 - largest free / total free over every block, 0 when it's all one piece
+float heap_pool_fragmentation(const HeapPool* pool);
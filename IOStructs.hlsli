@@ -1,18 +1,36 @@
 #ifndef IOSTRUCTS_H
 #define IOSTRUCTS_H
 
-struct VSInput { 
+#include "VertexConfig.h"
+
+// has to match GPUVertexLayout in VertexLayout.h, VertexDecode.hlsli unpacks it
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_FULL
+struct VSInput {
 	float3 position : POSITION;
 	float2 uv : TEXCOORD;
 	float3 normal : NORMAL;
-	float3 tangent : TANGENT;
+	float4 tangent : TANGENT;   // w = handedness
+};
+#elif VERTEX_LAYOUT == VERTEX_LAYOUT_OCTAHEDRAL
+struct VSInput {
+	float4 position : POSITION; // unorm, relative to the mesh bounds, w = handedness
+	float2 uv : TEXCOORD;       // unorm, relative to the mesh's UV range
+	float2 normal : NORMAL;     // octahedral
+	float2 tangent : TANGENT;   // octahedral
 };
+#else
+struct VSInput {
+	float4 position : POSITION; // unorm, relative to the mesh bounds
+	float2 uv : TEXCOORD;       // unorm, relative to the mesh's UV range
+	float4 qtangent : QTANGENT; // tangent frame quaternion
+};
+#endif
 
 struct PSInput {
 	float4 position : SV_POSITION;
 	float2 uv : TEXCOORD0;
 	float3 normal : NORMAL;
-	float3 tangent : TANGENT;
+	float4 tangent : TANGENT;
 	float3 world_pos : TEXCOORD1;
 };
 
@@ -0,0 +1,490 @@
+#include "Inflate.h"
+
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+    // first level lookup sizes. anything longer goes through a second,
+    //   smaller table hanging off its prefix's entry
+    constexpr uint32_t LITLEN_TABLE_BITS = 10;
+    constexpr uint32_t DIST_TABLE_BITS = 8;
+    constexpr uint32_t CODELEN_TABLE_BITS = 7;
+    // worst cases for those root sizes are 1332 & 400 (zlib's enough.c),
+    //   building still checks so a hostile stream can't go past the end
+    constexpr uint32_t LITLEN_TABLE_SIZE = 1536;
+    constexpr uint32_t DIST_TABLE_SIZE = 512;
+    constexpr uint32_t CODELEN_TABLE_SIZE = 1 << CODELEN_TABLE_BITS;
+
+    constexpr uint32_t MAX_CODE_BITS = 15;
+
+    // table entries pack everything decoding a symbol needs:
+    //   bits 0-4 how many bits the code takes, 5-7 the kind,
+    //   8-15 extra bits to read (or a subtable's size in bits),
+    //   16-31 the literal / base value / subtable offset
+    constexpr uint32_t KIND_LITERAL = 0 << 5;
+    constexpr uint32_t KIND_BASE = 1 << 5;
+    constexpr uint32_t KIND_END = 2 << 5;
+    constexpr uint32_t KIND_SUBTABLE = 3 << 5;
+    constexpr uint32_t KIND_INVALID = 4 << 5;
+    constexpr uint32_t KIND_MASK = 7 << 5;
+
+    constexpr uint32_t make_entry(uint32_t kind, uint32_t extra, uint32_t value) {
+        return kind | (extra << 8) | (value << 16);
+    }
+    uint32_t entry_bits(uint32_t entry) {
+        return entry & 31;
+    }
+    uint32_t entry_kind(uint32_t entry) {
+        return entry & KIND_MASK;
+    }
+    uint32_t entry_extra(uint32_t entry) {
+        return (entry >> 8) & 0xff;
+    }
+    uint32_t entry_value(uint32_t entry) {
+        return entry >> 16;
+    }
+
+    constexpr uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    constexpr uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    constexpr uint16_t DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    constexpr uint8_t DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+    // the order code length code lengths come in
+    constexpr uint8_t CODELEN_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    // what each symbol decodes to, before the code's length gets packed in
+    struct SymbolEntries {
+        uint32_t litlen[288];
+        uint32_t dist[32];
+        uint32_t codelen[19];
+
+        SymbolEntries() {
+            for (uint32_t i = 0; i < 256; i++) {
+                litlen[i] = make_entry(KIND_LITERAL, 0, i);
+            }
+            litlen[256] = make_entry(KIND_END, 0, 0);
+            for (uint32_t i = 0; i < 29; i++) {
+                litlen[257 + i] = make_entry(KIND_BASE, LENGTH_EXTRA[i], LENGTH_BASE[i]);
+            }
+            litlen[286] = litlen[287] = make_entry(KIND_INVALID, 0, 0);
+            for (uint32_t i = 0; i < 30; i++) {
+                dist[i] = make_entry(KIND_BASE, DIST_EXTRA[i], DIST_BASE[i]);
+            }
+            dist[30] = dist[31] = make_entry(KIND_INVALID, 0, 0);
+            for (uint32_t i = 0; i < 19; i++) {
+                codelen[i] = make_entry(KIND_LITERAL, 0, i);
+            }
+        }
+    };
+    const SymbolEntries symbol_entries;
+
+    uint32_t reverse_bits(uint32_t code, uint32_t length) {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            result = (result << 1) | (code & 1);
+            code >>= 1;
+        }
+        return result;
+    }
+
+    // canonical huffman codes from their lengths into a lookup table indexed
+    //   by the next table_bits of the (LSB first) stream. codes longer than
+    //   that get a subtable per prefix, sized for the longest code under it.
+    //   incomplete codes are fine (their holes decode as invalid), over
+    //   subscribed ones aren't
+    bool build_table(
+        const uint8_t* lengths,
+        uint32_t count,
+        const uint32_t* entries,
+        uint32_t table_bits,
+        uint32_t* table,
+        uint32_t table_size
+    ) {
+        uint32_t length_counts[MAX_CODE_BITS + 1] = {};
+        for (uint32_t i = 0; i < count; i++) {
+            length_counts[lengths[i]]++;
+        }
+        length_counts[0] = 0;
+
+        int32_t left = 1;
+        for (uint32_t length = 1; length <= MAX_CODE_BITS; length++) {
+            left = (left << 1) - (int32_t)length_counts[length];
+            if (left < 0) return false;
+        }
+
+        uint32_t next_code[MAX_CODE_BITS + 2] = {};
+        for (uint32_t length = 1; length <= MAX_CODE_BITS; length++) {
+            next_code[length + 1] = (next_code[length] + length_counts[length]) << 1;
+        }
+
+        uint32_t root_size = 1u << table_bits;
+        for (uint32_t i = 0; i < root_size; i++) {
+            table[i] = make_entry(KIND_INVALID, 0, 0);
+        }
+
+        // how deep each prefix's subtable goes, then where they all go
+        uint8_t sub_bits[1 << LITLEN_TABLE_BITS] = {};
+        uint32_t codes[288];
+        {
+            uint32_t code_at[MAX_CODE_BITS + 2];
+            memcpy(code_at, next_code, sizeof(code_at));
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t length = lengths[i];
+                if (length == 0) continue;
+                codes[i] = code_at[length]++;
+                if (length > table_bits) {
+                    uint32_t prefix = codes[i] >> (length - table_bits);
+                    uint32_t bits = length - table_bits;
+                    sub_bits[prefix] = bits > sub_bits[prefix] ? (uint8_t)bits : sub_bits[prefix];
+                }
+            }
+        }
+
+        uint32_t sub_offsets[1 << LITLEN_TABLE_BITS] = {};
+        uint32_t used = root_size;
+        for (uint32_t prefix = 0; prefix < root_size; prefix++) {
+            if (sub_bits[prefix] == 0) continue;
+            uint32_t size = 1u << sub_bits[prefix];
+            if (used + size > table_size) return false;
+            sub_offsets[prefix] = used;
+            for (uint32_t i = 0; i < size; i++) {
+                table[used + i] = make_entry(KIND_INVALID, 0, 0);
+            }
+            table[reverse_bits(prefix, table_bits)] = make_entry(KIND_SUBTABLE, sub_bits[prefix], used);
+            used += size;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t length = lengths[i];
+            if (length == 0) continue;
+            if (length <= table_bits) {
+                uint32_t entry = entries[i] | length;
+                for (uint32_t index = reverse_bits(codes[i], length); index < root_size; index += 1u << length) {
+                    table[index] = entry;
+                }
+            } else {
+                uint32_t prefix = codes[i] >> (length - table_bits);
+                uint32_t rest_length = length - table_bits;
+                uint32_t sub_size = 1u << sub_bits[prefix];
+                uint32_t entry = entries[i] | rest_length;
+                uint32_t* sub = table + sub_offsets[prefix];
+                for (uint32_t index = reverse_bits(codes[i], rest_length); index < sub_size; index += 1u << rest_length) {
+                    sub[index] = entry;
+                }
+            }
+        }
+        return true;
+    }
+
+    // LSB first bits, refilled 8 bytes at a time while there's that much
+    //   left & a byte at a time after. reading past the end feeds zeros &
+    //   gets counted so a truncated stream can be caught
+    struct BitReader {
+        const uint8_t* next;
+        const uint8_t* end;
+        uint64_t bits;
+        uint32_t count;
+        uint32_t overrun;
+    };
+
+    // leaves at least 56 bits, enough for a whole length/distance pair
+    inline void refill(BitReader& reader) {
+        if (reader.end - reader.next >= 8) {
+            uint64_t word;
+            memcpy(&word, reader.next, sizeof(word));
+            reader.bits |= word << reader.count;
+            reader.next += (63 - reader.count) >> 3;
+            reader.count |= 56;
+            return;
+        }
+        while (reader.count <= 56) {
+            uint64_t byte = 0;
+            if (reader.next < reader.end) {
+                byte = *reader.next++;
+            } else {
+                reader.overrun++;
+            }
+            reader.bits |= byte << reader.count;
+            reader.count += 8;
+        }
+    }
+
+    inline uint32_t peek(const BitReader& reader, uint32_t count) {
+        return (uint32_t)(reader.bits & ((1ull << count) - 1));
+    }
+
+    inline void consume(BitReader& reader, uint32_t count) {
+        reader.bits >>= count;
+        reader.count -= count;
+    }
+
+    inline uint32_t take(BitReader& reader, uint32_t count) {
+        uint32_t value = peek(reader, count);
+        consume(reader, count);
+        return value;
+    }
+
+    // byte position of the first bit not consumed yet, counting the zeros
+    //   handed out past the end
+    size_t byte_position(const BitReader& reader, const uint8_t* start) {
+        return (size_t)(reader.next - start) + reader.overrun - reader.count / 8;
+    }
+
+    // the next symbol, needs refill to have been called since the last one
+    //   that could have used 15+ bits
+    inline uint32_t decode(BitReader& reader, const uint32_t* table, uint32_t table_bits) {
+        uint32_t entry = table[peek(reader, table_bits)];
+        if (entry_kind(entry) == KIND_SUBTABLE) {
+            consume(reader, table_bits);
+            entry = table[entry_value(entry) + peek(reader, entry_extra(entry))];
+        }
+        consume(reader, entry_bits(entry));
+        return entry;
+    }
+
+    struct Tables {
+        uint32_t litlen[LITLEN_TABLE_SIZE];
+        uint32_t dist[DIST_TABLE_SIZE];
+    };
+
+    struct FixedTables {
+        Tables tables;
+        bool ok;
+
+        FixedTables() {
+            uint8_t lengths[288 + 32];
+            memset(lengths, 8, 144);
+            memset(lengths + 144, 9, 112);
+            memset(lengths + 256, 7, 24);
+            memset(lengths + 280, 8, 8);
+            memset(lengths + 288, 5, 32);
+            ok = build_table(lengths, 288, symbol_entries.litlen, LITLEN_TABLE_BITS, tables.litlen, LITLEN_TABLE_SIZE)
+                && build_table(lengths + 288, 32, symbol_entries.dist, DIST_TABLE_BITS, tables.dist, DIST_TABLE_SIZE);
+        }
+    };
+    const FixedTables fixed_tables;
+
+    bool read_dynamic_tables(BitReader& reader, Tables* out_tables) {
+        refill(reader);
+        uint32_t litlen_count = take(reader, 5) + 257;
+        uint32_t dist_count = take(reader, 5) + 1;
+        uint32_t codelen_count = take(reader, 4) + 4;
+        if (litlen_count > 286 || dist_count > 30) return false;
+
+        uint8_t codelen_lengths[19] = {};
+        for (uint32_t i = 0; i < codelen_count; i++) {
+            refill(reader);
+            codelen_lengths[CODELEN_ORDER[i]] = (uint8_t)take(reader, 3);
+        }
+        uint32_t codelen_table[CODELEN_TABLE_SIZE];
+        if (!build_table(codelen_lengths, 19, symbol_entries.codelen, CODELEN_TABLE_BITS, codelen_table, CODELEN_TABLE_SIZE)) {
+            return false;
+        }
+
+        // both alphabets' lengths come as one run, repeats can cross over
+        uint8_t lengths[286 + 30] = {};
+        uint32_t total = litlen_count + dist_count;
+        for (uint32_t i = 0; i < total;) {
+            refill(reader);
+            uint32_t entry = decode(reader, codelen_table, CODELEN_TABLE_BITS);
+            if (entry_kind(entry) == KIND_INVALID) return false;
+            uint32_t symbol = entry_value(entry);
+            if (symbol < 16) {
+                lengths[i++] = (uint8_t)symbol;
+                continue;
+            }
+
+            uint8_t value = 0;
+            uint32_t repeat = 0;
+            if (symbol == 16) {
+                if (i == 0) return false;
+                value = lengths[i - 1];
+                repeat = 3 + take(reader, 2);
+            } else if (symbol == 17) {
+                repeat = 3 + take(reader, 3);
+            } else {
+                repeat = 11 + take(reader, 7);
+            }
+            if (i + repeat > total) return false;
+            memset(lengths + i, value, repeat);
+            i += repeat;
+        }
+        if (lengths[256] == 0) return false;
+
+        return build_table(lengths, litlen_count, symbol_entries.litlen, LITLEN_TABLE_BITS, out_tables->litlen, LITLEN_TABLE_SIZE)
+            && build_table(lengths + litlen_count, dist_count, symbol_entries.dist, DIST_TABLE_BITS, out_tables->dist, DIST_TABLE_SIZE);
+    }
+
+    // one huffman block up to its end code
+    bool inflate_block(BitReader& reader, const Tables& tables, uint8_t* out_start, uint8_t*& out, uint8_t* out_end) {
+        for (;;) {
+            refill(reader);
+            uint32_t entry = decode(reader, tables.litlen, LITLEN_TABLE_BITS);
+            uint32_t kind = entry_kind(entry);
+
+            if (kind == KIND_LITERAL) {
+                if (out == out_end) return false;
+                *out++ = (uint8_t)entry_value(entry);
+                // more often than not another literal follows, & there's
+                //   still enough bits for it without refilling
+                if (reader.count < MAX_CODE_BITS) continue;
+                entry = decode(reader, tables.litlen, LITLEN_TABLE_BITS);
+                kind = entry_kind(entry);
+                if (kind == KIND_LITERAL) {
+                    if (out == out_end) return false;
+                    *out++ = (uint8_t)entry_value(entry);
+                    continue;
+                }
+                // the rest of a length/distance pair is at most 33 bits
+                if (kind == KIND_BASE && reader.count < 33) {
+                    refill(reader);
+                }
+            }
+            if (kind == KIND_END) return true;
+            if (kind != KIND_BASE) return false;
+
+            uint32_t length = entry_value(entry) + take(reader, entry_extra(entry));
+            uint32_t dist_entry = decode(reader, tables.dist, DIST_TABLE_BITS);
+            if (entry_kind(dist_entry) != KIND_BASE) return false;
+            uint32_t distance = entry_value(dist_entry) + take(reader, entry_extra(dist_entry));
+
+            if (distance > (size_t)(out - out_start) || length > (size_t)(out_end - out)) return false;
+            const uint8_t* src = out - distance;
+
+            // 8 bytes at a time when the source is far enough back to not
+            //   read what this copy's writing & there's room to overshoot
+            if (distance >= 8 && (size_t)(out_end - out) >= length + 8) {
+                uint8_t* dst = out;
+                uint8_t* dst_end = out + length;
+                do {
+                    uint64_t word;
+                    memcpy(&word, src, sizeof(word));
+                    memcpy(dst, &word, sizeof(word));
+                    src += 8;
+                    dst += 8;
+                } while (dst < dst_end);
+                out = dst_end;
+            } else if (distance == 1) {
+                memset(out, out[-1], length);
+                out += length;
+            } else {
+                for (uint32_t i = 0; i < length; i++) {
+                    out[i] = src[i];
+                }
+                out += length;
+            }
+        }
+    }
+}
+
+uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    // most bytes that can be summed before b could overflow 32 bits
+    constexpr size_t NMAX = 5552;
+    constexpr uint32_t BASE = 65521;
+
+    uint32_t a = adler & 0xffff;
+    uint32_t b = adler >> 16;
+
+    // 16 bytes at a time: a gets their plain sum & b their sum weighted
+    //   16..1, plus 16 times whatever a was going into each block
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights_low = _mm_set_epi16(9, 10, 11, 12, 13, 14, 15, 16);
+    const __m128i weights_high = _mm_set_epi16(1, 2, 3, 4, 5, 6, 7, 8);
+    while (size >= 16) {
+        size_t blocks = (size < NMAX ? size : NMAX) / 16;
+        size -= blocks * 16;
+
+        __m128i sums = zero;
+        __m128i prefix = zero;
+        __m128i weighted = zero;
+        uint64_t b_wide = b + (uint64_t)a * blocks * 16;
+        for (size_t i = 0; i < blocks; i++) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)data);
+            prefix = _mm_add_epi32(prefix, sums);
+            sums = _mm_add_epi32(sums, _mm_sad_epu8(bytes, zero));
+            weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weights_low));
+            weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weights_high));
+            data += 16;
+        }
+
+        alignas(16) uint32_t lanes[3][4];
+        _mm_store_si128((__m128i*)lanes[0], sums);
+        _mm_store_si128((__m128i*)lanes[1], prefix);
+        _mm_store_si128((__m128i*)lanes[2], weighted);
+        a += lanes[0][0] + lanes[0][2];
+        b_wide += 16 * ((uint64_t)lanes[1][0] + lanes[1][2]);
+        b_wide += (uint64_t)lanes[2][0] + lanes[2][1] + lanes[2][2] + lanes[2][3];
+        a %= BASE;
+        b = (uint32_t)(b_wide % BASE);
+    }
+
+    for (; size > 0; size--) {
+        a += *data++;
+        b += a;
+    }
+    a %= BASE;
+    b %= BASE;
+    return (b << 16) | a;
+}
+
+bool zlib_inflate(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) {
+    // deflate with a window of at most 32k & no preset dictionary
+    if (size < 6 || (data[0] & 0x0f) != 8 || (data[0] >> 4) > 7 || (data[1] & 0x20)
+        || ((uint32_t)data[0] << 8 | data[1]) % 31 != 0) {
+        return false;
+    }
+    if (!fixed_tables.ok) return false;
+
+    BitReader reader = { data + 2, data + size, 0, 0, 0 };
+    uint8_t* cursor = out;
+    uint8_t* out_end = out + out_size;
+    Tables dynamic;
+
+    bool last = false;
+    while (!last) {
+        // a truncated stream reads as zeros, which can't go on for long
+        if (reader.overrun > 8) return false;
+        refill(reader);
+        last = take(reader, 1) != 0;
+        uint32_t type = take(reader, 2);
+
+        if (type == 0) {
+            // stored, back to whole bytes & straight copy
+            size_t position = byte_position(reader, data);
+            if (position + 4 > size) return false;
+            uint32_t length = data[position] | (uint32_t)data[position + 1] << 8;
+            uint32_t complement = data[position + 2] | (uint32_t)data[position + 3] << 8;
+            position += 4;
+            if ((length ^ 0xffff) != complement || position + length > size || length > (size_t)(out_end - cursor)) {
+                return false;
+            }
+            memcpy(cursor, data + position, length);
+            cursor += length;
+            reader = { data + position + length, data + size, 0, 0, 0 };
+        } else if (type == 1) {
+            if (!inflate_block(reader, fixed_tables.tables, out, cursor, out_end)) return false;
+        } else if (type == 2) {
+            if (!read_dynamic_tables(reader, &dynamic)) return false;
+            if (!inflate_block(reader, dynamic, out, cursor, out_end)) return false;
+        } else {
+            return false;
+        }
+    }
+
+    size_t position = byte_position(reader, data);
+    if (cursor != out_end || position + 4 > size) return false;
+    uint32_t expected = (uint32_t)data[position] << 24 | (uint32_t)data[position + 1] << 16
+        | (uint32_t)data[position + 2] << 8 | data[position + 3];
+    return adler32(1, out, out_size) == expected;
+}
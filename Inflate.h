@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// a whole zlib stream (2 byte header, deflate blocks, adler32) into out in
+//   one go. out_size has to be exactly what it inflates to, which for the
+//   formats we read is always known up front. fails on anything malformed,
+//   a checksum mismatch or a stream that's shorter or longer than out_size
+bool zlib_inflate(const uint8_t* data, size_t size, uint8_t* out, size_t out_size);
+
+uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size);
@@ -2,47 +2,7 @@
 
 #include "Graphics.h"
 #include <cstring>
-
-static void create_texture(
-    uint32_t width,
-    uint32_t height,
-    DXGI_FORMAT format,
-    const float* clear_color,
-    Microsoft::WRL::ComPtr<ID3D12Resource>* out_texture
-) {
-    D3D12_RESOURCE_DESC desc = {};
-    desc.Alignment = 0;
-    desc.DepthOrArraySize = 1;
-    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-    desc.Format = format;
-    desc.Width = width;
-    desc.Height = height;
-    desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-    desc.MipLevels = 1;
-    desc.SampleDesc.Count = 1;
-    desc.SampleDesc.Quality = 0;
-
-    D3D12_HEAP_PROPERTIES heap_props = {};
-    heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-    heap_props.CreationNodeMask = 1;
-    heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-    heap_props.Type = D3D12_HEAP_TYPE_DEFAULT;
-    heap_props.VisibleNodeMask = 1;
-
-    D3D12_CLEAR_VALUE clear = {};
-    memcpy(clear.Color, clear_color, sizeof(float) * 4);
-    clear.Format = format;
-
-    Graphics::Device->CreateCommittedResource(
-        &heap_props,
-        D3D12_HEAP_FLAG_NONE,
-        &desc,
-        D3D12_RESOURCE_STATE_COMMON,
-        &clear,
-        IID_PPV_ARGS(out_texture->GetAddressOf())
-    );
-}
+#include <stdexcept>
 
 void mrt_bundle_create(
     uint32_t width,
@@ -52,7 +12,7 @@ void mrt_bundle_create(
     uint32_t count,
     MRTBundle* out_bundle
 ) {
-    out_bundle->images = new Microsoft::WRL::ComPtr<ID3D12Resource>[count];
+    out_bundle->images = new ID3D12Resource*[count]();
     out_bundle->srv_descriptors = new DescriptorDesc[count];
     out_bundle->uav_descriptors = new DescriptorDesc[count];
     out_bundle->rtv_descriptors = new D3D12_CPU_DESCRIPTOR_HANDLE[count];
@@ -83,6 +43,22 @@ void mrt_bundle_resize(
     uint32_t height,
     MRTBundle* out_bundle
 ) {
+    out_bundle->width = width;
+    out_bundle->height = height;
+}
+
+RenderGraphTextureDesc mrt_bundle_target_desc(const MRTBundle* bundle, uint32_t index) {
+    RenderGraphTextureDesc desc = {};
+    desc.format = bundle->formats[index];
+    desc.width = bundle->width;
+    desc.height = bundle->height;
+    desc.flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    memcpy(desc.clear_color, &bundle->clear_colors[index * 4], sizeof(float) * 4);
+    desc.initial_state = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    return desc;
+}
+
+void mrt_bundle_bind(MRTBundle* bundle, ID3D12Resource* const* images) {
     D3D12_RENDER_TARGET_VIEW_DESC rtv_desc = {};
     rtv_desc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
     rtv_desc.Texture2D.MipSlice = 0;
@@ -93,41 +69,52 @@ void mrt_bundle_resize(
     srv_desc.Texture2D.MipLevels = 1;
     srv_desc.Texture2D.MostDetailedMip = 0;
 
-    for (uint32_t i = 0; i < out_bundle->count; i++) {
-        create_texture(
-            width,
-            height,
-            out_bundle->formats[i],
-            &out_bundle->clear_colors[i * out_bundle->count],
-            &out_bundle->images[i]
-        );
+    for (uint32_t i = 0; i < bundle->count; i++) {
+        // same size & format as last frame is the same target
+        if (images[i] == bundle->images[i]) continue;
+        bundle->images[i] = images[i];
 
-        rtv_desc.Format = out_bundle->formats[i];
+        // RTVs are only read while recording, rewriting them in place is fine
+        rtv_desc.Format = bundle->formats[i];
         Graphics::Device->CreateRenderTargetView(
-            out_bundle->images[i].Get(),
+            bundle->images[i],
             &rtv_desc,
-            out_bundle->rtv_descriptors[i]
+            bundle->rtv_descriptors[i]
         );
 
-        Graphics::ReserveDescriptorHeapSlot(
-            &out_bundle->srv_descriptors[i].cpu_handle,
-            &out_bundle->srv_descriptors[i].gpu_handle
+        // the old SRV goes back once frames still reading it are done
+        if (bundle->srv_descriptors[i].bindless_index != (uint32_t)-1) {
+            Graphics::ReleaseDescriptorHeapSlot(bundle->srv_descriptors[i].gpu_handle);
+        }
+        bool reserved = Graphics::ReserveDescriptorHeapSlot(
+            &bundle->srv_descriptors[i].cpu_handle,
+            &bundle->srv_descriptors[i].gpu_handle
         );
+        if (!reserved) {
+            bundle->srv_descriptors[i].bindless_index = (uint32_t)-1;
+            throw std::runtime_error("Error binding MRT bundle: the bindless descriptor heap is out of slots");
+        }
 
-        srv_desc.Format = out_bundle->formats[i];
+        srv_desc.Format = bundle->formats[i];
         Graphics::Device->CreateShaderResourceView(
-            out_bundle->images[i].Get(),
+            bundle->images[i],
             &srv_desc,
-            out_bundle->srv_descriptors[i].cpu_handle
+            bundle->srv_descriptors[i].cpu_handle
         );
 
-        out_bundle->srv_descriptors[i].bindless_index = Graphics::get_descriptor_index(
-            out_bundle->srv_descriptors[i].gpu_handle
+        bundle->srv_descriptors[i].bindless_index = Graphics::get_descriptor_index(
+            bundle->srv_descriptors[i].gpu_handle
         );
     }
 }
 
 void mrt_bundle_destroy(MRTBundle* bundle) {
+    for (uint32_t i = 0; i < bundle->count; i++) {
+        if (bundle->srv_descriptors[i].bindless_index != (uint32_t)-1) {
+            Graphics::ReleaseDescriptorHeapSlot(bundle->srv_descriptors[i].gpu_handle);
+        }
+    }
+
     delete[] bundle->images;
     delete[] bundle->srv_descriptors;
     delete[] bundle->uav_descriptors;
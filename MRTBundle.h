@@ -3,6 +3,7 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 #include <cstdint>
+#include "RenderGraph.h"
 
 // lol, descriptor description
 struct DescriptorDesc {
@@ -12,9 +13,12 @@ struct DescriptorDesc {
 };
 
 // a bundle of data, pointers, etc that represent all resources
-//   needed for rendering to multiple render targets for a single frame
+//   needed for rendering to multiple render targets. frames run one after
+//   another on the queue, so every frame in flight shares the one bundle
 struct MRTBundle {
-    Microsoft::WRL::ComPtr<ID3D12Resource>* images;
+    // transient targets, they belong to the render graph & only hold for
+    //   the frame mrt_bundle_bind was last called in
+    ID3D12Resource** images;
     DescriptorDesc* srv_descriptors;
     DescriptorDesc* uav_descriptors;
     // we can just use the raw CPU handle cuz we'll feed this as an 
@@ -25,6 +29,8 @@ struct MRTBundle {
     // unique heap for all our descriptors individually bundled w everything else
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> rtv_descriptor_heap;
     uint32_t count;
+    uint32_t width;
+    uint32_t height;
 };
 
 void mrt_bundle_create(
@@ -35,9 +41,15 @@ void mrt_bundle_create(
     uint32_t count,
     MRTBundle* out_bundle
 );
+// just the size, the targets change on the next bind
 void mrt_bundle_resize(
     uint32_t width,
     uint32_t height,
     MRTBundle* out_bundle
 );
+// target i for a render graph, resting in PIXEL_SHADER_RESOURCE between uses
+RenderGraphTextureDesc mrt_bundle_target_desc(const MRTBundle* bundle, uint32_t index);
+// this frame's targets, views get remade on any that changed
+//! throws std::runtime_error if the bindless heap's out of slots for them
+void mrt_bundle_bind(MRTBundle* bundle, ID3D12Resource* const* images);
 void mrt_bundle_destroy(MRTBundle* bundle);
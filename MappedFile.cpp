@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool mapped_file_open(const char* path, MappedFile* out_file) {
+    *out_file = {};
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size = {};
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    out_file->file_handle = file;
+    out_file->size = (size_t)file_size.QuadPart;
+
+    // windows refuses to map empty files, but an empty view is still valid
+    if (out_file->size == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        mapped_file_close(out_file);
+        return false;
+    }
+    out_file->mapping_handle = mapping;
+
+    out_file->data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (out_file->data == nullptr) {
+        mapped_file_close(out_file);
+        return false;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat = {};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    out_file->file_descriptor = fd;
+    out_file->size = (size_t)file_stat.st_size;
+
+    if (out_file->size == 0) {
+        return true;
+    }
+
+    void* mapped = mmap(nullptr, out_file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        mapped_file_close(out_file);
+        return false;
+    }
+    out_file->data = (const uint8_t*)mapped;
+    madvise(mapped, out_file->size, MADV_SEQUENTIAL);
+#endif
+
+    return true;
+}
+
+void mapped_file_close(MappedFile* file) {
+#ifdef _WIN32
+    if (file->data != nullptr) {
+        UnmapViewOfFile(file->data);
+    }
+    if (file->mapping_handle != nullptr) {
+        CloseHandle(file->mapping_handle);
+    }
+    if (file->file_handle != nullptr) {
+        CloseHandle(file->file_handle);
+    }
+#else
+    if (file->data != nullptr) {
+        munmap((void*)file->data, file->size);
+    }
+    if (file->file_descriptor >= 0) {
+        close(file->file_descriptor);
+    }
+#endif
+
+    *file = {};
+}
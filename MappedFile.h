@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// a read-only view of an entire file mapped into memory, lets
+//   loaders parse straight out of the OS page cache w/o copying
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int file_descriptor = -1;
+#endif
+};
+
+bool mapped_file_open(const char* path, MappedFile* out_file);
+void mapped_file_close(MappedFile* file);
@@ -4,7 +4,9 @@ Material::Material()
   : color_tint(1.0f, 1.0f, 1.0f),
     uv_scale(1.0f, 1.0f),
     uv_offset(0.0f, 0.0f),
-    texture_index_count(0) { }
+    texture_index_count(0),
+    orm_constant_channels(0),
+    orm_constant(0.0f, 0.0f, 0.0f) { }
 
 Material::~Material() { }
 
@@ -12,7 +14,9 @@ Material::Material(const Material& other)
   : color_tint(other.color_tint),
     uv_scale(other.uv_scale),
     uv_offset(other.uv_offset),
-    texture_index_count(other.texture_index_count) {
+    texture_index_count(other.texture_index_count),
+    orm_constant_channels(other.orm_constant_channels),
+    orm_constant(other.orm_constant) {
     memcpy(texture_indices, other.texture_indices, sizeof(texture_indices));
 }
 
@@ -22,6 +26,8 @@ Material& Material::operator=(const Material& other) {
     uv_offset = other.uv_offset;
     memcpy(texture_indices, other.texture_indices, sizeof(texture_indices));
     texture_index_count = other.texture_index_count;
+    orm_constant_channels = other.orm_constant_channels;
+    orm_constant = other.orm_constant;
     return *this;
 }
 
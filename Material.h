@@ -7,6 +7,13 @@
 
 constexpr uint32_t MATERIAL_MAX_TEXTURES = 32;
 
+// the order a material's textures get added in, the G-buffer pass reads
+//   them from these slots. ORM is occlusion, roughness & metal packed into
+//   r, g & b (see TexturePacker.h)
+constexpr uint32_t MATERIAL_SLOT_ALBEDO = 0;
+constexpr uint32_t MATERIAL_SLOT_NORMALS = 1;
+constexpr uint32_t MATERIAL_SLOT_ORM = 2;
+
 class Material {
    private:
     DirectX::XMFLOAT3 color_tint;
@@ -14,6 +21,10 @@ class Material {
     DirectX::XMFLOAT2 uv_offset;
     uint32_t texture_indices[MATERIAL_MAX_TEXTURES];
     uint32_t texture_index_count;
+    // ORM channels (r, g & b bits of TEXTURE_CHANNEL_*) that are flat, those
+    //   come from orm_constant instead of the texture
+    uint32_t orm_constant_channels;
+    DirectX::XMFLOAT3 orm_constant;
 
    public:
     Material();
@@ -29,7 +40,13 @@ class Material {
     DirectX::XMFLOAT2 get_uv_offset() const { return uv_offset; }
     const uint32_t* get_texture_indices() const { return texture_indices; }
     uint32_t get_texture_index_count() const { return texture_index_count; }
+    uint32_t get_orm_constant_channels() const { return orm_constant_channels; }
+    DirectX::XMFLOAT3 get_orm_constant() const { return orm_constant; }
     void set_color_tint(DirectX::XMFLOAT3 color_tint) { this->color_tint = color_tint; }
     void set_uv_scale(DirectX::XMFLOAT2 uv_scale) { this->uv_scale = uv_scale; }
     void set_uv_offset(DirectX::XMFLOAT2 uv_offset) { this->uv_offset = uv_offset; }
+    void set_orm_constant(uint32_t channels, DirectX::XMFLOAT3 value) {
+        orm_constant_channels = channels;
+        orm_constant = value;
+    }
 };
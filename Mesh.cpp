@@ -2,323 +2,189 @@
 
 #include "Graphics.h"
 #include "Vertex.h"
+#include "MappedFile.h"
+#include "MeshCooker.h"
 #include <vector>
-#include <fstream>
+#include <cstring>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
 
 using namespace DirectX;
 
-// Calculates the tangents of the vertices in a mesh
-// Code adapted from: http://www.terathon.com/code/tangent.html
-static void calculate_tangents(Vertex* verts, size_t numVerts, uint32_t* indices, size_t numIndices) {
-    // Reset tangents
-    for (int i = 0; i < numVerts; i++) {
-        verts[i].Tangent = XMFLOAT3(0, 0, 0);
+Mesh::Mesh(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    const Meshlet* meshlets,
+    uint32_t meshlet_count,
+    const MeshSegment* segments,
+    uint32_t segment_count,
+    const MeshBounds* bounds
+)
+  : num_vertices(vertex_count),
+    num_indices(index_count) {
+    MeshBounds computed_bounds;
+    if (bounds == nullptr) {
+        mesh_bounds_compute(vertices, vertex_count, false, &computed_bounds);
+        bounds = &computed_bounds;
     }
 
-    // Calculate tangents one whole triangle at a time
-    for (int i = 0; i < numIndices;) {
-        // Grab indices and vertices of first triangle
-        unsigned int i1 = indices[i++];
-        unsigned int i2 = indices[i++];
-        unsigned int i3 = indices[i++];
-        Vertex* v1 = &verts[i1];
-        Vertex* v2 = &verts[i2];
-        Vertex* v3 = &verts[i3];
-
-        // Calculate vectors relative to triangle positions
-        float x1 = v2->Position.x - v1->Position.x;
-        float y1 = v2->Position.y - v1->Position.y;
-        float z1 = v2->Position.z - v1->Position.z;
-
-        float x2 = v3->Position.x - v1->Position.x;
-        float y2 = v3->Position.y - v1->Position.y;
-        float z2 = v3->Position.z - v1->Position.z;
-
-        // Do the same for vectors relative to triangle uv's
-        float s1 = v2->UV.x - v1->UV.x;
-        float t1 = v2->UV.y - v1->UV.y;
-
-        float s2 = v3->UV.x - v1->UV.x;
-        float t2 = v3->UV.y - v1->UV.y;
+    // the AABB doubles as the position quantization range
+    VertexEncodeParams params = vertex_encode_params_create(vertices, vertex_count, bounds->aabb_min, bounds->aabb_max);
+    std::vector<uint8_t> encoded((size_t)vertex_count * GPUVertexLayout::STRIDE);
+    GPUVertexLayout::encode(vertices, vertex_count, params, encoded.data());
+    init(encoded.data(), params, *bounds, lods, lod_count, meshlets, meshlet_count);
 
-        // Create vectors for tangent calculation
-        float r = 1.0f / (s1 * t2 - s2 * t1);
+    if (segments != nullptr && segment_count > 0) {
+        this->segments.assign(segments, segments + segment_count);
+    } else {
+        mesh_build_segments(vertex_count, index_count, &this->segments);
+    }
 
-        float tx = (t2 * x1 - t1 * x2) * r;
-        float ty = (t2 * y1 - t1 * y2) * r;
-        float tz = (t2 * z1 - t1 * z2) * r;
+    if (!this->segments.empty()) {
+        std::vector<uint16_t> narrow_indices(index_count);
+        mesh_narrow_indices(indices, this->segments.data(), (uint32_t)this->segments.size(), narrow_indices.data());
+        create_index_buffer(narrow_indices.data(), sizeof(uint16_t));
+    } else {
+        create_index_buffer(indices, sizeof(uint32_t));
+    }
+}
 
-        // Adjust tangents of each vert of the triangle
-        v1->Tangent.x += tx;
-        v1->Tangent.y += ty;
-        v1->Tangent.z += tz;
+Mesh::Mesh(const CookedMesh& cooked)
+  : num_vertices(cooked.header->vertex_count),
+    num_indices(cooked.header->index_count) {
+    init(cooked.vertices, cooked.header->encode_params, cooked.header->bounds, cooked.lods, cooked.header->lod_count, cooked.meshlets, cooked.header->meshlet_count);
 
-        v2->Tangent.x += tx;
-        v2->Tangent.y += ty;
-        v2->Tangent.z += tz;
+    segments.assign(cooked.segments, cooked.segments + cooked.header->segment_count);
+    create_index_buffer(cooked.indices, cooked.header->index_stride);
+}
 
-        v3->Tangent.x += tx;
-        v3->Tangent.y += ty;
-        v3->Tangent.z += tz;
+void Mesh::init(
+    const void* encoded_vertices,
+    const VertexEncodeParams& encode_params,
+    const MeshBounds& bounds,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    const Meshlet* meshlets,
+    uint32_t meshlet_count
+) {
+    if (meshlets != nullptr) {
+        this->meshlets.assign(meshlets, meshlets + meshlet_count);
     }
 
-    // Ensure all of the tangents are orthogonal to the normals
-    for (int i = 0; i < numVerts; i++) {
-        // Grab the two vectors
-        XMVECTOR normal = XMLoadFloat3(&verts[i].Normal);
-        XMVECTOR tangent = XMLoadFloat3(&verts[i].Tangent);
-
-        // Use Gram-Schmidt orthogonalize
-        tangent = XMVector3Normalize(
-            tangent - normal * XMVector3Dot(normal, tangent)
-        );
-
-        // Store the tangent
-        XMStoreFloat3(&verts[i].Tangent, tangent);
+    if (lod_count == 0 || lods == nullptr) {
+        this->lods[0] = { 0, num_indices, 0.0f };
+        this->lod_count = 1;
+    } else {
+        this->lod_count = lod_count < MESH_MAX_LODS ? lod_count : MESH_MAX_LODS;
+        memcpy(this->lods, lods, sizeof(MeshLod) * this->lod_count);
     }
-}
 
-Mesh::Mesh(const Vertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count)
-  : num_vertices(vertex_count),
-    num_indices(index_count) {
-    vertex_buffer = Graphics::CreateStaticBuffer(sizeof(Vertex), vertex_count, vertices);
-    vertex_buffer_view.StrideInBytes = sizeof(Vertex);
-    vertex_buffer_view.SizeInBytes = sizeof(Vertex) * vertex_count;
+    this->bounds = bounds;
+    this->encode_params = encode_params;
+
+    // init goes before create_index_buffer, so this is the first ticket
+    Graphics::UploadTicket ticket = {};
+    vertex_buffer = Graphics::CreateStaticBuffer(GPUVertexLayout::STRIDE, num_vertices, encoded_vertices, &ticket);
+    upload_ticket = ticket;
+    vertex_buffer_view.StrideInBytes = GPUVertexLayout::STRIDE;
+    vertex_buffer_view.SizeInBytes = GPUVertexLayout::STRIDE * num_vertices;
     vertex_buffer_view.BufferLocation = vertex_buffer->GetGPUVirtualAddress();
+}
 
-    index_buffer = Graphics::CreateStaticBuffer(sizeof(uint32_t), index_count, indices);
-    index_buffer_view.Format = DXGI_FORMAT_R32_UINT;
-    index_buffer_view.SizeInBytes = sizeof(uint32_t) * index_count;
+void Mesh::create_index_buffer(const void* indices, uint32_t index_stride) {
+    Graphics::UploadTicket ticket = {};
+    index_buffer = Graphics::CreateStaticBuffer(index_stride, num_indices, indices, &ticket);
+    upload_ticket.fence_value = ticket.fence_value > upload_ticket.fence_value ? ticket.fence_value : upload_ticket.fence_value;
+    index_buffer_view.Format = index_stride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    index_buffer_view.SizeInBytes = index_stride * num_indices;
     index_buffer_view.BufferLocation = index_buffer->GetGPUVirtualAddress();
 }
 
-Mesh::~Mesh() { }
+void Mesh::draw(ID3D12GraphicsCommandList* command_list, uint32_t first_index, uint32_t index_count) const {
+    if (segments.empty()) {
+        command_list->DrawIndexedInstanced(index_count, 1, first_index, 0, 0);
+        return;
+    }
 
-std::shared_ptr<Mesh> Mesh::Load(const char* path) {
-    //! code written by Chris Cascioli, acquired from:
-    //!  https://github.com/vixorien/ggp-demos/blob/main/GGP2/D3D12/01%20-%20Meshes%20%26%20Entities/Mesh.cpp
+    mesh_segment_draws(segments.data(), (uint32_t)segments.size(), first_index, index_count, [&](uint32_t start, uint32_t count, uint32_t base_vertex) {
+        command_list->DrawIndexedInstanced(count, 1, start, (INT)base_vertex, 0);
+    });
+}
 
-    // File input object
-    std::ifstream obj(path);
+Mesh::~Mesh() {
+    // buffers are placed in shared heaps, their spots have to be handed back
+    Graphics::ReleasePlacedResource(&vertex_buffer);
+    Graphics::ReleasePlacedResource(&index_buffer);
+}
 
-    // Check for successful open
-    if (!obj.is_open())
+std::shared_ptr<Mesh> Mesh::Load(const char* path, float weld_epsilon, uint32_t tangent_mode) {
+    MappedFile source;
+    if (!mapped_file_open(path, &source)) {
         throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
+    }
 
-    // Variables used while reading the file
-    std::vector<XMFLOAT3> positions;   // Positions from the file
-    std::vector<XMFLOAT3> normals;     // Normals from the file
-    std::vector<XMFLOAT2> uvs;         // UVs from the file
-    std::vector<Vertex> vertsFromFile; // Verts from file (including duplicates)
-    std::vector<Vertex> finalVertices; // Final, de-duplicated verts
-    std::vector<UINT> finalIndices;    // Indices for final verts
-    char chars[100];                   // String for line reading
-
-    // Still have data left?
-    while (obj.good()) {
-        // Get the line (100 characters should be more than enough)
-        obj.getline(chars, 100);
-
-        // Check the type of line
-        if (chars[0] == 'v' && chars[1] == 'n') {
-            // Read the 3 numbers directly into an XMFLOAT3
-            XMFLOAT3 norm {};
-            sscanf_s(
-                chars,
-                "vn %f %f %f",
-                &norm.x, &norm.y, &norm.z
-            );
-
-            // Add to the list of normals
-            normals.push_back(norm);
-        } else if (chars[0] == 'v' && chars[1] == 't') {
-            // Read the 2 numbers directly into an XMFLOAT2
-            XMFLOAT2 uv {};
-            sscanf_s(
-                chars,
-                "vt %f %f",
-                &uv.x, &uv.y
-            );
-
-            // Add to the list of uv's
-            uvs.push_back(uv);
-        } else if (chars[0] == 'v') {
-            // Read the 3 numbers directly into an XMFLOAT3
-            XMFLOAT3 pos {};
-            sscanf_s(
-                chars,
-                "v %f %f %f",
-                &pos.x, &pos.y, &pos.z
-            );
-
-            // Add to the positions
-            positions.push_back(pos);
-        } else if (chars[0] == 'f') {
-            // Read the face indices into an array
-            // NOTE: This assumes the given obj file contains
-            //  vertex positions, uv coordinates AND normals.
-            unsigned int i[12] {};
-            int numbersRead = sscanf_s(
-                chars,
-                "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d",
-                &i[0], &i[1], &i[2],
-                &i[3], &i[4], &i[5],
-                &i[6], &i[7], &i[8],
-                &i[9], &i[10], &i[11]
-            );
-
-            // If we only got the first number, chances are the OBJ
-            // file has no UV coordinates.  This isn't great, but we
-            // still want to load the model without crashing, so we
-            // need to re-read a different pattern (in which we assume
-            // there are no UVs denoted for any of the vertices)
-            if (numbersRead == 1) {
-                // Re-read with a different pattern
-                numbersRead = sscanf_s(
-                    chars,
-                    "f %d//%d %d//%d %d//%d %d//%d",
-                    &i[0], &i[2],
-                    &i[3], &i[5],
-                    &i[6], &i[8],
-                    &i[9], &i[11]
-                );
-
-                // The following indices are where the UVs should
-                // have been, so give them a valid value
-                i[1] = 1;
-                i[4] = 1;
-                i[7] = 1;
-                i[10] = 1;
-
-                // If we have no UVs, create a single UV coordinate
-                // that will be used for all vertices
-                if (uvs.size() == 0)
-                    uvs.push_back(XMFLOAT2(0, 0));
-            }
-
-            // - Create the verts by looking up
-            //    corresponding data from vectors
-            // - OBJ File indices are 1-based, so
-            //    they need to be adusted
-            Vertex v1 {};
-            v1.Position = positions[max(i[0] - 1, 0)];
-            v1.UV = uvs[max(i[1] - 1, 0)];
-            v1.Normal = normals[max(i[2] - 1, 0)];
-
-            Vertex v2 {};
-            v2.Position = positions[max(i[3] - 1, 0)];
-            v2.UV = uvs[max(i[4] - 1, 0)];
-            v2.Normal = normals[max(i[5] - 1, 0)];
-
-            Vertex v3 {};
-            v3.Position = positions[max(i[6] - 1, 0)];
-            v3.UV = uvs[max(i[7] - 1, 0)];
-            v3.Normal = normals[max(i[8] - 1, 0)];
-
-            // The model is most likely in a right-handed space,
-            // especially if it came from Maya.  We probably want
-            // to convert to a left-handed space.  This means we
-            // need to:
-            //  - Invert the Z position
-            //  - Invert the normal's Z
-            //  - Flip the winding order
-            // We also need to flip the UV coordinate since Direct3D
-            // defines (0,0) as the top left of the texture, and many
-            // 3D modeling packages use the bottom left as (0,0)
-
-            // Flip the UV's since they're probably "upside down"
-            v1.UV.y = 1.0f - v1.UV.y;
-            v2.UV.y = 1.0f - v2.UV.y;
-            v3.UV.y = 1.0f - v3.UV.y;
-
-            // Flip Z (LH vs. RH)
-            v1.Position.z *= -1.0f;
-            v2.Position.z *= -1.0f;
-            v3.Position.z *= -1.0f;
-
-            // Flip normal's Z
-            v1.Normal.z *= -1.0f;
-            v2.Normal.z *= -1.0f;
-            v3.Normal.z *= -1.0f;
-
-            // Add the verts to the vector (flipping the winding order)
-            vertsFromFile.push_back(v1);
-            vertsFromFile.push_back(v3);
-            vertsFromFile.push_back(v2);
+    uint64_t source_hash = mesh_source_hash(source.data, source.size);
+    std::string cooked_path = cooked_mesh_path(path);
 
-            // Was there a 4th face?
-            // - 12 numbers read means 4 faces WITH uv's
-            // - 8 numbers read means 4 faces WITHOUT uv's
-            if (numbersRead == 12 || numbersRead == 8) {
-                // Make the last vertex
-                Vertex v4 {};
-                v4.Position = positions[max(i[9] - 1, 0)];
-                v4.UV = uvs[max(i[10] - 1, 0)];
-                v4.Normal = normals[max(i[11] - 1, 0)];
+    // fast path: the cooked mesh is up to date, so the mapped bytes go
+    //   straight into the upload buffers
+    CookedMesh cooked;
+    if (cooked_mesh_open(cooked_path.c_str(), source_hash, weld_epsilon, tangent_mode, &cooked)) {
+        mapped_file_close(&source);
 
-                // Flip the UV, Z pos and normal's Z
-                v4.UV.y = 1.0f - v4.UV.y;
-                v4.Position.z *= -1.0f;
-                v4.Normal.z *= -1.0f;
+        std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(cooked);
 
-                // Add a whole triangle (flipping the winding order)
-                vertsFromFile.push_back(v1);
-                vertsFromFile.push_back(v4);
-                vertsFromFile.push_back(v3);
-            }
-        }
+        cooked_mesh_close(&cooked);
+        return mesh;
     }
 
-    // We'll use hash table (unordered_map) to determine
-    // if any of the vertices are duplicates
-    std::unordered_map<std::string, unsigned int> vertMap;
-    for (auto& v : vertsFromFile) {
-        // Create a "unique" representation of the vertex (its key)
-        // Note: This isn't a super efficient method, but since strings
-        //       inherently work with unordered_maps, this saves
-        //       us from having to write our own custom hash function
-        std::string vStr =
-            std::to_string(v.Position.x) +
-            std::to_string(v.Position.y) +
-            std::to_string(v.Position.z) +
-            std::to_string(v.Normal.x) +
-            std::to_string(v.Normal.y) +
-            std::to_string(v.Normal.z) +
-            std::to_string(v.UV.x) +
-            std::to_string(v.UV.y);
-
-        // Prepare the index for this vertex and
-        // search for the vertex in the hash table
-        unsigned int index = -1;
-        auto pair = vertMap.find(vStr);
-        if (pair == vertMap.end()) {
-            // Vertex not found, so this
-            // is the first time we've seen it
-            index = (unsigned int)finalVertices.size();
-            finalVertices.push_back(v);
-            vertMap.insert({vStr, index});
-        } else {
-            // Vert already exists, just
-            // grab its index
-            index = pair->second;
-        }
-
-        // Either way, save the index
-        finalIndices.push_back(index);
+    // slow path: build everything from the OBJ and (re)cook it for next time
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshSegment> segments;
+    MeshBounds bounds;
+    try {
+        mesh_build((const char*)source.data, source.size, weld_epsilon, tangent_mode, &vertices, &indices, &lods, &meshlets, &segments, &bounds);
+    } catch (...) {
+        mapped_file_close(&source);
+        throw;
     }
-
-    // Close the file and create the actual buffers
-    obj.close();
-
-    calculate_tangents(
-        finalVertices.data(), finalVertices.size(),
-        finalIndices.data(), finalIndices.size()
+    mapped_file_close(&source);
+
+    // the fresh cache already has the verts encoded, so load from it like
+    //   any other launch would. not being able to write it isn't fatal,
+    //   we'll just cook again next launch
+    bool written = cooked_mesh_write(
+        cooked_path.c_str(),
+        source_hash,
+        weld_epsilon,
+        tangent_mode,
+        vertices.data(), (uint32_t)vertices.size(),
+        indices.data(), (uint32_t)indices.size(),
+        lods.data(), (uint32_t)lods.size(),
+        meshlets.data(), (uint32_t)meshlets.size(),
+        segments.data(), (uint32_t)segments.size(),
+        &bounds
     );
+    if (written && cooked_mesh_open(cooked_path.c_str(), source_hash, weld_epsilon, tangent_mode, &cooked)) {
+        std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(cooked);
+
+        cooked_mesh_close(&cooked);
+        return mesh;
+    }
 
     return std::make_shared<Mesh>(
-        finalVertices.data(), (uint32_t)finalVertices.size(),
-        finalIndices.data(), (uint32_t)finalIndices.size()
+        vertices.data(), (uint32_t)vertices.size(),
+        indices.data(), (uint32_t)indices.size(),
+        lods.data(), (uint32_t)lods.size(),
+        meshlets.data(), (uint32_t)meshlets.size(),
+        segments.data(), (uint32_t)segments.size(),
+        &bounds
     );
 }
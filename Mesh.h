@@ -3,26 +3,100 @@
 #include <stdint.h>
 #include <d3d12.h>
 #include <wrl/client.h>
+#include <DirectXMath.h>
 #include <memory>
+#include <vector>
+#include "Graphics.h"
+#include "MeshBounds.h"
+#include "MeshCooker.h"
+#include "MeshLod.h"
+#include "MeshSegment.h"
+#include "MeshTangents.h"
+#include "Meshlet.h"
 #include "Vertex.h"
+#include "VertexLayout.h"
 
 class Mesh {
    private:
     uint32_t num_vertices;
+    // total across every LOD
     uint32_t num_indices;
     Microsoft::WRL::ComPtr<ID3D12Resource> vertex_buffer;
     D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view;
     Microsoft::WRL::ComPtr<ID3D12Resource> index_buffer;
     D3D12_INDEX_BUFFER_VIEW index_buffer_view;
+    // both buffers are on the GPU once this is done
+    Graphics::UploadTicket upload_ticket;
+
+    MeshLod lods[MESH_MAX_LODS];
+    uint32_t lod_count;
+
+    // object space, see GameEntity::get_world_bounds for world space
+    MeshBounds bounds;
+
+    // vertex buffer is in GPUVertexLayout, shaders need these to decode positions & UVs
+    VertexEncodeParams encode_params;
+
+    // clusters of LOD 0, for culling big meshes piece by piece
+    std::vector<Meshlet> meshlets;
+
+    // only set with 16 bit indices, every draw gets split along these
+    std::vector<MeshSegment> segments;
+
+    // encoded_vertices are in GPUVertexLayout, encoded with encode_params
+    void init(
+        const void* encoded_vertices,
+        const VertexEncodeParams& encode_params,
+        const MeshBounds& bounds,
+        const MeshLod* lods,
+        uint32_t lod_count,
+        const Meshlet* meshlets,
+        uint32_t meshlet_count
+    );
+    void create_index_buffer(const void* indices, uint32_t index_stride);
 
    public:
-    Mesh(const Vertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
+    // without any LODs given the whole index buffer is LOD 0. indices get
+    //   narrowed to 16 bits if there are segments (see mesh_split_segments)
+    //   or the mesh has few enough verts to not need any. without bounds
+    //   given they get computed, minus the oriented box
+    Mesh(
+        const Vertex* vertices,
+        uint32_t vertex_count,
+        const uint32_t* indices,
+        uint32_t index_count,
+        const MeshLod* lods = nullptr,
+        uint32_t lod_count = 0,
+        const Meshlet* meshlets = nullptr,
+        uint32_t meshlet_count = 0,
+        const MeshSegment* segments = nullptr,
+        uint32_t segment_count = 0,
+        const MeshBounds* bounds = nullptr
+    );
+    // uploads straight from the mapping, verts are already encoded & indices
+    //   are already as narrow as they get
+    explicit Mesh(const CookedMesh& cooked);
     ~Mesh();
 
     D3D12_VERTEX_BUFFER_VIEW get_vb_view() const { return vertex_buffer_view; }
     D3D12_INDEX_BUFFER_VIEW get_ib_view() const { return index_buffer_view; }
     uint32_t get_vertex_count() const { return num_vertices; }
-    uint32_t get_index_count() const { return num_indices; }
+    // index count of the full detail mesh (LOD 0)
+    uint32_t get_index_count() const { return lods[0].index_count; }
+    uint32_t get_lod_count() const { return lod_count; }
+    const MeshLod& get_lod(uint32_t index) const { return lods[index < lod_count ? index : lod_count - 1]; }
+    const MeshLod* get_lods() const { return lods; }
+    const MeshBounds& get_bounds() const { return bounds; }
+    const VertexEncodeParams& get_vertex_encode_params() const { return encode_params; }
+    const Meshlet* get_meshlets() const { return meshlets.data(); }
+    uint32_t get_meshlet_count() const { return (uint32_t)meshlets.size(); }
+    Graphics::UploadTicket get_upload_ticket() const { return upload_ticket; }
+
+    // draws a range of the index buffer (a LOD, some meshlets...), split
+    //   into one draw per segment it touches when indices are 16 bit
+    void draw(ID3D12GraphicsCommandList* command_list, uint32_t first_index, uint32_t index_count) const;
 
-    static std::shared_ptr<Mesh> Load(const char* path);
+    // weld_epsilon > 0 merges verts that are *nearly* identical too,
+    //   tangent_mode is one of TANGENT_MODE_* (MeshTangents.h)
+    static std::shared_ptr<Mesh> Load(const char* path, float weld_epsilon = 0.0f, uint32_t tangent_mode = TANGENT_MODE_FAST);
 };
@@ -0,0 +1,657 @@
+#include "MeshBounds.h"
+
+#include "Parallel.h"
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+    // verts per chunk for every pass, big enough to be worth a thread
+    constexpr uint32_t CHUNK_VERTICES = 65536;
+    // extreme points are tracked per block of this many verts, the winning
+    //   block gets searched again for the actual vertex
+    constexpr uint32_t EXTREME_BLOCK_VERTICES = 256;
+    // extreme points get searched along the 3 axes (which double as the
+    //   AABB), the 4 cube diagonals & the 6 cube edge directions
+    constexpr uint32_t DIRECTION_COUNT = 13;
+    // points this close to the sphere's surface (relative to its radius)
+    //   count as inside, keeps Welzl from chasing rounding noise
+    constexpr float SPHERE_EPSILON = 1e-5f;
+    // slack for the oriented box, relative to how big its numbers are
+    constexpr float BOX_EPSILON = 1e-6f;
+    // how long Jacobi gets to diagonalize the covariance, 3x3 converges in ~5
+    constexpr uint32_t MAX_JACOBI_SWEEPS = 16;
+
+    // one chunk's most extreme verts along every direction
+    struct ChunkExtremes {
+        float min_value[DIRECTION_COUNT];
+        float max_value[DIRECTION_COUNT];
+        uint32_t min_index[DIRECTION_COUNT];
+        uint32_t max_index[DIRECTION_COUNT];
+    };
+
+    // one chunk's position sums, relative to the AABB's center
+    struct ChunkMoments {
+        double sum[3];
+        // xx, yy, zz, xy, xz, yz
+        double products[6];
+    };
+
+    struct Sphere {
+        XMVECTOR center;
+        // negative means empty
+        float radius;
+    };
+}
+
+// rows in, columns out
+static void transpose4(XMVECTOR* rows) {
+    XMVECTOR t0 = XMVectorMergeXY(rows[0], rows[2]);
+    XMVECTOR t1 = XMVectorMergeXY(rows[1], rows[3]);
+    XMVECTOR t2 = XMVectorMergeZW(rows[0], rows[2]);
+    XMVECTOR t3 = XMVectorMergeZW(rows[1], rows[3]);
+    rows[0] = XMVectorMergeXY(t0, t1);
+    rows[1] = XMVectorMergeZW(t0, t1);
+    rows[2] = XMVectorMergeXY(t2, t3);
+    rows[3] = XMVectorMergeZW(t2, t3);
+}
+
+// positions get loaded as (position, u) float4s, the u just ends up in a lane nobody reads
+static_assert(offsetof(Vertex, Position) == 0 && offsetof(Vertex, UV) == 12, "position loads assume this Vertex layout");
+
+// 4 verts' positions as x, y & z lanes. lanes past end repeat the last
+//   vertex, which never changes a min or max
+static void load_positions(const Vertex* vertices, uint32_t first, uint32_t end, XMVECTOR* out_xyz) {
+    XMVECTOR rows[4];
+    for (uint32_t k = 0; k < 4; k++) {
+        rows[k] = XMLoadFloat4((const XMFLOAT4*)&vertices[first + k < end ? first + k : end - 1].Position);
+    }
+    transpose4(rows);
+    out_xyz[0] = rows[0];
+    out_xyz[1] = rows[1];
+    out_xyz[2] = rows[2];
+}
+
+// dot products with every search direction, they're all made of +-1 and 0
+//   so adds are enough (lengths differ, which doesn't matter for picking extremes)
+static void project_directions(const XMVECTOR* xyz, XMVECTOR* out_values) {
+    XMVECTOR x = xyz[0], y = xyz[1], z = xyz[2];
+    XMVECTOR x_plus_y = x + y;
+    XMVECTOR x_minus_y = x - y;
+    out_values[0] = x;
+    out_values[1] = y;
+    out_values[2] = z;
+    out_values[3] = x_plus_y + z;
+    out_values[4] = x_plus_y - z;
+    out_values[5] = x_minus_y + z;
+    out_values[6] = x_minus_y - z;
+    out_values[7] = x_plus_y;
+    out_values[8] = x_minus_y;
+    out_values[9] = x + z;
+    out_values[10] = x - z;
+    out_values[11] = y + z;
+    out_values[12] = y - z;
+}
+
+// the vertex in [first, end) whose projection along direction is exactly value
+static uint32_t find_extreme_vertex(const Vertex* vertices, uint32_t first, uint32_t end, uint32_t direction, float value) {
+    XMVECTOR xyz[3];
+    XMVECTOR values[DIRECTION_COUNT];
+    for (uint32_t i = first; i < end; i += 4) {
+        load_positions(vertices, i, end, xyz);
+        project_directions(xyz, values);
+        XMFLOAT4 lanes;
+        XMStoreFloat4(&lanes, values[direction]);
+        const float* lane_array = &lanes.x;
+        for (uint32_t k = 0; k < 4; k++) {
+            if (lane_array[k] == value) return i + k < end ? i + k : end - 1;
+        }
+    }
+    return first;
+}
+
+static void find_extremes(const Vertex* vertices, uint32_t first, uint32_t end, ChunkExtremes* out) {
+    // the hot loop only keeps min & max values per block. which block won
+    //   gets carried along per lane, and the winning vertex is dug back out
+    //   of that one block at the end
+    XMVECTOR best_min[DIRECTION_COUNT], best_max[DIRECTION_COUNT];
+    XMVECTOR best_min_block[DIRECTION_COUNT], best_max_block[DIRECTION_COUNT];
+    for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+        best_min[d] = XMVectorReplicate(FLT_MAX);
+        best_max[d] = XMVectorReplicate(-FLT_MAX);
+        best_min_block[d] = best_max_block[d] = XMVectorZero();
+    }
+
+    XMVECTOR xyz[3];
+    XMVECTOR values[DIRECTION_COUNT];
+    XMVECTOR block_min[DIRECTION_COUNT], block_max[DIRECTION_COUNT];
+    XMVECTOR block = XMVectorZero();
+    for (uint32_t block_first = first; block_first < end; block_first += EXTREME_BLOCK_VERTICES) {
+        uint32_t block_end = end - block_first > EXTREME_BLOCK_VERTICES ? block_first + EXTREME_BLOCK_VERTICES : end;
+
+        load_positions(vertices, block_first, block_end, xyz);
+        project_directions(xyz, block_min);
+        for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+            block_max[d] = block_min[d];
+        }
+        for (uint32_t i = block_first + 4; i < block_end; i += 4) {
+            load_positions(vertices, i, block_end, xyz);
+            project_directions(xyz, values);
+            for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+                block_min[d] = XMVectorMin(block_min[d], values[d]);
+                block_max[d] = XMVectorMax(block_max[d], values[d]);
+            }
+        }
+
+        for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+            XMVECTOR less = XMVectorLess(block_min[d], best_min[d]);
+            best_min[d] = XMVectorSelect(best_min[d], block_min[d], less);
+            best_min_block[d] = XMVectorSelect(best_min_block[d], block, less);
+            XMVECTOR greater = XMVectorGreater(block_max[d], best_max[d]);
+            best_max[d] = XMVectorSelect(best_max[d], block_max[d], greater);
+            best_max_block[d] = XMVectorSelect(best_max_block[d], block, greater);
+        }
+        block += XMVectorSplatOne();
+    }
+
+    // 4 lanes down to 1, then back to an actual vertex
+    for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+        XMFLOAT4 mins, maxs, min_blocks, max_blocks;
+        XMStoreFloat4(&mins, best_min[d]);
+        XMStoreFloat4(&maxs, best_max[d]);
+        XMStoreFloat4(&min_blocks, best_min_block[d]);
+        XMStoreFloat4(&max_blocks, best_max_block[d]);
+        const float* min_array = &mins.x;
+        const float* max_array = &maxs.x;
+        uint32_t best_min_lane = 0, best_max_lane = 0;
+        for (uint32_t k = 1; k < 4; k++) {
+            best_min_lane = min_array[k] < min_array[best_min_lane] ? k : best_min_lane;
+            best_max_lane = max_array[k] > max_array[best_max_lane] ? k : best_max_lane;
+        }
+        out->min_value[d] = min_array[best_min_lane];
+        out->max_value[d] = max_array[best_max_lane];
+
+        uint32_t min_first = first + (uint32_t)(&min_blocks.x)[best_min_lane] * EXTREME_BLOCK_VERTICES;
+        uint32_t max_first = first + (uint32_t)(&max_blocks.x)[best_max_lane] * EXTREME_BLOCK_VERTICES;
+        uint32_t min_end = end - min_first > EXTREME_BLOCK_VERTICES ? min_first + EXTREME_BLOCK_VERTICES : end;
+        uint32_t max_end = end - max_first > EXTREME_BLOCK_VERTICES ? max_first + EXTREME_BLOCK_VERTICES : end;
+        out->min_index[d] = find_extreme_vertex(vertices, min_first, min_end, d, out->min_value[d]);
+        out->max_index[d] = find_extreme_vertex(vertices, max_first, max_end, d, out->max_value[d]);
+    }
+}
+
+static float max_distance_sq(const Vertex* vertices, uint32_t first, uint32_t end, XMVECTOR center) {
+    XMVECTOR cx = XMVectorReplicate(XMVectorGetX(center));
+    XMVECTOR cy = XMVectorReplicate(XMVectorGetY(center));
+    XMVECTOR cz = XMVectorReplicate(XMVectorGetZ(center));
+    XMVECTOR result = XMVectorZero();
+    XMVECTOR xyz[3];
+    for (uint32_t i = first; i < end; i += 4) {
+        load_positions(vertices, i, end, xyz);
+        XMVECTOR dx = xyz[0] - cx;
+        XMVECTOR dy = xyz[1] - cy;
+        XMVECTOR dz = xyz[2] - cz;
+        result = XMVectorMax(result, XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, dz * dz)));
+    }
+    XMFLOAT4 lanes;
+    XMStoreFloat4(&lanes, result);
+    float a = lanes.x > lanes.y ? lanes.x : lanes.y;
+    float b = lanes.z > lanes.w ? lanes.z : lanes.w;
+    return a > b ? a : b;
+}
+
+// Ritter's pass, every vertex outside pulls the sphere just far enough to
+//   touch it. the new sphere always contains the old one
+static void grow_sphere(const Vertex* vertices, uint32_t first, uint32_t end, Sphere* sphere) {
+    float radius_sq = sphere->radius * sphere->radius;
+    for (uint32_t i = first; i < end; i++) {
+        XMVECTOR offset = XMLoadFloat3(&vertices[i].Position) - sphere->center;
+        float distance_sq = XMVectorGetX(XMVector3LengthSq(offset));
+        if (distance_sq <= radius_sq) continue;
+
+        float distance = sqrtf(distance_sq);
+        float radius = (sphere->radius + distance) * 0.5f;
+        sphere->center += offset * ((radius - sphere->radius) / distance);
+        sphere->radius = radius;
+        radius_sq = radius * radius;
+    }
+}
+
+static bool sphere_contains(const Sphere& sphere, XMVECTOR point) {
+    if (sphere.radius < 0.0f) return false;
+    float limit = sphere.radius * (1.0f + SPHERE_EPSILON);
+    return XMVectorGetX(XMVector3LengthSq(point - sphere.center)) <= limit * limit;
+}
+
+static Sphere sphere_from_two(XMVECTOR a, XMVECTOR b) {
+    return { (a + b) * 0.5f, XMVectorGetX(XMVector3Length(b - a)) * 0.5f };
+}
+
+// smallest of the candidate spheres that holds every point, for
+//   collinear / coplanar support sets that have no circumsphere
+static Sphere smallest_enclosing(const Sphere* candidates, uint32_t candidate_count, const XMVECTOR* points, uint32_t point_count) {
+    Sphere best = { XMVectorZero(), -1.0f };
+    for (uint32_t c = 0; c < candidate_count; c++) {
+        bool encloses = true;
+        for (uint32_t p = 0; p < point_count && encloses; p++) {
+            encloses = sphere_contains(candidates[c], points[p]);
+        }
+        if (encloses && (best.radius < 0.0f || candidates[c].radius < best.radius)) {
+            best = candidates[c];
+        }
+    }
+    return best;
+}
+
+static Sphere sphere_from_three(XMVECTOR p0, XMVECTOR p1, XMVECTOR p2) {
+    XMVECTOR a = p1 - p0;
+    XMVECTOR b = p2 - p0;
+    XMVECTOR normal = XMVector3Cross(a, b);
+    float denominator = 2.0f * XMVectorGetX(XMVector3LengthSq(normal));
+    float scale = XMVectorGetX(XMVector3LengthSq(a)) + XMVectorGetX(XMVector3LengthSq(b));
+
+    if (denominator <= scale * scale * 1e-10f) {
+        // collinear, the two farthest apart points hold the third
+        XMVECTOR points[3] = { p0, p1, p2 };
+        Sphere candidates[3] = { sphere_from_two(p0, p1), sphere_from_two(p0, p2), sphere_from_two(p1, p2) };
+        return smallest_enclosing(candidates, 3, points, 3);
+    }
+
+    XMVECTOR offset = (
+        XMVector3Cross(normal, a) * XMVectorGetX(XMVector3LengthSq(b)) +
+        XMVector3Cross(b, normal) * XMVectorGetX(XMVector3LengthSq(a))
+    ) / denominator;
+    return { p0 + offset, XMVectorGetX(XMVector3Length(offset)) };
+}
+
+static Sphere sphere_from_four(XMVECTOR p0, XMVECTOR p1, XMVECTOR p2, XMVECTOR p3) {
+    XMVECTOR a = p1 - p0;
+    XMVECTOR b = p2 - p0;
+    XMVECTOR c = p3 - p0;
+    float determinant = 2.0f * XMVectorGetX(XMVector3Dot(a, XMVector3Cross(b, c)));
+    float scale = XMVectorGetX(XMVector3Length(a)) * XMVectorGetX(XMVector3Length(b)) * XMVectorGetX(XMVector3Length(c));
+
+    if (fabsf(determinant) <= scale * 1e-6f) {
+        // coplanar, one of the smaller spheres has to do
+        XMVECTOR points[4] = { p0, p1, p2, p3 };
+        Sphere candidates[10] = {
+            sphere_from_two(p0, p1), sphere_from_two(p0, p2), sphere_from_two(p0, p3),
+            sphere_from_two(p1, p2), sphere_from_two(p1, p3), sphere_from_two(p2, p3),
+            sphere_from_three(p0, p1, p2), sphere_from_three(p0, p1, p3),
+            sphere_from_three(p0, p2, p3), sphere_from_three(p1, p2, p3)
+        };
+        return smallest_enclosing(candidates, 10, points, 4);
+    }
+
+    XMVECTOR offset = (
+        XMVector3Cross(b, c) * XMVectorGetX(XMVector3LengthSq(a)) +
+        XMVector3Cross(c, a) * XMVectorGetX(XMVector3LengthSq(b)) +
+        XMVector3Cross(a, b) * XMVectorGetX(XMVector3LengthSq(c))
+    ) / determinant;
+    return { p0 + offset, XMVectorGetX(XMVector3Length(offset)) };
+}
+
+static Sphere sphere_from_support(const XMVECTOR* support, uint32_t count) {
+    switch (count) {
+        case 1: return { support[0], 0.0f };
+        case 2: return sphere_from_two(support[0], support[1]);
+        case 3: return sphere_from_three(support[0], support[1], support[2]);
+        case 4: return sphere_from_four(support[0], support[1], support[2], support[3]);
+        default: return { XMVectorZero(), -1.0f };
+    }
+}
+
+// exact minimum sphere, only ever run on the handful of extreme points
+static Sphere welzl(const XMVECTOR* points, uint32_t count, XMVECTOR* support, uint32_t support_count) {
+    if (count == 0 || support_count == 4) {
+        return sphere_from_support(support, support_count);
+    }
+
+    Sphere sphere = welzl(points, count - 1, support, support_count);
+    if (sphere_contains(sphere, points[count - 1])) {
+        return sphere;
+    }
+
+    support[support_count] = points[count - 1];
+    return welzl(points, count - 1, support, support_count + 1);
+}
+
+static void sum_moments(const Vertex* vertices, uint32_t first, uint32_t end, XMVECTOR origin, ChunkMoments* out) {
+    XMVECTOR ox = XMVectorReplicate(XMVectorGetX(origin));
+    XMVECTOR oy = XMVectorReplicate(XMVectorGetY(origin));
+    XMVECTOR oz = XMVectorReplicate(XMVectorGetZ(origin));
+    XMVECTOR lane = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+
+    XMVECTOR sum[3] = { XMVectorZero(), XMVectorZero(), XMVectorZero() };
+    XMVECTOR products[6] = { XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero() };
+    XMVECTOR xyz[3];
+    for (uint32_t i = first; i < end; i += 4) {
+        load_positions(vertices, i, end, xyz);
+        // repeated lanes at the end have to add nothing
+        XMVECTOR valid = XMVectorLess(lane, XMVectorReplicate((float)(end - i)));
+        XMVECTOR x = XMVectorAndInt(xyz[0] - ox, valid);
+        XMVECTOR y = XMVectorAndInt(xyz[1] - oy, valid);
+        XMVECTOR z = XMVectorAndInt(xyz[2] - oz, valid);
+        sum[0] += x;
+        sum[1] += y;
+        sum[2] += z;
+        products[0] = XMVectorMultiplyAdd(x, x, products[0]);
+        products[1] = XMVectorMultiplyAdd(y, y, products[1]);
+        products[2] = XMVectorMultiplyAdd(z, z, products[2]);
+        products[3] = XMVectorMultiplyAdd(x, y, products[3]);
+        products[4] = XMVectorMultiplyAdd(x, z, products[4]);
+        products[5] = XMVectorMultiplyAdd(y, z, products[5]);
+    }
+
+    for (uint32_t k = 0; k < 9; k++) {
+        XMFLOAT4 lanes;
+        XMStoreFloat4(&lanes, k < 3 ? sum[k] : products[k - 3]);
+        double total = (double)lanes.x + lanes.y + lanes.z + lanes.w;
+        if (k < 3) {
+            out->sum[k] = total;
+        } else {
+            out->products[k - 3] = total;
+        }
+    }
+}
+
+// eigenvectors of a symmetric 3x3 (cyclic Jacobi), they come out as the columns of out_vectors
+static void jacobi_eigenvectors(double m[3][3], double out_vectors[3][3]) {
+    for (uint32_t r = 0; r < 3; r++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            out_vectors[r][c] = r == c ? 1.0 : 0.0;
+        }
+    }
+
+    for (uint32_t sweep = 0; sweep < MAX_JACOBI_SWEEPS; sweep++) {
+        double off_diagonal = fabs(m[0][1]) + fabs(m[0][2]) + fabs(m[1][2]);
+        if (off_diagonal <= 1e-12 * (fabs(m[0][0]) + fabs(m[1][1]) + fabs(m[2][2]))) break;
+
+        for (uint32_t p = 0; p < 2; p++) {
+            for (uint32_t q = p + 1; q < 3; q++) {
+                if (m[p][q] == 0.0) continue;
+
+                // rotation in the pq plane that zeroes m[p][q]
+                double theta = (m[q][q] - m[p][p]) / (2.0 * m[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (uint32_t k = 0; k < 3; k++) {
+                    double mkp = m[k][p], mkq = m[k][q];
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (uint32_t k = 0; k < 3; k++) {
+                    double mpk = m[p][k], mqk = m[q][k];
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (uint32_t k = 0; k < 3; k++) {
+                    double vkp = out_vectors[k][p], vkq = out_vectors[k][q];
+                    out_vectors[k][p] = c * vkp - s * vkq;
+                    out_vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+// min & max of every vertex projected onto 3 axes (rows of axes)
+static void project_axes(const Vertex* vertices, uint32_t first, uint32_t end, const XMFLOAT3* axes, XMFLOAT3* out_min, XMFLOAT3* out_max) {
+    XMVECTOR splat[3][3];
+    for (uint32_t a = 0; a < 3; a++) {
+        splat[a][0] = XMVectorReplicate(axes[a].x);
+        splat[a][1] = XMVectorReplicate(axes[a].y);
+        splat[a][2] = XMVectorReplicate(axes[a].z);
+    }
+
+    XMVECTOR xyz[3];
+    XMVECTOR low[3], high[3];
+    for (uint32_t a = 0; a < 3; a++) {
+        low[a] = XMVectorReplicate(FLT_MAX);
+        high[a] = XMVectorReplicate(-FLT_MAX);
+    }
+    for (uint32_t i = first; i < end; i += 4) {
+        load_positions(vertices, i, end, xyz);
+        for (uint32_t a = 0; a < 3; a++) {
+            XMVECTOR value = XMVectorMultiplyAdd(xyz[0], splat[a][0], XMVectorMultiplyAdd(xyz[1], splat[a][1], xyz[2] * splat[a][2]));
+            low[a] = XMVectorMin(low[a], value);
+            high[a] = XMVectorMax(high[a], value);
+        }
+    }
+
+    float* mins = &out_min->x;
+    float* maxs = &out_max->x;
+    for (uint32_t a = 0; a < 3; a++) {
+        XMFLOAT4 l, h;
+        XMStoreFloat4(&l, low[a]);
+        XMStoreFloat4(&h, high[a]);
+        float lo0 = l.x < l.y ? l.x : l.y, lo1 = l.z < l.w ? l.z : l.w;
+        float hi0 = h.x > h.y ? h.x : h.y, hi1 = h.z > h.w ? h.z : h.w;
+        mins[a] = lo0 < lo1 ? lo0 : lo1;
+        maxs[a] = hi0 > hi1 ? hi0 : hi1;
+    }
+}
+
+// box half sizes grown by BOX_EPSILON of the box's own numbers, covers
+//   the rounding in halving min/max or projecting onto rotated axes
+static XMFLOAT3 padded_extents(XMFLOAT3 extents, XMVECTOR center) {
+    float largest = extents.x > extents.y ? extents.x : extents.y;
+    largest = extents.z > largest ? extents.z : largest;
+    float padding = BOX_EPSILON * (largest + XMVectorGetX(XMVector3Length(center)));
+    return XMFLOAT3(extents.x + padding, extents.y + padding, extents.z + padding);
+}
+
+static void fit_oriented_box(const Vertex* vertices, uint32_t vertex_count, uint32_t chunk_count, MeshBounds* bounds) {
+    // covariance relative to the AABB's center, keeps float sums from cancelling out
+    XMVECTOR origin = (XMLoadFloat3(&bounds->aabb_min) + XMLoadFloat3(&bounds->aabb_max)) * 0.5f;
+    std::vector<ChunkMoments> moments(chunk_count);
+    parallel_for(chunk_count, [&](uint32_t c) {
+        uint32_t first = c * CHUNK_VERTICES;
+        uint32_t end = vertex_count - first > CHUNK_VERTICES ? first + CHUNK_VERTICES : vertex_count;
+        sum_moments(vertices, first, end, origin, &moments[c]);
+    });
+
+    ChunkMoments total = {};
+    for (const ChunkMoments& m : moments) {
+        for (uint32_t k = 0; k < 3; k++) total.sum[k] += m.sum[k];
+        for (uint32_t k = 0; k < 6; k++) total.products[k] += m.products[k];
+    }
+    double mean[3] = { total.sum[0] / vertex_count, total.sum[1] / vertex_count, total.sum[2] / vertex_count };
+    double covariance[3][3];
+    covariance[0][0] = total.products[0] / vertex_count - mean[0] * mean[0];
+    covariance[1][1] = total.products[1] / vertex_count - mean[1] * mean[1];
+    covariance[2][2] = total.products[2] / vertex_count - mean[2] * mean[2];
+    covariance[0][1] = covariance[1][0] = total.products[3] / vertex_count - mean[0] * mean[1];
+    covariance[0][2] = covariance[2][0] = total.products[4] / vertex_count - mean[0] * mean[2];
+    covariance[1][2] = covariance[2][1] = total.products[5] / vertex_count - mean[1] * mean[2];
+
+    double vectors[3][3];
+    jacobi_eigenvectors(covariance, vectors);
+
+    // rows of a rotation, the third axis is rebuilt so it's right handed
+    XMVECTOR axis0 = XMVector3Normalize(XMVectorSet((float)vectors[0][0], (float)vectors[1][0], (float)vectors[2][0], 0.0f));
+    XMVECTOR axis1 = XMVector3Normalize(XMVectorSet((float)vectors[0][1], (float)vectors[1][1], (float)vectors[2][1], 0.0f));
+    XMMATRIX rotation = XMMatrixIdentity();
+    rotation.r[0] = axis0;
+    rotation.r[1] = axis1;
+    rotation.r[2] = XMVector3Normalize(XMVector3Cross(axis0, axis1));
+    XMVECTOR orientation = XMQuaternionNormalize(XMQuaternionRotationMatrix(rotation));
+
+    // extents are measured along the quaternion's own axes, so the box
+    //   still holds every vertex after the round trip through it
+    rotation = XMMatrixRotationQuaternion(orientation);
+    XMFLOAT3 axes[3];
+    for (uint32_t a = 0; a < 3; a++) {
+        XMStoreFloat3(&axes[a], rotation.r[a]);
+    }
+
+    std::vector<XMFLOAT3> chunk_min(chunk_count), chunk_max(chunk_count);
+    parallel_for(chunk_count, [&](uint32_t c) {
+        uint32_t first = c * CHUNK_VERTICES;
+        uint32_t end = vertex_count - first > CHUNK_VERTICES ? first + CHUNK_VERTICES : vertex_count;
+        project_axes(vertices, first, end, axes, &chunk_min[c], &chunk_max[c]);
+    });
+    XMVECTOR local_min = XMLoadFloat3(&chunk_min[0]);
+    XMVECTOR local_max = XMLoadFloat3(&chunk_max[0]);
+    for (uint32_t c = 1; c < chunk_count; c++) {
+        local_min = XMVectorMin(local_min, XMLoadFloat3(&chunk_min[c]));
+        local_max = XMVectorMax(local_max, XMLoadFloat3(&chunk_max[c]));
+    }
+
+    // PCA boxes can lose to the AABB (cubes, evenly spread verts), keep whichever is smaller
+    XMFLOAT3 extents, aabb_extents;
+    XMStoreFloat3(&extents, (local_max - local_min) * 0.5f);
+    XMStoreFloat3(&aabb_extents, (XMLoadFloat3(&bounds->aabb_max) - XMLoadFloat3(&bounds->aabb_min)) * 0.5f);
+    if (extents.x * extents.y * extents.z >= aabb_extents.x * aabb_extents.y * aabb_extents.z) return;
+
+    XMVECTOR local_center = (local_min + local_max) * 0.5f;
+    XMStoreFloat3(&bounds->obb_center, XMVector3TransformNormal(local_center, rotation));
+
+    // projecting onto rotated axes rounds, a little padding keeps every vertex inside
+    bounds->obb_extents = padded_extents(extents, local_center);
+    XMStoreFloat4(&bounds->obb_orientation, orientation);
+}
+
+void mesh_bounds_compute(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    bool oriented_box,
+    MeshBounds* out_bounds,
+    MeshBoundsStats* out_stats
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    *out_bounds = {};
+    out_bounds->obb_orientation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+    uint32_t chunk_count = (vertex_count + CHUNK_VERTICES - 1) / CHUNK_VERTICES;
+    if (out_stats != nullptr) {
+        *out_stats = {};
+        out_stats->thread_count = chunk_count < parallel_worker_count() ? chunk_count : parallel_worker_count();
+    }
+    if (vertex_count == 0) return;
+
+    // pass 1: extremes along every direction, the axis ones are the AABB
+    std::vector<ChunkExtremes> extremes(chunk_count);
+    parallel_for(chunk_count, [&](uint32_t c) {
+        uint32_t first = c * CHUNK_VERTICES;
+        uint32_t end = vertex_count - first > CHUNK_VERTICES ? first + CHUNK_VERTICES : vertex_count;
+        find_extremes(vertices, first, end, &extremes[c]);
+    });
+
+    ChunkExtremes total = extremes[0];
+    for (uint32_t c = 1; c < chunk_count; c++) {
+        for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+            if (extremes[c].min_value[d] < total.min_value[d]) {
+                total.min_value[d] = extremes[c].min_value[d];
+                total.min_index[d] = extremes[c].min_index[d];
+            }
+            if (extremes[c].max_value[d] > total.max_value[d]) {
+                total.max_value[d] = extremes[c].max_value[d];
+                total.max_index[d] = extremes[c].max_index[d];
+            }
+        }
+    }
+    out_bounds->aabb_min = XMFLOAT3(total.min_value[0], total.min_value[1], total.min_value[2]);
+    out_bounds->aabb_max = XMFLOAT3(total.max_value[0], total.max_value[1], total.max_value[2]);
+    out_bounds->obb_center = XMFLOAT3(
+        (total.min_value[0] + total.max_value[0]) * 0.5f,
+        (total.min_value[1] + total.max_value[1]) * 0.5f,
+        (total.min_value[2] + total.max_value[2]) * 0.5f
+    );
+    // center +- half size doesn't land exactly back on min & max, so this
+    //   box gets the same padding as a fitted one
+    out_bounds->obb_extents = padded_extents(
+        XMFLOAT3(
+            (total.max_value[0] - total.min_value[0]) * 0.5f,
+            (total.max_value[1] - total.min_value[1]) * 0.5f,
+            (total.max_value[2] - total.min_value[2]) * 0.5f
+        ),
+        XMLoadFloat3(&out_bounds->obb_center)
+    );
+
+    // exact sphere around the extremes
+    XMVECTOR points[DIRECTION_COUNT * 2];
+    for (uint32_t d = 0; d < DIRECTION_COUNT; d++) {
+        points[d * 2 + 0] = XMLoadFloat3(&vertices[total.min_index[d]].Position);
+        points[d * 2 + 1] = XMLoadFloat3(&vertices[total.max_index[d]].Position);
+    }
+    XMVECTOR support[4];
+    Sphere sphere = welzl(points, DIRECTION_COUNT * 2, support, 0);
+    if (sphere.radius < 0.0f) {
+        sphere = { points[0], 0.0f };
+    }
+
+    // pass 2: grow it over whatever's still outside. only chunks that
+    //   actually poke out get walked one vertex at a time, and since growing
+    //   never drops anything already inside, the order doesn't matter
+    std::vector<float> chunk_distance_sq(chunk_count);
+    parallel_for(chunk_count, [&](uint32_t c) {
+        uint32_t first = c * CHUNK_VERTICES;
+        uint32_t end = vertex_count - first > CHUNK_VERTICES ? first + CHUNK_VERTICES : vertex_count;
+        chunk_distance_sq[c] = max_distance_sq(vertices, first, end, sphere.center);
+    });
+    // chunks that fit the sphere from before any growing still fit after
+    float initial_radius_sq = sphere.radius * sphere.radius;
+    for (uint32_t c = 0; c < chunk_count; c++) {
+        if (chunk_distance_sq[c] <= initial_radius_sq) continue;
+        uint32_t first = c * CHUNK_VERTICES;
+        uint32_t end = vertex_count - first > CHUNK_VERTICES ? first + CHUNK_VERTICES : vertex_count;
+        grow_sphere(vertices, first, end, &sphere);
+    }
+    XMStoreFloat3(&out_bounds->sphere_center, sphere.center);
+    // a touch of slack for the rounding in the center moves
+    out_bounds->sphere_radius = sphere.radius * (1.0f + SPHERE_EPSILON);
+
+    if (oriented_box) {
+        fit_oriented_box(vertices, vertex_count, chunk_count, out_bounds);
+    }
+
+    if (out_stats != nullptr) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        out_stats->seconds = elapsed.count();
+    }
+}
+
+// world AABB of a box given as a center & half extents along the rows of axes (Arvo)
+static void box_to_world(XMVECTOR center, XMFLOAT3 extents, const XMMATRIX& axes, XMVECTOR* out_min, XMVECTOR* out_max) {
+    XMVECTOR half =
+        XMVectorAbs(axes.r[0]) * extents.x +
+        XMVectorAbs(axes.r[1]) * extents.y +
+        XMVectorAbs(axes.r[2]) * extents.z;
+    *out_min = center - half;
+    *out_max = center + half;
+}
+
+WorldBounds mesh_bounds_transform(const MeshBounds& bounds, FXMMATRIX world) {
+    XMVECTOR aabb_center = (XMLoadFloat3(&bounds.aabb_min) + XMLoadFloat3(&bounds.aabb_max)) * 0.5f;
+    XMFLOAT3 aabb_extents;
+    XMStoreFloat3(&aabb_extents, (XMLoadFloat3(&bounds.aabb_max) - XMLoadFloat3(&bounds.aabb_min)) * 0.5f);
+    XMVECTOR aabb_min, aabb_max;
+    box_to_world(XMVector3Transform(aabb_center, world), aabb_extents, world, &aabb_min, &aabb_max);
+
+    // both boxes hold the whole mesh, so their overlap does too
+    XMMATRIX obb_axes = XMMatrixMultiply(XMMatrixRotationQuaternion(XMLoadFloat4(&bounds.obb_orientation)), world);
+    XMVECTOR obb_min, obb_max;
+    box_to_world(XMVector3Transform(XMLoadFloat3(&bounds.obb_center), world), bounds.obb_extents, obb_axes, &obb_min, &obb_max);
+
+    WorldBounds result;
+    XMStoreFloat3(&result.aabb_min, XMVectorMax(aabb_min, obb_min));
+    XMStoreFloat3(&result.aabb_max, XMVectorMin(aabb_max, obb_max));
+
+    // longest axis of the matrix, exact for rotation + scale (shear from
+    //   non-uniformly scaled parents isn't accounted for)
+    float scale_sq = XMVectorGetX(XMVector3LengthSq(world.r[0]));
+    float scale_y_sq = XMVectorGetX(XMVector3LengthSq(world.r[1]));
+    float scale_z_sq = XMVectorGetX(XMVector3LengthSq(world.r[2]));
+    scale_sq = scale_y_sq > scale_sq ? scale_y_sq : scale_sq;
+    scale_sq = scale_z_sq > scale_sq ? scale_z_sq : scale_sq;
+    XMStoreFloat3(&result.sphere_center, XMVector3Transform(XMLoadFloat3(&bounds.sphere_center), world));
+    result.sphere_radius = bounds.sphere_radius * sqrtf(scale_sq);
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include "Vertex.h"
+
+// every bounding volume a mesh carries, all in object space
+struct MeshBounds {
+    DirectX::XMFLOAT3 aabb_min;
+    DirectX::XMFLOAT3 aabb_max;
+    DirectX::XMFLOAT3 sphere_center;
+    float sphere_radius;
+    // oriented box, half sizes along its own axes. when it doesn't beat
+    //   the AABB (or wasn't asked for) it *is* the AABB, identity orientation
+    DirectX::XMFLOAT3 obb_center;
+    DirectX::XMFLOAT3 obb_extents;
+    // quaternion taking the box's axes into object space
+    DirectX::XMFLOAT4 obb_orientation;
+};
+static_assert(sizeof(MeshBounds) == 80, "MeshBounds layout is part of the cooked mesh format");
+
+// bounds moved into world space, both are conservative
+struct WorldBounds {
+    DirectX::XMFLOAT3 aabb_min;
+    DirectX::XMFLOAT3 aabb_max;
+    DirectX::XMFLOAT3 sphere_center;
+    float sphere_radius;
+};
+
+struct MeshBoundsStats {
+    uint32_t thread_count;
+    double seconds;
+};
+
+// AABB & extreme points come out of one SIMD min/max pass over the verts,
+//   the sphere is the exact (Welzl) sphere of those extremes grown to fit
+//   every vertex (Ritter), usually within a couple % of optimal. the
+//   oriented box is fit along the verts' principal axes, it costs two more
+//   passes so it's optional. big meshes get split across threads
+void mesh_bounds_compute(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    bool oriented_box,
+    MeshBounds* out_bounds,
+    MeshBoundsStats* out_stats = nullptr
+);
+
+// world AABB is whichever of the transformed AABB & OBB is tighter per axis,
+//   the sphere's radius gets scaled by the matrix's longest axis
+WorldBounds mesh_bounds_transform(const MeshBounds& bounds, DirectX::FXMMATRIX world);
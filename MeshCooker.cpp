@@ -0,0 +1,321 @@
+#include "MeshCooker.h"
+
+#include "MeshSimplifier.h"
+#include "ContentHash.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace DirectX;
+
+void mesh_build(
+    const char* obj_data,
+    size_t obj_size,
+    float weld_epsilon,
+    uint32_t tangent_mode,
+    std::vector<Vertex>* out_vertices,
+    std::vector<uint32_t>* out_indices,
+    std::vector<MeshLod>* out_lods,
+    std::vector<Meshlet>* out_meshlets,
+    std::vector<MeshSegment>* out_segments,
+    MeshBounds* out_bounds,
+    MeshBuildStats* out_stats
+) {
+    //! code written by Chris Cascioli, acquired from:
+    //!  https://github.com/vixorien/ggp-demos/blob/main/GGP2/D3D12/01%20-%20Meshes%20%26%20Entities/Mesh.cpp
+    auto start_time = std::chrono::high_resolution_clock::now();
+    MeshBuildStats stats = {};
+
+    // Verts from file (including duplicates)
+    std::vector<Vertex> vertsFromFile;
+
+    // Parse the whole file up front (multithreaded),
+    // this already handles the RH -> LH conversion for us
+    obj_parse(obj_data, obj_size, &vertsFromFile, &stats.parse);
+
+    // Weld duplicate verts together (binary keyed, see VertexWeld.h)
+    vertex_weld(
+        vertsFromFile.data(), (uint32_t)vertsFromFile.size(),
+        weld_epsilon,
+        out_vertices,
+        out_indices,
+        &stats.weld
+    );
+
+    mesh_calculate_tangents(out_vertices, out_indices, tangent_mode, &stats.tangents);
+
+    // reorder for the GPU, done last so the cooked file stores the
+    //   optimized order and loading it again costs nothing
+    uint32_t* indices = out_indices->data();
+    size_t index_count = out_indices->size();
+    uint32_t vertex_count = (uint32_t)out_vertices->size();
+
+    if (out_stats) {
+        stats.cache_before = analyze_vertex_cache(indices, index_count, vertex_count);
+        stats.fetch_before = analyze_vertex_fetch(indices, index_count, vertex_count, GPUVertexLayout::STRIDE);
+    }
+
+    std::vector<uint32_t> cluster_starts;
+    optimize_vertex_cache(indices, index_count, vertex_count, &cluster_starts);
+    optimize_overdraw(indices, index_count, out_vertices->data(), vertex_count, cluster_starts);
+    stats.cluster_count = (uint32_t)cluster_starts.size();
+
+    // meshlets regroup LOD 0's triangles, they grow from the cache
+    //   optimized order so most of the locality carries over
+    meshlet_build(indices, index_count, out_vertices->data(), vertex_count, out_meshlets);
+
+    // LODs reuse LOD 0's vertices, so they get built before the fetch remap
+    //   (which then sees LOD 0 first and keeps its order linear)
+    std::vector<uint32_t> lod_indices;
+    mesh_build_lods(out_vertices->data(), vertex_count, indices, index_count, &lod_indices, out_lods);
+    out_indices->swap(lod_indices);
+    indices = out_indices->data();
+
+    vertex_count = optimize_vertex_fetch(out_vertices->data(), vertex_count, indices, out_indices->size());
+    out_vertices->resize(vertex_count);
+
+    // 16 bit indices whenever they fit, big meshes get split up if that pays off.
+    //   last, since splitting duplicates verts the passes above shouldn't see
+    stats.unsplit_vertex_count = vertex_count;
+    mesh_split_segments(
+        out_vertices, out_indices,
+        out_lods->data(), (uint32_t)out_lods->size(),
+        GPUVertexLayout::STRIDE,
+        out_segments
+    );
+    indices = out_indices->data();
+    vertex_count = (uint32_t)out_vertices->size();
+
+    // cooking is the place to pay for the oriented box
+    mesh_bounds_compute(out_vertices->data(), vertex_count, true, out_bounds, &stats.bounds);
+
+    if (out_stats) {
+        stats.cache_after = analyze_vertex_cache(indices, index_count, vertex_count);
+        stats.fetch_after = analyze_vertex_fetch(indices, index_count, vertex_count, GPUVertexLayout::STRIDE);
+
+        // same params as Mesh uses
+        stats.layout_error = vertex_layout_round_trip_error<GPUVertexLayout>(
+            out_vertices->data(), vertex_count,
+            vertex_encode_params_create(out_vertices->data(), vertex_count, out_bounds->aabb_min, out_bounds->aabb_max)
+        );
+
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        stats.seconds = elapsed.count();
+        *out_stats = stats;
+    }
+}
+
+uint64_t mesh_source_hash(const void* data, size_t size) {
+    return content_hash(data, size);
+}
+
+std::string cooked_mesh_path(const char* source_path) {
+    return std::filesystem::path(source_path).replace_extension(".mesh").string();
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool cooked_mesh_write(
+    const char* path,
+    uint64_t source_hash,
+    float weld_epsilon,
+    uint32_t tangent_mode,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    const Meshlet* meshlets,
+    uint32_t meshlet_count,
+    const MeshSegment* segments,
+    uint32_t segment_count,
+    const MeshBounds* bounds
+) {
+    // segments mean 16 bit indices, written relative to their base vertex
+    std::vector<uint16_t> narrow_indices;
+    const void* index_data = indices;
+    uint32_t index_stride = sizeof(uint32_t);
+    if (segment_count > 0) {
+        narrow_indices.resize(index_count);
+        mesh_narrow_indices(indices, segments, segment_count, narrow_indices.data());
+        index_data = narrow_indices.data();
+        index_stride = sizeof(uint16_t);
+    }
+
+    VertexEncodeParams encode_params = vertex_encode_params_create(vertices, vertex_count, bounds->aabb_min, bounds->aabb_max);
+    std::vector<uint8_t> encoded_vertices((size_t)vertex_count * GPUVertexLayout::STRIDE);
+    GPUVertexLayout::encode(vertices, vertex_count, encode_params, encoded_vertices.data());
+
+    CookedMeshHeader header = {};
+    header.magic = COOKED_MESH_MAGIC;
+    header.version = COOKED_MESH_VERSION;
+    header.source_hash = source_hash;
+    header.weld_epsilon = weld_epsilon;
+    header.tangent_mode = tangent_mode;
+    header.vertex_layout = VERTEX_LAYOUT;
+    header.vertex_stride = GPUVertexLayout::STRIDE;
+    header.vertex_count = vertex_count;
+    header.index_stride = index_stride;
+    header.index_count = index_count;
+    header.lod_count = lod_count;
+    header.meshlet_count = meshlet_count;
+    header.segment_count = segment_count;
+    header.meshlet_offset = align_up(sizeof(CookedMeshHeader) + (uint64_t)lod_count * sizeof(MeshLod), COOKED_MESH_ALIGNMENT);
+    header.segment_offset = align_up(header.meshlet_offset + (uint64_t)meshlet_count * sizeof(Meshlet), COOKED_MESH_ALIGNMENT);
+    header.vertex_offset = align_up(header.segment_offset + (uint64_t)segment_count * sizeof(MeshSegment), COOKED_MESH_ALIGNMENT);
+    header.index_offset = align_up(header.vertex_offset + (uint64_t)vertex_count * GPUVertexLayout::STRIDE, COOKED_MESH_ALIGNMENT);
+
+    header.bounds = *bounds;
+    header.encode_params = encode_params;
+
+    // write to a temp file first so a crash mid-write never
+    //   leaves a half-written cache that looks valid
+    std::string temp_path = std::string(path) + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        const char zeros[COOKED_MESH_ALIGNMENT] = {};
+        uint64_t lods_end = sizeof(header) + (uint64_t)lod_count * sizeof(MeshLod);
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)lods, (std::streamsize)lod_count * sizeof(MeshLod));
+        uint64_t meshlets_end = header.meshlet_offset + (uint64_t)meshlet_count * sizeof(Meshlet);
+        out.write(zeros, header.meshlet_offset - lods_end);
+        out.write((const char*)meshlets, (std::streamsize)meshlet_count * sizeof(Meshlet));
+        uint64_t segments_end = header.segment_offset + (uint64_t)segment_count * sizeof(MeshSegment);
+        out.write(zeros, header.segment_offset - meshlets_end);
+        out.write((const char*)segments, (std::streamsize)segment_count * sizeof(MeshSegment));
+        out.write(zeros, header.vertex_offset - segments_end);
+        out.write((const char*)encoded_vertices.data(), (std::streamsize)encoded_vertices.size());
+        out.write(zeros, header.index_offset - (header.vertex_offset + encoded_vertices.size()));
+        out.write((const char*)index_data, (std::streamsize)index_count * index_stride);
+
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(temp_path);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    return !error;
+}
+
+bool cooked_mesh_open(const char* path, uint64_t source_hash, float weld_epsilon, uint32_t tangent_mode, CookedMesh* out_mesh) {
+    *out_mesh = {};
+    if (!mapped_file_open(path, &out_mesh->file)) {
+        return false;
+    }
+
+    const MappedFile& file = out_mesh->file;
+    const CookedMeshHeader* header = (const CookedMeshHeader*)file.data;
+
+    bool valid =
+        file.size >= sizeof(CookedMeshHeader) &&
+        header->magic == COOKED_MESH_MAGIC &&
+        header->version == COOKED_MESH_VERSION &&
+        header->source_hash == source_hash &&
+        memcmp(&header->weld_epsilon, &weld_epsilon, sizeof(float)) == 0 &&
+        header->tangent_mode == tangent_mode &&
+        header->vertex_layout == VERTEX_LAYOUT &&
+        header->vertex_stride == GPUVertexLayout::STRIDE &&
+        (header->index_stride == sizeof(uint32_t) || (header->index_stride == sizeof(uint16_t) && header->segment_count > 0)) &&
+        header->lod_count > 0 &&
+        header->lod_count <= MESH_MAX_LODS &&
+        sizeof(CookedMeshHeader) + (uint64_t)header->lod_count * sizeof(MeshLod) <= header->meshlet_offset &&
+        header->meshlet_offset % COOKED_MESH_ALIGNMENT == 0 &&
+        header->meshlet_offset + (uint64_t)header->meshlet_count * sizeof(Meshlet) <= header->segment_offset &&
+        header->segment_offset % COOKED_MESH_ALIGNMENT == 0 &&
+        header->segment_offset + (uint64_t)header->segment_count * sizeof(MeshSegment) <= header->vertex_offset &&
+        header->vertex_offset % COOKED_MESH_ALIGNMENT == 0 &&
+        header->index_offset % COOKED_MESH_ALIGNMENT == 0 &&
+        header->vertex_offset + (uint64_t)header->vertex_count * header->vertex_stride <= file.size &&
+        header->index_offset + (uint64_t)header->index_count * header->index_stride <= file.size;
+
+    if (!valid) {
+        cooked_mesh_close(out_mesh);
+        return false;
+    }
+
+    out_mesh->header = header;
+    out_mesh->vertices = file.data + header->vertex_offset;
+    out_mesh->indices = file.data + header->index_offset;
+    out_mesh->lods = (const MeshLod*)(file.data + sizeof(CookedMeshHeader));
+    out_mesh->meshlets = (const Meshlet*)(file.data + header->meshlet_offset);
+    out_mesh->segments = (const MeshSegment*)(file.data + header->segment_offset);
+
+    // LOD ranges have to actually fit in the index array
+    for (uint32_t i = 0; i < header->lod_count; i++) {
+        const MeshLod& lod = out_mesh->lods[i];
+        if ((uint64_t)lod.first_index + lod.index_count > header->index_count) {
+            cooked_mesh_close(out_mesh);
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->meshlet_count; i++) {
+        const Meshlet& meshlet = out_mesh->meshlets[i];
+        if ((uint64_t)meshlet.first_index + meshlet.index_count > out_mesh->lods[0].index_count) {
+            cooked_mesh_close(out_mesh);
+            return false;
+        }
+    }
+    // segments have to be sorted, in range and reachable from their base vertex
+    for (uint32_t i = 0; i < header->segment_count; i++) {
+        const MeshSegment& segment = out_mesh->segments[i];
+        bool sorted = i == 0 || out_mesh->segments[i - 1].first_index + out_mesh->segments[i - 1].index_count <= segment.first_index;
+        if (!sorted || (uint64_t)segment.first_index + segment.index_count > header->index_count || segment.base_vertex >= header->vertex_count) {
+            cooked_mesh_close(out_mesh);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void cooked_mesh_close(CookedMesh* mesh) {
+    mapped_file_close(&mesh->file);
+    *mesh = {};
+}
+
+bool mesh_cook(const char* obj_path, float weld_epsilon, uint32_t tangent_mode) {
+    MappedFile source;
+    if (!mapped_file_open(obj_path, &source)) {
+        throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshSegment> segments;
+    MeshBounds bounds;
+    uint64_t source_hash = mesh_source_hash(source.data, source.size);
+    try {
+        mesh_build((const char*)source.data, source.size, weld_epsilon, tangent_mode, &vertices, &indices, &lods, &meshlets, &segments, &bounds);
+    } catch (...) {
+        mapped_file_close(&source);
+        throw;
+    }
+    mapped_file_close(&source);
+
+    return cooked_mesh_write(
+        cooked_mesh_path(obj_path).c_str(),
+        source_hash,
+        weld_epsilon,
+        tangent_mode,
+        vertices.data(), (uint32_t)vertices.size(),
+        indices.data(), (uint32_t)indices.size(),
+        lods.data(), (uint32_t)lods.size(),
+        meshlets.data(), (uint32_t)meshlets.size(),
+        segments.data(), (uint32_t)segments.size(),
+        &bounds
+    );
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MeshBounds.h"
+#include "MeshLod.h"
+#include "MeshSegment.h"
+#include "MeshTangents.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "ObjParser.h"
+#include "Vertex.h"
+#include "VertexLayout.h"
+#include "VertexWeld.h"
+
+constexpr uint32_t COOKED_MESH_MAGIC = 0x4853454D; // "MESH"
+constexpr uint32_t COOKED_MESH_VERSION = 12;
+// vertex & index arrays start on this boundary inside the file
+constexpr uint64_t COOKED_MESH_ALIGNMENT = 16;
+
+// header at the very start of a cooked .mesh file, followed by the LOD
+//   table, the meshlet table, the index segment table, the vertex array
+//   (already encoded in GPUVertexLayout) and then every LOD's indices back to back
+struct CookedMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    // hash of the source OBJ's bytes, if this doesn't match the cache is stale
+    uint64_t source_hash;
+    float weld_epsilon;
+    // GPUVertexLayout::STRIDE
+    uint32_t vertex_stride;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    // byte offsets from the start of the file
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    // AABB, sphere & oriented box, so loading never has to walk the verts for them
+    MeshBounds bounds;
+    // 2 or 4, 16 bit indices are relative to their segment's base vertex
+    uint32_t index_stride;
+    uint32_t lod_count;
+    // meshlets only cover LOD 0
+    uint32_t meshlet_count;
+    // only 16 bit indices have segments
+    uint32_t segment_count;
+    uint64_t meshlet_offset;
+    uint64_t segment_offset;
+    // TANGENT_MODE_*, MikkTSpace tangents split verts so the whole mesh depends on it
+    uint32_t tangent_mode;
+    // VERTEX_LAYOUT_*, a build with another layout has to recook
+    uint32_t vertex_layout;
+    // what the vertex array was encoded with, the shaders decode with it
+    VertexEncodeParams encode_params;
+};
+static_assert(sizeof(CookedMeshHeader) == 208, "CookedMeshHeader layout is part of the file format");
+static_assert(sizeof(MeshLod) == 12, "MeshLod layout is part of the file format");
+static_assert(sizeof(Meshlet) == 48, "Meshlet layout is part of the file format");
+static_assert(sizeof(MeshSegment) == 16, "MeshSegment layout is part of the file format");
+static_assert(sizeof(VertexEncodeParams) == 40, "VertexEncodeParams layout is part of the file format");
+
+// a cooked mesh mapped into memory, vertices/indices point straight into the mapping
+struct CookedMesh {
+    MappedFile file;
+    const CookedMeshHeader* header;
+    // header->vertex_stride bytes each, ready to upload as is
+    const void* vertices;
+    // header->index_stride bytes each
+    const void* indices;
+    const MeshLod* lods;
+    const Meshlet* meshlets;
+    const MeshSegment* segments;
+};
+
+// what each step of mesh_build did, for tools & tests
+struct MeshBuildStats {
+    ObjParseStats parse;
+    VertexWeldStats weld;
+    TangentStats tangents;
+    // LOD 0 as it came out of welding vs as it gets drawn
+    VertexCacheStats cache_before;
+    VertexCacheStats cache_after;
+    VertexFetchStats fetch_before;
+    VertexFetchStats fetch_after;
+    uint32_t cluster_count;
+    // before mesh_split_segments duplicated any for 16 bit indices
+    uint32_t unsplit_vertex_count;
+    MeshBoundsStats bounds;
+    // what GPUVertexLayout loses with the params the mesh gets uploaded with
+    VertexLayoutError layout_error;
+    double seconds;
+};
+
+// runs the full OBJ -> GPU ready pipeline (parse, weld, tangents,
+//   optimize, meshlets, LODs, 16 bit segments, bounds). out_indices holds every LOD,
+//   see out_lods for ranges. out_segments is empty if indices have to stay 32 bit.
+//   tangent_mode is one of TANGENT_MODE_*. out_stats costs a couple of
+//   extra passes (cache/fetch simulations, a layout round trip), leave it
+//   null outside of tools
+void mesh_build(
+    const char* obj_data,
+    size_t obj_size,
+    float weld_epsilon,
+    uint32_t tangent_mode,
+    std::vector<Vertex>* out_vertices,
+    std::vector<uint32_t>* out_indices,
+    std::vector<MeshLod>* out_lods,
+    std::vector<Meshlet>* out_meshlets,
+    std::vector<MeshSegment>* out_segments,
+    MeshBounds* out_bounds,
+    MeshBuildStats* out_stats = nullptr
+);
+
+// content hash used to detect stale caches
+uint64_t mesh_source_hash(const void* data, size_t size);
+
+// "Assets/Meshes/cube.obj" -> "Assets/Meshes/cube.mesh"
+std::string cooked_mesh_path(const char* source_path);
+
+// verts get encoded to GPUVertexLayout (only mesh_build needs them at full
+//   precision), indices get written as 16 bit (relative to their segment)
+//   when there are segments
+bool cooked_mesh_write(
+    const char* path,
+    uint64_t source_hash,
+    float weld_epsilon,
+    uint32_t tangent_mode,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    const Meshlet* meshlets,
+    uint32_t meshlet_count,
+    const MeshSegment* segments,
+    uint32_t segment_count,
+    const MeshBounds* bounds
+);
+
+// maps a cooked mesh, failing if it's missing, corrupt, from an older
+//   version or was cooked from different source bytes/weld/tangent settings
+bool cooked_mesh_open(const char* path, uint64_t source_hash, float weld_epsilon, uint32_t tangent_mode, CookedMesh* out_mesh);
+void cooked_mesh_close(CookedMesh* mesh);
+
+// offline entry point: always rebuilds the .mesh next to the OBJ
+//! throws std::invalid_argument if the OBJ can't be opened or parsed
+bool mesh_cook(const char* obj_path, float weld_epsilon = 0.0f, uint32_t tangent_mode = TANGENT_MODE_FAST);
@@ -0,0 +1,44 @@
+#include "MeshLod.h"
+
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+float mesh_lod_projected_radius(
+    XMFLOAT3 center,
+    float radius,
+    XMFLOAT3 camera_position,
+    float fov,
+    float screen_height
+) {
+    float distance_squared = XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&center) - XMLoadFloat3(&camera_position)));
+    float radius_squared = radius * radius;
+    if (distance_squared <= radius_squared) {
+        return FLT_MAX;
+    }
+
+    // tangent distance instead of center distance so spheres near the
+    //   camera don't get underestimated
+    float projected = radius / (sqrtf(distance_squared - radius_squared) * tanf(fov * 0.5f));
+    return projected * screen_height * 0.5f;
+}
+
+uint32_t mesh_lod_select(const MeshLod* lods, uint32_t lod_count, float projected_radius, uint32_t current_lod) {
+    if (lod_count == 0) return 0;
+
+    uint32_t lod = current_lod < lod_count ? current_lod : lod_count - 1;
+
+    // refine straight away if the current LOD is visibly wrong...
+    while (lod > 0 && lods[lod].error * projected_radius > MESH_LOD_ERROR_PIXELS) {
+        lod--;
+    }
+
+    // ...but only coarsen once we're comfortably under the threshold
+    float coarsen_threshold = MESH_LOD_ERROR_PIXELS * (1.0f - MESH_LOD_HYSTERESIS);
+    while (lod + 1 < lod_count && lods[lod + 1].error * projected_radius <= coarsen_threshold) {
+        lod++;
+    }
+
+    return lod;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+
+// most LODs a mesh can have, LOD 0 is always the full detail mesh
+constexpr uint32_t MESH_MAX_LODS = 8;
+// how big (in pixels) a LOD's error can get on screen before we switch to a finer one
+constexpr float MESH_LOD_ERROR_PIXELS = 1.0f;
+// a coarser LOD only gets picked once its error is this much under the
+//   threshold, stops entities sitting on the boundary from popping every frame
+constexpr float MESH_LOD_HYSTERESIS = 0.25f;
+
+// one level of detail, all LODs share a vertex buffer and index buffer
+//! part of the cooked mesh format, don't reorder
+struct MeshLod {
+    uint32_t first_index;
+    uint32_t index_count;
+    // simplification error relative to the mesh's bounding sphere radius
+    float error;
+};
+
+// radius of a bounding sphere once projected to the screen, in pixels. returns
+//   FLT_MAX if the camera is inside the sphere
+float mesh_lod_projected_radius(
+    DirectX::XMFLOAT3 center,
+    float radius,
+    DirectX::XMFLOAT3 camera_position,
+    float fov,
+    float screen_height
+);
+
+// picks the coarsest LOD whose error is under MESH_LOD_ERROR_PIXELS on
+//   screen, starting from the LOD that was used last frame
+uint32_t mesh_lod_select(const MeshLod* lods, uint32_t lod_count, float projected_radius, uint32_t current_lod);
@@ -0,0 +1,310 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace {
+    constexpr uint32_t INVALID_VERTEX = UINT32_MAX;
+
+    // vertex -> triangles lookup, stored as one flat array + offsets
+    struct TriangleAdjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+        std::vector<uint32_t> counts;
+    };
+
+    // fetch simulation assumes 64 byte lines and a 4KB cache
+    constexpr uint32_t FETCH_LINE_SIZE = 64;
+    constexpr uint32_t FETCH_CACHE_LINES = 64;
+}
+
+static void build_adjacency(const uint32_t* indices, size_t index_count, uint32_t vertex_count, TriangleAdjacency* out) {
+    out->counts.assign(vertex_count, 0);
+    for (size_t i = 0; i < index_count; i++) {
+        out->counts[indices[i]]++;
+    }
+
+    out->offsets.resize((size_t)vertex_count + 1);
+    out->offsets[0] = 0;
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        out->offsets[v + 1] = out->offsets[v] + out->counts[v];
+    }
+
+    out->triangles.resize(index_count);
+    std::vector<uint32_t> cursors(out->offsets.begin(), out->offsets.end() - 1);
+    for (size_t i = 0; i < index_count; i++) {
+        out->triangles[cursors[indices[i]]++] = (uint32_t)(i / 3);
+    }
+}
+
+// picks the next fanning vertex, preferring whatever's in the cache and
+//   will still be in it after emitting all of its remaining triangles
+static uint32_t next_fanning_vertex(
+    const std::vector<uint32_t>& candidates,
+    const std::vector<uint32_t>& live_counts,
+    const std::vector<uint32_t>& cache_times,
+    uint32_t time,
+    uint32_t cache_size
+) {
+    uint32_t best = INVALID_VERTEX;
+    int64_t best_priority = -1;
+
+    for (uint32_t v : candidates) {
+        if (live_counts[v] == 0) continue;
+
+        int64_t age = (int64_t)time - cache_times[v];
+        int64_t priority = 0;
+        if (age + 2 * (int64_t)live_counts[v] <= cache_size) {
+            priority = age;
+        }
+
+        if (priority > best_priority) {
+            best_priority = priority;
+            best = v;
+        }
+    }
+
+    return best;
+}
+
+void optimize_vertex_cache(
+    uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    std::vector<uint32_t>* out_cluster_starts
+) {
+    size_t triangle_count = index_count / 3;
+    if (out_cluster_starts != nullptr) out_cluster_starts->clear();
+    if (triangle_count == 0) return;
+
+    TriangleAdjacency adjacency;
+    build_adjacency(indices, index_count, vertex_count, &adjacency);
+
+    std::vector<uint32_t> live_counts = adjacency.counts;
+    // start everything "far in the past" so nothing begins in the cache
+    std::vector<uint32_t> cache_times(vertex_count, 0);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    std::vector<uint32_t> dead_ends;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(index_count);
+
+    uint32_t time = MESH_OPTIMIZER_CACHE_SIZE + 1;
+    uint32_t fanning = 0;
+    uint32_t scan_cursor = 1;
+    bool new_cluster = true;
+
+    while (fanning != INVALID_VERTEX) {
+        candidates.clear();
+
+        if (new_cluster && out_cluster_starts != nullptr) {
+            out_cluster_starts->push_back((uint32_t)(result.size() / 3));
+        }
+        new_cluster = false;
+
+        // emit every remaining triangle around the fanning vertex
+        for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; a++) {
+            uint32_t t = adjacency.triangles[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+
+            for (uint32_t c = 0; c < 3; c++) {
+                uint32_t v = indices[t * 3 + c];
+                result.push_back(v);
+                dead_ends.push_back(v);
+                candidates.push_back(v);
+                live_counts[v]--;
+
+                if (time - cache_times[v] > MESH_OPTIMIZER_CACHE_SIZE) {
+                    cache_times[v] = time++;
+                }
+            }
+        }
+
+        fanning = next_fanning_vertex(candidates, live_counts, cache_times, time, MESH_OPTIMIZER_CACHE_SIZE);
+        if (fanning != INVALID_VERTEX) continue;
+
+        // dead end, first try recently used vertices that still have work...
+        while (!dead_ends.empty()) {
+            uint32_t v = dead_ends.back();
+            dead_ends.pop_back();
+            if (live_counts[v] > 0) {
+                fanning = v;
+                break;
+            }
+        }
+
+        // ...then fall back to scanning through the whole vertex list
+        while (fanning == INVALID_VERTEX && scan_cursor < vertex_count) {
+            if (live_counts[scan_cursor] > 0) {
+                fanning = scan_cursor;
+            }
+            scan_cursor++;
+        }
+
+        // only count it as a new cluster if we actually lost our place in
+        //   the cache, otherwise moving it would cost extra transforms
+        new_cluster = fanning == INVALID_VERTEX || time - cache_times[fanning] > MESH_OPTIMIZER_CACHE_SIZE;
+    }
+
+    memcpy(indices, result.data(), sizeof(uint32_t) * result.size());
+}
+
+void optimize_overdraw(
+    uint32_t* indices,
+    size_t index_count,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const std::vector<uint32_t>& cluster_starts
+) {
+    size_t triangle_count = index_count / 3;
+    if (triangle_count == 0 || cluster_starts.size() <= 1) return;
+
+    // mesh center, used as the "inside" reference point
+    XMVECTOR mesh_center = XMVectorZero();
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        mesh_center += XMLoadFloat3(&vertices[v].Position);
+    }
+    mesh_center = mesh_center / (float)(vertex_count > 0 ? vertex_count : 1);
+
+    struct Cluster {
+        uint32_t first_triangle;
+        uint32_t triangle_count;
+        float sort_key;
+    };
+
+    std::vector<Cluster> clusters(cluster_starts.size());
+    for (size_t ci = 0; ci < clusters.size(); ci++) {
+        uint32_t start = cluster_starts[ci];
+        uint32_t end = ci + 1 < clusters.size() ? cluster_starts[ci + 1] : (uint32_t)triangle_count;
+
+        // area weighted centroid & normal of the whole cluster
+        XMVECTOR centroid = XMVectorZero();
+        XMVECTOR normal = XMVectorZero();
+        float area = 0.0f;
+        for (uint32_t t = start; t < end; t++) {
+            XMVECTOR a = XMLoadFloat3(&vertices[indices[t * 3 + 0]].Position);
+            XMVECTOR b = XMLoadFloat3(&vertices[indices[t * 3 + 1]].Position);
+            XMVECTOR c = XMLoadFloat3(&vertices[indices[t * 3 + 2]].Position);
+
+            // clockwise winding, so this points out of the front face
+            XMVECTOR face_normal = XMVector3Cross(b - a, c - a);
+            float face_area = XMVectorGetX(XMVector3Length(face_normal));
+
+            centroid += (a + b + c) * (face_area / 3.0f);
+            normal += face_normal;
+            area += face_area;
+        }
+
+        if (area > 0.0f) {
+            centroid = centroid / area;
+        }
+
+        clusters[ci].first_triangle = start;
+        clusters[ci].triangle_count = end - start;
+        clusters[ci].sort_key = XMVectorGetX(XMVector3Dot(centroid - mesh_center, XMVector3Normalize(normal)));
+    }
+
+    // outward facing clusters on the outside of the mesh go first
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(index_count);
+    for (const Cluster& cluster : clusters) {
+        const uint32_t* first = indices + (size_t)cluster.first_triangle * 3;
+        result.insert(result.end(), first, first + (size_t)cluster.triangle_count * 3);
+    }
+
+    memcpy(indices, result.data(), sizeof(uint32_t) * result.size());
+}
+
+uint32_t optimize_vertex_fetch(
+    Vertex* vertices,
+    uint32_t vertex_count,
+    uint32_t* indices,
+    size_t index_count
+) {
+    std::vector<uint32_t> remap(vertex_count, INVALID_VERTEX);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertex_count);
+
+    for (size_t i = 0; i < index_count; i++) {
+        uint32_t& mapped = remap[indices[i]];
+        if (mapped == INVALID_VERTEX) {
+            mapped = (uint32_t)reordered.size();
+            reordered.push_back(vertices[indices[i]]);
+        }
+        indices[i] = mapped;
+    }
+
+    memcpy(vertices, reordered.data(), sizeof(Vertex) * reordered.size());
+    return (uint32_t)reordered.size();
+}
+
+VertexCacheStats analyze_vertex_cache(
+    const uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    uint32_t cache_size
+) {
+    // FIFO cache, a vertex is still cached if it was pushed
+    //   less than cache_size pushes ago
+    std::vector<uint32_t> push_times(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+
+    VertexCacheStats stats = {};
+    for (size_t i = 0; i < index_count; i++) {
+        uint32_t v = indices[i];
+        if (time - push_times[v] > cache_size) {
+            push_times[v] = time++;
+            stats.vertices_transformed++;
+        }
+    }
+
+    size_t triangle_count = index_count / 3;
+    stats.acmr = triangle_count > 0 ? (float)stats.vertices_transformed / triangle_count : 0.0f;
+    stats.atvr = vertex_count > 0 ? (float)stats.vertices_transformed / vertex_count : 0.0f;
+    return stats;
+}
+
+VertexFetchStats analyze_vertex_fetch(
+    const uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    uint32_t vertex_size
+) {
+    // tiny fully associative FIFO of cache lines
+    uint64_t lines[FETCH_CACHE_LINES];
+    uint32_t next_line = 0;
+    for (uint64_t& line : lines) line = UINT64_MAX;
+
+    VertexFetchStats stats = {};
+    for (size_t i = 0; i < index_count; i++) {
+        uint64_t start = (uint64_t)indices[i] * vertex_size;
+        uint64_t end = start + vertex_size;
+
+        for (uint64_t line = start / FETCH_LINE_SIZE; line <= (end - 1) / FETCH_LINE_SIZE; line++) {
+            bool hit = false;
+            for (uint64_t cached : lines) {
+                if (cached == line) {
+                    hit = true;
+                    break;
+                }
+            }
+
+            if (!hit) {
+                lines[next_line] = line;
+                next_line = (next_line + 1) % FETCH_CACHE_LINES;
+                stats.bytes_fetched += FETCH_LINE_SIZE;
+            }
+        }
+    }
+
+    uint64_t buffer_size = (uint64_t)vertex_count * vertex_size;
+    stats.overfetch = buffer_size > 0 ? (float)((double)stats.bytes_fetched / buffer_size) : 0.0f;
+    return stats;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// post-transform cache size we optimize for, most hardware behaves
+//   roughly like a FIFO of about this many vertices
+constexpr uint32_t MESH_OPTIMIZER_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    uint32_t vertices_transformed;
+    // average cache miss ratio, transformed vertices per triangle (0.5 is perfect)
+    float acmr;
+    // average transform to vertex ratio, transformed vertices per unique vertex (1.0 is perfect)
+    float atvr;
+};
+
+struct VertexFetchStats {
+    uint64_t bytes_fetched;
+    // bytes fetched vs the size of the vertex buffer (1.0 is perfect)
+    float overfetch;
+};
+
+// reorders triangles for post-transform cache locality (tipsify). optionally
+//   writes out the first triangle of every cluster it had to restart at,
+//   those clusters can be shuffled around without hurting the cache much
+void optimize_vertex_cache(
+    uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    std::vector<uint32_t>* out_cluster_starts = nullptr
+);
+
+// sorts the clusters from optimize_vertex_cache so the ones facing away from
+//   the mesh center (the ones most likely to occlude everything else) draw
+//   first, giving early-z more to reject no matter where it's viewed from
+void optimize_overdraw(
+    uint32_t* indices,
+    size_t index_count,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const std::vector<uint32_t>& cluster_starts
+);
+
+// remaps vertices into the order the index buffer first uses them so
+//   fetches walk through memory linearly. unused vertices are dropped,
+//   returns the new vertex count
+uint32_t optimize_vertex_fetch(
+    Vertex* vertices,
+    uint32_t vertex_count,
+    uint32_t* indices,
+    size_t index_count
+);
+
+// CPU simulations for measuring the above without a GPU
+VertexCacheStats analyze_vertex_cache(
+    const uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    uint32_t cache_size = MESH_OPTIMIZER_CACHE_SIZE
+);
+VertexFetchStats analyze_vertex_fetch(
+    const uint32_t* indices,
+    size_t index_count,
+    uint32_t vertex_count,
+    uint32_t vertex_size
+);
@@ -0,0 +1,114 @@
+#include "MeshSegment.h"
+
+bool mesh_build_segments(uint32_t vertex_count, size_t index_count, std::vector<MeshSegment>* out_segments) {
+    out_segments->clear();
+    if (vertex_count > MESH_SEGMENT_MAX_VERTICES) return false;
+
+    out_segments->push_back({ 0, (uint32_t)index_count, 0, 0 });
+    return true;
+}
+
+bool mesh_split_segments(
+    std::vector<Vertex>* vertices,
+    std::vector<uint32_t>* indices,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    uint32_t vertex_stride,
+    std::vector<MeshSegment>* out_segments
+) {
+    uint32_t vertex_count = (uint32_t)vertices->size();
+    if (mesh_build_segments(vertex_count, indices->size(), out_segments)) return true;
+
+    // without LODs the whole buffer is LOD 0
+    MeshLod whole = { 0, (uint32_t)indices->size(), 0.0f };
+    if (lods == nullptr || lod_count == 0) {
+        lods = &whole;
+        lod_count = 1;
+    }
+
+    const uint32_t* source = indices->data();
+    std::vector<Vertex> split_vertices;
+    split_vertices.reserve(vertex_count);
+    std::vector<uint32_t> split_indices(indices->size());
+    std::vector<MeshSegment> segments;
+
+    // vertex_stamps[v] == stamp means v already has a copy in the current segment
+    std::vector<uint32_t> vertex_stamps(vertex_count, UINT32_MAX);
+    std::vector<uint32_t> copies(vertex_count);
+    uint32_t stamp = 0;
+
+    for (uint32_t l = 0; l < lod_count; l++) {
+        const MeshLod& lod = lods[l];
+        if (lod.index_count == 0) continue;
+
+        // greedy, the existing order is already cache & fetch optimized so
+        //   runs of it stay compact and only their borders get duplicated
+        MeshSegment segment = { lod.first_index, 0, (uint32_t)split_vertices.size(), 0 };
+        stamp++;
+        for (uint32_t i = lod.first_index; i + 3 <= lod.first_index + lod.index_count; i += 3) {
+            uint32_t added = 0;
+            for (uint32_t c = 0; c < 3; c++) {
+                if (vertex_stamps[source[i + c]] != stamp) added++;
+            }
+
+            uint32_t segment_vertices = (uint32_t)split_vertices.size() - segment.base_vertex;
+            if (segment.index_count > 0 && segment_vertices + added > MESH_SEGMENT_MAX_VERTICES) {
+                segments.push_back(segment);
+                segment = { i, 0, (uint32_t)split_vertices.size(), 0 };
+                stamp++;
+            }
+
+            for (uint32_t c = 0; c < 3; c++) {
+                uint32_t v = source[i + c];
+                if (vertex_stamps[v] != stamp) {
+                    vertex_stamps[v] = stamp;
+                    copies[v] = (uint32_t)split_vertices.size();
+                    split_vertices.push_back((*vertices)[v]);
+                }
+                split_indices[i + c] = copies[v];
+            }
+            segment.index_count += 3;
+        }
+        segments.push_back(segment);
+    }
+
+    // coarse LODs mostly end up with their own copies, that has to be clearly
+    //   cheaper than just keeping 32 bit indices
+    size_t added_bytes = split_vertices.size() > vertex_count ? (split_vertices.size() - vertex_count) * vertex_stride : 0;
+    size_t saved_bytes = indices->size() * (sizeof(uint32_t) - sizeof(uint16_t));
+    if ((double)added_bytes > (double)saved_bytes * (1.0 - MESH_SEGMENT_MIN_NET_SAVING)) return false;
+
+    vertices->swap(split_vertices);
+    indices->swap(split_indices);
+    out_segments->swap(segments);
+    return true;
+}
+
+void mesh_narrow_indices(
+    const uint32_t* indices,
+    const MeshSegment* segments,
+    uint32_t segment_count,
+    uint16_t* out_indices
+) {
+    for (uint32_t s = 0; s < segment_count; s++) {
+        const MeshSegment& segment = segments[s];
+        for (uint32_t i = segment.first_index; i < segment.first_index + segment.index_count; i++) {
+            out_indices[i] = (uint16_t)(indices[i] - segment.base_vertex);
+        }
+    }
+}
+
+uint32_t mesh_find_segment(const MeshSegment* segments, uint32_t segment_count, uint32_t index_offset) {
+    // binary search for the last segment starting at or before index_offset
+    uint32_t low = 0;
+    uint32_t high = segment_count;
+    while (high - low > 1) {
+        uint32_t middle = (low + high) / 2;
+        if (segments[middle].first_index <= index_offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshLod.h"
+#include "Vertex.h"
+
+// how many verts a 16 bit index can reach from a segment's base vertex
+constexpr uint32_t MESH_SEGMENT_MAX_VERTICES = 65536;
+// a split has to keep at least this much of the index bytes it saves once
+//   the copied verts are paid for. near break even splits aren't worth
+//   (up to) doubling the vertex count
+constexpr float MESH_SEGMENT_MIN_NET_SAVING = 0.25f;
+
+// a run of the index buffer whose indices all fit in 16 bits once
+//   base_vertex is subtracted, drawn with base_vertex as BaseVertexLocation
+//! part of the cooked mesh format, don't reorder
+struct MeshSegment {
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t base_vertex;
+    uint32_t reserved;
+};
+
+// cheap case: meshes with at most MESH_SEGMENT_MAX_VERTICES verts need just
+//   one segment at base vertex 0. returns false (and no segments) for
+//   anything bigger, see mesh_split_segments for those
+bool mesh_build_segments(uint32_t vertex_count, size_t index_count, std::vector<MeshSegment>* out_segments);
+
+// splits a big mesh into 16 bit addressable sub-meshes: every LOD is cut
+//   into runs touching at most MESH_SEGMENT_MAX_VERTICES verts and each run
+//   gets its own copy of them. indices get rewritten to point at the copies
+//   (still 32 bit, base vertex included). only happens when the halved
+//   indices save at least MESH_SEGMENT_MIN_NET_SAVING more than the copied
+//   verts (at vertex_stride bytes on the GPU) cost, returns false and leaves
+//   everything alone otherwise
+bool mesh_split_segments(
+    std::vector<Vertex>* vertices,
+    std::vector<uint32_t>* indices,
+    const MeshLod* lods,
+    uint32_t lod_count,
+    uint32_t vertex_stride,
+    std::vector<MeshSegment>* out_segments
+);
+
+// writes every index relative to its segment's base vertex
+void mesh_narrow_indices(
+    const uint32_t* indices,
+    const MeshSegment* segments,
+    uint32_t segment_count,
+    uint16_t* out_indices
+);
+
+// the segment index_offset falls in, segments have to be sorted
+uint32_t mesh_find_segment(const MeshSegment* segments, uint32_t segment_count, uint32_t index_offset);
+
+// calls draw(first_index, index_count, base_vertex) once per segment the
+//   range of the index buffer touches, clipped to that segment
+template <typename F>
+void mesh_segment_draws(const MeshSegment* segments, uint32_t segment_count, uint32_t first_index, uint32_t index_count, F&& draw) {
+    uint32_t end = first_index + index_count;
+    for (uint32_t s = mesh_find_segment(segments, segment_count, first_index); s < segment_count; s++) {
+        const MeshSegment& segment = segments[s];
+        if (segment.first_index >= end) break;
+
+        uint32_t segment_end = segment.first_index + segment.index_count;
+        uint32_t draw_start = first_index > segment.first_index ? first_index : segment.first_index;
+        uint32_t draw_end = end < segment_end ? end : segment_end;
+        if (draw_end > draw_start) {
+            draw(draw_start, draw_end - draw_start, segment.base_vertex);
+        }
+    }
+}
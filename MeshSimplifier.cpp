@@ -0,0 +1,513 @@
+#include "MeshSimplifier.h"
+
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr uint32_t INVALID_VERTEX = UINT32_MAX;
+
+    // collapses that bend the surviving vertex normal more than this get rejected (~45 degrees)
+    constexpr float MIN_NORMAL_DOT = 0.7f;
+
+    // symmetric 4x4 plane quadric, stored as the 3x3 part (a), the
+    //   linear part (b), the constant (c) and the total area weight (w)
+    struct Quadric {
+        double a00, a11, a22, a10, a20, a21;
+        double b0, b1, b2;
+        double c;
+        double w;
+    };
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+}
+
+static void quadric_add(Quadric* q, const Quadric& other) {
+    q->a00 += other.a00;
+    q->a11 += other.a11;
+    q->a22 += other.a22;
+    q->a10 += other.a10;
+    q->a20 += other.a20;
+    q->a21 += other.a21;
+    q->b0 += other.b0;
+    q->b1 += other.b1;
+    q->b2 += other.b2;
+    q->c += other.c;
+    q->w += other.w;
+}
+
+static Quadric quadric_from_plane(double nx, double ny, double nz, double d, double weight) {
+    Quadric q;
+    q.a00 = weight * nx * nx;
+    q.a11 = weight * ny * ny;
+    q.a22 = weight * nz * nz;
+    q.a10 = weight * ny * nx;
+    q.a20 = weight * nz * nx;
+    q.a21 = weight * nz * ny;
+    q.b0 = weight * d * nx;
+    q.b1 = weight * d * ny;
+    q.b2 = weight * d * nz;
+    q.c = weight * d * d;
+    q.w = weight;
+    return q;
+}
+
+// area weighted sum of squared distances to all the planes in q
+static double quadric_evaluate(const Quadric& q, const DirectX::XMFLOAT3& p) {
+    double x = p.x, y = p.y, z = p.z;
+    return
+        q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+        2.0 * (q.a10 * x * y + q.a20 * x * z + q.a21 * y * z) +
+        2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) +
+        q.c;
+}
+
+// average squared distance of p to the planes of both quadrics, same as
+//   adding them together first but without building the sum
+static double quadric_collapse_error(const Quadric& a, const Quadric& b, const DirectX::XMFLOAT3& p) {
+    double weight = a.w + b.w;
+    return weight > 0.0 ? fabs(quadric_evaluate(a, p) + quadric_evaluate(b, p)) / weight : 0.0;
+}
+
+static void triangle_normal(
+    const DirectX::XMFLOAT3& a,
+    const DirectX::XMFLOAT3& b,
+    const DirectX::XMFLOAT3& c,
+    double out[3]
+) {
+    double e0[3] = { (double)b.x - a.x, (double)b.y - a.y, (double)b.z - a.z };
+    double e1[3] = { (double)c.x - a.x, (double)c.y - a.y, (double)c.z - a.z };
+    out[0] = e0[1] * e1[2] - e0[2] * e1[1];
+    out[1] = e0[2] * e1[0] - e0[0] * e1[2];
+    out[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+static float bounding_radius(const Vertex* vertices, uint32_t vertex_count) {
+    if (vertex_count == 0) return 0.0f;
+
+    DirectX::XMFLOAT3 min = vertices[0].Position;
+    DirectX::XMFLOAT3 max = vertices[0].Position;
+    for (uint32_t i = 1; i < vertex_count; i++) {
+        const DirectX::XMFLOAT3& p = vertices[i].Position;
+        min.x = p.x < min.x ? p.x : min.x;
+        min.y = p.y < min.y ? p.y : min.y;
+        min.z = p.z < min.z ? p.z : min.z;
+        max.x = p.x > max.x ? p.x : max.x;
+        max.y = p.y > max.y ? p.y : max.y;
+        max.z = p.z > max.z ? p.z : max.z;
+    }
+
+    float dx = max.x - min.x;
+    float dy = max.y - min.y;
+    float dz = max.z - min.z;
+    return 0.5f * sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+static uint64_t hash_position(const DirectX::XMFLOAT3& position) {
+    uint32_t bits[3];
+    memcpy(bits, &position, sizeof(bits));
+
+    uint64_t h = ((uint64_t)bits[0] * 0x9e3779b97f4a7c15ull) ^ ((uint64_t)bits[1] * 0xc2b2ae3d27d4eb4full) ^ bits[2];
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+// maps every vertex to the first vertex sharing its exact position, and
+//   links all of those "wedges" together in a circular list
+static void build_position_remap(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    std::vector<uint32_t>* out_remap,
+    std::vector<uint32_t>* out_wedges
+) {
+    out_remap->resize(vertex_count);
+    out_wedges->resize(vertex_count);
+
+    // open addressing, same idea as the exact weld
+    uint32_t capacity = 16;
+    while (capacity < vertex_count * 2) capacity <<= 1;
+    uint32_t mask = capacity - 1;
+    std::vector<uint32_t> table(capacity, INVALID_VERTEX);
+
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        (*out_remap)[v] = v;
+        (*out_wedges)[v] = v;
+
+        uint32_t slot = (uint32_t)hash_position(vertices[v].Position) & mask;
+        while (table[slot] != INVALID_VERTEX) {
+            uint32_t other = table[slot];
+            if (memcmp(&vertices[other].Position, &vertices[v].Position, sizeof(DirectX::XMFLOAT3)) == 0) {
+                (*out_remap)[v] = other;
+                (*out_wedges)[v] = (*out_wedges)[other];
+                (*out_wedges)[other] = v;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        if (table[slot] == INVALID_VERTEX) {
+            table[slot] = v;
+        }
+    }
+}
+
+static float normal_dot(const Vertex& a, const Vertex& b) {
+    return a.Normal.x * b.Normal.x + a.Normal.y * b.Normal.y + a.Normal.z * b.Normal.z;
+}
+
+// UV seams, hard normal edges and open borders get locked, moving them
+//   would tear the mesh or smear UVs/normals across the seam. wedges that
+//   only differ by a slightly different normal are fine, they move together
+static void build_locked_vertices(
+    const Vertex* vertices,
+    const std::vector<uint32_t>& position_remap,
+    const uint32_t* indices,
+    size_t index_count,
+    std::vector<uint8_t>* out_locked
+) {
+    uint32_t vertex_count = (uint32_t)position_remap.size();
+    std::vector<uint8_t> locked_positions(vertex_count, 0);
+
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        uint32_t first = position_remap[v];
+        if (first == v) continue;
+
+        bool same_uv = memcmp(&vertices[v].UV, &vertices[first].UV, sizeof(DirectX::XMFLOAT2)) == 0;
+        if (!same_uv || normal_dot(vertices[v], vertices[first]) < MIN_NORMAL_DOT) {
+            locked_positions[first] = 1;
+        }
+    }
+
+    // position -> triangles, so opposite half edges can be looked up
+    std::vector<uint32_t> offsets((size_t)vertex_count + 1, 0);
+    for (size_t i = 0; i < index_count; i++) {
+        offsets[position_remap[indices[i]] + 1]++;
+    }
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> triangles(index_count);
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < index_count; i++) {
+        triangles[cursors[position_remap[indices[i]]]++] = (uint32_t)(i / 3);
+    }
+
+    // an edge is on a border if its opposite half edge doesn't exist
+    for (size_t i = 0; i < index_count; i += 3) {
+        for (int e = 0; e < 3; e++) {
+            uint32_t a = position_remap[indices[i + e]];
+            uint32_t b = position_remap[indices[i + (e + 1) % 3]];
+
+            bool has_opposite = false;
+            for (uint32_t t = offsets[b]; t < offsets[b + 1] && !has_opposite; t++) {
+                const uint32_t* tri = indices + (size_t)triangles[t] * 3;
+                for (int c = 0; c < 3; c++) {
+                    if (position_remap[tri[c]] == b && position_remap[tri[(c + 1) % 3]] == a) {
+                        has_opposite = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!has_opposite) {
+                locked_positions[a] = 1;
+                locked_positions[b] = 1;
+            }
+        }
+    }
+
+    out_locked->resize(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        (*out_locked)[v] = locked_positions[position_remap[v]];
+    }
+}
+
+// every wedge at "from"'s position ends up using "to"'s normal, so they all need to be close
+static bool normals_match(const Vertex* vertices, const std::vector<uint32_t>& wedges, uint32_t from, uint32_t to) {
+    uint32_t wedge = from;
+    do {
+        if (normal_dot(vertices[wedge], vertices[to]) < MIN_NORMAL_DOT) return false;
+        wedge = wedges[wedge];
+    } while (wedge != from);
+    return true;
+}
+
+// true if moving "from" onto "to" would flip or squash any triangle around "from"
+static bool collapse_flips(
+    const Vertex* vertices,
+    const uint32_t* indices,
+    const std::vector<uint32_t>& adjacency_offsets,
+    const std::vector<uint32_t>& adjacency,
+    uint32_t from,
+    uint32_t to
+) {
+    for (uint32_t a = adjacency_offsets[from]; a < adjacency_offsets[from + 1]; a++) {
+        const uint32_t* tri = indices + (size_t)adjacency[a] * 3;
+        if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+        DirectX::XMFLOAT3 before[3];
+        DirectX::XMFLOAT3 after[3];
+        for (int c = 0; c < 3; c++) {
+            before[c] = vertices[tri[c]].Position;
+            after[c] = tri[c] == from ? vertices[to].Position : before[c];
+        }
+
+        double n0[3];
+        double n1[3];
+        triangle_normal(before[0], before[1], before[2], n0);
+        triangle_normal(after[0], after[1], after[2], n1);
+
+        double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+        double length0 = sqrt(n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]);
+        double length1 = sqrt(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+
+        // allow some rotation, but not flipping or collapsing to a sliver
+        if (dot <= 0.25 * length0 * length1) return true;
+    }
+
+    return false;
+}
+
+static bool wedges_flip(
+    const Vertex* vertices,
+    const uint32_t* indices,
+    const std::vector<uint32_t>& adjacency_offsets,
+    const std::vector<uint32_t>& adjacency,
+    const std::vector<uint32_t>& wedges,
+    uint32_t from,
+    uint32_t to
+) {
+    uint32_t wedge = from;
+    do {
+        if (collapse_flips(vertices, indices, adjacency_offsets, adjacency, wedge, to)) return true;
+        wedge = wedges[wedge];
+    } while (wedge != from);
+    return false;
+}
+
+float mesh_simplify(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    size_t index_count,
+    size_t target_index_count,
+    float target_error,
+    std::vector<uint32_t>* out_indices
+) {
+    out_indices->assign(indices, indices + index_count);
+    if (index_count <= target_index_count || vertex_count == 0) return 0.0f;
+
+    float radius = bounding_radius(vertices, vertex_count);
+    if (radius <= 0.0f) return 0.0f;
+
+    std::vector<uint32_t> position_remap;
+    std::vector<uint32_t> wedges;
+    std::vector<uint8_t> locked;
+    build_position_remap(vertices, vertex_count, &position_remap, &wedges);
+    build_locked_vertices(vertices, position_remap, indices, index_count, &locked);
+
+    // quadrics live on positions, so every vertex of a seam shares one
+    std::vector<Quadric> quadrics(vertex_count, Quadric {});
+    for (size_t i = 0; i < index_count; i += 3) {
+        const DirectX::XMFLOAT3& p0 = vertices[indices[i + 0]].Position;
+        const DirectX::XMFLOAT3& p1 = vertices[indices[i + 1]].Position;
+        const DirectX::XMFLOAT3& p2 = vertices[indices[i + 2]].Position;
+
+        double n[3];
+        triangle_normal(p0, p1, p2, n);
+        double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0) continue;
+
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+        double d = -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z);
+        Quadric q = quadric_from_plane(n[0], n[1], n[2], d, length * 0.5);
+
+        for (int c = 0; c < 3; c++) {
+            quadric_add(&quadrics[position_remap[indices[i + c]]], q);
+        }
+    }
+
+    double max_cost = (double)target_error * radius * (double)target_error * radius;
+    double reached_cost = 0.0;
+
+    std::vector<uint32_t>& current = *out_indices;
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> best_collapses(vertex_count);
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<uint8_t> touched(vertex_count);
+
+    // every pass collapses a batch of the cheapest independent edges,
+    //   then rebuilds adjacency. keeps things roughly O(n log n) overall
+    while (current.size() > target_index_count) {
+        size_t triangle_count = current.size() / 3;
+
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (uint32_t v : current) {
+            adjacency_offsets[v + 1]++;
+        }
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            adjacency_offsets[v + 1] += adjacency_offsets[v];
+        }
+        adjacency.resize(current.size());
+        std::vector<uint32_t> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for (size_t i = 0; i < current.size(); i++) {
+            adjacency[cursors[current[i]]++] = (uint32_t)(i / 3);
+        }
+
+        // every unlocked vertex only keeps its cheapest way out, that's all
+        //   a pass would ever use and it keeps the sort small
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            best_collapses[v] = { v, INVALID_VERTEX, max_cost };
+        }
+        for (size_t i = 0; i < current.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                for (int direction = 0; direction < 2; direction++) {
+                    uint32_t from = current[i + (e + direction) % 3];
+                    uint32_t to = current[i + (e + 1 - direction) % 3];
+                    if (locked[from] || position_remap[from] == position_remap[to]) continue;
+
+                    double cost = quadric_collapse_error(quadrics[position_remap[from]], quadrics[position_remap[to]], vertices[to].Position);
+                    if (cost > best_collapses[from].cost) continue;
+
+                    // only the cheapest *valid* edge is any use, so check that here
+                    //   (these don't change until something nearby collapses)
+                    if (!normals_match(vertices, wedges, from, to) || wedges_flip(vertices, current.data(), adjacency_offsets, adjacency, wedges, from, to)) continue;
+
+                    best_collapses[from].to = to;
+                    best_collapses[from].cost = cost;
+                }
+            }
+        }
+
+        collapses.clear();
+        for (const Collapse& collapse : best_collapses) {
+            if (collapse.to != INVALID_VERTEX) {
+                collapses.push_back(collapse);
+            }
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        // each collapse removes about two triangles, don't overshoot the target by much
+        size_t collapse_goal = (triangle_count - target_index_count / 3) / 2;
+        if (collapse_goal == 0) collapse_goal = 1;
+
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t collapse_count = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse_count >= collapse_goal) break;
+            if (touched[collapse.to]) continue;
+
+            // every wedge at "from"'s position moves along with it, so if any
+            //   of them were near an earlier collapse the checks are stale
+            bool valid = true;
+            uint32_t wedge = collapse.from;
+            do {
+                if (touched[wedge]) {
+                    valid = false;
+                    break;
+                }
+                wedge = wedges[wedge];
+            } while (wedge != collapse.from);
+            if (!valid) continue;
+
+            quadric_add(&quadrics[position_remap[collapse.to]], quadrics[position_remap[collapse.from]]);
+            reached_cost = collapse.cost > reached_cost ? collapse.cost : reached_cost;
+            collapse_count++;
+
+            // anything sharing a triangle with "from" just changed shape,
+            //   so it sits out the rest of this pass
+            wedge = collapse.from;
+            do {
+                remap[wedge] = collapse.to;
+                for (uint32_t a = adjacency_offsets[wedge]; a < adjacency_offsets[wedge + 1]; a++) {
+                    const uint32_t* tri = current.data() + (size_t)adjacency[a] * 3;
+                    touched[tri[0]] = 1;
+                    touched[tri[1]] = 1;
+                    touched[tri[2]] = 1;
+                }
+                wedge = wedges[wedge];
+            } while (wedge != collapse.from);
+        }
+
+        if (collapse_count == 0) break;
+
+        // apply the collapses and drop anything that became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i < current.size(); i += 3) {
+            uint32_t a = remap[current[i + 0]];
+            uint32_t b = remap[current[i + 1]];
+            uint32_t c = remap[current[i + 2]];
+            if (a == b || b == c || a == c) continue;
+
+            current[write + 0] = a;
+            current[write + 1] = b;
+            current[write + 2] = c;
+            write += 3;
+        }
+        current.resize(write);
+    }
+
+    return (float)(sqrt(reached_cost) / radius);
+}
+
+void mesh_build_lods(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    size_t index_count,
+    std::vector<uint32_t>* out_indices,
+    std::vector<MeshLod>* out_lods
+) {
+    out_indices->assign(indices, indices + index_count);
+    out_lods->clear();
+    out_lods->push_back({ 0, (uint32_t)index_count, 0.0f });
+
+    // every level simplifies the level before it, which keeps the whole
+    //   chain about as cheap as simplifying once. the deviation from the
+    //   original can't be more than the sum of every step's error, so
+    //   that's what each level records
+    std::vector<uint32_t> source_indices(indices, indices + index_count);
+    std::vector<uint32_t> lod_indices;
+    float previous_error = 0.0f;
+    for (uint32_t level = 1; level < MESH_MAX_LODS; level++) {
+        size_t target_count = (source_indices.size() / 2) / 3 * 3;
+        if (target_count < 3 || previous_error >= MESH_LOD_MAX_ERROR) break;
+
+        float error = mesh_simplify(
+            vertices, vertex_count,
+            source_indices.data(), source_indices.size(),
+            target_count,
+            MESH_LOD_MAX_ERROR - previous_error,
+            &lod_indices
+        );
+
+        // simplifier's stuck (seams, error limit), more levels won't help
+        if (lod_indices.empty() || lod_indices.size() > source_indices.size() * (1.0f - MESH_LOD_MIN_REDUCTION)) break;
+
+        source_indices = lod_indices;
+        previous_error += error;
+
+        optimize_vertex_cache(lod_indices.data(), lod_indices.size(), vertex_count);
+        out_lods->push_back({ (uint32_t)out_indices->size(), (uint32_t)lod_indices.size(), previous_error });
+        out_indices->insert(out_indices->end(), lod_indices.begin(), lod_indices.end());
+    }
+}
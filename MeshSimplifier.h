@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshLod.h"
+#include "Vertex.h"
+
+// biggest error (relative to the bounding sphere radius) a generated LOD may
+//   have, past this the shape is too far gone to be worth drawing
+constexpr float MESH_LOD_MAX_ERROR = 0.25f;
+// a LOD has to drop at least this fraction of the previous LOD's triangles
+constexpr float MESH_LOD_MIN_REDUCTION = 0.1f;
+
+// quadric error edge collapse, vertices only ever collapse onto existing
+//   vertices so no new vertices get made. vertices on UV seams, hard
+//   normal edges and open borders never move, and collapses that flip a
+//   triangle or bend a vertex normal too far get rejected.
+// target_error is relative to the mesh's bounding sphere radius,
+//   returns the error actually reached (same units)
+float mesh_simplify(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    size_t index_count,
+    size_t target_index_count,
+    float target_error,
+    std::vector<uint32_t>* out_indices
+);
+
+// builds a LOD chain where each level tries to halve the triangle count
+//   of the last. out_indices gets every LOD's indices back to back, with
+//   LOD 0 being the given indices untouched
+void mesh_build_lods(
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    size_t index_count,
+    std::vector<uint32_t>* out_indices,
+    std::vector<MeshLod>* out_lods
+);
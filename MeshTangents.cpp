@@ -0,0 +1,575 @@
+#include "MeshTangents.h"
+
+#include "Parallel.h"
+#include <DirectXMath.h>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+using namespace DirectX;
+
+namespace {
+    // below this many triangles per thread, spinning threads up costs more than it saves
+    constexpr uint32_t MIN_CHUNK_TRIANGLES = 16384;
+    // verts per block when merging thread sums & finishing tangents
+    constexpr uint32_t VERTEX_BLOCK_SIZE = 1024;
+    // below this many verts finishing stays on the calling thread
+    constexpr uint32_t MIN_PARALLEL_VERTICES = 16384;
+    // thread sums only cover the vertex range their triangles touch, if
+    //   those ranges add up to way more than the mesh (scattered vertex
+    //   order) the memory isn't worth it and one thread does everything
+    constexpr uint32_t MAX_WINDOW_OVERLAP = 2;
+    // triangles mesh_winding looks at
+    constexpr uint32_t WINDING_SAMPLES = 64;
+    // uv determinants smaller than this fraction of their terms are treated
+    //   as zero, catches both zero area & cancellation noise
+    constexpr float DEGENERATE_UV_EPSILON = 1e-6f;
+
+    // which way each triangle is mapped, MikkTSpace mode only
+    constexpr uint8_t ORIENTATION_DEGENERATE = 0;
+    constexpr uint8_t ORIENTATION_POSITIVE = 1;
+    constexpr uint8_t ORIENTATION_NEGATIVE = 2;
+
+    // one thread's sums for the verts in [first_vertex, first_vertex + vertex_count).
+    //   xyz is the summed tangent, w the uv determinant signs (fast) or how many
+    //   corners landed there (MikkTSpace). the first thread's cover every
+    //   vertex, the others get merged into them
+    struct TangentAccumulator {
+        uint32_t first_triangle;
+        uint32_t triangle_count;
+        uint32_t first_vertex;
+        uint32_t vertex_count;
+        std::vector<XMFLOAT4> sums;
+        // mirrored triangles' sums, MikkTSpace only
+        std::vector<XMFLOAT4> mirrored_sums;
+        uint32_t degenerate_count;
+    };
+
+    // 4 lanes of 3D vectors, one triangle per lane
+    struct Vector3x4 {
+        XMVECTOR x, y, z;
+    };
+
+    // a MikkTSpace vertex that needs a second copy for its mirrored triangles
+    struct TangentSplit {
+        uint32_t vertex;
+        XMFLOAT3 tangent;
+    };
+}
+
+static Vector3x4 v3_sub(const Vector3x4& a, const Vector3x4& b) {
+    return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+static Vector3x4 v3_add(const Vector3x4& a, const Vector3x4& b) {
+    return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+static Vector3x4 v3_scale(const Vector3x4& a, XMVECTOR s) {
+    return { a.x * s, a.y * s, a.z * s };
+}
+
+static XMVECTOR v3_dot(const Vector3x4& a, const Vector3x4& b) {
+    return XMVectorMultiplyAdd(a.x, b.x, XMVectorMultiplyAdd(a.y, b.y, a.z * b.z));
+}
+
+static Vector3x4 v3_cross(const Vector3x4& a, const Vector3x4& b) {
+    return {
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x
+    };
+}
+
+// removes the part along (unit length) n
+static Vector3x4 v3_project(const Vector3x4& a, const Vector3x4& n) {
+    return v3_sub(a, v3_scale(n, v3_dot(n, a)));
+}
+
+// zero length lanes stay zero instead of turning into NaNs
+static Vector3x4 v3_normalize_or_zero(const Vector3x4& a) {
+    XMVECTOR length_sq = v3_dot(a, a);
+    XMVECTOR nonzero = XMVectorGreater(length_sq, XMVectorZero());
+    XMVECTOR inverse_length = XMVectorAndInt(XMVectorReciprocalSqrt(XMVectorSelect(XMVectorSplatOne(), length_sq, nonzero)), nonzero);
+    return v3_scale(a, inverse_length);
+}
+
+// rows in, columns out
+static void transpose4(XMVECTOR* rows) {
+    XMVECTOR t0 = XMVectorMergeXY(rows[0], rows[2]);
+    XMVECTOR t1 = XMVectorMergeXY(rows[1], rows[3]);
+    XMVECTOR t2 = XMVectorMergeZW(rows[0], rows[2]);
+    XMVECTOR t3 = XMVectorMergeZW(rows[1], rows[3]);
+    rows[0] = XMVectorMergeXY(t0, t1);
+    rows[1] = XMVectorMergeZW(t0, t1);
+    rows[2] = XMVectorMergeXY(t2, t3);
+    rows[3] = XMVectorMergeZW(t2, t3);
+}
+
+// per lane vectors back out of a Vector3x4 (+ a w for every lane)
+static void split_lanes(const Vector3x4& v, XMVECTOR w, XMVECTOR* out_lanes) {
+    out_lanes[0] = v.x;
+    out_lanes[1] = v.y;
+    out_lanes[2] = v.z;
+    out_lanes[3] = w;
+    transpose4(out_lanes);
+}
+
+static void add_to(XMFLOAT4* sum, XMVECTOR value) {
+    XMStoreFloat4(sum, XMLoadFloat4(sum) + value);
+}
+
+static XMFLOAT4* sum_at(TangentAccumulator* acc, uint32_t vertex) {
+    return &acc->sums[vertex - acc->first_vertex];
+}
+
+// any unit vector perpendicular to n, for verts nothing gave a tangent to
+static XMVECTOR perpendicular(XMVECTOR n) {
+    XMVECTOR axis = fabsf(XMVectorGetX(n)) < 0.9f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0);
+    return XMVector3Normalize(axis - n * XMVector3Dot(n, axis));
+}
+
+// unit length part of sum perpendicular to n, false if there's nothing left
+static bool project_tangent(XMVECTOR sum, XMVECTOR n, XMVECTOR* out_tangent) {
+    XMVECTOR tangent = sum - n * XMVector3Dot(n, sum);
+    if (XMVectorGetX(XMVector3LengthSq(tangent)) <= 0.0f) return false;
+
+    *out_tangent = XMVector3Normalize(tangent);
+    return true;
+}
+
+// vertex memory is Position, UV, Normal back to back, so two 4 wide loads
+//   grab (position, u) and (v, normal) without any repacking
+static_assert(offsetof(Vertex, UV) == 12 && offsetof(Vertex, Normal) == 20, "tangent loads assume this Vertex layout");
+
+// true when a triangle's uvs have (next to) zero area
+static bool degenerate_uvs(float s1, float t1, float s2, float t2) {
+    float det = s1 * t2 - s2 * t1;
+    return fabsf(det) <= DEGENERATE_UV_EPSILON * (fabsf(s1 * t2) + fabsf(s2 * t1));
+}
+
+// which way round the mesh's triangles go next to their normals, +1 if
+//   n . cross(e1, e2) comes out positive. the bitangent has to follow the v
+//   gradient, and cross(n, sdir) dotted with it works out to
+//   n . cross(e1, e2) / det, so that times the sign of det says whether a
+//   triangle's uvs are mirrored whatever the winding convention. a spread of
+//   triangles is plenty to tell, every mesh we load winds one way
+static float mesh_winding(const Vertex* vertices, const uint32_t* indices, uint32_t triangle_count) {
+    uint32_t stride = triangle_count / WINDING_SAMPLES > 0 ? triangle_count / WINDING_SAMPLES : 1;
+    int32_t votes = 0;
+    for (uint32_t t = 0; t < triangle_count; t += stride) {
+        const Vertex& v0 = vertices[indices[t * 3]];
+        XMVECTOR p0 = XMLoadFloat3(&v0.Position);
+        XMVECTOR e1 = XMLoadFloat3(&vertices[indices[t * 3 + 1]].Position) - p0;
+        XMVECTOR e2 = XMLoadFloat3(&vertices[indices[t * 3 + 2]].Position) - p0;
+        float facing = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&v0.Normal), XMVector3Cross(e1, e2)));
+        votes += facing > 0.0f ? 1 : (facing < 0.0f ? -1 : 0);
+    }
+    return votes >= 0 ? 1.0f : -1.0f;
+}
+
+// fast mode, one triangle at a time in xyz lanes. the math per triangle is
+//   tiny next to the 3 scattered read-modify-writes, so spreading triangles
+//   across lanes would only add transposes. every triangle votes with the
+//   sign of its uv determinant in w, mesh_winding turns that into handedness
+static void accumulate_fast(const Vertex* vertices, const uint32_t* indices, TangentAccumulator* acc) {
+    // locals, the sum stores could alias anything reached through acc
+    XMFLOAT4* sums = acc->sums.data();
+    uint32_t first_vertex = acc->first_vertex;
+    uint32_t degenerate_count = 0;
+    uint32_t end = acc->first_triangle + acc->triangle_count;
+    for (uint32_t t = acc->first_triangle; t < end; t++) {
+        uint32_t i0 = indices[t * 3];
+        uint32_t i1 = indices[t * 3 + 1];
+        uint32_t i2 = indices[t * 3 + 2];
+        const Vertex& v0 = vertices[i0];
+        const Vertex& v1 = vertices[i1];
+        const Vertex& v2 = vertices[i2];
+
+        float s1 = v1.UV.x - v0.UV.x;
+        float t1 = v1.UV.y - v0.UV.y;
+        float s2 = v2.UV.x - v0.UV.x;
+        float t2 = v2.UV.y - v0.UV.y;
+        // zero area in uv space has no gradient at all (the old code divided by zero here)
+        if (degenerate_uvs(s1, t1, s2, t2)) {
+            degenerate_count++;
+            continue;
+        }
+        float r = 1.0f / (s1 * t2 - s2 * t1);
+
+        // (position, u) loads, so the w lanes go through the same math as
+        //   det / det. scaling w by |r| instead leaves the sign of det
+        XMVECTOR p0 = XMLoadFloat4((const XMFLOAT4*)&v0.Position);
+        XMVECTOR e1 = XMLoadFloat4((const XMFLOAT4*)&v1.Position) - p0;
+        XMVECTOR e2 = XMLoadFloat4((const XMFLOAT4*)&v2.Position) - p0;
+        XMVECTOR sdir = (e1 * t2 - e2 * t1) * XMVectorSet(r, r, r, fabsf(r));
+
+        add_to(&sums[i0 - first_vertex], sdir);
+        add_to(&sums[i1 - first_vertex], sdir);
+        add_to(&sums[i2 - first_vertex], sdir);
+    }
+    acc->degenerate_count = degenerate_count;
+}
+
+// MikkTSpace mode, 4 triangles at a time through SIMD lanes (every corner
+//   needs normalizes & an acos, that's where the lanes pay off), scattered
+//   back out per vertex
+static void accumulate_mikktspace(
+    const Vertex* vertices,
+    const uint32_t* indices,
+    TangentAccumulator* acc,
+    uint8_t* orientations
+) {
+    acc->degenerate_count = 0;
+
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR lane_ids = XMVectorSet(0, 1, 2, 3);
+    uint32_t end = acc->first_triangle + acc->triangle_count;
+
+    for (uint32_t t = acc->first_triangle; t < end; t += 4) {
+        // lanes past the end repeat the last triangle and get masked off
+        uint32_t lane_count = end - t < 4 ? end - t : 4;
+        uint32_t corners[3][4];
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint32_t triangle = t + (lane < lane_count ? lane : lane_count - 1);
+            for (uint32_t c = 0; c < 3; c++) {
+                corners[c][lane] = indices[triangle * 3 + c];
+            }
+        }
+
+        // AoS loads, transposed so each register holds one component of 4 corners
+        Vector3x4 p[3], n[3];
+        XMVECTOR u[3], v[3];
+        for (uint32_t c = 0; c < 3; c++) {
+            XMVECTOR low[4], high[4];
+            for (uint32_t lane = 0; lane < 4; lane++) {
+                const float* vertex = &vertices[corners[c][lane]].Position.x;
+                low[lane] = XMLoadFloat4((const XMFLOAT4*)vertex);
+                high[lane] = XMLoadFloat4((const XMFLOAT4*)(vertex + 4));
+            }
+            transpose4(low);
+            transpose4(high);
+            p[c] = { low[0], low[1], low[2] };
+            u[c] = low[3];
+            v[c] = high[0];
+            n[c] = { high[1], high[2], high[3] };
+        }
+
+        Vector3x4 e1 = v3_sub(p[1], p[0]);
+        Vector3x4 e2 = v3_sub(p[2], p[0]);
+        XMVECTOR s1 = u[1] - u[0];
+        XMVECTOR t1 = v[1] - v[0];
+        XMVECTOR s2 = u[2] - u[0];
+        XMVECTOR t2 = v[2] - v[0];
+
+        // same test as degenerate_uvs
+        XMVECTOR det = s1 * t2 - s2 * t1;
+        XMVECTOR limit = XMVectorReplicate(DEGENERATE_UV_EPSILON) * (XMVectorAbs(s1 * t2) + XMVectorAbs(s2 * t1));
+        XMVECTOR in_range = XMVectorLess(lane_ids, XMVectorReplicate((float)lane_count));
+        XMVECTOR valid = XMVectorAndInt(XMVectorGreater(XMVectorAbs(det), limit), in_range);
+        XMVECTOR r = XMVectorReciprocal(XMVectorSelect(one, det, valid));
+        Vector3x4 sdir = v3_scale(v3_sub(v3_scale(e1, t2), v3_scale(e2, t1)), r);
+
+        // mirrored or not, per triangle here (see mesh_winding)
+        Vector3x4 face_normal = v3_add(v3_add(n[0], n[1]), n[2]);
+        XMVECTOR positive = XMVectorGreater(v3_dot(face_normal, v3_cross(e1, e2)) * det, XMVectorZero());
+
+        uint32_t valid_lanes[4];
+        uint32_t positive_lanes[4];
+        XMStoreInt4(valid_lanes, valid);
+        XMStoreInt4(positive_lanes, positive);
+        for (uint32_t lane = 0; lane < lane_count; lane++) {
+            if (!valid_lanes[lane]) acc->degenerate_count++;
+        }
+
+        // the face tangent gets projected onto each corner's
+        //   normal and weighted by the corner's angle (also measured in the
+        //   normal's plane), so tessellation doesn't skew the result
+        Vector3x4 face_tangent = v3_normalize_or_zero(sdir);
+        for (uint32_t c = 0; c < 3; c++) {
+            Vector3x4 normal = v3_normalize_or_zero(n[c]);
+            Vector3x4 tangent = v3_normalize_or_zero(v3_project(face_tangent, normal));
+            Vector3x4 edge_a = v3_normalize_or_zero(v3_project(v3_sub(p[(c + 1) % 3], p[c]), normal));
+            Vector3x4 edge_b = v3_normalize_or_zero(v3_project(v3_sub(p[(c + 2) % 3], p[c]), normal));
+            XMVECTOR angle = XMVectorACos(XMVectorClamp(v3_dot(edge_a, edge_b), -one, one));
+
+            // w counts the corners so verts know which sides touched them
+            XMVECTOR lanes[4];
+            split_lanes(v3_scale(tangent, angle), one, lanes);
+            for (uint32_t lane = 0; lane < lane_count; lane++) {
+                if (!valid_lanes[lane]) continue;
+                uint32_t vertex = corners[c][lane];
+                if (positive_lanes[lane]) {
+                    add_to(sum_at(acc, vertex), lanes[lane]);
+                } else {
+                    add_to(&acc->mirrored_sums[vertex - acc->first_vertex], lanes[lane]);
+                }
+            }
+        }
+
+        for (uint32_t lane = 0; lane < lane_count; lane++) {
+            orientations[t + lane] = !valid_lanes[lane] ? ORIENTATION_DEGENERATE : (positive_lanes[lane] ? ORIENTATION_POSITIVE : ORIENTATION_NEGATIVE);
+        }
+    }
+}
+
+// fast mode's last step for verts [start, end), 4 at a time through the
+//   lanes: the summed tangent made perpendicular to the normal & unit
+//   length, handedness from the votes. returns how many verts had nothing
+//   left to use
+static uint32_t finish_fast(Vertex* vertices, const XMFLOAT4* totals, uint32_t start, uint32_t end, float winding) {
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR min_length_sq = XMVectorReplicate(FLT_MIN);
+    const XMVECTOR minus_one = XMVectorNegate(one);
+    const XMVECTOR left_handed = XMVectorReplicate(winding < 0.0f ? 1.0f : -1.0f);
+
+    uint32_t fallback_count = 0;
+    for (uint32_t i = start; i < end; i += 4) {
+        // lanes past the end repeat the last vertex & never get stored
+        uint32_t lane_count = end - i < 4 ? end - i : 4;
+        XMVECTOR normals[4], sums[4];
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint32_t vertex = i + (lane < lane_count ? lane : lane_count - 1);
+            // w picks up Tangent.x, it's never used
+            normals[lane] = XMLoadFloat4((const XMFLOAT4*)&vertices[vertex].Normal);
+            sums[lane] = XMLoadFloat4(&totals[vertex]);
+        }
+        transpose4(normals);
+        transpose4(sums);
+        Vector3x4 n = { normals[0], normals[1], normals[2] };
+        Vector3x4 sum = { sums[0], sums[1], sums[2] };
+
+        // divides by n . n rather than normalizing n first, zero normals
+        //   leave the sum as it is
+        XMVECTOR along = v3_dot(n, sum) * XMVectorReciprocal(XMVectorMax(v3_dot(n, n), min_length_sq));
+        Vector3x4 tangent = v3_sub(sum, v3_scale(n, along));
+        XMVECTOR length_sq = v3_dot(tangent, tangent);
+        XMVECTOR found = XMVectorGreater(length_sq, zero);
+        tangent = v3_scale(tangent, XMVectorReciprocalSqrt(XMVectorSelect(one, length_sq, found)));
+
+        // ties (nothing but degenerate triangles) go right handed
+        float handedness[4];
+        XMStoreFloat4((XMFLOAT4*)handedness, XMVectorSelect(one, minus_one, XMVectorGreater(sums[3] * left_handed, zero)));
+
+        XMVECTOR lanes[4];
+        split_lanes(tangent, zero, lanes);
+        uint32_t found_lanes[4];
+        XMStoreInt4(found_lanes, found);
+        for (uint32_t lane = 0; lane < lane_count; lane++) {
+            Vertex& vertex = vertices[i + lane];
+            if (found_lanes[lane]) {
+                XMStoreFloat3(&vertex.Tangent, lanes[lane]);
+                vertex.Handedness = handedness[lane];
+                continue;
+            }
+            XMStoreFloat3(&vertex.Tangent, perpendicular(XMVector3Normalize(XMLoadFloat3(&vertex.Normal))));
+            vertex.Handedness = totals[i + lane].w * winding < 0.0f ? -1.0f : 1.0f;
+            fallback_count++;
+        }
+    }
+    return fallback_count;
+}
+
+void mesh_calculate_tangents(
+    std::vector<Vertex>* vertices,
+    std::vector<uint32_t>* indices,
+    uint32_t mode,
+    TangentStats* out_stats
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    uint32_t vertex_count = (uint32_t)vertices->size();
+    uint32_t triangle_count = (uint32_t)(indices->size() / 3);
+    const uint32_t* index_data = indices->data();
+    Vertex* vertex_data = vertices->data();
+    uint32_t block_count = (vertex_count + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+
+    // contiguous chunks of triangles, one per thread. they have to know
+    //   their vertex range up front to size their sums
+    uint32_t chunk_count = (triangle_count + MIN_CHUNK_TRIANGLES - 1) / MIN_CHUNK_TRIANGLES;
+    chunk_count = chunk_count < parallel_worker_count() ? chunk_count : parallel_worker_count();
+    chunk_count = chunk_count > 0 ? chunk_count : 1;
+
+    std::vector<TangentAccumulator> accumulators;
+    for (int attempt = 0; attempt < 2 && chunk_count > 1; attempt++) {
+        accumulators.assign(chunk_count, {});
+        uint32_t per_chunk = (triangle_count + chunk_count - 1) / chunk_count;
+        parallel_for(chunk_count, [&](uint32_t c) {
+            TangentAccumulator* acc = &accumulators[c];
+            acc->first_triangle = c * per_chunk < triangle_count ? c * per_chunk : triangle_count;
+            uint32_t end = (c + 1) * per_chunk < triangle_count ? (c + 1) * per_chunk : triangle_count;
+            acc->triangle_count = end - acc->first_triangle;
+
+            uint32_t low = UINT32_MAX;
+            uint32_t high = 0;
+            for (size_t i = (size_t)acc->first_triangle * 3; i < (size_t)end * 3; i++) {
+                low = index_data[i] < low ? index_data[i] : low;
+                high = index_data[i] > high ? index_data[i] : high;
+            }
+            acc->first_vertex = acc->triangle_count > 0 ? low : 0;
+            acc->vertex_count = acc->triangle_count > 0 ? high - low + 1 : 0;
+        });
+
+        uint64_t window_total = 0;
+        for (const TangentAccumulator& acc : accumulators) {
+            window_total += acc.vertex_count;
+        }
+        if (window_total <= (uint64_t)vertex_count * MAX_WINDOW_OVERLAP) break;
+        chunk_count = 1;
+    }
+    // one thread just covers everything
+    if (chunk_count == 1) {
+        accumulators.assign(1, {});
+        accumulators[0].triangle_count = triangle_count;
+        accumulators[0].vertex_count = vertex_count;
+    }
+
+    // the first thread's sums are what everything merges into
+    accumulators[0].first_vertex = 0;
+    accumulators[0].vertex_count = vertex_count;
+
+    // finishing only goes wide when there's enough of it
+    auto for_each_block = [&](auto&& func) {
+        if (vertex_count >= MIN_PARALLEL_VERTICES) {
+            parallel_for(block_count, func);
+        } else {
+            for (uint32_t block = 0; block < block_count; block++) func(block);
+        }
+    };
+
+    float winding = mode == TANGENT_MODE_FAST ? mesh_winding(vertex_data, index_data, triangle_count) : 1.0f;
+    std::vector<uint8_t> orientations;
+    if (mode == TANGENT_MODE_MIKKTSPACE) {
+        orientations.assign(triangle_count, ORIENTATION_DEGENERATE);
+    }
+    parallel_for(chunk_count, [&](uint32_t c) {
+        TangentAccumulator* acc = &accumulators[c];
+        acc->sums.assign(acc->vertex_count, XMFLOAT4(0, 0, 0, 0));
+        if (mode == TANGENT_MODE_MIKKTSPACE) {
+            acc->mirrored_sums.assign(acc->vertex_count, XMFLOAT4(0, 0, 0, 0));
+        }
+        if (mode == TANGENT_MODE_FAST) {
+            accumulate_fast(vertex_data, index_data, acc);
+        } else {
+            accumulate_mikktspace(vertex_data, index_data, acc, orientations.data());
+        }
+    });
+
+    // every block merges whichever thread sums overlap it, then finishes
+    //   its own verts. blocks don't share verts so nothing conflicts
+    std::vector<uint32_t> block_fallbacks(block_count, 0);
+    std::vector<std::vector<TangentSplit>> block_splits(block_count);
+    XMFLOAT4* totals = accumulators[0].sums.data();
+    for_each_block([&](uint32_t block) {
+        uint32_t block_start = block * VERTEX_BLOCK_SIZE;
+        uint32_t block_end = block_start + VERTEX_BLOCK_SIZE < vertex_count ? block_start + VERTEX_BLOCK_SIZE : vertex_count;
+
+        std::vector<XMFLOAT4> mirrored;
+        if (mode == TANGENT_MODE_MIKKTSPACE) {
+            mirrored.assign(block_end - block_start, XMFLOAT4(0, 0, 0, 0));
+        }
+        for (uint32_t c = 0; c < chunk_count; c++) {
+            // the first thread's sums already are the totals, only its mirrored ones need moving
+            if (c == 0 && mode != TANGENT_MODE_MIKKTSPACE) continue;
+            TangentAccumulator* acc = &accumulators[c];
+            uint32_t start = acc->first_vertex > block_start ? acc->first_vertex : block_start;
+            uint32_t end = acc->first_vertex + acc->vertex_count < block_end ? acc->first_vertex + acc->vertex_count : block_end;
+            for (uint32_t i = start; i < end; i++) {
+                if (c > 0) {
+                    add_to(&totals[i], XMLoadFloat4(sum_at(acc, i)));
+                }
+                if (mode == TANGENT_MODE_MIKKTSPACE) {
+                    add_to(&mirrored[i - block_start], XMLoadFloat4(&acc->mirrored_sums[i - acc->first_vertex]));
+                }
+            }
+        }
+
+        if (mode == TANGENT_MODE_FAST) {
+            block_fallbacks[block] = finish_fast(vertex_data, totals, block_start, block_end, winding);
+            return;
+        }
+        for (uint32_t i = block_start; i < block_end; i++) {
+            Vertex& vertex = vertex_data[i];
+            XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&vertex.Normal));
+            XMVECTOR sum = XMLoadFloat4(&totals[i]);
+            float votes = totals[i].w;
+
+            // MikkTSpace, verts touched by both sides keep the positive frame, the
+            //   mirrored one goes on a copy added below
+            XMVECTOR tangent = XMVectorZero();
+            float handedness = 1.0f;
+            XMVECTOR mirrored_sum = XMLoadFloat4(&mirrored[i - block_start]);
+            bool has_positive = votes > 0.0f;
+            bool has_mirrored = mirrored[i - block_start].w > 0.0f;
+            bool found = has_positive && project_tangent(sum, n, &tangent);
+            if (!found && has_mirrored) {
+                found = project_tangent(mirrored_sum, n, &tangent);
+                handedness = -1.0f;
+            }
+            // unless the positive side didn't give a frame & the vert took
+            //   the mirrored one itself
+            if (has_positive && has_mirrored && handedness > 0.0f) {
+                XMVECTOR mirrored_tangent;
+                if (!project_tangent(mirrored_sum, n, &mirrored_tangent)) mirrored_tangent = perpendicular(n);
+                TangentSplit split = { i, {} };
+                XMStoreFloat3(&split.tangent, mirrored_tangent);
+                block_splits[block].push_back(split);
+            }
+            if (!found) {
+                tangent = perpendicular(n);
+                block_fallbacks[block]++;
+            }
+
+            XMStoreFloat3(&vertex.Tangent, tangent);
+            vertex.Handedness = handedness;
+        }
+    });
+
+    uint32_t split_count = 0;
+    if (mode == TANGENT_MODE_MIKKTSPACE) {
+        // mirrored copies go on the end, mirrored triangles get pointed at them
+        std::vector<uint32_t> split_of;
+        for (const std::vector<TangentSplit>& splits : block_splits) {
+            for (const TangentSplit& split : splits) {
+                if (split_of.empty()) split_of.assign(vertex_count, UINT32_MAX);
+
+                Vertex copy = (*vertices)[split.vertex];
+                copy.Tangent = split.tangent;
+                copy.Handedness = -1.0f;
+                split_of[split.vertex] = (uint32_t)vertices->size();
+                vertices->push_back(copy);
+                split_count++;
+            }
+        }
+
+        if (split_count > 0) {
+            uint32_t* rewrite = indices->data();
+            parallel_for(chunk_count, [&](uint32_t c) {
+                const TangentAccumulator& acc = accumulators[c];
+                for (uint32_t t = acc.first_triangle; t < acc.first_triangle + acc.triangle_count; t++) {
+                    if (orientations[t] != ORIENTATION_NEGATIVE) continue;
+                    for (uint32_t k = 0; k < 3; k++) {
+                        uint32_t split = split_of[rewrite[t * 3 + k]];
+                        if (split != UINT32_MAX) rewrite[t * 3 + k] = split;
+                    }
+                }
+            });
+        }
+    }
+
+    if (out_stats) {
+        *out_stats = {};
+        for (const TangentAccumulator& acc : accumulators) {
+            out_stats->degenerate_count += acc.degenerate_count;
+        }
+        for (uint32_t count : block_fallbacks) {
+            out_stats->fallback_count += count;
+        }
+        out_stats->split_count = split_count;
+        out_stats->thread_count = chunk_count;
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        out_stats->seconds = elapsed.count();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// per vertex sums of every triangle's u gradient (Lengyel), handedness is
+//   a majority vote of the triangles (assumes the whole mesh winds the same
+//   way round its normals). cheapest, fine without baked normal maps
+#define TANGENT_MODE_FAST 0
+// follows MikkTSpace's rules so normal maps baked by other tools line up:
+//   per corner tangents projected onto the vertex normal & weighted by the
+//   corner's angle, and verts shared by mirrored & unmirrored triangles get
+//   split so each side keeps its own frame
+#define TANGENT_MODE_MIKKTSPACE 1
+
+// info about a tangent pass, handy for spotting broken UVs
+struct TangentStats {
+    // triangles whose UVs have zero area, they don't contribute anything
+    uint32_t degenerate_count;
+    // verts no usable triangle touched, these got an arbitrary perpendicular tangent
+    uint32_t fallback_count;
+    // verts duplicated for mirrored UVs (MikkTSpace mode only)
+    uint32_t split_count;
+    uint32_t thread_count;
+    double seconds;
+};
+
+// fills in every vertex's Tangent & Handedness so the bitangent is
+//   Handedness * cross(Normal, Tangent). big meshes get split
+//   across threads that each sum into their own buffer, so there are no
+//   write conflicts.
+//   degenerate uvs never produce NaNs. TANGENT_MODE_MIKKTSPACE may append
+//   verts and rewrite indices to point at them
+void mesh_calculate_tangents(
+    std::vector<Vertex>* vertices,
+    std::vector<uint32_t>* indices,
+    uint32_t mode,
+    TangentStats* out_stats = nullptr
+);
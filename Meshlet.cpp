@@ -0,0 +1,275 @@
+#include "Meshlet.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace {
+    constexpr uint32_t INVALID_TRIANGLE = UINT32_MAX;
+
+    // cones this wide (normals spread over ~84 degrees from the axis) can't cull anything useful
+    constexpr float MIN_CONE_DOT = 0.1f;
+}
+
+// how many verts of triangle t aren't in the current meshlet yet
+static uint32_t new_vertex_count(
+    const uint32_t* indices,
+    uint32_t t,
+    const std::vector<uint32_t>& vertex_stamps,
+    uint32_t stamp
+) {
+    uint32_t count = 0;
+    for (int c = 0; c < 3; c++) {
+        if (vertex_stamps[indices[t * 3 + c]] != stamp) count++;
+    }
+    return count;
+}
+
+static XMVECTOR triangle_centroid(const uint32_t* indices, const Vertex* vertices, uint32_t t) {
+    return (
+        XMLoadFloat3(&vertices[indices[t * 3 + 0]].Position) +
+        XMLoadFloat3(&vertices[indices[t * 3 + 1]].Position) +
+        XMLoadFloat3(&vertices[indices[t * 3 + 2]].Position)
+    ) / 3.0f;
+}
+
+static void compute_bounds(const uint32_t* indices, const Vertex* vertices, Meshlet* meshlet) {
+    const uint32_t* first = indices + meshlet->first_index;
+    uint32_t triangle_count = meshlet->index_count / 3;
+
+    XMVECTOR bounds_min = XMLoadFloat3(&vertices[first[0]].Position);
+    XMVECTOR bounds_max = bounds_min;
+    for (uint32_t i = 1; i < meshlet->index_count; i++) {
+        XMVECTOR p = XMLoadFloat3(&vertices[first[i]].Position);
+        bounds_min = XMVectorMin(bounds_min, p);
+        bounds_max = XMVectorMax(bounds_max, p);
+    }
+
+    XMVECTOR center = (bounds_min + bounds_max) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = 0; i < meshlet->index_count; i++) {
+        float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&vertices[first[i]].Position) - center));
+        radius = distance > radius ? distance : radius;
+    }
+    XMStoreFloat3(&meshlet->center, center);
+    meshlet->radius = radius;
+
+    // unit triangle normals, clockwise winding so these point out of the front face
+    XMVECTOR axis = XMVectorZero();
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        XMVECTOR a = XMLoadFloat3(&vertices[first[t * 3 + 0]].Position);
+        XMVECTOR b = XMLoadFloat3(&vertices[first[t * 3 + 1]].Position);
+        XMVECTOR c = XMLoadFloat3(&vertices[first[t * 3 + 2]].Position);
+        XMVECTOR normal = XMVector3Cross(b - a, c - a);
+        if (XMVectorGetX(XMVector3LengthSq(normal)) > 0.0f) {
+            axis += XMVector3Normalize(normal);
+        }
+    }
+
+    meshlet->cone_axis = XMFLOAT3(0, 0, 0);
+    meshlet->cone_cutoff = 1.0f;
+    if (XMVectorGetX(XMVector3LengthSq(axis)) <= 0.0f) return;
+    axis = XMVector3Normalize(axis);
+
+    float min_dot = 1.0f;
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        XMVECTOR a = XMLoadFloat3(&vertices[first[t * 3 + 0]].Position);
+        XMVECTOR b = XMLoadFloat3(&vertices[first[t * 3 + 1]].Position);
+        XMVECTOR c = XMLoadFloat3(&vertices[first[t * 3 + 2]].Position);
+        XMVECTOR normal = XMVector3Cross(b - a, c - a);
+        if (XMVectorGetX(XMVector3LengthSq(normal)) <= 0.0f) continue;
+
+        float dot = XMVectorGetX(XMVector3Dot(axis, XMVector3Normalize(normal)));
+        min_dot = dot < min_dot ? dot : min_dot;
+    }
+
+    XMStoreFloat3(&meshlet->cone_axis, axis);
+    if (min_dot > MIN_CONE_DOT) {
+        meshlet->cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+    }
+}
+
+void meshlet_build(
+    uint32_t* indices,
+    size_t index_count,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    std::vector<Meshlet>* out_meshlets
+) {
+    out_meshlets->clear();
+    uint32_t triangle_count = (uint32_t)(index_count / 3);
+    if (triangle_count == 0) return;
+
+    // vertex -> triangles
+    std::vector<uint32_t> adjacency_offsets((size_t)vertex_count + 1, 0);
+    for (size_t i = 0; i < index_count; i++) {
+        adjacency_offsets[indices[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        adjacency_offsets[v + 1] += adjacency_offsets[v];
+    }
+    std::vector<uint32_t> adjacency(index_count);
+    std::vector<uint32_t> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t i = 0; i < index_count; i++) {
+        adjacency[cursors[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    // vertex_stamps[v] == stamp means v is already in the current meshlet
+    std::vector<uint32_t> vertex_stamps(vertex_count, UINT32_MAX);
+    std::vector<uint32_t> meshlet_vertices;
+    std::vector<uint32_t> result;
+    result.reserve(index_count);
+
+    // running sum of triangle centroids, keeps growth roughly round
+    XMVECTOR centroid_sum = XMVectorZero();
+    uint32_t stamp = 0;
+    uint32_t seed_cursor = 0;
+    uint32_t next = INVALID_TRIANGLE;
+    Meshlet meshlet = {};
+
+    for (uint32_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        // no neighbour to grow into, move on to the next unused triangle
+        //   in the existing (cache optimized) order. it's probably nowhere
+        //   near this meshlet, so that starts a new one too
+        bool disconnected = next == INVALID_TRIANGLE;
+        if (disconnected) {
+            while (emitted[seed_cursor]) seed_cursor++;
+            next = seed_cursor;
+        }
+
+        // close off the current meshlet if this triangle doesn't fit
+        uint32_t added = new_vertex_count(indices, next, vertex_stamps, stamp);
+        bool full = meshlet.vertex_count + added > MESHLET_MAX_VERTICES || meshlet.index_count / 3 + 1 > MESHLET_MAX_TRIANGLES;
+        if (meshlet.index_count > 0 && (full || disconnected)) {
+            out_meshlets->push_back(meshlet);
+            meshlet = {};
+            meshlet.first_index = (uint32_t)result.size();
+            meshlet_vertices.clear();
+            centroid_sum = XMVectorZero();
+            stamp++;
+        }
+
+        emitted[next] = 1;
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = indices[next * 3 + c];
+            result.push_back(v);
+            if (vertex_stamps[v] != stamp) {
+                vertex_stamps[v] = stamp;
+                meshlet_vertices.push_back(v);
+                meshlet.vertex_count++;
+            }
+        }
+        meshlet.index_count += 3;
+        centroid_sum += triangle_centroid(indices, vertices, next);
+        XMVECTOR centroid = centroid_sum / (float)(meshlet.index_count / 3);
+
+        // grow through whichever neighbouring triangle adds the fewest new
+        //   verts, closest to the middle of the meshlet breaking ties. without
+        //   the distance check meshlets follow the cache order into long strips
+        next = INVALID_TRIANGLE;
+        uint32_t best_added = UINT32_MAX;
+        float best_distance = FLT_MAX;
+        for (uint32_t v : meshlet_vertices) {
+            for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v + 1]; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+
+                uint32_t candidate_added = new_vertex_count(indices, t, vertex_stamps, stamp);
+                if (candidate_added > best_added) continue;
+
+                float distance = XMVectorGetX(XMVector3LengthSq(triangle_centroid(indices, vertices, t) - centroid));
+                if (candidate_added < best_added || distance < best_distance) {
+                    best_added = candidate_added;
+                    best_distance = distance;
+                    next = t;
+                }
+            }
+        }
+    }
+    out_meshlets->push_back(meshlet);
+
+    memcpy(indices, result.data(), sizeof(uint32_t) * result.size());
+
+    for (Meshlet& m : *out_meshlets) {
+        compute_bounds(indices, vertices, &m);
+    }
+}
+
+MeshletCullParams meshlet_cull_params_create(const XMFLOAT4X4& world_view_proj, XMFLOAT3 camera_position) {
+    // Gribb/Hartmann plane extraction, row vector matrices so the planes come
+    //   from the columns. D3D clip space z goes 0 -> w, so near is just column 2
+    const XMFLOAT4X4& m = world_view_proj;
+    XMFLOAT4 column0(m._11, m._21, m._31, m._41);
+    XMFLOAT4 column1(m._12, m._22, m._32, m._42);
+    XMFLOAT4 column2(m._13, m._23, m._33, m._43);
+    XMFLOAT4 column3(m._14, m._24, m._34, m._44);
+
+    XMVECTOR c0 = XMLoadFloat4(&column0);
+    XMVECTOR c1 = XMLoadFloat4(&column1);
+    XMVECTOR c2 = XMLoadFloat4(&column2);
+    XMVECTOR c3 = XMLoadFloat4(&column3);
+
+    XMVECTOR planes[6] = {
+        c3 + c0,
+        c3 - c0,
+        c3 + c1,
+        c3 - c1,
+        c2,
+        c3 - c2,
+    };
+
+    MeshletCullParams params = {};
+    for (int i = 0; i < 6; i++) {
+        float length = XMVectorGetX(XMVector3Length(planes[i]));
+        XMStoreFloat4(&params.planes[i], length > 0.0f ? planes[i] / length : planes[i]);
+    }
+    params.camera_position = camera_position;
+    return params;
+}
+
+static bool meshlet_visible(const Meshlet& meshlet, const MeshletCullParams& params) {
+    XMVECTOR center = XMLoadFloat3(&meshlet.center);
+
+    for (const XMFLOAT4& plane : params.planes) {
+        float distance = plane.x * meshlet.center.x + plane.y * meshlet.center.y + plane.z * meshlet.center.z + plane.w;
+        if (distance < -meshlet.radius) return false;
+    }
+
+    // every triangle faces away if the view direction falls inside the cone
+    if (meshlet.cone_cutoff < 1.0f) {
+        XMVECTOR view = center - XMLoadFloat3(&params.camera_position);
+        float along_axis = XMVectorGetX(XMVector3Dot(view, XMLoadFloat3(&meshlet.cone_axis)));
+        float distance = XMVectorGetX(XMVector3Length(view));
+        if (along_axis >= meshlet.cone_cutoff * distance + meshlet.radius) return false;
+    }
+
+    return true;
+}
+
+uint32_t meshlet_cull(
+    const Meshlet* meshlets,
+    uint32_t meshlet_count,
+    const MeshletCullParams& params,
+    std::vector<MeshletDraw>* out_draws
+) {
+    out_draws->clear();
+
+    uint32_t visible_count = 0;
+    for (uint32_t i = 0; i < meshlet_count; i++) {
+        const Meshlet& meshlet = meshlets[i];
+        if (!meshlet_visible(meshlet, params)) continue;
+        visible_count++;
+
+        // meshlets are back to back in the index buffer, so neighbours merge into one draw
+        if (!out_draws->empty() && out_draws->back().first_index + out_draws->back().index_count == meshlet.first_index) {
+            out_draws->back().index_count += meshlet.index_count;
+        } else {
+            out_draws->push_back({ meshlet.first_index, meshlet.index_count });
+        }
+    }
+
+    return visible_count;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// a small cluster of triangles. there's no mesh shader path, so every
+//   meshlet is just a contiguous range of LOD 0's index buffer and visible
+//   runs of them get drawn with regular indexed draws
+//! part of the cooked mesh format, don't reorder
+struct Meshlet {
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t vertex_count;
+    uint32_t reserved;
+
+    // object space bounding sphere
+    DirectX::XMFLOAT3 center;
+    float radius;
+
+    // backface cone, average triangle normal and the sine of the cone's
+    //   spread. cutoff >= 1 means the triangles face too many directions to cull
+    DirectX::XMFLOAT3 cone_axis;
+    float cone_cutoff;
+};
+
+// everything culling needs, all in the mesh's object space
+struct MeshletCullParams {
+    // left, right, bottom, top, near, far, normalized, pointing inwards
+    DirectX::XMFLOAT4 planes[6];
+    DirectX::XMFLOAT3 camera_position;
+};
+
+// a run of visible meshlets that can go out as one draw
+struct MeshletDraw {
+    uint32_t first_index;
+    uint32_t index_count;
+};
+
+// splits triangles into meshlets of at most MESHLET_MAX_VERTICES verts &
+//   MESHLET_MAX_TRIANGLES triangles, growing each one through neighbouring
+//   triangles so they stay compact. indices get reordered in place so every
+//   meshlet is contiguous
+void meshlet_build(
+    uint32_t* indices,
+    size_t index_count,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    std::vector<Meshlet>* out_meshlets
+);
+
+// pulls frustum planes out of world * view * proj, camera_position has
+//   to already be in the mesh's object space
+MeshletCullParams meshlet_cull_params_create(
+    const DirectX::XMFLOAT4X4& world_view_proj,
+    DirectX::XMFLOAT3 camera_position
+);
+
+// frustum & backface cone tests every meshlet, writing out merged draws for
+//   the survivors. returns how many meshlets were visible
+uint32_t meshlet_cull(
+    const Meshlet* meshlets,
+    uint32_t meshlet_count,
+    const MeshletCullParams& params,
+    std::vector<MeshletDraw>* out_draws
+);
@@ -0,0 +1,454 @@
+#include "ObjParser.h"
+
+#include "MappedFile.h"
+#include "Parallel.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace DirectX;
+
+namespace {
+    // chunks smaller than this aren't worth handing to another thread
+    constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    // per-attribute flags for a face corner
+    //   LOCAL   - index is relative to the start of its chunk (negative OBJ indices)
+    //   MISSING - the face didn't specify this attribute at all
+    constexpr uint8_t POSITION_LOCAL = 1 << 0;
+    constexpr uint8_t UV_LOCAL = 1 << 1;
+    constexpr uint8_t NORMAL_LOCAL = 1 << 2;
+    constexpr uint8_t UV_MISSING = 1 << 3;
+    constexpr uint8_t NORMAL_MISSING = 1 << 4;
+
+    // exact in single precision, used by the float fast path
+    constexpr float POW10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+    struct ObjCorner {
+        int32_t position;
+        int32_t uv;
+        int32_t normal;
+        uint8_t flags;
+    };
+
+    struct ObjChunk {
+        const char* start;
+        const char* end;
+
+        std::vector<XMFLOAT3> positions;
+        std::vector<XMFLOAT2> uvs;
+        std::vector<XMFLOAT3> normals;
+        // already triangulated & winding-flipped, 3 per triangle
+        std::vector<ObjCorner> corners;
+
+        // where this chunk's data lands once everything is stitched together
+        uint32_t position_base;
+        uint32_t uv_base;
+        uint32_t normal_base;
+        size_t corner_base;
+
+        bool malformed;
+    };
+}
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p)) p++;
+    return p;
+}
+
+static const char* skip_token(const char* p, const char* end) {
+    while (p < end && !is_blank(*p)) p++;
+    return p;
+}
+
+// scans a decimal float, rounding exactly like sscanf's %f does so output
+//   stays bit-identical to the old loader. most OBJ numbers have few enough
+//   digits to take the fast path, everything else goes through from_chars.
+//   returns the char after the number, or p itself if there wasn't one.
+static const char* scan_float(const char* p, const char* end, float* out) {
+    const char* start = p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    const char* number_start = p;
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    bool truncated = false;
+
+    for (; p < end && is_digit(*p); p++) {
+        any_digits = true;
+        if (significant_digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa != 0) significant_digits++;
+        } else {
+            truncated |= *p != '0';
+            exponent++;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && is_digit(*p); p++) {
+            any_digits = true;
+            if (significant_digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa != 0) significant_digits++;
+                exponent--;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
+    }
+
+    // no digits means either junk or inf/nan, let the library sort it out
+    if (!any_digits) {
+        float value = 0.0f;
+        auto result = std::from_chars(number_start, end, value);
+        if (result.ec != std::errc()) {
+            return start;
+        }
+        *out = negative ? -value : value;
+        return result.ptr;
+    }
+
+    // exponent only counts if there's actually a number after the 'e'
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool exp_negative = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            exp_negative = *e == '-';
+            e++;
+        }
+
+        if (e < end && is_digit(*e)) {
+            int exp_value = 0;
+            for (; e < end && is_digit(*e); e++) {
+                if (exp_value < 10000) exp_value = exp_value * 10 + (*e - '0');
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = e;
+        }
+    }
+
+    float value = 0.0f;
+    if (!truncated && mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10) {
+        // mantissa and power of ten are both exact floats, so a single
+        //   multiply/divide gives the correctly rounded result
+        value = (float)mantissa;
+        if (exponent < 0) {
+            value /= POW10[-exponent];
+        } else {
+            value *= POW10[exponent];
+        }
+    } else {
+        auto result = std::from_chars(number_start, p, value);
+        if (result.ec == std::errc::result_out_of_range) {
+            value = exponent > 0 ? std::numeric_limits<float>::infinity() : 0.0f;
+        }
+    }
+
+    *out = negative ? -value : value;
+    return p;
+}
+
+// scans up to count whitespace separated floats, anything
+//   missing is left untouched (the same as sscanf would)
+static const char* scan_floats(const char* p, const char* end, float* out, int count) {
+    for (int i = 0; i < count; i++) {
+        p = skip_blanks(p, end);
+        const char* next = scan_float(p, end, &out[i]);
+        if (next == p) break;
+        p = next;
+    }
+    return p;
+}
+
+static const char* scan_int(const char* p, const char* end, int32_t* out, bool* out_found) {
+    bool negative = false;
+    const char* digits = p;
+    if (digits < end && (*digits == '-' || *digits == '+')) {
+        negative = *digits == '-';
+        digits++;
+    }
+
+    if (digits >= end || !is_digit(*digits)) {
+        *out_found = false;
+        return p;
+    }
+
+    int64_t value = 0;
+    for (; digits < end && is_digit(*digits); digits++) {
+        if (value <= INT32_MAX) value = value * 10 + (*digits - '0');
+    }
+    if (value > INT32_MAX) value = INT32_MAX;
+
+    *out = (int32_t)(negative ? -value : value);
+    *out_found = true;
+    return digits;
+}
+
+// turns a raw 1-based (or negative, relative) OBJ index into either an
+//   absolute 0-based index or one relative to the start of the chunk
+static bool convert_index(int32_t raw, size_t local_count, uint8_t local_flag, int32_t* out, uint8_t* flags) {
+    if (raw > 0) {
+        *out = raw - 1;
+        return true;
+    }
+    if (raw < 0) {
+        *out = (int32_t)local_count + raw;
+        *flags |= local_flag;
+        return true;
+    }
+    return false;
+}
+
+static void parse_face(ObjChunk* chunk, const char* p, const char* end, std::vector<ObjCorner>* face) {
+    face->clear();
+
+    while (true) {
+        p = skip_blanks(p, end);
+        if (p >= end || *p == '#') break;
+
+        ObjCorner corner = {};
+        bool found = false;
+        int32_t raw = 0;
+
+        // position is required
+        p = scan_int(p, end, &raw, &found);
+        if (!found || !convert_index(raw, chunk->positions.size(), POSITION_LOCAL, &corner.position, &corner.flags)) {
+            chunk->malformed = true;
+            p = skip_token(p, end);
+            continue;
+        }
+
+        // v/vt, v//vn or v/vt/vn
+        bool has_uv = false;
+        bool has_normal = false;
+        if (p < end && *p == '/') {
+            p++;
+            p = scan_int(p, end, &raw, &found);
+            if (found) {
+                has_uv = convert_index(raw, chunk->uvs.size(), UV_LOCAL, &corner.uv, &corner.flags);
+                chunk->malformed |= !has_uv;
+            }
+
+            if (p < end && *p == '/') {
+                p++;
+                p = scan_int(p, end, &raw, &found);
+                if (found) {
+                    has_normal = convert_index(raw, chunk->normals.size(), NORMAL_LOCAL, &corner.normal, &corner.flags);
+                    chunk->malformed |= !has_normal;
+                }
+            }
+        }
+
+        if (!has_uv) {
+            // the old loader pointed uv-less corners at the very first uv in
+            //   the file (or a 0,0 one if there weren't any yet), keep doing that
+            if (chunk->uvs.empty()) {
+                corner.flags |= UV_MISSING;
+            } else {
+                corner.uv = 0;
+            }
+        }
+        if (!has_normal) {
+            corner.flags |= NORMAL_MISSING;
+        }
+
+        face->push_back(corner);
+        p = skip_token(p, end);
+    }
+
+    // fan triangulate n-gons, flipping the winding order as we go
+    for (size_t i = 1; i + 1 < face->size(); i++) {
+        chunk->corners.push_back((*face)[0]);
+        chunk->corners.push_back((*face)[i + 1]);
+        chunk->corners.push_back((*face)[i]);
+    }
+}
+
+static void parse_chunk(ObjChunk* chunk) {
+    std::vector<ObjCorner> face;
+    const char* p = chunk->start;
+    const char* end = chunk->end;
+
+    while (p < end) {
+        const char* line_end = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (line_end == nullptr) line_end = end;
+
+        const char* c = skip_blanks(p, line_end);
+        if (line_end - c >= 2 && c[0] == 'v') {
+            if (c[1] == 'n') {
+                XMFLOAT3 normal = {};
+                scan_floats(c + 2, line_end, &normal.x, 3);
+                chunk->normals.push_back(normal);
+            } else if (c[1] == 't') {
+                XMFLOAT2 uv = {};
+                scan_floats(c + 2, line_end, &uv.x, 2);
+                chunk->uvs.push_back(uv);
+            } else if (is_blank(c[1])) {
+                XMFLOAT3 position = {};
+                scan_floats(c + 1, line_end, &position.x, 3);
+                chunk->positions.push_back(position);
+            }
+        } else if (line_end - c >= 2 && c[0] == 'f' && is_blank(c[1])) {
+            parse_face(chunk, c + 1, line_end, &face);
+        }
+
+        p = line_end < end ? line_end + 1 : end;
+    }
+}
+
+static bool resolve_index(int32_t index, bool local, uint32_t base, size_t count, size_t* out) {
+    int64_t global = local ? (int64_t)base + index : (int64_t)index;
+    if (global < 0 || global >= (int64_t)count) {
+        return false;
+    }
+    *out = (size_t)global;
+    return true;
+}
+
+void obj_parse(const char* data, size_t size, std::vector<Vertex>* out_vertices, ObjParseStats* out_stats) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // split the file into roughly even chunks, nudging each boundary
+    //   forward so it always lands right after a newline
+    size_t chunk_count = size / MIN_CHUNK_BYTES;
+    size_t max_chunks = (size_t)parallel_worker_count() * 4;
+    if (chunk_count > max_chunks) chunk_count = max_chunks;
+    if (chunk_count < 1) chunk_count = 1;
+
+    std::vector<ObjChunk> chunks(chunk_count);
+    const char* end = data + size;
+    const char* cursor = data;
+    for (size_t i = 0; i < chunk_count; i++) {
+        chunks[i].start = cursor;
+
+        if (i == chunk_count - 1) {
+            chunks[i].end = end;
+        } else {
+            const char* target = data + size / chunk_count * (i + 1);
+            if (target < cursor) target = cursor;
+            const char* newline = (const char*)memchr(target, '\n', (size_t)(end - target));
+            chunks[i].end = newline != nullptr ? newline + 1 : end;
+        }
+
+        cursor = chunks[i].end;
+    }
+
+    parallel_for((uint32_t)chunk_count, [&](uint32_t i) {
+        parse_chunk(&chunks[i]);
+    });
+
+    // figure out where each chunk's data goes in the final arrays
+    std::vector<XMFLOAT3> positions;
+    std::vector<XMFLOAT2> uvs;
+    std::vector<XMFLOAT3> normals;
+    size_t corner_count = 0;
+    {
+        size_t position_count = 0;
+        size_t uv_count = 0;
+        size_t normal_count = 0;
+        for (auto& chunk : chunks) {
+            chunk.position_base = (uint32_t)position_count;
+            chunk.uv_base = (uint32_t)uv_count;
+            chunk.normal_base = (uint32_t)normal_count;
+            chunk.corner_base = corner_count;
+            position_count += chunk.positions.size();
+            uv_count += chunk.uvs.size();
+            normal_count += chunk.normals.size();
+            corner_count += chunk.corners.size();
+        }
+
+        positions.reserve(position_count);
+        uvs.reserve(uv_count);
+        normals.reserve(normal_count);
+        for (auto& chunk : chunks) {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        }
+    }
+
+    // now every face corner can be resolved into an actual vertex
+    out_vertices->resize(corner_count);
+    parallel_for((uint32_t)chunk_count, [&](uint32_t c) {
+        ObjChunk* chunk = &chunks[c];
+        Vertex* out = out_vertices->data() + chunk->corner_base;
+
+        for (const ObjCorner& corner : chunk->corners) {
+            Vertex v {};
+            size_t index = 0;
+
+            if (resolve_index(corner.position, corner.flags & POSITION_LOCAL, chunk->position_base, positions.size(), &index)) {
+                v.Position = positions[index];
+            } else {
+                chunk->malformed = true;
+            }
+
+            if (corner.flags & UV_MISSING) {
+                v.UV = chunk->uv_base > 0 ? uvs[0] : XMFLOAT2(0, 0);
+            } else if (resolve_index(corner.uv, corner.flags & UV_LOCAL, chunk->uv_base, uvs.size(), &index)) {
+                v.UV = uvs[index];
+            } else {
+                chunk->malformed = true;
+            }
+
+            if (corner.flags & NORMAL_MISSING) {
+                v.Normal = XMFLOAT3(0, 0, 0);
+            } else if (resolve_index(corner.normal, corner.flags & NORMAL_LOCAL, chunk->normal_base, normals.size(), &index)) {
+                v.Normal = normals[index];
+            } else {
+                chunk->malformed = true;
+            }
+
+            // models are most likely right-handed w/ uv (0,0) in the bottom
+            //   left, so flip z (and the normal's z) and the uv's v
+            v.UV.y = 1.0f - v.UV.y;
+            v.Position.z *= -1.0f;
+            v.Normal.z *= -1.0f;
+
+            *out++ = v;
+        }
+    });
+
+    for (auto& chunk : chunks) {
+        if (chunk.malformed) {
+            throw std::invalid_argument("Error parsing OBJ: face references a vertex attribute that doesn't exist");
+        }
+    }
+
+    if (out_stats != nullptr) {
+        out_stats->file_bytes = size;
+        out_stats->chunk_count = (uint32_t)chunk_count;
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        out_stats->seconds = elapsed.count();
+    }
+}
+
+void obj_parse_file(const char* path, std::vector<Vertex>* out_vertices, ObjParseStats* out_stats) {
+    MappedFile file;
+    if (!mapped_file_open(path, &file)) {
+        throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
+    }
+
+    try {
+        obj_parse((const char*)file.data, file.size, out_vertices, out_stats);
+    } catch (...) {
+        mapped_file_close(&file);
+        throw;
+    }
+
+    mapped_file_close(&file);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// timing/size info from a parse, handy for keeping an eye on load throughput
+struct ObjParseStats {
+    size_t file_bytes;
+    uint32_t chunk_count;
+    double seconds;
+};
+
+// parses OBJ text into a flat, triangulated (NOT de-duplicated) list of
+//   vertices, 3 per triangle. output is converted to our left-handed
+//   conventions (z flipped, uv v flipped, winding flipped) and tangents
+//   are left zeroed. big inputs get split into newline-aligned chunks
+//   that are parsed in parallel and stitched back together in order.
+//! throws std::invalid_argument on malformed face indices
+void obj_parse(
+    const char* data,
+    size_t size,
+    std::vector<Vertex>* out_vertices,
+    ObjParseStats* out_stats = nullptr
+);
+
+// memory maps the file at path and parses it with obj_parse
+//! throws std::invalid_argument if the file can't be opened
+void obj_parse_file(
+    const char* path,
+    std::vector<Vertex>* out_vertices,
+    ObjParseStats* out_stats = nullptr
+);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// how many threads we're willing to throw at a parallel_for. asked once,
+//   hardware_concurrency isn't free (it reads /sys on linux) & small jobs
+//   call this on every run
+inline uint32_t parallel_worker_count() {
+    static const uint32_t count = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    return count;
+}
+
+// runs func(i) for every i in [0, count) across a handful of threads and
+//   blocks until all of them are done. the calling thread pitches in too,
+//   so a count of 1 (or a single core machine) never spawns anything.
+//! func must not throw, exceptions on worker threads will terminate the app
+template <typename F>
+void parallel_for(uint32_t count, F&& func) {
+    uint32_t num_threads = parallel_worker_count();
+    if (num_threads > count) {
+        num_threads = count;
+    }
+
+    if (num_threads <= 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    // work is handed out one index at a time so uneven items balance out
+    std::atomic<uint32_t> next_index = 0;
+    auto worker = [&]() {
+        for (uint32_t i = next_index++; i < count; i = next_index++) {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (uint32_t i = 1; i < num_threads; i++) {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,170 @@
+#include "ParallelRecorder.h"
+
+void record_split(
+    const uint32_t* costs,
+    uint32_t count,
+    uint32_t max_chunks,
+    uint64_t min_chunk_cost,
+    std::vector<RecordChunk>* out_chunks
+) {
+    out_chunks->clear();
+    if (count == 0) return;
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += costs[i];
+    }
+
+    uint64_t chunk_count = max_chunks;
+    if (min_chunk_cost > 0) {
+        uint64_t by_cost = total / min_chunk_cost;
+        chunk_count = by_cost < chunk_count ? by_cost : chunk_count;
+    }
+    chunk_count = chunk_count < count ? chunk_count : count;
+    chunk_count = chunk_count > 0 ? chunk_count : 1;
+
+    // cut wherever the running cost passes the next even share, a big item
+    //   can swallow a share or two so there might be fewer chunks
+    RecordChunk chunk = { 0, 0 };
+    uint64_t running = 0;
+    uint64_t boundary = total / chunk_count;
+    for (uint32_t i = 0; i < count; i++) {
+        running += costs[i];
+        chunk.count++;
+
+        if (running >= boundary && out_chunks->size() + 1 < chunk_count && i + 1 < count) {
+            out_chunks->push_back(chunk);
+            chunk = { i + 1, 0 };
+            boundary = total * (out_chunks->size() + 1) / chunk_count;
+        }
+    }
+    out_chunks->push_back(chunk);
+}
+
+static void run_chunk(ParallelRecorder* recorder, uint32_t index) {
+    const RecordSlot& slot = recorder->slots[index];
+    recorder->backend->begin_list(slot);
+    recorder->job(slot, recorder->chunks[index]);
+    recorder->backend->end_list(slot);
+}
+
+static void worker_main(ParallelRecorder* recorder, uint32_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(recorder->mutex);
+            recorder->start.wait(lock, [&] { return recorder->quit || recorder->generation != seen; });
+            if (recorder->quit) return;
+            seen = recorder->generation;
+            // fewer chunks than workers this time, nothing to do
+            if (worker >= recorder->chunks.size()) continue;
+        }
+
+        run_chunk(recorder, worker);
+
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        if (--recorder->pending == 0) {
+            recorder->done.notify_one();
+        }
+    }
+}
+
+void parallel_recorder_create(
+    ParallelRecorder* recorder,
+    uint32_t worker_count,
+    uint32_t allocator_count,
+    RecordBackend* backend
+) {
+    recorder->worker_count = worker_count > 0 ? worker_count : 1;
+    recorder->allocator_count = allocator_count;
+    recorder->backend = backend;
+    recorder->workers.assign(recorder->worker_count, {});
+    for (RecordWorker& worker : recorder->workers) {
+        // frame 0 never happens, so every allocator resets on first use
+        worker.allocator_frames.assign(allocator_count, 0);
+    }
+    recorder->frame = 0;
+    recorder->frame_slot = 0;
+    recorder->generation = 0;
+    recorder->pending = 0;
+    recorder->quit = false;
+    recorder->stats = {};
+
+    for (uint32_t w = 1; w < recorder->worker_count; w++) {
+        recorder->threads.emplace_back(worker_main, recorder, w);
+    }
+}
+
+void parallel_recorder_destroy(ParallelRecorder* recorder) {
+    {
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        recorder->quit = true;
+    }
+    recorder->start.notify_all();
+    for (std::thread& thread : recorder->threads) {
+        thread.join();
+    }
+    recorder->threads.clear();
+    recorder->workers.clear();
+}
+
+void parallel_recorder_begin_frame(ParallelRecorder* recorder, uint32_t frame_slot) {
+    recorder->frame++;
+    recorder->frame_slot = frame_slot;
+    for (RecordWorker& worker : recorder->workers) {
+        worker.lists_used = 0;
+    }
+    recorder->stats.frame_count++;
+}
+
+void parallel_recorder_record(
+    ParallelRecorder* recorder,
+    const uint32_t* costs,
+    uint32_t count,
+    uint64_t min_chunk_cost,
+    std::function<void(const RecordSlot&, RecordChunk)> job
+) {
+    record_split(costs, count, recorder->worker_count, min_chunk_cost, &recorder->chunks);
+    if (recorder->chunks.empty()) return;
+
+    // a list that's been submitted can be reopened right away, it's only
+    //   the allocator that has to wait for the GPU
+    recorder->slots.clear();
+    for (uint32_t c = 0; c < (uint32_t)recorder->chunks.size(); c++) {
+        RecordWorker& worker = recorder->workers[c];
+        RecordSlot slot = {};
+        slot.worker = c;
+        slot.list = worker.lists_used++;
+        slot.allocator = recorder->frame_slot;
+        slot.reset_allocator = worker.allocator_frames[recorder->frame_slot] != recorder->frame;
+        worker.allocator_frames[recorder->frame_slot] = recorder->frame;
+        recorder->slots.push_back(slot);
+
+        if (worker.lists_used > worker.list_count) {
+            worker.list_count = worker.lists_used;
+            recorder->stats.list_count++;
+        }
+        recorder->stats.allocator_reset_count += slot.reset_allocator ? 1 : 0;
+    }
+    recorder->stats.record_count++;
+    recorder->stats.chunk_count += recorder->chunks.size();
+
+    recorder->job = std::move(job);
+    bool wake = recorder->chunks.size() > 1;
+    {
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        recorder->pending = (uint32_t)recorder->chunks.size() - 1;
+        recorder->generation++;
+    }
+    if (wake) {
+        recorder->start.notify_all();
+    }
+
+    run_chunk(recorder, 0);
+    {
+        std::unique_lock<std::mutex> lock(recorder->mutex);
+        recorder->done.wait(lock, [&] { return recorder->pending == 0; });
+    }
+
+    recorder->backend->submit(recorder->slots.data(), (uint32_t)recorder->slots.size());
+}
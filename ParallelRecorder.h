@@ -0,0 +1,146 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// least cost (draws & meshlets, a quarter of a microsecond or so each) a
+//   chunk's worth handing to a worker. waking one costs ~4 us, its list
+//   setting the pass up again about as much, ParallelRecorderTests measures it
+constexpr uint64_t RECORD_CHUNK_MIN_COST = 32;
+
+// a contiguous run of items that one worker records
+struct RecordChunk {
+    uint32_t first;
+    uint32_t count;
+};
+
+// where a chunk gets recorded: the worker's list-th command list this
+//   frame, on its allocator for the frame slot. an allocator only gets reset
+//   the first time it's used in a frame, lists after that add to it
+struct RecordSlot {
+    uint32_t worker;
+    uint32_t list;
+    uint32_t allocator;
+    bool reset_allocator;
+};
+
+struct ParallelRecorderStats {
+    uint64_t frame_count;
+    // over the recorder's life
+    uint64_t record_count;
+    uint64_t chunk_count;
+    uint64_t allocator_reset_count;
+    // lists every worker needed at most, summed
+    uint32_t list_count;
+};
+
+// what a recorder needs from the GPU side, see MockRecordBackend for one
+//   that just writes everything down
+class RecordBackend {
+   public:
+    virtual ~RecordBackend() = default;
+    // on the worker's thread before its chunk: reset the allocator if the
+    //   slot says so, then (re)open the list on it
+    virtual void begin_list(const RecordSlot& slot) = 0;
+    // on the worker's thread after its chunk
+    virtual void end_list(const RecordSlot& slot) = 0;
+    // main thread, every closed list of one record call in chunk order
+    virtual void submit(const RecordSlot* slots, uint32_t count) = 0;
+};
+
+// stands in for the command lists: each worker gets its own log so the
+//   threads never touch the same memory
+class MockRecordBackend : public RecordBackend {
+   public:
+    struct Event {
+        RecordSlot slot;
+        bool begin;
+    };
+    std::vector<std::vector<Event>> worker_events;
+    std::vector<RecordSlot> submitted;
+    uint32_t submit_count = 0;
+
+    explicit MockRecordBackend(uint32_t worker_count) : worker_events(worker_count) {}
+
+    void begin_list(const RecordSlot& slot) override { worker_events[slot.worker].push_back({ slot, true }); }
+    void end_list(const RecordSlot& slot) override { worker_events[slot.worker].push_back({ slot, false }); }
+    void submit(const RecordSlot* slots, uint32_t count) override {
+        submitted.insert(submitted.end(), slots, slots + count);
+        submit_count++;
+    }
+};
+
+struct RecordWorker {
+    // lists the worker's used in any one frame, the backend keeps that many
+    uint32_t list_count;
+    uint32_t lists_used;
+    // frame each allocator was last reset in
+    std::vector<uint64_t> allocator_frames;
+};
+
+// records a frame's draws on several threads. items get split into one
+//   contiguous chunk per worker by cost, chunk i goes to worker i (the
+//   calling thread is worker 0) & the lists get submitted in chunk order,
+//   so the GPU sees the draws in the order they came in
+struct ParallelRecorder {
+    uint32_t worker_count;
+    // one per frame in flight, per worker
+    uint32_t allocator_count;
+    RecordBackend* backend;
+    std::vector<RecordWorker> workers;
+    uint64_t frame;
+    uint32_t frame_slot;
+
+    // the record call in progress
+    std::vector<RecordChunk> chunks;
+    std::vector<RecordSlot> slots;
+    std::function<void(const RecordSlot&, RecordChunk)> job;
+
+    // workers 1 & up, they sleep between record calls
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    uint64_t generation;
+    uint32_t pending;
+    bool quit;
+
+    ParallelRecorderStats stats;
+};
+
+// count items into at most max_chunks contiguous chunks of about equal
+//   cost, fewer if a chunk would come in under min_chunk_cost. none are empty
+void record_split(
+    const uint32_t* costs,
+    uint32_t count,
+    uint32_t max_chunks,
+    uint64_t min_chunk_cost,
+    std::vector<RecordChunk>* out_chunks
+);
+
+// starts worker_count - 1 threads
+void parallel_recorder_create(
+    ParallelRecorder* recorder,
+    uint32_t worker_count,
+    uint32_t allocator_count,
+    RecordBackend* backend
+);
+void parallel_recorder_destroy(ParallelRecorder* recorder);
+
+// frame_slot picks each worker's allocator, the caller makes sure the GPU's
+//   done with whatever that slot recorded last time
+void parallel_recorder_begin_frame(ParallelRecorder* recorder, uint32_t frame_slot);
+
+// splits the items, runs job on every chunk in parallel between
+//   begin_list & end_list, then submits. returns once everything's recorded
+void parallel_recorder_record(
+    ParallelRecorder* recorder,
+    const uint32_t* costs,
+    uint32_t count,
+    uint64_t min_chunk_cost,
+    std::function<void(const RecordSlot&, RecordChunk)> job
+);
@@ -0,0 +1,615 @@
+#include "PngDecoder.h"
+
+#include "Inflate.h"
+#include <chrono>
+#include <cstring>
+#include <emmintrin.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr uint8_t PNG_SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    constexpr uint32_t FILTER_NONE = 0;
+    constexpr uint32_t FILTER_SUB = 1;
+    constexpr uint32_t FILTER_UP = 2;
+    constexpr uint32_t FILTER_AVG = 3;
+    constexpr uint32_t FILTER_PAETH = 4;
+
+    // Adam7's passes: where each one starts & how far apart its pixels are
+    constexpr uint32_t ADAM7_X[7] = { 0, 4, 0, 2, 0, 1, 0 };
+    constexpr uint32_t ADAM7_Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+    constexpr uint32_t ADAM7_DX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+    constexpr uint32_t ADAM7_DY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+    constexpr uint32_t chunk_type(const char* name) {
+        return (uint32_t)name[0] << 24 | (uint32_t)name[1] << 16 | (uint32_t)name[2] << 8 | (uint32_t)name[3];
+    }
+    constexpr uint32_t CHUNK_IHDR = chunk_type("IHDR");
+    constexpr uint32_t CHUNK_PLTE = chunk_type("PLTE");
+    constexpr uint32_t CHUNK_TRNS = chunk_type("tRNS");
+    constexpr uint32_t CHUNK_IDAT = chunk_type("IDAT");
+    constexpr uint32_t CHUNK_IEND = chunk_type("IEND");
+
+    double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count();
+    }
+
+    uint32_t read_be32(const uint8_t* bytes) {
+        return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+    }
+
+    // slicing by 8, chunks get checked 8 bytes at a time
+    struct CrcTables {
+        uint32_t tables[8][256];
+
+        CrcTables() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (uint32_t bit = 0; bit < 8; bit++) {
+                    crc = crc & 1 ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+                }
+                tables[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; i++) {
+                for (uint32_t t = 1; t < 8; t++) {
+                    tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xff];
+                }
+            }
+        }
+    };
+    const CrcTables crc_tables;
+
+    uint32_t crc32(const uint8_t* data, size_t size) {
+        const auto& t = crc_tables.tables;
+        uint32_t crc = 0xffffffff;
+        for (; size >= 8; size -= 8) {
+            uint32_t low;
+            uint32_t high;
+            memcpy(&low, data, sizeof(low));
+            memcpy(&high, data + 4, sizeof(high));
+            low ^= crc;
+            crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24]
+                ^ t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+            data += 8;
+        }
+        for (; size > 0; size--) {
+            crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+        }
+        return crc ^ 0xffffffff;
+    }
+
+    struct Chunk {
+        uint32_t type;
+        const uint8_t* data;
+        uint32_t length;
+    };
+
+    // the chunk at offset, checked against the end of the file & its CRC
+    bool read_chunk(const uint8_t* data, size_t size, size_t offset, Chunk* out_chunk) {
+        if (offset + 12 > size) return false;
+        uint32_t length = read_be32(data + offset);
+        if (length > size - offset - 12) return false;
+        // the CRC covers the type & the data
+        if (crc32(data + offset + 4, (size_t)length + 4) != read_be32(data + offset + 8 + length)) return false;
+        out_chunk->type = read_be32(data + offset + 4);
+        out_chunk->data = data + offset + 8;
+        out_chunk->length = length;
+        return true;
+    }
+
+    bool valid_format(uint32_t color_type, uint32_t bit_depth) {
+        switch (color_type) {
+            case PNG_COLOR_GRAY:
+                return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16;
+            case PNG_COLOR_PALETTE: return bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8;
+            case PNG_COLOR_RGB:
+            case PNG_COLOR_GRAY_ALPHA:
+            case PNG_COLOR_RGBA: return bit_depth == 8 || bit_depth == 16;
+            default: return false;
+        }
+    }
+
+    uint32_t channel_count(uint32_t color_type) {
+        switch (color_type) {
+            case PNG_COLOR_RGB: return 3;
+            case PNG_COLOR_GRAY_ALPHA: return 2;
+            case PNG_COLOR_RGBA: return 4;
+            default: return 1;
+        }
+    }
+
+    // everything png_decode pulls out of the chunks
+    struct PngImage {
+        PngInfo info;
+        uint32_t channels;
+        // bytes between a byte & the one the filters predict it from
+        uint32_t filter_stride;
+        // RGBA8 as stored in memory, indices past the PLTE are opaque black
+        uint32_t palette[256];
+        bool has_key;
+        // tRNS for gray & RGB, samples that match it come out transparent
+        uint16_t key[3];
+        // the IDATs back to back, pointing straight into the file if there's one
+        const uint8_t* compressed;
+        size_t compressed_size;
+        std::vector<uint8_t> joined;
+    };
+
+    uint64_t row_bytes(const PngImage& image, uint32_t width) {
+        return ((uint64_t)width * image.channels * image.info.bit_depth + 7) / 8;
+    }
+
+    bool parse_header(const uint8_t* data, size_t size, PngInfo* out_info) {
+        Chunk chunk;
+        if (size < sizeof(PNG_SIGNATURE) || memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0
+            || !read_chunk(data, size, sizeof(PNG_SIGNATURE), &chunk) || chunk.type != CHUNK_IHDR || chunk.length != 13) {
+            return false;
+        }
+        out_info->width = read_be32(chunk.data);
+        out_info->height = read_be32(chunk.data + 4);
+        out_info->bit_depth = chunk.data[8];
+        out_info->color_type = chunk.data[9];
+        out_info->interlaced = chunk.data[12] == 1;
+        // compression & filter method are always 0
+        return out_info->width > 0 && out_info->width < 0x80000000u && out_info->height > 0
+            && out_info->height < 0x80000000u && valid_format(out_info->color_type, out_info->bit_depth)
+            && chunk.data[10] == 0 && chunk.data[11] == 0 && chunk.data[12] <= 1;
+    }
+
+    bool parse(const uint8_t* data, size_t size, PngImage* out_image) {
+        if (!parse_header(data, size, &out_image->info)) return false;
+        const PngInfo& info = out_image->info;
+        out_image->channels = channel_count(info.color_type);
+        uint32_t pixel_bits = out_image->channels * info.bit_depth;
+        out_image->filter_stride = pixel_bits < 8 ? 1 : pixel_bits / 8;
+        out_image->has_key = false;
+        for (uint32_t i = 0; i < 256; i++) {
+            out_image->palette[i] = 0xff000000;
+        }
+
+        // where the IDATs are, to join up after the walk if there's several
+        std::vector<Chunk> idats;
+        uint32_t palette_size = 0;
+        // parse_header already checked IHDR
+        size_t offset = sizeof(PNG_SIGNATURE) + 25;
+        for (;;) {
+            Chunk chunk;
+            if (!read_chunk(data, size, offset, &chunk)) return false;
+            offset += (size_t)chunk.length + 12;
+
+            if (chunk.type == CHUNK_IEND) {
+                break;
+            } else if (chunk.type == CHUNK_IDAT) {
+                idats.push_back(chunk);
+            } else if (chunk.type == CHUNK_PLTE) {
+                if (chunk.length % 3 != 0 || chunk.length > 256 * 3 || !idats.empty()) return false;
+                palette_size = chunk.length / 3;
+                for (uint32_t i = 0; i < palette_size; i++) {
+                    const uint8_t* rgb = chunk.data + i * 3;
+                    out_image->palette[i] = rgb[0] | (uint32_t)rgb[1] << 8 | (uint32_t)rgb[2] << 16 | 0xff000000;
+                }
+            } else if (chunk.type == CHUNK_TRNS) {
+                if (info.color_type == PNG_COLOR_PALETTE) {
+                    // too many alphas is an error but an easy one to shrug off
+                    uint32_t count = chunk.length < palette_size ? chunk.length : palette_size;
+                    for (uint32_t i = 0; i < count; i++) {
+                        out_image->palette[i] = (out_image->palette[i] & 0x00ffffff) | (uint32_t)chunk.data[i] << 24;
+                    }
+                } else if (info.color_type == PNG_COLOR_GRAY || info.color_type == PNG_COLOR_RGB) {
+                    uint32_t samples = info.color_type == PNG_COLOR_RGB ? 3 : 1;
+                    if (chunk.length != samples * 2) return false;
+                    for (uint32_t i = 0; i < samples; i++) {
+                        out_image->key[i] = (uint16_t)(chunk.data[i * 2] << 8 | chunk.data[i * 2 + 1]);
+                    }
+                    out_image->has_key = true;
+                }
+            } else if (!(chunk.type & 0x20000000)) {
+                // an uppercase first letter means we'd have to understand it
+                return false;
+            }
+        }
+        if (idats.empty() || (info.color_type == PNG_COLOR_PALETTE && palette_size == 0)) return false;
+
+        if (idats.size() == 1) {
+            out_image->compressed = idats[0].data;
+            out_image->compressed_size = idats[0].length;
+            return true;
+        }
+        size_t total = 0;
+        for (const Chunk& idat : idats) {
+            total += idat.length;
+        }
+        out_image->joined.resize(total);
+        total = 0;
+        for (const Chunk& idat : idats) {
+            memcpy(out_image->joined.data() + total, idat.data, idat.length);
+            total += idat.length;
+        }
+        out_image->compressed = out_image->joined.data();
+        out_image->compressed_size = total;
+        return true;
+    }
+
+    // single pixels of STRIDE bytes in & out of the low end of a register.
+    //   odd sizes get put together from whole loads, copying them through a
+    //   zeroed local stalls on store forwarding every pixel
+    template <uint32_t STRIDE>
+    __m128i load_pixel(const uint8_t* pixel) {
+        if constexpr (STRIDE == 3) {
+            uint16_t low;
+            memcpy(&low, pixel, sizeof(low));
+            return _mm_cvtsi32_si128((int)(low | (uint32_t)pixel[2] << 16));
+        } else if constexpr (STRIDE == 4) {
+            uint32_t value;
+            memcpy(&value, pixel, sizeof(value));
+            return _mm_cvtsi32_si128((int)value);
+        } else if constexpr (STRIDE == 6) {
+            uint32_t low;
+            uint16_t high;
+            memcpy(&low, pixel, sizeof(low));
+            memcpy(&high, pixel + 4, sizeof(high));
+            return _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)low), _mm_cvtsi32_si128(high));
+        } else {
+            return _mm_loadl_epi64((const __m128i*)pixel);
+        }
+    }
+
+    template <uint32_t STRIDE>
+    void store_pixel(uint8_t* pixel, __m128i value) {
+        if constexpr (STRIDE == 3) {
+            uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(value);
+            uint16_t low = (uint16_t)bytes;
+            memcpy(pixel, &low, sizeof(low));
+            pixel[2] = (uint8_t)(bytes >> 16);
+        } else if constexpr (STRIDE == 4) {
+            uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(value);
+            memcpy(pixel, &bytes, sizeof(bytes));
+        } else if constexpr (STRIDE == 6) {
+            uint32_t low = (uint32_t)_mm_cvtsi128_si32(value);
+            uint16_t high = (uint16_t)_mm_cvtsi128_si32(_mm_srli_si128(value, 4));
+            memcpy(pixel, &low, sizeof(low));
+            memcpy(pixel + 4, &high, sizeof(high));
+        } else {
+            _mm_storel_epi64((__m128i*)pixel, value);
+        }
+    }
+
+    // up doesn't depend on anything in its own row, so 16 bytes at a time
+    //   whatever the pixel size
+    void unfilter_up(const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size) {
+        uint32_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(x, b));
+        }
+        for (; i < size; i++) {
+            out[i] = (uint8_t)(in[i] + prev[i]);
+        }
+    }
+
+    // sub, average & paeth all need the pixel to the left finished first,
+    //   so these go a whole pixel (all its channels) per step. out can be in
+    //   since every pixel's read before it's written
+    template <uint32_t STRIDE>
+    void unfilter_sub(const uint8_t* in, uint8_t* out, uint32_t size) {
+        __m128i a = _mm_setzero_si128();
+        for (uint32_t i = 0; i < size; i += STRIDE) {
+            a = _mm_add_epi8(load_pixel<STRIDE>(in + i), a);
+            store_pixel<STRIDE>(out + i, a);
+        }
+    }
+
+    template <uint32_t STRIDE>
+    void unfilter_avg(const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size) {
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i a = _mm_setzero_si128();
+        for (uint32_t i = 0; i < size; i += STRIDE) {
+            __m128i b = load_pixel<STRIDE>(prev + i);
+            // avg_epu8 rounds up, the filter rounds down
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(load_pixel<STRIDE>(in + i), average);
+            store_pixel<STRIDE>(out + i, a);
+        }
+    }
+
+    __m128i abs_epi16(__m128i value) {
+        return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+    }
+
+    __m128i select(__m128i mask, __m128i if_set, __m128i if_clear) {
+        return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+    }
+
+    // channels widened to 16 bits so a + b - c can't wrap. the row is
+    //   one long dependency chain through a, so that stays 16 bit too &
+    //   only gets packed back down on the way out
+    template <uint32_t STRIDE>
+    void unfilter_paeth(const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low_byte = _mm_set1_epi16(0xff);
+        __m128i a = zero;
+        __m128i c = zero;
+        for (uint32_t i = 0; i < size; i += STRIDE) {
+            __m128i b = _mm_unpacklo_epi8(load_pixel<STRIDE>(prev + i), zero);
+            __m128i x = _mm_unpacklo_epi8(load_pixel<STRIDE>(in + i), zero);
+
+            // p = a + b - c, so p - a = b - c, p - b = a - c & p - c is both
+            __m128i pa_signed = _mm_sub_epi16(b, c);
+            __m128i pb_signed = _mm_sub_epi16(a, c);
+            __m128i pa = abs_epi16(pa_signed);
+            __m128i pb = abs_epi16(pb_signed);
+            __m128i pc = abs_epi16(_mm_add_epi16(pa_signed, pb_signed));
+
+            // ties go to a, then b
+            __m128i not_a = _mm_cmpgt_epi16(pa, _mm_min_epi16(pb, pc));
+            __m128i b_or_c = select(_mm_cmpgt_epi16(pb, pc), c, b);
+            __m128i predicted = select(not_a, b_or_c, a);
+
+            a = _mm_and_si128(_mm_add_epi16(x, predicted), low_byte);
+            store_pixel<STRIDE>(out + i, _mm_packus_epi16(a, a));
+            c = b;
+        }
+    }
+
+    // byte at a time for 1 & 2 byte pixels, where a register per pixel
+    //   costs more than it saves
+    void unfilter_scalar(uint32_t filter, const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size, uint32_t stride) {
+        switch (filter) {
+            case FILTER_SUB:
+                for (uint32_t i = 0; i < size; i++) {
+                    out[i] = (uint8_t)(in[i] + (i >= stride ? out[i - stride] : 0));
+                }
+                break;
+            case FILTER_AVG:
+                for (uint32_t i = 0; i < size; i++) {
+                    uint32_t left = i >= stride ? out[i - stride] : 0;
+                    out[i] = (uint8_t)(in[i] + ((left + prev[i]) >> 1));
+                }
+                break;
+            case FILTER_PAETH:
+                for (uint32_t i = 0; i < size; i++) {
+                    int32_t a = i >= stride ? out[i - stride] : 0;
+                    int32_t b = prev[i];
+                    int32_t c = i >= stride ? prev[i - stride] : 0;
+                    int32_t pa = b - c < 0 ? c - b : b - c;
+                    int32_t pb = a - c < 0 ? c - a : a - c;
+                    int32_t pc = a + b - 2 * c < 0 ? 2 * c - a - b : a + b - 2 * c;
+                    int32_t predicted = pa <= pb && pa <= pc ? a : (pb <= pc ? b : c);
+                    out[i] = (uint8_t)(in[i] + predicted);
+                }
+                break;
+        }
+    }
+
+    template <uint32_t STRIDE>
+    void unfilter_pixels(uint32_t filter, const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size) {
+        switch (filter) {
+            case FILTER_SUB: unfilter_sub<STRIDE>(in, out, size); break;
+            case FILTER_AVG: unfilter_avg<STRIDE>(in, prev, out, size); break;
+            case FILTER_PAETH: unfilter_paeth<STRIDE>(in, prev, out, size); break;
+        }
+    }
+
+    // one row back to its raw bytes. prev is the row above, unfiltered
+    //   (zeros for the first), & out can be the same as in
+    bool unfilter_row(uint32_t filter, const uint8_t* in, const uint8_t* prev, uint8_t* out, uint32_t size, uint32_t stride) {
+        if (filter > FILTER_PAETH) return false;
+        if (filter == FILTER_NONE) {
+            if (out != in) memcpy(out, in, size);
+            return true;
+        }
+        if (filter == FILTER_UP) {
+            unfilter_up(in, prev, out, size);
+            return true;
+        }
+        switch (stride) {
+            case 3: unfilter_pixels<3>(filter, in, prev, out, size); break;
+            case 4: unfilter_pixels<4>(filter, in, prev, out, size); break;
+            case 6: unfilter_pixels<6>(filter, in, prev, out, size); break;
+            case 8: unfilter_pixels<8>(filter, in, prev, out, size); break;
+            default: unfilter_scalar(filter, in, prev, out, size, stride); break;
+        }
+        return true;
+    }
+
+    void store_rgba(uint8_t* out, uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+        uint32_t texel = r | g << 8 | b << 16 | a << 24;
+        memcpy(out, &texel, sizeof(texel));
+    }
+
+    uint32_t read_be16(const uint8_t* bytes) {
+        return (uint32_t)bytes[0] << 8 | bytes[1];
+    }
+
+    // 16 bits to 8, rounded
+    uint32_t narrow16(uint32_t value) {
+        return (value * 255 + 32895) >> 16;
+    }
+
+    // the sample at index x of a row packed at less than a byte each
+    uint32_t packed_sample(const uint8_t* row, uint32_t x, uint32_t bit_depth) {
+        uint32_t bit = x * bit_depth;
+        return (row[bit >> 3] >> (8 - bit_depth - (bit & 7))) & ((1u << bit_depth) - 1);
+    }
+
+    // an unfiltered row to RGBA8. 8 bit RGB reads 4 bytes per pixel, so
+    //   there has to be a byte after the row
+    void expand_row(const PngImage& image, const uint8_t* row, uint32_t width, uint8_t* out) {
+        const PngInfo& info = image.info;
+        uint32_t depth = info.bit_depth;
+        bool key = image.has_key;
+
+        if (info.color_type == PNG_COLOR_PALETTE) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t index = depth == 8 ? row[x] : packed_sample(row, x, depth);
+                memcpy(out + x * 4, &image.palette[index], 4);
+            }
+            return;
+        }
+
+        if (depth == 16) {
+            for (uint32_t x = 0; x < width; x++) {
+                const uint8_t* pixel = row + (uint64_t)x * image.channels * 2;
+                uint32_t r = read_be16(pixel);
+                uint32_t g = r;
+                uint32_t b = r;
+                uint32_t a = 0xffff;
+                if (info.color_type == PNG_COLOR_RGB || info.color_type == PNG_COLOR_RGBA) {
+                    g = read_be16(pixel + 2);
+                    b = read_be16(pixel + 4);
+                }
+                if (info.color_type == PNG_COLOR_GRAY_ALPHA) a = read_be16(pixel + 2);
+                if (info.color_type == PNG_COLOR_RGBA) a = read_be16(pixel + 6);
+                if (key && r == image.key[0] && (info.color_type == PNG_COLOR_GRAY || (g == image.key[1] && b == image.key[2]))) {
+                    a = 0;
+                }
+                store_rgba(out + x * 4, narrow16(r), narrow16(g), narrow16(b), narrow16(a));
+            }
+            return;
+        }
+
+        switch (info.color_type) {
+            case PNG_COLOR_GRAY:
+                if (depth < 8) {
+                    uint32_t scale = 255 / ((1u << depth) - 1);
+                    for (uint32_t x = 0; x < width; x++) {
+                        uint32_t value = packed_sample(row, x, depth);
+                        uint32_t gray = value * scale;
+                        store_rgba(out + x * 4, gray, gray, gray, key && value == image.key[0] ? 0 : 255);
+                    }
+                    break;
+                }
+                for (uint32_t x = 0; x < width; x++) {
+                    uint32_t gray = row[x];
+                    store_rgba(out + x * 4, gray, gray, gray, key && gray == image.key[0] ? 0 : 255);
+                }
+                break;
+            case PNG_COLOR_GRAY_ALPHA:
+                for (uint32_t x = 0; x < width; x++) {
+                    uint32_t gray = row[x * 2];
+                    store_rgba(out + x * 4, gray, gray, gray, row[x * 2 + 1]);
+                }
+                break;
+            case PNG_COLOR_RGB:
+                if (key) {
+                    for (uint32_t x = 0; x < width; x++) {
+                        const uint8_t* pixel = row + x * 3;
+                        bool match = pixel[0] == image.key[0] && pixel[1] == image.key[1] && pixel[2] == image.key[2];
+                        store_rgba(out + x * 4, pixel[0], pixel[1], pixel[2], match ? 0 : 255);
+                    }
+                    break;
+                }
+                for (uint32_t x = 0; x < width; x++) {
+                    uint32_t texel;
+                    memcpy(&texel, row + x * 3, sizeof(texel));
+                    texel |= 0xff000000;
+                    memcpy(out + x * 4, &texel, sizeof(texel));
+                }
+                break;
+            case PNG_COLOR_RGBA:
+                if (out != row) memcpy(out, row, (size_t)width * 4);
+                break;
+        }
+    }
+
+    bool decode_image(PngImage& image, uint8_t* dest, uint32_t row_pitch, PngDecodeStats* stats) {
+        const PngInfo& info = image.info;
+        uint32_t stride = image.filter_stride;
+
+        // every pass's rows, each with its filter byte in front
+        uint32_t pass_count = info.interlaced ? 7 : 1;
+        uint32_t pass_width[7];
+        uint32_t pass_height[7];
+        uint64_t filtered_size = 0;
+        uint64_t widest_row = 0;
+        for (uint32_t p = 0; p < pass_count; p++) {
+            pass_width[p] = info.interlaced ? (info.width - ADAM7_X[p] + ADAM7_DX[p] - 1) / ADAM7_DX[p] : info.width;
+            pass_height[p] = info.interlaced ? (info.height - ADAM7_Y[p] + ADAM7_DY[p] - 1) / ADAM7_DY[p] : info.height;
+            if (info.width <= ADAM7_X[p] || info.height <= ADAM7_Y[p]) {
+                pass_width[p] = pass_height[p] = 0;
+            }
+            if (pass_width[p] == 0) continue;
+            uint64_t bytes = row_bytes(image, pass_width[p]);
+            widest_row = bytes > widest_row ? bytes : widest_row;
+            filtered_size += (bytes + 1) * pass_height[p];
+        }
+        if (widest_row > 0xffffffffull - 16) return false;
+
+        // 16 spare bytes so expand_row can read past the last row
+        auto inflate_start = std::chrono::high_resolution_clock::now();
+        std::unique_ptr<uint8_t[]> filtered(new uint8_t[filtered_size + 16]);
+        if (!zlib_inflate(image.compressed, image.compressed_size, filtered.get(), filtered_size)) return false;
+        if (stats) stats->inflate_seconds = seconds_since(inflate_start);
+
+        auto unfilter_start = std::chrono::high_resolution_clock::now();
+        std::vector<uint8_t> zeros(widest_row, 0);
+
+        // 8 bit RGBA is already RGBA8, so unfilter straight into dest &
+        //   leave it there. everything else gets unfiltered in place &
+        //   expanded after
+        if (!info.interlaced && info.color_type == PNG_COLOR_RGBA && info.bit_depth == 8) {
+            uint32_t size = (uint32_t)row_bytes(image, info.width);
+            const uint8_t* prev = zeros.data();
+            for (uint32_t y = 0; y < info.height; y++) {
+                const uint8_t* in = filtered.get() + (uint64_t)y * (size + 1);
+                uint8_t* out = dest + (uint64_t)y * row_pitch;
+                if (!unfilter_row(in[0], in + 1, prev, out, size, stride)) return false;
+                prev = out;
+            }
+            if (stats) stats->unfilter_seconds = seconds_since(unfilter_start);
+            return true;
+        }
+
+        // interlaced passes expand here first, then get spread out
+        std::vector<uint8_t> pass_texels(info.interlaced ? (size_t)info.width * 4 : 0);
+        uint8_t* cursor = filtered.get();
+        for (uint32_t p = 0; p < pass_count; p++) {
+            if (pass_width[p] == 0) continue;
+            uint32_t size = (uint32_t)row_bytes(image, pass_width[p]);
+            const uint8_t* prev = zeros.data();
+            for (uint32_t y = 0; y < pass_height[p]; y++) {
+                uint8_t* row = cursor + 1;
+                if (!unfilter_row(cursor[0], row, prev, row, size, stride)) return false;
+                prev = row;
+                cursor += (uint64_t)size + 1;
+
+                if (!info.interlaced) {
+                    expand_row(image, row, info.width, dest + (uint64_t)y * row_pitch);
+                    continue;
+                }
+                expand_row(image, row, pass_width[p], pass_texels.data());
+                uint8_t* out = dest + (uint64_t)(ADAM7_Y[p] + y * ADAM7_DY[p]) * row_pitch;
+                for (uint32_t x = 0; x < pass_width[p]; x++) {
+                    memcpy(out + (uint64_t)(ADAM7_X[p] + x * ADAM7_DX[p]) * 4, pass_texels.data() + x * 4, 4);
+                }
+            }
+        }
+        if (stats) stats->unfilter_seconds = seconds_since(unfilter_start);
+        return true;
+    }
+}
+
+bool png_info_read(const uint8_t* data, size_t size, PngInfo* out_info) {
+    return parse_header(data, size, out_info);
+}
+
+bool png_decode(const uint8_t* data, size_t size, uint8_t* dest, uint32_t row_pitch, PngDecodeStats* out_stats) {
+    PngImage image;
+    if (out_stats) *out_stats = {};
+    return parse(data, size, &image) && decode_image(image, dest, row_pitch, out_stats);
+}
+
+bool PngImageDecoder::read_info(const uint8_t* data, size_t size, ImageInfo* out_info) {
+    PngInfo info;
+    if (!png_info_read(data, size, &info)) return false;
+    out_info->width = info.width;
+    out_info->height = info.height;
+    return true;
+}
+
+bool PngImageDecoder::decode(const uint8_t* data, size_t size, uint8_t* dest, uint32_t row_pitch) {
+    return png_decode(data, size, dest, row_pitch);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "TextureLoader.h"
+
+// IHDR color types
+#define PNG_COLOR_GRAY 0
+#define PNG_COLOR_RGB 2
+#define PNG_COLOR_PALETTE 3
+#define PNG_COLOR_GRAY_ALPHA 4
+#define PNG_COLOR_RGBA 6
+
+struct PngInfo {
+    uint32_t width;
+    uint32_t height;
+    // 1, 2, 4, 8 or 16, per sample (per index for palettes)
+    uint32_t bit_depth;
+    // PNG_COLOR_*
+    uint32_t color_type;
+    bool interlaced;
+};
+
+struct PngDecodeStats {
+    double inflate_seconds;
+    // unfiltering & expanding to RGBA8
+    double unfilter_seconds;
+};
+
+// signature & IHDR only, fails on anything a PNG isn't allowed to be
+bool png_info_read(const uint8_t* data, size_t size, PngInfo* out_info);
+
+// every kind of PNG there is (gray, gray + alpha, RGB, RGBA & paletted at
+//   all their bit depths, Adam7 too) into RGBA8, rows row_pitch bytes apart.
+//   16 bit samples get rounded to 8, gray gets copied across RGB, palettes &
+//   tRNS get applied. chunk CRCs & the zlib checksum are checked. it only
+//   needs its own scratch memory so any number of threads can call it
+bool png_decode(const uint8_t* data, size_t size, uint8_t* dest, uint32_t row_pitch, PngDecodeStats* out_stats = nullptr);
+
+// png_decode for the texture loader
+class PngImageDecoder : public ImageDecoder {
+   public:
+    bool read_info(const uint8_t* data, size_t size, ImageInfo* out_info) override;
+    bool decode(const uint8_t* data, size_t size, uint8_t* dest, uint32_t row_pitch) override;
+};
@@ -0,0 +1,39 @@
+#include "QueueSync.h"
+
+void queue_sync_create(QueueSync* sync) {
+    sync->required_value = 0;
+    sync->waited_value = 0;
+    sync->signaled_value = 0;
+    sync->stats = {};
+}
+
+void queue_sync_require(QueueSync* sync, uint64_t value) {
+    sync->required_value = value > sync->required_value ? value : sync->required_value;
+}
+
+void queue_sync_signaled(QueueSync* sync, uint64_t value) {
+    sync->signaled_value = value > sync->signaled_value ? value : sync->signaled_value;
+}
+
+bool queue_sync_submit(QueueSync* sync, UploadFence* fence, QueueWaiter* queue) {
+    sync->stats.submit_count++;
+    uint64_t required = sync->required_value;
+    sync->required_value = 0;
+    if (required <= sync->waited_value) return true;
+
+    bool signaled = required <= sync->signaled_value;
+    if (!signaled) {
+        sync->stats.unsignaled_count++;
+        required = sync->signaled_value;
+    }
+    sync->stats.dependent_submit_count++;
+
+    // anything the CPU's seen finish is already visible to work submitted after.
+    //   falling back to the signaled value can land on one that's been waited on
+    if (required > sync->waited_value && fence->get_completed_value() < required) {
+        queue->wait(required);
+        sync->stats.wait_count++;
+    }
+    sync->waited_value = required > sync->waited_value ? required : sync->waited_value;
+    return signaled;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "UploadRing.h"
+
+// the waiting queue's side of a cross queue wait, see MockQueueWaiter
+class QueueWaiter {
+   public:
+    virtual ~QueueWaiter() = default;
+    // nothing submitted to the queue after this runs until the other
+    //   queue's fence hits value. the CPU doesn't block
+    virtual void wait(uint64_t value) = 0;
+};
+
+// writes the waits down instead of making them
+class MockQueueWaiter : public QueueWaiter {
+   public:
+    std::vector<uint64_t> waits;
+
+    void wait(uint64_t value) override { waits.push_back(value); }
+};
+
+struct QueueSyncStats {
+    uint64_t submit_count;
+    // submits that read something from the other queue no earlier one waited on
+    uint64_t dependent_submit_count;
+    // of those, the ones the GPU had to wait for, the rest were done already
+    uint64_t wait_count;
+    // submits that needed a value the other queue hadn't even been sent
+    uint64_t unsignaled_count;
+};
+
+// what one queue's next submit needs from another queue's fence, usually
+//   the direct queue reading what the copy queue uploaded. it only ever
+//   waits on the highest value the submit actually reads, & not at all if
+//   the fence is already past it or an earlier submit waited on it
+struct QueueSync {
+    // highest value the work being recorded reads
+    uint64_t required_value;
+    // the queue's already waited on everything up to here
+    uint64_t waited_value;
+    // highest value the other queue's been told to signal, waiting on
+    //   anything past it would hang the queue
+    uint64_t signaled_value;
+    QueueSyncStats stats;
+};
+
+void queue_sync_create(QueueSync* sync);
+
+// the work being recorded reads something that's there once the fence hits value
+void queue_sync_require(QueueSync* sync, uint64_t value);
+
+// the other queue got sent a signal of value
+void queue_sync_signaled(QueueSync* sync, uint64_t value);
+
+// right before the submit, waits on the queue if it has to. false when
+//   the submit reads something that wasn't signaled yet, it waits on what
+//   was instead so the queue can't hang (flush the other queue first)
+bool queue_sync_submit(QueueSync* sync, UploadFence* fence, QueueWaiter* queue);
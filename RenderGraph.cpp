@@ -0,0 +1,271 @@
+#include "RenderGraph.h"
+
+static bool is_read_only(uint32_t state) {
+    return state != 0 && (state & ~RG_STATE_READ_ONLY_MASK) == 0;
+}
+
+void render_graph_reset(RenderGraph* graph) {
+    graph->resources.clear();
+    graph->passes.clear();
+    graph->barriers.clear();
+    graph->final_first_barrier = 0;
+    graph->final_barrier_count = 0;
+    graph->stats = {};
+}
+
+uint32_t render_graph_import(
+    RenderGraph* graph,
+    const char* name,
+    void* native,
+    uint32_t initial_state,
+    uint32_t final_state
+) {
+    RenderGraphResource resource = {};
+    resource.name = name;
+    resource.transient = false;
+    resource.initial_state = initial_state;
+    resource.final_state = final_state;
+    resource.native = native;
+    graph->resources.push_back(resource);
+    return (uint32_t)graph->resources.size() - 1;
+}
+
+uint32_t render_graph_create_texture(RenderGraph* graph, const char* name, const RenderGraphTextureDesc& desc) {
+    RenderGraphResource resource = {};
+    resource.name = name;
+    resource.transient = true;
+    resource.desc = desc;
+    resource.initial_state = desc.initial_state;
+    resource.final_state = desc.initial_state;
+    resource.native = nullptr;
+    graph->resources.push_back(resource);
+    return (uint32_t)graph->resources.size() - 1;
+}
+
+uint32_t render_graph_add_pass(RenderGraph* graph, const char* name, std::function<void()> execute, bool side_effect) {
+    graph->passes.emplace_back();
+    RenderGraphPass& pass = graph->passes.back();
+    pass.name = name;
+    pass.side_effect = side_effect;
+    pass.execute = std::move(execute);
+    return (uint32_t)graph->passes.size() - 1;
+}
+
+void render_graph_use(RenderGraph* graph, uint32_t pass, uint32_t resource, uint32_t state, uint32_t flags) {
+    // one use per resource per pass, a second one folds into the first.
+    //   reads share a state, otherwise the write's state wins
+    for (RenderGraphUse& use : graph->passes[pass].uses) {
+        if (use.resource != resource) continue;
+
+        if (is_read_only(use.state) && is_read_only(state)) {
+            use.state |= state;
+        } else if (flags & RG_USE_WRITE) {
+            use.state = state;
+        }
+        use.flags |= flags;
+        return;
+    }
+    graph->passes[pass].uses.push_back({ resource, state, flags });
+}
+
+void render_graph_compile(RenderGraph* graph) {
+    uint32_t resource_count = (uint32_t)graph->resources.size();
+    uint32_t pass_count = (uint32_t)graph->passes.size();
+    graph->barriers.clear();
+    graph->stats = {};
+    graph->stats.pass_count = pass_count;
+
+    // culling, back to front. imported resources are always wanted, a
+    //   transient is wanted if a live pass further on reads it. a pass
+    //   lives if it writes something wanted, then what it reads is wanted
+    //   too, & what it overwrites without reading isn't anymore
+    std::vector<uint32_t>& wanted = graph->scratch_states;
+    wanted.assign(resource_count, 0);
+    for (uint32_t r = 0; r < resource_count; r++) {
+        wanted[r] = graph->resources[r].transient ? 0 : 1;
+    }
+    for (uint32_t p = pass_count; p-- > 0;) {
+        RenderGraphPass& pass = graph->passes[p];
+        pass.live = pass.side_effect;
+        for (const RenderGraphUse& use : pass.uses) {
+            if ((use.flags & RG_USE_WRITE) && wanted[use.resource]) {
+                pass.live = true;
+            }
+        }
+        if (!pass.live) {
+            graph->stats.culled_pass_count++;
+            continue;
+        }
+
+        for (const RenderGraphUse& use : pass.uses) {
+            if (use.flags == RG_USE_WRITE && graph->resources[use.resource].transient) {
+                wanted[use.resource] = 0;
+            }
+        }
+        for (const RenderGraphUse& use : pass.uses) {
+            if (use.flags & RG_USE_READ) {
+                wanted[use.resource] = 1;
+            }
+        }
+    }
+
+    // lifetimes & every live use in order, chained per resource so a read
+    //   can look ahead at the reads right after it
+    std::vector<RenderGraphUse>& uses = graph->scratch_uses;
+    std::vector<uint32_t>& next_use = graph->scratch_next_use;
+    std::vector<uint32_t>& last_use = graph->scratch_last_use;
+    uses.clear();
+    next_use.clear();
+    last_use.assign(resource_count, RENDER_GRAPH_NONE);
+    for (RenderGraphResource& resource : graph->resources) {
+        resource.first_pass = RENDER_GRAPH_NONE;
+        resource.last_pass = RENDER_GRAPH_NONE;
+    }
+    for (uint32_t p = 0; p < pass_count; p++) {
+        if (!graph->passes[p].live) continue;
+
+        for (const RenderGraphUse& use : graph->passes[p].uses) {
+            RenderGraphResource& resource = graph->resources[use.resource];
+            if (resource.first_pass == RENDER_GRAPH_NONE) {
+                resource.first_pass = p;
+            }
+            resource.last_pass = p;
+
+            uint32_t index = (uint32_t)uses.size();
+            uses.push_back(use);
+            next_use.push_back(RENDER_GRAPH_NONE);
+            if (last_use[use.resource] != RENDER_GRAPH_NONE) {
+                next_use[last_use[use.resource]] = index;
+            }
+            last_use[use.resource] = index;
+        }
+    }
+
+    // transitions. a read-only state that's already covered needs nothing,
+    //   otherwise a read goes straight to every read state coming up before
+    //   the next write so the reads after it need nothing either
+    std::vector<uint32_t>& states = graph->scratch_states;
+    for (uint32_t r = 0; r < resource_count; r++) {
+        states[r] = graph->resources[r].initial_state;
+    }
+    uint32_t use_index = 0;
+    uint32_t previous_pass = RENDER_GRAPH_NONE;
+    for (uint32_t p = 0; p < pass_count; p++) {
+        RenderGraphPass& pass = graph->passes[p];
+        pass.first_barrier = (uint32_t)graph->barriers.size();
+        pass.barrier_count = 0;
+        pass.return_barrier_count = 0;
+        if (!pass.live) continue;
+
+        // transients whose last pass just ran go back to their initial state
+        //   first, before anything else gets their memory
+        if (previous_pass != RENDER_GRAPH_NONE) {
+            for (const RenderGraphUse& use : graph->passes[previous_pass].uses) {
+                RenderGraphResource& resource = graph->resources[use.resource];
+                if (resource.transient && resource.last_pass == previous_pass && states[use.resource] != resource.final_state) {
+                    graph->barriers.push_back({ use.resource, states[use.resource], resource.final_state });
+                    states[use.resource] = resource.final_state;
+                    pass.return_barrier_count++;
+                }
+            }
+        }
+
+        for (uint32_t u = 0; u < (uint32_t)pass.uses.size(); u++, use_index++) {
+            const RenderGraphUse& use = pass.uses[u];
+            uint32_t current = states[use.resource];
+            if (current == use.state) continue;
+            if (is_read_only(current) && is_read_only(use.state) && (use.state & ~current) == 0) continue;
+
+            uint32_t target = use.state;
+            if (is_read_only(target)) {
+                for (uint32_t next = next_use[use_index]; next != RENDER_GRAPH_NONE && is_read_only(uses[next].state); next = next_use[next]) {
+                    target |= uses[next].state;
+                }
+            }
+            graph->barriers.push_back({ use.resource, current, target });
+            states[use.resource] = target;
+        }
+
+        pass.barrier_count = (uint32_t)graph->barriers.size() - pass.first_barrier;
+        graph->stats.barrier_batch_count += pass.barrier_count > 0 ? 1 : 0;
+        previous_pass = p;
+    }
+
+    // everything goes where it has to be once the graph's done
+    graph->final_first_barrier = (uint32_t)graph->barriers.size();
+    for (uint32_t r = 0; r < resource_count; r++) {
+        const RenderGraphResource& resource = graph->resources[r];
+        if (resource.first_pass != RENDER_GRAPH_NONE && states[r] != resource.final_state) {
+            graph->barriers.push_back({ r, states[r], resource.final_state });
+        }
+    }
+    graph->final_barrier_count = (uint32_t)graph->barriers.size() - graph->final_first_barrier;
+    graph->stats.barrier_batch_count += graph->final_barrier_count > 0 ? 1 : 0;
+    graph->stats.barrier_count = (uint32_t)graph->barriers.size();
+}
+
+// the native stays around, the return transitions still need it
+static void release_finished(RenderGraph* graph, uint32_t pass, RenderGraphDevice* device) {
+    for (const RenderGraphUse& use : graph->passes[pass].uses) {
+        const RenderGraphResource& resource = graph->resources[use.resource];
+        if (resource.transient && resource.last_pass == pass && resource.first_pass != RENDER_GRAPH_NONE) {
+            device->release_transient(resource.native);
+        }
+    }
+}
+
+static void send_batch(RenderGraph* graph, RenderGraphDevice* device) {
+    if (graph->scratch_batch.empty()) return;
+
+    graph->scratch_natives.clear();
+    for (const RenderGraphBarrier& barrier : graph->scratch_batch) {
+        graph->scratch_natives.push_back(graph->resources[barrier.resource].native);
+    }
+    device->resource_barriers(graph->scratch_batch.data(), graph->scratch_natives.data(), (uint32_t)graph->scratch_batch.size());
+}
+
+void render_graph_execute(RenderGraph* graph, RenderGraphDevice* device) {
+    std::vector<RenderGraphBarrier>& batch = graph->scratch_batch;
+    uint32_t previous_pass = RENDER_GRAPH_NONE;
+
+    for (uint32_t p = 0; p < (uint32_t)graph->passes.size(); p++) {
+        RenderGraphPass& pass = graph->passes[p];
+        if (!pass.live) continue;
+
+        // memory of whatever died last pass is up for grabs now. its return
+        //   transitions go first in the batch, before aliasing barriers hand
+        //   the memory to something else
+        if (previous_pass != RENDER_GRAPH_NONE) {
+            release_finished(graph, previous_pass, device);
+        }
+        const RenderGraphBarrier* barriers = graph->barriers.data() + pass.first_barrier;
+        batch.assign(barriers, barriers + pass.return_barrier_count);
+
+        for (const RenderGraphUse& use : pass.uses) {
+            RenderGraphResource& resource = graph->resources[use.resource];
+            if (!resource.transient || resource.first_pass != p) continue;
+
+            bool aliased = false;
+            resource.native = device->acquire_transient(resource.desc, &aliased);
+            if (aliased) {
+                batch.push_back({ use.resource, RENDER_GRAPH_NONE, RENDER_GRAPH_NONE });
+            }
+        }
+        batch.insert(batch.end(), barriers + pass.return_barrier_count, barriers + pass.barrier_count);
+        send_batch(graph, device);
+
+        pass.execute();
+        previous_pass = p;
+    }
+
+    if (previous_pass != RENDER_GRAPH_NONE) {
+        release_finished(graph, previous_pass, device);
+    }
+    const RenderGraphBarrier* barriers = graph->barriers.data() + graph->final_first_barrier;
+    batch.assign(barriers, barriers + graph->final_barrier_count);
+    send_batch(graph, device);
+}
+
+void* render_graph_native(const RenderGraph* graph, uint32_t resource) {
+    return graph->resources[resource].native;
+}
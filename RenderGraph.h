@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+constexpr uint32_t RENDER_GRAPH_NONE = UINT32_MAX;
+
+// resource states, same values as D3D12_RESOURCE_STATES so a backend can
+//   pass them straight through. the read-only ones can be OR'd together
+constexpr uint32_t RG_STATE_COMMON = 0x0;
+constexpr uint32_t RG_STATE_PRESENT = 0x0;
+constexpr uint32_t RG_STATE_RENDER_TARGET = 0x4;
+constexpr uint32_t RG_STATE_UNORDERED_ACCESS = 0x8;
+constexpr uint32_t RG_STATE_DEPTH_WRITE = 0x10;
+constexpr uint32_t RG_STATE_DEPTH_READ = 0x20;
+constexpr uint32_t RG_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40;
+constexpr uint32_t RG_STATE_PIXEL_SHADER_RESOURCE = 0x80;
+constexpr uint32_t RG_STATE_COPY_DEST = 0x400;
+constexpr uint32_t RG_STATE_COPY_SOURCE = 0x800;
+constexpr uint32_t RG_STATE_READ_ONLY_MASK =
+    RG_STATE_DEPTH_READ | RG_STATE_NON_PIXEL_SHADER_RESOURCE | RG_STATE_PIXEL_SHADER_RESOURCE | RG_STATE_COPY_SOURCE;
+
+// how a pass touches a resource. a write without RG_USE_READ throws the
+//   old contents away (a clear, a full overwrite), so nothing before it
+//   has to run for this pass's sake
+constexpr uint32_t RG_USE_READ = 0x1;
+constexpr uint32_t RG_USE_WRITE = 0x2;
+
+// what a transient texture is, the backend makes it. format & flags are
+//   whatever the backend uses (DXGI_FORMAT & D3D12_RESOURCE_FLAGS)
+struct RenderGraphTextureDesc {
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;
+    float clear_color[4];
+    // the state it's in when acquired, the graph puts it back after its last use
+    uint32_t initial_state;
+};
+
+struct RenderGraphResource {
+    const char* name;
+    bool transient;
+    RenderGraphTextureDesc desc;
+    // imported ones end up in final_state once the graph's done
+    uint32_t initial_state;
+    uint32_t final_state;
+    // whatever the backend uses (ID3D12Resource*), transients get it on acquire
+    void* native;
+
+    // filled by compile: the live passes that first & last use it
+    uint32_t first_pass;
+    uint32_t last_pass;
+};
+
+struct RenderGraphUse {
+    uint32_t resource;
+    uint32_t state;
+    uint32_t flags;
+};
+
+struct RenderGraphBarrier {
+    uint32_t resource;
+    uint32_t before;
+    uint32_t after;
+};
+
+struct RenderGraphPass {
+    const char* name;
+    std::vector<RenderGraphUse> uses;
+    // runs no matter what reads its output (it presents, reads back, ...)
+    bool side_effect;
+    std::function<void()> execute;
+
+    // filled by compile
+    bool live;
+    // this pass's barriers in RenderGraph::barriers, all go out in one call.
+    //   the first return_barrier_count put transients that died after the
+    //   previous pass back in their initial state
+    uint32_t first_barrier;
+    uint32_t barrier_count;
+    uint32_t return_barrier_count;
+};
+
+struct RenderGraphStats {
+    uint32_t pass_count;
+    uint32_t culled_pass_count;
+    uint32_t barrier_count;
+    // ResourceBarrier calls, at most one per pass plus one at the end
+    uint32_t barrier_batch_count;
+};
+
+// passes & resources for one frame, rebuilt every frame. passes declare
+//   what they read & write in what state, compile culls passes nothing
+//   needs, works out each transient's lifetime & the fewest transitions
+//   between passes, execute runs it all through a backend
+struct RenderGraph {
+    std::vector<RenderGraphResource> resources;
+    std::vector<RenderGraphPass> passes;
+    std::vector<RenderGraphBarrier> barriers;
+    // transitions back to final/initial states after the last pass
+    uint32_t final_first_barrier;
+    uint32_t final_barrier_count;
+    RenderGraphStats stats;
+
+    // compile & execute scratch, kept so a frame doesn't allocate
+    std::vector<uint32_t> scratch_states;
+    std::vector<uint32_t> scratch_next_use;
+    std::vector<uint32_t> scratch_last_use;
+    std::vector<RenderGraphUse> scratch_uses;
+    std::vector<RenderGraphBarrier> scratch_batch;
+    std::vector<void*> scratch_natives;
+};
+
+// what execute needs from the GPU side, see MockRenderGraphDevice for one
+//   that just writes everything down
+class RenderGraphDevice {
+   public:
+    virtual ~RenderGraphDevice() = default;
+    // right before the first pass that uses it, returns the native resource.
+    //   out_aliased says its memory was something else's earlier in the frame
+    virtual void* acquire_transient(const RenderGraphTextureDesc& desc, bool* out_aliased) = 0;
+    // after the last pass that uses it, its memory's free for later acquires
+    virtual void release_transient(void* native) = 0;
+    // one batch of transitions, aliasing ones have before == after ==
+    //   RENDER_GRAPH_NONE. natives line up with barriers
+    virtual void resource_barriers(const RenderGraphBarrier* barriers, void* const* natives, uint32_t count) = 0;
+};
+
+// a device that writes down what it's told, for running graphs on the CPU
+class MockRenderGraphDevice : public RenderGraphDevice {
+   public:
+    struct Batch {
+        std::vector<RenderGraphBarrier> barriers;
+        std::vector<void*> natives;
+    };
+    std::vector<Batch> batches;
+    uint32_t acquire_count = 0;
+    uint32_t release_count = 0;
+    // acquires hand out fake pointers from here
+    uintptr_t next_native = 0x1000;
+
+    void* acquire_transient(const RenderGraphTextureDesc&, bool* out_aliased) override {
+        acquire_count++;
+        *out_aliased = false;
+        next_native += 0x10;
+        return reinterpret_cast<void*>(next_native);
+    }
+    void release_transient(void*) override { release_count++; }
+    void resource_barriers(const RenderGraphBarrier* barriers, void* const* natives, uint32_t count) override {
+        batches.push_back({ { barriers, barriers + count }, { natives, natives + count } });
+    }
+};
+
+// clears everything but keeps the allocations around for the next frame
+void render_graph_reset(RenderGraph* graph);
+
+// something that lives outside the graph (a back buffer, the depth
+//   buffer), it's in initial_state now & has to be in final_state after
+uint32_t render_graph_import(
+    RenderGraph* graph,
+    const char* name,
+    void* native,
+    uint32_t initial_state,
+    uint32_t final_state
+);
+
+// only exists from the first pass that uses it to the last
+uint32_t render_graph_create_texture(RenderGraph* graph, const char* name, const RenderGraphTextureDesc& desc);
+
+uint32_t render_graph_add_pass(RenderGraph* graph, const char* name, std::function<void()> execute, bool side_effect = false);
+
+// pass uses resource in state, RG_USE_* flags. using it again in the
+//   same pass merges into the first use
+void render_graph_use(RenderGraph* graph, uint32_t pass, uint32_t resource, uint32_t state, uint32_t flags);
+
+void render_graph_compile(RenderGraph* graph);
+
+// acquires transients, sends each pass's barriers as one batch, runs the
+//   pass, releases transients after their last use
+void render_graph_execute(RenderGraph* graph, RenderGraphDevice* device);
+
+// native resource, for passes that need to bind it. transients only have
+//   one while the graph's executing
+void* render_graph_native(const RenderGraph* graph, uint32_t resource);
@@ -1,12 +1,17 @@
 #include "IOStructs.hlsli"
+#include "VertexDecode.hlsli"
 
 cbuffer SkyMatrixBuffer : register(b0) {
 	float4x4 view;
 	float4x4 projection;
+	float3 position_offset;
+	float3 position_scale;
 }
 
 SkyPSIn main(VSInput input) {
 	SkyPSIn output;
+	// the sky only needs positions, its UVs can decode to whatever
+	DecodedVertex vertex = decode_vertex(input, position_offset, position_scale, float2(0.0f, 0.0f), float2(0.0f, 0.0f));
 
 	matrix viewNoTranslate = view;
 	viewNoTranslate._14 = 0;
@@ -15,9 +20,9 @@ SkyPSIn main(VSInput input) {
 
 	matrix viewProj = mul(projection, viewNoTranslate);
 
-	output.position = mul(viewProj, float4(input.position, 1.0f));
+	output.position = mul(viewProj, float4(vertex.position, 1.0f));
 	output.position.z = output.position.w;
-	output.sample_dir = input.position;
+	output.sample_dir = vertex.position;
 
 	return output;
 }
@@ -0,0 +1,180 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "FrameAllocator.h"
+#include "TestCheck.h"
+
+// what CBHeapFillNext & Draw do per draw, before & after per draw constants
+//   became root CBVs. the D3D calls are stand-ins: a CBV is a 32 byte
+//   descriptor store into the heap & root arguments get appended to a
+//   command stream. the driver's own CreateConstantBufferView cost comes on
+//   top of the descriptor table numbers & can't be measured here
+
+constexpr uint64_t CB_FRAME_BUDGET = 256 * 1024;
+constexpr uint64_t CB_ALIGNMENT = 256;
+// the CBV ring the descriptor heap used to start with
+constexpr uint32_t MAX_CBUFFERS = 1000;
+constexpr uint64_t DESCRIPTOR_SIZE = 32;
+// where the fake upload heap & descriptor heap live on the "GPU"
+constexpr uint64_t CB_GPU_BASE = 0x100000000ull;
+constexpr uint64_t HEAP_GPU_BASE = 0x200000000ull;
+
+// TransformBuffer & MaterialBuffer sized
+struct TransformData { float values[72]; };
+struct MaterialData { float values[24]; };
+
+// D3D12_CONSTANT_BUFFER_VIEW_DESC as it lands in the heap
+struct CBVDescriptor {
+    uint64_t buffer_location;
+    uint32_t size_in_bytes;
+    uint8_t padding[DESCRIPTOR_SIZE - 12];
+};
+
+// SetGraphicsRootDescriptorTable / SetGraphicsRootConstantBufferView
+struct RootArgument {
+    uint32_t parameter;
+    uint64_t value;
+};
+
+struct CBufferBackend {
+    FrameAllocator allocator;
+    // CPU side of each page, grows along with allocator.pages
+    std::vector<std::vector<uint8_t>> pages;
+    std::vector<CBVDescriptor> descriptors;
+    uint32_t descriptor_index;
+    std::vector<RootArgument> command_stream;
+};
+
+static void backend_create(CBufferBackend* backend) {
+    frame_allocator_create(&backend->allocator, CB_FRAME_BUDGET, CB_ALIGNMENT, 2);
+    backend->descriptors.resize(MAX_CBUFFERS);
+    backend->descriptor_index = 0;
+    backend->command_stream.reserve(16 * 1024);
+}
+
+static uint64_t page_gpu_address(uint32_t page) {
+    return CB_GPU_BASE + (uint64_t)page * 0x10000000ull;
+}
+
+// the copy both paths share
+static uint64_t fill(CBufferBackend* backend, const void* data, size_t size) {
+    FrameAllocation allocation = frame_allocator_allocate(&backend->allocator, size);
+    if (allocation.page >= backend->pages.size()) backend->pages.resize(allocation.page + 1);
+    std::vector<uint8_t>& page = backend->pages[allocation.page];
+    if (page.size() < backend->allocator.pages[allocation.page].size) page.resize(backend->allocator.pages[allocation.page].size);
+    memcpy(page.data() + allocation.offset, data, size);
+    return page_gpu_address(allocation.page) + allocation.offset;
+}
+
+// before: a CBV per cbuffer in the ring, bound through a one entry table
+static void bind_table(CBufferBackend* backend, uint32_t parameter, const void* data, size_t size) {
+    uint64_t address = fill(backend, data, size);
+    CBVDescriptor& descriptor = backend->descriptors[backend->descriptor_index];
+    descriptor.buffer_location = address;
+    descriptor.size_in_bytes = (uint32_t)((size + 255) / 256 * 256);
+    uint64_t handle = HEAP_GPU_BASE + backend->descriptor_index * DESCRIPTOR_SIZE;
+    backend->descriptor_index = (backend->descriptor_index + 1) % MAX_CBUFFERS;
+    backend->command_stream.push_back({ parameter, handle });
+}
+
+// after: the address goes straight into the root argument
+static void bind_root(CBufferBackend* backend, uint32_t parameter, const void* data, size_t size) {
+    uint64_t address = fill(backend, data, size);
+    backend->command_stream.push_back({ parameter, address });
+}
+
+// the buffer address a recorded argument ends up reading from
+static uint64_t resolve(const CBufferBackend& backend, const RootArgument& argument) {
+    if (argument.value < HEAP_GPU_BASE) return argument.value;
+    return backend.descriptors[(argument.value - HEAP_GPU_BASE) / DESCRIPTOR_SIZE].buffer_location;
+}
+
+typedef void (*BindFunction)(CBufferBackend*, uint32_t, const void*, size_t);
+
+// Draw's loop: a transform & a material per draw, one frame's arguments
+//   recorded & then thrown away. returns seconds
+static double run_frames(CBufferBackend* backend, BindFunction bind, uint32_t frame_count, uint32_t draw_count, uint64_t* sink) {
+    TransformData transform = {};
+    MaterialData material = {};
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t frame = 1; frame <= frame_count; frame++) {
+        frame_allocator_begin_frame(&backend->allocator, frame, frame > 2 ? frame - 2 : 0);
+        backend->command_stream.clear();
+        for (uint32_t d = 0; d < draw_count; d++) {
+            transform.values[0] = (float)d;
+            material.values[0] = (float)frame;
+            bind(backend, 0, &transform, sizeof(transform));
+            bind(backend, 2, &material, sizeof(material));
+        }
+        *sink += backend->command_stream.back().value;
+        frame_allocator_end_frame(&backend->allocator);
+    }
+    return test_seconds_since(start);
+}
+
+// both paths end up pointing the shader at the same bytes. a frame has to
+//   fit the CBV ring for the table path to be right at all, which is the
+//   wraparound the root CBVs got rid of
+static void test_same_addresses() {
+    CBufferBackend table;
+    CBufferBackend root;
+    backend_create(&table);
+    backend_create(&root);
+    uint64_t sink = 0;
+    run_frames(&table, bind_table, 3, MAX_CBUFFERS / 2, &sink);
+    run_frames(&root, bind_root, 3, MAX_CBUFFERS / 2, &sink);
+    CHECK(table.command_stream.size() == root.command_stream.size());
+    uint32_t mismatched = 0;
+    for (size_t i = 0; i < root.command_stream.size(); i++) {
+        mismatched += table.command_stream[i].parameter != root.command_stream[i].parameter;
+        mismatched += resolve(table, table.command_stream[i]) != root.command_stream[i].value;
+        mismatched += root.command_stream[i].value % CB_ALIGNMENT != 0;
+    }
+    CHECK(mismatched == 0);
+
+    // past MAX_CBUFFERS cbuffers a frame the ring wraps onto its own draws,
+    //   the first ones end up reading what the later ones wrote
+    run_frames(&table, bind_table, 1, MAX_CBUFFERS, &sink);
+    uint32_t overwritten = 0;
+    std::vector<uint64_t> addresses;
+    for (const RootArgument& argument : table.command_stream) addresses.push_back(resolve(table, argument));
+    for (size_t i = 0; i + MAX_CBUFFERS < addresses.size(); i++) overwritten += addresses[i] == addresses[i + MAX_CBUFFERS];
+    CHECK(overwritten == MAX_CBUFFERS);
+}
+
+// 2000 draws a frame, per draw cost of each path. rounds alternate & the
+//   best of each counts, so one noisy stretch doesn't pick the winner
+static void bench_per_draw() {
+    constexpr uint32_t ROUNDS = 8;
+    constexpr uint32_t FRAMES = 100;
+    constexpr uint32_t DRAWS = 2000;
+    CBufferBackend table;
+    CBufferBackend root;
+    backend_create(&table);
+    backend_create(&root);
+    uint64_t sink = 0;
+    // warm up, so every page exists before the timing
+    run_frames(&table, bind_table, 4, DRAWS, &sink);
+    run_frames(&root, bind_root, 4, DRAWS, &sink);
+
+    double table_seconds = 1e30;
+    double root_seconds = 1e30;
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        double seconds = run_frames(&table, bind_table, FRAMES, DRAWS, &sink);
+        table_seconds = seconds < table_seconds ? seconds : table_seconds;
+        seconds = run_frames(&root, bind_root, FRAMES, DRAWS, &sink);
+        root_seconds = seconds < root_seconds ? seconds : root_seconds;
+    }
+    double draws = (double)FRAMES * DRAWS;
+    printf(
+        "%u draws x %u frames (best of %u), 2 cbuffers each: descriptor table + CBV %.1f ns/draw, root CBV %.1f ns/draw (%llu)\n",
+        DRAWS, FRAMES, ROUNDS, table_seconds * 1e9 / draws, root_seconds * 1e9 / draws, (unsigned long long)(sink & 1)
+    );
+}
+
+int main() {
+    test_same_addresses();
+    bench_per_draw();
+    return test_finish();
+}
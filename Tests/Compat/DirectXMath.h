@@ -0,0 +1,290 @@
+#pragma once
+
+// the slice of DirectXMath the GPU-free modules use, for building them &
+//   their tests off windows. SSE2 only like the real thing's default path,
+//   so timings stay in the same ballpark. NOT a general replacement
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace DirectX {
+    constexpr float XM_PI = 3.141592654f;
+    constexpr float XM_2PI = 6.283185307f;
+    constexpr float XM_PIDIV2 = 1.570796327f;
+    constexpr float XM_PIDIV4 = 0.785398163f;
+
+    constexpr float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+    constexpr float XMConvertToDegrees(float radians) { return radians * (180.0f / XM_PI); }
+
+    struct XMFLOAT2 {
+        float x, y;
+        XMFLOAT2() = default;
+        constexpr XMFLOAT2(float x, float y) : x(x), y(y) { }
+    };
+    struct XMFLOAT3 {
+        float x, y, z;
+        XMFLOAT3() = default;
+        constexpr XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) { }
+    };
+    struct XMFLOAT4 {
+        float x, y, z, w;
+        XMFLOAT4() = default;
+        constexpr XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) { }
+    };
+    struct XMUINT4 {
+        uint32_t x, y, z, w;
+    };
+    struct XMFLOAT4X4 {
+        union {
+            float m[4][4];
+            struct {
+                float _11, _12, _13, _14;
+                float _21, _22, _23, _24;
+                float _31, _32, _33, _34;
+                float _41, _42, _43, _44;
+            };
+        };
+    };
+
+    // gcc & clang give __m128 the arithmetic operators DirectXMath overloads
+    typedef __m128 XMVECTOR;
+    typedef const XMVECTOR FXMVECTOR;
+    typedef const XMVECTOR GXMVECTOR;
+    typedef const XMVECTOR& CXMVECTOR;
+
+    struct XMMATRIX {
+        XMVECTOR r[4];
+    };
+    typedef const XMMATRIX& FXMMATRIX;
+    typedef const XMMATRIX& CXMMATRIX;
+
+    // --- LOAD / STORE ---
+
+    inline XMVECTOR XMVectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+    inline XMVECTOR XMVectorZero() { return _mm_setzero_ps(); }
+    inline XMVECTOR XMVectorReplicate(float value) { return _mm_set1_ps(value); }
+    inline XMVECTOR XMVectorSplatOne() { return _mm_set1_ps(1.0f); }
+    inline XMVECTOR XMVectorSetInt(uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+        return _mm_castsi128_ps(_mm_setr_epi32((int)x, (int)y, (int)z, (int)w));
+    }
+    inline XMVECTOR XMVectorTrueInt() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    inline XMVECTOR XMVectorFalseInt() { return _mm_setzero_ps(); }
+
+    inline XMVECTOR XMLoadFloat2(const XMFLOAT2* p) { return _mm_castpd_ps(_mm_load_sd((const double*)&p->x)); }
+    inline XMVECTOR XMLoadFloat3(const XMFLOAT3* p) {
+        return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double*)&p->x)), _mm_load_ss(&p->z));
+    }
+    inline XMVECTOR XMLoadFloat4(const XMFLOAT4* p) { return _mm_loadu_ps(&p->x); }
+    inline void XMStoreFloat2(XMFLOAT2* p, FXMVECTOR v) { _mm_store_sd((double*)&p->x, _mm_castps_pd(v)); }
+    inline void XMStoreFloat3(XMFLOAT3* p, FXMVECTOR v) {
+        _mm_store_sd((double*)&p->x, _mm_castps_pd(v));
+        _mm_store_ss(&p->z, _mm_movehl_ps(v, v));
+    }
+    inline void XMStoreFloat4(XMFLOAT4* p, FXMVECTOR v) { _mm_storeu_ps(&p->x, v); }
+    inline void XMStoreInt4(uint32_t* p, FXMVECTOR v) { _mm_storeu_si128((__m128i*)p, _mm_castps_si128(v)); }
+
+    inline float XMVectorGetX(FXMVECTOR v) { return _mm_cvtss_f32(v); }
+    inline float XMVectorGetY(FXMVECTOR v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+    inline float XMVectorGetZ(FXMVECTOR v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+    inline float XMVectorGetW(FXMVECTOR v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+    inline XMVECTOR XMVectorSetW(FXMVECTOR v, float w) {
+        // (z, z, w', w') then back into place next to x & y
+        XMVECTOR zw = _mm_shuffle_ps(v, _mm_set_ss(w), _MM_SHUFFLE(0, 0, 2, 2));
+        return _mm_shuffle_ps(v, zw, _MM_SHUFFLE(2, 0, 1, 0));
+    }
+
+    template <uint32_t X, uint32_t Y, uint32_t Z, uint32_t W>
+    inline XMVECTOR XMVectorSwizzle(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+    inline XMVECTOR XMVectorSplatW(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+    inline XMVECTOR XMVectorMergeXY(FXMVECTOR a, FXMVECTOR b) { return _mm_unpacklo_ps(a, b); }
+    inline XMVECTOR XMVectorMergeZW(FXMVECTOR a, FXMVECTOR b) { return _mm_unpackhi_ps(a, b); }
+
+    // --- PER COMPONENT ---
+
+    inline XMVECTOR XMVectorAdd(FXMVECTOR a, FXMVECTOR b) { return _mm_add_ps(a, b); }
+    inline XMVECTOR XMVectorSubtract(FXMVECTOR a, FXMVECTOR b) { return _mm_sub_ps(a, b); }
+    inline XMVECTOR XMVectorMultiply(FXMVECTOR a, FXMVECTOR b) { return _mm_mul_ps(a, b); }
+    inline XMVECTOR XMVectorScale(FXMVECTOR v, float s) { return _mm_mul_ps(v, _mm_set1_ps(s)); }
+    inline XMVECTOR XMVectorNegate(FXMVECTOR v) { return _mm_sub_ps(_mm_setzero_ps(), v); }
+    inline XMVECTOR XMVectorMultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    inline XMVECTOR XMVectorNegativeMultiplySubtract(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+    inline XMVECTOR XMVectorLerp(FXMVECTOR a, FXMVECTOR b, float t) { return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t))); }
+    inline XMVECTOR XMVectorMin(FXMVECTOR a, FXMVECTOR b) { return _mm_min_ps(a, b); }
+    inline XMVECTOR XMVectorMax(FXMVECTOR a, FXMVECTOR b) { return _mm_max_ps(a, b); }
+    inline XMVECTOR XMVectorClamp(FXMVECTOR v, FXMVECTOR lo, FXMVECTOR hi) { return _mm_min_ps(_mm_max_ps(v, lo), hi); }
+    inline XMVECTOR XMVectorAbs(FXMVECTOR v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+    inline XMVECTOR XMVectorSqrt(FXMVECTOR v) { return _mm_sqrt_ps(v); }
+    inline XMVECTOR XMVectorReciprocal(FXMVECTOR v) { return _mm_div_ps(_mm_set1_ps(1.0f), v); }
+    inline XMVECTOR XMVectorReciprocalSqrt(FXMVECTOR v) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(v)); }
+
+    // same polynomial DirectXMath uses, good to ~1e-6 rad
+    inline XMVECTOR XMVectorACos(FXMVECTOR v) {
+        static const float coefficients[8] = {
+            -0.0012624911f, 0.0066700901f, -0.0170881256f, 0.0308918810f,
+            -0.0501743046f, 0.0889789874f, -0.2145988016f, 1.5707963050f
+        };
+        XMVECTOR non_negative = _mm_cmpge_ps(v, _mm_setzero_ps());
+        XMVECTOR x = XMVectorAbs(v);
+        XMVECTOR root = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), _mm_setzero_ps()));
+        XMVECTOR t = _mm_set1_ps(coefficients[0]);
+        for (int i = 1; i < 8; i++) t = _mm_add_ps(_mm_mul_ps(t, x), _mm_set1_ps(coefficients[i]));
+        t = _mm_mul_ps(t, root);
+        XMVECTOR flipped = _mm_sub_ps(_mm_set1_ps(XM_PI), t);
+        return _mm_or_ps(_mm_and_ps(non_negative, t), _mm_andnot_ps(non_negative, flipped));
+    }
+
+    inline XMVECTOR XMVectorEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpeq_ps(a, b); }
+    inline XMVECTOR XMVectorGreater(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpgt_ps(a, b); }
+    inline XMVECTOR XMVectorGreaterOrEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpge_ps(a, b); }
+    inline XMVECTOR XMVectorLess(FXMVECTOR a, FXMVECTOR b) { return _mm_cmplt_ps(a, b); }
+    inline XMVECTOR XMVectorLessOrEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmple_ps(a, b); }
+    inline XMVECTOR XMVectorSelect(FXMVECTOR a, FXMVECTOR b, FXMVECTOR control) {
+        return _mm_or_ps(_mm_andnot_ps(control, a), _mm_and_ps(b, control));
+    }
+    inline XMVECTOR XMVectorAndInt(FXMVECTOR a, FXMVECTOR b) { return _mm_and_ps(a, b); }
+    inline XMVECTOR XMVectorAndCInt(FXMVECTOR a, FXMVECTOR b) { return _mm_andnot_ps(b, a); }
+    inline XMVECTOR XMVectorOrInt(FXMVECTOR a, FXMVECTOR b) { return _mm_or_ps(a, b); }
+
+    // --- GEOMETRIC ---
+
+    // the result's splatted across all 4 lanes, like DirectXMath's
+    inline XMVECTOR XMVector2Dot(FXMVECTOR a, FXMVECTOR b) {
+        XMVECTOR p = _mm_mul_ps(a, b);
+        p = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+    inline XMVECTOR XMVector3Dot(FXMVECTOR a, FXMVECTOR b) {
+        XMVECTOR p = _mm_mul_ps(a, b);
+        XMVECTOR s = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        s = _mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+    inline XMVECTOR XMVector4Dot(FXMVECTOR a, FXMVECTOR b) {
+        XMVECTOR p = _mm_mul_ps(a, b);
+        p = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+    inline XMVECTOR XMVector3Cross(FXMVECTOR a, FXMVECTOR b) {
+        XMVECTOR a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        XMVECTOR b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        XMVECTOR c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+        c = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        return _mm_and_ps(c, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    }
+    inline XMVECTOR XMVector2Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector2Dot(v, v)); }
+    inline XMVECTOR XMVector3LengthSq(FXMVECTOR v) { return XMVector3Dot(v, v); }
+    inline XMVECTOR XMVector3Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector3Dot(v, v)); }
+    // zero length stays zero
+    inline XMVECTOR XMVector3Normalize(FXMVECTOR v) {
+        XMVECTOR length = _mm_sqrt_ps(XMVector3Dot(v, v));
+        XMVECTOR valid = _mm_cmpgt_ps(length, _mm_setzero_ps());
+        return _mm_and_ps(_mm_div_ps(v, length), valid);
+    }
+    inline XMVECTOR XMVector4Normalize(FXMVECTOR v) {
+        XMVECTOR length = _mm_sqrt_ps(XMVector4Dot(v, v));
+        XMVECTOR valid = _mm_cmpgt_ps(length, _mm_setzero_ps());
+        return _mm_and_ps(_mm_div_ps(v, length), valid);
+    }
+
+    // --- MATRICES (row vectors, like DirectXMath) ---
+
+    inline XMMATRIX XMMatrixIdentity() {
+        return { { _mm_setr_ps(1, 0, 0, 0), _mm_setr_ps(0, 1, 0, 0), _mm_setr_ps(0, 0, 1, 0), _mm_setr_ps(0, 0, 0, 1) } };
+    }
+    inline XMVECTOR XMVector4Transform(FXMVECTOR v, FXMMATRIX m) {
+        XMVECTOR r = _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)), m.r[0]);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), m.r[1]));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), m.r[2]));
+        return _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), m.r[3]));
+    }
+    inline XMVECTOR XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m) {
+        XMVECTOR r = _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)), m.r[0]);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), m.r[1]));
+        return _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), m.r[2]));
+    }
+    inline XMVECTOR XMVector3Transform(FXMVECTOR v, FXMMATRIX m) { return _mm_add_ps(XMVector3TransformNormal(v, m), m.r[3]); }
+    inline XMVECTOR XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m) {
+        XMVECTOR r = XMVector3Transform(v, m);
+        return _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    inline XMMATRIX XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b) {
+        XMMATRIX r;
+        for (int i = 0; i < 4; i++) r.r[i] = XMVector4Transform(a.r[i], b);
+        return r;
+    }
+    inline XMMATRIX operator*(FXMMATRIX a, CXMMATRIX b) { return XMMatrixMultiply(a, b); }
+    inline XMMATRIX XMMatrixTranspose(FXMMATRIX m) {
+        XMMATRIX r = m;
+        _MM_TRANSPOSE4_PS(r.r[0], r.r[1], r.r[2], r.r[3]);
+        return r;
+    }
+    inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* p) {
+        return { { _mm_loadu_ps(p->m[0]), _mm_loadu_ps(p->m[1]), _mm_loadu_ps(p->m[2]), _mm_loadu_ps(p->m[3]) } };
+    }
+    inline void XMStoreFloat4x4(XMFLOAT4X4* p, FXMMATRIX m) {
+        for (int i = 0; i < 4; i++) _mm_storeu_ps(p->m[i], m.r[i]);
+    }
+    inline XMMATRIX XMMatrixPerspectiveFovLH(float fov, float aspect, float near_z, float far_z) {
+        float y_scale = 1.0f / tanf(fov * 0.5f);
+        float range = far_z / (far_z - near_z);
+        return { {
+            _mm_setr_ps(y_scale / aspect, 0, 0, 0),
+            _mm_setr_ps(0, y_scale, 0, 0),
+            _mm_setr_ps(0, 0, range, 1),
+            _mm_setr_ps(0, 0, -range * near_z, 0)
+        } };
+    }
+    inline XMMATRIX XMMatrixLookToLH(FXMVECTOR eye, FXMVECTOR direction, FXMVECTOR up) {
+        XMVECTOR z = XMVector3Normalize(direction);
+        XMVECTOR x = XMVector3Normalize(XMVector3Cross(up, z));
+        XMVECTOR y = XMVector3Cross(z, x);
+        XMMATRIX m = { { x, y, z, _mm_setr_ps(0, 0, 0, 1) } };
+        m = XMMatrixTranspose(m);
+        m.r[3] = _mm_setr_ps(
+            -XMVectorGetX(XMVector3Dot(x, eye)),
+            -XMVectorGetX(XMVector3Dot(y, eye)),
+            -XMVectorGetX(XMVector3Dot(z, eye)),
+            1
+        );
+        return m;
+    }
+
+    // --- QUATERNIONS ---
+
+    inline XMVECTOR XMQuaternionNormalize(FXMVECTOR q) { return XMVector4Normalize(q); }
+    inline XMMATRIX XMMatrixRotationQuaternion(FXMVECTOR q) {
+        alignas(16) float f[4];
+        _mm_store_ps(f, q);
+        float x = f[0], y = f[1], z = f[2], w = f[3];
+        return { {
+            _mm_setr_ps(1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0),
+            _mm_setr_ps(2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0),
+            _mm_setr_ps(2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0),
+            _mm_setr_ps(0, 0, 0, 1)
+        } };
+    }
+    inline XMVECTOR XMQuaternionRotationMatrix(FXMMATRIX m) {
+        alignas(16) float r[3][4];
+        for (int i = 0; i < 3; i++) _mm_store_ps(r[i], m.r[i]);
+        float m00 = r[0][0], m01 = r[0][1], m02 = r[0][2];
+        float m10 = r[1][0], m11 = r[1][1], m12 = r[1][2];
+        float m20 = r[2][0], m21 = r[2][1], m22 = r[2][2];
+        float trace = m00 + m11 + m22;
+        if (trace > 0.0f) {
+            float s = sqrtf(trace + 1.0f) * 2.0f;
+            return XMVectorSet((m12 - m21) / s, (m20 - m02) / s, (m01 - m10) / s, 0.25f * s);
+        }
+        if (m00 > m11 && m00 > m22) {
+            float s = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
+            return XMVectorSet(0.25f * s, (m01 + m10) / s, (m02 + m20) / s, (m12 - m21) / s);
+        }
+        if (m11 > m22) {
+            float s = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
+            return XMVectorSet((m01 + m10) / s, 0.25f * s, (m12 + m21) / s, (m20 - m02) / s);
+        }
+        float s = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
+        return XMVectorSet((m02 + m20) / s, (m12 + m21) / s, 0.25f * s, (m01 - m10) / s);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// half <-> float the same way DirectXMath's scalar path does it (round to
+//   nearest even, no infinities on the way in), see Compat/DirectXMath.h
+
+#include <cstdint>
+#include <cstring>
+
+namespace DirectX {
+    namespace PackedVector {
+        typedef uint16_t HALF;
+
+        inline HALF XMConvertFloatToHalf(float value) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            uint32_t sign = (bits >> 16) & 0x8000u;
+            bits &= 0x7fffffffu;
+
+            uint32_t result;
+            if (bits > 0x477fe000u) {
+                // too big, or a nan (which stays one)
+                result = (bits & 0x7f800000u) == 0x7f800000u && (bits & 0x7fffffu) != 0 ? 0x7fffu : 0x7c00u;
+            } else if (bits < 0x38800000u) {
+                // denormal or flushes to 0
+                uint32_t shift = 113u - (bits >> 23);
+                bits = shift > 24 ? 0 : (0x800000u | (bits & 0x7fffffu)) >> shift;
+                result = (bits + 0x0fffu + ((bits >> 13) & 1u)) >> 13;
+            } else {
+                bits += 0xc8000000u;
+                result = ((bits + 0x0fffu + ((bits >> 13) & 1u)) >> 13) & 0x7fffu;
+            }
+            return (HALF)(result | sign);
+        }
+
+        inline float XMConvertHalfToFloat(HALF value) {
+            uint32_t mantissa = value & 0x03ffu;
+            uint32_t exponent = value & 0x7c00u;
+            if (exponent == 0x7c00u) {
+                exponent = 0x8fu;
+            } else if (exponent != 0) {
+                exponent = (value >> 10) & 0x1fu;
+            } else if (mantissa != 0) {
+                // renormalize the denormal
+                exponent = 1;
+                do {
+                    exponent--;
+                    mantissa <<= 1;
+                } while ((mantissa & 0x0400u) == 0);
+                mantissa &= 0x03ffu;
+            } else {
+                exponent = (uint32_t)-112;
+            }
+            uint32_t bits = ((uint32_t)(value & 0x8000u) << 16) | ((exponent + 112) << 23) | (mantissa << 13);
+            float result;
+            memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// the few d3d12/dxgi declarations the GPU-free modules touch (vertex input
+//   elements & texture formats), values match the real headers since cooked
+//   files store them. see Compat/DirectXMath.h
+
+#include <cstdint>
+
+enum DXGI_FORMAT {
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+    DXGI_FORMAT_R32G32B32_FLOAT = 6,
+    DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+    DXGI_FORMAT_R16G16B16A16_UNORM = 11,
+    DXGI_FORMAT_R16G16B16A16_SNORM = 13,
+    DXGI_FORMAT_R32G32_FLOAT = 16,
+    DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+    DXGI_FORMAT_R16G16_FLOAT = 34,
+    DXGI_FORMAT_R16G16_UNORM = 35,
+    DXGI_FORMAT_R16G16_SNORM = 37,
+    DXGI_FORMAT_R32_UINT = 42,
+    DXGI_FORMAT_R16_UINT = 57,
+    DXGI_FORMAT_BC1_UNORM = 71,
+    DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+    DXGI_FORMAT_BC3_UNORM = 77,
+    DXGI_FORMAT_BC4_UNORM = 80,
+    DXGI_FORMAT_BC5_UNORM = 83,
+    DXGI_FORMAT_BC7_UNORM = 98,
+    DXGI_FORMAT_BC7_UNORM_SRGB = 99,
+};
+
+enum D3D12_INPUT_CLASSIFICATION {
+    D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA = 0,
+    D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA = 1,
+};
+
+#define D3D12_APPEND_ALIGNED_ELEMENT (0xffffffff)
+
+struct D3D12_INPUT_ELEMENT_DESC {
+    const char* SemanticName;
+    uint32_t SemanticIndex;
+    DXGI_FORMAT Format;
+    uint32_t InputSlot;
+    uint32_t AlignedByteOffset;
+    D3D12_INPUT_CLASSIFICATION InputSlotClass;
+    uint32_t InstanceDataStepRate;
+};
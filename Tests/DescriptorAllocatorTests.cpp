@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "DescriptorAllocator.h"
+#include "TestCheck.h"
+
+static void test_runs_and_fences() {
+    DescriptorAllocator allocator;
+    descriptor_allocator_create(&allocator, 200, 16, 2);
+
+    CHECK(descriptor_allocator_allocate(&allocator, 0) == DESCRIPTOR_INVALID);
+    uint32_t a = descriptor_allocator_allocate(&allocator, 1);
+    uint32_t b = descriptor_allocator_allocate(&allocator, 100);
+    uint32_t c = descriptor_allocator_allocate(&allocator, 1);
+    CHECK(a == 0 && b == 1 && c == 101);
+    // 98 left at the end, a run of 99 doesn't exist
+    CHECK(descriptor_allocator_allocate(&allocator, 99) == DESCRIPTOR_INVALID);
+    CHECK(descriptor_allocator_largest_free_run(&allocator) == 98);
+
+    // the run only frees up once its fence does
+    descriptor_allocator_free(&allocator, b, 100, 5);
+    CHECK(allocator.stats.pending_frees == 1);
+    descriptor_allocator_retire(&allocator, 4);
+    CHECK(descriptor_allocator_allocate(&allocator, 99) == DESCRIPTOR_INVALID);
+    descriptor_allocator_retire(&allocator, 5);
+    CHECK(allocator.stats.pending_frees == 0);
+    CHECK(descriptor_allocator_largest_free_run(&allocator) == 100);
+    CHECK(descriptor_allocator_allocate(&allocator, 99) == 1);
+    // single slots fill the hole that's left first
+    CHECK(descriptor_allocator_allocate(&allocator, 1) == 100);
+    CHECK(allocator.stats.used == 1 + 99 + 1 + 1);
+}
+
+static void test_frame_partitions() {
+    DescriptorAllocator allocator;
+    descriptor_allocator_create(&allocator, 100, 16, 2);
+
+    descriptor_allocator_begin_frame(&allocator, 0);
+    CHECK(descriptor_allocator_allocate_frame(&allocator, 10) == 100);
+    CHECK(descriptor_allocator_allocate_frame(&allocator, 6) == 110);
+    CHECK(descriptor_allocator_allocate_frame(&allocator, 1) == DESCRIPTOR_INVALID);
+    CHECK(allocator.stats.frame_overflow_count == 1);
+
+    descriptor_allocator_begin_frame(&allocator, 1);
+    CHECK(descriptor_allocator_allocate_frame(&allocator, 4) == 116);
+    CHECK(allocator.stats.frame_used == 4 && allocator.stats.frame_high_water == 16);
+
+    // coming around again wipes the slot
+    descriptor_allocator_begin_frame(&allocator, 0);
+    CHECK(descriptor_allocator_allocate_frame(&allocator, 16) == 100);
+}
+
+// random singles & ranges freed with the frame's fence value, the GPU one
+//   frame behind. the model tracks every slot: nothing live or waiting on
+//   its fence may ever be handed out
+static void test_random_against_model() {
+    constexpr uint32_t SLOT_COUNT = 4000;
+    enum SlotState { FREE, LIVE, PENDING };
+    struct Owned {
+        uint32_t index;
+        uint32_t count;
+        uint64_t fence_value;
+    };
+
+    DescriptorAllocator allocator;
+    descriptor_allocator_create(&allocator, SLOT_COUNT, 256, 2);
+    std::vector<SlotState> slots(SLOT_COUNT, FREE);
+    std::vector<Owned> live;
+    std::vector<Owned> pending;
+    std::mt19937 random(5);
+
+    uint64_t errors = 0;
+    uint64_t fence_value = 1;
+    for (uint32_t step = 0; step < 300000; step++) {
+        uint32_t op = random() % 100;
+        if (op < 55) {
+            uint32_t count = random() % 10 == 0 ? 1 + random() % 16 : 1;
+            uint32_t index = descriptor_allocator_allocate(&allocator, count);
+            if (index == DESCRIPTOR_INVALID) continue;
+            for (uint32_t s = index; s < index + count; s++) {
+                errors += s >= SLOT_COUNT || slots[s] != FREE;
+                if (s < SLOT_COUNT) slots[s] = LIVE;
+            }
+            live.push_back({ index, count, 0 });
+        } else if (op < 98 && !live.empty()) {
+            size_t i = random() % live.size();
+            Owned owned = live[i];
+            live[i] = live.back();
+            live.pop_back();
+
+            owned.fence_value = fence_value;
+            descriptor_allocator_free(&allocator, owned.index, owned.count, fence_value);
+            for (uint32_t s = owned.index; s < owned.index + owned.count; s++) slots[s] = PENDING;
+            pending.push_back(owned);
+        } else {
+            fence_value++;
+            uint64_t completed = fence_value - 2;
+            descriptor_allocator_retire(&allocator, completed);
+            for (size_t i = 0; i < pending.size();) {
+                if (pending[i].fence_value <= completed) {
+                    for (uint32_t s = pending[i].index; s < pending[i].index + pending[i].count; s++) slots[s] = FREE;
+                    pending[i] = pending.back();
+                    pending.pop_back();
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+
+    uint32_t used = (uint32_t)std::count_if(slots.begin(), slots.end(), [](SlotState s) { return s != FREE; });
+    CHECK(errors == 0);
+    CHECK(allocator.stats.used == used);
+    CHECK(allocator.stats.pending_frees == pending.size());
+}
+
+// a resize swapping 8 SRVs every frame mustn't creep through the heap
+static void test_resize_churn() {
+    DescriptorAllocator allocator;
+    descriptor_allocator_create(&allocator, 100, 256, 2);
+
+    uint32_t slots[8];
+    for (uint32_t& slot : slots) slot = descriptor_allocator_allocate(&allocator, 1);
+    for (uint64_t frame = 1; frame < 100000; frame++) {
+        for (uint32_t& slot : slots) {
+            descriptor_allocator_free(&allocator, slot, 1, frame);
+            slot = descriptor_allocator_allocate(&allocator, 1);
+            if (!CHECK(slot != DESCRIPTOR_INVALID)) return;
+        }
+        descriptor_allocator_retire(&allocator, frame - 1);
+    }
+    CHECK(allocator.stats.high_water <= 24);
+}
+
+static void bench_churn() {
+    DescriptorAllocator allocator;
+    descriptor_allocator_create(&allocator, 100000, 256, 2);
+    std::vector<uint32_t> held;
+    for (uint32_t i = 0; i < 75000; i++) held.push_back(descriptor_allocator_allocate(&allocator, 1));
+    std::mt19937 random(7);
+    std::shuffle(held.begin(), held.end(), random);
+
+    // single slot frees & allocations at 75% occupancy
+    constexpr uint32_t COUNT = 2000000;
+    uint64_t fence_value = 1;
+    size_t cursor = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        descriptor_allocator_free(&allocator, held[cursor], 1, fence_value);
+        held[cursor] = descriptor_allocator_allocate(&allocator, 1);
+        cursor = (cursor + 7919) % held.size();
+        if ((i & 255) == 255) {
+            fence_value++;
+            descriptor_allocator_retire(&allocator, fence_value - 2);
+        }
+    }
+    double seconds = test_seconds_since(start);
+    CHECK(std::find(held.begin(), held.end(), DESCRIPTOR_INVALID) == held.end());
+    printf("%u free + allocate pairs at 75%% full: %.1f ns each\n", COUNT, seconds * 1e9 / COUNT);
+}
+
+int main() {
+    test_runs_and_fences();
+    test_frame_partitions();
+    test_random_against_model();
+    test_resize_churn();
+    bench_churn();
+    return test_finish();
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include "FrameAllocator.h"
+#include "TestCheck.h"
+
+static void test_spill_and_recycle() {
+    FrameAllocator allocator;
+    frame_allocator_create(&allocator, 1024, 256, 2);
+
+    frame_allocator_begin_frame(&allocator, 1, 0);
+    FrameAllocation a = frame_allocator_allocate(&allocator, 100);
+    FrameAllocation b = frame_allocator_allocate(&allocator, 100);
+    CHECK(a.page == b.page && a.offset == 0 && b.offset == 256);
+    CHECK(allocator.stats.bytes_written == 200 && allocator.stats.bytes_reserved == 512);
+
+    // 600 doesn't fit behind 512, so it spills into the other page
+    FrameAllocation c = frame_allocator_allocate(&allocator, 600);
+    CHECK(c.page != a.page && c.offset == 0);
+    CHECK(allocator.stats.spill_count == 1 && allocator.stats.page_count == 2);
+
+    // bigger than a page gets a page of its own size
+    FrameAllocation d = frame_allocator_allocate(&allocator, 3000);
+    CHECK(d.offset == 0 && allocator.pages[d.page].size == 3072);
+    CHECK(allocator.stats.pages_created == 1);
+    frame_allocator_end_frame(&allocator);
+    CHECK(allocator.stats.high_water_bytes == 512 + 768 + 3072);
+
+    // frame 1 hasn't finished, so frame 2 needs a new page
+    frame_allocator_begin_frame(&allocator, 2, 0);
+    CHECK(allocator.frame_pages[0] != a.page && allocator.frame_pages[0] != c.page && allocator.frame_pages[0] != d.page);
+    frame_allocator_end_frame(&allocator);
+    CHECK(allocator.stats.pages_created == 2);
+
+    // now it has, & all of its pages come back
+    frame_allocator_begin_frame(&allocator, 3, 1);
+    CHECK(allocator.free_pages.size() == 2 && allocator.retired_pages.size() == 1);
+    frame_allocator_end_frame(&allocator);
+    CHECK(allocator.stats.pages_created == 2);
+}
+
+// what GPU-side memory the allocator gave to a frame that's still in flight
+struct LiveSpan {
+    uint32_t page;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t fence_value;
+};
+
+// frames of a few hundred draws with the odd spike, the GPU finishing each
+//   one frames_in_flight frames later (what AdvanceSwapChainIndex waits
+//   for). nothing a frame in flight reads may be handed out again
+static void test_frames_in_flight() {
+    constexpr uint64_t PAGE_SIZE = 256 * 1000;
+    constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+    FrameAllocator allocator;
+    frame_allocator_create(&allocator, PAGE_SIZE, 256, FRAMES_IN_FLIGHT);
+
+    std::mt19937 random(3);
+    std::deque<LiveSpan> live;
+    uint64_t overlaps = 0;
+    uint64_t out_of_page = 0;
+    uint64_t fence_value = 1;
+    uint64_t completed = 0;
+    for (uint32_t frame = 0; frame < 5000; frame++) {
+        frame_allocator_begin_frame(&allocator, fence_value, completed);
+
+        uint32_t draws = random() % 50 == 0 ? 1500 : 250 + random() % 100;
+        for (uint32_t i = 0; i < draws * 2; i++) {
+            // a transform & a material buffer per draw
+            uint64_t size = i & 1 ? 80 : 272;
+            FrameAllocation allocation = frame_allocator_allocate(&allocator, size);
+            out_of_page += allocation.offset + size > allocator.pages[allocation.page].size;
+            out_of_page += allocation.offset % 256 != 0;
+            for (const LiveSpan& span : live) {
+                overlaps += span.page == allocation.page && allocation.offset < span.offset + span.size && span.offset < allocation.offset + size;
+            }
+            // every span of earlier frames gets checked against, this one's only sampled
+            if (i < 64 || i % 64 == 0) live.push_back({ allocation.page, allocation.offset, size, fence_value });
+        }
+        frame_allocator_end_frame(&allocator);
+
+        fence_value++;
+        completed = fence_value > FRAMES_IN_FLIGHT ? fence_value - FRAMES_IN_FLIGHT : 0;
+        while (!live.empty() && live.front().fence_value <= completed) live.pop_front();
+    }
+    CHECK(overlaps == 0);
+    CHECK(out_of_page == 0);
+    // the spikes need more pages, but only ever a handful
+    CHECK(allocator.pages.size() <= 12);
+
+    printf(
+        "%llu frames: %zu pages (%u created), %llu spills, high water %llu KB\n",
+        (unsigned long long)allocator.stats.frame_count, allocator.pages.size(), allocator.stats.pages_created,
+        (unsigned long long)allocator.stats.spill_count, (unsigned long long)allocator.stats.high_water_bytes / 1024
+    );
+}
+
+static void bench_allocate() {
+    FrameAllocator allocator;
+    frame_allocator_create(&allocator, 256 * 1000, 256, 2);
+
+    uint64_t sink = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t frame = 1; frame <= 10000; frame++) {
+        frame_allocator_begin_frame(&allocator, frame, frame > 2 ? frame - 2 : 0);
+        for (uint32_t i = 0; i < 1000; i++) {
+            sink += frame_allocator_allocate(&allocator, 192).offset;
+        }
+        frame_allocator_end_frame(&allocator);
+    }
+    double seconds = test_seconds_since(start);
+    printf("10M allocations in %.1f ms, %.2f ns each (%llu)\n", seconds * 1e3, seconds * 1e9 / 1e7, (unsigned long long)(sink & 1));
+}
+
+int main() {
+    test_spill_and_recycle();
+    test_frames_in_flight();
+    bench_allocate();
+    return test_finish();
+}
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "FrameRing.h"
+#include "TestCheck.h"
+
+static void test_slots_and_fences() {
+    FrameRing ring;
+    frame_ring_create(&ring, 2, 1, 0.0);
+    CHECK(ring.slot == 0 && ring.fence_value == 1);
+
+    CHECK(frame_ring_submit(&ring) == 1);
+    // slot 1's never been used, nothing to wait for
+    CHECK(frame_ring_advance(&ring) == 0 && ring.slot == 1);
+    CHECK(frame_ring_submit(&ring) == 2);
+    // back to slot 0, which frame 1 still has
+    CHECK(frame_ring_advance(&ring) == 1 && ring.slot == 0);
+    CHECK(frame_ring_submit(&ring) == 3);
+    CHECK(frame_ring_advance(&ring) == 2 && ring.slot == 1);
+
+    // counts get clamped & only change on an advance
+    frame_ring_set_count(&ring, 100);
+    CHECK(ring.requested_count == MAX_FRAMES_IN_FLIGHT && ring.count == 2);
+    frame_ring_submit(&ring);
+    frame_ring_advance(&ring);
+    CHECK(ring.count == MAX_FRAMES_IN_FLIGHT && ring.slot == 2);
+    frame_ring_set_count(&ring, 0);
+    CHECK(ring.requested_count == 1);
+}
+
+static void test_latency_stats() {
+    FrameRing ring;
+    frame_ring_create(&ring, 2, 1, 0.0);
+    frame_ring_submit(&ring);
+    frame_ring_advance(&ring);
+    // frame 1 isn't done yet
+    frame_ring_retire(&ring, 0, 0.010);
+    CHECK(ring.stats.frame_count == 0 && ring.in_flight[0]);
+
+    frame_ring_submit(&ring);
+    frame_ring_advance(&ring);
+    frame_ring_stalled(&ring, 0.005);
+    // both done, frame 1 started at 0 & frame 2 at 0.010
+    frame_ring_retire(&ring, 2, 0.030);
+    CHECK(ring.stats.frame_count == 2);
+    CHECK(ring.stats.max_seconds == 0.030 && ring.stats.last_seconds == 0.030 - 0.010);
+    CHECK(ring.stats.stall_count == 1 && ring.stats.stall_seconds == 0.005);
+    CHECK(!ring.in_flight[0] && !ring.in_flight[1]);
+}
+
+// a GPU that runs frames in order, each taking however long it's handed
+struct SimulatedGpu {
+    double busy_until = 0.0;
+    // fence value & when it got there, in order
+    std::vector<std::pair<uint64_t, double>> finishes;
+
+    void submit(uint64_t fence_value, double now, double seconds) {
+        busy_until = (now > busy_until ? now : busy_until) + seconds;
+        finishes.push_back({ fence_value, busy_until });
+    }
+    uint64_t completed_at(double now) const {
+        uint64_t completed = 0;
+        for (const std::pair<uint64_t, double>& finish : finishes) {
+            if (finish.second <= now) completed = finish.first;
+        }
+        return completed;
+    }
+    double time_of(uint64_t fence_value) const {
+        for (const std::pair<uint64_t, double>& finish : finishes) {
+            if (finish.first >= fence_value) return finish.second;
+        }
+        return 1e30;
+    }
+    uint32_t in_flight_at(double now) const {
+        uint32_t count = 0;
+        for (const std::pair<uint64_t, double>& finish : finishes) count += finish.second > now;
+        return count;
+    }
+};
+
+struct SimulatedRun {
+    double frames_per_second;
+    double latency_seconds;
+    // of the whole run
+    double stalled_fraction;
+    uint32_t early_reuses;
+    uint32_t too_many_in_flight;
+};
+
+// the game's loop (record, submit, advance & wait, retire) with CPU & GPU
+//   frame times jittered by up to jitter either way. change_every switches
+//   to a random count that often, 0 never does
+static SimulatedRun simulate(uint32_t count, double cpu_seconds, double gpu_seconds, double jitter, uint32_t change_every,
+                             uint32_t frames, std::mt19937* random) {
+    FrameRing ring;
+    frame_ring_create(&ring, count, 1, 0.0);
+    SimulatedGpu gpu;
+    std::uniform_real_distribution<double> jittered(1.0 - jitter, 1.0 + jitter);
+    // fence value of the frame that last recorded into each slot
+    uint64_t slot_owners[MAX_FRAMES_IN_FLIGHT] = {};
+    uint32_t frames_since_change = MAX_FRAMES_IN_FLIGHT;
+
+    SimulatedRun run = {};
+    double now = 0.0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        if (change_every > 0 && frame % change_every == 0) {
+            frame_ring_set_count(&ring, 1 + (*random)() % MAX_FRAMES_IN_FLIGHT);
+            frames_since_change = 0;
+        }
+        frames_since_change++;
+
+        run.early_reuses += slot_owners[ring.slot] > gpu.completed_at(now);
+        now += cpu_seconds * jittered(*random);
+        uint64_t fence_value = frame_ring_submit(&ring);
+        slot_owners[ring.slot] = fence_value;
+        gpu.submit(fence_value, now, gpu_seconds * jittered(*random));
+
+        uint64_t wait_value = frame_ring_advance(&ring);
+        if (gpu.completed_at(now) < wait_value) {
+            double until = gpu.time_of(wait_value);
+            frame_ring_stalled(&ring, until - now);
+            now = until;
+        }
+        // once a shrink has drained, never more queued than the count
+        uint32_t in_flight = gpu.in_flight_at(now);
+        run.too_many_in_flight += in_flight > MAX_FRAMES_IN_FLIGHT;
+        run.too_many_in_flight += frames_since_change > MAX_FRAMES_IN_FLIGHT && in_flight >= ring.count;
+        frame_ring_retire(&ring, gpu.completed_at(now), now);
+    }
+    run.frames_per_second = frames / now;
+    run.latency_seconds = ring.stats.average_seconds;
+    run.stalled_fraction = ring.stats.stall_seconds / now;
+    return run;
+}
+
+// counts switched every few frames, never a slot reused while the GPU's still on it
+static void test_count_changes() {
+    std::mt19937 random(7);
+    uint32_t early_reuses = 0;
+    uint32_t too_many_in_flight = 0;
+    for (uint32_t i = 0; i < 50; i++) {
+        SimulatedRun run = simulate(1 + i % MAX_FRAMES_IN_FLIGHT, 5e-3, 5e-3, 0.3, 37, 2000, &random);
+        early_reuses += run.early_reuses;
+        too_many_in_flight += run.too_many_in_flight;
+    }
+    CHECK(early_reuses == 0);
+    CHECK(too_many_in_flight == 0);
+}
+
+// what each count buys: a GPU bound frame needs 2 to keep the GPU busy,
+//   more only adds latency
+static void bench_frames_in_flight() {
+    struct Case {
+        const char* name;
+        double cpu_seconds;
+        double gpu_seconds;
+        double jitter;
+    };
+    const Case cases[] = {
+        { "gpu bound, 4 ms cpu & 6 ms gpu", 4e-3, 6e-3, 0.0 },
+        { "cpu bound, 6 ms cpu & 4 ms gpu", 6e-3, 4e-3, 0.0 },
+        { "5 ms each, 30% jitter", 5e-3, 5e-3, 0.3 },
+    };
+    std::mt19937 random(7);
+    for (const Case& c : cases) {
+        printf("%s\n", c.name);
+        double fps[MAX_FRAMES_IN_FLIGHT + 1] = {};
+        for (uint32_t count = 1; count <= MAX_FRAMES_IN_FLIGHT; count++) {
+            SimulatedRun run = simulate(count, c.cpu_seconds, c.gpu_seconds, c.jitter, 0, 4000, &random);
+            CHECK(run.early_reuses == 0 && run.too_many_in_flight == 0);
+            fps[count] = run.frames_per_second;
+            printf(
+                "  %u in flight: %6.1f fps, latency %5.2f ms, cpu stalled %4.1f%%\n",
+                count, run.frames_per_second, run.latency_seconds * 1e3, run.stalled_fraction * 100.0
+            );
+        }
+        // 1 in flight runs the CPU & GPU back to back, 2 overlaps them
+        CHECK(fps[2] > fps[1] * 1.3);
+        CHECK(fps[MAX_FRAMES_IN_FLIGHT] >= fps[2] * 0.95);
+    }
+}
+
+int main() {
+    test_slots_and_fences();
+    test_latency_stats();
+    test_count_changes();
+    bench_frames_in_flight();
+    return test_finish();
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "HeapAllocator.h"
+#include "TestCheck.h"
+
+constexpr uint64_t KB = 1024;
+constexpr uint64_t MB = 1024 * KB;
+
+// walks the block in memory order & through every free list. returns how
+//   many invariants are broken: pieces have to tile the block, no two free
+//   ones sit next to each other, the bitmaps & stats agree with the lists
+static uint32_t heap_errors(const HeapAllocator& allocator) {
+    uint32_t errors = 0;
+    uint64_t offset = 0;
+    uint32_t prev = HEAP_NODE_NONE;
+    bool prev_free = false;
+    uint64_t free_bytes = 0;
+    uint64_t used_bytes = 0;
+    uint32_t free_nodes = 0;
+    for (uint32_t n = 0; n != HEAP_NODE_NONE; n = allocator.nodes[n].next_physical) {
+        const HeapNode& node = allocator.nodes[n];
+        errors += node.offset != offset;
+        errors += node.prev_physical != prev;
+        errors += node.free && prev_free;
+        errors += node.size == 0 || node.size % allocator.granularity != 0;
+        if (node.free) {
+            free_bytes += node.size;
+            free_nodes++;
+        } else {
+            used_bytes += node.size;
+        }
+        offset += node.size;
+        prev = n;
+        prev_free = node.free;
+    }
+    errors += offset != allocator.size;
+    errors += free_bytes != allocator.stats.free_bytes;
+    errors += used_bytes != allocator.stats.used_bytes;
+    errors += free_nodes != allocator.stats.free_node_count;
+
+    uint32_t listed = 0;
+    for (uint32_t fl = 0; fl < HEAP_FL_COUNT; fl++) {
+        for (uint32_t sl = 0; sl < HEAP_SL_COUNT; sl++) {
+            bool bit = (allocator.fl_bitmap >> fl & 1) && (allocator.sl_bitmaps[fl] >> sl & 1);
+            errors += bit != (allocator.free_lists[fl][sl] != HEAP_NODE_NONE);
+            for (uint32_t n = allocator.free_lists[fl][sl]; n != HEAP_NODE_NONE; n = allocator.nodes[n].next_free) {
+                errors += !allocator.nodes[n].free;
+                listed++;
+            }
+        }
+    }
+    errors += listed != free_nodes;
+    return errors;
+}
+
+static void test_merge_on_free() {
+    HeapAllocator allocator;
+    heap_allocator_create(&allocator, 1 * MB, 4 * KB);
+
+    HeapAllocation a;
+    HeapAllocation b;
+    HeapAllocation c;
+    CHECK(heap_allocator_allocate(&allocator, 100 * KB, 4 * KB, &a) && a.offset == 0);
+    CHECK(heap_allocator_allocate(&allocator, 1, 64 * KB, &b) && b.offset == 128 * KB);
+    CHECK(heap_allocator_allocate(&allocator, 200 * KB, 4 * KB, &c));
+    CHECK(!heap_allocator_allocate(&allocator, 1 * MB, 4 * KB, &c));
+    CHECK(heap_errors(allocator) == 0);
+
+    heap_allocator_free(&allocator, a.node);
+    heap_allocator_free(&allocator, c.node);
+    heap_allocator_free(&allocator, b.node);
+    CHECK(heap_errors(allocator) == 0);
+    CHECK(allocator.stats.free_node_count == 1 && heap_allocator_largest_free(&allocator) == 1 * MB);
+}
+
+// mixed sizes & alignments (buffers, textures, MSAA targets) freed in a
+//   random order, the whole structure checked as it goes
+static void test_random_single_block() {
+    std::mt19937_64 random(15);
+    const uint64_t alignments[] = { 4 * KB, 64 * KB, 64 * KB, 4 * MB };
+    uint32_t errors = 0;
+    uint32_t overlaps = 0;
+    for (uint32_t round = 0; round < 8; round++) {
+        HeapAllocator allocator;
+        heap_allocator_create(&allocator, 256 * MB, 4 * KB);
+        std::vector<HeapAllocation> live;
+        for (uint32_t i = 0; i < 20000; i++) {
+            if (random() % 100 < 55 || live.empty()) {
+                uint64_t size = random() % 4 == 0 ? 1 + random() % (16 * MB) : 1 + random() % (512 * KB);
+                uint64_t alignment = alignments[random() % 4];
+                HeapAllocation allocation;
+                if (!heap_allocator_allocate(&allocator, size, alignment, &allocation)) continue;
+                errors += allocation.offset % alignment != 0;
+                errors += allocation.offset + size > allocator.size;
+                live.push_back(allocation);
+            } else {
+                size_t victim = random() % live.size();
+                heap_allocator_free(&allocator, live[victim].node);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+            if (i % 997 == 0) errors += heap_errors(allocator);
+        }
+
+        std::sort(live.begin(), live.end(), [](const HeapAllocation& a, const HeapAllocation& b) { return a.offset < b.offset; });
+        for (size_t i = 1; i < live.size(); i++) {
+            overlaps += live[i - 1].offset + live[i - 1].size > live[i].offset;
+        }
+        for (const HeapAllocation& allocation : live) heap_allocator_free(&allocator, allocation.node);
+        errors += heap_errors(allocator);
+        errors += allocator.stats.free_node_count != 1 || allocator.stats.free_bytes != allocator.size;
+    }
+    CHECK(errors == 0);
+    CHECK(overlaps == 0);
+}
+
+static uint32_t blocks_in_use(const HeapPool& pool) {
+    uint32_t count = 0;
+    for (const HeapAllocator& block : pool.blocks) count += block.stats.allocation_count > 0;
+    return count;
+}
+
+// a failed resource creation gives its memory straight back, the pool's
+//   stats follow without waiting for a retire
+static void test_pool_free_now() {
+    HeapPool pool;
+    heap_pool_create(&pool, 64 * MB, 64 * KB);
+    HeapAllocation kept;
+    HeapAllocation failed;
+    heap_pool_allocate(&pool, 3 * MB, 64 * KB, &kept);
+    heap_pool_allocate(&pool, 5 * MB, 64 * KB, &failed);
+    CHECK(pool.stats.allocation_count == 2 && pool.stats.used_bytes == 8 * MB);
+
+    heap_pool_free_now(&pool, failed);
+    CHECK(pool.stats.allocation_count == 1 && pool.stats.used_bytes == 3 * MB);
+    CHECK(pool.stats.pending_frees == 0);
+    CHECK(heap_errors(pool.blocks[0]) == 0);
+
+    // & the space is there for the next one
+    HeapAllocation again;
+    heap_pool_allocate(&pool, 5 * MB, 64 * KB, &again);
+    CHECK(again.block == failed.block && again.offset == failed.offset);
+}
+
+// deferred frees & a defragment pass. moves have to go down (earlier block
+//   or lower in their own) & the tail of the pool has to empty out
+static void test_pool_defragment() {
+    std::mt19937_64 random(16);
+    HeapPool pool;
+    heap_pool_create(&pool, 64 * MB, 64 * KB);
+
+    std::vector<HeapAllocation> live;
+    uint64_t fence_value = 1;
+    auto free_random = [&]() {
+        size_t i = random() % live.size();
+        heap_pool_free(&pool, live[i], fence_value);
+        live[i] = live.back();
+        live.pop_back();
+    };
+    for (uint32_t i = 0; i < 50000; i++) {
+        if (random() % 100 < 52 || live.empty()) {
+            HeapAllocation allocation;
+            heap_pool_allocate(&pool, 64 * KB + random() % (8 * MB), 64 * KB, &allocation);
+            live.push_back(allocation);
+        } else {
+            free_random();
+        }
+        if (live.size() > 60) free_random();
+        if (i % 50 == 49) {
+            fence_value++;
+            heap_pool_retire(&pool, fence_value - 2);
+        }
+    }
+    heap_pool_retire(&pool, fence_value);
+    CHECK(pool.stats.pending_frees == 0);
+
+    uint32_t errors = 0;
+    for (const HeapAllocator& block : pool.blocks) errors += heap_errors(block);
+    float fragmentation_before = heap_pool_fragmentation(&pool);
+    uint32_t blocks_before = blocks_in_use(pool);
+
+    std::vector<HeapMove> moves;
+    heap_pool_defragment(&pool, 1000, &moves);
+    for (const HeapMove& move : moves) {
+        errors += move.to.block > move.from.block;
+        errors += move.to.block == move.from.block && move.to.offset + move.to.size > move.from.offset;
+        errors += move.to.size != move.from.size;
+        // the copy's recorded, its source goes once that frame's done
+        heap_pool_free(&pool, move.from, fence_value);
+    }
+    heap_pool_retire(&pool, fence_value);
+    for (const HeapAllocator& block : pool.blocks) errors += heap_errors(block);
+    CHECK(errors == 0);
+    CHECK(!moves.empty());
+    CHECK(blocks_in_use(pool) < blocks_before);
+    CHECK(heap_pool_fragmentation(&pool) <= fragmentation_before);
+
+    printf(
+        "pool: %u of %zu blocks in use -> %u after %zu moves, fragmentation %.1f%% -> %.1f%%\n",
+        blocks_before, pool.blocks.size(), blocks_in_use(pool), moves.size(),
+        fragmentation_before * 100.0f, heap_pool_fragmentation(&pool) * 100.0f
+    );
+}
+
+// free + allocate churn at ~70% of a 1 GB heap, 64 KB aligned like placed resources
+static void bench_churn() {
+    std::mt19937_64 random(17);
+    HeapAllocator allocator;
+    heap_allocator_create(&allocator, 1024 * MB, 4 * KB);
+
+    std::vector<uint64_t> sizes(1 << 16);
+    for (uint64_t& size : sizes) size = random() % 8 == 0 ? 1 * MB + random() % (8 * MB) : 4 * KB + random() % (256 * KB);
+    size_t next_size = 0;
+    std::vector<HeapAllocation> live;
+    while (allocator.stats.used_bytes < 700 * MB) {
+        HeapAllocation allocation;
+        heap_allocator_allocate(&allocator, sizes[next_size++ & 0xffff], 64 * KB, &allocation);
+        live.push_back(allocation);
+    }
+
+    constexpr uint32_t COUNT = 1000000;
+    uint32_t failures = 0;
+    size_t cursor = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        heap_allocator_free(&allocator, live[cursor].node);
+        if (!heap_allocator_allocate(&allocator, sizes[next_size++ & 0xffff], 64 * KB, &live[cursor])) {
+            failures++;
+            heap_allocator_allocate(&allocator, 64 * KB, 64 * KB, &live[cursor]);
+        }
+        cursor = (cursor + 7919) % live.size();
+    }
+    double seconds = test_seconds_since(start);
+    CHECK(heap_errors(allocator) == 0);
+
+    uint64_t largest = heap_allocator_largest_free(&allocator);
+    printf(
+        "%u free + allocate pairs: %.1f ns each, %u didn't fit, fragmentation %.1f%%\n",
+        COUNT, seconds * 1e9 / COUNT, failures, 100.0 * (1.0 - (double)largest / allocator.stats.free_bytes)
+    );
+}
+
+int main() {
+    test_merge_on_free();
+    test_random_single_block();
+    test_pool_free_now();
+    test_pool_defragment();
+    bench_churn();
+    return test_finish();
+}
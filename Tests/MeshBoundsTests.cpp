@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "MeshBounds.h"
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+struct Point { double x, y, z; };
+
+static Point operator-(const Point& a, const Point& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static Point operator+(const Point& a, const Point& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+static Point operator*(const Point& a, double s) { return { a.x * s, a.y * s, a.z * s }; }
+static double dot(const Point& a, const Point& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static Point cross(const Point& a, const Point& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+static Point to_point(const XMFLOAT3& p) { return { p.x, p.y, p.z }; }
+
+struct ReferenceSphere {
+    Point center;
+    double radius_sq;
+};
+
+static bool reference_contains(const ReferenceSphere& sphere, const Point& p) {
+    Point d = p - sphere.center;
+    return dot(d, d) <= sphere.radius_sq * (1.0 + 1e-12) + 1e-18;
+}
+
+static ReferenceSphere sphere_through(const Point& a, const Point& b) {
+    Point center = (a + b) * 0.5;
+    Point d = a - center;
+    return { center, dot(d, d) };
+}
+
+// circumcircle of the triangle, as a sphere
+static ReferenceSphere sphere_through(const Point& a, const Point& b, const Point& c) {
+    Point ab = b - a;
+    Point ac = c - a;
+    Point n = cross(ab, ac);
+    double denominator = 2.0 * dot(n, n);
+    if (denominator == 0.0) {
+        // collinear, the two far ends decide it
+        ReferenceSphere spheres[3] = { sphere_through(a, b), sphere_through(a, c), sphere_through(b, c) };
+        return *std::max_element(spheres, spheres + 3, [](const ReferenceSphere& x, const ReferenceSphere& y) { return x.radius_sq < y.radius_sq; });
+    }
+    Point offset = (cross(n, ab) * dot(ac, ac) + cross(ac, n) * dot(ab, ab)) * (1.0 / denominator);
+    return { a + offset, dot(offset, offset) };
+}
+
+static ReferenceSphere sphere_through(const Point& a, const Point& b, const Point& c, const Point& d) {
+    Point ab = b - a;
+    Point ac = c - a;
+    Point ad = d - a;
+    double determinant = dot(ab, cross(ac, ad));
+    if (determinant == 0.0) return sphere_through(a, b, c);
+    Point offset = (cross(ac, ad) * dot(ab, ab) + cross(ad, ab) * dot(ac, ac) + cross(ab, ac) * dot(ad, ad)) * (0.5 / determinant);
+    return { a + offset, dot(offset, offset) };
+}
+
+// exact minimum sphere, Welzl's incremental form in doubles. expected
+//   linear time on shuffled input
+static ReferenceSphere reference_welzl(std::vector<Point> points, std::mt19937* random) {
+    std::shuffle(points.begin(), points.end(), *random);
+    ReferenceSphere sphere = { points[0], 0.0 };
+    for (size_t i = 1; i < points.size(); i++) {
+        if (reference_contains(sphere, points[i])) continue;
+        sphere = { points[i], 0.0 };
+        for (size_t j = 0; j < i; j++) {
+            if (reference_contains(sphere, points[j])) continue;
+            sphere = sphere_through(points[i], points[j]);
+            for (size_t k = 0; k < j; k++) {
+                if (reference_contains(sphere, points[k])) continue;
+                sphere = sphere_through(points[i], points[j], points[k]);
+                for (size_t l = 0; l < k; l++) {
+                    if (reference_contains(sphere, points[l])) continue;
+                    sphere = sphere_through(points[i], points[j], points[k], points[l]);
+                }
+            }
+        }
+    }
+    return sphere;
+}
+
+struct Outside {
+    uint32_t aabb;
+    uint32_t sphere;
+    uint32_t obb;
+};
+
+// every vertex inside all three volumes, in doubles so the check doesn't
+//   round the way the bounds did
+static Outside count_outside(const std::vector<Vertex>& vertices, const MeshBounds& bounds) {
+    Outside outside = {};
+    XMFLOAT4X4 axes;
+    XMStoreFloat4x4(&axes, XMMatrixRotationQuaternion(XMLoadFloat4(&bounds.obb_orientation)));
+    Point center = to_point(bounds.obb_center);
+    Point sphere_center = to_point(bounds.sphere_center);
+    double radius = bounds.sphere_radius;
+    for (const Vertex& v : vertices) {
+        const XMFLOAT3& p = v.Position;
+        outside.aabb +=
+            p.x < bounds.aabb_min.x || p.y < bounds.aabb_min.y || p.z < bounds.aabb_min.z ||
+            p.x > bounds.aabb_max.x || p.y > bounds.aabb_max.y || p.z > bounds.aabb_max.z;
+        Point d = to_point(p) - sphere_center;
+        outside.sphere += dot(d, d) > radius * radius;
+        Point local = to_point(p) - center;
+        const float* extents = &bounds.obb_extents.x;
+        for (uint32_t a = 0; a < 3; a++) {
+            Point axis = { axes.m[a][0], axes.m[a][1], axes.m[a][2] };
+            if (fabs(dot(local, axis)) > extents[a]) {
+                outside.obb++;
+                break;
+            }
+        }
+    }
+    return outside;
+}
+
+static bool inside_all(const std::vector<Vertex>& vertices, const MeshBounds& bounds) {
+    Outside outside = count_outside(vertices, bounds);
+    return outside.aabb == 0 && outside.sphere == 0 && outside.obb == 0;
+}
+
+static std::vector<Vertex> vertices_from(const std::vector<XMFLOAT3>& positions) {
+    std::vector<Vertex> vertices(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) vertices[i].Position = positions[i];
+    return vertices;
+}
+
+static std::vector<Vertex> load_asset(const char* mesh) {
+    std::vector<Vertex> soup;
+    obj_parse_file(test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str()).c_str(), &soup);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, &vertices, &indices);
+    return vertices;
+}
+
+static const char* ASSETS[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+
+// degenerate inputs still get volumes that hold every vertex
+static void test_degenerate_containment() {
+    std::vector<std::vector<XMFLOAT3>> inputs = {
+        { XMFLOAT3(1.5f, -2.0f, 3.0f) },
+        std::vector<XMFLOAT3>(1000, XMFLOAT3(-4.0f, 0.25f, 7.0f)),
+        { XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 2.0f, 3.0f), XMFLOAT3(-1.0f, 5.0f, 0.5f) },
+    };
+    std::vector<XMFLOAT3> collinear;
+    std::vector<XMFLOAT3> planar;
+    std::mt19937 random(10);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (uint32_t i = 0; i < 5000; i++) {
+        float t = unit(random) * 10.0f;
+        collinear.push_back(XMFLOAT3(1.0f + t * 0.3f, -2.0f + t * 0.9f, 0.5f - t * 0.1f));
+        float u = unit(random) * 5.0f;
+        float v = unit(random) * 5.0f;
+        planar.push_back(XMFLOAT3(u * 0.6f + v * 0.0f, u * 0.8f + v * 0.6f, -v * 0.8f + 2.0f));
+    }
+    inputs.push_back(collinear);
+    inputs.push_back(planar);
+
+    uint32_t failed = 0;
+    for (const std::vector<XMFLOAT3>& positions : inputs) {
+        std::vector<Vertex> vertices = vertices_from(positions);
+        for (bool oriented_box : { false, true }) {
+            MeshBounds bounds;
+            mesh_bounds_compute(vertices.data(), (uint32_t)vertices.size(), oriented_box, &bounds);
+            failed += !inside_all(vertices, bounds);
+            failed += !std::isfinite(bounds.sphere_radius) || bounds.sphere_radius < 0.0f;
+        }
+    }
+    CHECK(failed == 0);
+
+    // a single point is its own AABB & a zero size sphere (bar the slack)
+    MeshBounds point_bounds;
+    std::vector<Vertex> point = vertices_from(inputs[0]);
+    mesh_bounds_compute(point.data(), 1, true, &point_bounds);
+    CHECK(point_bounds.aabb_min.x == 1.5f && point_bounds.aabb_max.z == 3.0f && point_bounds.sphere_radius < 1e-5f);
+}
+
+// the asset meshes, both with & without the box. the sphere prints against
+//   the exact one, so it's easy to see how close the cheap path gets
+static void test_asset_containment() {
+    std::mt19937 random(11);
+    for (const char* mesh : ASSETS) {
+        std::vector<Vertex> vertices = load_asset(mesh);
+        MeshBounds bounds;
+        mesh_bounds_compute(vertices.data(), (uint32_t)vertices.size(), true, &bounds);
+        CHECK(inside_all(vertices, bounds));
+        MeshBounds no_box;
+        mesh_bounds_compute(vertices.data(), (uint32_t)vertices.size(), false, &no_box);
+        CHECK(inside_all(vertices, no_box));
+
+        std::vector<Point> points;
+        for (const Vertex& v : vertices) points.push_back(to_point(v.Position));
+        double reference = sqrt(reference_welzl(points, &random).radius_sq);
+        double ratio = bounds.sphere_radius / reference;
+        CHECK(ratio >= 1.0 - 1e-6 && ratio < 1.02);
+        XMFLOAT3 size(bounds.aabb_max.x - bounds.aabb_min.x, bounds.aabb_max.y - bounds.aabb_min.y, bounds.aabb_max.z - bounds.aabb_min.z);
+        double aabb_volume = (double)size.x * size.y * size.z;
+        double obb_volume = 8.0 * bounds.obb_extents.x * bounds.obb_extents.y * bounds.obb_extents.z;
+        printf(
+            "%-18s %5zu verts  sphere %.4f of exact  OBB %.3f of AABB volume\n",
+            mesh, vertices.size(), ratio, aabb_volume > 0.0 ? obb_volume / aabb_volume : 1.0
+        );
+    }
+}
+
+// random clouds of every shape: the sphere is never smaller than the exact
+//   one & at most a little bigger
+static void test_sphere_against_welzl() {
+    std::mt19937 random(12);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    double worst = 1.0;
+    uint32_t failed = 0;
+    for (uint32_t cloud = 0; cloud < 40; cloud++) {
+        uint32_t count = 100 + random() % 20000;
+        std::vector<XMFLOAT3> positions(count);
+        for (XMFLOAT3& p : positions) {
+            switch (cloud % 4) {
+            // cube
+            case 0: p = XMFLOAT3(unit(random), unit(random), unit(random)); break;
+            // gaussian blob, stretched
+            case 1: p = XMFLOAT3(normal(random) * 3.0f, normal(random), normal(random) * 0.5f); break;
+            // sphere shell, every point on the answer
+            case 2: {
+                float x = normal(random), y = normal(random), z = normal(random);
+                float length = sqrtf(x * x + y * y + z * z) + 1e-20f;
+                p = XMFLOAT3(x / length, y / length, z / length);
+                break;
+            }
+            // a few tight clusters far apart, offset from the origin
+            default: {
+                uint32_t cluster = random() % 5;
+                p = XMFLOAT3(100.0f + cluster * 7.0f + unit(random) * 0.1f, -50.0f + (cluster * cluster) * 1.3f + unit(random) * 0.1f, unit(random) * 0.1f);
+                break;
+            }
+            }
+        }
+        std::vector<Vertex> vertices = vertices_from(positions);
+        MeshBounds bounds;
+        mesh_bounds_compute(vertices.data(), count, false, &bounds);
+        failed += !inside_all(vertices, bounds);
+
+        std::vector<Point> points;
+        for (const XMFLOAT3& p : positions) points.push_back(to_point(p));
+        double ratio = bounds.sphere_radius / sqrt(reference_welzl(points, &random).radius_sq);
+        failed += ratio < 1.0 - 1e-6 || ratio > 1.02;
+        worst = ratio > worst ? ratio : worst;
+    }
+    CHECK(failed == 0);
+    printf("40 random clouds: sphere at most %.5f of the exact radius\n", worst);
+}
+
+static XMMATRIX random_world(std::mt19937* random) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+    XMVECTOR q = XMQuaternionNormalize(XMVectorSet(unit(*random), unit(*random), unit(*random), unit(*random) + 1e-3f));
+    XMMATRIX world = XMMatrixRotationQuaternion(q);
+    world.r[0] = world.r[0] * scale(*random);
+    world.r[1] = world.r[1] * scale(*random);
+    world.r[2] = world.r[2] * scale(*random);
+    world.r[3] = XMVectorSet(unit(*random) * 100.0f, unit(*random) * 100.0f, unit(*random) * 100.0f, 1.0f);
+    return world;
+}
+
+// the assets & a rotated slab under random rotation, non-uniform scale &
+//   translation: every transformed vertex inside the world AABB & sphere.
+//   prints how much the OBB tightens the world AABB over the AABB alone
+static void test_world_containment() {
+    std::vector<std::vector<Vertex>> meshes;
+    for (const char* mesh : ASSETS) meshes.push_back(load_asset(mesh));
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<XMFLOAT3> slab(4000);
+    XMMATRIX tilt = XMMatrixRotationQuaternion(XMQuaternionNormalize(XMVectorSet(0.3f, 0.5f, 0.2f, 0.8f)));
+    for (XMFLOAT3& p : slab) XMStoreFloat3(&p, XMVector3TransformNormal(XMVectorSet(unit(random) * 5.0f, unit(random) * 0.1f, unit(random) * 2.0f, 0.0f), tilt));
+    meshes.push_back(vertices_from(slab));
+
+    uint32_t outside = 0;
+    double tightened = 0.0;
+    uint32_t transforms = 0;
+    for (const std::vector<Vertex>& vertices : meshes) {
+        MeshBounds bounds;
+        mesh_bounds_compute(vertices.data(), (uint32_t)vertices.size(), true, &bounds);
+        MeshBounds aabb_only = bounds;
+        aabb_only.obb_center = XMFLOAT3(
+            (bounds.aabb_min.x + bounds.aabb_max.x) * 0.5f, (bounds.aabb_min.y + bounds.aabb_max.y) * 0.5f, (bounds.aabb_min.z + bounds.aabb_max.z) * 0.5f
+        );
+        aabb_only.obb_extents = XMFLOAT3(
+            (bounds.aabb_max.x - bounds.aabb_min.x) * 0.5f, (bounds.aabb_max.y - bounds.aabb_min.y) * 0.5f, (bounds.aabb_max.z - bounds.aabb_min.z) * 0.5f
+        );
+        aabb_only.obb_orientation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+
+        for (uint32_t t = 0; t < 50; t++) {
+            XMMATRIX world = random_world(&random);
+            WorldBounds world_bounds = mesh_bounds_transform(bounds, world);
+            WorldBounds loose = mesh_bounds_transform(aabb_only, world);
+            XMFLOAT4X4 m;
+            XMStoreFloat4x4(&m, world);
+
+            // float transforms on the bounds' side, so allow their rounding
+            Point size = to_point(world_bounds.aabb_max) - to_point(world_bounds.aabb_min);
+            double slack = 1e-5 * (sqrt(dot(size, size)) + fabs(m._41) + fabs(m._42) + fabs(m._43));
+            Point sphere_center = to_point(world_bounds.sphere_center);
+            for (const Vertex& v : vertices) {
+                const XMFLOAT3& p = v.Position;
+                Point w = {
+                    p.x * (double)m._11 + p.y * (double)m._21 + p.z * (double)m._31 + m._41,
+                    p.x * (double)m._12 + p.y * (double)m._22 + p.z * (double)m._32 + m._42,
+                    p.x * (double)m._13 + p.y * (double)m._23 + p.z * (double)m._33 + m._43,
+                };
+                bool in_aabb =
+                    w.x >= world_bounds.aabb_min.x - slack && w.y >= world_bounds.aabb_min.y - slack && w.z >= world_bounds.aabb_min.z - slack &&
+                    w.x <= world_bounds.aabb_max.x + slack && w.y <= world_bounds.aabb_max.y + slack && w.z <= world_bounds.aabb_max.z + slack;
+                Point d = w - sphere_center;
+                bool in_sphere = sqrt(dot(d, d)) <= world_bounds.sphere_radius + slack;
+                outside += !in_aabb || !in_sphere;
+            }
+
+            Point loose_size = to_point(loose.aabb_max) - to_point(loose.aabb_min);
+            double loose_volume = loose_size.x * loose_size.y * loose_size.z;
+            if (loose_volume > 0.0) {
+                tightened += size.x * size.y * size.z / loose_volume;
+                transforms++;
+            }
+        }
+    }
+    CHECK(outside == 0);
+    printf("world AABB with the OBB: %.2f of the AABB-only volume over %u transforms\n", tightened / transforms, transforms);
+}
+
+// 10M verts in a noisy ellipsoid, what a big scanned mesh looks like
+static void bench_10m() {
+    constexpr uint32_t COUNT = 10000000;
+    std::vector<Vertex> vertices(COUNT);
+    std::mt19937 random(14);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (Vertex& v : vertices) {
+        float x = unit(random), y = unit(random), z = unit(random);
+        float length = sqrtf(x * x + y * y + z * z) + 1e-6f;
+        float r = 1.0f + unit(random) * 0.05f;
+        v.Position = XMFLOAT3(x / length * r * 4.0f, y / length * r * 2.0f, z / length * r + 10.0f);
+    }
+
+    // the scalar loop loading used to run
+    auto start = std::chrono::high_resolution_clock::now();
+    XMFLOAT3 min = vertices[0].Position;
+    XMFLOAT3 max = vertices[0].Position;
+    for (const Vertex& v : vertices) {
+        min.x = v.Position.x < min.x ? v.Position.x : min.x;
+        min.y = v.Position.y < min.y ? v.Position.y : min.y;
+        min.z = v.Position.z < min.z ? v.Position.z : min.z;
+        max.x = v.Position.x > max.x ? v.Position.x : max.x;
+        max.y = v.Position.y > max.y ? v.Position.y : max.y;
+        max.z = v.Position.z > max.z ? v.Position.z : max.z;
+    }
+    double scalar_seconds = test_seconds_since(start);
+
+    MeshBounds bounds;
+    MeshBoundsStats stats;
+    mesh_bounds_compute(vertices.data(), COUNT, false, &bounds, &stats);
+    CHECK(bounds.aabb_min.x == min.x && bounds.aabb_max.z == max.z);
+    MeshBounds boxed;
+    MeshBoundsStats boxed_stats;
+    mesh_bounds_compute(vertices.data(), COUNT, true, &boxed, &boxed_stats);
+    Outside outside = count_outside(vertices, boxed);
+    CHECK(outside.aabb == 0 && outside.sphere == 0 && outside.obb == 0);
+    printf(
+        "10M verts on %u threads: AABB + sphere %.0f ms, with the OBB %.0f ms (scalar AABB loop %.0f ms)\n",
+        stats.thread_count, stats.seconds * 1e3, boxed_stats.seconds * 1e3, scalar_seconds * 1e3
+    );
+}
+
+int main() {
+    test_degenerate_containment();
+    test_asset_containment();
+    test_sphere_against_welzl();
+    test_world_containment();
+    bench_10m();
+    return test_finish();
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MeshCooker.h"
+#include "TestCheck.h"
+
+using namespace DirectX;
+
+// worst round trip error GPUVertexLayout is allowed on the assets. positions
+//   & UVs get half a unorm16 step per axis across their range, the rest is absolute
+constexpr float MAX_NORMAL_ERROR = 1e-3f;
+constexpr float MAX_TANGENT_ERROR = 1e-3f;
+
+static bool build_asset(const char* mesh, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices, std::vector<MeshLod>* lods,
+                        std::vector<Meshlet>* meshlets, std::vector<MeshSegment>* segments, MeshBounds* bounds, MeshBuildStats* stats) {
+    std::string path = test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str());
+    MappedFile source;
+    if (!mapped_file_open(path.c_str(), &source)) return false;
+    mesh_build((const char*)source.data, source.size, 0.0f, TANGENT_MODE_FAST, vertices, indices, lods, meshlets, segments, bounds, stats);
+    mapped_file_close(&source);
+    return true;
+}
+
+static void test_layout_error() {
+    const char* meshes[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+    printf("%-18s %7s %10s %10s %9s %9s %3s  (%u byte verts)\n", "", "verts", "position", "uv", "normal°", "tangent°", "hd", GPUVertexLayout::STRIDE);
+    for (const char* mesh : meshes) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<MeshLod> lods;
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshSegment> segments;
+        MeshBounds bounds;
+        MeshBuildStats stats = {};
+        CHECK(build_asset(mesh, &vertices, &indices, &lods, &meshlets, &segments, &bounds, &stats));
+
+        VertexEncodeParams params = vertex_encode_params_create(vertices.data(), (uint32_t)vertices.size(), bounds.aabb_min, bounds.aabb_max);
+        float max_position_error = XMVectorGetX(XMVector3Length(XMLoadFloat3(&params.position_scale))) * 0.5f / 65535.0f;
+        float max_uv_error = XMVectorGetX(XMVector2Length(XMLoadFloat2(&params.uv_scale))) * 0.5f / 65535.0f;
+        const VertexLayoutError& error = stats.layout_error;
+        CHECK(error.position <= max_position_error * 1.01f);
+        CHECK(error.uv <= max_uv_error * 1.01f);
+        CHECK(error.normal_angle <= MAX_NORMAL_ERROR);
+        CHECK(error.tangent_angle <= MAX_TANGENT_ERROR);
+        CHECK(error.handedness_mismatches == 0);
+        printf(
+            "%-18s %7zu %10.2e %10.2e %9.4f %9.4f %3u\n",
+            mesh, vertices.size(), error.position, error.uv,
+            XMConvertToDegrees(error.normal_angle), XMConvertToDegrees(error.tangent_angle), error.handedness_mismatches
+        );
+    }
+}
+
+// whatever mesh_build hands over has to come back out of the cache ready to upload
+static void test_cooked_round_trip() {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshSegment> segments;
+    MeshBounds bounds;
+    CHECK(build_asset("torus", &vertices, &indices, &lods, &meshlets, &segments, &bounds, nullptr));
+
+    std::string path = (std::filesystem::temp_directory_path() / "mesh_cooker_test.mesh").string();
+    bool written = cooked_mesh_write(
+        path.c_str(), 1234, 0.0f, TANGENT_MODE_FAST,
+        vertices.data(), (uint32_t)vertices.size(),
+        indices.data(), (uint32_t)indices.size(),
+        lods.data(), (uint32_t)lods.size(),
+        meshlets.data(), (uint32_t)meshlets.size(),
+        segments.data(), (uint32_t)segments.size(),
+        &bounds
+    );
+    CHECK(written);
+
+    CookedMesh cooked;
+    CHECK(!cooked_mesh_open(path.c_str(), 4321, 0.0f, TANGENT_MODE_FAST, &cooked));
+    CHECK(!cooked_mesh_open(path.c_str(), 1234, 0.0f, TANGENT_MODE_MIKKTSPACE, &cooked));
+    if (CHECK(cooked_mesh_open(path.c_str(), 1234, 0.0f, TANGENT_MODE_FAST, &cooked))) {
+        CHECK(cooked.header->vertex_count == vertices.size());
+        CHECK(cooked.header->index_count == indices.size());
+        CHECK(cooked.header->lod_count == lods.size());
+        // verts come back encoded, the same way Mesh would have encoded them
+        VertexEncodeParams params = vertex_encode_params_create(vertices.data(), (uint32_t)vertices.size(), bounds.aabb_min, bounds.aabb_max);
+        std::vector<uint8_t> encoded(vertices.size() * GPUVertexLayout::STRIDE);
+        GPUVertexLayout::encode(vertices.data(), (uint32_t)vertices.size(), params, encoded.data());
+        CHECK(cooked.header->vertex_stride == GPUVertexLayout::STRIDE);
+        CHECK(memcmp(&cooked.header->encode_params, &params, sizeof(params)) == 0);
+        CHECK(memcmp(cooked.vertices, encoded.data(), encoded.size()) == 0);
+        CHECK(memcmp(cooked.lods, lods.data(), lods.size() * sizeof(MeshLod)) == 0);
+        CHECK(memcmp(&cooked.header->bounds, &bounds, sizeof(bounds)) == 0);
+        cooked_mesh_close(&cooked);
+    }
+    std::filesystem::remove(path);
+}
+
+int main() {
+    test_layout_error();
+    test_cooked_round_trip();
+    return test_finish();
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+// sorted triangles by position, so reorders & remaps can be compared
+//   against where the mesh started
+static std::vector<std::array<float, 9>> triangle_set(const Vertex* vertices, const uint32_t* indices, size_t index_count) {
+    std::vector<std::array<float, 9>> triangles(index_count / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            const XMFLOAT3& p = vertices[indices[t * 3 + c]].Position;
+            triangles[t][c * 3 + 0] = p.x;
+            triangles[t][c * 3 + 1] = p.y;
+            triangles[t][c * 3 + 2] = p.z;
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+struct OptimizeReport {
+    VertexCacheStats cache_before;
+    VertexCacheStats cache_after;
+    VertexFetchStats fetch_before;
+    // triangles reordered but the verts still where they were
+    VertexFetchStats fetch_unmapped;
+    VertexFetchStats fetch_after;
+    uint32_t cluster_count;
+    double seconds;
+};
+
+// the same passes, in the same order, as mesh_build runs them
+static OptimizeReport optimize(std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) {
+    OptimizeReport report = {};
+    uint32_t vertex_count = (uint32_t)vertices->size();
+    report.cache_before = analyze_vertex_cache(indices->data(), indices->size(), vertex_count);
+    report.fetch_before = analyze_vertex_fetch(indices->data(), indices->size(), vertex_count, sizeof(Vertex));
+
+    std::vector<std::array<float, 9>> before = triangle_set(vertices->data(), indices->data(), indices->size());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint32_t> cluster_starts;
+    optimize_vertex_cache(indices->data(), indices->size(), vertex_count, &cluster_starts);
+    optimize_overdraw(indices->data(), indices->size(), vertices->data(), vertex_count, cluster_starts);
+    report.seconds = test_seconds_since(start);
+
+    report.fetch_unmapped = analyze_vertex_fetch(indices->data(), indices->size(), vertex_count, sizeof(Vertex));
+
+    start = std::chrono::high_resolution_clock::now();
+    vertex_count = optimize_vertex_fetch(vertices->data(), vertex_count, indices->data(), indices->size());
+    vertices->resize(vertex_count);
+    report.seconds += test_seconds_since(start);
+    report.cluster_count = (uint32_t)cluster_starts.size();
+
+    report.cache_after = analyze_vertex_cache(indices->data(), indices->size(), vertex_count);
+    report.fetch_after = analyze_vertex_fetch(indices->data(), indices->size(), vertex_count, sizeof(Vertex));
+
+    // nothing gets added, lost or rewound along the way
+    CHECK(triangle_set(vertices->data(), indices->data(), indices->size()) == before);
+    return report;
+}
+
+static void print_report(const char* name, size_t triangle_count, const OptimizeReport& report) {
+    printf(
+        "%-18s %8zu  acmr %5.3f -> %5.3f  atvr %5.3f -> %5.3f  overfetch %5.3f -> %5.3f  %5u clusters %8.3f ms\n",
+        name, triangle_count,
+        report.cache_before.acmr, report.cache_after.acmr,
+        report.cache_before.atvr, report.cache_after.atvr,
+        report.fetch_before.overfetch, report.fetch_after.overfetch,
+        report.cluster_count, report.seconds * 1000.0
+    );
+}
+
+static void test_assets() {
+    const char* meshes[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+    for (const char* mesh : meshes) {
+        std::vector<Vertex> soup;
+        obj_parse_file(test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str()).c_str(), &soup);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, &vertices, &indices);
+
+        OptimizeReport report = optimize(&vertices, &indices);
+        print_report(mesh, indices.size() / 3, report);
+
+        // the cache order can't be worse than the OBJ's face order. it can cost
+        //   some fetch locality over an OBJ that happened to be linear (the
+        //   torus), the remap just has to win back what it can of that
+        CHECK(report.cache_after.acmr <= report.cache_before.acmr + 1e-3f);
+        CHECK(report.fetch_after.bytes_fetched <= report.fetch_unmapped.bytes_fetched);
+        CHECK(report.fetch_after.overfetch < 1.35f);
+    }
+}
+
+// a grid with its triangles shuffled is about as bad as an index buffer gets,
+//   so the gains are easy to see (& easy to lose in a regression)
+static void test_shuffled_grid() {
+    constexpr uint32_t SIDE = 256;
+    std::vector<Vertex> vertices(SIDE * SIDE);
+    for (uint32_t y = 0; y < SIDE; y++) {
+        for (uint32_t x = 0; x < SIDE; x++) {
+            Vertex& v = vertices[y * SIDE + x];
+            v = {};
+            v.Position = XMFLOAT3((float)x, 0.0f, (float)y);
+            v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y + 1 < SIDE; y++) {
+        for (uint32_t x = 0; x + 1 < SIDE; x++) {
+            uint32_t i = y * SIDE + x;
+            triangles.push_back({ i, i + SIDE, i + 1 });
+            triangles.push_back({ i + 1, i + SIDE, i + SIDE + 1 });
+        }
+    }
+    std::mt19937 random(1234);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    std::vector<uint32_t> indices;
+    for (const std::array<uint32_t, 3>& triangle : triangles) {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    OptimizeReport report = optimize(&vertices, &indices);
+    print_report("shuffled grid", triangles.size(), report);
+
+    CHECK(report.cache_before.acmr > 2.5f);
+    CHECK(report.cache_after.acmr < 0.8f);
+    CHECK(report.cache_after.atvr < 1.6f);
+    CHECK(report.fetch_after.overfetch < 1.5f);
+}
+
+int main() {
+    test_assets();
+    test_shuffled_grid();
+    return test_finish();
+}
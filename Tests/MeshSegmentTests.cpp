@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "MeshCooker.h"
+#include "MeshSegment.h"
+#include "TestCheck.h"
+
+using namespace DirectX;
+
+// a UV sphere as OBJ text, the seam column & every pole vertex has its own
+//   UV. the quads at the poles are really triangles, so one pole vertex on
+//   each end goes unused: (stacks + 1) * (slices + 1) - 2 verts once welded
+static std::string sphere_obj(uint32_t stacks, uint32_t slices) {
+    std::string obj;
+    char line[128];
+    for (uint32_t y = 0; y <= stacks; y++) {
+        float theta = XM_PI * y / stacks;
+        for (uint32_t x = 0; x <= slices; x++) {
+            float phi = XM_2PI * x / slices;
+            float nx = sinf(theta) * cosf(phi);
+            float ny = cosf(theta);
+            float nz = sinf(theta) * sinf(phi);
+            snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", nx, ny, nz, (float)x / slices, (float)y / stacks, nx, ny, nz);
+            obj += line;
+        }
+    }
+    auto corner = [&](uint32_t x, uint32_t y) { return y * (slices + 1) + x + 1; };
+    for (uint32_t y = 0; y < stacks; y++) {
+        for (uint32_t x = 0; x < slices; x++) {
+            uint32_t a = corner(x, y), b = corner(x + 1, y), c = corner(x, y + 1), d = corner(x + 1, y + 1);
+            if (y != 0) {
+                snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, d, d, d);
+                obj += line;
+            }
+            if (y != stacks - 1) {
+                snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, d, d, d, c, c, c);
+                obj += line;
+            }
+        }
+    }
+    return obj;
+}
+
+struct RangeCheck {
+    uint32_t ranges;
+    uint32_t draws;
+    // indices that fetch different vertex data than the 32 bit buffer did
+    uint32_t mismatched;
+    // draws that cross a segment or don't tile the range exactly
+    uint32_t bad_draws;
+};
+
+// draws a range the way Mesh::draw does & fetches every vertex the GPU
+//   would through the 16 bit indices, comparing against the 32 bit ones
+static void check_range(
+    const std::vector<Vertex>& original_vertices,
+    const std::vector<uint32_t>& original_indices,
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint16_t>& narrow_indices,
+    const std::vector<MeshSegment>& segments,
+    uint32_t first_index,
+    uint32_t index_count,
+    RangeCheck* check
+) {
+    check->ranges++;
+    uint32_t cursor = first_index;
+    mesh_segment_draws(segments.data(), (uint32_t)segments.size(), first_index, index_count, [&](uint32_t start, uint32_t count, uint32_t base_vertex) {
+        check->draws++;
+        const MeshSegment& segment = segments[mesh_find_segment(segments.data(), (uint32_t)segments.size(), start)];
+        check->bad_draws += start != cursor || segment.base_vertex != base_vertex ||
+            start + count > segment.first_index + segment.index_count;
+        cursor = start + count;
+        for (uint32_t i = start; i < start + count; i++) {
+            uint32_t fetched = narrow_indices[i] + base_vertex;
+            check->mismatched += fetched >= vertices.size() ||
+                memcmp(&vertices[fetched], &original_vertices[original_indices[i]], sizeof(Vertex)) != 0;
+        }
+    });
+    check->bad_draws += cursor != first_index + index_count;
+}
+
+// the 181k vertex sphere. at the cooked vertex size splitting copies
+//   nearly as many bytes as the halved indices save, so it stays 32 bit.
+//   with small enough verts it splits, & then every LOD, every meshlet &
+//   2000 random ranges drawn through the segments fetch exactly what the
+//   32 bit indices did
+static void test_big_sphere() {
+    std::string obj = sphere_obj(300, 600);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshSegment> segments;
+    MeshBounds bounds;
+    MeshBuildStats stats = {};
+    mesh_build(obj.data(), obj.size(), 0.0f, TANGENT_MODE_FAST, &vertices, &indices, &lods, &meshlets, &segments, &bounds, &stats);
+    CHECK(vertices.size() == 301 * 601 - 2 && vertices.size() > MESH_SEGMENT_MAX_VERTICES);
+    CHECK(segments.empty() && stats.unsplit_vertex_count == vertices.size());
+
+    // what the split would have cost, with the same LODs at the cooked stride
+    std::vector<Vertex> split_vertices = vertices;
+    std::vector<uint32_t> split_indices = indices;
+    CHECK(!mesh_split_segments(&split_vertices, &split_indices, lods.data(), (uint32_t)lods.size(), GPUVertexLayout::STRIDE, &segments));
+    CHECK(split_vertices.size() == vertices.size() && split_indices == indices && segments.empty());
+
+    const uint32_t small_stride = 4;
+    CHECK(mesh_split_segments(&split_vertices, &split_indices, lods.data(), (uint32_t)lods.size(), small_stride, &segments));
+    double copied_mb = (double)(split_vertices.size() - vertices.size()) * GPUVertexLayout::STRIDE / (1024.0 * 1024.0);
+    double saved_mb = (double)indices.size() * sizeof(uint16_t) / (1024.0 * 1024.0);
+    printf(
+        "%zu vert sphere, %zu LODs: split to %zu verts in %zu segments, at %u byte verts +%.1f MB of copies for %.1f MB "
+        "of index bytes (%.0f%% net), kept 32 bit\n",
+        vertices.size(), lods.size(), split_vertices.size(), segments.size(), GPUVertexLayout::STRIDE, copied_mb, saved_mb,
+        100.0 * (saved_mb - copied_mb) / saved_mb
+    );
+    CHECK(copied_mb > saved_mb * (1.0 - MESH_SEGMENT_MIN_NET_SAVING));
+
+    std::vector<uint16_t> narrow_indices(split_indices.size());
+    mesh_narrow_indices(split_indices.data(), segments.data(), (uint32_t)segments.size(), narrow_indices.data());
+
+    // segments tile the buffer, sorted, each addressable with 16 bits
+    uint32_t bad_segments = 0;
+    uint32_t next_index = 0;
+    for (const MeshSegment& segment : segments) {
+        bad_segments += segment.first_index < next_index;
+        next_index = segment.first_index + segment.index_count;
+        uint32_t highest = 0;
+        for (uint32_t i = segment.first_index; i < segment.first_index + segment.index_count; i++) {
+            bad_segments += split_indices[i] < segment.base_vertex;
+            highest = split_indices[i] - segment.base_vertex > highest ? split_indices[i] - segment.base_vertex : highest;
+        }
+        bad_segments += highest >= MESH_SEGMENT_MAX_VERTICES;
+    }
+    CHECK(bad_segments == 0);
+
+    RangeCheck lod_check = {};
+    for (const MeshLod& lod : lods) check_range(vertices, indices, split_vertices, narrow_indices, segments, lod.first_index, lod.index_count, &lod_check);
+    CHECK(lod_check.mismatched == 0 && lod_check.bad_draws == 0);
+
+    RangeCheck meshlet_check = {};
+    for (const Meshlet& meshlet : meshlets) check_range(vertices, indices, split_vertices, narrow_indices, segments, meshlet.first_index, meshlet.index_count, &meshlet_check);
+    CHECK(meshlet_check.mismatched == 0 && meshlet_check.bad_draws == 0);
+
+    std::mt19937 random(8);
+    RangeCheck random_check = {};
+    uint32_t triangle_count = (uint32_t)indices.size() / 3;
+    for (uint32_t r = 0; r < 2000; r++) {
+        uint32_t first = random() % triangle_count;
+        uint32_t count = 1 + random() % (r % 10 == 0 ? triangle_count - first : (triangle_count - first < 5000 ? triangle_count - first : 5000));
+        check_range(vertices, indices, split_vertices, narrow_indices, segments, first * 3, count * 3, &random_check);
+    }
+    CHECK(random_check.mismatched == 0 && random_check.bad_draws == 0);
+    printf(
+        "%u LODs, %u meshlets, %u random ranges all match 32 bit, %.2f draws per random range\n",
+        lod_check.ranges, meshlet_check.ranges, random_check.ranges, (double)random_check.draws / random_check.ranges
+    );
+}
+
+// LOD 0 on its own only copies the verts segments share, that's well worth it
+static void test_split_pays_off() {
+    std::string obj = sphere_obj(300, 600);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshSegment> segments;
+    MeshBounds bounds;
+    mesh_build(obj.data(), obj.size(), 0.0f, TANGENT_MODE_FAST, &vertices, &indices, &lods, &meshlets, &segments, &bounds);
+    indices.resize(lods[0].index_count);
+    std::vector<Vertex> original_vertices = vertices;
+    std::vector<uint32_t> original_indices = indices;
+    CHECK(mesh_split_segments(&vertices, &indices, nullptr, 0, GPUVertexLayout::STRIDE, &segments));
+    CHECK(vertices.size() < original_vertices.size() * 5 / 4 && segments.size() >= 3);
+    printf("LOD 0 alone: %zu verts split to %zu in %zu segments\n", original_vertices.size(), vertices.size(), segments.size());
+
+    std::vector<uint16_t> narrow_indices(indices.size());
+    mesh_narrow_indices(indices.data(), segments.data(), (uint32_t)segments.size(), narrow_indices.data());
+    RangeCheck check = {};
+    check_range(original_vertices, original_indices, vertices, narrow_indices, segments, 0, (uint32_t)indices.size(), &check);
+    CHECK(check.mismatched == 0 && check.bad_draws == 0 && check.draws == segments.size());
+}
+
+// small meshes are one segment at base 0, the search clamps to either end
+static void test_single_segment_and_search() {
+    std::vector<MeshSegment> segments;
+    CHECK(mesh_build_segments(MESH_SEGMENT_MAX_VERTICES, 300, &segments) && segments.size() == 1 && segments[0].index_count == 300);
+    CHECK(!mesh_build_segments(MESH_SEGMENT_MAX_VERTICES + 1, 300, &segments) && segments.empty());
+
+    MeshSegment sorted[] = { { 0, 30, 0, 0 }, { 30, 60, 100, 0 }, { 90, 3, 200, 0 } };
+    CHECK(mesh_find_segment(sorted, 3, 0) == 0 && mesh_find_segment(sorted, 3, 29) == 0);
+    CHECK(mesh_find_segment(sorted, 3, 30) == 1 && mesh_find_segment(sorted, 3, 89) == 1);
+    CHECK(mesh_find_segment(sorted, 3, 90) == 2 && mesh_find_segment(sorted, 3, 1000) == 2);
+
+    // a range over all three comes back clipped to each
+    uint32_t draws = 0;
+    uint32_t total = 0;
+    mesh_segment_draws(sorted, 3, 27, 66, [&](uint32_t start, uint32_t count, uint32_t base_vertex) {
+        CHECK(base_vertex == sorted[draws].base_vertex && start == (draws == 0 ? 27u : sorted[draws].first_index));
+        draws++;
+        total += count;
+    });
+    CHECK(draws == 3 && total == 66);
+}
+
+int main() {
+    test_single_segment_and_search();
+    test_big_sphere();
+    test_split_pays_off();
+    return test_finish();
+}
@@ -0,0 +1,282 @@
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MeshLod.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+static std::vector<float> position_key(const Vertex& v) {
+    return { v.Position.x, v.Position.y, v.Position.z };
+}
+
+// what mesh_simplify must leave alone, worked out the slow way: positions
+//   whose wedges disagree on UV or bend their normal past ~45 degrees, &
+//   both ends of every edge without an opposite half edge
+static std::vector<uint8_t> reference_locked(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    std::map<std::vector<float>, uint32_t> firsts;
+    std::vector<uint32_t> positions(vertices.size());
+    for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) {
+        positions[v] = firsts.try_emplace(position_key(vertices[v]), v).first->second;
+    }
+
+    std::set<uint32_t> locked_positions;
+    for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) {
+        const Vertex& a = vertices[v];
+        const Vertex& b = vertices[positions[v]];
+        float dot = a.Normal.x * b.Normal.x + a.Normal.y * b.Normal.y + a.Normal.z * b.Normal.z;
+        if (memcmp(&a.UV, &b.UV, sizeof(XMFLOAT2)) != 0 || dot < 0.7f) locked_positions.insert(positions[v]);
+    }
+
+    std::set<std::pair<uint32_t, uint32_t>> half_edges;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (uint32_t e = 0; e < 3; e++) half_edges.insert({ positions[indices[i + e]], positions[indices[i + (e + 1) % 3]] });
+    }
+    for (const std::pair<uint32_t, uint32_t>& edge : half_edges) {
+        if (!half_edges.count({ edge.second, edge.first })) {
+            locked_positions.insert(edge.first);
+            locked_positions.insert(edge.second);
+        }
+    }
+
+    std::vector<uint8_t> locked(vertices.size());
+    for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) locked[v] = (uint8_t)locked_positions.count(positions[v]);
+    return locked;
+}
+
+struct LodCheck {
+    // indices past the vertex buffer
+    uint32_t out_of_range;
+    // locked positions LOD 0 draws that a coarser LOD doesn't. a wedge can
+    //   lose all its triangles to collapses around it, its position can't
+    uint32_t locked_lost;
+    // LODs that don't cut at least MESH_LOD_MIN_REDUCTION off the one before
+    uint32_t too_small_steps;
+};
+
+static LodCheck check_lods(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& lod_indices, const std::vector<MeshLod>& lods, const std::vector<uint8_t>& locked) {
+    LodCheck check = {};
+    std::set<std::vector<float>> locked_positions;
+    for (uint32_t i = 0; i < lods[0].index_count; i++) {
+        uint32_t index = lod_indices[lods[0].first_index + i];
+        if (locked[index]) locked_positions.insert(position_key(vertices[index]));
+    }
+
+    for (uint32_t l = 0; l < (uint32_t)lods.size(); l++) {
+        std::set<std::vector<float>> positions;
+        for (uint32_t i = 0; i < lods[l].index_count; i++) {
+            uint32_t index = lod_indices[lods[l].first_index + i];
+            if (index >= vertices.size()) check.out_of_range++;
+            else positions.insert(position_key(vertices[index]));
+        }
+        for (const std::vector<float>& position : locked_positions) check.locked_lost += !positions.count(position);
+        if (l > 0 && lods[l].index_count > lods[l - 1].index_count * (1.0f - MESH_LOD_MIN_REDUCTION)) check.too_small_steps++;
+    }
+    return check;
+}
+
+// the whole chain on every asset: per level triangle counts & error on the
+//   way, LODs packed back to back with LOD 0 untouched, indices in range,
+//   every level a real step down, error capped & growing, seams, hard
+//   normals & borders all still there
+static void bench_assets() {
+    // triangles per level. the cube, cylinder & quads are all hard edges,
+    //   seams & borders so nothing collapses
+    const std::map<std::string, std::vector<uint32_t>> expected_triangles = {
+        { "cube", { 24 } },
+        { "cylinder", { 124 } },
+        { "helix", { 4824, 2384, 1512 } },
+        { "quad", { 2 } },
+        { "quad_double_sided", { 4 } },
+        { "sphere", { 960, 480, 240, 120, 60 } },
+        { "torus", { 1600, 800, 400, 200, 152 } },
+    };
+    for (const auto& [mesh, expected] : expected_triangles) {
+        std::vector<Vertex> soup;
+        obj_parse_file(test_asset_path(("Meshes/" + mesh + ".obj").c_str()).c_str(), &soup);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, &vertices, &indices);
+
+        std::vector<uint32_t> lod_indices;
+        std::vector<MeshLod> lods;
+        auto start = std::chrono::high_resolution_clock::now();
+        mesh_build_lods(vertices.data(), (uint32_t)vertices.size(), indices.data(), indices.size(), &lod_indices, &lods);
+        double seconds = test_seconds_since(start);
+
+        CHECK(!lods.empty() && lods.size() <= MESH_MAX_LODS);
+        CHECK(lods[0].first_index == 0 && lods[0].error == 0.0f);
+        CHECK(std::vector<uint32_t>(lod_indices.begin(), lod_indices.begin() + lods[0].index_count) == indices);
+        uint32_t packed = 0;
+        uint32_t bad_errors = 0;
+        for (uint32_t l = 0; l < (uint32_t)lods.size(); l++) {
+            packed += lods[l].first_index != (l ? lods[l - 1].first_index + lods[l - 1].index_count : 0);
+            packed += lods[l].index_count % 3 != 0;
+            bad_errors += lods[l].error > MESH_LOD_MAX_ERROR || (l > 0 && lods[l].error < lods[l - 1].error);
+        }
+        CHECK(packed == 0 && bad_errors == 0);
+        CHECK(lods.back().first_index + lods.back().index_count == lod_indices.size());
+        std::vector<uint32_t> triangles;
+        for (const MeshLod& lod : lods) triangles.push_back(lod.index_count / 3);
+        CHECK(triangles == expected);
+
+        LodCheck check = check_lods(vertices, lod_indices, lods, reference_locked(vertices, indices));
+        CHECK(check.out_of_range == 0);
+        CHECK(check.locked_lost == 0);
+        CHECK(check.too_small_steps == 0);
+
+        printf("%-18s %.1f ms  tris", mesh.c_str(), seconds * 1e3);
+        for (const MeshLod& lod : lods) printf(" %u (%.4f)", lod.index_count / 3, lod.error);
+        printf("\n");
+    }
+}
+
+// a flat grid with a UV seam down the middle: the inside of each half is
+//   free to go, the seam column & the outer border have to stay put
+static void test_seam_and_border_locked() {
+    const uint32_t side = 16;
+    const uint32_t seam = side / 2;
+    std::vector<Vertex> vertices;
+    // [y][x], the seam column gets a second copy for the right half
+    std::vector<uint32_t> left((side + 1) * (side + 1));
+    std::vector<uint32_t> right((side + 1) * (side + 1));
+    for (uint32_t y = 0; y <= side; y++) {
+        for (uint32_t x = 0; x <= side; x++) {
+            Vertex v = {};
+            v.Position = XMFLOAT3((float)x, 0.0f, (float)y);
+            v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+            v.UV = XMFLOAT2((float)x / side, (float)y / side);
+            left[y * (side + 1) + x] = right[y * (side + 1) + x] = (uint32_t)vertices.size();
+            vertices.push_back(v);
+            if (x == seam) {
+                v.UV.x += 0.5f;
+                right[y * (side + 1) + x] = (uint32_t)vertices.size();
+                vertices.push_back(v);
+            }
+        }
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            const std::vector<uint32_t>& grid = x < seam ? left : right;
+            uint32_t a = grid[y * (side + 1) + x];
+            uint32_t b = grid[y * (side + 1) + x + 1];
+            uint32_t c = grid[(y + 1) * (side + 1) + x];
+            uint32_t d = grid[(y + 1) * (side + 1) + x + 1];
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+
+    std::vector<uint8_t> locked(vertices.size(), 0);
+    uint32_t locked_count = 0;
+    for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) {
+        const XMFLOAT3& p = vertices[v].Position;
+        locked[v] = p.x == 0.0f || p.x == (float)side || p.z == 0.0f || p.z == (float)side || p.x == (float)seam;
+        locked_count += locked[v];
+    }
+    CHECK(reference_locked(vertices, indices) == locked);
+
+    std::vector<uint32_t> simplified;
+    float error = mesh_simplify(vertices.data(), (uint32_t)vertices.size(), indices.data(), indices.size(), 0, 0.01f, &simplified);
+    CHECK(error == 0.0f);
+    CHECK(simplified.size() < indices.size() / 4);
+
+    std::vector<uint8_t> used(vertices.size(), 0);
+    for (uint32_t index : simplified) used[index] = 1;
+    uint32_t locked_kept = 0;
+    uint32_t inner_kept = 0;
+    for (uint32_t v = 0; v < (uint32_t)vertices.size(); v++) {
+        locked_kept += locked[v] && used[v];
+        inner_kept += !locked[v] && used[v];
+    }
+    CHECK(locked_kept == locked_count);
+    CHECK(inner_kept == 0);
+}
+
+// errors 0, 1%, 2%, 4% of the radius
+static const MeshLod HYSTERESIS_LODS[] = { { 0, 0, 0.0f }, { 0, 0, 0.01f }, { 0, 0, 0.02f }, { 0, 0, 0.04f } };
+
+// inside the 25% band under the threshold nothing changes in either
+//   direction, whichever LOD it started on
+static void test_hysteresis_band() {
+    // LOD 1's error at 0.8 to 1 pixel, LOD 2's at 1.6 to 2
+    uint32_t from_fine = 0;
+    uint32_t from_coarse = 1;
+    uint32_t switches = 0;
+    for (uint32_t frame = 0; frame < 1000; frame++) {
+        float projected = 80.0f + 20.0f * (0.5f + 0.5f * sinf(frame * 0.37f));
+        uint32_t fine = mesh_lod_select(HYSTERESIS_LODS, 4, projected, from_fine);
+        uint32_t coarse = mesh_lod_select(HYSTERESIS_LODS, 4, projected, from_coarse);
+        switches += (fine != from_fine) + (coarse != from_coarse);
+        from_fine = fine;
+        from_coarse = coarse;
+    }
+    CHECK(switches == 0 && from_fine == 0 && from_coarse == 1);
+
+    // a radius jittering around one threshold settles on a LOD & stays
+    uint32_t lod = 1;
+    uint32_t changes = 0;
+    for (uint32_t frame = 0; frame < 1000; frame++) {
+        float projected = 100.0f * (1.0f + ((frame & 1) ? 0.02f : -0.02f));
+        uint32_t next = mesh_lod_select(HYSTERESIS_LODS, 4, projected, lod);
+        changes += next != lod;
+        lod = next;
+    }
+    CHECK(changes <= 1);
+
+    // & under the band it coarsens, as far as it can in one go
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 74.0f, 0) == 1);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 18.0f, 0) == 3);
+}
+
+// past 1 pixel it refines straight away, no waiting on the band
+static void test_refine_immediately() {
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 25.5f, 3) == 2);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 25.0f, 3) == 3);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 101.0f, 3) == 0);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 101.0f, 1) == 0);
+    // out of range current LODs start from the coarsest
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, 10.0f, 99) == 3);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 0, 10.0f, 2) == 0);
+}
+
+// inside the sphere the radius is FLT_MAX & only LOD 0 (error 0) is fine
+//   enough, on the way in the radius only ever grows
+static void test_projected_radius() {
+    const float fov = XM_PIDIV4;
+    XMFLOAT3 center(0.0f, 0.0f, 10.0f);
+    CHECK(mesh_lod_projected_radius(center, 2.0f, XMFLOAT3(0.0f, 0.0f, 9.0f), fov, 1080.0f) == FLT_MAX);
+    CHECK(mesh_lod_projected_radius(center, 2.0f, XMFLOAT3(0.0f, 0.0f, 8.0f), fov, 1080.0f) == FLT_MAX);
+    CHECK(mesh_lod_select(HYSTERESIS_LODS, 4, FLT_MAX, 3) == 0);
+
+    float previous = 0.0f;
+    uint32_t shrinking = 0;
+    for (float z = -100.0f; z < 7.9f; z += 0.5f) {
+        float projected = mesh_lod_projected_radius(center, 2.0f, XMFLOAT3(0.0f, 0.0f, z), fov, 1080.0f);
+        shrinking += projected < previous;
+        previous = projected;
+    }
+    CHECK(shrinking == 0);
+    // far away it's radius / distance scaled to the screen
+    float far = mesh_lod_projected_radius(center, 2.0f, XMFLOAT3(0.0f, 0.0f, -990.0f), fov, 1080.0f);
+    CHECK(fabsf(far - 2.0f / (1000.0f * tanf(fov * 0.5f)) * 540.0f) < 1e-3f);
+}
+
+int main() {
+    bench_assets();
+    test_seam_and_border_locked();
+    test_hysteresis_band();
+    test_refine_immediately();
+    test_projected_radius();
+    return test_finish();
+}
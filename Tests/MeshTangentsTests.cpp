@@ -0,0 +1,279 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MeshTangents.h"
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+// the per vertex Lengyel loop Mesh had before MeshTangents, what the
+//   serial path gets timed against
+static void legacy_calculate_tangents(Vertex* verts, size_t vertex_count, const uint32_t* indices, size_t index_count) {
+    for (size_t i = 0; i < vertex_count; i++) {
+        verts[i].Tangent = XMFLOAT3(0, 0, 0);
+    }
+    for (size_t i = 0; i < index_count;) {
+        Vertex* v1 = &verts[indices[i++]];
+        Vertex* v2 = &verts[indices[i++]];
+        Vertex* v3 = &verts[indices[i++]];
+
+        float x1 = v2->Position.x - v1->Position.x;
+        float y1 = v2->Position.y - v1->Position.y;
+        float z1 = v2->Position.z - v1->Position.z;
+        float x2 = v3->Position.x - v1->Position.x;
+        float y2 = v3->Position.y - v1->Position.y;
+        float z2 = v3->Position.z - v1->Position.z;
+        float s1 = v2->UV.x - v1->UV.x;
+        float t1 = v2->UV.y - v1->UV.y;
+        float s2 = v3->UV.x - v1->UV.x;
+        float t2 = v3->UV.y - v1->UV.y;
+        float r = 1.0f / (s1 * t2 - s2 * t1);
+
+        float tx = (t2 * x1 - t1 * x2) * r;
+        float ty = (t2 * y1 - t1 * y2) * r;
+        float tz = (t2 * z1 - t1 * z2) * r;
+        for (Vertex* v : { v1, v2, v3 }) {
+            v->Tangent.x += tx;
+            v->Tangent.y += ty;
+            v->Tangent.z += tz;
+        }
+    }
+    for (size_t i = 0; i < vertex_count; i++) {
+        XMVECTOR normal = XMLoadFloat3(&verts[i].Normal);
+        XMVECTOR tangent = XMLoadFloat3(&verts[i].Tangent);
+        tangent = XMVector3Normalize(tangent - normal * XMVector3Dot(normal, tangent));
+        XMStoreFloat3(&verts[i].Tangent, tangent);
+    }
+}
+
+static void load_mesh(const char* name, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) {
+    std::vector<Vertex> flat;
+    obj_parse_file(test_asset_path((std::string("Meshes/") + name + ".obj").c_str()).c_str(), &flat);
+    vertex_weld(flat.data(), (uint32_t)flat.size(), 0.0f, vertices, indices);
+}
+
+// a wavy size x size grid, uvs run along x & z
+static void make_grid(uint32_t size, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) {
+    vertices->clear();
+    indices->clear();
+    for (uint32_t z = 0; z < size; z++) {
+        for (uint32_t x = 0; x < size; x++) {
+            float height = sinf(x * 0.3f) * cosf(z * 0.2f) * 0.5f;
+            Vertex v = {};
+            v.Position = XMFLOAT3((float)x, height, (float)z);
+            v.UV = XMFLOAT2(x / (float)(size - 1), z / (float)(size - 1));
+            XMStoreFloat3(&v.Normal, XMVector3Normalize(XMVectorSet(-cosf(x * 0.3f) * 0.15f, 1.0f, sinf(z * 0.2f) * 0.1f, 0)));
+            vertices->push_back(v);
+        }
+    }
+    for (uint32_t z = 0; z + 1 < size; z++) {
+        for (uint32_t x = 0; x + 1 < size; x++) {
+            uint32_t a = z * size + x;
+            indices->insert(indices->end(), { a, a + size, a + 1, a + 1, a + size, a + size + 1 });
+        }
+    }
+}
+
+static float angle_between(XMFLOAT3 a, XMFLOAT3 b) {
+    XMVECTOR va = XMVector3Normalize(XMLoadFloat3(&a));
+    XMVECTOR vb = XMVector3Normalize(XMLoadFloat3(&b));
+    float cosine = XMVectorGetX(XMVector3Dot(va, vb));
+    return acosf(cosine > 1.0f ? 1.0f : (cosine < -1.0f ? -1.0f : cosine));
+}
+
+// every tangent finite, unit length & perpendicular to its normal, every
+//   handedness exactly +1 or -1
+static bool tangents_valid(const std::vector<Vertex>& vertices) {
+    for (const Vertex& v : vertices) {
+        XMVECTOR t = XMLoadFloat3(&v.Tangent);
+        XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&v.Normal));
+        float length = XMVectorGetX(XMVector3Length(t));
+        float along_normal = XMVectorGetX(XMVector3Dot(t, n));
+        if (!std::isfinite(length) || fabsf(length - 1.0f) > 1e-4f || fabsf(along_normal) > 1e-4f) return false;
+        if (v.Handedness != 1.0f && v.Handedness != -1.0f) return false;
+    }
+    return true;
+}
+
+// the bitangent the handedness gives has to point along each triangle's v gradient
+static uint32_t count_wrong_handedness(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    uint32_t wrong = 0;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const Vertex& v0 = vertices[indices[t]];
+        const Vertex& v1 = vertices[indices[t + 1]];
+        const Vertex& v2 = vertices[indices[t + 2]];
+        XMVECTOR e1 = XMLoadFloat3(&v1.Position) - XMLoadFloat3(&v0.Position);
+        XMVECTOR e2 = XMLoadFloat3(&v2.Position) - XMLoadFloat3(&v0.Position);
+        float s1 = v1.UV.x - v0.UV.x, t1 = v1.UV.y - v0.UV.y;
+        float s2 = v2.UV.x - v0.UV.x, t2 = v2.UV.y - v0.UV.y;
+        float det = s1 * t2 - s2 * t1;
+        if (fabsf(det) < 1e-8f) continue;
+        XMVECTOR v_gradient = (e2 * s1 - e1 * s2) * (1.0f / det);
+
+        for (const Vertex* corner : { &v0, &v1, &v2 }) {
+            XMVECTOR bitangent = XMVector3Cross(XMLoadFloat3(&corner->Normal), XMLoadFloat3(&corner->Tangent)) * corner->Handedness;
+            if (XMVectorGetX(XMVector3Dot(bitangent, v_gradient)) < 0.0f) wrong++;
+        }
+    }
+    return wrong;
+}
+
+static void test_assets() {
+    const char* meshes[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+    for (const char* mesh : meshes) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        load_mesh(mesh, &vertices, &indices);
+
+        // fast mode points the same way the old loop did
+        std::vector<Vertex> legacy = vertices;
+        legacy_calculate_tangents(legacy.data(), legacy.size(), indices.data(), indices.size());
+        std::vector<Vertex> fast = vertices;
+        std::vector<uint32_t> fast_indices = indices;
+        TangentStats fast_stats = {};
+        mesh_calculate_tangents(&fast, &fast_indices, TANGENT_MODE_FAST, &fast_stats);
+        float worst = 0.0f;
+        for (size_t i = 0; i < fast.size(); i++) {
+            if (!std::isfinite(legacy[i].Tangent.x)) continue;
+            float angle = angle_between(fast[i].Tangent, legacy[i].Tangent);
+            worst = angle > worst ? angle : worst;
+        }
+        CHECK(tangents_valid(fast));
+        CHECK(worst < 1e-3f);
+        CHECK(fast_indices == indices);
+
+        std::vector<Vertex> mikk = vertices;
+        std::vector<uint32_t> mikk_indices = indices;
+        TangentStats mikk_stats = {};
+        mesh_calculate_tangents(&mikk, &mikk_indices, TANGENT_MODE_MIKKTSPACE, &mikk_stats);
+        CHECK(tangents_valid(mikk));
+        CHECK(count_wrong_handedness(mikk, mikk_indices) == 0);
+        // nothing needed splitting, so fast mode's votes are never split either
+        CHECK(mikk_stats.split_count > 0 || count_wrong_handedness(fast, indices) == 0);
+
+        uint32_t mirrored = 0;
+        for (const Vertex& v : fast) mirrored += v.Handedness < 0.0f ? 1 : 0;
+        printf(
+            "%-18s %6zu verts  fast: %.1e rad off legacy, %u mirrored  mikk: %u splits, %u degenerate\n",
+            mesh, vertices.size(), worst, mirrored, mikk_stats.split_count, mikk_stats.degenerate_count
+        );
+    }
+}
+
+// two triangles sharing an edge, the second one's uvs mirrored across it
+static void test_mirrored_split() {
+    std::vector<Vertex> vertices(4);
+    XMFLOAT3 positions[4] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+    XMFLOAT2 uvs[4] = { { 0, 1 }, { 1, 1 }, { 0, 0 }, { 0, 1 } };
+    for (uint32_t i = 0; i < 4; i++) {
+        vertices[i].Position = positions[i];
+        vertices[i].UV = uvs[i];
+        vertices[i].Normal = XMFLOAT3(0, 0, -1);
+    }
+    std::vector<uint32_t> indices = { 0, 2, 1, 1, 2, 3 };
+
+    TangentStats stats = {};
+    mesh_calculate_tangents(&vertices, &indices, TANGENT_MODE_MIKKTSPACE, &stats);
+    CHECK(stats.split_count == 2);
+    CHECK(vertices.size() == 6);
+    CHECK(tangents_valid(vertices));
+    CHECK(count_wrong_handedness(vertices, indices) == 0);
+}
+
+// fast mode works the winding out per mesh, so triangles wound either way
+//   round their normals (& mirrored uvs on top of that) all have to come out
+//   with the right handedness
+static void test_fast_handedness() {
+    std::vector<Vertex> grid;
+    std::vector<uint32_t> grid_indices;
+    make_grid(16, &grid, &grid_indices);
+
+    for (bool reversed : { false, true }) {
+        for (bool mirrored : { false, true }) {
+            std::vector<Vertex> vertices = grid;
+            std::vector<uint32_t> indices = grid_indices;
+            for (size_t t = 0; reversed && t < indices.size(); t += 3) {
+                uint32_t swap = indices[t + 1];
+                indices[t + 1] = indices[t + 2];
+                indices[t + 2] = swap;
+            }
+            for (Vertex& v : vertices) {
+                if (mirrored) v.UV.x = 1.0f - v.UV.x;
+            }
+
+            mesh_calculate_tangents(&vertices, &indices, TANGENT_MODE_FAST);
+            CHECK(tangents_valid(vertices));
+            CHECK(count_wrong_handedness(vertices, indices) == 0);
+        }
+    }
+}
+
+static void test_degenerate_uvs() {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    make_grid(8, &vertices, &indices);
+    for (Vertex& v : vertices) v.UV = XMFLOAT2(0.5f, 0.5f);
+
+    for (uint32_t mode : { TANGENT_MODE_FAST, TANGENT_MODE_MIKKTSPACE }) {
+        std::vector<Vertex> out = vertices;
+        std::vector<uint32_t> out_indices = indices;
+        TangentStats stats = {};
+        mesh_calculate_tangents(&out, &out_indices, mode, &stats);
+        CHECK(stats.degenerate_count == indices.size() / 3);
+        CHECK(stats.fallback_count == vertices.size());
+        CHECK(tangents_valid(out));
+    }
+}
+
+// best of a few runs, the first one warms everything up
+template <typename F>
+static double best_seconds(uint32_t runs, F&& func) {
+    double best = 1e30;
+    for (uint32_t i = 0; i < runs; i++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        func();
+        double elapsed = test_seconds_since(start_time);
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+static void bench_grids() {
+    printf("%10s %10s %10s %10s %8s %8s\n", "tris", "legacy ms", "fast ms", "mikk ms", "threads", "fast/old");
+    for (uint32_t size : { 24u, 72u, 224u, 708u }) {
+        std::vector<Vertex> grid;
+        std::vector<uint32_t> indices;
+        make_grid(size, &grid, &indices);
+        uint32_t runs = size < 100 ? 200 : (size < 300 ? 20 : 5);
+
+        std::vector<Vertex> vertices = grid;
+        double legacy = best_seconds(runs, [&]() {
+            legacy_calculate_tangents(vertices.data(), vertices.size(), indices.data(), indices.size());
+        });
+        TangentStats stats = {};
+        double fast = best_seconds(runs, [&]() {
+            mesh_calculate_tangents(&vertices, &indices, TANGENT_MODE_FAST, &stats);
+        });
+        // nothing on the grid is mirrored, so nothing gets split & reruns see the same mesh
+        double mikk = best_seconds(runs, [&]() {
+            mesh_calculate_tangents(&vertices, &indices, TANGENT_MODE_MIKKTSPACE);
+        });
+        printf(
+            "%10zu %10.3f %10.3f %10.3f %8u %8.2f\n",
+            indices.size() / 3, legacy * 1000.0, fast * 1000.0, mikk * 1000.0, stats.thread_count, fast / legacy
+        );
+        CHECK(tangents_valid(vertices));
+    }
+}
+
+int main() {
+    test_assets();
+    test_mirrored_split();
+    test_fast_handedness();
+    test_degenerate_uvs();
+    bench_grids();
+    return test_finish();
+}
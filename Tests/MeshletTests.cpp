@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+static const char* ASSETS[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+
+// welded & cache optimized, the order meshlet_build sees in the cooker
+static void load_asset(const char* mesh, std::vector<Vertex>* out_vertices, std::vector<uint32_t>* out_indices) {
+    std::vector<Vertex> soup;
+    obj_parse_file(test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str()).c_str(), &soup);
+    vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, out_vertices, out_indices);
+    optimize_vertex_cache(out_indices->data(), out_indices->size(), (uint32_t)out_vertices->size());
+}
+
+// rotated so the smallest index leads, keeps the winding
+static std::vector<std::array<uint32_t, 3>> triangle_set(const std::vector<uint32_t>& indices) {
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        const uint32_t* tri = &indices[t * 3];
+        uint32_t first = tri[0] <= tri[1] && tri[0] <= tri[2] ? 0 : tri[1] <= tri[2] ? 1 : 2;
+        triangles[t] = { tri[first], tri[(first + 1) % 3], tri[(first + 2) % 3] };
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// every asset: meshlets within the vertex & triangle limits, their ranges
+//   back to back over the whole buffer so each triangle is in exactly one,
+//   the same triangles (winding too) as before & bounds holding every vertex
+static void test_build_assets() {
+    for (const char* mesh : ASSETS) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        load_asset(mesh, &vertices, &indices);
+        std::vector<uint32_t> original = indices;
+        std::vector<Meshlet> meshlets;
+        meshlet_build(indices.data(), indices.size(), vertices.data(), (uint32_t)vertices.size(), &meshlets);
+
+        uint32_t over_limit = 0;
+        uint32_t wrong_vertex_count = 0;
+        uint32_t gaps = 0;
+        uint32_t outside = 0;
+        uint32_t next_index = 0;
+        for (const Meshlet& meshlet : meshlets) {
+            gaps += meshlet.first_index != next_index || meshlet.index_count == 0 || meshlet.index_count % 3 != 0;
+            next_index = meshlet.first_index + meshlet.index_count;
+
+            std::vector<uint32_t> unique(indices.begin() + meshlet.first_index, indices.begin() + next_index);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            over_limit += unique.size() > MESHLET_MAX_VERTICES || meshlet.index_count / 3 > MESHLET_MAX_TRIANGLES;
+            wrong_vertex_count += unique.size() != meshlet.vertex_count;
+            for (uint32_t v : unique) {
+                const XMFLOAT3& p = vertices[v].Position;
+                double dx = p.x - meshlet.center.x, dy = p.y - meshlet.center.y, dz = p.z - meshlet.center.z;
+                outside += sqrt(dx * dx + dy * dy + dz * dz) > meshlet.radius * (1.0 + 1e-5) + 1e-6;
+            }
+        }
+        CHECK(next_index == indices.size());
+        CHECK(gaps == 0);
+        CHECK(over_limit == 0 && wrong_vertex_count == 0);
+        CHECK(outside == 0);
+        CHECK(triangle_set(indices) == triangle_set(original));
+
+        double triangles = (double)indices.size() / 3;
+        printf(
+            "%-18s %5.0f tris -> %4zu meshlets, %.1f tris & %.1f verts each\n",
+            mesh, triangles, meshlets.size(), triangles / meshlets.size(),
+            [&] { double sum = 0.0; for (const Meshlet& m : meshlets) sum += m.vertex_count; return sum / meshlets.size(); }()
+        );
+    }
+}
+
+// clip space position, row vectors like everything else
+static XMFLOAT4 to_clip(const XMFLOAT3& p, const XMFLOAT4X4& m) {
+    return XMFLOAT4(
+        p.x * m._11 + p.y * m._21 + p.z * m._31 + m._41,
+        p.x * m._12 + p.y * m._22 + p.z * m._32 + m._42,
+        p.x * m._13 + p.y * m._23 + p.z * m._33 + m._43,
+        p.x * m._14 + p.y * m._24 + p.z * m._34 + m._44
+    );
+}
+
+// a little way inside every clip plane
+static bool clearly_inside(const XMFLOAT4& clip) {
+    float w = clip.w * 0.999f;
+    return clip.w > 0.0f && fabsf(clip.x) < w && fabsf(clip.y) < w && clip.z > clip.w * 0.001f && clip.z < w;
+}
+
+// cameras all around every asset, near & far, some inside, each looking
+//   roughly at it under a random world transform like Draw does: any
+//   triangle that faces the camera & has a vertex on screen has to be in
+//   one of the draws
+static void test_no_front_face_culled() {
+    std::mt19937 random(6);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    uint64_t missing = 0;
+    uint64_t total_meshlets = 0;
+    uint64_t culled_meshlets = 0;
+    for (const char* mesh : ASSETS) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        load_asset(mesh, &vertices, &indices);
+        std::vector<Meshlet> meshlets;
+        meshlet_build(indices.data(), indices.size(), vertices.data(), (uint32_t)vertices.size(), &meshlets);
+        std::vector<uint32_t> meshlet_of(indices.size() / 3);
+        for (uint32_t m = 0; m < (uint32_t)meshlets.size(); m++) {
+            for (uint32_t t = meshlets[m].first_index / 3; t < (meshlets[m].first_index + meshlets[m].index_count) / 3; t++) meshlet_of[t] = m;
+        }
+        float mesh_radius = 0.0f;
+        for (const Vertex& v : vertices) mesh_radius = std::max(mesh_radius, sqrtf(v.Position.x * v.Position.x + v.Position.y * v.Position.y + v.Position.z * v.Position.z));
+
+        for (uint32_t sample = 0; sample < 300; sample++) {
+            // rotation, uniform scale & translation, so the inverse is easy
+            XMVECTOR q = XMQuaternionNormalize(XMVectorSet(normal(random), normal(random), normal(random), normal(random)));
+            XMMATRIX rotation = XMMatrixRotationQuaternion(q);
+            float scale = 0.5f + (unit(random) + 1.0f) * 2.0f;
+            XMVECTOR translation = XMVectorSet(unit(random) * 20.0f, unit(random) * 20.0f, unit(random) * 20.0f, 0.0f);
+            XMMATRIX world = rotation;
+            world.r[0] = world.r[0] * scale;
+            world.r[1] = world.r[1] * scale;
+            world.r[2] = world.r[2] * scale;
+            world.r[3] = XMVectorSetW(translation, 1.0f);
+
+            XMVECTOR direction = XMVector3Normalize(XMVectorSet(normal(random), normal(random), normal(random), 0.0f));
+            float distance = mesh_radius * scale * (sample % 10 == 0 ? 0.3f : 1.2f + (unit(random) + 1.0f) * 3.0f);
+            XMVECTOR eye = translation + direction * distance;
+            XMVECTOR look = XMVector3Normalize(-direction + XMVectorSet(unit(random), unit(random), unit(random), 0.0f) * 0.3f);
+            XMMATRIX view = XMMatrixLookToLH(eye, look, fabsf(XMVectorGetY(look)) > 0.99f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0));
+            XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.01f, 1000.0f);
+            XMFLOAT4X4 world_view_proj;
+            XMStoreFloat4x4(&world_view_proj, XMMatrixMultiply(XMMatrixMultiply(world, view), proj));
+
+            // world -> object is transpose(R) * (p - t) / s
+            XMFLOAT3 offset;
+            XMStoreFloat3(&offset, (eye - translation) / scale);
+            XMFLOAT4X4 r;
+            XMStoreFloat4x4(&r, rotation);
+            XMFLOAT3 camera(
+                offset.x * r._11 + offset.y * r._12 + offset.z * r._13,
+                offset.x * r._21 + offset.y * r._22 + offset.z * r._23,
+                offset.x * r._31 + offset.y * r._32 + offset.z * r._33
+            );
+
+            MeshletCullParams params = meshlet_cull_params_create(world_view_proj, camera);
+            std::vector<MeshletDraw> draws;
+            uint32_t visible = meshlet_cull(meshlets.data(), (uint32_t)meshlets.size(), params, &draws);
+            std::vector<uint8_t> drawn(meshlets.size(), 0);
+            for (const MeshletDraw& draw : draws) {
+                for (uint32_t t = draw.first_index / 3; t < (draw.first_index + draw.index_count) / 3; t++) drawn[meshlet_of[t]] = 1;
+            }
+            total_meshlets += meshlets.size();
+            culled_meshlets += meshlets.size() - visible;
+
+            for (uint32_t t = 0; t < (uint32_t)meshlet_of.size(); t++) {
+                if (drawn[meshlet_of[t]]) continue;
+                const XMFLOAT3& a = vertices[indices[t * 3 + 0]].Position;
+                const XMFLOAT3& b = vertices[indices[t * 3 + 1]].Position;
+                const XMFLOAT3& c = vertices[indices[t * 3 + 2]].Position;
+                double e0[3] = { (double)b.x - a.x, (double)b.y - a.y, (double)b.z - a.z };
+                double e1[3] = { (double)c.x - a.x, (double)c.y - a.y, (double)c.z - a.z };
+                double n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+                double to_triangle[3] = { (double)a.x - camera.x, (double)a.y - camera.y, (double)a.z - camera.z };
+                double facing = n[0] * to_triangle[0] + n[1] * to_triangle[1] + n[2] * to_triangle[2];
+                double scale_of = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) *
+                    sqrt(to_triangle[0] * to_triangle[0] + to_triangle[1] * to_triangle[1] + to_triangle[2] * to_triangle[2]);
+                // clockwise is the front, so front faces point back at the camera
+                if (facing > -1e-4 * scale_of) continue;
+                bool on_screen =
+                    clearly_inside(to_clip(a, world_view_proj)) ||
+                    clearly_inside(to_clip(b, world_view_proj)) ||
+                    clearly_inside(to_clip(c, world_view_proj));
+                missing += on_screen;
+            }
+        }
+    }
+    CHECK(missing == 0);
+    CHECK(culled_meshlets > 0);
+    printf("%llu meshlet tests over 2100 cameras, %.1f%% culled, no visible front face lost\n",
+        (unsigned long long)total_meshlets, 100.0 * culled_meshlets / total_meshlets);
+}
+
+// visible neighbours in the index buffer merge into one draw, anything
+//   culled or not actually adjacent splits them
+static void test_draw_merging() {
+    // x >= 0 is inside, the other planes can't cull anything
+    MeshletCullParams params = {};
+    params.planes[0] = XMFLOAT4(1.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 1; i < 6; i++) params.planes[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+    params.camera_position = XMFLOAT3(0.0f, 0.0f, -100.0f);
+
+    const char* pattern = "VVIVIIVVVV";
+    std::vector<Meshlet> meshlets;
+    uint32_t first_index = 0;
+    for (const char* c = pattern; *c; c++) {
+        Meshlet meshlet = {};
+        meshlet.first_index = first_index;
+        meshlet.index_count = 3 * (1 + (uint32_t)meshlets.size());
+        meshlet.center = XMFLOAT3(*c == 'V' ? 5.0f : -5.0f, 0.0f, 0.0f);
+        meshlet.radius = 1.0f;
+        meshlet.cone_cutoff = 1.0f;
+        first_index += meshlet.index_count;
+        meshlets.push_back(meshlet);
+    }
+    // the last one lives somewhere else in the buffer (another segment)
+    meshlets.back().first_index += 300;
+
+    std::vector<MeshletDraw> draws;
+    uint32_t visible = meshlet_cull(meshlets.data(), (uint32_t)meshlets.size(), params, &draws);
+    CHECK(visible == 7);
+    CHECK(draws.size() == 4);
+    if (draws.size() == 4) {
+        CHECK(draws[0].first_index == 0 && draws[0].index_count == meshlets[0].index_count + meshlets[1].index_count);
+        CHECK(draws[1].first_index == meshlets[3].first_index && draws[1].index_count == meshlets[3].index_count);
+        CHECK(draws[2].first_index == meshlets[6].first_index && draws[2].index_count == meshlets[6].index_count + meshlets[7].index_count + meshlets[8].index_count);
+        CHECK(draws[3].first_index == meshlets[9].first_index && draws[3].index_count == meshlets[9].index_count);
+    }
+
+    // a sphere just touching the plane still counts, a cone facing straight away doesn't
+    meshlets[0].center.x = -0.999f;
+    meshlets[1].cone_axis = XMFLOAT3(0.0f, 0.0f, 1.0f);
+    meshlets[1].cone_cutoff = 0.1f;
+    meshlets[1].center = XMFLOAT3(5.0f, 0.0f, 0.0f);
+    visible = meshlet_cull(meshlets.data(), 2, params, &draws);
+    CHECK(visible == 1 && draws.size() == 1 && draws[0].index_count == meshlets[0].index_count);
+
+    // nothing visible, nothing drawn
+    meshlets[0].center.x = -2.0f;
+    visible = meshlet_cull(meshlets.data(), 2, params, &draws);
+    CHECK(visible == 0 && draws.empty());
+}
+
+int main() {
+    test_build_assets();
+    test_no_front_face_culled();
+    test_draw_merging();
+    return test_finish();
+}
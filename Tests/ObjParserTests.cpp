@@ -0,0 +1,206 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ObjParser.h"
+#include "TestCheck.h"
+
+using namespace DirectX;
+
+// the getline + sscanf loader Mesh used before ObjParser, kept as the
+//   reference output has to match bit for bit
+static std::vector<Vertex> legacy_obj_parse(const char* path) {
+    std::ifstream obj(path);
+    if (!obj.is_open())
+        throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
+
+    std::vector<XMFLOAT3> positions;
+    std::vector<XMFLOAT3> normals;
+    std::vector<XMFLOAT2> uvs;
+    std::vector<Vertex> vertices;
+    char chars[100];
+
+    auto corner = [&](int position, int uv, int normal) {
+        Vertex v {};
+        v.Position = positions[position - 1 > 0 ? position - 1 : 0];
+        v.UV = uvs[uv - 1 > 0 ? uv - 1 : 0];
+        v.Normal = normals[normal - 1 > 0 ? normal - 1 : 0];
+        v.UV.y = 1.0f - v.UV.y;
+        v.Position.z *= -1.0f;
+        v.Normal.z *= -1.0f;
+        return v;
+    };
+
+    while (obj.good()) {
+        obj.getline(chars, 100);
+
+        if (chars[0] == 'v' && chars[1] == 'n') {
+            XMFLOAT3 norm {};
+            sscanf(chars, "vn %f %f %f", &norm.x, &norm.y, &norm.z);
+            normals.push_back(norm);
+        } else if (chars[0] == 'v' && chars[1] == 't') {
+            XMFLOAT2 uv {};
+            sscanf(chars, "vt %f %f", &uv.x, &uv.y);
+            uvs.push_back(uv);
+        } else if (chars[0] == 'v') {
+            XMFLOAT3 pos {};
+            sscanf(chars, "v %f %f %f", &pos.x, &pos.y, &pos.z);
+            positions.push_back(pos);
+        } else if (chars[0] == 'f') {
+            int i[12] {};
+            int numbers_read = sscanf(
+                chars,
+                "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d",
+                &i[0], &i[1], &i[2],
+                &i[3], &i[4], &i[5],
+                &i[6], &i[7], &i[8],
+                &i[9], &i[10], &i[11]
+            );
+            if (numbers_read == 1) {
+                numbers_read = sscanf(
+                    chars,
+                    "f %d//%d %d//%d %d//%d %d//%d",
+                    &i[0], &i[2],
+                    &i[3], &i[5],
+                    &i[6], &i[8],
+                    &i[9], &i[11]
+                );
+                i[1] = i[4] = i[7] = i[10] = 1;
+                if (uvs.size() == 0) uvs.push_back(XMFLOAT2(0, 0));
+            }
+
+            Vertex v1 = corner(i[0], i[1], i[2]);
+            Vertex v2 = corner(i[3], i[4], i[5]);
+            Vertex v3 = corner(i[6], i[7], i[8]);
+            vertices.push_back(v1);
+            vertices.push_back(v3);
+            vertices.push_back(v2);
+            if (numbers_read == 12 || numbers_read == 8) {
+                Vertex v4 = corner(i[9], i[10], i[11]);
+                vertices.push_back(v1);
+                vertices.push_back(v4);
+                vertices.push_back(v3);
+            }
+        }
+    }
+    return vertices;
+}
+
+// a bumpy grid of quads, big enough that obj_parse splits it into chunks
+//   (the shipped assets all fit in one). lines stay under the legacy
+//   loader's 100 characters
+static std::string write_grid_obj(uint32_t size) {
+    std::string path = (std::filesystem::temp_directory_path() / "objparser_grid.obj").string();
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) throw std::runtime_error("can't write " + path);
+
+    fprintf(file, "# generated by ObjParserTests\n");
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            float height = (float)((x * 7 + y * 13) % 17) * 0.0371f;
+            fprintf(file, "v %f %f %f\n", x * 0.125f - 3.0f, height, y * -0.0625f + 1.5f);
+            fprintf(file, "vt %f %f\n", (float)x / (size - 1), (float)y / (size - 1));
+            fprintf(file, "vn %f %f %f\n", 0.0f, 1.0f, height - 0.25f);
+        }
+    }
+    for (uint32_t y = 0; y + 1 < size; y++) {
+        for (uint32_t x = 0; x + 1 < size; x++) {
+            uint32_t a = y * size + x + 1;
+            uint32_t b = a + 1;
+            uint32_t c = a + size + 1;
+            uint32_t d = a + size;
+            fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c, d, d, d);
+        }
+    }
+    fclose(file);
+    return path;
+}
+
+// parses path with both loaders a few times, checks they agree exactly &
+//   returns the bytes parsed for the throughput totals
+static size_t compare_with_legacy(const char* name, const std::string& path, uint32_t repeats, double* legacy_seconds, double* parser_seconds) {
+    std::vector<Vertex> legacy;
+    std::vector<Vertex> parsed;
+    ObjParseStats stats = {};
+    double legacy_best = 1e30;
+    double parser_best = 1e30;
+    for (uint32_t i = 0; i < repeats; i++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        legacy = legacy_obj_parse(path.c_str());
+        double elapsed = test_seconds_since(start_time);
+        legacy_best = elapsed < legacy_best ? elapsed : legacy_best;
+
+        obj_parse_file(path.c_str(), &parsed, &stats);
+        parser_best = stats.seconds < parser_best ? stats.seconds : parser_best;
+    }
+
+    bool identical = legacy.size() == parsed.size()
+        && memcmp(legacy.data(), parsed.data(), legacy.size() * sizeof(Vertex)) == 0;
+    CHECK(!parsed.empty());
+    CHECK(identical);
+
+    double megabytes = (double)stats.file_bytes / 1e6;
+    printf(
+        "%-20s %8.2f MB %8zu verts %3u chunk(s)  legacy %7.1f MB/s  obj_parse %7.1f MB/s  %s\n",
+        name, megabytes, parsed.size(), stats.chunk_count,
+        megabytes / legacy_best, megabytes / parser_best,
+        identical ? "identical" : "DIFFERENT"
+    );
+    *legacy_seconds += legacy_best;
+    *parser_seconds += parser_best;
+    return stats.file_bytes;
+}
+
+static void test_assets() {
+    const char* meshes[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+    double legacy_seconds = 0;
+    double parser_seconds = 0;
+    size_t bytes = 0;
+    for (const char* mesh : meshes) {
+        std::string path = test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str());
+        bytes += compare_with_legacy(mesh, path, 5, &legacy_seconds, &parser_seconds);
+    }
+    printf(
+        "%-20s %8.2f MB  legacy %7.1f MB/s  obj_parse %7.1f MB/s (%.1fx)\n",
+        "assets", bytes / 1e6, bytes / 1e6 / legacy_seconds, bytes / 1e6 / parser_seconds,
+        legacy_seconds / parser_seconds
+    );
+}
+
+static void test_chunked() {
+    std::string path = write_grid_obj(256);
+    double legacy_seconds = 0;
+    double parser_seconds = 0;
+    compare_with_legacy("grid 256x256", path, 2, &legacy_seconds, &parser_seconds);
+    std::filesystem::remove(path);
+}
+
+static void test_malformed() {
+    std::vector<Vertex> vertices;
+    const char out_of_range[] = "v 0 0 0\nvt 0 0\nvn 0 1 0\nf 1/1/1 2/1/1 1/1/1\n";
+    bool threw = false;
+    try {
+        obj_parse(out_of_range, sizeof(out_of_range) - 1, &vertices);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    threw = false;
+    try {
+        obj_parse_file("does/not/exist.obj", &vertices);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+int main() {
+    test_assets();
+    test_chunked();
+    test_malformed();
+    return test_finish();
+}
@@ -0,0 +1,222 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ParallelRecorder.h"
+#include "TestCheck.h"
+
+// what DrawGBuffer charges for the demo scene's meshes: 1 per entity plus
+//   its meshlets (cube, helix, sphere)
+constexpr uint32_t SCENE_COSTS[] = { 1 + 6, 1 + 42, 1 + 16 };
+// Graphics::MAX_RECORD_WORKERS
+constexpr uint32_t GAME_WORKER_COUNT = 8;
+
+static bool chunks_cover(const std::vector<RecordChunk>& chunks, uint32_t count) {
+    uint32_t next = 0;
+    for (const RecordChunk& chunk : chunks) {
+        if (chunk.first != next || chunk.count == 0) return false;
+        next += chunk.count;
+    }
+    return next == count;
+}
+
+static void test_split() {
+    std::vector<RecordChunk> chunks;
+    std::vector<uint32_t> costs(1000, 1);
+    record_split(costs.data(), 1000, 8, 0, &chunks);
+    CHECK(chunks.size() == 8 && chunks_cover(chunks, 1000));
+    for (const RecordChunk& chunk : chunks) CHECK(chunk.count >= 124 && chunk.count <= 126);
+
+    record_split(costs.data(), 1000, 8, 300, &chunks);
+    CHECK(chunks.size() == 3);
+    record_split(costs.data(), 3, 8, 0, &chunks);
+    CHECK(chunks.size() == 3);
+    record_split(costs.data(), 0, 8, 0, &chunks);
+    CHECK(chunks.empty());
+
+    // one huge item gets a chunk to itself
+    costs[0] = 100000;
+    record_split(costs.data(), 1000, 8, 0, &chunks);
+    CHECK(chunks[0].count == 1 && chunks_cover(chunks, 1000));
+
+    std::mt19937 random(3);
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint32_t count = random() % 300;
+        std::vector<uint32_t> random_costs(count);
+        for (uint32_t& cost : random_costs) cost = random() % 50;
+        uint32_t max_chunks = 1 + random() % 40;
+        record_split(random_costs.data(), count, max_chunks, random() % 3 ? 0 : random() % 500, &chunks);
+        errors += !chunks_cover(chunks, count);
+        errors += chunks.size() > max_chunks;
+    }
+    CHECK(errors == 0);
+}
+
+// 4 workers, 2 allocators, 2 record calls a frame: the second call opens a
+//   second list on the same allocator without resetting it
+static void test_bookkeeping() {
+    MockRecordBackend backend(4);
+    ParallelRecorder recorder;
+    parallel_recorder_create(&recorder, 4, 2, &backend);
+
+    std::vector<uint32_t> costs(4000, 1);
+    std::vector<std::vector<uint32_t>> recorded(4);
+    for (uint32_t frame = 0; frame < 6; frame++) {
+        parallel_recorder_begin_frame(&recorder, frame % 2);
+        for (uint32_t call = 0; call < 2; call++) {
+            parallel_recorder_record(&recorder, costs.data(), 4000, 0, [&](const RecordSlot& slot, RecordChunk chunk) {
+                for (uint32_t i = 0; i < chunk.count; i++) recorded[slot.worker].push_back(chunk.first + i);
+            });
+        }
+    }
+
+    CHECK(backend.submit_count == 12 && backend.submitted.size() == 48);
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < (uint32_t)backend.submitted.size(); i++) {
+        const RecordSlot& slot = backend.submitted[i];
+        uint32_t frame = i / 8;
+        uint32_t call = i / 4 % 2;
+        errors += slot.worker != i % 4 || slot.list != call || slot.allocator != frame % 2;
+        errors += slot.reset_allocator != (call == 0);
+    }
+    CHECK(errors == 0);
+    for (const std::vector<MockRecordBackend::Event>& events : backend.worker_events) CHECK(events.size() == 24);
+    size_t total = 0;
+    for (const std::vector<uint32_t>& items : recorded) total += items.size();
+    CHECK(total == 4000 * 12);
+    CHECK(recorder.stats.allocator_reset_count == 24 && recorder.stats.list_count == 8);
+    parallel_recorder_destroy(&recorder);
+}
+
+// the demo scene is worth a second worker (the helix on its own is most of
+//   it), a few hundred of its entities spread over every worker & still
+//   record in order
+static void test_game_threshold() {
+    std::vector<RecordChunk> chunks;
+    record_split(SCENE_COSTS, 3, GAME_WORKER_COUNT, RECORD_CHUNK_MIN_COST, &chunks);
+    CHECK(chunks.size() == 2);
+
+    std::vector<uint32_t> costs;
+    for (uint32_t i = 0; i < 300; i++) costs.insert(costs.end(), SCENE_COSTS, SCENE_COSTS + 3);
+    uint32_t count = (uint32_t)costs.size();
+
+    MockRecordBackend backend(GAME_WORKER_COUNT);
+    ParallelRecorder recorder;
+    parallel_recorder_create(&recorder, GAME_WORKER_COUNT, 2, &backend);
+    parallel_recorder_begin_frame(&recorder, 0);
+    std::vector<std::vector<uint32_t>> recorded(GAME_WORKER_COUNT);
+    std::vector<uint64_t> worker_costs(GAME_WORKER_COUNT, 0);
+    parallel_recorder_record(&recorder, costs.data(), count, RECORD_CHUNK_MIN_COST, [&](const RecordSlot& slot, RecordChunk chunk) {
+        for (uint32_t i = chunk.first; i < chunk.first + chunk.count; i++) {
+            recorded[slot.worker].push_back(i);
+            worker_costs[slot.worker] += costs[i];
+        }
+    });
+    CHECK(recorder.chunks.size() == GAME_WORKER_COUNT);
+
+    // the lists go out in chunk order, so reading them back in that order
+    //   has to give every entity once, as they came in
+    std::vector<uint32_t> order;
+    for (const RecordSlot& slot : backend.submitted) order.insert(order.end(), recorded[slot.worker].begin(), recorded[slot.worker].end());
+    bool in_order = order.size() == count;
+    for (uint32_t i = 0; in_order && i < count; i++) in_order = order[i] == i;
+    CHECK(in_order);
+
+    // no worker gets more than its share & one entity
+    uint64_t total = 0;
+    for (uint32_t cost : costs) total += cost;
+    for (uint64_t cost : worker_costs) CHECK(cost <= total / GAME_WORKER_COUNT + 43);
+    parallel_recorder_destroy(&recorder);
+}
+
+// a list of commands per worker stands in for its command list
+struct NullList {
+    std::vector<uint32_t> commands;
+};
+
+// the engine's side of recording a draw, a matrix for its constants & a
+//   couple of commands, without any driver behind it
+static void null_draw(NullList* list, uint32_t item) {
+    float m[16];
+    for (uint32_t i = 0; i < 16; i++) m[i] = (float)(item * 16 + i);
+    float r[16] = {};
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            for (uint32_t k = 0; k < 4; k++) r[i * 4 + j] += m[i * 4 + k] * m[k * 4 + j];
+        }
+    }
+    uint32_t bits;
+    memcpy(&bits, &r[5], sizeof(bits));
+    list->commands.push_back(item);
+    list->commands.push_back(bits);
+}
+
+// microseconds per record call of count items, each chunk running null draws
+static double time_record(uint32_t worker_count, uint32_t count, uint64_t min_chunk_cost, uint32_t frames) {
+    MockRecordBackend backend(worker_count);
+    ParallelRecorder recorder;
+    parallel_recorder_create(&recorder, worker_count, 2, &backend);
+    std::vector<uint32_t> costs(count, 1);
+    std::vector<NullList> lists(worker_count);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        parallel_recorder_begin_frame(&recorder, frame % 2);
+        for (NullList& list : lists) list.commands.clear();
+        parallel_recorder_record(&recorder, costs.data(), count, min_chunk_cost, [&](const RecordSlot& slot, RecordChunk chunk) {
+            for (uint32_t i = chunk.first; i < chunk.first + chunk.count; i++) null_draw(&lists[slot.worker], i);
+        });
+        backend.submitted.clear();
+        for (std::vector<MockRecordBackend::Event>& events : backend.worker_events) events.clear();
+    }
+    double seconds = test_seconds_since(start);
+
+    size_t commands = 0;
+    for (const NullList& list : lists) commands += list.commands.size();
+    CHECK(commands == (size_t)count * 2);
+    parallel_recorder_destroy(&recorder);
+    return seconds * 1e6 / frames;
+}
+
+// roughly what recording a draw costs against a real driver, a null draw's
+//   nowhere near that. a chunk's list also needs the pass's state set again
+//   (heaps, viewport, pipeline, targets), call that as much again as the handoff
+constexpr double DRIVER_DRAW_US = 0.25;
+
+// what a chunk costs on top of its draws (waking its thread & waiting on
+//   it). that over a draw is the break even RECORD_CHUNK_MIN_COST is set by
+static void bench_handoff() {
+    constexpr uint32_t FRAMES = 20000;
+    double alone = time_record(1, GAME_WORKER_COUNT, 0, FRAMES);
+    double spread = time_record(GAME_WORKER_COUNT, GAME_WORKER_COUNT, 0, FRAMES);
+    double per_chunk = (spread - alone) / (GAME_WORKER_COUNT - 1);
+    printf(
+        "handing off a chunk: %.2f us, break even %.0f draws (RECORD_CHUNK_MIN_COST %llu)\n",
+        per_chunk, 2.0 * per_chunk / DRIVER_DRAW_US, (unsigned long long)RECORD_CHUNK_MIN_COST
+    );
+}
+
+// 20000 null draws over 1 to 32 threads. only means something with that
+//   many cores, the hardware's thread count is printed with it
+static void bench_scaling() {
+    constexpr uint32_t DRAWS = 20000;
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    double single = 0.0;
+    for (uint32_t threads : { 1u, 2u, 4u, 8u, 16u, 32u }) {
+        double us = time_record(threads, DRAWS, RECORD_CHUNK_MIN_COST, 100);
+        single = threads == 1 ? us : single;
+        printf("%2u threads: %8.1f us a frame for %u draws (%.2fx)\n", threads, us, DRAWS, single / us);
+    }
+}
+
+int main() {
+    test_split();
+    test_bookkeeping();
+    test_game_threshold();
+    bench_handoff();
+    bench_scaling();
+    return test_finish();
+}
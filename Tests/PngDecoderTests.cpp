@@ -0,0 +1,309 @@
+#include <png.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "Inflate.h"
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "TestCheck.h"
+
+// png_decode against libpng: every color type & bit depth it writes, & the
+//   assets. only built where CMake finds libpng
+
+struct PngReadState {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+};
+
+static void png_read_memory(png_structp png, png_bytep out, png_size_t size) {
+    PngReadState* state = (PngReadState*)png_get_io_ptr(png);
+    if (state->offset + size > state->size) png_error(png, "read past the end");
+    memcpy(out, state->data + state->offset, size);
+    state->offset += size;
+}
+
+// libpng's take on the same RGBA8 png_decode makes
+static bool reference_decode(const uint8_t* data, size_t size, std::vector<uint8_t>* out_rgba, uint32_t* out_width, uint32_t* out_height) {
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+    PngReadState state = { data, size, 0 };
+    png_set_read_fn(png, &state, png_read_memory);
+    png_read_info(png, info);
+    uint32_t width = png_get_image_width(png, info);
+    uint32_t height = png_get_image_height(png, info);
+    int color_type = png_get_color_type(png, info);
+    int bit_depth = png_get_bit_depth(png, info);
+    if (bit_depth == 16) png_set_scale_16(png);
+    if (color_type == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png);
+    if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8) png_set_expand_gray_1_2_4_to_8(png);
+    if (png_get_valid(png, info, PNG_INFO_tRNS)) png_set_tRNS_to_alpha(png);
+    if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) png_set_gray_to_rgb(png);
+    png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+
+    out_rgba->resize((size_t)width * height * 4);
+    std::vector<png_bytep> rows(height);
+    for (uint32_t y = 0; y < height; y++) rows[y] = out_rgba->data() + (size_t)y * width * 4;
+    png_read_image(png, rows.data());
+    png_destroy_read_struct(&png, &info, nullptr);
+    *out_width = width;
+    *out_height = height;
+    return true;
+}
+
+static void png_write_memory(png_structp png, png_bytep data, png_size_t size) {
+    std::vector<uint8_t>* out = (std::vector<uint8_t>*)png_get_io_ptr(png);
+    out->insert(out->end(), data, data + size);
+}
+
+static void png_flush_memory(png_structp) {}
+
+struct PngCase {
+    uint32_t width;
+    uint32_t height;
+    int color_type;
+    int bit_depth;
+    bool interlaced;
+    bool transparency;
+    int filters;
+    // lots of small IDATs instead of one
+    bool split_idat;
+};
+
+// noisy gradients, with a sprinkling of the tRNS key color so that gets hit
+static std::vector<uint8_t> make_png(const PngCase& c, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> out;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    png_set_write_fn(png, &out, png_write_memory, png_flush_memory);
+    png_set_IHDR(png, info, c.width, c.height, c.bit_depth, c.color_type,
+                 c.interlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_set_filter(png, 0, c.filters);
+    if (c.split_idat) png_set_compression_buffer_size(png, 1024);
+
+    if (c.color_type == PNG_COLOR_TYPE_PALETTE) {
+        png_color palette[256];
+        int entries = 1 << c.bit_depth;
+        for (int i = 0; i < entries; i++) palette[i] = { (png_byte)random(), (png_byte)random(), (png_byte)random() };
+        png_set_PLTE(png, info, palette, entries);
+        if (c.transparency) {
+            png_byte alphas[256];
+            for (int i = 0; i < entries / 2 + 1; i++) alphas[i] = (png_byte)random();
+            png_set_tRNS(png, info, alphas, entries / 2 + 1, nullptr);
+        }
+    } else if (c.transparency && (c.color_type == PNG_COLOR_TYPE_GRAY || c.color_type == PNG_COLOR_TYPE_RGB)) {
+        int max = (1 << c.bit_depth) - 1;
+        png_color_16 key = {};
+        key.gray = (png_uint_16)(3 & max);
+        key.red = (png_uint_16)(5 & max);
+        key.green = (png_uint_16)(7 & max);
+        key.blue = (png_uint_16)(9 & max);
+        png_set_tRNS(png, info, nullptr, 0, &key);
+    }
+    png_write_info(png, info);
+
+    int channels = c.color_type == PNG_COLOR_TYPE_RGB ? 3
+        : c.color_type == PNG_COLOR_TYPE_GRAY_ALPHA ? 2
+        : c.color_type == PNG_COLOR_TYPE_RGB_ALPHA ? 4 : 1;
+    size_t row_size = ((size_t)c.width * channels * c.bit_depth + 7) / 8;
+    std::vector<uint8_t> image(row_size * c.height);
+    for (uint32_t y = 0; y < c.height; y++) {
+        for (size_t x = 0; x < row_size; x++) {
+            uint8_t value = (uint8_t)((x * 3 + y * 5) / 4 + random() % 7);
+            if (random() % 50 == 0) {
+                value = c.bit_depth == 16 ? 0 : c.color_type == PNG_COLOR_TYPE_RGB ? (uint8_t)(x % 3 == 0 ? 5 : x % 3 == 1 ? 7 : 9) : 3;
+            }
+            image[y * row_size + x] = value;
+        }
+    }
+    std::vector<png_bytep> rows(c.height);
+    for (uint32_t y = 0; y < c.height; y++) rows[y] = image.data() + y * row_size;
+    png_write_image(png, rows.data());
+    png_write_end(png, info);
+    png_destroy_write_struct(&png, &info);
+    return out;
+}
+
+static bool matches_reference(const std::vector<uint8_t>& file) {
+    std::vector<uint8_t> reference;
+    uint32_t width;
+    uint32_t height;
+    if (!reference_decode(file.data(), file.size(), &reference, &width, &height)) return false;
+    uint32_t row_pitch = (width * 4 + 255) & ~255u;
+    std::vector<uint8_t> decoded((size_t)row_pitch * height);
+    if (!png_decode(file.data(), file.size(), decoded.data(), row_pitch)) return false;
+    for (uint32_t y = 0; y < height; y++) {
+        if (memcmp(decoded.data() + (size_t)y * row_pitch, reference.data() + (size_t)y * width * 4, width * 4) != 0) return false;
+    }
+    return true;
+}
+
+// every color type & bit depth, interlaced or not, with & without tRNS,
+//   each filter, sizes that leave partial bytes & empty Adam7 passes
+static void test_against_libpng() {
+    struct Format {
+        int color_type;
+        int bit_depth;
+    };
+    const Format formats[] = {
+        { PNG_COLOR_TYPE_GRAY, 1 }, { PNG_COLOR_TYPE_GRAY, 2 }, { PNG_COLOR_TYPE_GRAY, 4 }, { PNG_COLOR_TYPE_GRAY, 8 },
+        { PNG_COLOR_TYPE_GRAY, 16 }, { PNG_COLOR_TYPE_RGB, 8 }, { PNG_COLOR_TYPE_RGB, 16 }, { PNG_COLOR_TYPE_PALETTE, 1 },
+        { PNG_COLOR_TYPE_PALETTE, 2 }, { PNG_COLOR_TYPE_PALETTE, 4 }, { PNG_COLOR_TYPE_PALETTE, 8 },
+        { PNG_COLOR_TYPE_GRAY_ALPHA, 8 }, { PNG_COLOR_TYPE_GRAY_ALPHA, 16 }, { PNG_COLOR_TYPE_RGB_ALPHA, 8 },
+        { PNG_COLOR_TYPE_RGB_ALPHA, 16 },
+    };
+    const int filters[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH, PNG_ALL_FILTERS };
+    const uint32_t sizes[][2] = { { 1, 1 }, { 3, 2 }, { 7, 5 }, { 33, 17 }, { 64, 64 }, { 129, 3 } };
+
+    uint32_t cases = 0;
+    uint32_t mismatches = 0;
+    for (const Format& format : formats) {
+        for (bool interlaced : { false, true }) {
+            for (bool transparency : { false, true }) {
+                for (int filter : filters) {
+                    for (const uint32_t* size : sizes) {
+                        PngCase c = { size[0], size[1], format.color_type, format.bit_depth, interlaced, transparency, filter, cases % 3 == 0 };
+                        if (!matches_reference(make_png(c, cases))) {
+                            printf(
+                                "differs from libpng: color type %d, %d bits, %ux%u, interlaced %d, tRNS %d, filters %x\n",
+                                c.color_type, c.bit_depth, c.width, c.height, interlaced, transparency, filter
+                            );
+                            mismatches++;
+                        }
+                        cases++;
+                    }
+                }
+            }
+        }
+    }
+    printf("%u of %u synthetic PNGs identical to libpng\n", cases - mismatches, cases);
+    CHECK(mismatches == 0);
+}
+
+// flipped bytes & cut off files have to fail, not crash or read past the end
+static void test_corrupt_input() {
+    PngCase c = { 64, 64, PNG_COLOR_TYPE_RGB_ALPHA, 8, false, false, PNG_ALL_FILTERS, false };
+    std::vector<uint8_t> file = make_png(c, 1);
+    std::vector<uint8_t> decoded(256 * 64);
+    uint32_t accepted = 0;
+    for (size_t i = 8; i < file.size(); i += 7) {
+        std::vector<uint8_t> corrupt = file;
+        corrupt[i] ^= 0x5a;
+        accepted += png_decode(corrupt.data(), corrupt.size(), decoded.data(), 256);
+    }
+    for (size_t size = 0; size < file.size(); size += 13) {
+        accepted += png_decode(file.data(), size, decoded.data(), 256);
+    }
+    CHECK(accepted == 0);
+
+    // the deflate stream on its own, where there are no chunk CRCs to catch it
+    c.color_type = PNG_COLOR_TYPE_RGB;
+    file = make_png(c, 2);
+    const uint8_t* idat = nullptr;
+    uint32_t idat_size = 0;
+    for (size_t offset = 8; offset + 12 <= file.size();) {
+        uint32_t length = (uint32_t)file[offset] << 24 | file[offset + 1] << 16 | file[offset + 2] << 8 | file[offset + 3];
+        if (memcmp(&file[offset + 4], "IDAT", 4) == 0) {
+            idat = &file[offset + 8];
+            idat_size = length;
+            break;
+        }
+        offset += length + 12;
+    }
+    if (!CHECK(idat)) return;
+    std::vector<uint8_t> clean(64 * (64 * 3 + 1));
+    CHECK(zlib_inflate(idat, idat_size, clean.data(), clean.size()));
+    std::mt19937 random(23);
+    std::vector<uint8_t> inflated(clean.size());
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < 20000; i++) {
+        std::vector<uint8_t> corrupt(idat, idat + idat_size);
+        for (uint32_t flips = 1 + random() % 3; flips > 0; flips--) corrupt[2 + random() % (idat_size - 2)] ^= (uint8_t)(1 << (random() % 8));
+        // a flip in the padding after the last block changes nothing, that's fine
+        wrong += zlib_inflate(corrupt.data(), corrupt.size(), inflated.data(), inflated.size()) && inflated != clean;
+    }
+    CHECK(wrong == 0);
+}
+
+// every PNG under Assets, best of 3 each for both
+static void bench_assets() {
+    std::vector<std::string> paths;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(TEST_ASSETS_DIR)) {
+        if (entry.path().extension() == ".png") paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    double reference_seconds = 0.0;
+    double decode_seconds = 0.0;
+    double inflate_seconds = 0.0;
+    double unfilter_seconds = 0.0;
+    uint64_t texels = 0;
+    uint32_t identical = 0;
+    for (const std::string& path : paths) {
+        MappedFile file;
+        if (!CHECK(mapped_file_open(path.c_str(), &file))) continue;
+        std::vector<uint8_t> reference;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        double best_reference = 1e9;
+        for (uint32_t run = 0; run < 3; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            reference_decode(file.data, file.size, &reference, &width, &height);
+            best_reference = std::min(best_reference, test_seconds_since(start));
+        }
+
+        uint32_t row_pitch = (width * 4 + 255) & ~255u;
+        std::vector<uint8_t> decoded((size_t)row_pitch * height);
+        double best_decode = 1e9;
+        PngDecodeStats best_stats = {};
+        bool ok = true;
+        for (uint32_t run = 0; run < 3; run++) {
+            PngDecodeStats stats = {};
+            auto start = std::chrono::high_resolution_clock::now();
+            ok &= png_decode(file.data, file.size, decoded.data(), row_pitch, &stats);
+            double seconds = test_seconds_since(start);
+            if (seconds < best_decode) {
+                best_decode = seconds;
+                best_stats = stats;
+            }
+        }
+        mapped_file_close(&file);
+
+        bool same = ok;
+        for (uint32_t y = 0; same && y < height; y++) {
+            same = memcmp(decoded.data() + (size_t)y * row_pitch, reference.data() + (size_t)y * width * 4, width * 4) == 0;
+        }
+        if (!same) printf("differs from libpng: %s\n", path.c_str());
+        identical += same;
+        reference_seconds += best_reference;
+        decode_seconds += best_decode;
+        inflate_seconds += best_stats.inflate_seconds;
+        unfilter_seconds += best_stats.unfilter_seconds;
+        texels += (uint64_t)width * height;
+    }
+    CHECK(identical == paths.size());
+    printf(
+        "%zu asset PNGs, %.1f Mtexels: libpng %.1f ms, png_decode %.1f ms (%.2fx, %.1f ms inflating & %.1f ms unfiltering)\n",
+        paths.size(), texels / 1e6, reference_seconds * 1e3, decode_seconds * 1e3, reference_seconds / decode_seconds,
+        inflate_seconds * 1e3, unfilter_seconds * 1e3
+    );
+}
+
+int main() {
+    test_against_libpng();
+    test_corrupt_input();
+    bench_assets();
+    return test_finish();
+}
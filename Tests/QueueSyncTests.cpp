@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "QueueSync.h"
+#include "TestCheck.h"
+
+static void test_waits() {
+    MockUploadFence fence;
+    MockQueueWaiter queue;
+    QueueSync sync;
+    queue_sync_create(&sync);
+
+    // reads nothing, waits on nothing
+    CHECK(queue_sync_submit(&sync, &fence, &queue) && queue.waits.empty());
+
+    // only the highest value read gets waited on, not the highest signaled
+    queue_sync_signaled(&sync, 5);
+    fence.complete(1);
+    queue_sync_require(&sync, 2);
+    queue_sync_require(&sync, 3);
+    queue_sync_require(&sync, 1);
+    CHECK(queue_sync_submit(&sync, &fence, &queue));
+    CHECK(queue.waits.size() == 1 && queue.waits[0] == 3);
+
+    // the queue's already waited on it
+    queue_sync_require(&sync, 3);
+    CHECK(queue_sync_submit(&sync, &fence, &queue) && queue.waits.size() == 1);
+
+    // the CPU's seen it finish, so the GPU has too
+    fence.complete(4);
+    queue_sync_require(&sync, 4);
+    CHECK(queue_sync_submit(&sync, &fence, &queue) && queue.waits.size() == 1);
+
+    // never signaled: waits on what was & says so
+    queue_sync_require(&sync, 9);
+    CHECK(!queue_sync_submit(&sync, &fence, &queue));
+    CHECK(queue.waits.size() == 2 && queue.waits[1] == 5);
+
+    // what a submit reads doesn't carry over to the next one
+    CHECK(queue_sync_submit(&sync, &fence, &queue) && queue.waits.size() == 2);
+    CHECK(sync.stats.submit_count == 6 && sync.stats.dependent_submit_count == 3);
+    CHECK(sync.stats.wait_count == 2 && sync.stats.unsignaled_count == 1);
+}
+
+// random reads, signals & fence progress. every submit has to see what it
+//   reads (done on the CPU's side or waited on), never wait on something
+//   that wasn't signaled & never wait when it didn't need to
+static void test_random_against_model() {
+    std::mt19937 random(20);
+    MockUploadFence fence;
+    MockQueueWaiter queue;
+    QueueSync sync;
+    queue_sync_create(&sync);
+
+    uint64_t signaled = 0;
+    uint64_t waited = 0;
+    uint32_t unseen = 0;
+    uint32_t bad_waits = 0;
+    uint32_t needless_waits = 0;
+    for (uint32_t i = 0; i < 100000; i++) {
+        if (random() % 3 == 0) {
+            signaled += 1 + random() % 2;
+            queue_sync_signaled(&sync, signaled);
+        }
+        if (random() % 2 == 0 && fence.completed_value < signaled) fence.complete(fence.completed_value + 1 + random() % (signaled - fence.completed_value));
+
+        // mostly values that are already out, now & then one that isn't yet
+        uint64_t required = 0;
+        for (uint32_t r = random() % 4; r > 0; r--) {
+            uint64_t value = random() % 20 == 0 ? signaled + 1 : random() % (signaled + 1);
+            queue_sync_require(&sync, value);
+            required = value > required ? value : required;
+        }
+
+        size_t wait_count = queue.waits.size();
+        bool signaled_before = queue_sync_submit(&sync, &fence, &queue);
+        CHECK(signaled_before == (required <= signaled));
+        if (queue.waits.size() > wait_count) {
+            uint64_t value = queue.waits.back();
+            bad_waits += value > signaled || value <= waited;
+            needless_waits += value <= fence.completed_value || value > required;
+            waited = value > waited ? value : waited;
+        }
+        uint64_t needed = required <= signaled ? required : signaled;
+        unseen += needed > waited && needed > fence.completed_value;
+    }
+    CHECK(unseen == 0);
+    CHECK(bad_waits == 0);
+    CHECK(needless_waits == 0);
+}
+
+struct StreamingRun {
+    double average_ms;
+    double p99_ms;
+    double worst_ms;
+    uint64_t wait_count;
+};
+
+enum StreamingMode {
+    // uploads recorded on the direct queue ahead of the frame
+    STREAMING_SAME_QUEUE,
+    // on the copy queue, every frame waits on the newest batch
+    STREAMING_WAIT_NEWEST,
+    // on the copy queue, frames wait on what they read (the sky, from the first batch)
+    STREAMING_WAIT_REQUIRED,
+};
+
+// both queues run in order & alongside each other. the CPU sends a frame
+//   every cpu_ms that takes gpu_ms, & every stream_every frames a batch of
+//   stream_ms worth of copies. entities only get drawn once they're
+//   resident, so the only thing a frame reads that might not be is the sky
+static StreamingRun simulate_streaming(StreamingMode mode, uint32_t frames, double cpu_ms, double gpu_ms, uint32_t stream_every, double stream_ms) {
+    MockUploadFence fence;
+    MockQueueWaiter queue;
+    QueueSync sync;
+    queue_sync_create(&sync);
+
+    double copy_free = 0.0;
+    double direct_free = 0.0;
+    // when each upload batch (fence value - 1) finishes
+    std::vector<double> batch_done;
+    auto flush = [&](double now) {
+        double& queue_free = mode == STREAMING_SAME_QUEUE ? direct_free : copy_free;
+        queue_free = std::max(now, queue_free) + stream_ms;
+        batch_done.push_back(queue_free);
+        queue_sync_signaled(&sync, batch_done.size());
+    };
+
+    // the scene's first batch has the sky in it
+    flush(0.0);
+    std::vector<double> presents;
+    double now = 0.0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        now += cpu_ms;
+        if (frame > 0 && frame % stream_every == 0) flush(now);
+        uint64_t completed = 0;
+        for (size_t i = 0; i < batch_done.size(); i++) completed = batch_done[i] <= now ? i + 1 : completed;
+        fence.complete(completed);
+
+        if (mode == STREAMING_WAIT_NEWEST) queue_sync_require(&sync, batch_done.size());
+        if (mode == STREAMING_WAIT_REQUIRED) queue_sync_require(&sync, 1);
+        size_t wait_count = queue.waits.size();
+        if (mode != STREAMING_SAME_QUEUE) queue_sync_submit(&sync, &fence, &queue);
+
+        double start = std::max(now, direct_free);
+        if (queue.waits.size() > wait_count) start = std::max(start, batch_done[queue.waits.back() - 1]);
+        direct_free = start + gpu_ms;
+        presents.push_back(direct_free);
+    }
+
+    // skip the first few frames, they're all waiting on the scene
+    std::vector<double> frame_times;
+    for (size_t i = 10; i < presents.size(); i++) frame_times.push_back(presents[i] - presents[i - 1]);
+    std::sort(frame_times.begin(), frame_times.end());
+    double sum = 0.0;
+    for (double frame_time : frame_times) sum += frame_time;
+    return { sum / frame_times.size(), frame_times[frame_times.size() * 99 / 100], frame_times.back(), sync.stats.wait_count };
+}
+
+// a 20 ms batch every 50 frames, in the way of the frames or beside them
+static void bench_streaming() {
+    const char* names[] = { "same queue", "copy queue, wait on newest", "copy queue, wait on required" };
+    StreamingRun runs[3];
+    printf("6 ms cpu & 5 ms gpu frames, a 20 ms upload batch every 50 frames\n");
+    for (uint32_t mode = 0; mode < 3; mode++) {
+        runs[mode] = simulate_streaming((StreamingMode)mode, 2000, 6.0, 5.0, 50, 20.0);
+        printf(
+            "  %-28s average %.2f ms, p99 %.2f ms, worst %.2f ms, %llu gpu waits\n",
+            names[mode], runs[mode].average_ms, runs[mode].p99_ms, runs[mode].worst_ms, (unsigned long long)runs[mode].wait_count
+        );
+    }
+    // only the first frame has to wait for the sky, streaming never hitches
+    CHECK(runs[STREAMING_WAIT_REQUIRED].wait_count == 1);
+    CHECK(runs[STREAMING_WAIT_REQUIRED].worst_ms < runs[STREAMING_SAME_QUEUE].worst_ms);
+    CHECK(runs[STREAMING_WAIT_REQUIRED].worst_ms < runs[STREAMING_WAIT_NEWEST].worst_ms);
+    CHECK(runs[STREAMING_WAIT_REQUIRED].worst_ms <= 6.0 + 1e-9);
+}
+
+int main() {
+    test_waits();
+    test_random_against_model();
+    bench_streaming();
+    return test_finish();
+}
@@ -0,0 +1,260 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "RenderGraph.h"
+#include "TestCheck.h"
+
+constexpr uint32_t GBUFFER_COUNT = 4;
+
+// says every acquire after the first reuses earlier memory, like the
+//   transient pool does for a chain of temporaries
+class AliasingDevice : public MockRenderGraphDevice {
+   public:
+    void* acquire_transient(const RenderGraphTextureDesc& desc, bool* out_aliased) override {
+        void* native = MockRenderGraphDevice::acquire_transient(desc, out_aliased);
+        *out_aliased = acquire_count > 1;
+        return native;
+    }
+};
+
+// the frame Game::BuildRenderGraph builds, plus a debug view nothing reads
+static void build_game_graph(RenderGraph* graph, bool debug_pass, std::string* order) {
+    render_graph_reset(graph);
+    uint32_t back_buffer = render_graph_import(graph, "back buffer", (void*)0x10, RG_STATE_PRESENT, RG_STATE_PRESENT);
+    uint32_t depth = render_graph_import(graph, "depth", (void*)0x20, RG_STATE_DEPTH_WRITE, RG_STATE_DEPTH_WRITE);
+
+    RenderGraphTextureDesc desc = {};
+    desc.initial_state = RG_STATE_PIXEL_SHADER_RESOURCE;
+    uint32_t gbuffer[GBUFFER_COUNT];
+    for (uint32_t i = 0; i < GBUFFER_COUNT; i++) {
+        gbuffer[i] = render_graph_create_texture(graph, "gbuffer", desc);
+    }
+
+    uint32_t pass = render_graph_add_pass(graph, "gbuffer", [=]() { *order += "gbuffer "; });
+    for (uint32_t i = 0; i < GBUFFER_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    }
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_WRITE);
+
+    pass = render_graph_add_pass(graph, "sky", [=]() { *order += "sky "; });
+    for (uint32_t i = 0; i < GBUFFER_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_RENDER_TARGET, RG_USE_READ | RG_USE_WRITE);
+    }
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_READ);
+
+    if (debug_pass) {
+        uint32_t debug = render_graph_create_texture(graph, "debug", desc);
+        pass = render_graph_add_pass(graph, "debug", [=]() { *order += "debug "; });
+        render_graph_use(graph, pass, gbuffer[1], RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+        render_graph_use(graph, pass, debug, RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    }
+
+    pass = render_graph_add_pass(graph, "combine", [=]() { *order += "combine "; });
+    for (uint32_t i = 0; i < GBUFFER_COUNT; i++) {
+        render_graph_use(graph, pass, gbuffer[i], RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+    }
+    render_graph_use(graph, pass, back_buffer, RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    render_graph_use(graph, pass, depth, RG_STATE_DEPTH_WRITE, RG_USE_READ);
+}
+
+static void test_game_graph() {
+    RenderGraph graph;
+    std::string order;
+    build_game_graph(&graph, false, &order);
+    render_graph_compile(&graph);
+    MockRenderGraphDevice device;
+    render_graph_execute(&graph, &device);
+
+    CHECK(order == "gbuffer sky combine ");
+    // gbuffer: 4 targets PSR -> RT. combine: 4 targets RT -> PSR & the back
+    //   buffer PRESENT -> RT. after: the back buffer back to PRESENT. the
+    //   targets end where they started, so they need nothing more
+    CHECK(graph.stats.barrier_count == 10);
+    CHECK(graph.stats.barrier_batch_count == 3);
+    if (CHECK(device.batches.size() == 3)) {
+        CHECK(device.batches[0].barriers.size() == 4);
+        CHECK(device.batches[1].barriers.size() == 5);
+        CHECK(device.batches[2].barriers.size() == 1);
+        CHECK(device.batches[2].natives[0] == (void*)0x10);
+        CHECK(device.batches[2].barriers[0].before == RG_STATE_RENDER_TARGET);
+        CHECK(device.batches[2].barriers[0].after == RG_STATE_PRESENT);
+    }
+    for (const MockRenderGraphDevice::Batch& batch : device.batches) {
+        for (void* native : batch.natives) CHECK(native != nullptr);
+    }
+    CHECK(device.acquire_count == GBUFFER_COUNT && device.release_count == GBUFFER_COUNT);
+}
+
+// a pass whose output nobody reads doesn't run & costs nothing
+static void test_culling() {
+    RenderGraph graph;
+    std::string order;
+    build_game_graph(&graph, true, &order);
+    render_graph_compile(&graph);
+    MockRenderGraphDevice device;
+    render_graph_execute(&graph, &device);
+
+    CHECK(order == "gbuffer sky combine ");
+    CHECK(graph.stats.culled_pass_count == 1 && !graph.passes[2].live);
+    CHECK(graph.stats.barrier_count == 10);
+    CHECK(device.acquire_count == GBUFFER_COUNT);
+}
+
+// reads in different states back to back merge into one transition to all of them
+static void test_read_merging() {
+    RenderGraph graph;
+    render_graph_reset(&graph);
+    RenderGraphTextureDesc desc = {};
+    desc.initial_state = RG_STATE_COMMON;
+    uint32_t texture = render_graph_create_texture(&graph, "texture", desc);
+    uint32_t output = render_graph_import(&graph, "output", (void*)0x30, RG_STATE_COMMON, RG_STATE_COMMON);
+
+    uint32_t pass = render_graph_add_pass(&graph, "write", []() {});
+    render_graph_use(&graph, pass, texture, RG_STATE_UNORDERED_ACCESS, RG_USE_WRITE);
+    const uint32_t read_states[] = { RG_STATE_PIXEL_SHADER_RESOURCE, RG_STATE_NON_PIXEL_SHADER_RESOURCE, RG_STATE_PIXEL_SHADER_RESOURCE };
+    for (uint32_t state : read_states) {
+        pass = render_graph_add_pass(&graph, "read", []() {});
+        render_graph_use(&graph, pass, texture, state, RG_USE_READ);
+        render_graph_use(&graph, pass, output, RG_STATE_RENDER_TARGET, RG_USE_READ | RG_USE_WRITE);
+    }
+    render_graph_compile(&graph);
+
+    // write: COMMON -> UAV. first read: UAV -> PSR | NPSR, output COMMON -> RT.
+    //   after: output back to COMMON, the texture back to its initial state
+    CHECK(graph.stats.barrier_count == 5);
+    CHECK(graph.barriers[1].after == (RG_STATE_PIXEL_SHADER_RESOURCE | RG_STATE_NON_PIXEL_SHADER_RESOURCE));
+    CHECK(graph.passes[2].barrier_count == 0 && graph.passes[3].barrier_count == 0);
+}
+
+// a chain of temporaries, each read by the next pass only. every one after
+//   the first lands in aliased memory, so it needs an aliasing barrier, &
+//   whatever died before it has to be put back (to COMMON) first
+static void test_aliasing_chain() {
+    constexpr uint32_t CHAIN_LENGTH = 6;
+    RenderGraph graph;
+    render_graph_reset(&graph);
+    RenderGraphTextureDesc desc = {};
+    desc.initial_state = RG_STATE_COMMON;
+    uint32_t output = render_graph_import(&graph, "output", (void*)0x30, RG_STATE_COMMON, RG_STATE_COMMON);
+
+    uint32_t previous = RENDER_GRAPH_NONE;
+    for (uint32_t i = 0; i < CHAIN_LENGTH; i++) {
+        uint32_t texture = render_graph_create_texture(&graph, "temporary", desc);
+        uint32_t pass = render_graph_add_pass(&graph, "step", []() {});
+        if (previous != RENDER_GRAPH_NONE) {
+            render_graph_use(&graph, pass, previous, RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+        }
+        render_graph_use(&graph, pass, texture, RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+        previous = texture;
+    }
+    uint32_t pass = render_graph_add_pass(&graph, "final", []() {});
+    render_graph_use(&graph, pass, previous, RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+    render_graph_use(&graph, pass, output, RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+    render_graph_compile(&graph);
+
+    AliasingDevice device;
+    render_graph_execute(&graph, &device);
+    CHECK(device.acquire_count == CHAIN_LENGTH && device.release_count == CHAIN_LENGTH);
+
+    uint32_t aliasing_barriers = 0;
+    uint32_t returns = 0;
+    uint32_t late_returns = 0;
+    for (const MockRenderGraphDevice::Batch& batch : device.batches) {
+        bool aliased = false;
+        for (const RenderGraphBarrier& barrier : batch.barriers) {
+            if (barrier.before == RENDER_GRAPH_NONE) {
+                CHECK(barrier.after == RENDER_GRAPH_NONE);
+                aliased = true;
+                aliasing_barriers++;
+            } else if (barrier.after == RG_STATE_COMMON && graph.resources[barrier.resource].transient) {
+                returns++;
+                late_returns += aliased;
+            }
+        }
+    }
+    CHECK(aliasing_barriers == CHAIN_LENGTH - 1);
+    CHECK(returns == CHAIN_LENGTH);
+    CHECK(late_returns == 0);
+}
+
+// a big random graph: every transient acquired is released, every barrier
+//   starts in the state the last one left its resource in
+static void test_random_graph() {
+    constexpr uint32_t TEXTURE_COUNT = 64;
+    constexpr uint32_t PASS_COUNT = 256;
+    std::mt19937 random(1);
+    RenderGraph graph;
+    render_graph_reset(&graph);
+    RenderGraphTextureDesc desc = {};
+    desc.initial_state = RG_STATE_PIXEL_SHADER_RESOURCE;
+    uint32_t output = render_graph_import(&graph, "output", (void*)0x30, RG_STATE_COMMON, RG_STATE_COMMON);
+    std::vector<uint32_t> textures;
+    for (uint32_t i = 0; i < TEXTURE_COUNT; i++) {
+        textures.push_back(render_graph_create_texture(&graph, "texture", desc));
+    }
+    for (uint32_t p = 0; p < PASS_COUNT; p++) {
+        uint32_t pass = render_graph_add_pass(&graph, "pass", []() {});
+        for (uint32_t u = 0; u < 4; u++) {
+            render_graph_use(&graph, pass, textures[random() % TEXTURE_COUNT], RG_STATE_PIXEL_SHADER_RESOURCE, RG_USE_READ);
+        }
+        render_graph_use(&graph, pass, textures[random() % TEXTURE_COUNT], RG_STATE_RENDER_TARGET, RG_USE_WRITE);
+        if (p % 16 == 15) render_graph_use(&graph, pass, output, RG_STATE_RENDER_TARGET, RG_USE_READ | RG_USE_WRITE);
+    }
+
+    const uint32_t COMPILE_COUNT = 2000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < COMPILE_COUNT; i++) render_graph_compile(&graph);
+    double seconds = test_seconds_since(start);
+
+    MockRenderGraphDevice device;
+    render_graph_execute(&graph, &device);
+    CHECK(device.acquire_count == device.release_count);
+
+    // replay the barriers, nothing may transition out of a state it isn't in
+    std::vector<uint32_t> states(graph.resources.size());
+    for (size_t r = 0; r < graph.resources.size(); r++) states[r] = graph.resources[r].initial_state;
+    uint32_t mismatches = 0;
+    for (const MockRenderGraphDevice::Batch& batch : device.batches) {
+        for (const RenderGraphBarrier& barrier : batch.barriers) {
+            if (barrier.before == RENDER_GRAPH_NONE) continue;
+            mismatches += states[barrier.resource] != barrier.before;
+            states[barrier.resource] = barrier.after;
+        }
+    }
+    CHECK(mismatches == 0);
+    for (size_t r = 0; r < graph.resources.size(); r++) {
+        const RenderGraphResource& resource = graph.resources[r];
+        CHECK(states[r] == (resource.transient ? resource.desc.initial_state : resource.final_state));
+    }
+
+    printf(
+        "%u passes, %u transients: compile %.1f us, %u culled, %u barriers in %u batches\n",
+        PASS_COUNT, TEXTURE_COUNT, seconds * 1e6 / COMPILE_COUNT,
+        graph.stats.culled_pass_count, graph.stats.barrier_count, graph.stats.barrier_batch_count
+    );
+}
+
+static void bench_game_graph() {
+    RenderGraph graph;
+    std::string order;
+    constexpr uint32_t COUNT = 100000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        build_game_graph(&graph, true, &order);
+        render_graph_compile(&graph);
+    }
+    double seconds = test_seconds_since(start);
+    printf("game graph build + compile: %.0f ns\n", seconds * 1e9 / COUNT);
+}
+
+int main() {
+    test_game_graph();
+    test_culling();
+    test_read_merging();
+    test_aliasing_chain();
+    test_random_graph();
+    bench_game_graph();
+    return test_finish();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// bare bones checks for the tests under Tests/, a failed one prints where &
+//   carries on so one run shows everything that's broken
+
+inline int& test_failure_count() {
+    static int count = 0;
+    return count;
+}
+
+inline bool test_check(bool passed, const char* expression, const char* file, int line) {
+    if (!passed) {
+        printf("FAILED %s:%d: %s\n", file, line, expression);
+        test_failure_count()++;
+    }
+    return passed;
+}
+
+#define CHECK(expression) test_check((expression), #expression, __FILE__, __LINE__)
+
+// what main returns
+inline int test_finish() {
+    if (test_failure_count() > 0) {
+        printf("%d check(s) failed\n", test_failure_count());
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+inline std::string test_asset_path(const char* relative) {
+    return std::string(TEST_ASSETS_DIR) + "/" + relative;
+}
+
+inline double test_seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
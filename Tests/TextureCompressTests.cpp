@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "TestCheck.h"
+#include "TextureCompress.h"
+#include "TextureCooker.h"
+
+static const char* const FORMAT_NAMES[] = { "RGBA8", "BC1", "BC4", "BC5", "BC7" };
+
+// the channels each format keeps, as a mask of RGBA
+static uint32_t format_channels(uint32_t format) {
+    switch (format) {
+        case TEXTURE_FORMAT_BC1: return 0x7;
+        case TEXTURE_FORMAT_BC4: return 0x1;
+        case TEXTURE_FORMAT_BC5: return 0x3;
+        default: return 0xf;
+    }
+}
+
+static double psnr(const uint8_t* a, const uint8_t* b, uint32_t texel_count, uint32_t channels) {
+    double squared_error = 0.0;
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < texel_count; i++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            if (!(channels >> c & 1)) continue;
+            double error = (double)a[i * 4 + c] - b[i * 4 + c];
+            squared_error += error * error;
+            count++;
+        }
+    }
+    // identical, call it 99
+    return squared_error == 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 * count / squared_error);
+}
+
+static int max_error(const uint8_t* a, const uint8_t* b, uint32_t channels) {
+    int worst = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            if (channels >> c & 1) worst = std::max(worst, abs(a[i * 4 + c] - b[i * 4 + c]));
+        }
+    }
+    return worst;
+}
+
+// flat blocks & a two value BC4 block come back exact (or a step off where
+//   the endpoint precision can't hit the value), noise stays watchable
+static void test_blocks() {
+    uint8_t texels[64];
+    uint8_t block[16];
+    uint8_t decoded[64];
+    for (int value : { 0, 17, 128, 255 }) {
+        for (uint32_t i = 0; i < 64; i++) texels[i] = (uint8_t)(i % 4 == 3 ? 255 : value);
+        bc7_encode_block(texels, block);
+        bc7_decode_block(block, decoded);
+        CHECK(max_error(texels, decoded, 0xf) <= 1);
+        bc4_encode_block(texels, 0, block);
+        bc4_decode_block(block, decoded);
+        CHECK(max_error(texels, decoded, 0x1) == 0);
+        bc5_encode_block(texels, block);
+        bc5_decode_block(block, decoded);
+        CHECK(max_error(texels, decoded, 0x3) == 0);
+        bc1_encode_block(texels, block);
+        bc1_decode_block(block, decoded);
+        CHECK(max_error(texels, decoded, 0x7) <= 4);
+    }
+
+    for (uint32_t i = 0; i < 16; i++) texels[i * 4] = i & 1 ? 200 : 10;
+    bc4_encode_block(texels, 0, block);
+    bc4_decode_block(block, decoded);
+    CHECK(max_error(texels, decoded, 0x1) == 0);
+
+    std::mt19937 random(22);
+    double worst = 99.0;
+    for (uint32_t i = 0; i < 2000; i++) {
+        for (uint8_t& texel : texels) texel = (uint8_t)random();
+        bc7_encode_block(texels, block);
+        bc7_decode_block(block, decoded);
+        worst = std::min(worst, psnr(texels, decoded, 16, 0xf));
+    }
+    CHECK(worst > 10.0);
+}
+
+struct FormatTotals {
+    double psnr_sum;
+    uint32_t texture_count;
+    double texels;
+    double seconds;
+};
+
+// every asset in the format cooking picks for it (& albedo in BC1 too, to
+//   see what BC7 buys), quality over the channels the format keeps
+static void bench_assets() {
+    std::vector<std::string> names;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(test_asset_path("Textures"))) {
+        if (entry.path().extension() == ".png") names.push_back(entry.path().filename().string());
+    }
+    std::sort(names.begin(), names.end());
+
+    PngImageDecoder decoder;
+    FormatTotals totals[5] = {};
+    for (const std::string& name : names) {
+        std::string path = test_asset_path(("Textures/" + name).c_str());
+        MappedFile file;
+        if (!CHECK(mapped_file_open(path.c_str(), &file))) continue;
+        ImageInfo info;
+        CHECK(decoder.read_info(file.data, file.size, &info));
+        std::vector<uint8_t> rgba((size_t)info.width * info.height * 4);
+        CHECK(decoder.decode(file.data, file.size, rgba.data(), info.width * 4));
+        mapped_file_close(&file);
+
+        uint32_t role = texture_role_from_path(path.c_str());
+        uint32_t formats[2] = { texture_role_format(role, info.width, info.height), TEXTURE_FORMAT_RGBA8 };
+        if (role == TEXTURE_ROLE_ALBEDO) formats[1] = TEXTURE_FORMAT_BC1;
+        for (uint32_t format : formats) {
+            if (!texture_format_is_block(format)) continue;
+            uint32_t row_pitch = texture_format_row_pitch(format, info.width);
+            std::vector<uint8_t> compressed((size_t)row_pitch * texture_format_row_count(format, info.height));
+            std::vector<uint8_t> decompressed(rgba.size());
+            TextureCompressStats stats = {};
+            texture_compress(rgba.data(), info.width, info.height, info.width * 4, format, compressed.data(), row_pitch, &stats);
+            texture_decompress(compressed.data(), info.width, info.height, row_pitch, format, decompressed.data(), info.width * 4);
+
+            double quality = psnr(rgba.data(), decompressed.data(), info.width * info.height, format_channels(format));
+            // the assets all land well above this, BC1's 565 endpoints get a bit less room
+            CHECK(quality > (format == TEXTURE_FORMAT_BC1 ? 28.0 : 32.0));
+            printf(
+                "%-26s %4ux%-4u %-4s %6.2f dB %7.1f ms\n",
+                name.c_str(), info.width, info.height, FORMAT_NAMES[format], quality, stats.seconds * 1e3
+            );
+            FormatTotals& total = totals[format];
+            total.psnr_sum += quality;
+            total.texture_count++;
+            total.texels += (double)info.width * info.height;
+            total.seconds += stats.seconds;
+        }
+    }
+    for (uint32_t format = TEXTURE_FORMAT_BC1; format <= TEXTURE_FORMAT_BC7; format++) {
+        const FormatTotals& total = totals[format];
+        if (total.texture_count == 0) continue;
+        printf(
+            "%s: %.2f dB on average over %u textures, %.1f Mtexel/s\n",
+            FORMAT_NAMES[format], total.psnr_sum / total.texture_count, total.texture_count, total.texels / total.seconds / 1e6
+        );
+    }
+    CHECK(totals[TEXTURE_FORMAT_BC7].psnr_sum / totals[TEXTURE_FORMAT_BC7].texture_count
+          > totals[TEXTURE_FORMAT_BC1].psnr_sum / totals[TEXTURE_FORMAT_BC1].texture_count);
+}
+
+int main() {
+    test_blocks();
+    bench_assets();
+    return test_finish();
+}
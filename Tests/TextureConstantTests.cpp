@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "TestCheck.h"
+#include "TextureConstant.h"
+
+// D3D12's texture copy alignments
+constexpr uint32_t ROW_ALIGNMENT = 256;
+constexpr uint32_t MIP_ALIGNMENT = 512;
+
+// one texel at a time in doubles
+static void reference_scan(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t row_pitch, TextureUniformity* out_uniformity) {
+    for (uint32_t c = 0; c < 4; c++) {
+        uint8_t min = 255;
+        uint8_t max = 0;
+        double sum = 0.0;
+        double squares = 0.0;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t value = rgba[(uint64_t)y * row_pitch + x * TEXTURE_TEXEL_SIZE + c];
+                min = value < min ? value : min;
+                max = value > max ? value : max;
+                sum += value;
+                squares += (double)value * value;
+            }
+        }
+        double count = (double)width * height;
+        double mean = sum / count;
+        double variance = squares / count - mean * mean;
+        out_uniformity->channels[c] = { min, max, (float)mean, variance > 0.0 ? (float)variance : 0.0f };
+    }
+}
+
+static bool scans_match(const TextureUniformity& a, const TextureUniformity& b) {
+    for (uint32_t c = 0; c < 4; c++) {
+        const TextureChannelStats& x = a.channels[c];
+        const TextureChannelStats& y = b.channels[c];
+        if (x.min != y.min || x.max != y.max) return false;
+        if (fabsf(x.mean - y.mean) > 1e-3f || fabsf(x.variance - y.variance) > 1e-2f + y.variance * 1e-4f) return false;
+    }
+    return true;
+}
+
+// widths either side of the 4 texel steps, padded pitches, noise of every
+//   spread from flat to full range
+static void test_scan_against_reference() {
+    std::mt19937 random(25);
+    uint32_t mismatched = 0;
+    for (uint32_t width = 1; width <= 23; width++) {
+        for (uint32_t height : { 1u, 2u, 7u, 16u }) {
+            for (uint32_t spread : { 0u, 3u, 40u, 256u }) {
+                uint32_t row_pitch = width * TEXTURE_TEXEL_SIZE + 12;
+                std::vector<uint8_t> rgba(row_pitch * height, 0xcd);
+                uint8_t base = (uint8_t)(random() % (257 - spread));
+                for (uint32_t y = 0; y < height; y++) {
+                    for (uint32_t x = 0; x < width * TEXTURE_TEXEL_SIZE; x++) {
+                        rgba[y * row_pitch + x] = (uint8_t)(base + (spread ? random() % spread : 0));
+                    }
+                }
+                TextureUniformity scanned;
+                TextureUniformity reference;
+                texture_uniformity_scan(rgba.data(), width, height, row_pitch, &scanned);
+                reference_scan(rgba.data(), width, height, row_pitch, &reference);
+                mismatched += !scans_match(scanned, reference);
+            }
+        }
+    }
+    CHECK(mismatched == 0);
+}
+
+// range & deviation both have to pass, per channel
+static void test_thresholds() {
+    TextureUniformity uniformity = {};
+    uniformity.channels[0] = { 100, 100 + CONSTANT_MAX_RANGE, 102.4f, 0.5f };
+    uniformity.channels[1] = { 100, 100 + CONSTANT_MAX_RANGE + 1, 102.0f, 0.5f };
+    uniformity.channels[2] = { 100, 101, 100.5f, CONSTANT_MAX_DEVIATION * CONSTANT_MAX_DEVIATION * 1.5f };
+    uniformity.channels[3] = { 255, 255, 255.0f, 0.0f };
+    TextureConstant constant = texture_constant_from(uniformity);
+    CHECK(constant.channels == (TEXTURE_CHANNEL_R | TEXTURE_CHANNEL_A));
+    CHECK(constant.value[0] == 102 && constant.value[3] == 255);
+    CHECK(texture_constant_pack(constant) >> 24 == 255 && (texture_constant_pack(constant) & 0xff) == 102);
+
+    // collapsing leaves one texel of the value at the start
+    std::vector<uint8_t> staging(4096, 0);
+    TextureLayout layout;
+    texture_layout_compute(32, 32, 0, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    texture_collapse(staging.data(), constant, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    CHECK(layout.mip_count == 1 && layout.mips[0].width == 1 && layout.mips[0].height == 1);
+    CHECK(staging[layout.mips[0].offset] == 102 && staging[layout.mips[0].offset + 3] == 255);
+}
+
+// what the loader decides for every PNG under Assets/Textures: each
+//   channel's range & deviation, which of them are flat & what collapsing
+//   saves (only textures flat in all four collapse). the scan's checked
+//   against the reference on the way & timed against it
+static void bench_assets() {
+    std::vector<std::string> names;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(test_asset_path("Textures"))) {
+        if (entry.path().extension() == ".png") names.push_back(entry.path().filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    CHECK(!names.empty());
+
+    PngImageDecoder decoder;
+    double scan_seconds = 0.0;
+    double reference_seconds = 0.0;
+    double texels = 0.0;
+    uint32_t collapsed = 0;
+    uint64_t saved_bytes = 0;
+    printf("%-26s %-9s  range (r g b a)   deviation (r g b a)       flat  saved\n", "", "");
+    for (const std::string& name : names) {
+        std::string path = test_asset_path(("Textures/" + name).c_str());
+        MappedFile file;
+        if (!CHECK(mapped_file_open(path.c_str(), &file))) continue;
+        ImageInfo info;
+        CHECK(decoder.read_info(file.data, file.size, &info));
+        std::vector<uint8_t> rgba((size_t)info.width * info.height * TEXTURE_TEXEL_SIZE);
+        CHECK(decoder.decode(file.data, file.size, rgba.data(), info.width * TEXTURE_TEXEL_SIZE));
+        mapped_file_close(&file);
+
+        TextureUniformity uniformity;
+        TextureUniformity reference;
+        texture_uniformity_scan(rgba.data(), info.width, info.height, info.width * TEXTURE_TEXEL_SIZE, &uniformity);
+        scan_seconds += uniformity.seconds;
+        auto start = std::chrono::high_resolution_clock::now();
+        reference_scan(rgba.data(), info.width, info.height, info.width * TEXTURE_TEXEL_SIZE, &reference);
+        reference_seconds += test_seconds_since(start);
+        CHECK(scans_match(uniformity, reference));
+        texels += (double)info.width * info.height;
+
+        TextureConstant constant = texture_constant_from(uniformity);
+        uint64_t saved = 0;
+        if (constant.channels == TEXTURE_CHANNELS_ALL) {
+            TextureLayout full;
+            TextureLayout single;
+            texture_layout_compute(info.width, info.height, 0, ROW_ALIGNMENT, MIP_ALIGNMENT, &full);
+            texture_layout_compute(1, 1, 1, ROW_ALIGNMENT, MIP_ALIGNMENT, &single);
+            saved = full.size - single.size;
+            collapsed++;
+            saved_bytes += saved;
+        }
+        const TextureChannelStats* c = uniformity.channels;
+        char flat[5] = "----";
+        for (uint32_t i = 0; i < 4; i++) flat[i] = constant.channels >> i & 1 ? "rgba"[i] : '-';
+        printf(
+            "%-26s %4ux%-4u  %3u %3u %3u %3u   %5.1f %5.1f %5.1f %5.1f   %s  %6.1f KB\n",
+            name.c_str(), info.width, info.height,
+            c[0].max - c[0].min, c[1].max - c[1].min, c[2].max - c[2].min, c[3].max - c[3].min,
+            sqrtf(c[0].variance), sqrtf(c[1].variance), sqrtf(c[2].variance), sqrtf(c[3].variance),
+            flat, saved / 1024.0
+        );
+    }
+    // the flat 128x128 metal maps at least
+    CHECK(collapsed > 0);
+    printf(
+        "%u of %zu collapse, %.1f MB saved. scan %.1f Mtexel/s, reference %.1f Mtexel/s (%.1fx)\n",
+        collapsed, names.size(), saved_bytes / (1024.0 * 1024.0),
+        texels / scan_seconds / 1e6, texels / reference_seconds / 1e6, reference_seconds / scan_seconds
+    );
+}
+
+int main() {
+    test_scan_against_reference();
+    test_thresholds();
+    bench_assets();
+    return test_finish();
+}
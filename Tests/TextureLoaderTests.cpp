@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "TestCheck.h"
+#include "TextureLoader.h"
+
+// D3D12's texture copy alignments
+constexpr uint32_t ROW_ALIGNMENT = 256;
+constexpr uint32_t MIP_ALIGNMENT = 512;
+
+// texture_downsample's footprint in floats: texels 2x & 2x + 1, except the
+//   last of an odd size reaches for the very last one
+static void reference_downsample(const uint8_t* src, uint32_t src_width, uint32_t src_height, uint32_t src_pitch,
+                                 float* dst, uint32_t dst_width, uint32_t dst_height) {
+    for (uint32_t y = 0; y < dst_height; y++) {
+        uint32_t y0 = y * 2;
+        uint32_t y1 = src_height == 1 ? 0 : y == dst_height - 1 ? src_height - 1 : y * 2 + 1;
+        for (uint32_t x = 0; x < dst_width; x++) {
+            uint32_t x0 = x * 2;
+            uint32_t x1 = src_width == 1 ? 0 : x == dst_width - 1 ? src_width - 1 : x * 2 + 1;
+            for (uint32_t c = 0; c < TEXTURE_TEXEL_SIZE; c++) {
+                float sum = 0.0f;
+                uint32_t count = 0;
+                for (uint32_t sy = y0; sy <= y1; sy++) {
+                    for (uint32_t sx = x0; sx <= x1; sx++) {
+                        sum += src[sy * src_pitch + sx * TEXTURE_TEXEL_SIZE + c];
+                        count++;
+                    }
+                }
+                dst[(y * dst_width + x) * TEXTURE_TEXEL_SIZE + c] = sum / count;
+            }
+        }
+    }
+}
+
+// every odd & even size up to 37x9 (the SSE loop & the edges), padded pitches
+static void test_downsample_against_reference() {
+    std::mt19937 random(21);
+    int worst = 0;
+    for (uint32_t src_width = 1; src_width <= 37; src_width++) {
+        for (uint32_t src_height = 1; src_height <= 9; src_height++) {
+            if (src_width == 1 && src_height == 1) continue;
+            uint32_t src_pitch = src_width * TEXTURE_TEXEL_SIZE + 8;
+            std::vector<uint8_t> src(src_pitch * src_height);
+            for (uint8_t& byte : src) byte = (uint8_t)random();
+
+            uint32_t dst_width = src_width > 1 ? src_width / 2 : 1;
+            uint32_t dst_height = src_height > 1 ? src_height / 2 : 1;
+            uint32_t dst_pitch = dst_width * TEXTURE_TEXEL_SIZE + 4;
+            std::vector<uint8_t> dst(dst_pitch * dst_height, 0xcd);
+            std::vector<float> reference(dst_width * dst_height * TEXTURE_TEXEL_SIZE);
+            texture_downsample(src.data(), src_width, src_height, src_pitch, dst.data(), dst_width, dst_height, dst_pitch);
+            reference_downsample(src.data(), src_width, src_height, src_pitch, reference.data(), dst_width, dst_height);
+
+            for (uint32_t y = 0; y < dst_height; y++) {
+                for (uint32_t x = 0; x < dst_width * TEXTURE_TEXEL_SIZE; x++) {
+                    float exact = reference[y * dst_width * TEXTURE_TEXEL_SIZE + x];
+                    worst = std::max(worst, (int)std::lround(std::fabs(dst[y * dst_pitch + x] - exact)));
+                }
+            }
+        }
+    }
+    // rounding only
+    CHECK(worst <= 1);
+}
+
+static void test_layout() {
+    TextureLayout layout;
+    texture_layout_compute(1024, 1024, 0, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    CHECK(layout.mip_count == 11);
+    CHECK(layout.mips[10].width == 1 && layout.mips[10].height == 1);
+
+    texture_layout_compute(177, 33, 0, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    CHECK(layout.mip_count == 8);
+    uint64_t end = 0;
+    for (uint32_t i = 0; i < layout.mip_count; i++) {
+        const TextureMip& mip = layout.mips[i];
+        CHECK(mip.offset % MIP_ALIGNMENT == 0 && mip.offset >= end);
+        CHECK(mip.row_pitch % ROW_ALIGNMENT == 0 && mip.row_pitch >= mip.width * TEXTURE_TEXEL_SIZE);
+        end = mip.offset + (uint64_t)mip.row_pitch * mip.height;
+    }
+    CHECK(layout.mips[7].width == 1 && layout.mips[7].height == 1);
+    CHECK(layout.size == end);
+
+    // asking for fewer stops there, more than there are gets clamped
+    texture_layout_compute(177, 33, 3, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    CHECK(layout.mip_count == 3);
+    texture_layout_compute(4, 4, 10, ROW_ALIGNMENT, MIP_ALIGNMENT, &layout);
+    CHECK(layout.mip_count == 3);
+}
+
+// every PNG under Assets/Textures, mapped like LoadTextures does
+struct TextureFiles {
+    std::vector<std::string> names;
+    std::vector<MappedFile> files;
+};
+
+static void texture_files_open(TextureFiles* out_files) {
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(test_asset_path("Textures"))) {
+        if (entry.path().extension() == ".png") out_files->names.push_back(entry.path().filename().string());
+    }
+    std::sort(out_files->names.begin(), out_files->names.end());
+    out_files->files.resize(out_files->names.size());
+    for (size_t i = 0; i < out_files->names.size(); i++) {
+        std::string path = test_asset_path(("Textures/" + out_files->names[i]).c_str());
+        CHECK(mapped_file_open(path.c_str(), &out_files->files[i]));
+    }
+}
+
+static void texture_files_close(TextureFiles* files) {
+    for (MappedFile& file : files->files) mapped_file_close(&file);
+}
+
+// prepare, one staging block laid out like upload_decoded's, decode
+static std::unique_ptr<uint8_t[]> decode_batch(const TextureFiles& files, std::vector<TextureLoadJob>* out_jobs, TextureBatchStats* out_stats) {
+    PngImageDecoder decoder;
+    uint32_t count = (uint32_t)files.files.size();
+    out_jobs->assign(count, {});
+    for (uint32_t i = 0; i < count; i++) {
+        (*out_jobs)[i].data = files.files[i].data;
+        (*out_jobs)[i].size = files.files[i].size;
+        (*out_jobs)[i].generate_mips = true;
+    }
+    texture_batch_prepare(out_jobs->data(), count, &decoder, ROW_ALIGNMENT, MIP_ALIGNMENT);
+
+    std::vector<uint64_t> offsets(count);
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        offsets[i] = size;
+        size += ((*out_jobs)[i].layout.size + MIP_ALIGNMENT - 1) & ~(uint64_t)(MIP_ALIGNMENT - 1);
+    }
+    std::unique_ptr<uint8_t[]> staging = std::make_unique<uint8_t[]>(size);
+    for (uint32_t i = 0; i < count; i++) (*out_jobs)[i].staging = staging.get() + offsets[i];
+    texture_batch_decode(out_jobs->data(), count, &decoder, out_stats);
+    return staging;
+}
+
+// every asset decodes, & every level past the first is exactly the level
+//   before it downsampled
+static void test_asset_mip_chains() {
+    TextureFiles files;
+    texture_files_open(&files);
+    CHECK(!files.names.empty());
+
+    std::vector<TextureLoadJob> jobs;
+    TextureBatchStats stats = {};
+    std::unique_ptr<uint8_t[]> staging = decode_batch(files, &jobs, &stats);
+    CHECK(stats.texture_count == files.names.size() && stats.failed_count == 0);
+
+    uint32_t mismatched = 0;
+    for (uint32_t i = 0; i < (uint32_t)jobs.size(); i++) {
+        const TextureLoadJob& job = jobs[i];
+        if (!CHECK(job.ok)) continue;
+        const TextureLayout& layout = job.layout;
+        CHECK(layout.mip_count == texture_full_mip_count(job.info.width, job.info.height));
+        for (uint32_t m = 1; m < layout.mip_count; m++) {
+            const TextureMip& src = layout.mips[m - 1];
+            const TextureMip& dst = layout.mips[m];
+            std::vector<uint8_t> expected(dst.row_pitch * dst.height);
+            texture_downsample(job.staging + src.offset, src.width, src.height, src.row_pitch, expected.data(), dst.width, dst.height, dst.row_pitch);
+            for (uint32_t y = 0; y < dst.height; y++) {
+                mismatched += memcmp(expected.data() + y * dst.row_pitch, job.staging + dst.offset + y * dst.row_pitch, dst.width * TEXTURE_TEXEL_SIZE) != 0;
+            }
+        }
+    }
+    CHECK(mismatched == 0);
+    texture_files_close(&files);
+}
+
+// what LoadTextures pays to decode the lot, & the SSE downsample against
+//   the float reference on the 1024s
+static void bench_decode() {
+    TextureFiles files;
+    texture_files_open(&files);
+    std::vector<TextureLoadJob> jobs;
+    std::unique_ptr<uint8_t[]> staging;
+    for (uint32_t run = 0; run < 3; run++) {
+        TextureBatchStats stats = {};
+        staging = decode_batch(files, &jobs, &stats);
+        printf(
+            "%u textures on %u threads, %.1f MB staged: %.1f ms decoding, %.1f ms on mips, %.1f ms wall\n",
+            stats.texture_count, stats.thread_count, stats.staged_bytes / (1024.0 * 1024.0),
+            stats.decode_seconds * 1e3, stats.mip_seconds * 1e3, stats.wall_seconds * 1e3
+        );
+    }
+
+    double reference_seconds = 0.0;
+    double sse_seconds = 0.0;
+    uint32_t downsampled = 0;
+    for (const TextureLoadJob& job : jobs) {
+        const TextureLayout& layout = job.layout;
+        if (!job.ok || layout.mip_count < 2) continue;
+        const TextureMip& src = layout.mips[0];
+        const TextureMip& dst = layout.mips[1];
+        std::vector<float> reference(dst.width * dst.height * TEXTURE_TEXEL_SIZE);
+        auto start = std::chrono::high_resolution_clock::now();
+        reference_downsample(job.staging, src.width, src.height, src.row_pitch, reference.data(), dst.width, dst.height);
+        reference_seconds += test_seconds_since(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        texture_downsample(job.staging, src.width, src.height, src.row_pitch, job.staging + dst.offset, dst.width, dst.height, dst.row_pitch);
+        sse_seconds += test_seconds_since(start);
+        downsampled++;
+    }
+    printf(
+        "top level of %u textures downsampled: float reference %.1f ms, SSE %.1f ms (%.1fx)\n",
+        downsampled, reference_seconds * 1e3, sse_seconds * 1e3, reference_seconds / sse_seconds
+    );
+    texture_files_close(&files);
+}
+
+int main() {
+    test_downsample_against_reference();
+    test_layout();
+    test_asset_mip_chains();
+    bench_decode();
+    return test_finish();
+}
@@ -0,0 +1,316 @@
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "TestCheck.h"
+#include "TextureCompress.h"
+#include "TextureCooker.h"
+#include "TexturePacker.h"
+
+// an RGBA8 image & the PackSource looking at it
+struct Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+
+    PackSource source() const { return { rgba.data(), width, height, width * 4 }; }
+    uint8_t at(uint32_t x, uint32_t y, uint32_t c) const { return rgba[((size_t)y * width + x) * 4 + c]; }
+};
+
+// gray noise, r = g = b
+static Image gray_noise(uint32_t width, uint32_t height, std::mt19937* random) {
+    Image image = { width, height, std::vector<uint8_t>((size_t)width * height * 4) };
+    for (size_t i = 0; i < image.rgba.size(); i += 4) {
+        uint8_t value = (uint8_t)(*random)();
+        image.rgba[i] = image.rgba[i + 1] = image.rgba[i + 2] = value;
+        image.rgba[i + 3] = 255;
+    }
+    return image;
+}
+
+static Image pack(const PackSource* sources, TexturePackStats* out_stats = nullptr) {
+    Image out;
+    orm_pack_size(sources, &out.width, &out.height);
+    out.rgba.assign((size_t)out.width * out.height * 4, 0xcd);
+    texture_pack_orm(sources, out.rgba.data(), out.width * 4, out_stats);
+    return out;
+}
+
+// each map's red ends up in its own channel, alpha's opaque
+static void test_channel_placement() {
+    std::mt19937 random(24);
+    Image maps[ORM_CHANNEL_COUNT] = { gray_noise(13, 7, &random), gray_noise(13, 7, &random), gray_noise(13, 7, &random) };
+    PackSource sources[ORM_CHANNEL_COUNT] = { maps[0].source(), maps[1].source(), maps[2].source() };
+    TexturePackStats stats = {};
+    Image packed = pack(sources, &stats);
+    CHECK(packed.width == 13 && packed.height == 7);
+    CHECK(stats.packed_source_count == 0 && stats.constant_count == 0 && stats.resampled_count == 0);
+
+    uint32_t wrong = 0;
+    for (uint32_t y = 0; y < packed.height; y++) {
+        for (uint32_t x = 0; x < packed.width; x++) {
+            for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) wrong += packed.at(x, y, c) != maps[c].at(x, y, 0);
+            wrong += packed.at(x, y, 3) != 255;
+        }
+    }
+    CHECK(wrong == 0);
+}
+
+// a missing map is its default everywhere, none at all is a 1x1 of them
+static void test_defaults() {
+    PackSource none[ORM_CHANNEL_COUNT] = {};
+    Image empty = pack(none);
+    CHECK(empty.width == 1 && empty.height == 1);
+    CHECK(empty.at(0, 0, 0) == ORM_DEFAULTS[0] && empty.at(0, 0, 1) == ORM_DEFAULTS[1] && empty.at(0, 0, 2) == ORM_DEFAULTS[2]);
+
+    std::mt19937 random(24);
+    Image roughness = gray_noise(9, 5, &random);
+    PackSource sources[ORM_CHANNEL_COUNT] = {};
+    sources[ORM_CHANNEL_ROUGHNESS] = roughness.source();
+    Image packed = pack(sources);
+    uint32_t wrong = 0;
+    for (uint32_t y = 0; y < packed.height; y++) {
+        for (uint32_t x = 0; x < packed.width; x++) {
+            wrong += packed.at(x, y, ORM_CHANNEL_OCCLUSION) != ORM_DEFAULTS[ORM_CHANNEL_OCCLUSION];
+            wrong += packed.at(x, y, ORM_CHANNEL_ROUGHNESS) != roughness.at(x, y, 0);
+            wrong += packed.at(x, y, ORM_CHANNEL_METAL) != ORM_DEFAULTS[ORM_CHANNEL_METAL];
+        }
+    }
+    CHECK(packed.width == 9 && packed.height == 5 && wrong == 0);
+}
+
+// bilinear in doubles, texel centers lined up & edges clamped
+static double reference_sample(const Image& image, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    auto axis = [](uint32_t i, uint32_t source_size, uint32_t size, uint32_t* first, uint32_t* second, double* weight) {
+        double position = ((double)i + 0.5) * source_size / size - 0.5;
+        position = position < 0.0 ? 0.0 : position;
+        *first = (uint32_t)position < source_size - 1 ? (uint32_t)position : source_size - 1;
+        *second = *first + 1 < source_size ? *first + 1 : *first;
+        *weight = position - *first > 1.0 ? 1.0 : position - *first;
+    };
+    uint32_t x0, x1, y0, y1;
+    double wx, wy;
+    axis(x, image.width, width, &x0, &x1, &wx);
+    axis(y, image.height, height, &y0, &y1, &wy);
+    double top = image.at(x0, y0, 0) * (1.0 - wx) + image.at(x1, y0, 0) * wx;
+    double bottom = image.at(x0, y1, 0) * (1.0 - wx) + image.at(x1, y1, 0) * wx;
+    return top * (1.0 - wy) + bottom * wy;
+}
+
+// smaller maps stretched to the biggest, up by odd factors both ways
+static void test_resampling() {
+    std::mt19937 random(24);
+    uint32_t sizes[][2] = { { 1, 1 }, { 2, 3 }, { 5, 3 }, { 7, 16 }, { 16, 11 } };
+    int worst = 0;
+    for (const uint32_t* size : sizes) {
+        Image occlusion = gray_noise(37, 23, &random);
+        Image roughness = gray_noise(size[0], size[1], &random);
+        // the 1x1 would be flat & filled in instead
+        if (size[0] == 1) roughness.rgba[0] = roughness.rgba[1] = roughness.rgba[2] = 77;
+        PackSource sources[ORM_CHANNEL_COUNT] = { occlusion.source(), roughness.source(), {} };
+        TexturePackStats stats = {};
+        Image packed = pack(sources, &stats);
+        CHECK(packed.width == 37 && packed.height == 23);
+        CHECK(stats.resampled_count == (size[0] == 1 ? 0u : 1u));
+        for (uint32_t y = 0; y < packed.height; y++) {
+            for (uint32_t x = 0; x < packed.width; x++) {
+                double exact = reference_sample(roughness, x, y, packed.width, packed.height);
+                int error = (int)std::lround(std::fabs(packed.at(x, y, ORM_CHANNEL_ROUGHNESS) - exact));
+                worst = error > worst ? error : worst;
+            }
+        }
+    }
+    // 8 bit weights & rounding
+    CHECK(worst <= 1);
+}
+
+// gray within a few steps is a single channel map, anything with color is
+//   already packed & gets read from the channel its map would go in
+static void test_packed_detection() {
+    std::mt19937 random(24);
+    Image gray = gray_noise(11, 6, &random);
+    CHECK(!orm_source_is_packed(gray.source()));
+    // lossy noise between channels stays gray, past the tolerance it doesn't
+    for (size_t i = 0; i < gray.rgba.size(); i += 4) gray.rgba[i + 1] = gray.rgba[i] > 252 ? 255 : gray.rgba[i] + 3;
+    CHECK(!orm_source_is_packed(gray.source()));
+    gray.rgba[4 * 10 + 2] = gray.rgba[4 * 10 + 1] > 200 ? 0 : 255;
+    CHECK(orm_source_is_packed(gray.source()));
+    CHECK(!orm_source_is_packed(PackSource{}));
+
+    // an ORM that went in as the metal map: its blue comes through
+    Image orm = gray_noise(11, 6, &random);
+    for (size_t i = 0; i < orm.rgba.size(); i += 4) {
+        orm.rgba[i] = 255;
+        orm.rgba[i + 1] = (uint8_t)(i * 7);
+        orm.rgba[i + 2] = (uint8_t)(i * 13 + 5);
+    }
+    PackSource sources[ORM_CHANNEL_COUNT] = {};
+    sources[ORM_CHANNEL_METAL] = orm.source();
+    TexturePackStats stats = {};
+    Image packed = pack(sources, &stats);
+    CHECK(stats.packed_source_count == 1);
+    uint32_t wrong = 0;
+    for (uint32_t y = 0; y < packed.height; y++) {
+        for (uint32_t x = 0; x < packed.width; x++) wrong += packed.at(x, y, ORM_CHANNEL_METAL) != orm.at(x, y, 2);
+    }
+    CHECK(wrong == 0);
+}
+
+static void touch(const std::filesystem::path& path, const char* contents) {
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+// "_orm" -> its maps & each map back to the "_orm", first suffix winning
+static void test_suffixes() {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "texture_packer_suffixes";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    touch(dir / "bronze_occlusion.png", "o");
+    touch(dir / "bronze_ao.png", "a");
+    touch(dir / "bronze_roughness.png", "r");
+    touch(dir / "bronze_metalness.png", "m");
+    touch(dir / "wood_metal.png", "m");
+
+    OrmSources sources;
+    CHECK(orm_sources_find((dir / "bronze_orm.png").string().c_str(), &sources));
+    CHECK(sources.paths[ORM_CHANNEL_OCCLUSION] == (dir / "bronze_occlusion.png").string());
+    CHECK(sources.paths[ORM_CHANNEL_ROUGHNESS] == (dir / "bronze_roughness.png").string());
+    CHECK(sources.paths[ORM_CHANNEL_METAL] == (dir / "bronze_metalness.png").string());
+    CHECK(orm_sources_find((dir / "wood_orm.png").string().c_str(), &sources));
+    CHECK(sources.paths[ORM_CHANNEL_OCCLUSION].empty() && sources.paths[ORM_CHANNEL_ROUGHNESS].empty());
+    CHECK(!orm_sources_find((dir / "floor_orm.png").string().c_str(), &sources));
+    CHECK(!orm_sources_find((dir / "bronze_roughness.png").string().c_str(), &sources));
+
+    std::string orm_path;
+    for (const char* map : { "bronze_occlusion.png", "bronze_ao.png", "bronze_roughness.png", "bronze_metal.png", "bronze_metalness.png" }) {
+        CHECK(orm_path_for_source((dir / map).string().c_str(), &orm_path) && orm_path == (dir / "bronze_orm.png").string());
+    }
+    CHECK(!orm_path_for_source((dir / "bronze_albedo.png").string().c_str(), &orm_path));
+    CHECK(!orm_path_for_source((dir / "bronze_orm.png").string().c_str(), &orm_path));
+    // the suffix on its own isn't a material
+    CHECK(!orm_path_for_source((dir / "_roughness.png").string().c_str(), &orm_path));
+    std::filesystem::remove_all(dir);
+}
+
+// the offline prune only goes once the ORM's cooked from the maps as they are
+static void test_prune() {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "texture_packer_prune";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    touch(dir / "bronze_roughness.png", "r");
+    touch(dir / "bronze_metal.png", "m");
+    auto touch_caches = [&]() {
+        touch(dir / "bronze_roughness.dds", "stale");
+        touch(dir / "bronze_metal.dds", "stale");
+    };
+    touch_caches();
+    std::string orm_path = (dir / "bronze_orm.png").string();
+
+    // nothing cooked yet
+    CHECK(texture_cook_prune_orm_sources(orm_path.c_str()) == 0);
+    CHECK(std::filesystem::exists(dir / "bronze_roughness.dds"));
+
+    OrmSources sources;
+    orm_sources_find(orm_path.c_str(), &sources);
+    TextureLayout layout;
+    texture_layout_compute(4, 4, 1, 1, 1, &layout);
+    std::vector<uint8_t> rgba(layout.size, 128);
+    CHECK(cooked_texture_write(cooked_texture_path(orm_path.c_str()).c_str(), orm_sources_hash(sources), TEXTURE_ROLE_ORM, rgba.data(), layout, TextureConstant{}));
+    CHECK(texture_cook_prune_orm_sources(orm_path.c_str()) == 2);
+    CHECK(!std::filesystem::exists(dir / "bronze_roughness.dds") && !std::filesystem::exists(dir / "bronze_metal.dds"));
+    CHECK(std::filesystem::exists(cooked_texture_path(orm_path.c_str())));
+
+    // a map changed since, the ORM's stale & nothing goes
+    touch_caches();
+    touch(dir / "bronze_metal.png", "changed");
+    CHECK(texture_cook_prune_orm_sources(orm_path.c_str()) == 0);
+    CHECK(std::filesystem::exists(dir / "bronze_metal.dds"));
+    std::filesystem::remove_all(dir);
+}
+
+static bool load_png(PngImageDecoder* decoder, const std::string& path, Image* out_image) {
+    MappedFile file;
+    if (!mapped_file_open(path.c_str(), &file)) return false;
+    ImageInfo info;
+    bool ok = decoder->read_info(file.data, file.size, &info);
+    if (ok) {
+        *out_image = { info.width, info.height, std::vector<uint8_t>((size_t)info.width * info.height * 4) };
+        ok = decoder->decode(file.data, file.size, out_image->rgba.data(), info.width * 4);
+    }
+    mapped_file_close(&file);
+    return ok;
+}
+
+static double channel_psnr(const Image& a, const std::vector<uint8_t>& b, uint32_t a_channel, uint32_t b_channel) {
+    double squared_error = 0.0;
+    for (size_t i = 0; i < (size_t)a.width * a.height; i++) {
+        double error = (double)a.rgba[i * 4 + a_channel] - b[i * 4 + b_channel];
+        squared_error += error * error;
+    }
+    return squared_error == 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 * a.width * a.height / squared_error);
+}
+
+// what a texture comes back as after format, at the same size
+static std::vector<uint8_t> round_trip(const Image& image, uint32_t format) {
+    uint32_t row_pitch = texture_format_row_pitch(format, image.width);
+    std::vector<uint8_t> compressed((size_t)row_pitch * texture_format_row_count(format, image.height));
+    std::vector<uint8_t> decompressed(image.rgba.size());
+    texture_compress(image.rgba.data(), image.width, image.height, image.width * 4, format, compressed.data(), row_pitch);
+    texture_decompress(compressed.data(), image.width, image.height, row_pitch, format, decompressed.data(), image.width * 4);
+    return decompressed;
+}
+
+// every material's ORM packed from the assets: what packing did & per
+//   channel quality of the BC7 ORM against the BC4 the map alone would get
+static void bench_assets() {
+    const char* materials[] = { "bronze", "cobblestone", "floor", "paint", "rough", "scratched", "wood" };
+    PngImageDecoder decoder;
+    printf("             size       packed flat stretched      ms   rough BC7/BC4   metal BC7/BC4\n");
+    for (const char* material : materials) {
+        std::string orm_path = test_asset_path((std::string("Textures/") + material + "_orm.png").c_str());
+        OrmSources paths;
+        if (!CHECK(orm_sources_find(orm_path.c_str(), &paths))) continue;
+        Image maps[ORM_CHANNEL_COUNT];
+        PackSource sources[ORM_CHANNEL_COUNT] = {};
+        for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+            if (paths.paths[c].empty()) continue;
+            CHECK(load_png(&decoder, paths.paths[c], &maps[c]));
+            sources[c] = maps[c].source();
+        }
+        TexturePackStats stats = {};
+        Image packed = pack(sources, &stats);
+        // none of the shipped maps are packed already
+        CHECK(stats.packed_source_count == 0);
+
+        std::vector<uint8_t> orm_bc7 = round_trip(packed, TEXTURE_FORMAT_BC7);
+        double quality[2][2] = {};
+        for (uint32_t c = ORM_CHANNEL_ROUGHNESS; c <= ORM_CHANNEL_METAL; c++) {
+            const Image& map = maps[c];
+            if (map.rgba.empty()) continue;
+            quality[c - 1][0] = channel_psnr(packed, orm_bc7, c, c);
+            quality[c - 1][1] = channel_psnr(map, round_trip(map, TEXTURE_FORMAT_BC4), 0, 0);
+            CHECK(quality[c - 1][0] > 30.0);
+        }
+        printf(
+            "%-12s %4ux%-4u   %6u %4u %9u %7.1f   %5.1f / %4.1f     %5.1f / %4.1f\n",
+            material, packed.width, packed.height, stats.packed_source_count, stats.constant_count, stats.resampled_count,
+            stats.seconds * 1e3, quality[0][0], quality[0][1], quality[1][0], quality[1][1]
+        );
+    }
+}
+
+int main() {
+    test_channel_placement();
+    test_defaults();
+    test_resampling();
+    test_packed_detection();
+    test_suffixes();
+    test_prune();
+    bench_assets();
+    return test_finish();
+}
@@ -0,0 +1,211 @@
+#include <cstdio>
+#include <vector>
+#include "TestCheck.h"
+#include "TransientPool.h"
+
+constexpr uint64_t KB = 1024;
+constexpr uint64_t MB = 1024 * KB;
+// what D3D12 places render targets at
+constexpr uint64_t PLACEMENT_ALIGNMENT = 64 * KB;
+constexpr uint32_t RELEASE_AFTER_FRAMES = 60;
+
+// formats only need to tell keys apart here, bytes per texel is all that matters
+constexpr uint32_t FORMAT_RGBA8 = 28;
+constexpr uint32_t FORMAT_RGBA16F = 10;
+
+static uint64_t target_size(const TransientKey& key) {
+    uint64_t texel_size = key.format == FORMAT_RGBA16F ? 8 : 4;
+    uint64_t size = (uint64_t)key.width * key.height * texel_size;
+    return (size + PLACEMENT_ALIGNMENT - 1) & ~(PLACEMENT_ALIGNMENT - 1);
+}
+
+static TransientAcquire acquire(TransientPool* pool, const TransientKey& key) {
+    return transient_pool_acquire(pool, key, target_size(key), PLACEMENT_ALIGNMENT);
+}
+
+// the game's G-buffer: 3 RGBA8 targets & an RGBA16F one
+static void gbuffer_keys(uint32_t width, uint32_t height, TransientKey* out_keys) {
+    out_keys[0] = { FORMAT_RGBA8, width, height, 0 };
+    out_keys[1] = { FORMAT_RGBA8, width, height, 0 };
+    out_keys[2] = { FORMAT_RGBA8, width, height, 0 };
+    out_keys[3] = { FORMAT_RGBA16F, width, height, 0 };
+}
+
+// one frame like the render graph runs it: every target acquired for the
+//   whole frame, released at the end
+static void gbuffer_frame(TransientPool* pool, uint32_t width, uint32_t height, TransientAcquire* out_acquires, std::vector<TransientRelease>* out_released) {
+    transient_pool_begin_frame(pool, out_released);
+    TransientKey keys[4];
+    gbuffer_keys(width, height, keys);
+    for (uint32_t i = 0; i < 4; i++) out_acquires[i] = acquire(pool, keys[i]);
+    for (uint32_t i = 0; i < 4; i++) transient_pool_release(pool, out_acquires[i].slot);
+}
+
+// equal keys in the same order land in the same slot & placement every
+//   frame, only the first frame allocates or creates anything
+static void test_same_key_same_slot() {
+    TransientPool pool;
+    transient_pool_create(&pool, RELEASE_AFTER_FRAMES);
+    std::vector<TransientRelease> released;
+    TransientAcquire first[4];
+    gbuffer_frame(&pool, 1920, 1080, first, &released);
+    for (const TransientAcquire& acquired : first) CHECK(acquired.allocate && acquired.create && !acquired.aliased);
+    CHECK(pool.stats.slot_count == 4);
+
+    uint32_t moved = 0;
+    uint32_t churn = 0;
+    for (uint32_t frame = 0; frame < 200; frame++) {
+        TransientAcquire acquires[4];
+        gbuffer_frame(&pool, 1920, 1080, acquires, &released);
+        for (uint32_t i = 0; i < 4; i++) {
+            moved += acquires[i].slot != first[i].slot || acquires[i].placement != first[i].placement;
+            churn += acquires[i].allocate || acquires[i].create || acquires[i].aliased;
+        }
+    }
+    CHECK(moved == 0 && churn == 0 && released.empty());
+    CHECK(pool.stats.allocation_count == 4 && pool.stats.create_count == 4);
+}
+
+// new keys go into the smallest free memory that's big enough, new memory
+//   only when none is
+static void test_smallest_fit() {
+    TransientPool pool;
+    transient_pool_create(&pool, RELEASE_AFTER_FRAMES);
+    std::vector<TransientRelease> released;
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire big = transient_pool_acquire(&pool, { 1, 100, 1, 0 }, 100 * MB, PLACEMENT_ALIGNMENT);
+    TransientAcquire small = transient_pool_acquire(&pool, { 1, 50, 1, 0 }, 50 * MB, PLACEMENT_ALIGNMENT);
+    CHECK(big.slot != small.slot);
+
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire fits_small = transient_pool_acquire(&pool, { 2, 40, 1, 0 }, 40 * MB, PLACEMENT_ALIGNMENT);
+    CHECK(fits_small.slot == small.slot && !fits_small.allocate && fits_small.create);
+    TransientAcquire fits_big = transient_pool_acquire(&pool, { 2, 60, 1, 0 }, 60 * MB, PLACEMENT_ALIGNMENT);
+    CHECK(fits_big.slot == big.slot && !fits_big.allocate);
+    // both taken this frame, so even a tiny one needs its own
+    TransientAcquire tiny = transient_pool_acquire(&pool, { 2, 1, 1, 0 }, 1 * MB, PLACEMENT_ALIGNMENT);
+    CHECK(tiny.allocate && tiny.slot != big.slot && tiny.slot != small.slot);
+
+    // memory aligned for less than asked never gets reused
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire aligned = transient_pool_acquire(&pool, { 3, 1, 1, 0 }, 1 * MB, 4 * MB);
+    CHECK(aligned.allocate);
+    CHECK(pool.stats.allocation_count == 4);
+}
+
+// a placement switch in the same memory asks for an aliasing barrier, the
+//   placement that's already there doesn't
+static void test_aliased_on_switch() {
+    TransientPool pool;
+    transient_pool_create(&pool, RELEASE_AFTER_FRAMES);
+    std::vector<TransientRelease> released;
+    TransientKey color = { FORMAT_RGBA8, 256, 256, 0 };
+    TransientKey depth = { 45, 256, 256, 2 };
+
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire a = acquire(&pool, color);
+    CHECK(!a.aliased);
+    // released mid frame, the next target can take over the memory
+    transient_pool_release(&pool, a.slot);
+    TransientAcquire b = acquire(&pool, depth);
+    CHECK(b.slot == a.slot && b.placement != a.placement && b.aliased && b.create);
+    transient_pool_release(&pool, b.slot);
+
+    // next frame: back to color means switching again, both resources kept
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire again = acquire(&pool, color);
+    CHECK(again.slot == a.slot && again.placement == a.placement && again.aliased && !again.create);
+    transient_pool_release(&pool, again.slot);
+    TransientAcquire same = acquire(&pool, color);
+    CHECK(same.placement == a.placement && !same.aliased);
+    CHECK(pool.stats.alias_count == 2 && pool.stats.create_count == 2 && pool.stats.allocation_count == 1);
+}
+
+// a window dragged smaller a few pixels at a time: every size is a new key
+//   but fits the memory that's there, so nothing new gets allocated. once
+//   it settles, whatever the drag made goes after release_after_frames
+static void test_resize_drag() {
+    TransientPool pool;
+    transient_pool_create(&pool, RELEASE_AFTER_FRAMES);
+    std::vector<TransientRelease> released;
+    TransientAcquire acquires[4];
+    for (uint32_t frame = 0; frame < 10; frame++) gbuffer_frame(&pool, 1920, 1080, acquires, &released);
+    uint64_t allocations = pool.stats.allocation_count;
+    uint64_t capacity = pool.stats.capacity_bytes;
+    uint64_t creates = pool.stats.create_count;
+    released.clear();
+
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint64_t peak = capacity;
+    for (uint32_t step = 0; step < 200; step++) {
+        width -= 4;
+        height -= 2;
+        gbuffer_frame(&pool, width, height, acquires, &released);
+        peak = pool.stats.capacity_bytes > peak ? pool.stats.capacity_bytes : peak;
+    }
+    CHECK(pool.stats.allocation_count == allocations);
+    CHECK(peak == capacity);
+    uint64_t drag_creates = pool.stats.create_count - creates;
+    CHECK(drag_creates == 200 * 4);
+
+    // the last size sticks, every older placement goes once it's idle long
+    //   enough, the drag's first ones already while it's still going
+    uint32_t placement_releases = 0;
+    uint32_t slot_releases = 0;
+    for (uint32_t frame = 0; frame <= RELEASE_AFTER_FRAMES + 1; frame++) {
+        if (frame > 0) gbuffer_frame(&pool, width, height, acquires, &released);
+        for (const TransientRelease& release : released) {
+            placement_releases += release.placement != TRANSIENT_NONE;
+            slot_releases += release.placement == TRANSIENT_NONE;
+        }
+        released.clear();
+    }
+    uint32_t live = 0;
+    for (const TransientSlot& slot : pool.slots) {
+        for (const TransientPlacement& placement : slot.placements) live += placement.live;
+    }
+    CHECK(live == 4 && slot_releases == 0);
+    CHECK(placement_releases == 200 * 4);
+    printf(
+        "1080p g-buffer: %.1f MB in %u slots, a 200 step drag: %llu new placements, 0 allocations, "
+        "%u stale placements dropped after\n",
+        capacity / (double)MB, pool.stats.slot_count, (unsigned long long)drag_creates, placement_releases
+    );
+}
+
+// memory nobody acquires for release_after_frames frames goes, & only then
+static void test_release_after_frames() {
+    TransientPool pool;
+    transient_pool_create(&pool, RELEASE_AFTER_FRAMES);
+    std::vector<TransientRelease> released;
+    TransientKey kept = { FORMAT_RGBA8, 128, 128, 0 };
+    TransientKey dropped = { FORMAT_RGBA16F, 128, 128, 0 };
+    transient_pool_begin_frame(&pool, &released);
+    TransientAcquire kept_acquire = acquire(&pool, kept);
+    TransientAcquire dropped_acquire = acquire(&pool, dropped);
+
+    uint32_t frames_until_release = 0;
+    for (uint32_t frame = 1; frame <= RELEASE_AFTER_FRAMES + 5 && frames_until_release == 0; frame++) {
+        released.clear();
+        transient_pool_begin_frame(&pool, &released);
+        acquire(&pool, kept);
+        if (!released.empty()) frames_until_release = frame;
+    }
+    CHECK(frames_until_release == RELEASE_AFTER_FRAMES + 1);
+    CHECK(released.size() == 1 && released[0].slot == dropped_acquire.slot && released[0].placement == TRANSIENT_NONE);
+    CHECK(pool.stats.slot_count == 1 && pool.stats.capacity_bytes == target_size(kept));
+
+    // the dead slot's spot gets reused for the next new memory
+    TransientAcquire reborn = acquire(&pool, dropped);
+    CHECK(reborn.allocate && reborn.slot == dropped_acquire.slot && reborn.slot != kept_acquire.slot);
+}
+
+int main() {
+    test_same_key_same_slot();
+    test_smallest_fit();
+    test_aliased_on_switch();
+    test_resize_drag();
+    test_release_after_frames();
+    return test_finish();
+}
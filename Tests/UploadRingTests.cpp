@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "TestCheck.h"
+#include "UploadRing.h"
+
+static void test_alignment_and_wrap() {
+    MockUploadFence fence;
+    UploadRing ring;
+    upload_ring_create(&ring, 1024, &fence);
+
+    uint64_t offset = 0;
+    CHECK(upload_ring_allocate(&ring, 100, 16, &offset) && offset == 0);
+    CHECK(upload_ring_allocate(&ring, 100, 256, &offset) && offset == 256);
+    CHECK(ring.stats.padding_bytes == 156);
+    upload_ring_close_batch(&ring, 1);
+
+    // 600 still fits behind 356
+    CHECK(upload_ring_allocate(&ring, 600, 16, &offset) && offset == 368);
+    upload_ring_close_batch(&ring, 2);
+    CHECK(fence.wait_count == 0);
+
+    // 300 doesn't, so it skips to the start, which batch 1 still holds
+    CHECK(upload_ring_allocate(&ring, 300, 16, &offset) && offset == 0);
+    CHECK(fence.wait_count == 1);
+    CHECK(ring.stats.wait_count == 1);
+    CHECK(ring.tail == 356);
+    upload_ring_close_batch(&ring, 3);
+}
+
+// once the GPU has caught up, an allocation that has to wrap only needs
+//   its own size free, not the end it skips on top
+static void test_wrap_when_empty() {
+    MockUploadFence fence;
+    UploadRing ring;
+    upload_ring_create(&ring, 1024, &fence);
+
+    uint64_t offset;
+    CHECK(upload_ring_allocate(&ring, 356, 4, &offset));
+    upload_ring_close_batch(&ring, 1);
+    CHECK(upload_ring_allocate(&ring, 700, 16, &offset) && offset == 0);
+    CHECK(fence.wait_count == 1);
+    CHECK(ring.batches.empty() && ring.tail == 1024);
+    CHECK(ring.stats.padding_bytes == 0);
+}
+
+static void test_retire_in_fence_order() {
+    MockUploadFence fence;
+    UploadRing ring;
+    upload_ring_create(&ring, 1024, &fence);
+
+    uint64_t offset;
+    for (uint64_t batch = 1; batch <= 3; batch++) {
+        CHECK(upload_ring_allocate(&ring, 200, 4, &offset));
+        upload_ring_close_batch(&ring, batch);
+    }
+    // closing with nothing allocated doesn't add a batch
+    upload_ring_close_batch(&ring, 4);
+    CHECK(ring.batches.size() == 3);
+    CHECK(!upload_ring_has_open_batch(&ring));
+
+    fence.complete(2);
+    upload_ring_retire(&ring);
+    CHECK(ring.batches.size() == 1);
+    CHECK(ring.tail == 400);
+
+    fence.complete(3);
+    upload_ring_retire(&ring);
+    CHECK(ring.batches.empty());
+    CHECK(ring.tail == ring.head);
+    CHECK(fence.wait_count == 0);
+}
+
+static void test_refusals() {
+    MockUploadFence fence;
+    UploadRing ring;
+    upload_ring_create(&ring, 1024, &fence);
+
+    uint64_t offset;
+    CHECK(!upload_ring_allocate(&ring, 2048, 4, &offset));
+    CHECK(upload_ring_allocate(&ring, 1024, 4, &offset));
+    // the open batch is in the way, only closing it can help
+    CHECK(upload_ring_has_open_batch(&ring));
+    CHECK(!upload_ring_allocate(&ring, 4, 4, &offset));
+    upload_ring_close_batch(&ring, 1);
+    CHECK(upload_ring_allocate(&ring, 4, 4, &offset) && offset == 0);
+    CHECK(fence.wait_count == 1);
+}
+
+// drives the ring like Graphics does (close & submit when the open batch
+//   is in the way) against a GPU that lags a random number of batches
+//   behind, and checks nothing still in flight ever gets handed out again
+static void test_in_flight_never_reused() {
+    constexpr uint64_t CAPACITY = 4096;
+    constexpr uint64_t OPEN = UINT64_MAX;
+    MockUploadFence fence;
+    UploadRing ring;
+    upload_ring_create(&ring, CAPACITY, &fence);
+
+    // fence value of the batch each byte went out with
+    std::vector<uint64_t> owner(CAPACITY, 0);
+    uint64_t next_fence = 1;
+    std::mt19937 random(42);
+
+    auto close = [&]() {
+        for (uint64_t& fence_value : owner) {
+            if (fence_value == OPEN) fence_value = next_fence;
+        }
+        upload_ring_close_batch(&ring, next_fence++);
+    };
+
+    bool overlapped = false;
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint64_t size = 1 + random() % 700;
+        uint64_t alignment = 1ull << (random() % 9);
+        uint64_t offset;
+        bool reserved = upload_ring_allocate(&ring, size, alignment, &offset);
+        if (!reserved && upload_ring_has_open_batch(&ring)) {
+            close();
+            reserved = upload_ring_allocate(&ring, size, alignment, &offset);
+        }
+        if (!CHECK(reserved)) break;
+        CHECK(offset % alignment == 0);
+        CHECK(offset + size <= CAPACITY);
+
+        for (uint64_t b = offset; b < offset + size; b++) {
+            overlapped |= owner[b] == OPEN || owner[b] > fence.completed_value;
+            owner[b] = OPEN;
+        }
+
+        if (random() % 4 == 0) close();
+        // the GPU catches up to somewhere between 0 & 3 batches behind
+        uint64_t behind = random() % 4;
+        if (next_fence - 1 > behind) fence.complete(next_fence - 1 - behind);
+    }
+    CHECK(!overlapped);
+
+    printf(
+        "%llu allocations in %llu batches, %.1f%% padding, %llu waits\n",
+        (unsigned long long)ring.stats.allocation_count, (unsigned long long)ring.stats.batch_count,
+        100.0 * ring.stats.padding_bytes / ring.stats.allocated_bytes, (unsigned long long)ring.stats.wait_count
+    );
+}
+
+int main() {
+    test_alignment_and_wrap();
+    test_wrap_when_empty();
+    test_retire_in_fence_order();
+    test_refusals();
+    test_in_flight_never_reused();
+    return test_finish();
+}
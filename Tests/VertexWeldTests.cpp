@@ -0,0 +1,209 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ObjParser.h"
+#include "TestCheck.h"
+#include "VertexWeld.h"
+
+using namespace DirectX;
+
+// position, uv & normal, what welding looks at
+constexpr size_t KEY_BYTES = offsetof(Vertex, Tangent);
+
+// Mesh::Load's old de-duplication, a string of every component per vertex
+static void legacy_weld(const std::vector<Vertex>& soup, std::vector<Vertex>* out_vertices, std::vector<uint32_t>* out_indices) {
+    std::unordered_map<std::string, unsigned int> vert_map;
+    out_vertices->clear();
+    out_indices->clear();
+    for (const Vertex& v : soup) {
+        std::string key =
+            std::to_string(v.Position.x) +
+            std::to_string(v.Position.y) +
+            std::to_string(v.Position.z) +
+            std::to_string(v.Normal.x) +
+            std::to_string(v.Normal.y) +
+            std::to_string(v.Normal.z) +
+            std::to_string(v.UV.x) +
+            std::to_string(v.UV.y);
+        auto pair = vert_map.find(key);
+        if (pair == vert_map.end()) {
+            vert_map.insert({ key, (unsigned int)out_vertices->size() });
+            out_indices->push_back((unsigned int)out_vertices->size());
+            out_vertices->push_back(v);
+        } else {
+            out_indices->push_back(pair->second);
+        }
+    }
+}
+
+// the exact weld spelled out serially, raw key bytes in a map
+static void reference_weld(const std::vector<Vertex>& soup, std::vector<Vertex>* out_vertices, std::vector<uint32_t>* out_indices) {
+    std::unordered_map<std::string, uint32_t> firsts;
+    out_vertices->clear();
+    out_indices->clear();
+    for (const Vertex& v : soup) {
+        auto inserted = firsts.try_emplace(std::string((const char*)&v, KEY_BYTES), (uint32_t)out_vertices->size());
+        if (inserted.second) out_vertices->push_back(v);
+        out_indices->push_back(inserted.first->second);
+    }
+}
+
+static bool welds_equal(const std::vector<Vertex>& a_vertices, const std::vector<uint32_t>& a_indices,
+                        const std::vector<Vertex>& b_vertices, const std::vector<uint32_t>& b_indices) {
+    if (a_vertices.size() != b_vertices.size() || a_indices != b_indices) return false;
+    for (size_t i = 0; i < a_vertices.size(); i++) {
+        if (memcmp(&a_vertices[i], &b_vertices[i], KEY_BYTES) != 0) return false;
+    }
+    return true;
+}
+
+// same vertices, same order, same indices as the string map
+static void test_assets_match_legacy() {
+    const char* meshes[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+    for (const char* mesh : meshes) {
+        std::vector<Vertex> soup;
+        obj_parse_file(test_asset_path((std::string("Meshes/") + mesh + ".obj").c_str()).c_str(), &soup);
+
+        std::vector<Vertex> legacy_vertices;
+        std::vector<uint32_t> legacy_indices;
+        auto start = std::chrono::high_resolution_clock::now();
+        legacy_weld(soup, &legacy_vertices, &legacy_indices);
+        double legacy_seconds = test_seconds_since(start);
+
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        VertexWeldStats stats = {};
+        vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, &vertices, &indices, &stats);
+        CHECK(welds_equal(vertices, indices, legacy_vertices, legacy_indices));
+        printf(
+            "%-18s %6zu -> %5zu verts  string map %7.2f ms  vertex_weld %5.2f ms\n",
+            mesh, soup.size(), vertices.size(), legacy_seconds * 1e3, stats.seconds * 1e3
+        );
+    }
+}
+
+// every component has to be within epsilon, cell edges don't matter
+static void test_epsilon() {
+    const float epsilon = 1e-3f;
+    Vertex base = {};
+    // right next to a grid cell edge, so neighbours land in the next cell over
+    base.Position = XMFLOAT3(2.0f * epsilon - 1e-5f, 1.0f, -3.0f);
+    base.UV = XMFLOAT2(0.25f, 0.75f);
+    base.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+    std::vector<Vertex> soup = { base };
+    auto nudged = [&](uint32_t component, float by) {
+        Vertex v = base;
+        (&v.Position.x)[component] += by;
+        soup.push_back(v);
+    };
+    for (uint32_t component = 0; component < KEY_BYTES / sizeof(float); component++) {
+        nudged(component, epsilon * 0.5f);
+        nudged(component, -epsilon * 0.9f);
+        nudged(component, epsilon * 1.5f);
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    vertex_weld(soup.data(), (uint32_t)soup.size(), epsilon, &vertices, &indices);
+    uint32_t wrong = 0;
+    for (uint32_t component = 0; component < KEY_BYTES / sizeof(float); component++) {
+        const uint32_t* triple = &indices[1 + component * 3];
+        wrong += triple[0] != 0 || triple[1] != 0 || triple[2] == 0;
+    }
+    CHECK(wrong == 0);
+    // the first one seen is what's kept
+    CHECK(indices[0] == 0 && memcmp(&vertices[0], &base, KEY_BYTES) == 0);
+    CHECK(vertices.size() == 1 + KEY_BYTES / sizeof(float));
+
+    // & an epsilon that covers everything leaves one
+    vertex_weld(soup.data(), (uint32_t)soup.size(), 1.0f, &vertices, &indices);
+    CHECK(vertices.size() == 1);
+}
+
+// a pool of unique verts drawn from at random, so duplicates are spread
+//   across every shard & far apart in the input
+static std::vector<Vertex> random_soup(uint32_t unique_count, uint32_t count, std::mt19937* random) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<Vertex> pool(unique_count);
+    for (Vertex& v : pool) {
+        v.Position = XMFLOAT3(unit(*random), unit(*random), unit(*random));
+        v.UV = XMFLOAT2(unit(*random), unit(*random));
+        v.Normal = XMFLOAT3(unit(*random), unit(*random), unit(*random));
+    }
+    std::vector<Vertex> soup(count);
+    for (Vertex& v : soup) v = pool[(*random)() % unique_count];
+    return soup;
+}
+
+// the sharded path (64K verts & up) gives what the serial weld does, either
+//   side of where it kicks in
+static void test_shards() {
+    std::mt19937 random(2);
+    for (uint32_t count : { 65535u, 65536u, 300000u }) {
+        std::vector<Vertex> soup = random_soup(count / 5, count, &random);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        VertexWeldStats stats = {};
+        vertex_weld(soup.data(), count, 0.0f, &vertices, &indices, &stats);
+        CHECK(stats.shard_count == (count >= 65536 ? 64u : 1u));
+
+        std::vector<Vertex> reference_vertices;
+        std::vector<uint32_t> reference_indices;
+        reference_weld(soup, &reference_vertices, &reference_indices);
+        CHECK(welds_equal(vertices, indices, reference_vertices, reference_indices));
+    }
+}
+
+// a big grid as triangle soup, every inner vertex shows up 6 times
+static void bench_grid() {
+    const uint32_t side = 300;
+    std::vector<Vertex> soup;
+    soup.reserve((size_t)side * side * 6);
+    auto corner = [&](uint32_t x, uint32_t y) {
+        Vertex v = {};
+        v.Position = XMFLOAT3((float)x, 0.0f, (float)y);
+        v.UV = XMFLOAT2((float)x / side, (float)y / side);
+        v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+        soup.push_back(v);
+    };
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            corner(x, y); corner(x + 1, y); corner(x, y + 1);
+            corner(x + 1, y); corner(x + 1, y + 1); corner(x, y + 1);
+        }
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    VertexWeldStats stats = {};
+    vertex_weld(soup.data(), (uint32_t)soup.size(), 0.0f, &vertices, &indices, &stats);
+    CHECK(vertices.size() == (size_t)(side + 1) * (side + 1));
+    VertexWeldStats epsilon_stats = {};
+    vertex_weld(soup.data(), (uint32_t)soup.size(), 1e-4f, &vertices, &indices, &epsilon_stats);
+    CHECK(vertices.size() == (size_t)(side + 1) * (side + 1));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint32_t> legacy_indices;
+    legacy_weld(soup, &vertices, &legacy_indices);
+    double legacy_seconds = test_seconds_since(start);
+    printf(
+        "grid %ux%u, %zu -> %zu verts: string map %.0f ms, exact %.1f ms on %u shards, epsilon %.1f ms\n",
+        side, side, soup.size(), vertices.size(), legacy_seconds * 1e3, stats.seconds * 1e3, stats.shard_count,
+        epsilon_stats.seconds * 1e3
+    );
+}
+
+int main() {
+    test_assets_match_legacy();
+    test_epsilon();
+    test_shards();
+    bench_grid();
+    return test_finish();
+}
@@ -0,0 +1,682 @@
+#include "TextureCompress.h"
+
+#include "Parallel.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+    // endpoint fit -> indices -> refit rounds per block, most blocks stop
+    //   improving after the second
+    constexpr uint32_t REFINE_PASSES = 3;
+
+    // BC7's 4 bit index weights out of 64
+    constexpr uint8_t BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // a block as floats, one array per channel so 4 texels fit a register
+    struct BlockChannels {
+        alignas(16) float values[4][16];
+    };
+
+    void load_block(const uint8_t* texels, BlockChannels* out_block) {
+        for (uint32_t i = 0; i < 16; i++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                out_block->values[c][i] = texels[i * 4 + c];
+            }
+        }
+    }
+
+    float clamp_unit(float value) {
+        return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+    }
+
+    // closest palette entry for every texel over channels first to
+    //   first + count - 1, 4 texels at a time. returns the squared error
+    float pick_indices(
+        const BlockChannels& block,
+        uint32_t first,
+        uint32_t count,
+        const float (*palette)[4],
+        uint32_t palette_size,
+        uint8_t* out_indices
+    ) {
+        __m128 total = _mm_setzero_ps();
+        for (uint32_t t = 0; t < 16; t += 4) {
+            __m128 best_error = _mm_set1_ps(1e30f);
+            __m128 best_index = _mm_setzero_ps();
+            for (uint32_t e = 0; e < palette_size; e++) {
+                __m128 error = _mm_setzero_ps();
+                for (uint32_t c = first; c < first + count; c++) {
+                    __m128 diff = _mm_sub_ps(_mm_load_ps(block.values[c] + t), _mm_set1_ps(palette[e][c]));
+                    error = _mm_add_ps(error, _mm_mul_ps(diff, diff));
+                }
+                // ties keep the earlier entry
+                __m128 closer = _mm_cmplt_ps(error, best_error);
+                best_error = _mm_min_ps(error, best_error);
+                best_index = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)e)), _mm_andnot_ps(closer, best_index));
+            }
+            total = _mm_add_ps(total, best_error);
+
+            alignas(16) float indices[4];
+            _mm_store_ps(indices, best_index);
+            for (uint32_t i = 0; i < 4; i++) {
+                out_indices[t + i] = (uint8_t)indices[i];
+            }
+        }
+
+        alignas(16) float sums[4];
+        _mm_store_ps(sums, total);
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }
+
+    // ends of the line through the block's main axis of variation, just
+    //   far enough out to cover every texel
+    void principal_endpoints(const BlockChannels& block, uint32_t first, uint32_t count, float* out_start, float* out_end) {
+        float mean[4] = {};
+        for (uint32_t c = first; c < first + count; c++) {
+            for (uint32_t i = 0; i < 16; i++) {
+                mean[c] += block.values[c][i];
+            }
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (uint32_t i = 0; i < 16; i++) {
+            for (uint32_t a = first; a < first + count; a++) {
+                for (uint32_t b = first; b < first + count; b++) {
+                    covariance[a][b] += (block.values[a][i] - mean[a]) * (block.values[b][i] - mean[b]);
+                }
+            }
+        }
+
+        // power iteration, starting from the channel that varies the most
+        uint32_t widest = first;
+        for (uint32_t c = first; c < first + count; c++) {
+            widest = covariance[c][c] > covariance[widest][widest] ? c : widest;
+        }
+        float axis[4] = {};
+        for (uint32_t c = first; c < first + count; c++) {
+            axis[c] = covariance[widest][c];
+        }
+        for (uint32_t iteration = 0; iteration < 8; iteration++) {
+            float next[4] = {};
+            float largest = 0.0f;
+            for (uint32_t a = first; a < first + count; a++) {
+                for (uint32_t b = first; b < first + count; b++) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                largest = fabsf(next[a]) > largest ? fabsf(next[a]) : largest;
+            }
+            if (largest == 0.0f) break;
+            for (uint32_t c = first; c < first + count; c++) {
+                axis[c] = next[c] / largest;
+            }
+        }
+
+        float length = 0.0f;
+        for (uint32_t c = first; c < first + count; c++) {
+            length += axis[c] * axis[c];
+        }
+        length = sqrtf(length);
+
+        float min_t = 0.0f;
+        float max_t = 0.0f;
+        if (length > 0.0f) {
+            for (uint32_t c = first; c < first + count; c++) {
+                axis[c] /= length;
+            }
+            min_t = 1e30f;
+            max_t = -1e30f;
+            for (uint32_t i = 0; i < 16; i++) {
+                float t = 0.0f;
+                for (uint32_t c = first; c < first + count; c++) {
+                    t += (block.values[c][i] - mean[c]) * axis[c];
+                }
+                min_t = t < min_t ? t : min_t;
+                max_t = t > max_t ? t : max_t;
+            }
+        }
+
+        for (uint32_t c = first; c < first + count; c++) {
+            out_start[c] = clamp_unit(mean[c] + axis[c] * min_t);
+            out_end[c] = clamp_unit(mean[c] + axis[c] * max_t);
+        }
+    }
+
+    // least squares endpoints for texels that already know where they sit
+    //   between them (0 = start, 1 = end). false if they all sit together
+    bool fit_endpoints(
+        const BlockChannels& block,
+        uint32_t first,
+        uint32_t count,
+        const float* weights,
+        float* out_start,
+        float* out_end
+    ) {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[4] = {};
+        float bx[4] = {};
+        for (uint32_t i = 0; i < 16; i++) {
+            float a = 1.0f - weights[i];
+            float b = weights[i];
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (uint32_t c = first; c < first + count; c++) {
+                ax[c] += a * block.values[c][i];
+                bx[c] += b * block.values[c][i];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if (fabsf(determinant) < 1e-6f) return false;
+        for (uint32_t c = first; c < first + count; c++) {
+            out_start[c] = clamp_unit((ax[c] * bb - bx[c] * ab) / determinant);
+            out_end[c] = clamp_unit((bx[c] * aa - ax[c] * ab) / determinant);
+        }
+        return true;
+    }
+
+    void swap_endpoints(float* start, float* end) {
+        for (uint32_t c = 0; c < 4; c++) {
+            float temp = start[c];
+            start[c] = end[c];
+            end[c] = temp;
+        }
+    }
+
+    uint16_t pack_565(const float* color) {
+        uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+        uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+        uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(uint16_t color, uint32_t* out_color) {
+        uint32_t r = color >> 11;
+        uint32_t g = (color >> 5) & 63;
+        uint32_t b = color & 31;
+        out_color[0] = (r << 3) | (r >> 2);
+        out_color[1] = (g << 2) | (g >> 4);
+        out_color[2] = (b << 3) | (b >> 2);
+    }
+
+    // BC4's 8 value palette, 0 & 1 are the endpoints & 2-7 step from one to the other
+    void bc4_palette(float start, float end, uint32_t channel, float (*out_palette)[4]) {
+        out_palette[0][channel] = start;
+        out_palette[1][channel] = end;
+        for (uint32_t i = 2; i < 8; i++) {
+            out_palette[i][channel] = ((8 - i) * start + (i - 1) * end) / 7.0f;
+        }
+    }
+
+    void bc4_encode_channel(const BlockChannels& block, uint32_t channel, uint8_t* out_block) {
+        float low = 255.0f;
+        float high = 0.0f;
+        for (uint32_t i = 0; i < 16; i++) {
+            float value = block.values[channel][i];
+            low = value < low ? value : low;
+            high = value > high ? value : high;
+        }
+
+        // the 8 value mode needs the first endpoint to be the bigger one
+        uint32_t start = (uint32_t)high;
+        uint32_t end = (uint32_t)low;
+        uint32_t best_start = start;
+        uint32_t best_end = end;
+        uint8_t best_indices[16] = {};
+        float best_error = 1e30f;
+        for (uint32_t pass = 0; pass < REFINE_PASSES && start > end; pass++) {
+            float palette[8][4] = {};
+            bc4_palette((float)start, (float)end, channel, palette);
+            uint8_t indices[16];
+            float error = pick_indices(block, channel, 1, palette, 8, indices);
+            if (error < best_error) {
+                best_error = error;
+                best_start = start;
+                best_end = end;
+                memcpy(best_indices, indices, sizeof(indices));
+            }
+            if (error == 0.0f) break;
+
+            float weights[16];
+            for (uint32_t i = 0; i < 16; i++) {
+                weights[i] = indices[i] == 0 ? 0.0f : (indices[i] == 1 ? 1.0f : (indices[i] - 1) / 7.0f);
+            }
+            float fit_start[4];
+            float fit_end[4];
+            if (!fit_endpoints(block, channel, 1, weights, fit_start, fit_end)) break;
+            start = (uint32_t)(fit_start[channel] + 0.5f);
+            end = (uint32_t)(fit_end[channel] + 0.5f);
+        }
+
+        uint64_t bits = best_start | (best_end << 8);
+        for (uint32_t i = 0; i < 16; i++) {
+            bits |= (uint64_t)best_indices[i] << (16 + i * 3);
+        }
+        memcpy(out_block, &bits, 8);
+    }
+
+    void bc4_decode_channel(const uint8_t* block, uint32_t channel, uint8_t* out_texels) {
+        uint64_t bits = 0;
+        memcpy(&bits, block, 8);
+        uint32_t start = block[0];
+        uint32_t end = block[1];
+
+        uint8_t palette[8];
+        palette[0] = (uint8_t)start;
+        palette[1] = (uint8_t)end;
+        if (start > end) {
+            for (uint32_t i = 2; i < 8; i++) {
+                palette[i] = (uint8_t)(((8 - i) * start + (i - 1) * end) / 7.0f + 0.5f);
+            }
+        } else {
+            for (uint32_t i = 2; i < 6; i++) {
+                palette[i] = (uint8_t)(((6 - i) * start + (i - 1) * end) / 5.0f + 0.5f);
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            out_texels[i * 4 + channel] = palette[(bits >> (16 + i * 3)) & 7];
+        }
+    }
+
+    // a 128 bit block, written & read from the lowest bit up
+    struct BlockBits {
+        uint64_t words[2];
+        uint32_t position;
+    };
+
+    void bits_write(BlockBits* bits, uint32_t value, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++, bits->position++) {
+            bits->words[bits->position / 64] |= (uint64_t)((value >> i) & 1) << (bits->position % 64);
+        }
+    }
+
+    uint32_t bits_read(BlockBits* bits, uint32_t count) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++, bits->position++) {
+            value |= (uint32_t)((bits->words[bits->position / 64] >> (bits->position % 64)) & 1) << i;
+        }
+        return value;
+    }
+
+    // 7 bits & the p-bit under them, whichever p-bit gets the color closest
+    void bc7_quantize(const float* color, uint8_t* out_values, uint8_t* out_p_bit) {
+        float best_error = 1e30f;
+        for (uint32_t p = 0; p < 2; p++) {
+            uint8_t values[4];
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; c++) {
+                float scaled = (color[c] - p) * 0.5f + 0.5f;
+                values[c] = (uint8_t)(scaled < 0.0f ? 0.0f : (scaled > 127.0f ? 127.0f : scaled));
+                float diff = (float)((values[c] << 1) | p) - color[c];
+                error += diff * diff;
+            }
+            if (error < best_error) {
+                best_error = error;
+                memcpy(out_values, values, 4);
+                *out_p_bit = (uint8_t)p;
+            }
+        }
+    }
+}
+
+bool texture_format_is_block(uint32_t format) {
+    return format != TEXTURE_FORMAT_RGBA8;
+}
+
+uint32_t texture_format_unit_size(uint32_t format) {
+    switch (format) {
+        case TEXTURE_FORMAT_BC1:
+        case TEXTURE_FORMAT_BC4: return 8;
+        case TEXTURE_FORMAT_BC5:
+        case TEXTURE_FORMAT_BC7: return 16;
+        default: return 4;
+    }
+}
+
+uint32_t texture_format_row_pitch(uint32_t format, uint32_t width) {
+    return texture_format_is_block(format)
+        ? ((width + 3) / 4) * texture_format_unit_size(format)
+        : width * texture_format_unit_size(format);
+}
+
+uint32_t texture_format_row_count(uint32_t format, uint32_t height) {
+    return texture_format_is_block(format) ? (height + 3) / 4 : height;
+}
+
+uint32_t texture_format_dxgi(uint32_t format) {
+    switch (format) {
+        case TEXTURE_FORMAT_BC1: return 71; // DXGI_FORMAT_BC1_UNORM
+        case TEXTURE_FORMAT_BC4: return 80; // DXGI_FORMAT_BC4_UNORM
+        case TEXTURE_FORMAT_BC5: return 83; // DXGI_FORMAT_BC5_UNORM
+        case TEXTURE_FORMAT_BC7: return 98; // DXGI_FORMAT_BC7_UNORM
+        default: return 28;                 // DXGI_FORMAT_R8G8B8A8_UNORM
+    }
+}
+
+void bc1_encode_block(const uint8_t* texels, uint8_t* out_block) {
+    BlockChannels block;
+    load_block(texels, &block);
+    float start[4] = {};
+    float end[4] = {};
+    principal_endpoints(block, 0, 3, start, end);
+
+    // where each index sits between the endpoints, the line goes 0, 2, 3, 1
+    static const float index_weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    uint16_t best_colors[2] = {};
+    uint8_t best_indices[16] = {};
+    float best_error = 1e30f;
+    for (uint32_t pass = 0; pass < REFINE_PASSES; pass++) {
+        // the 4 color mode needs the first endpoint to be the bigger one
+        uint16_t color0 = pack_565(start);
+        uint16_t color1 = pack_565(end);
+        if (color0 < color1) {
+            uint16_t temp = color0;
+            color0 = color1;
+            color1 = temp;
+            swap_endpoints(start, end);
+        }
+
+        uint32_t expanded[2][3];
+        unpack_565(color0, expanded[0]);
+        unpack_565(color1, expanded[1]);
+        float palette[4][4] = {};
+        for (uint32_t c = 0; c < 3; c++) {
+            palette[0][c] = (float)expanded[0][c];
+            palette[1][c] = (float)expanded[1][c];
+            palette[2][c] = (2.0f * expanded[0][c] + expanded[1][c]) / 3.0f;
+            palette[3][c] = (expanded[0][c] + 2.0f * expanded[1][c]) / 3.0f;
+        }
+
+        // equal endpoints mean the 3 color mode, only index 0 is safe there
+        uint8_t indices[16];
+        float error = pick_indices(block, 0, 3, palette, color0 == color1 ? 1 : 4, indices);
+        if (error < best_error) {
+            best_error = error;
+            best_colors[0] = color0;
+            best_colors[1] = color1;
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+        if (error == 0.0f) break;
+
+        float weights[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            weights[i] = index_weights[indices[i]];
+        }
+        if (!fit_endpoints(block, 0, 3, weights, start, end)) break;
+    }
+
+    uint32_t index_bits = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        index_bits |= (uint32_t)best_indices[i] << (i * 2);
+    }
+    memcpy(out_block, &best_colors[0], 2);
+    memcpy(out_block + 2, &best_colors[1], 2);
+    memcpy(out_block + 4, &index_bits, 4);
+}
+
+void bc4_encode_block(const uint8_t* texels, uint32_t channel, uint8_t* out_block) {
+    BlockChannels block;
+    load_block(texels, &block);
+    bc4_encode_channel(block, channel, out_block);
+}
+
+void bc5_encode_block(const uint8_t* texels, uint8_t* out_block) {
+    BlockChannels block;
+    load_block(texels, &block);
+    bc4_encode_channel(block, 0, out_block);
+    bc4_encode_channel(block, 1, out_block + 8);
+}
+
+void bc7_encode_block(const uint8_t* texels, uint8_t* out_block) {
+    BlockChannels block;
+    load_block(texels, &block);
+    float start[4] = {};
+    float end[4] = {};
+    principal_endpoints(block, 0, 4, start, end);
+
+    uint8_t best_endpoints[2][4] = {};
+    uint8_t best_p_bits[2] = {};
+    uint8_t best_indices[16] = {};
+    float best_error = 1e30f;
+    for (uint32_t pass = 0; pass < REFINE_PASSES; pass++) {
+        uint8_t endpoints[2][4];
+        uint8_t p_bits[2];
+        bc7_quantize(start, endpoints[0], &p_bits[0]);
+        bc7_quantize(end, endpoints[1], &p_bits[1]);
+
+        float palette[16][4];
+        for (uint32_t c = 0; c < 4; c++) {
+            uint32_t a = (endpoints[0][c] << 1) | p_bits[0];
+            uint32_t b = (endpoints[1][c] << 1) | p_bits[1];
+            for (uint32_t i = 0; i < 16; i++) {
+                palette[i][c] = (float)(((64 - BC7_WEIGHTS[i]) * a + BC7_WEIGHTS[i] * b + 32) >> 6);
+            }
+        }
+
+        uint8_t indices[16];
+        float error = pick_indices(block, 0, 4, palette, 16, indices);
+        if (error < best_error) {
+            best_error = error;
+            memcpy(best_endpoints, endpoints, sizeof(endpoints));
+            memcpy(best_p_bits, p_bits, sizeof(p_bits));
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+        if (error == 0.0f) break;
+
+        float weights[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+        }
+        if (!fit_endpoints(block, 0, 4, weights, start, end)) break;
+    }
+
+    // the first texel's index loses its top bit, so it has to be under 8.
+    //   swapping the endpoints flips every index around
+    if (best_indices[0] >= 8) {
+        for (uint32_t c = 0; c < 4; c++) {
+            uint8_t temp = best_endpoints[0][c];
+            best_endpoints[0][c] = best_endpoints[1][c];
+            best_endpoints[1][c] = temp;
+        }
+        uint8_t temp = best_p_bits[0];
+        best_p_bits[0] = best_p_bits[1];
+        best_p_bits[1] = temp;
+        for (uint32_t i = 0; i < 16; i++) {
+            best_indices[i] = (uint8_t)(15 - best_indices[i]);
+        }
+    }
+
+    BlockBits bits = {};
+    bits_write(&bits, 1 << 6, 7);
+    for (uint32_t c = 0; c < 4; c++) {
+        bits_write(&bits, best_endpoints[0][c], 7);
+        bits_write(&bits, best_endpoints[1][c], 7);
+    }
+    bits_write(&bits, best_p_bits[0], 1);
+    bits_write(&bits, best_p_bits[1], 1);
+    for (uint32_t i = 0; i < 16; i++) {
+        bits_write(&bits, best_indices[i], i == 0 ? 3 : 4);
+    }
+    memcpy(out_block, bits.words, 16);
+}
+
+void bc1_decode_block(const uint8_t* block, uint8_t* out_texels) {
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+    uint32_t index_bits = 0;
+    memcpy(&color0, block, 2);
+    memcpy(&color1, block + 2, 2);
+    memcpy(&index_bits, block + 4, 4);
+
+    uint32_t palette[4][4] = {};
+    unpack_565(color0, palette[0]);
+    unpack_565(color1, palette[1]);
+    palette[0][3] = 255;
+    palette[1][3] = 255;
+    palette[2][3] = 255;
+    for (uint32_t c = 0; c < 3; c++) {
+        if (color0 > color1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+        }
+    }
+    // 3 color mode's last entry is transparent black
+    palette[3][3] = color0 > color1 ? 255 : 0;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        const uint32_t* color = palette[(index_bits >> (i * 2)) & 3];
+        for (uint32_t c = 0; c < 4; c++) {
+            out_texels[i * 4 + c] = (uint8_t)color[c];
+        }
+    }
+}
+
+void bc4_decode_block(const uint8_t* block, uint8_t* out_texels) {
+    for (uint32_t i = 0; i < 16; i++) {
+        out_texels[i * 4 + 1] = 0;
+        out_texels[i * 4 + 2] = 0;
+        out_texels[i * 4 + 3] = 255;
+    }
+    bc4_decode_channel(block, 0, out_texels);
+}
+
+void bc5_decode_block(const uint8_t* block, uint8_t* out_texels) {
+    for (uint32_t i = 0; i < 16; i++) {
+        out_texels[i * 4 + 2] = 0;
+        out_texels[i * 4 + 3] = 255;
+    }
+    bc4_decode_channel(block, 0, out_texels);
+    bc4_decode_channel(block + 8, 1, out_texels);
+}
+
+void bc7_decode_block(const uint8_t* block, uint8_t* out_texels) {
+    BlockBits bits = {};
+    memcpy(bits.words, block, 16);
+    if (bits_read(&bits, 7) != 1 << 6) {
+        memset(out_texels, 0, 64);
+        return;
+    }
+
+    uint32_t endpoints[2][4];
+    for (uint32_t c = 0; c < 4; c++) {
+        endpoints[0][c] = bits_read(&bits, 7) << 1;
+        endpoints[1][c] = bits_read(&bits, 7) << 1;
+    }
+    uint32_t p_bit0 = bits_read(&bits, 1);
+    uint32_t p_bit1 = bits_read(&bits, 1);
+    for (uint32_t c = 0; c < 4; c++) {
+        endpoints[0][c] |= p_bit0;
+        endpoints[1][c] |= p_bit1;
+    }
+
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t weight = BC7_WEIGHTS[bits_read(&bits, i == 0 ? 3 : 4)];
+        for (uint32_t c = 0; c < 4; c++) {
+            out_texels[i * 4 + c] = (uint8_t)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+}
+
+void texture_compress(
+    const uint8_t* rgba,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    uint32_t format,
+    uint8_t* out_data,
+    uint32_t out_row_pitch,
+    TextureCompressStats* out_stats
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    uint32_t row_count = texture_format_row_count(format, height);
+
+    if (!texture_format_is_block(format)) {
+        for (uint32_t y = 0; y < height; y++) {
+            memcpy(out_data + (uint64_t)y * out_row_pitch, rgba + (uint64_t)y * row_pitch, (size_t)width * 4);
+        }
+    } else {
+        uint32_t blocks_x = (width + 3) / 4;
+        uint32_t block_size = texture_format_unit_size(format);
+
+        // a row of blocks per item, a 1024 wide level has 256 blocks in each
+        parallel_for(row_count, [&](uint32_t block_y) {
+            uint8_t texels[64];
+            for (uint32_t block_x = 0; block_x < blocks_x; block_x++) {
+                for (uint32_t y = 0; y < 4; y++) {
+                    uint32_t source_y = block_y * 4 + y < height ? block_y * 4 + y : height - 1;
+                    const uint8_t* row = rgba + (uint64_t)source_y * row_pitch;
+                    for (uint32_t x = 0; x < 4; x++) {
+                        uint32_t source_x = block_x * 4 + x < width ? block_x * 4 + x : width - 1;
+                        memcpy(texels + (y * 4 + x) * 4, row + source_x * 4, 4);
+                    }
+                }
+
+                uint8_t* out_block = out_data + (uint64_t)block_y * out_row_pitch + block_x * block_size;
+                switch (format) {
+                    case TEXTURE_FORMAT_BC1: bc1_encode_block(texels, out_block); break;
+                    case TEXTURE_FORMAT_BC4: bc4_encode_block(texels, 0, out_block); break;
+                    case TEXTURE_FORMAT_BC5: bc5_encode_block(texels, out_block); break;
+                    case TEXTURE_FORMAT_BC7: bc7_encode_block(texels, out_block); break;
+                }
+            }
+        });
+    }
+
+    if (out_stats) {
+        uint32_t workers = parallel_worker_count();
+        out_stats->block_count = texture_format_is_block(format) ? row_count * ((width + 3) / 4) : 0;
+        out_stats->thread_count = texture_format_is_block(format) ? (workers < row_count ? workers : row_count) : 1;
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        out_stats->seconds = elapsed.count();
+    }
+}
+
+void texture_decompress(
+    const uint8_t* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    uint32_t format,
+    uint8_t* out_rgba,
+    uint32_t out_row_pitch
+) {
+    if (!texture_format_is_block(format)) {
+        for (uint32_t y = 0; y < height; y++) {
+            memcpy(out_rgba + (uint64_t)y * out_row_pitch, data + (uint64_t)y * row_pitch, (size_t)width * 4);
+        }
+        return;
+    }
+
+    uint32_t block_size = texture_format_unit_size(format);
+    for (uint32_t block_y = 0; block_y < (height + 3) / 4; block_y++) {
+        for (uint32_t block_x = 0; block_x < (width + 3) / 4; block_x++) {
+            const uint8_t* block = data + (uint64_t)block_y * row_pitch + block_x * block_size;
+            uint8_t texels[64];
+            switch (format) {
+                case TEXTURE_FORMAT_BC1: bc1_decode_block(block, texels); break;
+                case TEXTURE_FORMAT_BC4: bc4_decode_block(block, texels); break;
+                case TEXTURE_FORMAT_BC5: bc5_decode_block(block, texels); break;
+                case TEXTURE_FORMAT_BC7: bc7_decode_block(block, texels); break;
+            }
+
+            // edge blocks only have part of theirs in the level
+            for (uint32_t y = 0; y < 4 && block_y * 4 + y < height; y++) {
+                uint8_t* row = out_rgba + (uint64_t)(block_y * 4 + y) * out_row_pitch;
+                for (uint32_t x = 0; x < 4 && block_x * 4 + x < width; x++) {
+                    memcpy(row + (block_x * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+// what a cooked texture's stored as. everything but RGBA8 is 4x4 blocks
+// 4 bytes a texel, nothing lost
+#define TEXTURE_FORMAT_RGBA8 0
+// 565 color & 2 bit indices, 8 bytes a block. no alpha
+#define TEXTURE_FORMAT_BC1 1
+// one channel with 3 bit indices, 8 bytes a block. reads back as (r, 0, 0, 1)
+#define TEXTURE_FORMAT_BC4 2
+// two BC4s, red then green, 16 bytes a block. reads back as (r, g, 0, 1)
+#define TEXTURE_FORMAT_BC5 3
+// RGBA, 16 bytes a block. only mode 6 gets encoded (one pair of 7 bit
+//   endpoints with p-bits, 4 bit indices), which is as good as it gets for
+//   smooth single color ranges & does fine on everything else
+#define TEXTURE_FORMAT_BC7 4
+
+bool texture_format_is_block(uint32_t format);
+// bytes per 4x4 block, or per texel for RGBA8
+uint32_t texture_format_unit_size(uint32_t format);
+// tightly packed, in blocks for the block formats
+uint32_t texture_format_row_pitch(uint32_t format, uint32_t width);
+uint32_t texture_format_row_count(uint32_t format, uint32_t height);
+// the DXGI_FORMAT it maps to (UNORM)
+uint32_t texture_format_dxgi(uint32_t format);
+
+// single 4x4 blocks. texels are RGBA8 in row order, 64 bytes
+void bc1_encode_block(const uint8_t* texels, uint8_t* out_block);
+// channel picks which of the texel's bytes gets encoded
+void bc4_encode_block(const uint8_t* texels, uint32_t channel, uint8_t* out_block);
+void bc5_encode_block(const uint8_t* texels, uint8_t* out_block);
+void bc7_encode_block(const uint8_t* texels, uint8_t* out_block);
+
+// back to RGBA8 the way the GPU reads them
+void bc1_decode_block(const uint8_t* block, uint8_t* out_texels);
+void bc4_decode_block(const uint8_t* block, uint8_t* out_texels);
+void bc5_decode_block(const uint8_t* block, uint8_t* out_texels);
+//! mode 6 only, that's all bc7_encode_block makes. other modes come out black
+void bc7_decode_block(const uint8_t* block, uint8_t* out_texels);
+
+struct TextureCompressStats {
+    uint32_t block_count;
+    uint32_t thread_count;
+    double seconds;
+};
+
+// a whole level with rows of blocks split across threads. edge blocks of
+//   levels that aren't a multiple of 4 repeat the last row/column.
+//   RGBA8 just gets copied
+void texture_compress(
+    const uint8_t* rgba,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    uint32_t format,
+    uint8_t* out_data,
+    uint32_t out_row_pitch,
+    TextureCompressStats* out_stats = nullptr
+);
+
+// the other way, for checking what the encoders lost
+void texture_decompress(
+    const uint8_t* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    uint32_t format,
+    uint8_t* out_rgba,
+    uint32_t out_row_pitch
+);
@@ -0,0 +1,129 @@
+#include "TextureConstant.h"
+
+#include <chrono>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+    double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // r, g, b & a of a 16 bit pair of texels (as unpacked from 8 bit),
+    //   widened & added onto 4 32 bit per channel totals
+    inline __m128i add_channels(__m128i totals, __m128i texels16) {
+        const __m128i zero = _mm_setzero_si128();
+        totals = _mm_add_epi32(totals, _mm_unpacklo_epi16(texels16, zero));
+        return _mm_add_epi32(totals, _mm_unpackhi_epi16(texels16, zero));
+    }
+}
+
+void texture_uniformity_scan(
+    const uint8_t* rgba,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    TextureUniformity* out_uniformity
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const __m128i zero = _mm_setzero_si128();
+
+    // 4 texels at a time, every lane lines up with the same channel so
+    //   folding down to one texel at the end is all it takes
+    __m128i min = _mm_set1_epi8((char)0xff);
+    __m128i max = _mm_setzero_si128();
+    uint64_t sums[4] = {};
+    uint64_t squares[4] = {};
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = rgba + (uint64_t)y * row_pitch;
+
+        // squares fit 16 bits & only 4 of them per lane per step go into
+        //   the 32 bit totals, so no row up to 32k wide overflows them
+        __m128i row_sums = _mm_setzero_si128();
+        __m128i row_squares = _mm_setzero_si128();
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i texels = _mm_loadu_si128((const __m128i*)(row + x * TEXTURE_TEXEL_SIZE));
+            min = _mm_min_epu8(min, texels);
+            max = _mm_max_epu8(max, texels);
+
+            __m128i low = _mm_unpacklo_epi8(texels, zero);
+            __m128i high = _mm_unpackhi_epi8(texels, zero);
+            row_sums = add_channels(row_sums, _mm_add_epi16(low, high));
+            row_squares = add_channels(row_squares, _mm_mullo_epi16(low, low));
+            row_squares = add_channels(row_squares, _mm_mullo_epi16(high, high));
+        }
+
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128((__m128i*)lanes, row_sums);
+        for (uint32_t c = 0; c < 4; c++) sums[c] += lanes[c];
+        _mm_store_si128((__m128i*)lanes, row_squares);
+        for (uint32_t c = 0; c < 4; c++) squares[c] += lanes[c];
+
+        // whatever doesn't fill a step goes through the same lanes
+        for (; x < width; x++) {
+            uint32_t texel;
+            memcpy(&texel, row + x * TEXTURE_TEXEL_SIZE, sizeof(texel));
+            __m128i single = _mm_set1_epi32((int)texel);
+            min = _mm_min_epu8(min, single);
+            max = _mm_max_epu8(max, single);
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t value = (texel >> (c * 8)) & 0xff;
+                sums[c] += value;
+                squares[c] += value * value;
+            }
+        }
+    }
+
+    alignas(16) uint8_t mins[16];
+    alignas(16) uint8_t maxes[16];
+    _mm_store_si128((__m128i*)mins, min);
+    _mm_store_si128((__m128i*)maxes, max);
+
+    double count = (double)width * height;
+    for (uint32_t c = 0; c < 4; c++) {
+        TextureChannelStats& channel = out_uniformity->channels[c];
+        channel.min = mins[c];
+        channel.max = maxes[c];
+        for (uint32_t lane = 1; lane < 4; lane++) {
+            channel.min = mins[lane * 4 + c] < channel.min ? mins[lane * 4 + c] : channel.min;
+            channel.max = maxes[lane * 4 + c] > channel.max ? maxes[lane * 4 + c] : channel.max;
+        }
+        double mean = (double)sums[c] / count;
+        double variance = (double)squares[c] / count - mean * mean;
+        channel.mean = (float)mean;
+        channel.variance = variance > 0.0 ? (float)variance : 0.0f;
+    }
+    out_uniformity->seconds = seconds_since(start_time);
+}
+
+TextureConstant texture_constant_from(const TextureUniformity& uniformity) {
+    TextureConstant constant = {};
+    for (uint32_t c = 0; c < 4; c++) {
+        const TextureChannelStats& channel = uniformity.channels[c];
+        constant.value[c] = (uint8_t)(channel.mean + 0.5f);
+        bool flat = (uint32_t)(channel.max - channel.min) <= CONSTANT_MAX_RANGE
+            && channel.variance <= CONSTANT_MAX_DEVIATION * CONSTANT_MAX_DEVIATION;
+        constant.channels |= flat ? 1u << c : 0;
+    }
+    return constant;
+}
+
+uint32_t texture_constant_pack(const TextureConstant& constant) {
+    return (uint32_t)constant.value[0]
+        | (uint32_t)constant.value[1] << 8
+        | (uint32_t)constant.value[2] << 16
+        | (uint32_t)constant.value[3] << 24;
+}
+
+void texture_collapse(
+    uint8_t* staging,
+    const TextureConstant& constant,
+    uint32_t row_alignment,
+    uint32_t mip_alignment,
+    TextureLayout* layout
+) {
+    texture_layout_compute(1, 1, 1, row_alignment, mip_alignment, layout);
+    memcpy(staging + layout->mips[0].offset, constant.value, sizeof(constant.value));
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include "TextureLoader.h"
+
+// one bit per channel of an RGBA8 texture
+#define TEXTURE_CHANNEL_R 0x1
+#define TEXTURE_CHANNEL_G 0x2
+#define TEXTURE_CHANNEL_B 0x4
+#define TEXTURE_CHANNEL_A 0x8
+constexpr uint32_t TEXTURE_CHANNELS_RGB = TEXTURE_CHANNEL_R | TEXTURE_CHANNEL_G | TEXTURE_CHANNEL_B;
+constexpr uint32_t TEXTURE_CHANNELS_ALL = TEXTURE_CHANNELS_RGB | TEXTURE_CHANNEL_A;
+
+// a channel counts as constant if nothing strays further than this from
+//   anything else (so the rounded mean is never more than 2 off)...
+constexpr uint32_t CONSTANT_MAX_RANGE = 4;
+// ...& it's not noise right up to that either. flat maps saved through
+//   something lossy still come in way under both
+constexpr float CONSTANT_MAX_DEVIATION = 1.0f;
+
+struct TextureChannelStats {
+    uint8_t min;
+    uint8_t max;
+    float mean;
+    float variance;
+};
+
+struct TextureUniformity {
+    TextureChannelStats channels[4];
+    double seconds;
+};
+
+// min, max, mean & variance of every channel in one pass
+void texture_uniformity_scan(
+    const uint8_t* rgba,
+    uint32_t width,
+    uint32_t height,
+    uint32_t row_pitch,
+    TextureUniformity* out_uniformity
+);
+
+struct TextureConstant {
+    // TEXTURE_CHANNEL_* of every channel that's flat enough to be a constant
+    uint32_t channels;
+    // each channel's rounded mean, only means anything where channels says so
+    uint8_t value[4];
+};
+
+// which channels pass CONSTANT_MAX_RANGE & CONSTANT_MAX_DEVIATION
+TextureConstant texture_constant_from(const TextureUniformity& uniformity);
+
+// the value as one RGBA8 texel (r in the low byte)
+uint32_t texture_constant_pack(const TextureConstant& constant);
+
+// a texture where every channel's constant doesn't need more than one
+//   texel: rewrites staging's first level as a 1x1 of constant.value & the
+//   layout to match (no mips, there's nothing to filter). staging always
+//   has room, the old top level is at least that big
+void texture_collapse(
+    uint8_t* staging,
+    const TextureConstant& constant,
+    uint32_t row_alignment,
+    uint32_t mip_alignment,
+    TextureLayout* layout
+);
@@ -0,0 +1,293 @@
+#include "TextureCooker.h"
+
+#include "ContentHash.h"
+#include "TexturePacker.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr uint32_t DDS_MAGIC = 0x20534444;   // "DDS "
+    constexpr uint32_t DDS_FOURCC_DX10 = 0x30315844; // "DX10"
+
+    constexpr uint32_t DDSD_CAPS = 0x1;
+    constexpr uint32_t DDSD_HEIGHT = 0x2;
+    constexpr uint32_t DDSD_WIDTH = 0x4;
+    constexpr uint32_t DDSD_PITCH = 0x8;
+    constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+    constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+    constexpr uint32_t DDPF_FOURCC = 0x4;
+    constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+    constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+    constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+    constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    // where everything before the first level ends
+    constexpr uint64_t DDS_DATA_OFFSET = sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDX10);
+
+    uint64_t level_size(uint32_t format, uint32_t width, uint32_t height) {
+        return (uint64_t)texture_format_row_pitch(format, width) * texture_format_row_count(format, height);
+    }
+
+    bool ends_with(const std::string& text, const char* suffix) {
+        size_t length = strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+}
+
+uint32_t texture_role_from_path(const char* path) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    if (ends_with(stem, "_albedo")) return TEXTURE_ROLE_ALBEDO;
+    if (ends_with(stem, "_normals")) return TEXTURE_ROLE_NORMALS;
+    if (ends_with(stem, "_roughness")) return TEXTURE_ROLE_ROUGHNESS;
+    if (ends_with(stem, "_metal")) return TEXTURE_ROLE_METAL;
+    if (ends_with(stem, "_orm")) return TEXTURE_ROLE_ORM;
+    return TEXTURE_ROLE_NONE;
+}
+
+uint32_t texture_role_format(uint32_t role, uint32_t width, uint32_t height) {
+    if (width % 4 != 0 || height % 4 != 0) {
+        return TEXTURE_FORMAT_RGBA8;
+    }
+    switch (role) {
+        case TEXTURE_ROLE_ALBEDO: return COOKED_ALBEDO_FORMAT;
+        case TEXTURE_ROLE_NORMALS: return TEXTURE_FORMAT_BC5;
+        case TEXTURE_ROLE_ROUGHNESS:
+        case TEXTURE_ROLE_METAL: return TEXTURE_FORMAT_BC4;
+        case TEXTURE_ROLE_ORM: return COOKED_ORM_FORMAT;
+        default: return TEXTURE_FORMAT_RGBA8;
+    }
+}
+
+uint64_t texture_source_hash(const void* data, size_t size) {
+    return content_hash(data, size);
+}
+
+std::string cooked_texture_path(const char* source_path) {
+    return std::filesystem::path(source_path).replace_extension(".dds").string();
+}
+
+bool cooked_texture_write(
+    const char* path,
+    uint64_t source_hash,
+    uint32_t role,
+    const uint8_t* rgba,
+    const TextureLayout& layout,
+    const TextureConstant& constant,
+    TextureCookStats* out_stats
+) {
+    uint32_t width = layout.mips[0].width;
+    uint32_t height = layout.mips[0].height;
+    uint32_t format = texture_role_format(role, width, height);
+    bool block = texture_format_is_block(format);
+
+    DDSHeader header = {};
+    header.size = sizeof(DDSHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT
+        | (block ? DDSD_LINEARSIZE : DDSD_PITCH);
+    header.height = height;
+    header.width = width;
+    header.pitch_or_linear_size = block
+        ? (uint32_t)level_size(format, width, height)
+        : texture_format_row_pitch(format, width);
+    header.depth = 1;
+    header.mip_map_count = layout.mip_count;
+    header.reserved1[0] = COOKED_TEXTURE_MAGIC;
+    header.reserved1[1] = COOKED_TEXTURE_VERSION;
+    header.reserved1[2] = (uint32_t)source_hash;
+    header.reserved1[3] = (uint32_t)(source_hash >> 32);
+    header.reserved1[4] = role;
+    header.reserved1[5] = format;
+    header.reserved1[6] = constant.channels;
+    header.reserved1[7] = texture_constant_pack(constant);
+    header.pixel_format.size = sizeof(DDSPixelFormat);
+    header.pixel_format.flags = DDPF_FOURCC;
+    header.pixel_format.four_cc = DDS_FOURCC_DX10;
+    header.caps = DDSCAPS_TEXTURE | (layout.mip_count > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    DDSHeaderDX10 header_dx10 = {};
+    header_dx10.dxgi_format = texture_format_dxgi(format);
+    header_dx10.resource_dimension = DDS_DIMENSION_TEXTURE2D;
+    header_dx10.array_size = 1;
+
+    TextureCookStats stats = {};
+    stats.format = format;
+
+    // write to a temp file first so a crash mid-write never
+    //   leaves a half-written cache that looks valid
+    std::string temp_path = std::string(path) + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        out.write((const char*)&DDS_MAGIC, sizeof(DDS_MAGIC));
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)&header_dx10, sizeof(header_dx10));
+
+        // the top level's the biggest, one buffer does for all of them
+        std::vector<uint8_t> level(level_size(format, width, height));
+        for (uint32_t i = 0; i < layout.mip_count; i++) {
+            const TextureMip& mip = layout.mips[i];
+            TextureCompressStats compress_stats = {};
+            texture_compress(
+                rgba + mip.offset, mip.width, mip.height, mip.row_pitch,
+                format, level.data(), texture_format_row_pitch(format, mip.width), &compress_stats
+            );
+            stats.compress.block_count += compress_stats.block_count;
+            stats.compress.thread_count = compress_stats.thread_count > stats.compress.thread_count
+                ? compress_stats.thread_count
+                : stats.compress.thread_count;
+            stats.compress.seconds += compress_stats.seconds;
+            out.write((const char*)level.data(), (std::streamsize)level_size(format, mip.width, mip.height));
+        }
+
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(temp_path);
+            return false;
+        }
+    }
+
+    if (out_stats) {
+        *out_stats = stats;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    return !error;
+}
+
+bool cooked_texture_open(const char* path, uint64_t source_hash, uint32_t role, bool mips, CookedTexture* out_texture) {
+    *out_texture = {};
+    if (!mapped_file_open(path, &out_texture->file)) {
+        return false;
+    }
+
+    const MappedFile& file = out_texture->file;
+    const DDSHeader* header = (const DDSHeader*)(file.data + sizeof(uint32_t));
+    const DDSHeaderDX10* header_dx10 = (const DDSHeaderDX10*)(file.data + sizeof(uint32_t) + sizeof(DDSHeader));
+
+    uint32_t magic = 0;
+    if (file.size >= DDS_DATA_OFFSET) {
+        memcpy(&magic, file.data, sizeof(magic));
+    }
+    bool valid =
+        file.size >= DDS_DATA_OFFSET &&
+        magic == DDS_MAGIC &&
+        header->size == sizeof(DDSHeader) &&
+        header->pixel_format.four_cc == DDS_FOURCC_DX10 &&
+        header->reserved1[0] == COOKED_TEXTURE_MAGIC &&
+        header->reserved1[1] == COOKED_TEXTURE_VERSION &&
+        (header->reserved1[2] | ((uint64_t)header->reserved1[3] << 32)) == source_hash &&
+        header->reserved1[4] == role &&
+        header->width > 0 &&
+        header->height > 0 &&
+        header->reserved1[5] == texture_role_format(role, header->width, header->height) &&
+        header_dx10->dxgi_format == texture_format_dxgi(header->reserved1[5]) &&
+        header->mip_map_count == (mips ? texture_full_mip_count(header->width, header->height) : 1);
+
+    if (!valid) {
+        cooked_texture_close(out_texture);
+        return false;
+    }
+
+    out_texture->header = header;
+    out_texture->format = header->reserved1[5];
+    out_texture->width = header->width;
+    out_texture->height = header->height;
+    out_texture->mip_count = header->mip_map_count;
+    out_texture->constant.channels = header->reserved1[6];
+    memcpy(out_texture->constant.value, &header->reserved1[7], sizeof(out_texture->constant.value));
+
+    // every level has to actually be in the file
+    uint64_t offset = DDS_DATA_OFFSET;
+    for (uint32_t i = 0; i < out_texture->mip_count; i++) {
+        uint32_t width = header->width >> i > 0 ? header->width >> i : 1;
+        uint32_t height = header->height >> i > 0 ? header->height >> i : 1;
+        out_texture->mips[i] = file.data + offset;
+        offset += level_size(out_texture->format, width, height);
+    }
+    if (offset > file.size) {
+        cooked_texture_close(out_texture);
+        return false;
+    }
+
+    return true;
+}
+
+void cooked_texture_close(CookedTexture* texture) {
+    mapped_file_close(&texture->file);
+    *texture = {};
+}
+
+bool texture_cook(const char* source_path, ImageDecoder* decoder) {
+    MappedFile source;
+    if (!mapped_file_open(source_path, &source)) {
+        return false;
+    }
+
+    TextureLoadJob job = {};
+    job.data = source.data;
+    job.size = source.size;
+    job.generate_mips = true;
+    texture_batch_prepare(&job, 1, decoder, 1, 1);
+
+    std::unique_ptr<uint8_t[]> pixels;
+    if (job.ok) {
+        pixels = std::make_unique<uint8_t[]>(job.layout.size);
+        job.staging = pixels.get();
+        texture_batch_decode(&job, 1, decoder);
+    }
+
+    TextureConstant constant = {};
+    if (job.ok) {
+        TextureUniformity uniformity;
+        const TextureMip& top = job.layout.mips[0];
+        texture_uniformity_scan(pixels.get() + top.offset, top.width, top.height, top.row_pitch, &uniformity);
+        constant = texture_constant_from(uniformity);
+        if (constant.channels == TEXTURE_CHANNELS_ALL) {
+            texture_collapse(pixels.get(), constant, 1, 1, &job.layout);
+        }
+    }
+
+    bool cooked = job.ok && cooked_texture_write(
+        cooked_texture_path(source_path).c_str(),
+        texture_source_hash(source.data, source.size),
+        texture_role_from_path(source_path),
+        pixels.get(),
+        job.layout,
+        constant
+    );
+    mapped_file_close(&source);
+    return cooked;
+}
+
+uint32_t texture_cook_prune_orm_sources(const char* orm_path) {
+    OrmSources sources;
+    if (!orm_sources_find(orm_path, &sources)) return 0;
+
+    // either mip setting counts, as long as it's from these maps
+    uint64_t source_hash = orm_sources_hash(sources);
+    std::string cooked_path = cooked_texture_path(orm_path);
+    CookedTexture cooked;
+    bool current = false;
+    for (bool mips : { true, false }) {
+        if (!current && cooked_texture_open(cooked_path.c_str(), source_hash, TEXTURE_ROLE_ORM, mips, &cooked)) {
+            cooked_texture_close(&cooked);
+            current = true;
+        }
+    }
+    if (!current) return 0;
+
+    uint32_t removed = 0;
+    for (const std::string& map_path : sources.paths) {
+        std::error_code error;
+        if (!map_path.empty() && std::filesystem::remove(cooked_texture_path(map_path.c_str()), error)) removed++;
+    }
+    return removed;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "TextureCompress.h"
+#include "TextureConstant.h"
+#include "TextureLoader.h"
+
+// what a texture's for, picked from its file name (see texture_role_from_path)
+//   & deciding what it gets cooked to
+// anything else, it stays RGBA8
+#define TEXTURE_ROLE_NONE 0
+// "_albedo", COOKED_ALBEDO_FORMAT
+#define TEXTURE_ROLE_ALBEDO 1
+// "_normals", BC5. only x & y survive, shaders rebuild z
+#define TEXTURE_ROLE_NORMALS 2
+// "_roughness", BC4
+#define TEXTURE_ROLE_ROUGHNESS 3
+// "_metal", BC4
+#define TEXTURE_ROLE_METAL 4
+// "_orm", occlusion, roughness & metal in r, g & b (see TexturePacker.h),
+//   COOKED_ORM_FORMAT
+#define TEXTURE_ROLE_ORM 5
+
+// BC7 by default. BC1 halves it again but loses ~9 dB on our albedos
+constexpr uint32_t COOKED_ALBEDO_FORMAT = TEXTURE_FORMAT_BC7;
+// same size as the two BC4s it replaces at 1 fetch instead of 2. roughness
+//   comes out about as close as BC4 gets it
+constexpr uint32_t COOKED_ORM_FORMAT = TEXTURE_FORMAT_BC7;
+
+constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58455443; // "CTEX"
+constexpr uint32_t COOKED_TEXTURE_VERSION = 2;
+
+// a cooked texture is a regular DDS ("DDS " + DDSHeader + DDSHeaderDX10 +
+//   every level tightly packed, biggest first), so anything that reads DDS
+//   can open it. our own bits ride along in the header's reserved1
+struct DDSPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t four_cc;
+    uint32_t rgb_bit_count;
+    uint32_t r_mask;
+    uint32_t g_mask;
+    uint32_t b_mask;
+    uint32_t a_mask;
+};
+
+struct DDSHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitch_or_linear_size;
+    uint32_t depth;
+    uint32_t mip_map_count;
+    // [0] COOKED_TEXTURE_MAGIC, [1] COOKED_TEXTURE_VERSION, [2] & [3] the
+    //   source hash (low, high), [4] TEXTURE_ROLE_*, [5] TEXTURE_FORMAT_*,
+    //   [6] & [7] the TextureConstant it was cooked with (channels, packed
+    //   value)
+    uint32_t reserved1[11];
+    DDSPixelFormat pixel_format;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+struct DDSHeaderDX10 {
+    uint32_t dxgi_format;
+    uint32_t resource_dimension;
+    uint32_t misc_flag;
+    uint32_t array_size;
+    uint32_t misc_flags2;
+};
+static_assert(sizeof(DDSPixelFormat) == 32, "DDSPixelFormat layout is part of the file format");
+static_assert(sizeof(DDSHeader) == 124, "DDSHeader layout is part of the file format");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDSHeaderDX10 layout is part of the file format");
+
+// a cooked texture mapped into memory, levels point straight into the mapping
+struct CookedTexture {
+    MappedFile file;
+    const DDSHeader* header;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+    const uint8_t* mips[TEXTURE_MAX_MIPS];
+    // which channels were flat in the source, a 1x1 has all of them
+    TextureConstant constant;
+};
+
+// by the file name's suffix, "Textures/bronze_albedo.png" -> TEXTURE_ROLE_ALBEDO
+uint32_t texture_role_from_path(const char* path);
+
+// TEXTURE_FORMAT_* for a role. block formats need the top level to be a
+//   multiple of 4 both ways, anything else stays RGBA8
+uint32_t texture_role_format(uint32_t role, uint32_t width, uint32_t height);
+
+// content hash used to detect stale caches, the same one meshes use
+uint64_t texture_source_hash(const void* data, size_t size);
+
+// "Assets/Textures/bronze_albedo.png" -> "Assets/Textures/bronze_albedo.dds"
+std::string cooked_texture_path(const char* source_path);
+
+struct TextureCookStats {
+    uint32_t format;
+    // summed over every level
+    TextureCompressStats compress;
+};
+
+// compresses every level of rgba (laid out as in TextureLoader.h) to
+//   texture_role_format's pick & writes it out. constant is what
+//   texture_constant_from made of the source, it gets stored so reopening
+//   doesn't need to scan again
+bool cooked_texture_write(
+    const char* path,
+    uint64_t source_hash,
+    uint32_t role,
+    const uint8_t* rgba,
+    const TextureLayout& layout,
+    const TextureConstant& constant,
+    TextureCookStats* out_stats = nullptr
+);
+
+// maps a cooked texture, failing if it's missing, corrupt, from an older
+//   version, cooked from different source bytes, for another role or with
+//   a different mip count (1 without mips, the full chain with them)
+bool cooked_texture_open(const char* path, uint64_t source_hash, uint32_t role, bool mips, CookedTexture* out_texture);
+void cooked_texture_close(CookedTexture* texture);
+
+// offline entry point: always rebuilds the .dds next to the image, mips
+//   included. flat images get collapsed to 1x1 like LoadTextures does
+bool texture_cook(const char* source_path, ImageDecoder* decoder);
+
+// offline cleanup for an "_orm" texture that gets packed from its maps (see
+//   TexturePacker.h): once its .dds is cooked from the maps as they are
+//   now, any .dds cooked from the maps themselves is dead weight. deletes
+//   those & returns how many, leaves everything be if the ORM cache is
+//   missing or stale. LoadTextures never deletes anything itself
+uint32_t texture_cook_prune_orm_sources(const char* orm_path);
@@ -0,0 +1,232 @@
+#include "TextureLoader.h"
+
+#include "Parallel.h"
+#include <chrono>
+#include <emmintrin.h>
+
+namespace {
+    uint64_t align_up(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // one output texel the slow way, for edges & whatever's left past the SSE loop
+    void downsample_texel(const uint8_t* row0, const uint8_t* row1, uint32_t x0, uint32_t x1, uint8_t* out) {
+        for (uint32_t c = 0; c < TEXTURE_TEXEL_SIZE; c++) {
+            uint32_t sum = row0[x0 * TEXTURE_TEXEL_SIZE + c] + row0[x1 * TEXTURE_TEXEL_SIZE + c]
+                + row1[x0 * TEXTURE_TEXEL_SIZE + c] + row1[x1 * TEXTURE_TEXEL_SIZE + c];
+            out[c] = (uint8_t)((sum + 2) >> 2);
+        }
+    }
+}
+
+uint32_t texture_full_mip_count(uint32_t width, uint32_t height) {
+    uint32_t size = width > height ? width : height;
+    uint32_t count = 1;
+    while (size > 1 && count < TEXTURE_MAX_MIPS) {
+        size >>= 1;
+        count++;
+    }
+    return count;
+}
+
+void texture_layout_compute(
+    uint32_t width,
+    uint32_t height,
+    uint32_t mip_count,
+    uint32_t row_alignment,
+    uint32_t mip_alignment,
+    TextureLayout* out_layout
+) {
+    uint32_t full_count = texture_full_mip_count(width, height);
+    mip_count = mip_count == 0 || mip_count > full_count ? full_count : mip_count;
+
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < mip_count; i++) {
+        TextureMip& mip = out_layout->mips[i];
+        offset = align_up(offset, mip_alignment);
+        mip.offset = offset;
+        mip.width = width;
+        mip.height = height;
+        mip.row_pitch = (uint32_t)align_up((uint64_t)width * TEXTURE_TEXEL_SIZE, row_alignment);
+        offset += (uint64_t)mip.row_pitch * height;
+
+        width = width > 1 ? width >> 1 : 1;
+        height = height > 1 ? height >> 1 : 1;
+    }
+    out_layout->mip_count = mip_count;
+    out_layout->size = offset;
+}
+
+void texture_downsample(
+    const uint8_t* src,
+    uint32_t src_width,
+    uint32_t src_height,
+    uint32_t src_pitch,
+    uint8_t* dst,
+    uint32_t dst_width,
+    uint32_t dst_height,
+    uint32_t dst_pitch
+) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+    for (uint32_t y = 0; y < dst_height; y++) {
+        const uint8_t* row0 = src + (uint64_t)(y * 2) * src_pitch;
+        // 1 tall sources average a row with itself
+        const uint8_t* row1 = y * 2 + 1 < src_height ? row0 + src_pitch : row0;
+        uint8_t* out = dst + (uint64_t)y * dst_pitch;
+
+        // 4 output texels from 8 on each row at a time, which needs the
+        //   source to be at least twice as wide
+        uint32_t x = 0;
+        if (src_width >= 2) {
+            for (; x + 4 <= dst_width; x += 4) {
+                __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+                __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+                __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+
+                // vertical sums, 2 texels per register as 16 bit channels
+                __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+                __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+                __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+                __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+                // horizontal pairs end up in the low half of each
+                s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+                s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+                s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+                s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+                __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), round), 2);
+                __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), round), 2);
+                _mm_storeu_si128((__m128i*)(out + x * TEXTURE_TEXEL_SIZE), _mm_packus_epi16(lo, hi));
+            }
+        }
+
+        for (; x < dst_width; x++) {
+            uint32_t x0 = x * 2;
+            uint32_t x1 = x0 + 1 < src_width ? x0 + 1 : x0;
+            downsample_texel(row0, row1, x0, x1, out + x * TEXTURE_TEXEL_SIZE);
+        }
+
+        // an odd source has a column nobody picked up, blend it into the
+        //   last texel. same for the last row below
+        if (src_width > 1 && (src_width & 1)) {
+            uint8_t* last = out + (dst_width - 1) * TEXTURE_TEXEL_SIZE;
+            uint8_t edge[TEXTURE_TEXEL_SIZE];
+            downsample_texel(row0, row1, src_width - 1, src_width - 1, edge);
+            for (uint32_t c = 0; c < TEXTURE_TEXEL_SIZE; c++) {
+                last[c] = (uint8_t)((last[c] * 2 + edge[c] + 1) / 3);
+            }
+        }
+    }
+
+    if (src_height > 1 && (src_height & 1)) {
+        const uint8_t* edge_row = src + (uint64_t)(src_height - 1) * src_pitch;
+        uint8_t* out = dst + (uint64_t)(dst_height - 1) * dst_pitch;
+        for (uint32_t x = 0; x < dst_width; x++) {
+            uint32_t x0 = x * 2 < src_width ? x * 2 : src_width - 1;
+            uint32_t x1 = x0 + 1 < src_width ? x0 + 1 : x0;
+            uint8_t edge[TEXTURE_TEXEL_SIZE];
+            downsample_texel(edge_row, edge_row, x0, x1, edge);
+            // the corner texel of an odd by odd source
+            if (x == dst_width - 1 && src_width > 1 && (src_width & 1)) {
+                const uint8_t* corner = edge_row + (src_width - 1) * TEXTURE_TEXEL_SIZE;
+                for (uint32_t c = 0; c < TEXTURE_TEXEL_SIZE; c++) {
+                    edge[c] = (uint8_t)((edge[c] * 2 + corner[c] + 1) / 3);
+                }
+            }
+            for (uint32_t c = 0; c < TEXTURE_TEXEL_SIZE; c++) {
+                uint8_t& value = out[x * TEXTURE_TEXEL_SIZE + c];
+                value = (uint8_t)((value * 2 + edge[c] + 1) / 3);
+            }
+        }
+    }
+}
+
+void texture_generate_mips(uint8_t* staging, const TextureLayout& layout) {
+    for (uint32_t i = 1; i < layout.mip_count; i++) {
+        const TextureMip& src = layout.mips[i - 1];
+        const TextureMip& dst = layout.mips[i];
+        texture_downsample(
+            staging + src.offset, src.width, src.height, src.row_pitch,
+            staging + dst.offset, dst.width, dst.height, dst.row_pitch
+        );
+    }
+}
+
+void texture_batch_prepare(
+    TextureLoadJob* jobs,
+    uint32_t count,
+    ImageDecoder* decoder,
+    uint32_t row_alignment,
+    uint32_t mip_alignment
+) {
+    for (uint32_t i = 0; i < count; i++) {
+        TextureLoadJob& job = jobs[i];
+        job.info = {};
+        job.layout = {};
+        job.staging = nullptr;
+        job.decode_seconds = 0.0;
+        job.mip_seconds = 0.0;
+        job.ok = job.data && decoder->read_info(job.data, job.size, &job.info)
+            && job.info.width > 0 && job.info.height > 0;
+        if (!job.ok) continue;
+
+        texture_layout_compute(
+            job.info.width, job.info.height, job.generate_mips ? 0 : 1,
+            row_alignment, mip_alignment, &job.layout
+        );
+    }
+}
+
+void texture_batch_decode(
+    TextureLoadJob* jobs,
+    uint32_t count,
+    ImageDecoder* decoder,
+    TextureBatchStats* out_stats
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // whole textures per thread, the batches this sees are a handful of big
+    //   images & splitting one up would mean splitting its decode too
+    parallel_for(count, [&](uint32_t i) {
+        TextureLoadJob& job = jobs[i];
+        if (!job.ok || !job.staging) {
+            job.ok = false;
+            return;
+        }
+
+        auto decode_start = std::chrono::high_resolution_clock::now();
+        job.ok = decoder->decode(job.data, job.size, job.staging + job.layout.mips[0].offset, job.layout.mips[0].row_pitch);
+        job.decode_seconds = seconds_since(decode_start);
+        if (!job.ok) return;
+
+        auto mip_start = std::chrono::high_resolution_clock::now();
+        texture_generate_mips(job.staging, job.layout);
+        job.mip_seconds = seconds_since(mip_start);
+    });
+
+    if (!out_stats) return;
+    TextureBatchStats stats = {};
+    stats.texture_count = count;
+    stats.thread_count = parallel_worker_count() < count ? parallel_worker_count() : count;
+    for (uint32_t i = 0; i < count; i++) {
+        const TextureLoadJob& job = jobs[i];
+        if (!job.ok) {
+            stats.failed_count++;
+            continue;
+        }
+        stats.staged_bytes += job.layout.size;
+        stats.decode_seconds += job.decode_seconds;
+        stats.mip_seconds += job.mip_seconds;
+    }
+    stats.wall_seconds = seconds_since(start_time);
+    *out_stats = stats;
+}
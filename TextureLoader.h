@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// enough for a 32k texture
+constexpr uint32_t TEXTURE_MAX_MIPS = 16;
+// everything the loader puts out is RGBA8
+constexpr uint32_t TEXTURE_TEXEL_SIZE = 4;
+
+struct ImageInfo {
+    uint32_t width;
+    uint32_t height;
+};
+
+// turns an encoded image (png, jpg...) into RGBA8. see PngImageDecoder in
+//   PngDecoder.h, anything else works as long as it's fine being called
+//   from several threads at once
+class ImageDecoder {
+   public:
+    virtual ~ImageDecoder() = default;
+    // just the header, should be cheap
+    virtual bool read_info(const uint8_t* data, size_t size, ImageInfo* out_info) = 0;
+    // the whole image into dest, rows row_pitch bytes apart
+    virtual bool decode(const uint8_t* data, size_t size, uint8_t* dest, uint32_t row_pitch) = 0;
+};
+
+// where one mip level sits in a texture's staging memory
+struct TextureMip {
+    uint64_t offset;
+    uint32_t width;
+    uint32_t height;
+    uint32_t row_pitch;
+};
+
+struct TextureLayout {
+    uint32_t mip_count;
+    // all of it, padding included
+    uint64_t size;
+    TextureMip mips[TEXTURE_MAX_MIPS];
+};
+
+// down to 1x1
+uint32_t texture_full_mip_count(uint32_t width, uint32_t height);
+
+// mips packed one after another, rows padded to row_alignment & levels
+//   starting on mip_alignment (both powers of two). with D3D12's 256 & 512
+//   this matches GetCopyableFootprints for RGBA8, so it can be copied as is
+void texture_layout_compute(
+    uint32_t width,
+    uint32_t height,
+    uint32_t mip_count,
+    uint32_t row_alignment,
+    uint32_t mip_alignment,
+    TextureLayout* out_layout
+);
+
+// 2x2 box filter down to dst's size (half of src, rounded down, at least
+//   1). an odd last row or column gets folded into the one before it
+void texture_downsample(
+    const uint8_t* src,
+    uint32_t src_width,
+    uint32_t src_height,
+    uint32_t src_pitch,
+    uint8_t* dst,
+    uint32_t dst_width,
+    uint32_t dst_height,
+    uint32_t dst_pitch
+);
+
+// fills every level past the first from the one before it
+void texture_generate_mips(uint8_t* staging, const TextureLayout& layout);
+
+// one image going through a batch
+struct TextureLoadJob {
+    // encoded bytes, they have to outlive the batch
+    const uint8_t* data;
+    size_t size;
+    bool generate_mips;
+
+    // texture_batch_prepare fills these in, the rest get skipped if !ok
+    bool ok;
+    ImageInfo info;
+    TextureLayout layout;
+
+    // the caller's, between prepare & decode: layout.size bytes for the
+    //   texture, usually straight in upload memory
+    uint8_t* staging;
+
+    double decode_seconds;
+    double mip_seconds;
+};
+
+struct TextureBatchStats {
+    uint32_t texture_count;
+    uint32_t failed_count;
+    uint32_t thread_count;
+    uint64_t staged_bytes;
+    // summed over every job, so more than wall_seconds with threads
+    double decode_seconds;
+    double mip_seconds;
+    double wall_seconds;
+};
+
+// reads every header & works out its layout, one thread since it's tiny
+void texture_batch_prepare(
+    TextureLoadJob* jobs,
+    uint32_t count,
+    ImageDecoder* decoder,
+    uint32_t row_alignment,
+    uint32_t mip_alignment
+);
+
+// decodes & makes mips for every prepared job across parallel_for's
+//   threads, one job per thread at a time. a failed decode clears ok
+void texture_batch_decode(
+    TextureLoadJob* jobs,
+    uint32_t count,
+    ImageDecoder* decoder,
+    TextureBatchStats* out_stats = nullptr
+);
@@ -0,0 +1,239 @@
+#include "TexturePacker.h"
+
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "TextureConstant.h"
+#include <chrono>
+#include <cstring>
+#include <emmintrin.h>
+#include <filesystem>
+#include <vector>
+
+namespace {
+    // channels of a gray map saved through something lossy drift apart a
+    //   little, packed maps are way further apart than this
+    constexpr uint32_t GRAY_TOLERANCE = 3;
+
+    // suffixes each ORM channel's map can go by, most common first
+    const char* const CHANNEL_SUFFIXES[ORM_CHANNEL_COUNT][2] = {
+        { "_occlusion", "_ao" },
+        { "_roughness", nullptr },
+        { "_metal", "_metalness" },
+    };
+
+    double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // where output texel i samples a map of source_size from, as the two
+    //   texels either side & the second's weight out of 256. texel centers
+    //   line up, the edges clamp
+    struct Tap {
+        uint32_t first;
+        uint32_t second;
+        uint32_t weight;
+    };
+
+    void compute_taps(uint32_t source_size, uint32_t size, Tap* out_taps) {
+        for (uint32_t i = 0; i < size; i++) {
+            float position = ((float)i + 0.5f) * (float)source_size / (float)size - 0.5f;
+            position = position < 0.0f ? 0.0f : position;
+            uint32_t first = (uint32_t)position;
+            first = first < source_size - 1 ? first : source_size - 1;
+            out_taps[i].first = first;
+            out_taps[i].second = first + 1 < source_size ? first + 1 : first;
+            out_taps[i].weight = (uint32_t)((position - (float)first) * 256.0f + 0.5f);
+            out_taps[i].weight = out_taps[i].weight > 256 ? 256 : out_taps[i].weight;
+        }
+    }
+}
+
+bool orm_sources_find(const char* orm_path, OrmSources* out_sources) {
+    *out_sources = {};
+    std::filesystem::path path(orm_path);
+    std::string stem = path.stem().string();
+    const char* suffix = "_orm";
+    if (stem.size() < 4 || stem.compare(stem.size() - 4, 4, suffix) != 0) {
+        return false;
+    }
+    std::string base = stem.substr(0, stem.size() - 4);
+
+    bool found = false;
+    for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+        for (const char* channel_suffix : CHANNEL_SUFFIXES[c]) {
+            if (!channel_suffix) continue;
+            std::filesystem::path candidate = path;
+            candidate.replace_filename(base + channel_suffix + path.extension().string());
+            std::error_code error;
+            if (std::filesystem::exists(candidate, error)) {
+                out_sources->paths[c] = candidate.string();
+                found = true;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+bool orm_path_for_source(const char* source_path, std::string* out_orm_path) {
+    std::filesystem::path path(source_path);
+    std::string stem = path.stem().string();
+    for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+        for (const char* channel_suffix : CHANNEL_SUFFIXES[c]) {
+            if (!channel_suffix) continue;
+            size_t length = strlen(channel_suffix);
+            if (stem.size() <= length || stem.compare(stem.size() - length, length, channel_suffix) != 0) continue;
+            path.replace_filename(stem.substr(0, stem.size() - length) + "_orm" + path.extension().string());
+            *out_orm_path = path.string();
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t orm_sources_hash(const OrmSources& sources) {
+    // missing maps hash as 0 in their slot so adding one still changes it
+    uint64_t hashes[ORM_CHANNEL_COUNT] = {};
+    for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+        if (sources.paths[c].empty()) continue;
+        MappedFile file;
+        if (!mapped_file_open(sources.paths[c].c_str(), &file)) {
+            return 0;
+        }
+        hashes[c] = content_hash(file.data, file.size);
+        mapped_file_close(&file);
+    }
+    return content_hash(hashes, sizeof(hashes));
+}
+
+bool texture_is_grayscale(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t row_pitch, uint32_t tolerance) {
+    // lines each texel up with itself shifted down a channel, so bytes 0
+    //   & 1 of every texel end up |r - g| & |g - b|
+    const __m128i rg_gb = _mm_set1_epi32(0x0000ffff);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = rgba + (uint64_t)y * row_pitch;
+        __m128i worst = _mm_setzero_si128();
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i texels = _mm_loadu_si128((const __m128i*)(row + x * 4));
+            __m128i shifted = _mm_srli_epi32(texels, 8);
+            __m128i diff = _mm_or_si128(_mm_subs_epu8(texels, shifted), _mm_subs_epu8(shifted, texels));
+            worst = _mm_max_epu8(worst, _mm_and_si128(diff, rg_gb));
+        }
+
+        // one row at a time, anything with color gives itself away early
+        alignas(16) uint8_t bytes[16];
+        _mm_store_si128((__m128i*)bytes, worst);
+        uint32_t row_worst = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            row_worst = bytes[i] > row_worst ? bytes[i] : row_worst;
+        }
+        for (; x < width; x++) {
+            const uint8_t* texel = row + x * 4;
+            uint32_t rg = texel[0] > texel[1] ? texel[0] - texel[1] : texel[1] - texel[0];
+            uint32_t gb = texel[1] > texel[2] ? texel[1] - texel[2] : texel[2] - texel[1];
+            row_worst = rg > row_worst ? rg : row_worst;
+            row_worst = gb > row_worst ? gb : row_worst;
+        }
+        if (row_worst > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool orm_source_is_packed(const PackSource& source) {
+    return source.rgba && !texture_is_grayscale(source.rgba, source.width, source.height, source.row_pitch, GRAY_TOLERANCE);
+}
+
+void orm_pack_size(const PackSource* sources, uint32_t* out_width, uint32_t* out_height) {
+    uint32_t width = 1;
+    uint32_t height = 1;
+    for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+        if (!sources[c].rgba) continue;
+        width = sources[c].width > width ? sources[c].width : width;
+        height = sources[c].height > height ? sources[c].height : height;
+    }
+    *out_width = width;
+    *out_height = height;
+}
+
+void texture_pack_orm(const PackSource* sources, uint8_t* out_rgba, uint32_t out_row_pitch, TexturePackStats* out_stats) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    TexturePackStats stats = {};
+
+    uint32_t width;
+    uint32_t height;
+    orm_pack_size(sources, &width, &height);
+
+    // alpha's unused, everything else gets written channel by channel
+    for (uint32_t y = 0; y < height; y++) {
+        uint32_t* row = (uint32_t*)(out_rgba + (uint64_t)y * out_row_pitch);
+        for (uint32_t x = 0; x < width; x++) {
+            row[x] = 0xff000000;
+        }
+    }
+
+    std::vector<Tap> x_taps(width);
+    std::vector<Tap> y_taps(height);
+    for (uint32_t c = 0; c < ORM_CHANNEL_COUNT; c++) {
+        const PackSource& source = sources[c];
+        bool packed = orm_source_is_packed(source);
+        uint32_t source_channel = packed ? c : 0;
+        stats.packed_source_count += packed ? 1 : 0;
+
+        // no map & a flat one come out the same, one value everywhere
+        uint8_t fill = ORM_DEFAULTS[c];
+        bool flat = !source.rgba;
+        if (source.rgba) {
+            TextureUniformity uniformity;
+            texture_uniformity_scan(source.rgba, source.width, source.height, source.row_pitch, &uniformity);
+            TextureConstant constant = texture_constant_from(uniformity);
+            flat = (constant.channels & (1u << source_channel)) != 0;
+            fill = flat ? constant.value[source_channel] : fill;
+            stats.constant_count += flat ? 1 : 0;
+        }
+        if (flat) {
+            for (uint32_t y = 0; y < height; y++) {
+                uint8_t* row = out_rgba + (uint64_t)y * out_row_pitch;
+                for (uint32_t x = 0; x < width; x++) {
+                    row[x * 4 + c] = fill;
+                }
+            }
+            continue;
+        }
+
+        if (source.width == width && source.height == height) {
+            for (uint32_t y = 0; y < height; y++) {
+                const uint8_t* in = source.rgba + (uint64_t)y * source.row_pitch + source_channel;
+                uint8_t* out = out_rgba + (uint64_t)y * out_row_pitch + c;
+                for (uint32_t x = 0; x < width; x++) {
+                    out[x * 4] = in[x * 4];
+                }
+            }
+            continue;
+        }
+
+        stats.resampled_count++;
+        compute_taps(source.width, width, x_taps.data());
+        compute_taps(source.height, height, y_taps.data());
+        for (uint32_t y = 0; y < height; y++) {
+            const Tap& y_tap = y_taps[y];
+            const uint8_t* row0 = source.rgba + (uint64_t)y_tap.first * source.row_pitch + source_channel;
+            const uint8_t* row1 = source.rgba + (uint64_t)y_tap.second * source.row_pitch + source_channel;
+            uint8_t* out = out_rgba + (uint64_t)y * out_row_pitch + c;
+            for (uint32_t x = 0; x < width; x++) {
+                const Tap& x_tap = x_taps[x];
+                uint32_t top = row0[x_tap.first * 4] * (256 - x_tap.weight) + row0[x_tap.second * 4] * x_tap.weight;
+                uint32_t bottom = row1[x_tap.first * 4] * (256 - x_tap.weight) + row1[x_tap.second * 4] * x_tap.weight;
+                out[x * 4] = (uint8_t)((top * (256 - y_tap.weight) + bottom * y_tap.weight + 32768) >> 16);
+            }
+        }
+    }
+
+    stats.seconds = seconds_since(start_time);
+    if (out_stats) {
+        *out_stats = stats;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// which channel of an ORM texture each map ends up in
+#define ORM_CHANNEL_OCCLUSION 0
+#define ORM_CHANNEL_ROUGHNESS 1
+#define ORM_CHANNEL_METAL 2
+constexpr uint32_t ORM_CHANNEL_COUNT = 3;
+
+// what a channel gets when there's no map for it: unoccluded, fully rough
+//   & not metal at all
+constexpr uint8_t ORM_DEFAULTS[ORM_CHANNEL_COUNT] = { 255, 255, 0 };
+
+// the single channel maps a "_orm" texture gets packed from, found next to
+//   it by suffix: "_occlusion" or "_ao", "_roughness", "_metal" or
+//   "_metalness". "" where there's no such file
+struct OrmSources {
+    std::string paths[ORM_CHANNEL_COUNT];
+};
+
+// "Textures/bronze_orm.png" -> "Textures/bronze_roughness.png" & friends,
+//   false if there's none of them
+bool orm_sources_find(const char* orm_path, OrmSources* out_sources);
+
+// the other way: "Textures/bronze_roughness.png" -> "Textures/bronze_orm.png",
+//   false if the path isn't named like any of the maps
+bool orm_path_for_source(const char* source_path, std::string* out_orm_path);
+
+// stands in for the source hash of a packed texture, changes if any of its
+//   maps do or one shows up / goes away. 0 if one can't be read
+uint64_t orm_sources_hash(const OrmSources& sources);
+
+// an RGBA8 image to pack from, rgba == nullptr for a missing map
+struct PackSource {
+    const uint8_t* rgba;
+    uint32_t width;
+    uint32_t height;
+    uint32_t row_pitch;
+};
+
+// true if r, g & b never differ by more than tolerance anywhere
+bool texture_is_grayscale(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t row_pitch, uint32_t tolerance);
+
+// single channel maps are gray & get read from red. a map with color is
+//   taken to already be packed ORM, whatever channel it's packed for gets
+//   read from where ORM keeps it
+bool orm_source_is_packed(const PackSource& source);
+
+// the output size, as big as the biggest map each way (1x1 with none)
+void orm_pack_size(const PackSource* sources, uint32_t* out_width, uint32_t* out_height);
+
+struct TexturePackStats {
+    // maps that were picked up as already packed
+    uint32_t packed_source_count;
+    // flat maps (see TextureConstant.h), they just get filled in
+    uint32_t constant_count;
+    // maps that had to be resampled to the output size
+    uint32_t resampled_count;
+    double seconds;
+};
+
+// sources[ORM_CHANNEL_*] into RGBA8 (occlusion, roughness, metal, 255) at
+//   orm_pack_size. maps smaller than that get bilinearly stretched, unless
+//   they're flat & their value can be filled in as is
+void texture_pack_orm(
+    const PackSource* sources,
+    uint8_t* out_rgba,
+    uint32_t out_row_pitch,
+    TexturePackStats* out_stats = nullptr
+);
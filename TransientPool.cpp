@@ -0,0 +1,138 @@
+#include "TransientPool.h"
+
+static bool same_key(const TransientKey& a, const TransientKey& b) {
+    return a.format == b.format && a.width == b.width && a.height == b.height && a.flags == b.flags;
+}
+
+void transient_pool_create(TransientPool* pool, uint32_t release_after_frames) {
+    pool->slots.clear();
+    pool->frame = 0;
+    pool->release_after_frames = release_after_frames;
+    pool->stats = {};
+}
+
+void transient_pool_begin_frame(TransientPool* pool, std::vector<TransientRelease>* out_released) {
+    pool->frame++;
+
+    for (uint32_t s = 0; s < (uint32_t)pool->slots.size(); s++) {
+        TransientSlot& slot = pool->slots[s];
+        if (!slot.live) continue;
+        slot.acquired = false;
+
+        if (pool->frame - slot.last_used_frame > pool->release_after_frames) {
+            slot.live = false;
+            slot.placements.clear();
+            slot.active = TRANSIENT_NONE;
+            pool->stats.slot_count--;
+            pool->stats.capacity_bytes -= slot.capacity;
+            pool->stats.release_count++;
+            out_released->push_back({ s, TRANSIENT_NONE });
+            continue;
+        }
+
+        // the memory's still wanted but maybe not as this (old size, say)
+        for (uint32_t p = 0; p < (uint32_t)slot.placements.size(); p++) {
+            TransientPlacement& placement = slot.placements[p];
+            if (placement.live && pool->frame - placement.last_used_frame > pool->release_after_frames) {
+                placement.live = false;
+                if (slot.active == p) {
+                    slot.active = TRANSIENT_NONE;
+                }
+                pool->stats.release_count++;
+                out_released->push_back({ s, p });
+            }
+        }
+    }
+}
+
+TransientAcquire transient_pool_acquire(TransientPool* pool, const TransientKey& key, uint64_t size, uint64_t alignment) {
+    TransientAcquire result = { TRANSIENT_NONE, TRANSIENT_NONE, false, false, false };
+    pool->stats.acquire_count++;
+
+    // same key already placed somewhere free. the first one that's active
+    //   wins since it doesn't need a barrier, & acquiring the same keys in
+    //   the same order gets the same resources back every frame
+    bool found_active = false;
+    for (uint32_t s = 0; s < (uint32_t)pool->slots.size() && !found_active; s++) {
+        const TransientSlot& slot = pool->slots[s];
+        if (!slot.live || slot.acquired) continue;
+
+        for (uint32_t p = 0; p < (uint32_t)slot.placements.size(); p++) {
+            if (!slot.placements[p].live || !same_key(slot.placements[p].key, key)) continue;
+            if (result.slot == TRANSIENT_NONE || slot.active == p) {
+                result.slot = s;
+                result.placement = p;
+                found_active = slot.active == p;
+            }
+        }
+    }
+
+    // otherwise a new placement in the smallest free memory that fits
+    if (result.slot == TRANSIENT_NONE) {
+        uint64_t best_capacity = UINT64_MAX;
+        for (uint32_t s = 0; s < (uint32_t)pool->slots.size(); s++) {
+            const TransientSlot& slot = pool->slots[s];
+            bool fits = slot.capacity >= size && slot.alignment >= alignment;
+            if (slot.live && !slot.acquired && fits && slot.capacity < best_capacity) {
+                result.slot = s;
+                best_capacity = slot.capacity;
+            }
+        }
+    }
+
+    // or new memory, in a dead slot's spot if there is one
+    if (result.slot == TRANSIENT_NONE) {
+        for (uint32_t s = 0; s < (uint32_t)pool->slots.size() && result.slot == TRANSIENT_NONE; s++) {
+            if (!pool->slots[s].live) {
+                result.slot = s;
+            }
+        }
+        if (result.slot == TRANSIENT_NONE) {
+            pool->slots.emplace_back();
+            result.slot = (uint32_t)pool->slots.size() - 1;
+        }
+
+        TransientSlot& slot = pool->slots[result.slot];
+        slot.capacity = size;
+        slot.alignment = alignment;
+        slot.placements.clear();
+        slot.active = TRANSIENT_NONE;
+        slot.live = true;
+        result.allocate = true;
+        pool->stats.slot_count++;
+        pool->stats.capacity_bytes += size;
+        pool->stats.allocation_count++;
+    }
+
+    TransientSlot& slot = pool->slots[result.slot];
+    if (result.placement == TRANSIENT_NONE) {
+        for (uint32_t p = 0; p < (uint32_t)slot.placements.size() && result.placement == TRANSIENT_NONE; p++) {
+            if (!slot.placements[p].live) {
+                result.placement = p;
+            }
+        }
+        if (result.placement == TRANSIENT_NONE) {
+            slot.placements.emplace_back();
+            result.placement = (uint32_t)slot.placements.size() - 1;
+        }
+        slot.placements[result.placement].key = key;
+        slot.placements[result.placement].live = true;
+        result.create = true;
+        pool->stats.create_count++;
+    }
+
+    result.aliased = slot.active != TRANSIENT_NONE && slot.active != result.placement;
+    if (result.aliased) {
+        pool->stats.alias_count++;
+    }
+
+    slot.active = result.placement;
+    slot.acquired = true;
+    slot.last_used_frame = pool->frame;
+    slot.placements[result.placement].last_used_frame = pool->frame;
+    return result;
+}
+
+void transient_pool_release(TransientPool* pool, uint32_t slot) {
+    pool->slots[slot].acquired = false;
+}
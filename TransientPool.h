@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+constexpr uint32_t TRANSIENT_NONE = UINT32_MAX;
+
+// what a transient resource is, requests with equal keys can share one
+//   resource. 2D, one mip, the rest is up to the backend
+struct TransientKey {
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;
+};
+
+// one resource placed in a slot's memory. a slot can hold several, they
+//   alias each other & only one of them is active at a time
+struct TransientPlacement {
+    TransientKey key;
+    uint64_t last_used_frame;
+    bool live;
+};
+
+// one piece of memory, the backend owns the heap space & resources behind it
+struct TransientSlot {
+    uint64_t capacity;
+    uint64_t alignment;
+    std::vector<TransientPlacement> placements;
+    // placement whose contents are in the memory right now
+    uint32_t active;
+    uint64_t last_used_frame;
+    // handed out & not released yet this frame
+    bool acquired;
+    bool live;
+};
+
+struct TransientAcquire {
+    uint32_t slot;
+    uint32_t placement;
+    // new memory, capacity bytes of it
+    bool allocate;
+    // new resource for this placement, views on it have to be (re)made
+    bool create;
+    // another placement was active in the memory, so the resource needs an
+    //   aliasing barrier & a clear/discard before anything reads it
+    bool aliased;
+};
+
+// what begin_frame dropped, placement == TRANSIENT_NONE means the whole
+//   slot (memory & every placement in it)
+struct TransientRelease {
+    uint32_t slot;
+    uint32_t placement;
+};
+
+struct TransientPoolStats {
+    uint32_t slot_count;
+    uint64_t capacity_bytes;
+    // over the pool's life
+    uint64_t acquire_count;
+    uint64_t allocation_count;
+    uint64_t create_count;
+    uint64_t alias_count;
+    uint64_t release_count;
+};
+
+// hands out transient resources (render targets & such) by key, one
+//   frame at a time. the same key every frame gets the same resource back,
+//   anything else goes into memory nobody's acquired yet this frame if
+//   it fits (smallest that does), new memory only when nothing fits.
+//   placements & slots nobody's asked for in release_after_frames frames
+//   get dropped. nothing here touches the GPU
+struct TransientPool {
+    std::vector<TransientSlot> slots;
+    uint64_t frame;
+    uint32_t release_after_frames;
+    TransientPoolStats stats;
+};
+
+// release_after_frames has to be more than the frames in flight so dropped
+//   resources aren't still in use on the GPU
+void transient_pool_create(TransientPool* pool, uint32_t release_after_frames);
+
+// next frame: nothing's acquired anymore & whatever sat idle for too long
+//   goes into out_released for the backend to free
+void transient_pool_begin_frame(TransientPool* pool, std::vector<TransientRelease>* out_released);
+
+// size & alignment are what the resource needs, memory only gets reused
+//   if it's at least that big & that aligned
+TransientAcquire transient_pool_acquire(TransientPool* pool, const TransientKey& key, uint64_t size, uint64_t alignment);
+
+// done with it for the rest of the frame, later acquires can alias it
+void transient_pool_release(TransientPool* pool, uint32_t slot);
@@ -0,0 +1,70 @@
+#include "UploadRing.h"
+
+void upload_ring_create(UploadRing* ring, uint64_t capacity, UploadFence* fence) {
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->batches.clear();
+    ring->fence = fence;
+    ring->stats = {};
+}
+
+void upload_ring_retire(UploadRing* ring) {
+    if (ring->batches.empty()) return;
+
+    uint64_t completed = ring->fence->get_completed_value();
+    while (!ring->batches.empty() && ring->batches.front().fence_value <= completed) {
+        ring->tail = ring->batches.front().end;
+        ring->batches.pop_front();
+    }
+}
+
+bool upload_ring_allocate(UploadRing* ring, uint64_t size, uint64_t alignment, uint64_t* out_offset) {
+    if (size > ring->capacity) return false;
+
+    upload_ring_retire(ring);
+    for (;;) {
+        uint64_t offset = ring->head % ring->capacity;
+        uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        // allocations never straddle the end, the rest of the ring gets skipped instead
+        if (aligned + size > ring->capacity) {
+            aligned = 0;
+        }
+        uint64_t padding = aligned >= offset ? aligned - offset : ring->capacity - offset;
+        uint64_t needed = padding + size;
+
+        if (ring->head + needed - ring->tail <= ring->capacity) {
+            ring->head += needed;
+            ring->stats.allocation_count++;
+            ring->stats.allocated_bytes += needed;
+            ring->stats.padding_bytes += padding;
+            *out_offset = aligned;
+            return true;
+        }
+
+        // nothing's in flight, so starting over at the next lap is free. the
+        //   skipped end would otherwise count against the space & could
+        //   refuse an allocation an empty ring has room for
+        if (ring->head == ring->tail) {
+            ring->head = ring->tail = ring->head - offset + ring->capacity;
+            continue;
+        }
+        if (ring->batches.empty()) return false;
+
+        ring->fence->wait(ring->batches.front().fence_value);
+        ring->stats.wait_count++;
+        upload_ring_retire(ring);
+    }
+}
+
+void upload_ring_close_batch(UploadRing* ring, uint64_t fence_value) {
+    if (!upload_ring_has_open_batch(ring)) return;
+
+    ring->batches.push_back({ fence_value, ring->head });
+    ring->stats.batch_count++;
+}
+
+bool upload_ring_has_open_batch(const UploadRing* ring) {
+    uint64_t closed_end = ring->batches.empty() ? ring->tail : ring->batches.back().end;
+    return ring->head != closed_end;
+}
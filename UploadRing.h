@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// what the upload ring needs from the GPU, so all of its bookkeeping can
+//   run without one (see MockUploadFence). values only ever go up
+class UploadFence {
+   public:
+    virtual ~UploadFence() = default;
+    // highest value the GPU has finished
+    virtual uint64_t get_completed_value() = 0;
+    // blocks until the GPU has finished value
+    virtual void wait(uint64_t value) = 0;
+};
+
+// a fence completed by hand, for driving the ring on the CPU alone.
+//   waiting acts like a GPU that finishes the moment someone blocks on it
+class MockUploadFence : public UploadFence {
+   public:
+    uint64_t completed_value = 0;
+    uint64_t wait_count = 0;
+
+    uint64_t get_completed_value() override { return completed_value; }
+    void wait(uint64_t value) override {
+        wait_count++;
+        complete(value);
+    }
+    void complete(uint64_t value) { completed_value = value > completed_value ? value : completed_value; }
+};
+
+// every allocation made between two closes, its space comes back once the
+//   fence reaches fence_value
+struct UploadRingBatch {
+    uint64_t fence_value;
+    // ring head when the batch was closed
+    uint64_t end;
+};
+
+struct UploadRingStats {
+    uint64_t allocation_count;
+    // including alignment padding & space skipped at the wrap
+    uint64_t allocated_bytes;
+    uint64_t padding_bytes;
+    uint64_t batch_count;
+    // times an allocation had to block on the fence for space
+    uint64_t wait_count;
+};
+
+// staging space handed out front to back & given back in fence order.
+//   head & tail count bytes since creation and never wrap, the actual
+//   offset is position % capacity
+struct UploadRing {
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t tail;
+    std::deque<UploadRingBatch> batches;
+    UploadFence* fence;
+    UploadRingStats stats;
+};
+
+void upload_ring_create(UploadRing* ring, uint64_t capacity, UploadFence* fence);
+
+// gives back the space of every batch the fence has passed, never blocks
+void upload_ring_retire(UploadRing* ring);
+
+// reserves size bytes at an offset that's a multiple of alignment (a power
+//   of two that divides the capacity). waits on the fence if closed batches
+//   are in the way. false when it can't fit even then: too big for the whole
+//   ring, or the open batch is what's in the way and has to be closed first
+bool upload_ring_allocate(UploadRing* ring, uint64_t size, uint64_t alignment, uint64_t* out_offset);
+
+// everything allocated since the last close comes back once fence_value is done
+void upload_ring_close_batch(UploadRing* ring, uint64_t fence_value);
+
+// anything allocated since the last close?
+bool upload_ring_has_open_batch(const UploadRing* ring);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include <cstdint>
 #include <vector>
 #include <d3d12.h>
 
@@ -9,6 +10,9 @@ struct Vertex {
     DirectX::XMFLOAT2 UV;
     DirectX::XMFLOAT3 Normal;
     DirectX::XMFLOAT3 Tangent;
+    // +1 or -1, bitangent = Handedness * cross(Normal, Tangent). right after
+    //   Tangent so the two read as the float4 the full layout uploads
+    float Handedness = 1.0f;
 };
 
 std::vector<D3D12_INPUT_ELEMENT_DESC> vertex_get_input_elements();
@@ -0,0 +1,13 @@
+#ifndef VERTEX_CONFIG_H
+#define VERTEX_CONFIG_H
+
+//! included by both C++ and HLSL, keep this to preprocessor stuff only
+
+#define VERTEX_LAYOUT_FULL 0       // float everything, 48 bytes
+#define VERTEX_LAYOUT_OCTAHEDRAL 1 // quantized position & UV, octahedral normal & tangent, 20 bytes
+#define VERTEX_LAYOUT_QTANGENT 2   // quantized position & UV, quaternion tangent frame, 20 bytes
+
+// the layout vertex buffers get uploaded in, shaders decode to match
+#define VERTEX_LAYOUT VERTEX_LAYOUT_QTANGENT
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef VERTEX_DECODE_H
+#define VERTEX_DECODE_H
+
+#include "IOStructs.hlsli"
+
+// unpacked vertex, matches what VSInput used to be before compression
+struct DecodedVertex {
+	float3 position;
+	float2 uv;
+	float3 normal;
+	// w = handedness, bitangent = w * cross(normal, tangent)
+	float4 tangent;
+};
+
+// mirrors vertex_octahedral_decode in VertexLayout.cpp
+float3 octahedral_decode(float2 e) {
+	float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+// mirrors vertex_qtangent_decode, the rotation's x column is the tangent and
+//   z is the normal. w's sign is the handedness
+void qtangent_decode(float4 q, out float3 normal, out float4 tangent) {
+	float handedness = q.w < 0.0f ? -1.0f : 1.0f;
+	q = normalize(q);
+	tangent.xyz = float3(
+		1.0f - 2.0f * (q.y * q.y + q.z * q.z),
+		2.0f * (q.x * q.y + q.w * q.z),
+		2.0f * (q.x * q.z - q.w * q.y)
+	);
+	tangent.w = handedness;
+	normal = float3(
+		2.0f * (q.x * q.z + q.w * q.y),
+		2.0f * (q.y * q.z - q.w * q.x),
+		1.0f - 2.0f * (q.x * q.x + q.y * q.y)
+	);
+}
+
+// the offsets/scales come from the mesh, see Mesh::get_vertex_encode_params
+DecodedVertex decode_vertex(VSInput input, float3 position_offset, float3 position_scale, float2 uv_offset, float2 uv_scale) {
+	DecodedVertex v;
+
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_FULL
+	v.position = input.position;
+	v.uv = input.uv;
+	v.normal = input.normal;
+	v.tangent = input.tangent;
+#else
+	v.position = position_offset + input.position.xyz * position_scale;
+	v.uv = uv_offset + input.uv * uv_scale;
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_OCTAHEDRAL
+	v.normal = octahedral_decode(input.normal);
+	v.tangent = float4(octahedral_decode(input.tangent), input.position.w >= 0.5f ? 1.0f : -1.0f);
+#else
+	qtangent_decode(input.qtangent, v.normal, v.tangent);
+#endif
+#endif
+
+	return v;
+}
+
+#endif
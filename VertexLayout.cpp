@@ -0,0 +1,191 @@
+#include "VertexLayout.h"
+
+using namespace DirectX;
+
+namespace {
+    constexpr float SNORM16_MAX = 32767.0f;
+    constexpr float UNORM16_MAX = 65535.0f;
+
+    // smallest |w| that still has a sign after snorm16 quantization
+    constexpr float QTANGENT_W_BIAS = 1.0f / SNORM16_MAX;
+}
+
+static float sign_not_zero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static float clamp(float value, float low, float high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+VertexEncodeParams vertex_encode_params_create(const Vertex* vertices, uint32_t count, XMFLOAT3 bounds_min, XMFLOAT3 bounds_max) {
+    VertexEncodeParams params = {};
+    params.position_offset = bounds_min;
+    params.position_scale = XMFLOAT3(
+        bounds_max.x - bounds_min.x,
+        bounds_max.y - bounds_min.y,
+        bounds_max.z - bounds_min.z
+    );
+
+    if (count > 0) {
+        XMVECTOR uv_min = XMLoadFloat2(&vertices[0].UV);
+        XMVECTOR uv_max = uv_min;
+        for (uint32_t i = 1; i < count; i++) {
+            XMVECTOR uv = XMLoadFloat2(&vertices[i].UV);
+            uv_min = XMVectorMin(uv_min, uv);
+            uv_max = XMVectorMax(uv_max, uv);
+        }
+        XMStoreFloat2(&params.uv_offset, uv_min);
+        XMStoreFloat2(&params.uv_scale, XMVectorSubtract(uv_max, uv_min));
+    }
+    return params;
+}
+
+int16_t vertex_pack_snorm16(float value) {
+    return (int16_t)roundf(clamp(value, -1.0f, 1.0f) * SNORM16_MAX);
+}
+
+float vertex_unpack_snorm16(int16_t value) {
+    // -32768 and -32767 both mean -1, same as the GPU does it
+    float f = (float)value / SNORM16_MAX;
+    return f < -1.0f ? -1.0f : f;
+}
+
+uint16_t vertex_pack_unorm16(float value) {
+    return (uint16_t)roundf(clamp(value, 0.0f, 1.0f) * UNORM16_MAX);
+}
+
+float vertex_unpack_unorm16(uint16_t value) {
+    return (float)value / UNORM16_MAX;
+}
+
+XMFLOAT2 vertex_octahedral_encode(XMFLOAT3 n) {
+    float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+    if (l1 <= 0.0f) return XMFLOAT2(0.0f, 0.0f);
+
+    float x = n.x / l1;
+    float y = n.y / l1;
+    if (n.z < 0.0f) {
+        float folded_x = (1.0f - fabsf(y)) * sign_not_zero(x);
+        float folded_y = (1.0f - fabsf(x)) * sign_not_zero(y);
+        x = folded_x;
+        y = folded_y;
+    }
+    return XMFLOAT2(x, y);
+}
+
+XMFLOAT3 vertex_octahedral_decode(XMFLOAT2 e) {
+    XMFLOAT3 n(e.x, e.y, 1.0f - fabsf(e.x) - fabsf(e.y));
+    float t = -n.z > 0.0f ? -n.z : 0.0f;
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+
+    XMStoreFloat3(&n, XMVector3Normalize(XMLoadFloat3(&n)));
+    return n;
+}
+
+XMFLOAT4 vertex_qtangent_encode(XMFLOAT3 normal, XMFLOAT3 tangent, float handedness) {
+    // orthonormal frame first, quaternions can't hold skew
+    XMVECTOR n = XMLoadFloat3(&normal);
+    if (XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f) n = XMVectorSet(0, 0, 1, 0);
+    n = XMVector3Normalize(n);
+
+    XMVECTOR t = XMLoadFloat3(&tangent);
+    t = t - n * XMVectorGetX(XMVector3Dot(n, t));
+    if (XMVectorGetX(XMVector3LengthSq(t)) <= 1e-12f) {
+        // no usable tangent, any perpendicular will do
+        XMVECTOR axis = fabsf(XMVectorGetX(n)) < 0.9f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0);
+        t = axis - n * XMVectorGetX(XMVector3Dot(n, axis));
+    }
+    t = XMVector3Normalize(t);
+    XMVECTOR b = XMVector3Cross(n, t);
+
+    // columns of the rotation are (T, N x T, N)
+    XMFLOAT3 c0, c1, c2;
+    XMStoreFloat3(&c0, t);
+    XMStoreFloat3(&c1, b);
+    XMStoreFloat3(&c2, n);
+    float m00 = c0.x, m10 = c0.y, m20 = c0.z;
+    float m01 = c1.x, m11 = c1.y, m21 = c1.z;
+    float m02 = c2.x, m12 = c2.y, m22 = c2.z;
+
+    XMFLOAT4 q;
+    float trace = m00 + m11 + m22;
+    if (trace > 0.0f) {
+        float s = sqrtf(trace + 1.0f) * 2.0f;
+        q = XMFLOAT4((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, 0.25f * s);
+    } else if (m00 > m11 && m00 > m22) {
+        float s = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
+        q = XMFLOAT4(0.25f * s, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+    } else if (m11 > m22) {
+        float s = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
+        q = XMFLOAT4((m01 + m10) / s, 0.25f * s, (m12 + m21) / s, (m02 - m20) / s);
+    } else {
+        float s = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
+        q = XMFLOAT4((m02 + m20) / s, (m12 + m21) / s, 0.25f * s, (m10 - m01) / s);
+    }
+    XMStoreFloat4(&q, XMVector4Normalize(XMLoadFloat4(&q)));
+
+    // q and -q are the same rotation, so w's sign is free to store handedness
+    if (q.w < 0.0f) {
+        q = XMFLOAT4(-q.x, -q.y, -q.z, -q.w);
+    }
+    if (q.w < QTANGENT_W_BIAS) {
+        float rescale = sqrtf(1.0f - QTANGENT_W_BIAS * QTANGENT_W_BIAS);
+        q = XMFLOAT4(q.x * rescale, q.y * rescale, q.z * rescale, QTANGENT_W_BIAS);
+    }
+    if (handedness < 0.0f) {
+        q = XMFLOAT4(-q.x, -q.y, -q.z, -q.w);
+    }
+    return q;
+}
+
+void vertex_qtangent_decode(XMFLOAT4 q, XMFLOAT3* out_normal, XMFLOAT3* out_tangent, float* out_handedness) {
+    *out_handedness = sign_not_zero(q.w);
+    XMStoreFloat4(&q, XMVector4Normalize(XMLoadFloat4(&q)));
+
+    // the rotation's x & z columns
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+    *out_tangent = XMFLOAT3(
+        1.0f - 2.0f * (y * y + z * z),
+        2.0f * (x * y + w * z),
+        2.0f * (x * z - w * y)
+    );
+    *out_normal = XMFLOAT3(
+        2.0f * (x * z + w * y),
+        2.0f * (y * z - w * x),
+        1.0f - 2.0f * (x * x + y * y)
+    );
+}
+
+static float angle_between(XMFLOAT3 a, XMFLOAT3 b) {
+    XMVECTOR va = XMLoadFloat3(&a);
+    XMVECTOR vb = XMLoadFloat3(&b);
+    // zero length vectors (missing tangents) have nothing to compare
+    if (XMVectorGetX(XMVector3LengthSq(va)) <= 0.0f || XMVectorGetX(XMVector3LengthSq(vb)) <= 0.0f) return 0.0f;
+
+    // atan2 instead of acos, acos can't resolve tiny angles in float
+    float sin = XMVectorGetX(XMVector3Length(XMVector3Cross(va, vb)));
+    float cos = XMVectorGetX(XMVector3Dot(va, vb));
+    return atan2f(sin, cos);
+}
+
+VertexLayoutError vertex_layout_measure_error(const Vertex* original, const Vertex* decoded, uint32_t count) {
+    VertexLayoutError error = {};
+    for (uint32_t i = 0; i < count; i++) {
+        const Vertex& a = original[i];
+        const Vertex& b = decoded[i];
+
+        float position = XMVectorGetX(XMVector3Length(XMLoadFloat3(&a.Position) - XMLoadFloat3(&b.Position)));
+        float uv = XMVectorGetX(XMVector2Length(XMLoadFloat2(&a.UV) - XMLoadFloat2(&b.UV)));
+        float normal = angle_between(a.Normal, b.Normal);
+        float tangent = angle_between(a.Tangent, b.Tangent);
+
+        error.position = position > error.position ? position : error.position;
+        error.uv = uv > error.uv ? uv : error.uv;
+        error.normal_angle = normal > error.normal_angle ? normal : error.normal_angle;
+        error.tangent_angle = tangent > error.tangent_angle ? tangent : error.tangent_angle;
+        if (a.Handedness != b.Handedness) error.handedness_mismatches++;
+    }
+    return error;
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <d3d12.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Vertex.h"
+#include "VertexConfig.h"
+
+// per mesh values some attributes need to encode/decode, positions & UVs
+//   get quantized relative to the mesh's bounds (offset = min, scale = max - min)
+struct VertexEncodeParams {
+    DirectX::XMFLOAT3 position_offset;
+    DirectX::XMFLOAT3 position_scale;
+    DirectX::XMFLOAT2 uv_offset;
+    DirectX::XMFLOAT2 uv_scale;
+};
+
+// bounds_min/max are the mesh's AABB, the UV range comes from walking the verts
+VertexEncodeParams vertex_encode_params_create(
+    const Vertex* vertices,
+    uint32_t count,
+    DirectX::XMFLOAT3 bounds_min,
+    DirectX::XMFLOAT3 bounds_max
+);
+
+// --- ENCODING HELPERS ---
+
+int16_t vertex_pack_snorm16(float value);
+float vertex_unpack_snorm16(int16_t value);
+uint16_t vertex_pack_unorm16(float value);
+float vertex_unpack_unorm16(uint16_t value);
+
+// value -> [0, 1] across a range, flat ranges all land on the offset
+inline float vertex_range_normalize(float value, float offset, float scale) {
+    return scale > 0.0f ? (value - offset) / scale : 0.0f;
+}
+
+// unit vector <-> 2 components in [-1, 1], folding the octahedron's bottom half over the top
+DirectX::XMFLOAT2 vertex_octahedral_encode(DirectX::XMFLOAT3 n);
+DirectX::XMFLOAT3 vertex_octahedral_decode(DirectX::XMFLOAT2 e);
+
+// rotation taking +x to the tangent and +z to the normal, w's sign holds
+//   the bitangent's handedness (w is kept away from 0 so the sign survives snorm16)
+DirectX::XMFLOAT4 vertex_qtangent_encode(DirectX::XMFLOAT3 normal, DirectX::XMFLOAT3 tangent, float handedness);
+void vertex_qtangent_decode(DirectX::XMFLOAT4 q, DirectX::XMFLOAT3* out_normal, DirectX::XMFLOAT3* out_tangent, float* out_handedness);
+
+// --- ATTRIBUTES ---
+
+// every attribute describes how it's stored (Stored, which has to be a
+//   multiple of 4 bytes), what the input assembler sees (SEMANTIC, FORMAT)
+//   and how to get there from a Vertex and back
+namespace VertexAttributes {
+    struct PositionFloat3 {
+        using Stored = DirectX::XMFLOAT3;
+        static constexpr const char* SEMANTIC = "POSITION";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R32G32B32_FLOAT;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) { *out = v.Position; }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) { v->Position = in; }
+    };
+
+    // 16 bits per axis across the mesh bounds. w would just be padding, so
+    //   it carries the tangent's handedness instead (0 = -1, 1 = +1)
+    struct PositionUnorm16 {
+        struct Stored {
+            uint16_t xyzw[4];
+        };
+        static constexpr const char* SEMANTIC = "POSITION";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R16G16B16A16_UNORM;
+
+        static void encode(const Vertex& v, const VertexEncodeParams& p, Stored* out) {
+            out->xyzw[0] = vertex_pack_unorm16(vertex_range_normalize(v.Position.x, p.position_offset.x, p.position_scale.x));
+            out->xyzw[1] = vertex_pack_unorm16(vertex_range_normalize(v.Position.y, p.position_offset.y, p.position_scale.y));
+            out->xyzw[2] = vertex_pack_unorm16(vertex_range_normalize(v.Position.z, p.position_offset.z, p.position_scale.z));
+            out->xyzw[3] = v.Handedness < 0.0f ? 0 : UINT16_MAX;
+        }
+        static void decode(const Stored& in, const VertexEncodeParams& p, Vertex* v) {
+            v->Position.x = p.position_offset.x + vertex_unpack_unorm16(in.xyzw[0]) * p.position_scale.x;
+            v->Position.y = p.position_offset.y + vertex_unpack_unorm16(in.xyzw[1]) * p.position_scale.y;
+            v->Position.z = p.position_offset.z + vertex_unpack_unorm16(in.xyzw[2]) * p.position_scale.z;
+            v->Handedness = in.xyzw[3] >= UINT16_MAX / 2 ? 1.0f : -1.0f;
+        }
+    };
+
+    struct UVFloat2 {
+        using Stored = DirectX::XMFLOAT2;
+        static constexpr const char* SEMANTIC = "TEXCOORD";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R32G32_FLOAT;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) { *out = v.UV; }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) { v->UV = in; }
+    };
+
+    // 16 bits per axis across the mesh's UV range, so the precision doesn't
+    //   depend on how far from 0 the UVs sit (halves got blurry on tiled UVs)
+    //! it does scale with the range, a mesh tiling a texture thousands of times should stay float
+    struct UVUnorm16 {
+        struct Stored {
+            uint16_t xy[2];
+        };
+        static constexpr const char* SEMANTIC = "TEXCOORD";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R16G16_UNORM;
+
+        static void encode(const Vertex& v, const VertexEncodeParams& p, Stored* out) {
+            out->xy[0] = vertex_pack_unorm16(vertex_range_normalize(v.UV.x, p.uv_offset.x, p.uv_scale.x));
+            out->xy[1] = vertex_pack_unorm16(vertex_range_normalize(v.UV.y, p.uv_offset.y, p.uv_scale.y));
+        }
+        static void decode(const Stored& in, const VertexEncodeParams& p, Vertex* v) {
+            v->UV.x = p.uv_offset.x + vertex_unpack_unorm16(in.xy[0]) * p.uv_scale.x;
+            v->UV.y = p.uv_offset.y + vertex_unpack_unorm16(in.xy[1]) * p.uv_scale.y;
+        }
+    };
+
+    struct NormalFloat3 {
+        using Stored = DirectX::XMFLOAT3;
+        static constexpr const char* SEMANTIC = "NORMAL";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R32G32B32_FLOAT;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) { *out = v.Normal; }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) { v->Normal = in; }
+    };
+
+    // w is the handedness
+    struct TangentFloat4 {
+        using Stored = DirectX::XMFLOAT4;
+        static constexpr const char* SEMANTIC = "TANGENT";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) {
+            *out = DirectX::XMFLOAT4(v.Tangent.x, v.Tangent.y, v.Tangent.z, v.Handedness);
+        }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) {
+            v->Tangent = DirectX::XMFLOAT3(in.x, in.y, in.z);
+            v->Handedness = in.w < 0.0f ? -1.0f : 1.0f;
+        }
+    };
+
+    struct NormalOctahedral {
+        struct Stored {
+            int16_t xy[2];
+        };
+        static constexpr const char* SEMANTIC = "NORMAL";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R16G16_SNORM;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) {
+            DirectX::XMFLOAT2 e = vertex_octahedral_encode(v.Normal);
+            out->xy[0] = vertex_pack_snorm16(e.x);
+            out->xy[1] = vertex_pack_snorm16(e.y);
+        }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) {
+            v->Normal = vertex_octahedral_decode(DirectX::XMFLOAT2(vertex_unpack_snorm16(in.xy[0]), vertex_unpack_snorm16(in.xy[1])));
+        }
+    };
+
+    //! only the direction, handedness has to come from somewhere else (PositionUnorm16's w)
+    struct TangentOctahedral {
+        struct Stored {
+            int16_t xy[2];
+        };
+        static constexpr const char* SEMANTIC = "TANGENT";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R16G16_SNORM;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) {
+            DirectX::XMFLOAT2 e = vertex_octahedral_encode(v.Tangent);
+            out->xy[0] = vertex_pack_snorm16(e.x);
+            out->xy[1] = vertex_pack_snorm16(e.y);
+        }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) {
+            v->Tangent = vertex_octahedral_decode(DirectX::XMFLOAT2(vertex_unpack_snorm16(in.xy[0]), vertex_unpack_snorm16(in.xy[1])));
+        }
+    };
+
+    // normal + tangent (+ handedness) as one quaternion, replaces both
+    struct TangentFrameQuat {
+        struct Stored {
+            int16_t xyzw[4];
+        };
+        static constexpr const char* SEMANTIC = "QTANGENT";
+        static constexpr DXGI_FORMAT FORMAT = DXGI_FORMAT_R16G16B16A16_SNORM;
+
+        static void encode(const Vertex& v, const VertexEncodeParams&, Stored* out) {
+            DirectX::XMFLOAT4 q = vertex_qtangent_encode(v.Normal, v.Tangent, v.Handedness);
+            out->xyzw[0] = vertex_pack_snorm16(q.x);
+            out->xyzw[1] = vertex_pack_snorm16(q.y);
+            out->xyzw[2] = vertex_pack_snorm16(q.z);
+            out->xyzw[3] = vertex_pack_snorm16(q.w);
+        }
+        static void decode(const Stored& in, const VertexEncodeParams&, Vertex* v) {
+            DirectX::XMFLOAT4 q(
+                vertex_unpack_snorm16(in.xyzw[0]),
+                vertex_unpack_snorm16(in.xyzw[1]),
+                vertex_unpack_snorm16(in.xyzw[2]),
+                vertex_unpack_snorm16(in.xyzw[3])
+            );
+            vertex_qtangent_decode(q, &v->Normal, &v->Tangent, &v->Handedness);
+        }
+    };
+}
+
+// --- LAYOUTS ---
+
+// one declaration gives the GPU side (stride, input elements) and the CPU
+//   side (encode/decode), so they can't drift apart. attributes are packed
+//   back to back in the order they're listed
+template <typename... Attributes>
+struct VertexLayout {
+    static constexpr uint32_t ATTRIBUTE_COUNT = sizeof...(Attributes);
+    static constexpr uint32_t STRIDE = (0 + ... + (uint32_t)sizeof(typename Attributes::Stored));
+
+    static_assert(((sizeof(typename Attributes::Stored) % 4 == 0) && ...), "vertex elements have to be 4 byte aligned");
+
+    static std::vector<D3D12_INPUT_ELEMENT_DESC> input_elements() {
+        return {
+            D3D12_INPUT_ELEMENT_DESC {
+                Attributes::SEMANTIC,
+                0,
+                Attributes::FORMAT,
+                0,
+                D3D12_APPEND_ALIGNED_ELEMENT,
+                D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                0
+            }...
+        };
+    }
+
+    // out needs room for count * STRIDE bytes
+    static void encode(const Vertex* vertices, uint32_t count, const VertexEncodeParams& params, void* out) {
+        uint8_t* bytes = (uint8_t*)out;
+        for (uint32_t i = 0; i < count; i++) {
+            size_t offset = (size_t)i * STRIDE;
+            (encode_attribute<Attributes>(vertices[i], params, bytes, &offset), ...);
+        }
+    }
+
+    // anything the layout doesn't store comes back zeroed
+    static void decode(const void* data, uint32_t count, const VertexEncodeParams& params, Vertex* out) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (uint32_t i = 0; i < count; i++) {
+            size_t offset = (size_t)i * STRIDE;
+            out[i] = {};
+            (decode_attribute<Attributes>(bytes, params, &out[i], &offset), ...);
+        }
+    }
+
+   private:
+    // memcpy since packed attributes aren't necessarily aligned for their type
+    template <typename Attribute>
+    static void encode_attribute(const Vertex& v, const VertexEncodeParams& params, uint8_t* bytes, size_t* offset) {
+        typename Attribute::Stored stored;
+        Attribute::encode(v, params, &stored);
+        memcpy(bytes + *offset, &stored, sizeof(stored));
+        *offset += sizeof(stored);
+    }
+
+    template <typename Attribute>
+    static void decode_attribute(const uint8_t* bytes, const VertexEncodeParams& params, Vertex* v, size_t* offset) {
+        typename Attribute::Stored stored;
+        memcpy(&stored, bytes + *offset, sizeof(stored));
+        Attribute::decode(stored, params, v);
+        *offset += sizeof(stored);
+    }
+};
+
+using VertexLayoutFull = VertexLayout<
+    VertexAttributes::PositionFloat3,
+    VertexAttributes::UVFloat2,
+    VertexAttributes::NormalFloat3,
+    VertexAttributes::TangentFloat4>;
+
+using VertexLayoutOctahedral = VertexLayout<
+    VertexAttributes::PositionUnorm16,
+    VertexAttributes::UVUnorm16,
+    VertexAttributes::NormalOctahedral,
+    VertexAttributes::TangentOctahedral>;
+
+using VertexLayoutQTangent = VertexLayout<
+    VertexAttributes::PositionUnorm16,
+    VertexAttributes::UVUnorm16,
+    VertexAttributes::TangentFrameQuat>;
+
+static_assert(VertexLayoutFull::STRIDE == sizeof(Vertex), "full layout should be Vertex as is");
+static_assert(VertexLayoutOctahedral::STRIDE == 20);
+static_assert(VertexLayoutQTangent::STRIDE == 20);
+
+// the layout vertex buffers actually get uploaded in, see VertexConfig.h
+#if VERTEX_LAYOUT == VERTEX_LAYOUT_FULL
+using GPUVertexLayout = VertexLayoutFull;
+#elif VERTEX_LAYOUT == VERTEX_LAYOUT_OCTAHEDRAL
+using GPUVertexLayout = VertexLayoutOctahedral;
+#elif VERTEX_LAYOUT == VERTEX_LAYOUT_QTANGENT
+using GPUVertexLayout = VertexLayoutQTangent;
+#else
+#error "Unknown VERTEX_LAYOUT"
+#endif
+
+// worst case differences after an encode -> decode round trip
+struct VertexLayoutError {
+    float position;
+    float uv;
+    // in radians
+    float normal_angle;
+    float tangent_angle;
+    uint32_t handedness_mismatches;
+};
+
+VertexLayoutError vertex_layout_measure_error(
+    const Vertex* original,
+    const Vertex* decoded,
+    uint32_t count
+);
+
+// encodes + decodes with a layout and measures how much got lost
+template <typename Layout>
+VertexLayoutError vertex_layout_round_trip_error(const Vertex* vertices, uint32_t count, const VertexEncodeParams& params) {
+    std::vector<uint8_t> encoded((size_t)count * Layout::STRIDE);
+    std::vector<Vertex> decoded(count);
+    Layout::encode(vertices, count, params, encoded.data());
+    Layout::decode(encoded.data(), count, params, decoded.data());
+    return vertex_layout_measure_error(vertices, decoded.data(), count);
+}
@@ -1,24 +1,30 @@
 #include "IOStructs.hlsli"
+#include "VertexDecode.hlsli"
 
 cbuffer MatrixData : register(b0) {
 	float4x4 world;
 	float4x4 view;
 	float4x4 proj;
 	float4x4 wit;
+	float3 position_offset;
+	float3 position_scale;
+	float2 uv_offset;
+	float2 uv_scale;
 }
 
 PSInput main(VSInput input) {
 	PSInput output;
+	DecodedVertex vertex = decode_vertex(input, position_offset, position_scale, uv_offset, uv_scale);
 
 	float4x4 wvp = mul(proj, mul(view, world));
 
-	output.position = mul(wvp, float4(input.position, 1.0f));
-	output.world_pos = mul(world, float4(input.position, 1.0f)).xyz;
+	output.position = mul(wvp, float4(vertex.position, 1.0f));
+	output.world_pos = mul(world, float4(vertex.position, 1.0f)).xyz;
 
-	output.uv = input.uv;
+	output.uv = vertex.uv;
 
-	output.normal = normalize(mul((float3x3)wit, input.normal));
-	output.tangent = normalize(mul((float3x3)world, input.tangent));
+	output.normal = normalize(mul((float3x3)wit, vertex.normal));
+	output.tangent = float4(normalize(mul((float3x3)world, vertex.tangent.xyz)), vertex.tangent.w);
 
 	return output;
 }
\ No newline at end of file
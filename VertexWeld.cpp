@@ -0,0 +1,233 @@
+#include "VertexWeld.h"
+
+#include "Parallel.h"
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    // position, uv and normal are the first 32 bytes of a vertex, which
+    //   makes them the welding key (tangents get regenerated later)
+    constexpr size_t WELD_KEY_BYTES = offsetof(Vertex, Tangent);
+    static_assert(WELD_KEY_BYTES == 32, "weld key expects Position/UV/Normal to be packed at the front of Vertex");
+
+    constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    // meshes smaller than this aren't worth splitting across threads
+    constexpr uint32_t SHARDED_WELD_THRESHOLD = 1 << 16;
+    constexpr uint32_t SHARD_BITS = 6;
+
+    // neighbouring grid cells are packed into one 64 bit key, 21 bits per axis
+    constexpr int64_t GRID_AXIS_BIAS = 1 << 20;
+    constexpr int64_t GRID_AXIS_MASK = (1 << 21) - 1;
+}
+
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t hash_key(const Vertex& v) {
+    uint64_t words[4];
+    memcpy(words, &v, WELD_KEY_BYTES);
+
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (uint64_t word : words) {
+        h = mix64(h ^ word);
+    }
+    return h;
+}
+
+static bool keys_equal(const Vertex& a, const Vertex& b) {
+    return memcmp(&a, &b, WELD_KEY_BYTES) == 0;
+}
+
+static uint32_t next_pow2(uint32_t value) {
+    uint32_t result = 16;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+// fills out_firsts with the index of the first vertex that's
+//   bit-identical to each vertex (which is itself for new vertices)
+static uint32_t weld_exact(const Vertex* vertices, uint32_t count, std::vector<uint32_t>* out_firsts) {
+    uint32_t shard_bits = count >= SHARDED_WELD_THRESHOLD ? SHARD_BITS : 0;
+    uint32_t shard_count = 1u << shard_bits;
+
+    // hash everything up front, in parallel blocks
+    std::vector<uint64_t> hashes(count);
+    constexpr uint32_t BLOCK_SIZE = 1 << 14;
+    uint32_t block_count = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    parallel_for(block_count, [&](uint32_t b) {
+        uint32_t end = (b + 1) * BLOCK_SIZE < count ? (b + 1) * BLOCK_SIZE : count;
+        for (uint32_t i = b * BLOCK_SIZE; i < end; i++) {
+            hashes[i] = hash_key(vertices[i]);
+        }
+    });
+
+    // bucket vertices by shard (top bits of the hash), keeping input order
+    //   inside each shard so the earliest duplicate always wins
+    std::vector<uint32_t> shard_offsets(shard_count + 1, 0);
+    std::vector<uint32_t> shard_members(count);
+    if (shard_count > 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            shard_offsets[(hashes[i] >> (64 - shard_bits)) + 1]++;
+        }
+        for (uint32_t s = 0; s < shard_count; s++) {
+            shard_offsets[s + 1] += shard_offsets[s];
+        }
+
+        std::vector<uint32_t> cursors(shard_offsets.begin(), shard_offsets.end() - 1);
+        for (uint32_t i = 0; i < count; i++) {
+            shard_members[cursors[hashes[i] >> (64 - shard_bits)]++] = i;
+        }
+    } else {
+        shard_offsets[1] = count;
+        for (uint32_t i = 0; i < count; i++) {
+            shard_members[i] = i;
+        }
+    }
+
+    // every shard gets its own open addressing table, so no locking needed
+    out_firsts->resize(count);
+    parallel_for(shard_count, [&](uint32_t s) {
+        uint32_t member_count = shard_offsets[s + 1] - shard_offsets[s];
+        if (member_count == 0) return;
+
+        uint32_t capacity = next_pow2(member_count * 2);
+        uint32_t mask = capacity - 1;
+        std::vector<uint32_t> table(capacity, EMPTY_SLOT);
+
+        for (uint32_t m = shard_offsets[s]; m < shard_offsets[s + 1]; m++) {
+            uint32_t i = shard_members[m];
+            uint32_t slot = (uint32_t)hashes[i] & mask;
+
+            while (true) {
+                uint32_t existing = table[slot];
+                if (existing == EMPTY_SLOT) {
+                    table[slot] = i;
+                    (*out_firsts)[i] = i;
+                    break;
+                }
+                if (hashes[existing] == hashes[i] && keys_equal(vertices[existing], vertices[i])) {
+                    (*out_firsts)[i] = existing;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+    });
+
+    return shard_count;
+}
+
+static bool within_epsilon(const Vertex& a, const Vertex& b, float epsilon) {
+    const float* fa = &a.Position.x;
+    const float* fb = &b.Position.x;
+    for (size_t i = 0; i < WELD_KEY_BYTES / sizeof(float); i++) {
+        if (fabsf(fa[i] - fb[i]) > epsilon) return false;
+    }
+    return true;
+}
+
+static int64_t grid_coord(float value, float cell_size) {
+    return (int64_t)floorf(value / cell_size);
+}
+
+static uint64_t grid_key(int64_t x, int64_t y, int64_t z) {
+    return ((uint64_t)((x + GRID_AXIS_BIAS) & GRID_AXIS_MASK) << 42) |
+           ((uint64_t)((y + GRID_AXIS_BIAS) & GRID_AXIS_MASK) << 21) |
+           ((uint64_t)((z + GRID_AXIS_BIAS) & GRID_AXIS_MASK));
+}
+
+// same as weld_exact but merges anything within epsilon, positions are
+//   bucketed into epsilon sized cells so only the 27 cells around each
+//   vertex need checking. this one's order dependent so it stays serial
+static void weld_epsilon(const Vertex* vertices, uint32_t count, float epsilon, std::vector<uint32_t>* out_firsts) {
+    std::unordered_map<uint64_t, uint32_t> cell_heads;
+    cell_heads.reserve(count);
+    // linked list of unique vertices sharing a cell
+    std::vector<uint32_t> next_in_cell(count, EMPTY_SLOT);
+
+    out_firsts->resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const Vertex& v = vertices[i];
+        int64_t cx = grid_coord(v.Position.x, epsilon);
+        int64_t cy = grid_coord(v.Position.y, epsilon);
+        int64_t cz = grid_coord(v.Position.z, epsilon);
+
+        uint32_t match = EMPTY_SLOT;
+        for (int64_t dx = -1; dx <= 1 && match == EMPTY_SLOT; dx++) {
+            for (int64_t dy = -1; dy <= 1 && match == EMPTY_SLOT; dy++) {
+                for (int64_t dz = -1; dz <= 1 && match == EMPTY_SLOT; dz++) {
+                    auto cell = cell_heads.find(grid_key(cx + dx, cy + dy, cz + dz));
+                    if (cell == cell_heads.end()) continue;
+
+                    for (uint32_t other = cell->second; other != EMPTY_SLOT; other = next_in_cell[other]) {
+                        if (within_epsilon(vertices[other], v, epsilon)) {
+                            match = other;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (match != EMPTY_SLOT) {
+            (*out_firsts)[i] = match;
+            continue;
+        }
+
+        // brand new vertex, push it onto the front of its cell's list
+        (*out_firsts)[i] = i;
+        uint32_t& head = cell_heads.try_emplace(grid_key(cx, cy, cz), EMPTY_SLOT).first->second;
+        next_in_cell[i] = head;
+        head = i;
+    }
+}
+
+void vertex_weld(
+    const Vertex* vertices,
+    uint32_t count,
+    float epsilon,
+    std::vector<Vertex>* out_vertices,
+    std::vector<uint32_t>* out_indices,
+    VertexWeldStats* out_stats
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<uint32_t> firsts;
+    uint32_t shard_count = 1;
+    if (epsilon > 0.0f) {
+        weld_epsilon(vertices, count, epsilon, &firsts);
+    } else {
+        shard_count = weld_exact(vertices, count, &firsts);
+    }
+
+    // compact down to unique vertices in first-seen order. a vertex's
+    //   first occurrence always comes before it, so one pass does it
+    out_vertices->clear();
+    out_indices->resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (firsts[i] == i) {
+            (*out_indices)[i] = (uint32_t)out_vertices->size();
+            out_vertices->push_back(vertices[i]);
+        } else {
+            (*out_indices)[i] = (*out_indices)[firsts[i]];
+        }
+    }
+
+    if (out_stats != nullptr) {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        out_stats->input_count = count;
+        out_stats->unique_count = (uint32_t)out_vertices->size();
+        out_stats->shard_count = shard_count;
+        out_stats->seconds = elapsed.count();
+    }
+}
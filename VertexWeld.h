@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// info about a weld, handy for seeing how much de-duplication actually happened
+struct VertexWeldStats {
+    uint32_t input_count;
+    uint32_t unique_count;
+    uint32_t shard_count;
+    double seconds;
+};
+
+// de-duplicates a flat list of vertices into unique vertices + an index
+//   list, unique vertices are kept in the order they're first seen.
+//   - epsilon == 0: vertices weld only if their position, uv and normal
+//     are bit-for-bit identical (hashed as raw bytes, sharded across threads)
+//   - epsilon > 0: anything within epsilon on every position, uv and normal
+//     component gets merged, found through a spatial hash grid
+//   tangents are ignored since they get recalculated after welding anyways
+void vertex_weld(
+    const Vertex* vertices,
+    uint32_t count,
+    float epsilon,
+    std::vector<Vertex>* out_vertices,
+    std::vector<uint32_t>* out_indices,
+    VertexWeldStats* out_stats = nullptr
+);
@@ -167,6 +167,9 @@ void Window::UpdateStats(float totalTime) {
     std::wostringstream output;
     output.precision(6);
     output << windowTitle << "    Width: " << windowWidth << "    Height: " << windowHeight << "    FPS: " << fpsFrameCounter << "    Frame Time: " << mspf << "ms" << "    Graphics: " << Graphics::get_api_name();
+    // how long frames take from starting on the CPU to the GPU finishing them
+    FrameLatencyStats latency = Graphics::get_frame_latency_stats();
+    output << "    Frames In Flight: " << Graphics::get_frames_in_flight() << "    Latency: " << latency.average_seconds * 1000.0 << "ms";
 
     // Actually update the title bar and reset fps data
     SetWindowText(windowHandle, output.str().c_str());